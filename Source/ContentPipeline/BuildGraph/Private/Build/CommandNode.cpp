@@ -5,6 +5,7 @@
 #include "BuildContext.h"
 #include "BuildGraph.h"
 #include "BuildLog.h"
+#include "BuildWorkerFarm.h"
 #include "Build/FileHelpers.h"
 #include "Build/FileNode.h"
 
@@ -25,21 +26,12 @@ namespace ContentPipeline {
 //----------------------------------------------------------------------------
 namespace {
 //----------------------------------------------------------------------------
-static void FormatParameters_(
-    FWStringBuilder& outp,
+template <typename _Each>
+static void ExpandParameters_(
     const FFilename& destination,
     const FCommandNode::FDependenciesView& sources,
-    const FCommandNode::FParameters& parameters ) {
-    auto prmFormat = [&](const FWStringView& prm) {
-        if (not outp.Written().empty())
-            outp << Fmt::Space;
-
-        if (prm.empty() || HasSpace(prm))
-            outp << Fmt::Quoted(prm, Fmt::DoubleQuote);
-        else
-            outp << prm;
-    };
-
+    const FCommandNode::FParameters& parameters,
+    _Each&& prmFormat ) {
     for (const FWString& prm : parameters) {
         if (prm.front() == L'$') {
             if (Equals(prm.MakeView(), FCommandNode::Token_Input.MakeView())) {
@@ -60,6 +52,22 @@ static void FormatParameters_(
     }
 }
 //----------------------------------------------------------------------------
+static void FormatParameters_(
+    FWStringBuilder& outp,
+    const FFilename& destination,
+    const FCommandNode::FDependenciesView& sources,
+    const FCommandNode::FParameters& parameters ) {
+    ExpandParameters_(destination, sources, parameters, [&](const FWStringView& prm) {
+        if (not outp.Written().empty())
+            outp << Fmt::Space;
+
+        if (prm.empty() || HasSpace(prm))
+            outp << Fmt::Quoted(prm, Fmt::DoubleQuote);
+        else
+            outp << prm;
+    });
+}
+//----------------------------------------------------------------------------
 } //!namespace
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -126,6 +134,9 @@ EBuildResult FCommandNode::Import(FBuildContext& ctx) {
 }
 //----------------------------------------------------------------------------
 EBuildResult FCommandNode::Process(FBuildContext& ctx) {
+    if (FBuildWorkerFarm* const farm = ctx.WorkerFarm(_executable))
+        return ProcessInWorker_(ctx, *farm);
+
     FWStringBuilder cmdline;
     FormatParameters_(cmdline, Filename(), DynamicDeps(), _parameters);
 
@@ -146,6 +157,46 @@ EBuildResult FCommandNode::Process(FBuildContext& ctx) {
     }
 }
 //----------------------------------------------------------------------------
+EBuildResult FCommandNode::ProcessInWorker_(FBuildContext& ctx, FBuildWorkerFarm& farm) {
+    FBuildWorkerJob job;
+    ExpandParameters_(Filename(), DynamicDeps(), _parameters, [&job](const FWStringView& prm) {
+        job.Arguments.push_back(ToString(prm));
+    });
+
+    // cached outputs are only reused for the same tool and the same inputs
+    FBuildFingerpint fingerprint;
+    if (not ctx.FileFingerprint(&fingerprint, _executable)) {
+        ctx.Log().TraceError("can't fingerprint executable '{0}' for command node '{1}'", _executable, Filename());
+        return EBuildResult::Failed;
+    }
+
+    job.Inputs.push_back(fingerprint);
+    for (const PBuildNode& input : DynamicDeps())
+        job.Inputs.push_back(RTTI::CastChecked<FFileNode>(input.get())->Fingerprint());
+
+    job.Fingerprint = FBuildWorkerJob::MakeFingerprint(job);
+
+    FBuildWorkerResult result;
+    if (not farm.Execute(&result, job, &ctx.Cache(), ctx.Flags())) {
+        ctx.Log().TraceError("lost build worker while processing command node '{0}'", Filename());
+        return EBuildResult::Failed;
+    }
+
+    if (0 != result.ExitCode) {
+        ctx.Log().TraceError(result.Log.MakeView());
+        return EBuildResult::Failed;
+    }
+
+    // an empty output means the tool wrote the file itself
+    if (not result.Output.empty() and
+        not VFS_WriteAll(Filename(), result.Output.MakeConstView(), EAccessPolicy::Truncate_Binary) ) {
+        ctx.Log().TraceError("failed to write output file '{0}' for command node", Filename());
+        return EBuildResult::Failed;
+    }
+
+    return EBuildResult::Built;
+}
+//----------------------------------------------------------------------------
 EBuildResult FCommandNode::Clean(FCleanContext& ctx) {
     const FFilename& filename = Filename();
 
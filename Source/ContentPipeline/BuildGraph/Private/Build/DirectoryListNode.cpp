@@ -9,6 +9,7 @@
 #include "RTTI/Macros-impl.h"
 
 #include "IO/FileSystemProperties.h"
+#include "IO/StringBuilder.h"
 #include "IO/regexp.h"
 #include "VirtualFileSystem_fwd.h"
 
@@ -75,6 +76,12 @@ EBuildResult FDirectoryListNode::Clean(FCleanContext&) {
     return EBuildResult::UpToDate; // nothing to do
 }
 //----------------------------------------------------------------------------
+FWString FDirectoryListNode::BuildName() const {
+    FWStringBuilder sb;
+    sb << _path << L'|' << _pattern << (_recursive ? L"|recursive" : L"");
+    return sb.ToString();
+}
+//----------------------------------------------------------------------------
 void FDirectoryListNode::SetPath(const FDirpath& path) NOEXCEPT {
     Assert(not path.empty());
 
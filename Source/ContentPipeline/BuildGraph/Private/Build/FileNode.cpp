@@ -16,6 +16,7 @@ namespace ContentPipeline {
 RTTI_CLASS_BEGIN(BuildGraph, FFileNode, Concrete)
 RTTI_PROPERTY_PRIVATE_FIELD(_filename)
 RTTI_PROPERTY_PRIVATE_READONLY(_timestamp)
+RTTI_PROPERTY_PRIVATE_READONLY(_fingerprint)
 RTTI_CLASS_END()
 //----------------------------------------------------------------------------
 #ifdef WITH_RTTI_VERIFY_PREDICATES
@@ -32,7 +33,11 @@ FFileNode::FFileNode(const FFilename& filename) NOEXCEPT {
     SetFilename(filename);
 }
 //----------------------------------------------------------------------------
-EBuildResult FFileNode::Scan(FScanContext&) {
+EBuildResult FFileNode::Scan(FScanContext& ctx) {
+    // only rehashes the files with different stat data, Process() will reuse the cached fingerprint
+    FBuildFingerpint fingerprint;
+    Unused(ctx.FileFingerprint(&fingerprint, _filename)); // the file can be produced later by the build
+
     return EBuildResult::UpToDate;
 }
 //----------------------------------------------------------------------------
@@ -40,11 +45,14 @@ EBuildResult FFileNode::Import(FBuildContext&) {
     return EBuildResult::Built; // always call Process()
 }
 //----------------------------------------------------------------------------
-EBuildResult FFileNode::Process(FBuildContext&) {
-    FTimestamp lastModified;
-    if (VFS_FileLastModified(&lastModified, _filename)) {
-        if (lastModified != _timestamp) {
-            _timestamp = lastModified;
+EBuildResult FFileNode::Process(FBuildContext& ctx) {
+    // touched files with the same content are still up-to-date
+    FBuildFingerpint fingerprint;
+    if (ctx.FileFingerprint(&fingerprint, _filename)) {
+        Unused(VFS_FileLastModified(&_timestamp, _filename));
+
+        if (fingerprint != _fingerprint) {
+            _fingerprint = fingerprint;
             return EBuildResult::Built;
         }
         else {
@@ -53,6 +61,7 @@ EBuildResult FFileNode::Process(FBuildContext&) {
     }
     else {
         _timestamp = 0;
+        _fingerprint = FBuildFingerpint::Zero();
         return EBuildResult::Failed;
     }
 }
@@ -61,6 +70,10 @@ EBuildResult FFileNode::Clean(FCleanContext&) {
     return EBuildResult::UpToDate; // nothing to do
 }
 //----------------------------------------------------------------------------
+FWString FFileNode::BuildName() const {
+    return _filename.ToWString();
+}
+//----------------------------------------------------------------------------
 void FFileNode::SetFilename(const FFilename& filename) NOEXCEPT {
     Assert(not filename.empty());
 
@@ -8,6 +8,7 @@
 #include "BuildGraph.h"
 #include "BuildLog.h"
 #include "BuildNode.h"
+#include "FileStatCache.h"
 #include "Build/FileNode.h"
 
 #include "Diagnostic/Logger.h"
@@ -34,6 +35,8 @@ FPipelineContext::FPipelineContext(
 ,   _numBuilt(0)
 ,   _numFailed(0)
 ,   _numUpToDate(0)
+,   _numFilesHashed(0)
+,   _numFilesSkipped(0)
 {}
 //----------------------------------------------------------------------------
 FPipelineContext::FPipelineContext(FPipelineContext& parent) NOEXCEPT
@@ -48,6 +51,8 @@ FPipelineContext::FPipelineContext(FPipelineContext& parent) NOEXCEPT
 ,   _numBuilt(0)
 ,   _numFailed(0)
 ,   _numUpToDate(0)
+,   _numFilesHashed(0)
+,   _numFilesSkipped(0)
 {}
 //----------------------------------------------------------------------------
 FPipelineContext::~FPipelineContext() {
@@ -55,6 +60,8 @@ FPipelineContext::~FPipelineContext() {
         _parent->_numBuilt += _numBuilt;
         _parent->_numFailed += _numFailed;
         _parent->_numUpToDate += _numUpToDate;
+        _parent->_numFilesHashed += _numFilesHashed;
+        _parent->_numFilesSkipped += _numFilesSkipped;
 
         for (;;) {
             EBuildResult old = _parent->_result;
@@ -87,6 +94,27 @@ IBuildLog& FPipelineContext::Log() const NOEXCEPT {
     return _environment.Log();
 }
 //----------------------------------------------------------------------------
+FFileStatCache& FPipelineContext::StatCache() const NOEXCEPT {
+    return _environment.StatCache();
+}
+//----------------------------------------------------------------------------
+FBuildWorkerFarm* FPipelineContext::WorkerFarm(const FFilename& executable) const NOEXCEPT {
+    return _environment.WorkerFarm(executable);
+}
+//----------------------------------------------------------------------------
+bool FPipelineContext::FileFingerprint(FBuildFingerpint* outFingerprint, const FFilename& filename) {
+    bool rehashed = false;
+    if (not _environment.StatCache().Fingerprint(outFingerprint, filename, &rehashed))
+        return false;
+
+    if (rehashed)
+        ++_numFilesHashed;
+    else
+        ++_numFilesSkipped;
+
+    return true;
+}
+//----------------------------------------------------------------------------
 void FPipelineContext::SetResult_(EBuildResult result) NOEXCEPT {
     switch (result) {
     case PPE::ContentPipeline::EBuildResult::Built: ++_numBuilt; break;
@@ -149,7 +177,8 @@ EBuildResult FScanContext::Scan(FBuildNode& node) {
     EBuildResult result = exe.QueueAndWaitFor(*this, node.StaticDeps());
 
     if (EBuildResult::Failed != result)
-        result = Combine(result, node.Scan(*this));
+        result = Combine(result, exe.Work(*this, node, EBuildStep::Scan,
+            [](FPipelineContext& ctx, FBuildNode& n) { return n.Scan(static_cast<FScanContext&>(ctx)); }));
 
     if ((EBuildResult::Failed != result) | not HasStopOnError())
         exe.Queue(*this, node.DynamicDeps());
@@ -223,13 +252,15 @@ EBuildResult FBuildContext::Build(FBuildNode& node) {
     EBuildResult result = exe.QueueAndWaitFor(*this, node.StaticDeps());
 
     if (EBuildResult::Failed != result) {
-        result = Combine(result, node.Import(*this));
+        result = Combine(result, exe.Work(*this, node, EBuildStep::Import,
+            [](FPipelineContext& ctx, FBuildNode& n) { return n.Import(static_cast<FBuildContext&>(ctx)); }));
 
         if ((EBuildResult::Built == result) | ((EBuildResult::UpToDate == result) & HasRebuild())) {
             result = exe.QueueAndWaitFor(*this, node.DynamicDeps());
 
             if (EBuildResult::Failed != result) {
-                result = Combine(result, node.Process(*this));
+                result = Combine(result, exe.Work(*this, node, EBuildStep::Process,
+                    [](FPipelineContext& ctx, FBuildNode& n) { return n.Process(static_cast<FBuildContext&>(ctx)); }));
 
                 if ((EBuildResult::Failed != result) | not HasStopOnError())
                     exe.Queue(*this, node.RuntimeDeps());
@@ -268,7 +299,8 @@ EBuildResult FCleanContext::Clean(FBuildNode& node) {
     EBuildResult result = exe.QueueAndWaitFor(*this, node.StaticDeps());
 
     if (EBuildResult::Failed != result)
-        result = Combine(result, node.Clean(*this));
+        result = Combine(result, exe.Work(*this, node, EBuildStep::Clean,
+            [](FPipelineContext& ctx, FBuildNode& n) { return n.Clean(static_cast<FCleanContext&>(ctx)); }));
 
     if ((EBuildResult::Failed != result) | not HasStopOnError())
         exe.Queue(*this, node.DynamicDeps());
@@ -78,4 +78,80 @@ FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline::EBuildResult resul
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+FTextWriter& operator <<(FTextWriter& oss, ContentPipeline::EBuildStep step) {
+    using ContentPipeline::EBuildStep;
+
+    switch (step) {
+    case EBuildStep::Scan:
+        return oss << "Scan";
+    case EBuildStep::Build:
+        return oss << "Build";
+    case EBuildStep::Clean:
+        return oss << "Clean";
+    case EBuildStep::Import:
+        return oss << "Import";
+    case EBuildStep::Process:
+        return oss << "Process";
+    default:
+        AssertNotReached();
+    }
+}
+//----------------------------------------------------------------------------
+FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline::EBuildStep step) {
+    using ContentPipeline::EBuildStep;
+
+    switch (step) {
+    case EBuildStep::Scan:
+        return oss << L"Scan";
+    case EBuildStep::Build:
+        return oss << L"Build";
+    case EBuildStep::Clean:
+        return oss << L"Clean";
+    case EBuildStep::Import:
+        return oss << L"Import";
+    case EBuildStep::Process:
+        return oss << L"Process";
+    default:
+        AssertNotReached();
+    }
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FTextWriter& operator <<(FTextWriter& oss, ContentPipeline::EBuildResourceClass resource) {
+    using ContentPipeline::EBuildResourceClass;
+
+    switch (resource) {
+    case EBuildResourceClass::Light:
+        return oss << "Light";
+    case EBuildResourceClass::CpuHeavy:
+        return oss << "CpuHeavy";
+    case EBuildResourceClass::IoHeavy:
+        return oss << "IoHeavy";
+    case EBuildResourceClass::MemoryHeavy:
+        return oss << "MemoryHeavy";
+    default:
+        AssertNotReached();
+    }
+}
+//----------------------------------------------------------------------------
+FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline::EBuildResourceClass resource) {
+    using ContentPipeline::EBuildResourceClass;
+
+    switch (resource) {
+    case EBuildResourceClass::Light:
+        return oss << L"Light";
+    case EBuildResourceClass::CpuHeavy:
+        return oss << L"CpuHeavy";
+    case EBuildResourceClass::IoHeavy:
+        return oss << L"IoHeavy";
+    case EBuildResourceClass::MemoryHeavy:
+        return oss << L"MemoryHeavy";
+    default:
+        AssertNotReached();
+    }
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
 } //!namespace PPE
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include "BuildEnvironment.h"
 
+#include "BuildWorkerFarm.h"
+#include "FileStatCache.h"
+
 #include "RTTI/Any.h"
 #include "MetaObject.h"
 
@@ -23,7 +26,26 @@ FBuildEnvironment::FBuildEnvironment(
 ,   _outputDir(outputDir)
 ,   _cache(cache)
 ,   _executor(executor)
-,   _log(log) {
+,   _log(log)
+,   _transientStatCache(MakeUnique<FFileStatCache>())
+,   _statCache(*_transientStatCache) {
+    Assert(not outputDir.empty());
+    Assert_NoAssume(outputDir.IsAbsolute());
+}
+//----------------------------------------------------------------------------
+FBuildEnvironment::FBuildEnvironment(
+    const ITargetPlaftorm& platform,
+    const FDirpath& outputDir,
+    IBuildCache& cache,
+    IBuildExecutor& executor,
+    IBuildLog& log,
+    FFileStatCache& statCache ) NOEXCEPT
+:   _platform(platform)
+,   _outputDir(outputDir)
+,   _cache(cache)
+,   _executor(executor)
+,   _log(log)
+,   _statCache(statCache) {
     Assert(not outputDir.empty());
     Assert_NoAssume(outputDir.IsAbsolute());
 }
@@ -31,6 +53,17 @@ FBuildEnvironment::FBuildEnvironment(
 FBuildEnvironment::~FBuildEnvironment() 
 {} // for forward declaration
 //----------------------------------------------------------------------------
+void FBuildEnvironment::RegisterWorkerFarm(FBuildWorkerFarm& farm) {
+    Assert_NoAssume(not _workerFarms.Contains(farm.Executable()));
+
+    _workerFarms.insert_or_assign(farm.Executable(), &farm);
+}
+//----------------------------------------------------------------------------
+FBuildWorkerFarm* FBuildEnvironment::WorkerFarm(const FFilename& executable) const NOEXCEPT {
+    const auto it = _workerFarms.find(executable);
+    return (_workerFarms.end() != it ? it->second : nullptr);
+}
+//----------------------------------------------------------------------------
 FDirpath FBuildEnvironment::MakeOutputDir(const FDirpath& relative) const {
     Assert(not relative.empty());
     Assert_NoAssume(relative.IsRelative());
@@ -4,12 +4,19 @@
 
 #include "BuildContext.h"
 #include "BuildNode.h"
+#include "BuildProfiler.h"
 
 #include "Container/SparseArray.h"
+#include "Container/Vector.h"
 
+#include "Meta/ThreadResource.h"
 #include "Thread/Task/CompletionPort.h"
+#include "Thread/Task/TaskContext.h"
 #include "Thread/ThreadPool.h"
+#include "Time/Timepoint.h"
 
+#include <algorithm>
+#include <mutex>
 #include <type_traits>
 
 namespace PPE {
@@ -17,11 +24,108 @@ namespace ContentPipeline {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// Limits the number of nodes working concurrently, without blocking the workers:
+// waiting nodes yield their fiber on a ticket, and the slot is handed over to the
+// waiting node with the longest estimated path when released.
+class FResourceGate_ : Meta::FNonCopyableNorMovable {
+public:
+    u32 Limit() const { return _limit; }
+    void SetLimit(u32 limit) { _limit = limit; }
+
+    NODISCARD bool TryAcquire() {
+        if (0 == _limit)
+            return true;
+
+        const Meta::FLockGuard scopeLock(_barrier);
+        if (_running < _limit) {
+            ++_running;
+            return true;
+        }
+        return false;
+    }
+
+    void Acquire(ITaskContext& task, u64 priority) {
+        if (0 == _limit)
+            return;
+
+        FCompletionPort ticket;
+        {
+            const Meta::FLockGuard scopeLock(_barrier);
+            if (_running < _limit) {
+                ++_running;
+                return;
+            }
+
+            ticket.Start(1);
+            _waiting.push_back(FWaiting_{ priority, _numWaits++, &ticket });
+        }
+
+        // resumed by Release(), which hands over its slot
+        task.WaitFor(ticket, ETaskPriority::High);
+    }
+
+    void Release() {
+        if (0 == _limit)
+            return;
+
+        FCompletionPort* ticket;
+        {
+            const Meta::FLockGuard scopeLock(_barrier);
+            if (_waiting.empty()) {
+                Assert(_running > 0);
+                --_running;
+                return;
+            }
+
+            // longest path first, then first come first served
+            const auto it = std::min_element(_waiting.begin(), _waiting.end(),
+                [](const FWaiting_& a, const FWaiting_& b) {
+                    return (a.Priority != b.Priority ? a.Priority > b.Priority : a.Order < b.Order);
+                });
+
+            ticket = it->Ticket;
+            *it = _waiting.back();
+            _waiting.pop_back();
+        }
+
+        ticket->OnJobComplete();
+    }
+
+private:
+    struct FWaiting_ {
+        u64 Priority;
+        u64 Order;
+        FCompletionPort* Ticket;
+    };
+
+    std::mutex _barrier;
+    u32 _limit{ 0 };
+    u32 _running{ 0 };
+    u64 _numWaits{ 0 };
+    VECTOR(BuildGraph, FWaiting_) _waiting;
+};
+//----------------------------------------------------------------------------
+NODISCARD static u64 TimespanInMicros_(FTimespan duration) {
+    return static_cast<u64>(Max(0.0, duration.Value()) * 1000.0);
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
 class FParallelExecutor : public IBuildExecutor {
 public:
-    FParallelExecutor(FTaskManager& pool) NOEXCEPT
+    FParallelExecutor(FTaskManager& pool, const FParallelExecutorOptions& options) NOEXCEPT
     :   _pool(pool)
-    {}
+    ,   _profiler(options.Profiler) {
+        forrange(i, 0, static_cast<size_t>(EBuildResourceClass::_Count))
+            _gates[i].SetLimit(options.MaxConcurrency[i]);
+
+        // light nodes are never limited, cpu heavy nodes are limited by the number of workers by default
+        _gates[static_cast<size_t>(EBuildResourceClass::Light)].SetLimit(0);
+        if (0 == options.MaxConcurrency[static_cast<size_t>(EBuildResourceClass::CpuHeavy)])
+            _gates[static_cast<size_t>(EBuildResourceClass::CpuHeavy)].SetLimit(checked_cast<u32>(_pool.WorkerCount()));
+    }
 
     virtual void Queue(const FScanContext& scan, const TMemoryView<const PBuildNode>& deps) override {
         Queue_Dispatch_(scan, deps);
@@ -47,6 +151,29 @@ public:
         _pool.RunInWorker([this](ITaskContext& task) {
             _global.JoinAndReset(task);
         });
+
+        // each pass estimates its own critical path
+        if (_profiler)
+            _profiler->ResetCriticalPath();
+    }
+
+    virtual EBuildResult Work(FPipelineContext& ctx, FBuildNode& node, EBuildStep step, FWorkFunc work) override {
+        Assert(work);
+
+        FResourceGate_& gate = _gates[static_cast<size_t>(node.ResourceClass())];
+        if (not gate.TryAcquire()) // only estimate the path when the gate is contended
+            gate.Acquire(ITaskContext::Get(), EstimatedPathInMicros_(node, PathStep_(step)));
+
+        const FTimepoint startedAt = FTimepoint::Now();
+        const EBuildResult result = work(ctx, node);
+        const FTimespan duration = FTimepoint::ElapsedSince(startedAt); // before releasing the slot, traced work never overlaps
+
+        gate.Release();
+
+        if (_profiler)
+            _profiler->RecordWork(node, step, result, startedAt, duration);
+
+        return result;
     }
 
 private:
@@ -54,7 +181,7 @@ private:
     void Queue_Dispatch_(const _Context& action, const TMemoryView<const PBuildNode>& deps) {
         if (not deps.empty()) {
             _Context& root = const_cast<_Context&>(action).Root();
-            _pool.Run(_global, [&root, deps](ITaskContext& task) {
+            _pool.Run(_global, [this, &root, deps](ITaskContext& task) {
                 _Context local(root);
                 Parallelize_<_Context>(task, local, deps, nullptr);
             },  PriorityFromArity_(deps.size()) );
@@ -66,9 +193,9 @@ private:
         if (not deps.empty()) {
             _Context local(action);
             volatile EBuildResult result = EBuildResult::Unbuilt;
-            _pool.RunInWorker(
-                FTaskFunc::Bind< Parallelize_<_Context> >(&local, deps, &result),
-                PriorityFromArity_(deps.size()) );
+            _pool.RunInWorker([this, &local, deps, &result](ITaskContext& task) {
+                Parallelize_<_Context>(task, local, deps, &result);
+            },  PriorityFromArity_(deps.size()) );
             return result;
         }
         else {
@@ -87,12 +214,41 @@ private:
         return clean.Clean(node);
     }
 
+    static CONSTEXPR EBuildStep PathStep_(const FScanContext&) { return EBuildStep::Scan; }
+    static CONSTEXPR EBuildStep PathStep_(const FBuildContext&) { return EBuildStep::Build; }
+    static CONSTEXPR EBuildStep PathStep_(const FCleanContext&) { return EBuildStep::Clean; }
+
+    // the history records whole paths, node work is accounted with its dependencies
+    static CONSTEXPR EBuildStep PathStep_(EBuildStep step) {
+        switch (step) {
+        case EBuildStep::Import:
+        case EBuildStep::Process:
+            return EBuildStep::Build;
+        default:
+            return step;
+        }
+    }
+
     template <typename _Context>
-    static void DispatchNode_(ITaskContext&, _Context& action, const SBuildNode& node) {
+    void DispatchNode_(_Context& action, const SBuildNode& node, const FBuildFingerpint& historyKey) {
         Assert(node);
 
+        const FTimepoint startedAt = FTimepoint::Now();
+
         FBuildState& st = node->State();
         st.Result = ExecuteNode_(action, *node);
+
+        if (historyKey != FBuildFingerpint::Zero() and EBuildResult::Failed != st.Result) {
+            Assert(_profiler);
+            _profiler->RecordPath(historyKey, FTimepoint::ElapsedSince(startedAt));
+        }
+    }
+
+    NODISCARD u64 EstimatedPathInMicros_(const FBuildNode& node, EBuildStep step) const {
+        FTimespan estimate;
+        if (_profiler and _profiler->EstimatePath(&estimate, FBuildProfiler::HistoryKey(node, step)))
+            return TimespanInMicros_(estimate);
+        return 0;
     }
 
 private:
@@ -113,20 +269,65 @@ private:
             node.RuntimeDeps().size() );
     }
 
+    // Nodes on the critical path come first, when the history knows them
+    ETaskPriority PriorityFromEstimate_(u64 estimateInMicros) const {
+        Assert(_profiler);
+        const u64 criticalPathInMicros = TimespanInMicros_(_profiler->CriticalPath());
+        if (estimateInMicros * 2 >= criticalPathInMicros)
+            return ETaskPriority::High;
+        else if (estimateInMicros * 10 >= criticalPathInMicros)
+            return ETaskPriority::Normal;
+        else
+            return ETaskPriority::Low;
+    }
+
 private:
     FTaskManager& _pool;
+    FBuildProfiler* const _profiler;
     FAggregationPort _global;
+    FResourceGate_ _gates[static_cast<size_t>(EBuildResourceClass::_Count)];
+
+    struct FLaunch_ {
+        FBuildFingerpint HistoryKey;
+        u64 EstimateInMicros;
+        const PBuildNode* Node;
+    };
 
     template <typename _Context>
-    static void Parallelize_(ITaskContext& task, _Context& action, const TMemoryView<const PBuildNode>& deps, volatile EBuildResult* pResult) {
+    void Parallelize_(ITaskContext& task, _Context& action, const TMemoryView<const PBuildNode>& deps, volatile EBuildResult* pResult) {
         STATIC_ASSERT(std::is_base_of_v<FPipelineContext, _Context>);
         Assert(deps.data());
         Assert_NoAssume(not deps.empty());
 
         const FBuildRevision globalRev = action.Revision();
 
-        FAggregationPort batch;
+        // longest estimated paths are launched first (LPT), nodes without history keep their order
+        VECTORINSITU(BuildGraph, FLaunch_, 8) launches;
+        launches.reserve(deps.size());
         for (const PBuildNode& node : deps) {
+            FLaunch_& launch = launches.push_back_Default();
+            launch.HistoryKey = FBuildFingerpint::Zero();
+            launch.EstimateInMicros = 0;
+            launch.Node = &node;
+
+            if (_profiler) {
+                launch.HistoryKey = FBuildProfiler::HistoryKey(*node, PathStep_(action));
+
+                FTimespan estimate;
+                if (launch.HistoryKey != FBuildFingerpint::Zero() and
+                    _profiler->EstimatePath(&estimate, launch.HistoryKey) )
+                    launch.EstimateInMicros = Max(u64(1), TimespanInMicros_(estimate));
+            }
+        }
+
+        if (_profiler)
+            std::stable_sort(launches.begin(), launches.end(), [](const FLaunch_& a, const FLaunch_& b) {
+                return (a.EstimateInMicros > b.EstimateInMicros);
+            });
+
+        FAggregationPort batch;
+        for (const FLaunch_& launch : launches) {
+            const PBuildNode& node = *launch.Node;
             FBuildState& st = node->State();
 
             auto launchBuild = [&]() {
@@ -136,8 +337,12 @@ private:
                 st.Payload.reset(port);
 
                 task.Run(port.get(),
-                    FTaskFunc::Bind< &DispatchNode_<_Context> >(&action, MakeSafePtr(node.get())),
-                    PriorityFromNode_(*node) );
+                    [this, &action, n{ MakeSafePtr(node.get()) }, historyKey{ launch.HistoryKey }](ITaskContext&) {
+                        DispatchNode_<_Context>(action, n, historyKey);
+                    },
+                    (launch.EstimateInMicros
+                        ? PriorityFromEstimate_(launch.EstimateInMicros)
+                        : PriorityFromNode_(*node)) );
             };
 
             if (not st.Phase.Transition(globalRev, std::move(launchBuild))) {
@@ -162,8 +367,8 @@ private:
     }
 };
 //----------------------------------------------------------------------------
-UBuildExecutor MakeParallelExecutor(FTaskManager& pool) {
-    return MakeUnique<FParallelExecutor>(pool);
+UBuildExecutor MakeParallelExecutor(FTaskManager& pool, const FParallelExecutorOptions& options/* = {} */) {
+    return MakeUnique<FParallelExecutor>(pool, options);
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
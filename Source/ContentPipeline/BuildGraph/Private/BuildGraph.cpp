@@ -31,6 +31,12 @@ static EBuildResult ReportBuildStatus_(const FPipelineContext& ctx, FStringLiter
 
     const size_t totalNodes = (numBuilt + numFailed + numUpToDate);
 
+    const size_t numFilesHashed = ctx.NumFilesHashed();
+    const size_t numFilesSkipped = ctx.NumFilesSkipped();
+    if (numFilesHashed + numFilesSkipped > 0)
+        ctx.Log().TraceInfo("[{0}] {1} files hashed, {2} skipped with unchanged stats.",
+            action, numFilesHashed, numFilesSkipped);
+
     switch (ctx.Result()) {
     case EBuildResult::Unbuilt:
         Assert_NoAssume(0 == totalNodes);
@@ -121,7 +127,7 @@ void FBuildGraph::RemoveFile(const FFilename& fname, FBuildNode* node) {
 }
 //----------------------------------------------------------------------------
 EBuildResult FBuildGraph::ScanAll(const FBuildEnvironment& env) {
-    return BuildNodes_(env, _roots);
+    return ScanNodes_(env, _roots);
 }
 //----------------------------------------------------------------------------
 EBuildResult FBuildGraph::BuildAll(const FBuildEnvironment& env) {
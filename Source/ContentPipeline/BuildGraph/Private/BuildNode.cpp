@@ -27,6 +27,10 @@ FBuildNode::FBuildNode() NOEXCEPT
 FBuildNode::~FBuildNode()
 {}
 //----------------------------------------------------------------------------
+FWString FBuildNode::BuildName() const {
+    return FWString{};
+}
+//----------------------------------------------------------------------------
 void FBuildNode::AddStaticDep(FBuildNode* node) {
     Assert(node);
 
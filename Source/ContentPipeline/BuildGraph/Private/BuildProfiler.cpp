@@ -0,0 +1,320 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "BuildProfiler.h"
+
+#include "BuildNode.h"
+
+#include "MetaClass.h"
+
+#include "Diagnostic/Logger.h"
+#include "IO/Format.h"
+#include "IO/FormatHelpers.h"
+#include "IO/StringBuilder.h"
+#include "IO/TextWriter.h"
+#include "Memory/HashFunctions.h"
+#include "Memory/MemoryProvider.h"
+#include "Memory/MemoryStream.h"
+#include "Memory/SharedBuffer.h"
+#include "Misc/FourCC.h"
+#include "Thread/ThreadContext.h"
+#include "VirtualFileSystem_fwd.h"
+
+#include <algorithm>
+
+namespace PPE {
+namespace ContentPipeline {
+EXTERN_LOG_CATEGORY(PPE_BUILDGRAPH_API, BuildGraph)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+static const FFourCC HISTORY_MAGIC_   ("PBPH");
+static const FFourCC HISTORY_VERSION_ ("1.00");
+//----------------------------------------------------------------------------
+struct FHistoryHeader_ {
+    FFourCC Magic;
+    FFourCC Version;
+    u64 NumEntries;
+    u64 Checksum;
+};
+STATIC_ASSERT(Meta::is_pod_v<FHistoryHeader_>);
+//----------------------------------------------------------------------------
+struct FHistoryEntry_ {
+    FBuildFingerpint Key;
+    u64 PathInMicros;
+    u32 NumSamples;
+    u32 _Padding;
+};
+STATIC_ASSERT(Meta::is_pod_v<FHistoryEntry_>);
+//----------------------------------------------------------------------------
+NODISCARD static u64 TimespanInMicros_(FTimespan elapsed) {
+    return static_cast<u64>(Max(0.0, elapsed.Value()) * 1000.0);
+}
+//----------------------------------------------------------------------------
+// paths are mostly ascii, everything else is escaped
+static void JsonString_(FTextWriter& oss, const FWStringView& str) {
+    oss << '"';
+    for (const wchar_t ch : str) {
+        if (L'"' == ch or L'\\' == ch)
+            oss << '\\' << static_cast<char>(ch);
+        else if (ch >= 0x20 and ch < 0x7F)
+            oss << static_cast<char>(ch);
+        else {
+            u32 codepoint = static_cast<u32>(ch);
+            if (codepoint > 0x10FFFF)
+                codepoint = 0xFFFD; // not unicode, replacement character
+            if (codepoint > 0xFFFF) {
+                // wchar_t is UTF-32 on Linux, json only escapes UTF-16 code units
+                codepoint -= 0x10000;
+                Format(oss, "\\u{0:#4x}", 0xD800 + (codepoint >> 10));
+                codepoint = 0xDC00 + (codepoint & 0x3FF);
+            }
+            Format(oss, "\\u{0:#4x}", codepoint);
+        }
+    }
+    oss << '"';
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FBuildProfiler::FBuildProfiler() NOEXCEPT
+:   _createdAt(FTimepoint::Now())
+{}
+//----------------------------------------------------------------------------
+FBuildProfiler::FBuildProfiler(const FFilename& historyPath)
+:   _historyPath(historyPath)
+,   _createdAt(FTimepoint::Now()) {
+    Assert_NoAssume(not _historyPath.empty());
+
+    if (VFS_FileExists(_historyPath))
+        Unused(Load());
+}
+//----------------------------------------------------------------------------
+FBuildProfiler::~FBuildProfiler() {
+    if (not _historyPath.empty() and not Flush())
+        PPE_LOG(BuildGraph, Error, "failed to save build history to <{0}>", _historyPath);
+}
+//----------------------------------------------------------------------------
+FTimespan FBuildProfiler::CriticalPath() const {
+    return FTimespan{ _criticalPathInMicros.load(std::memory_order_relaxed) / 1000.0 };
+}
+//----------------------------------------------------------------------------
+void FBuildProfiler::ResetCriticalPath() {
+    _criticalPathInMicros.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+bool FBuildProfiler::EstimatePath(FTimespan* outDuration, const FBuildFingerpint& key) {
+    Assert(outDuration);
+
+    if (FBuildFingerpint::Zero() == key)
+        return false;
+
+    u64 pathInMicros;
+    {
+        const auto sharedShard = _shards[ShardIndex_(key)].LockShared();
+        const auto it = sharedShard->find(key);
+        if (sharedShard->end() == it)
+            return false;
+
+        pathInMicros = it->second.PathInMicros;
+    }
+
+    for (u64 criticalPath = _criticalPathInMicros.load(std::memory_order_relaxed); criticalPath < pathInMicros; ) {
+        if (_criticalPathInMicros.compare_exchange_weak(criticalPath, pathInMicros, std::memory_order_relaxed))
+            break;
+    }
+
+    *outDuration = FTimespan{ pathInMicros / 1000.0 };
+    return true;
+}
+//----------------------------------------------------------------------------
+void FBuildProfiler::RecordPath(const FBuildFingerpint& key, FTimespan duration) {
+    if (FBuildFingerpint::Zero() == key)
+        return;
+
+    const u64 sampleInMicros = TimespanInMicros_(duration);
+    {
+        const auto exclusiveShard = _shards[ShardIndex_(key)].LockExclusive();
+
+        auto it = exclusiveShard->find(key);
+        if (exclusiveShard->end() == it) {
+            exclusiveShard->try_emplace(key, FHistoryEntry{ sampleInMicros, 1 });
+        }
+        else {
+            // alpha=1/4: follows the trend within a few runs, without jumping on each outlier
+            FHistoryEntry& entry = it->second;
+            entry.PathInMicros = (entry.PathInMicros * 3 + sampleInMicros) / 4;
+            entry.NumSamples++;
+        }
+    }
+
+    _dirty.store(true, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+void FBuildProfiler::RecordWork(const FBuildNode& node, EBuildStep step, EBuildResult result, FTimepoint startedAt, FTimespan duration) {
+    if (not Tracing())
+        return;
+
+    FBuildTraceEvent ev{
+        node.BuildName(),
+        RTTI::MetaClassName(node.RTTI_Class()),
+        step,
+        node.ResourceClass(),
+        result,
+        checked_cast<u32>(CurrentThreadContext().ThreadIndex()),
+        TimespanInMicros_(FTimepoint::SignedDuration(_createdAt, startedAt)),
+        TimespanInMicros_(duration) };
+
+    _trace.LockExclusive()->push_back(std::move(ev));
+}
+//----------------------------------------------------------------------------
+size_t FBuildProfiler::NumHistoryEntries() const {
+    size_t n = 0;
+    for (const auto& shard : _shards)
+        n += shard.LockShared()->size();
+    return n;
+}
+//----------------------------------------------------------------------------
+size_t FBuildProfiler::NumTraceEvents() const {
+    return _trace.LockShared()->size();
+}
+//----------------------------------------------------------------------------
+auto FBuildProfiler::TraceEvents() const -> VECTOR(BuildGraph, FBuildTraceEvent) {
+    return (*_trace.LockShared());
+}
+//----------------------------------------------------------------------------
+void FBuildProfiler::ClearTrace() {
+    _trace.LockExclusive()->clear_ReleaseMemory();
+}
+//----------------------------------------------------------------------------
+void FBuildProfiler::ExportChromeTrace(FTextWriter& oss) const {
+    FTrace events = TraceEvents();
+
+    // sorted by thread then by start, which keeps the exported file stable between runs
+    std::sort(events.begin(), events.end(), [](const FBuildTraceEvent& lhs, const FBuildTraceEvent& rhs) {
+        return (lhs.ThreadIndex == rhs.ThreadIndex
+            ? lhs.StartInMicros < rhs.StartInMicros
+            : lhs.ThreadIndex < rhs.ThreadIndex );
+    });
+
+    oss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << Eol;
+
+    auto sep = Fmt::NotFirstTime(",\n");
+    for (const FBuildTraceEvent& ev : events) {
+        oss << sep << "{\"name\":";
+        if (ev.Name.empty())
+            oss << '"' << ev.ClassName << '"';
+        else
+            JsonString_(oss, ev.Name);
+
+        oss << ",\"cat\":\"" << ev.Step
+            << "\",\"ph\":\"X\",\"ts\":" << ev.StartInMicros
+            << ",\"dur\":" << ev.DurationInMicros
+            << ",\"pid\":1,\"tid\":" << ev.ThreadIndex
+            << ",\"args\":{\"class\":\"" << ev.ClassName
+            << "\",\"resource\":\"" << ev.Resource
+            << "\",\"result\":\"" << ev.Result << "\"}}";
+    }
+
+    oss << Eol << "]}" << Eol;
+}
+//----------------------------------------------------------------------------
+bool FBuildProfiler::ExportChromeTrace(const FFilename& filename) const {
+    FStringBuilder sb;
+    ExportChromeTrace(sb);
+
+    const FStringView json = sb.Written();
+    if (not VFS_WriteAll(filename, json.Cast<const u8>(), EAccessPolicy::Truncate_Binary)) {
+        PPE_LOG(BuildGraph, Error, "failed to export build trace to <{0}>", filename);
+        return false;
+    }
+
+    PPE_LOG(BuildGraph, Info, "exported {0} build trace events to <{1}> ({2})",
+        NumTraceEvents(), filename, Fmt::SizeInBytes(json.SizeInBytes()) );
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FBuildProfiler::Load() {
+    Assert_NoAssume(not _historyPath.empty());
+
+    const FUniqueBuffer content = VFS_ReadAll(_historyPath, EAccessPolicy::Binary | EAccessPolicy::ShareRead);
+    if (not content)
+        return false;
+
+    FHistoryHeader_ header;
+    FMemoryViewReader reader{ content.MakeView() };
+    if (not reader.ReadPOD(&header) or
+        header.Magic != HISTORY_MAGIC_ or
+        header.Version != HISTORY_VERSION_ or
+        content.SizeInBytes() != sizeof(header) + header.NumEntries * sizeof(FHistoryEntry_) or
+        header.Checksum != hash_mem64(content.MakeView().CutStartingAt(sizeof(header)).Pointer(), content.SizeInBytes() - sizeof(header)) ) {
+        PPE_LOG(BuildGraph, Warning, "ignore invalid build history <{0}>", _historyPath);
+        return false;
+    }
+
+    const TMemoryView<const FHistoryEntry_> entries = content.MakeView().CutStartingAt(sizeof(header)).Cast<const FHistoryEntry_>();
+
+    for (auto& shard : _shards)
+        shard.Value_Unsafe().reserve(entries.size() / NumShards);
+
+    for (const FHistoryEntry_& entry : entries)
+        _shards[ShardIndex_(entry.Key)].Value_Unsafe().insert_or_assign(entry.Key, FHistoryEntry{ entry.PathInMicros, entry.NumSamples });
+
+    _dirty.store(false, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FBuildProfiler::Flush() {
+    if (_historyPath.empty())
+        return false;
+
+    if (not _dirty.exchange(false, std::memory_order_relaxed))
+        return true;
+
+    MEMORYSTREAM(BuildGraph) content;
+    content.WritePOD(FHistoryHeader_{}); // patched below, once the checksum is known
+
+    u64 numEntries = 0;
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        for (const auto& it : *sharedShard) {
+            content.WritePOD(FHistoryEntry_{ it.first, it.second.PathInMicros, it.second.NumSamples, 0 });
+            ++numEntries;
+        }
+    }
+
+    const FRawMemoryConst body = content.MakeView().CutStartingAt(sizeof(FHistoryHeader_));
+
+    FHistoryHeader_ header{};
+    header.Magic = HISTORY_MAGIC_;
+    header.Version = HISTORY_VERSION_;
+    header.NumEntries = numEntries;
+    header.Checksum = hash_mem64(body.Pointer(), body.SizeInBytes());
+    MakeRawView(&header, sizeof(header)).CopyTo(content.MakeView().CutBefore(sizeof(FHistoryHeader_)));
+
+    if (not VFS_WriteAll(_historyPath, content.MakeView(), EAccessPolicy::Truncate_Binary)) {
+        _dirty.store(true, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+FBuildFingerpint FBuildProfiler::HistoryKey(const FBuildNode& node, EBuildStep step) {
+    const FWString name = node.BuildName();
+    if (name.empty())
+        return FBuildFingerpint::Zero();
+
+    const FStringLiteral className = RTTI::MetaClassName(node.RTTI_Class());
+    const u128 classHash = hash_128(className.data(), className.size(), static_cast<u64>(step));
+
+    return hash_128(name.data(), name.size() * sizeof(wchar_t), classHash.lo ^ classHash.hi);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -0,0 +1,614 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "BuildWorkerFarm.h"
+
+#include "BuildCache.h"
+
+#include "Diagnostic/Logger.h"
+#include "HAL/PlatformLowLevelIO.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
+#include "IO/FormatHelpers.h"
+#include "IO/StreamProvider.h"
+#include "IO/StringView.h"
+#include "Memory/HashFunctions.h"
+#include "Memory/MemoryProvider.h"
+#include "Memory/MemoryStream.h"
+#include "Misc/FourCC.h"
+#include "Misc/Process.h"
+#include "Thread/Task/TaskHelpers.h"
+#include "Time/Timepoint.h"
+#include "VirtualFileSystem_fwd.h"
+
+namespace PPE {
+namespace ContentPipeline {
+EXTERN_LOG_CATEGORY(PPE_BUILDGRAPH_API, BuildGraph)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// Worker protocol, all integers are little endian:
+// - the worker greets with a FHelloHeader_ on stdout, and may print anything before it
+// - each batch is a FBatchHeader_ followed by its jobs, read entirely before running them,
+//   so the farm never blocks writing a batch while the worker blocks writing its results
+// - a job is a FJobHeader_, NumInputs fingerprints, then NumArguments strings prefixed by their u32 length
+// - each result is a FResultHeader_ followed by the output and the log, in the order of the jobs
+// - the worker exits when its stdin is closed
+//----------------------------------------------------------------------------
+static const FFourCC WORKER_HELLO_      ("PBWH");
+static const FFourCC WORKER_BATCH_      ("PBWB");
+static const FFourCC WORKER_RESULT_     ("PBWR");
+static const FFourCC WORKER_VERSION_    ("1.00");
+//----------------------------------------------------------------------------
+CONSTEXPR size_t WorkerMaxBatchSizeInBytes_ = 256u << 20;
+CONSTEXPR size_t WorkerMaxHelloPrefixInBytes_ = 64u << 10;
+//----------------------------------------------------------------------------
+struct FHelloHeader_ {
+    FFourCC Magic;
+    FFourCC Version;
+};
+STATIC_ASSERT(Meta::is_pod_v<FHelloHeader_>);
+//----------------------------------------------------------------------------
+struct FBatchHeader_ {
+    FFourCC Magic;
+    FFourCC Version;
+    u32 NumJobs;
+    u32 _Padding;
+    u64 SizeInBytes; // of the jobs following the header
+};
+STATIC_ASSERT(Meta::is_pod_v<FBatchHeader_>);
+//----------------------------------------------------------------------------
+struct FJobHeader_ {
+    FBuildFingerpint Fingerprint;
+    u32 NumInputs;
+    u32 NumArguments;
+};
+STATIC_ASSERT(Meta::is_pod_v<FJobHeader_>);
+//----------------------------------------------------------------------------
+struct FResultHeader_ {
+    FFourCC Magic;
+    i32 ExitCode;
+    FBuildFingerpint Fingerprint; // of the job, checked by the farm
+    u64 OutputSizeInBytes;
+    u64 LogSizeInBytes;
+};
+STATIC_ASSERT(Meta::is_pod_v<FResultHeader_>);
+//----------------------------------------------------------------------------
+template <typename _Stream>
+static void WriteJob_(_Stream& oss, const FBuildWorkerJob& job) {
+    oss.WritePOD(FJobHeader_{
+        job.Fingerprint,
+        checked_cast<u32>(job.Inputs.size()),
+        checked_cast<u32>(job.Arguments.size()) });
+
+    oss.WriteView(job.Inputs.MakeConstView());
+
+    for (const FString& arg : job.Arguments) {
+        oss.WritePOD(checked_cast<u32>(arg.size()));
+        oss.WriteView(arg.MakeView());
+    }
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool ReadJob_(FBuildWorkerJob* outJob, FMemoryViewReader& reader) {
+    FJobHeader_ header;
+    if (not reader.ReadPOD(&header))
+        return false;
+
+    outJob->Fingerprint = header.Fingerprint;
+
+    FRawMemoryConst inputs;
+    if (not reader.EatIFP(&inputs, header.NumInputs * sizeof(FBuildFingerpint)))
+        return false;
+
+    outJob->Inputs.resize_Uninitialized(header.NumInputs);
+    inputs.CopyTo(outJob->Inputs.MakeView().Cast<u8>());
+
+    outJob->Arguments.clear();
+    outJob->Arguments.reserve(header.NumArguments);
+
+    forrange(i, 0, header.NumArguments) {
+        u32 length;
+        FRawMemoryConst arg;
+        if (not reader.ReadPOD(&length) or
+            not reader.EatIFP(&arg, length) )
+            return false;
+
+        outJob->Arguments.emplace_back(reinterpret_cast<const char*>(arg.data()), arg.size());
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+// Worker side: blocking reads and writes on the standard handles
+NODISCARD static bool ReadExactly_(FPlatformLowLevelIO::FHandle handle, const FRawMemory& dst) {
+    for (FRawMemory it = dst; not it.empty(); ) {
+        const std::streamsize read = FPlatformLowLevelIO::Read(handle, it.data(), it.SizeInBytes());
+        if (read <= 0)
+            return false;
+
+        it = it.CutStartingAt(checked_cast<size_t>(read));
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool WriteExactly_(FPlatformLowLevelIO::FHandle handle, const FRawMemoryConst& src) {
+    for (FRawMemoryConst it = src; not it.empty(); ) {
+        const std::streamsize written = FPlatformLowLevelIO::Write(handle, it.data(), it.SizeInBytes());
+        if (written <= 0)
+            return false;
+
+        it = it.CutStartingAt(checked_cast<size_t>(written));
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FBuildFingerpint FBuildWorkerJob::MakeFingerprint(const FBuildWorkerJob& job) NOEXCEPT {
+    MEMORYSTREAM(BuildGraph) content;
+    WriteJob_(content, FBuildWorkerJob{ FBuildFingerpint::Zero(), job.Arguments, job.Inputs });
+
+    return hash_128(content.data(), checked_cast<size_t>(content.SizeInBytes()));
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Farm side: reads are polled on the worker stdout, like FProcess::CaptureOutput()
+class FBuildWorkerFarm::FWorker : Meta::FNonCopyableNorMovable {
+public:
+    FProcess Process;
+    u32 NumJobs{ 0 };
+    FTimepoint Deadline; // zero for no timeout
+    bool Stopped{ false };
+
+    explicit FWorker(FProcess&& process) NOEXCEPT
+    :   Process(std::move(process))
+    {}
+
+    ~FWorker() {
+        if (Process.IsValid() and not Stopped)
+            Unused(Stop());
+    }
+
+    void SetTimeout(double seconds) {
+        Deadline = (seconds > 0 ? FTimepoint::Now() + FTimespan{ FSeconds{ seconds } } : FTimepoint{});
+    }
+
+    NODISCARD bool Write(const FRawMemoryConst& src) {
+        for (FRawMemoryConst it = src; not it.empty(); ) {
+            const size_t written = Process.WriteStdin(it);
+            if (0 == written)
+                return false;
+
+            it = it.CutStartingAt(written);
+        }
+        return true;
+    }
+
+    NODISCARD bool Read(const FRawMemory& dst) {
+        i32 backoff = 0;
+        for (FRawMemory it = dst; not it.empty(); ) {
+            // liveness is checked before reading, to not miss what the worker wrote before exiting
+            const bool alive = Process.IsAlive();
+            const size_t read = Process.ReadStdout(it);
+            if (read) {
+                it = it.CutStartingAt(read);
+                backoff = 0;
+                continue;
+            }
+
+            if (not alive)
+                return false;
+
+            if (Deadline.Value() and FTimepoint::Now() > Deadline) {
+                PPE_LOG(BuildGraph, Error, "build worker {0} timed out", Process.Pid());
+                return false;
+            }
+
+            FPlatformProcess::SleepForSpinning(backoff);
+        }
+        return true;
+    }
+
+    // skips anything the tool printed before initializing the protocol
+    NODISCARD bool ReadHello() {
+        FHelloHeader_ hello;
+        u8* const raw = reinterpret_cast<u8*>(&hello);
+        if (not Read(MakePodView(hello)))
+            return false;
+
+        for (size_t skipped = 0; hello.Magic != WORKER_HELLO_; ++skipped) {
+            if (skipped == WorkerMaxHelloPrefixInBytes_)
+                return false;
+
+            FPlatformMemory::Memmove(raw, raw + 1, sizeof(hello) - 1);
+            if (not Read(FRawMemory{ raw + sizeof(hello) - 1, 1 }))
+                return false;
+        }
+
+        return (hello.Version == WORKER_VERSION_);
+    }
+
+    // returns true when the worker exited by itself with a zero exit code
+    NODISCARD bool Stop() {
+        Assert(not Stopped);
+        Stopped = true;
+
+        // closing stdin asks the worker to exit gracefully
+        Process.CloseStdin();
+        if (not Process.WaitFor(1000)) {
+            Process.Terminate(false);
+            return false;
+        }
+
+        const bool graceful = (0 == Process.ExitCode());
+        Process.Close();
+        return graceful;
+    }
+};
+//----------------------------------------------------------------------------
+FBuildWorkerFarm::FBuildWorkerFarm(
+    const FFilename& executable,
+    const FWString& workerArguments,
+    const FDirpath& workingDir/* = FDirpath{} */,
+    const FOptions& options/* = FOptions{} */)
+:   _executable(executable)
+,   _workerArguments(workerArguments)
+,   _workingDir(workingDir)
+,   _options(options)
+,   _maxWorkers(options.MaxWorkers
+        ? options.MaxWorkers
+        : checked_cast<u32>(FPlatformMisc::NumCoresWithSMT()) ) {
+    Assert(not _executable.empty());
+    Assert(_options.MaxJobsPerBatch > 0);
+    Assert(_options.MaxJobsPerWorker > 0);
+}
+//----------------------------------------------------------------------------
+FBuildWorkerFarm::~FBuildWorkerFarm() {
+    Shutdown();
+
+    Assert_NoAssume(0 == _numWorkers);
+}
+//----------------------------------------------------------------------------
+size_t FBuildWorkerFarm::NumWorkers() const {
+    const Meta::FLockGuard scopeLock(_barrier);
+    return _numWorkers;
+}
+//----------------------------------------------------------------------------
+auto FBuildWorkerFarm::Statistics() const NOEXCEPT -> FStatistics {
+    FStatistics stats;
+    stats.NumJobs = _numJobs.load(std::memory_order_relaxed);
+    stats.NumBatches = _numBatches.load(std::memory_order_relaxed);
+    stats.NumCacheHits = _numCacheHits.load(std::memory_order_relaxed);
+    stats.NumSpawns = _numSpawns.load(std::memory_order_relaxed);
+    stats.NumRecycles = _numRecycles.load(std::memory_order_relaxed);
+    stats.NumCrashes = _numCrashes.load(std::memory_order_relaxed);
+    stats.NumGracefulExits = _numGracefulExits.load(std::memory_order_relaxed);
+    return stats;
+}
+//----------------------------------------------------------------------------
+void FBuildWorkerFarm::ResetStatistics() NOEXCEPT {
+    _numJobs.store(0, std::memory_order_relaxed);
+    _numBatches.store(0, std::memory_order_relaxed);
+    _numCacheHits.store(0, std::memory_order_relaxed);
+    _numSpawns.store(0, std::memory_order_relaxed);
+    _numRecycles.store(0, std::memory_order_relaxed);
+    _numCrashes.store(0, std::memory_order_relaxed);
+    _numGracefulExits.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+void FBuildWorkerFarm::Shutdown() {
+    VECTOR(BuildGraph, UWorker) idle;
+    {
+        const Meta::FLockGuard scopeLock(_barrier);
+        idle = std::move(_idleWorkers);
+        _numWorkers -= checked_cast<u32>(idle.size());
+    }
+
+    // workers are stopped outside of the lock
+    for (UWorker& worker : idle) {
+        if (worker->Stop())
+            _numGracefulExits.fetch_add(1, std::memory_order_relaxed);
+    }
+    idle.clear();
+
+    _onWorkerReleased.notify_all();
+}
+//----------------------------------------------------------------------------
+bool FBuildWorkerFarm::Execute(
+    FBuildWorkerResult* outResult,
+    const FBuildWorkerJob& job,
+    IBuildCache* cache/* = nullptr */,
+    EBuildFlags flags/* = EBuildFlags::Cache */) {
+    Assert(outResult);
+    return ExecuteBatch({ outResult, 1 }, { &job, 1 }, cache, flags);
+}
+//----------------------------------------------------------------------------
+bool FBuildWorkerFarm::ExecuteBatch(
+    const TMemoryView<FBuildWorkerResult>& results,
+    const TMemoryView<const FBuildWorkerJob>& jobs,
+    IBuildCache* cache/* = nullptr */,
+    EBuildFlags flags/* = EBuildFlags::Cache */) {
+    Assert(results.size() == jobs.size());
+
+    _numJobs.fetch_add(jobs.size(), std::memory_order_relaxed);
+
+    // outputs found in the cache don't need a worker
+    VECTORINSITU(BuildGraph, u32, 8) misses;
+    forrange(i, 0, checked_cast<u32>(jobs.size())) {
+        const FBuildWorkerJob& job = jobs[i];
+        FBuildWorkerResult& result = results[i];
+        Assert_NoAssume(job.Fingerprint == FBuildWorkerJob::MakeFingerprint(job));
+
+        result.ExitCode = -1;
+        result.FromCache = false;
+        result.Output.clear_ReleaseMemory();
+        result.Log.clear();
+
+        if (cache and (flags & EBuildFlags::CacheRead)) {
+            if (const UStreamReader reader = cache->Read(job.Fingerprint)) {
+                result.Output.Resize_DiscardData(checked_cast<size_t>(reader->SizeInBytes()));
+                if (reader->Read(result.Output.data(), result.Output.SizeInBytes())) {
+                    result.ExitCode = 0;
+                    result.FromCache = true;
+                    _numCacheHits.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+            }
+        }
+
+        misses.push_back(i);
+    }
+
+    if (misses.empty())
+        return true;
+
+    // each batch is sent to its own worker, batches are dispatched in parallel
+    const size_t numBatches = (misses.size() + _options.MaxJobsPerBatch - 1) / _options.MaxJobsPerBatch;
+    _numBatches.fetch_add(numBatches, std::memory_order_relaxed);
+
+    std::atomic<bool> succeed{ true };
+    const auto runBatch = [&](size_t b) {
+        const TMemoryView<const u32> batch = misses.MakeConstView().SubRange(
+            b * _options.MaxJobsPerBatch,
+            Min(size_t(_options.MaxJobsPerBatch), misses.size() - b * _options.MaxJobsPerBatch) );
+
+        VECTORINSITU(BuildGraph, FBuildWorkerJob, 8) batchJobs;
+        VECTORINSITU(BuildGraph, FBuildWorkerResult, 8) batchResults;
+        batchJobs.reserve(batch.size());
+        for (u32 i : batch)
+            batchJobs.push_back(jobs[i]);
+        batchResults.resize(batch.size());
+
+        bool batchSucceed = false;
+        if (UWorker worker = AcquireWorker_()) {
+            batchSucceed = RunBatch_(*worker, batchResults.MakeView(), batchJobs.MakeConstView());
+
+            bool recycle = (not batchSucceed or worker->NumJobs >= _options.MaxJobsPerWorker);
+            if (not recycle and _options.MaxMemoryPerWorker)
+                recycle = (worker->Process.MemoryUsage().UsedPhysical >= _options.MaxMemoryPerWorker);
+
+            ReleaseWorker_(std::move(worker), recycle);
+        }
+
+        if (not batchSucceed)
+            succeed = false;
+
+        forrange(j, 0, batch.size()) {
+            FBuildWorkerResult& result = results[batch[j]];
+            result = std::move(batchResults[j]);
+
+            if (0 == result.ExitCode and cache and (flags & EBuildFlags::CacheWrite) and not result.Output.empty())
+                Unused(cache->Write(jobs[batch[j]].Fingerprint, result.Output.MakeConstView()));
+        }
+    };
+
+    if (1 == numBatches)
+        runBatch(0);
+    else
+        ParallelFor(0, numBatches, runBatch);
+
+    return succeed;
+}
+//----------------------------------------------------------------------------
+auto FBuildWorkerFarm::AcquireWorker_() -> UWorker {
+    {
+        std::unique_lock scopeLock(_barrier);
+        _onWorkerReleased.wait(scopeLock, [this]() {
+            return (not _idleWorkers.empty() or _numWorkers < _maxWorkers);
+        });
+
+        if (not _idleWorkers.empty()) {
+            UWorker worker = std::move(_idleWorkers.back());
+            _idleWorkers.pop_back();
+            return worker;
+        }
+
+        ++_numWorkers; // reserve the slot, the worker is spawned outside of the lock
+    }
+
+    UWorker worker = SpawnWorker_();
+    if (not worker) {
+        {
+            const Meta::FLockGuard scopeLock(_barrier);
+            --_numWorkers;
+        }
+        _onWorkerReleased.notify_one();
+    }
+
+    return worker;
+}
+//----------------------------------------------------------------------------
+void FBuildWorkerFarm::ReleaseWorker_(UWorker&& worker, bool recycle) {
+    Assert(worker);
+
+    if (recycle) {
+        _numRecycles.fetch_add(1, std::memory_order_relaxed);
+
+        // stops the process outside of the lock
+        if (worker->Stop())
+            _numGracefulExits.fetch_add(1, std::memory_order_relaxed);
+        worker.reset();
+
+        const Meta::FLockGuard scopeLock(_barrier);
+        --_numWorkers;
+    }
+    else {
+        const Meta::FLockGuard scopeLock(_barrier);
+        _idleWorkers.push_back(std::move(worker));
+    }
+
+    _onWorkerReleased.notify_one();
+}
+//----------------------------------------------------------------------------
+auto FBuildWorkerFarm::SpawnWorker_() -> UWorker {
+    FProcess process = FProcess::Create(
+        VFS_Unalias(_executable),
+        _workerArguments,
+        (_workingDir.empty() ? FWString{} : VFS_Unalias(_workingDir)),
+        static_cast<FProcess::EProcessFlags>(FProcess::RedirectStdin | FProcess::RedirectStdout | FProcess::NoWindow) );
+
+    if (not process.IsValid()) {
+        PPE_LOG(BuildGraph, Error, "failed to spawn build worker <{0}>", _executable);
+        _numCrashes.fetch_add(1, std::memory_order_relaxed);
+        return UWorker{};
+    }
+
+    UWorker worker = MakeUnique<FWorker>(std::move(process));
+    worker->SetTimeout(_options.StartupTimeoutInSeconds);
+
+    if (not worker->ReadHello()) {
+        PPE_LOG(BuildGraph, Error, "build worker <{0}> did not initialize the protocol", _executable);
+        _numCrashes.fetch_add(1, std::memory_order_relaxed);
+        return UWorker{};
+    }
+
+    _numSpawns.fetch_add(1, std::memory_order_relaxed);
+    return worker;
+}
+//----------------------------------------------------------------------------
+bool FBuildWorkerFarm::RunBatch_(FWorker& worker, const TMemoryView<FBuildWorkerResult>& results, const TMemoryView<const FBuildWorkerJob>& jobs) {
+    Assert(results.size() == jobs.size());
+
+    MEMORYSTREAM(BuildGraph) batch;
+    batch.WritePOD(FBatchHeader_{}); // patched below, once the size is known
+    for (const FBuildWorkerJob& job : jobs)
+        WriteJob_(batch, job);
+
+    FBatchHeader_ header{};
+    header.Magic = WORKER_BATCH_;
+    header.Version = WORKER_VERSION_;
+    header.NumJobs = checked_cast<u32>(jobs.size());
+    header.SizeInBytes = (batch.SizeInBytes() - sizeof(header));
+    MakePodView(header).CopyTo(batch.MakeView().CutBefore(sizeof(header)));
+
+    worker.SetTimeout(_options.BatchTimeoutInSeconds);
+    worker.NumJobs += checked_cast<u32>(jobs.size());
+
+    bool succeed = worker.Write(batch.MakeView());
+
+    FBuildWorkerResult::FOutput log;
+
+    forrange(i, 0, jobs.size()) {
+        if (not succeed)
+            break;
+
+        FResultHeader_ result;
+        succeed = (worker.Read(MakePodView(result)) and
+            result.Magic == WORKER_RESULT_ and
+            result.Fingerprint == jobs[i].Fingerprint );
+        if (not succeed)
+            break;
+
+        FBuildWorkerResult& dst = results[i];
+        dst.ExitCode = result.ExitCode;
+        dst.Output.Resize_DiscardData(checked_cast<size_t>(result.OutputSizeInBytes));
+        log.Resize_DiscardData(checked_cast<size_t>(result.LogSizeInBytes));
+
+        succeed = (worker.Read(dst.Output.MakeView()) and worker.Read(log.MakeView()));
+        if (succeed)
+            dst.Log = FString{ reinterpret_cast<const char*>(log.data()), log.size() };
+    }
+
+    if (not succeed) {
+        PPE_LOG(BuildGraph, Error, "lost build worker <{0}> with pid {1} while running a batch of {2} jobs",
+            _executable, worker.Process.Pid(), jobs.size() );
+        _numCrashes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return succeed;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+int RunBuildWorker(const FBuildWorkerHandler& handler) {
+    Assert(handler);
+
+    using FLowLevelIO = FPlatformLowLevelIO;
+
+    // keeps a private handle for the protocol, then anything printed on stdout goes to stderr
+    const FLowLevelIO::FHandle hInput = FLowLevelIO::Stdin;
+    const FLowLevelIO::FHandle hOutput = FLowLevelIO::Dup(FLowLevelIO::Stdout);
+    if (FLowLevelIO::InvalidHandle == hOutput)
+        return 1;
+
+    Unused(FLowLevelIO::Dup2(FLowLevelIO::Stderr, FLowLevelIO::Stdout));
+    Unused(FLowLevelIO::SetMode(hInput, EAccessPolicy::Binary));
+    Unused(FLowLevelIO::SetMode(hOutput, EAccessPolicy::Binary));
+
+    if (not WriteExactly_(hOutput, MakePodView(FHelloHeader_{ WORKER_HELLO_, WORKER_VERSION_ })))
+        return 1;
+
+    RAWSTORAGE(BuildGraph, u8) content;
+    FBuildWorkerJob job;
+    FBuildWorkerResult result;
+
+    for (;;) {
+        FBatchHeader_ header;
+        if (not ReadExactly_(hInput, MakePodView(header)))
+            return 0; // stdin was closed: graceful exit
+
+        if (header.Magic != WORKER_BATCH_ or
+            header.Version != WORKER_VERSION_ or
+            header.SizeInBytes > WorkerMaxBatchSizeInBytes_ )
+            return 2;
+
+        content.Resize_DiscardData(checked_cast<size_t>(header.SizeInBytes));
+        if (not ReadExactly_(hInput, content.MakeView()))
+            return 2;
+
+        FMemoryViewReader reader{ content.MakeConstView() };
+        forrange(i, 0, header.NumJobs) {
+            if (not ReadJob_(&job, reader))
+                return 2;
+
+            result.ExitCode = -1;
+            result.FromCache = false;
+            result.Output.clear();
+            result.Log.clear();
+
+            handler(&result, job);
+
+            const FResultHeader_ resultHeader{
+                WORKER_RESULT_,
+                checked_cast<i32>(result.ExitCode),
+                job.Fingerprint,
+                result.Output.SizeInBytes(),
+                result.Log.size() };
+
+            if (not WriteExactly_(hOutput, MakePodView(resultHeader)) or
+                not WriteExactly_(hOutput, result.Output.MakeConstView()) or
+                not WriteExactly_(hOutput, result.Log.MakeView().Cast<const u8>()) )
+                return 3;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -0,0 +1,321 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "FileStatCache.h"
+
+#include "Container/RawStorage.h"
+#include "Container/Vector.h"
+#include "Diagnostic/Logger.h"
+#include "IO/FileSystemProperties.h"
+#include "IO/FormatHelpers.h"
+#include "IO/String.h"
+#include "IO/StringView.h"
+#include "Memory/HashFunctions.h"
+#include "Memory/MemoryProvider.h"
+#include "Memory/MemoryStream.h"
+#include "Memory/SharedBuffer.h"
+#include "Misc/FourCC.h"
+#include "Thread/Task/TaskHelpers.h"
+#include "Time/Timepoint.h"
+#include "VirtualFileSystem_fwd.h"
+
+namespace PPE {
+namespace ContentPipeline {
+EXTERN_LOG_CATEGORY(PPE_BUILDGRAPH_API, BuildGraph)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+static const FFourCC STATCACHE_MAGIC_   ("PFSC");
+static const FFourCC STATCACHE_VERSION_ ("1.00");
+//----------------------------------------------------------------------------
+struct FStatCacheHeader_ {
+    FFourCC Magic;
+    FFourCC Version;
+    u32 CharSize; // paths are saved as wide strings
+    u32 _Padding;
+    u64 NumEntries;
+    u64 Checksum;
+};
+STATIC_ASSERT(Meta::is_pod_v<FStatCacheHeader_>);
+//----------------------------------------------------------------------------
+// followed by the path, padded to keep the next entry aligned
+struct FStatCacheEntry_ {
+    u64 SizeInBytes;
+    u64 Inode;
+    i64 LastModified;
+    i64 HashedAt;
+    FBuildFingerpint Fingerprint;
+    u32 PathLength;
+    u32 _Padding;
+};
+STATIC_ASSERT(Meta::is_pod_v<FStatCacheEntry_>);
+//----------------------------------------------------------------------------
+NODISCARD static size_t PaddedPathSizeInBytes_(u32 pathLength) {
+    return ROUND_TO_NEXT_8(pathLength * sizeof(wchar_t));
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool HashChunk_(u128* outHash, IStreamReader& reader, const FRawMemory& buffer, std::streamoff offset) {
+    if (not reader.ReadAt(buffer, offset))
+        return false;
+
+    *outHash = hash_128(buffer.Pointer(), buffer.SizeInBytes());
+    return true;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FFileStatCache::FFileStatCache() NOEXCEPT = default;
+//----------------------------------------------------------------------------
+FFileStatCache::FFileStatCache(const FFilename& path)
+:   _path(path) {
+    Assert_NoAssume(not _path.empty());
+
+    if (VFS_FileExists(_path))
+        Unused(Load());
+}
+//----------------------------------------------------------------------------
+FFileStatCache::~FFileStatCache() {
+    if (not _path.empty() and not Flush())
+        PPE_LOG(BuildGraph, Error, "failed to save file stat cache to <{0}>", _path);
+}
+//----------------------------------------------------------------------------
+bool FFileStatCache::Fingerprint(FBuildFingerpint* outFingerprint, const FFilename& filename, bool* outRehashed/* = nullptr */) {
+    Assert(outFingerprint);
+    Assert_NoAssume(not filename.empty());
+
+    if (outRehashed)
+        *outRehashed = false;
+
+    FFileStat stat;
+    if (not VFS_FileStats(&stat, filename) or not (stat.Mode & FFileStat::RegularFile)) {
+        Invalidate(filename);
+        _filesMissing.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto& shard = _shards[ShardIndex_(filename)];
+    {
+        const auto sharedShard = shard.LockShared();
+        const auto it = sharedShard->find(filename);
+        if (sharedShard->end() != it and
+            it->second.SizeInBytes == stat.SizeInBytes and
+            it->second.Inode == stat.Inode and
+            it->second.LastModified == stat.LastModified and
+            // the file could have been modified again in the same second, after being hashed
+            it->second.HashedAt > stat.LastModified ) {
+            *outFingerprint = it->second.Fingerprint;
+            _filesSkipped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    const FTimestamp hashedAt = FTimestamp::Now();
+    if (not HashFile(outFingerprint, filename, stat.SizeInBytes)) {
+        Invalidate(filename);
+        _filesMissing.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    shard.LockExclusive()->insert_or_assign(filename, FEntry{
+        stat.SizeInBytes,
+        stat.Inode,
+        stat.LastModified,
+        hashedAt,
+        *outFingerprint });
+
+    _dirty.store(true, std::memory_order_relaxed);
+    _filesHashed.fetch_add(1, std::memory_order_relaxed);
+    _hashedSizeInBytes.fetch_add(stat.SizeInBytes, std::memory_order_relaxed);
+
+    if (outRehashed)
+        *outRehashed = true;
+
+    return true;
+}
+//----------------------------------------------------------------------------
+void FFileStatCache::Invalidate(const FFilename& filename) {
+    if (_shards[ShardIndex_(filename)].LockExclusive()->erase(filename))
+        _dirty.store(true, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+void FFileStatCache::Clear() {
+    for (auto& shard : _shards)
+        shard.LockExclusive()->clear_ReleaseMemory();
+
+    _dirty.store(true, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+bool FFileStatCache::Load() {
+    Assert_NoAssume(not _path.empty());
+
+    const FTimepoint startedAt = FTimepoint::Now();
+
+    const FUniqueBuffer content = VFS_ReadAll(_path, EAccessPolicy::Binary | EAccessPolicy::ShareRead);
+    if (not content)
+        return false;
+
+    FStatCacheHeader_ header;
+    FMemoryViewReader reader{ content.MakeView() };
+    if (not reader.ReadPOD(&header) or
+        header.Magic != STATCACHE_MAGIC_ or
+        header.Version != STATCACHE_VERSION_ or
+        header.CharSize != sizeof(wchar_t) or
+        header.Checksum != hash_mem64(content.MakeView().CutStartingAt(sizeof(header)).Pointer(), content.SizeInBytes() - sizeof(header)) ) {
+        PPE_LOG(BuildGraph, Warning, "ignore invalid file stat cache <{0}>, all files will be hashed again", _path);
+        return false;
+    }
+
+    for (auto& shard : _shards)
+        shard.Value_Unsafe().reserve(checked_cast<size_t>(header.NumEntries / NumShards));
+
+    forrange(i, 0, header.NumEntries) {
+        FStatCacheEntry_ entry;
+        FRawMemoryConst path;
+        if (not reader.ReadPOD(&entry) or
+            not reader.EatIFP(&path, PaddedPathSizeInBytes_(entry.PathLength)) )
+            return false; // can't happen without a checksum collision
+
+        const FFilename filename{ FWStringView{ reinterpret_cast<const wchar_t*>(path.Pointer()), entry.PathLength } };
+        _shards[ShardIndex_(filename)].Value_Unsafe().insert_or_assign(filename, FEntry{
+            entry.SizeInBytes,
+            entry.Inode,
+            FTimestamp{ entry.LastModified },
+            FTimestamp{ entry.HashedAt },
+            entry.Fingerprint });
+    }
+
+    _dirty.store(false, std::memory_order_relaxed);
+
+    PPE_LOG(BuildGraph, Info, "loaded {0} entries from file stat cache <{1}> in {2}",
+        header.NumEntries, _path, Fmt::DurationInMs(FTimepoint::ElapsedSince(startedAt)) );
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FFileStatCache::Flush() {
+    if (_path.empty())
+        return false;
+
+    if (not _dirty.exchange(false, std::memory_order_relaxed))
+        return true;
+
+    MEMORYSTREAM(BuildGraph) content;
+    content.WritePOD(FStatCacheHeader_{}); // patched below, once the checksum is known
+
+    u64 numEntries = 0;
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        for (const auto& it : *sharedShard) {
+            const FWString path = it.first.ToWString();
+
+            FStatCacheEntry_ entry{};
+            entry.SizeInBytes = it.second.SizeInBytes;
+            entry.Inode = it.second.Inode;
+            entry.LastModified = it.second.LastModified.Value();
+            entry.HashedAt = it.second.HashedAt.Value();
+            entry.Fingerprint = it.second.Fingerprint;
+            entry.PathLength = checked_cast<u32>(path.size());
+
+            content.WritePOD(entry);
+            content.WriteView(path.MakeView());
+
+            const u8 padding[8]{};
+            content.Write(padding, PaddedPathSizeInBytes_(entry.PathLength) - path.size() * sizeof(wchar_t));
+
+            ++numEntries;
+        }
+    }
+
+    const FRawMemoryConst body = content.MakeView().CutStartingAt(sizeof(FStatCacheHeader_));
+
+    FStatCacheHeader_ header{};
+    header.Magic = STATCACHE_MAGIC_;
+    header.Version = STATCACHE_VERSION_;
+    header.CharSize = sizeof(wchar_t);
+    header.NumEntries = numEntries;
+    header.Checksum = hash_mem64(body.Pointer(), body.SizeInBytes());
+    MakeRawView(&header, sizeof(header)).CopyTo(content.MakeView().CutBefore(sizeof(FStatCacheHeader_)));
+
+    if (not VFS_WriteAll(_path, content.MakeView(), EAccessPolicy::Truncate_Binary)) {
+        _dirty.store(true, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+auto FFileStatCache::Statistics() const NOEXCEPT -> FStatistics {
+    FStatistics stats;
+
+    for (const auto& shard : _shards)
+        stats.NumEntries += shard.LockShared()->size();
+
+    stats.FilesHashed = _filesHashed.load(std::memory_order_relaxed);
+    stats.FilesSkipped = _filesSkipped.load(std::memory_order_relaxed);
+    stats.FilesMissing = _filesMissing.load(std::memory_order_relaxed);
+    stats.HashedSizeInBytes = _hashedSizeInBytes.load(std::memory_order_relaxed);
+
+    return stats;
+}
+//----------------------------------------------------------------------------
+void FFileStatCache::ResetStatistics() NOEXCEPT {
+    _filesHashed.store(0, std::memory_order_relaxed);
+    _filesSkipped.store(0, std::memory_order_relaxed);
+    _filesMissing.store(0, std::memory_order_relaxed);
+    _hashedSizeInBytes.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+bool FFileStatCache::HashFile(FBuildFingerpint* outFingerprint, const FFilename& filename, u64 sizeInBytes) {
+    Assert(outFingerprint);
+
+    const EAccessPolicy policy = (EAccessPolicy::ShareRead | EAccessPolicy::Random);
+
+    // small files are hashed in a single chunk, without any task
+    if (sizeInBytes <= ChunkSizeInBytes) {
+        const UStreamReader reader = VFS_OpenBinaryReadable(filename, policy);
+        if (not reader or checked_cast<u64>(reader->SizeInBytes()) != sizeInBytes)
+            return false;
+
+        RAWSTORAGE(BuildGraph, u8) buffer;
+        buffer.Resize_DiscardData(checked_cast<size_t>(sizeInBytes));
+        return HashChunk_(outFingerprint, *reader, buffer.MakeView(), 0);
+    }
+
+    // large files are streamed by chunks, each chunk is read and hashed by a different worker:
+    // the fingerprint hashes the chunk hashes, so it doesn't depend on the number of workers
+    const size_t numChunks = checked_cast<size_t>((sizeInBytes + ChunkSizeInBytes - 1) / ChunkSizeInBytes);
+
+    VECTOR(BuildGraph, u128) chunkHashes;
+    chunkHashes.resize_AssumeEmpty(numChunks);
+
+    std::atomic<bool> succeed{ true };
+    ParallelFor(0, numChunks, [&](size_t chunk) {
+        const UStreamReader reader = VFS_OpenBinaryReadable(filename, policy);
+        if (not reader or checked_cast<u64>(reader->SizeInBytes()) != sizeInBytes) {
+            succeed.store(false, std::memory_order_relaxed);
+            return;
+        }
+
+        const u64 offset = (chunk * ChunkSizeInBytes);
+
+        RAWSTORAGE(BuildGraph, u8) buffer;
+        buffer.Resize_DiscardData(checked_cast<size_t>(Min(u64(ChunkSizeInBytes), sizeInBytes - offset)));
+
+        if (not HashChunk_(&chunkHashes[chunk], *reader, buffer.MakeView(), checked_cast<std::streamoff>(offset)))
+            succeed.store(false, std::memory_order_relaxed);
+    });
+
+    if (not succeed.load(std::memory_order_relaxed))
+        return false;
+
+    *outFingerprint = hash_128(chunkHashes.data(), chunkHashes.size() * sizeof(u128), sizeInBytes);
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
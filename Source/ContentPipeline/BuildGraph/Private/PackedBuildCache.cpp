@@ -0,0 +1,773 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "PackedBuildCache.h"
+
+#include "Container/RawStorage.h"
+#include "Diagnostic/Logger.h"
+#include "IO/Extname.h"
+#include "IO/FileSystemProperties.h"
+#include "IO/Format.h"
+#include "IO/FormatHelpers.h"
+#include "IO/StringView.h"
+#include "IO/TextWriter.h"
+#include "Memory/HashFunctions.h"
+#include "Memory/MemoryProvider.h"
+#include "Memory/MemoryStream.h"
+#include "Memory/SharedBuffer.h"
+#include "Misc/FourCC.h"
+#include "Time/Timepoint.h"
+#include "VirtualFileSystem_fwd.h"
+
+#include <algorithm>
+
+namespace PPE {
+namespace ContentPipeline {
+EXTERN_LOG_CATEGORY(PPE_BUILDGRAPH_API, BuildGraph)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+#define PPE_PACKEDCACHE_PACK_EXTNAME L".pack"
+#define PPE_PACKEDCACHE_INDEX_EXTNAME L".pidx"
+//----------------------------------------------------------------------------
+static const FFourCC RECORD_MAGIC_  ("PBCR");
+static const FFourCC INDEX_MAGIC_   ("PBCI");
+static const FFourCC INDEX_VERSION_ ("1.00");
+//----------------------------------------------------------------------------
+STATIC_CONST_INTEGRAL(u32, RecordCompressed_, 1u << 0);
+//----------------------------------------------------------------------------
+// prepended to each entry in the packs, so the index can be rebuilt from the packs alone
+struct FRecordHeader_ {
+    FFourCC Magic;
+    u32 Flags;
+    u32 PayloadSizeInBytes;
+    u32 RawSizeInBytes;
+    FBuildFingerpint Fingerprint;
+    u64 PayloadChecksum;
+};
+STATIC_ASSERT(Meta::is_pod_v<FRecordHeader_>);
+//----------------------------------------------------------------------------
+// index snapshot: header, then the pack table, then the entries
+struct FIndexHeader_ {
+    FFourCC Magic;
+    FFourCC Version;
+    u64 Generation;
+    u32 AccessTick;
+    u32 NextPack;
+    u32 NumPacks;
+    u32 _Padding;
+    u64 NumEntries;
+    u64 Checksum;
+};
+STATIC_ASSERT(Meta::is_pod_v<FIndexHeader_>);
+//----------------------------------------------------------------------------
+struct FIndexPack_ {
+    u32 Id;
+    u32 _Padding;
+    u64 SizeInBytes;
+};
+STATIC_ASSERT(Meta::is_pod_v<FIndexPack_>);
+//----------------------------------------------------------------------------
+struct FIndexEntry_ {
+    FBuildFingerpint Fingerprint;
+    u64 Offset;
+    u32 Pack;
+    u32 SizeInBytes;
+    u32 LastAccess;
+    u32 _Padding;
+};
+STATIC_ASSERT(Meta::is_pod_v<FIndexEntry_>);
+//----------------------------------------------------------------------------
+NODISCARD static u64 RecordChecksum_(const FBuildFingerpint& fingerprint, const FRawMemoryConst& payload) {
+    return hash_mem64(payload.Pointer(), payload.SizeInBytes(), fingerprint.lo);
+}
+//----------------------------------------------------------------------------
+// rejects truncated or corrupted records, writes are not atomic
+NODISCARD static bool ReadRecord_(FRecordHeader_* outHeader, FRawMemoryConst* outPayload, const FRawMemoryConst& data) {
+    FMemoryViewReader reader{ data };
+    if (not reader.ReadPOD(outHeader) or
+        outHeader->Magic != RECORD_MAGIC_ or
+        outHeader->PayloadSizeInBytes > data.SizeInBytes() - sizeof(FRecordHeader_) )
+        return false;
+
+    *outPayload = data.SubRange(sizeof(FRecordHeader_), outHeader->PayloadSizeInBytes);
+    return (RecordChecksum_(outHeader->Fingerprint, *outPayload) == outHeader->PayloadChecksum);
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool ReadIndexHeader_(FIndexHeader_* outHeader, const FRawMemoryConst& content) {
+    FMemoryViewReader reader{ content };
+    if (not reader.ReadPOD(outHeader) or
+        outHeader->Magic != INDEX_MAGIC_ or
+        outHeader->Version != INDEX_VERSION_ )
+        return false;
+
+    const FRawMemoryConst body = content.CutStartingAt(sizeof(FIndexHeader_));
+    if (body.SizeInBytes() != outHeader->NumPacks * sizeof(FIndexPack_) + outHeader->NumEntries * sizeof(FIndexEntry_))
+        return false;
+
+    return (hash_mem64(body.Pointer(), body.SizeInBytes()) == outHeader->Checksum);
+}
+//----------------------------------------------------------------------------
+template <typename _Packs>
+NODISCARD static auto FindPack_(_Packs& packs, u32 id) {
+    const auto it = std::lower_bound(packs.begin(), packs.end(), id,
+        [](const auto& pack, u32 value) { return (pack.Id < value); });
+    return ((packs.end() != it and it->Id == id) ? it : packs.end());
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FPackedBuildCache::FPackedBuildCache(const FDirpath& path, bool writable, const FOptions& options)
+:   _path(path)
+,   _options(options)
+,   _writable(writable) {
+    Assert_NoAssume(_options.MaxPackSizeInBytes > sizeof(FRecordHeader_));
+    Assert_NoAssume(_options.CompactionRatio >= 0.f and _options.CompactionRatio <= 1.f);
+
+    Open_();
+}
+//----------------------------------------------------------------------------
+FPackedBuildCache::~FPackedBuildCache() {
+    if (_writable) {
+        const FReadWriteLock::FScopeLockWrite maintenanceLock(_maintenanceRW);
+        const auto exclusivePacks = _packs.LockExclusive();
+
+        exclusivePacks->Writer.reset();
+        Unused(Flush_(*exclusivePacks));
+    }
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::Initialize(const FTimestamp& buildTime) {
+    Unused(buildTime); // ticks are ordered even when the clock is not
+    _accessTick.fetch_add(1, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+UStreamReader FPackedBuildCache::Read(FBuildFingerpint fingerprint) {
+    const FReadWriteLock::FScopeLockRead maintenanceLock(_maintenanceRW);
+
+    FLocation location;
+    if (not Find_(&location, fingerprint)) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return UStreamReader{};
+    }
+
+    // only the first access of each tick needs to lock the shard for writing
+    if (location.LastAccess != _accessTick.load(std::memory_order_relaxed))
+        Touch_(fingerprint);
+
+    RAWSTORAGE(BuildGraph, u8) content;
+    content.Resize_DiscardData(location.SizeInBytes);
+
+    bool succeed = false;
+    if (UStreamReader pack = VFS_OpenBinaryReadable(PackFilename_(location.Pack), EAccessPolicy::ShareRead | EAccessPolicy::Random)) {
+        const std::streamoff offset = checked_cast<std::streamoff>(location.Offset);
+        succeed = (pack->SeekI(offset) == offset and pack->Read(content.data(), content.SizeInBytes()));
+    }
+
+    FRecordHeader_ header;
+    FRawMemoryConst payload;
+    if (succeed)
+        succeed = (ReadRecord_(&header, &payload, content.MakeConstView()) and header.Fingerprint == fingerprint);
+
+    RAWSTORAGE(BuildGraph, u8) rawdata;
+    if (succeed) {
+        if (header.Flags & RecordCompressed_) {
+            succeed = Compression::DecompressMemory(rawdata, payload);
+        }
+        else {
+            rawdata.Resize_DiscardData(payload.size());
+            payload.CopyTo(rawdata.MakeView());
+        }
+
+        succeed &= (rawdata.SizeInBytes() == header.RawSizeInBytes);
+    }
+
+    if (not succeed) {
+        PPE_LOG(BuildGraph, Warning, "forget corrupted build cache entry {0:#16x}-{1:#16x} in pack {2:#8x}",
+            fingerprint.lo, fingerprint.hi, location.Pack );
+
+        Forget_(fingerprint, location);
+        _corruptedEntries.fetch_add(1, std::memory_order_relaxed);
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return UStreamReader{};
+    }
+
+    _hits.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t sizeInBytes = rawdata.SizeInBytes();
+    return MakeUnique<MEMORYSTREAM(BuildGraph)>(std::move(rawdata), checked_cast<std::streamsize>(sizeInBytes));
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::Write(FBuildFingerpint fingerprint, const FRawMemoryConst& rawdata) {
+    if (not _writable)
+        return false;
+
+    const FReadWriteLock::FScopeLockRead maintenanceLock(_maintenanceRW);
+
+    // content-addressed: the record already stored holds the same data
+    FLocation location;
+    if (Find_(&location, fingerprint)) {
+        if (location.LastAccess != _accessTick.load(std::memory_order_relaxed))
+            Touch_(fingerprint);
+
+        _duplicates.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // the record is compressed outside of the locks
+    FRecordHeader_ header{};
+    header.Magic = RECORD_MAGIC_;
+    header.RawSizeInBytes = checked_cast<u32>(rawdata.SizeInBytes());
+    header.Fingerprint = fingerprint;
+
+    RAWSTORAGE(BuildGraph, u8) record;
+    size_t payloadSizeInBytes = 0;
+
+    if (_options.Compress and rawdata.SizeInBytes() >= _options.MinCompressSizeInBytes) {
+        record.Resize_DiscardData(sizeof(FRecordHeader_) + Compression::CompressedSizeUpperBound(rawdata.SizeInBytes()));
+        payloadSizeInBytes = Compression::CompressMemory(record.MakeView().CutStartingAt(sizeof(FRecordHeader_)), rawdata, _options.CompressMethod);
+
+        // keep incompressible data as is
+        if (payloadSizeInBytes < rawdata.SizeInBytes())
+            header.Flags |= RecordCompressed_;
+    }
+
+    if (not (header.Flags & RecordCompressed_)) {
+        record.Resize_DiscardData(sizeof(FRecordHeader_) + rawdata.SizeInBytes());
+        rawdata.CopyTo(record.MakeView().CutStartingAt(sizeof(FRecordHeader_)));
+        payloadSizeInBytes = rawdata.SizeInBytes();
+    }
+
+    header.PayloadSizeInBytes = checked_cast<u32>(payloadSizeInBytes);
+    header.PayloadChecksum = RecordChecksum_(fingerprint, record.MakeConstView().SubRange(sizeof(FRecordHeader_), payloadSizeInBytes));
+    MakeRawView(&header, sizeof(header)).CopyTo(record.MakeView().CutBefore(sizeof(FRecordHeader_)));
+
+    {
+        const auto exclusivePacks = _packs.LockExclusive();
+        if (not Append_(&location, *exclusivePacks, record.MakeConstView().CutBefore(sizeof(FRecordHeader_) + payloadSizeInBytes)))
+            return false;
+    }
+
+    location.LastAccess = _accessTick.load(std::memory_order_relaxed);
+
+    bool inserted;
+    {
+        const auto exclusiveShard = _shards[ShardIndex_(fingerprint)].LockExclusive();
+        inserted = exclusiveShard->try_emplace(fingerprint, location).second;
+    }
+
+    // a concurrent writer of the same entry won the race: our record is dead and reclaimed by Cleanup()
+    (inserted ? _writes : _duplicates).fetch_add(1, std::memory_order_relaxed);
+    _dirty.store(true, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::Cleanup() {
+    if (not _writable)
+        return;
+
+    const FTimepoint startedAt = FTimepoint::Now();
+
+    const FReadWriteLock::FScopeLockWrite maintenanceLock(_maintenanceRW);
+    const auto exclusivePacks = _packs.LockExclusive();
+
+    const size_t numPacksBefore = exclusivePacks->Packs.size();
+    const u64 compactedBefore = _compactedSizeInBytes.load(std::memory_order_relaxed);
+
+    const size_t numEvicted = EvictEntries_();
+    CompactPacks_(*exclusivePacks);
+
+    if (not Flush_(*exclusivePacks))
+        PPE_LOG(BuildGraph, Error, "failed to save build cache index in <{0}>", _path);
+
+    PPE_LOG(BuildGraph, Info, "build cache cleanup: evicted {0} entries, compacted {1}, {2} -> {3} packs in {4}",
+        numEvicted,
+        Fmt::SizeInBytes(_compactedSizeInBytes.load(std::memory_order_relaxed) - compactedBefore),
+        numPacksBefore, exclusivePacks->Packs.size(),
+        Fmt::DurationInMs(FTimepoint::ElapsedSince(startedAt)) );
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::Contains(FBuildFingerpint fingerprint) const {
+    FLocation location;
+    return Find_(&location, fingerprint);
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::Flush() {
+    if (not _writable)
+        return false;
+
+    const FReadWriteLock::FScopeLockWrite maintenanceLock(_maintenanceRW);
+    const auto exclusivePacks = _packs.LockExclusive();
+
+    return Flush_(*exclusivePacks);
+}
+//----------------------------------------------------------------------------
+auto FPackedBuildCache::Statistics() const -> FStatistics {
+    FStatistics stats;
+
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        stats.NumEntries += sharedShard->size();
+        for (const auto& it : *sharedShard)
+            stats.LiveSizeInBytes += it.second.SizeInBytes;
+    }
+
+    {
+        const auto sharedPacks = _packs.LockShared();
+        stats.NumPacks = sharedPacks->Packs.size();
+        for (const FPack& pack : sharedPacks->Packs)
+            stats.PackSizeInBytes += pack.SizeInBytes;
+    }
+
+    stats.Hits = _hits.load(std::memory_order_relaxed);
+    stats.Misses = _misses.load(std::memory_order_relaxed);
+    stats.Writes = _writes.load(std::memory_order_relaxed);
+    stats.Duplicates = _duplicates.load(std::memory_order_relaxed);
+    stats.Evictions = _evictions.load(std::memory_order_relaxed);
+    stats.CorruptedEntries = _corruptedEntries.load(std::memory_order_relaxed);
+    stats.RecoveredEntries = _recoveredEntries.load(std::memory_order_relaxed);
+    stats.CompactedSizeInBytes = _compactedSizeInBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+//----------------------------------------------------------------------------
+FFilename FPackedBuildCache::PackFilename_(u32 pack) const {
+    wchar_t tmp[20];
+    FWFixedSizeTextWriter oss(tmp);
+    Format(oss, L"{0:#8x}", pack);
+
+    return FFilename(_path, FBasenameNoExt{ oss.Written() }, FExtname{ MakeStringView(PPE_PACKEDCACHE_PACK_EXTNAME) });
+}
+//----------------------------------------------------------------------------
+FFilename FPackedBuildCache::IndexFilename_(u32 slot) const {
+    Assert(slot < 2);
+
+    wchar_t tmp[20];
+    FWFixedSizeTextWriter oss(tmp);
+    Format(oss, L"index-{0}", slot);
+
+    return FFilename(_path, FBasenameNoExt{ oss.Written() }, FExtname{ MakeStringView(PPE_PACKEDCACHE_INDEX_EXTNAME) });
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::Find_(FLocation* outLocation, const FBuildFingerpint& fingerprint) const {
+    Assert(outLocation);
+
+    const auto sharedShard = _shards[ShardIndex_(fingerprint)].LockShared();
+    const auto it = sharedShard->find(fingerprint);
+    if (sharedShard->end() == it)
+        return false;
+
+    *outLocation = it->second;
+    return true;
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::Touch_(const FBuildFingerpint& fingerprint) {
+    const auto exclusiveShard = _shards[ShardIndex_(fingerprint)].LockExclusive();
+    const auto it = exclusiveShard->find(fingerprint);
+    if (exclusiveShard->end() != it) {
+        it->second.LastAccess = _accessTick.load(std::memory_order_relaxed);
+        _dirty.store(true, std::memory_order_relaxed);
+    }
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::Forget_(const FBuildFingerpint& fingerprint, const FLocation& location) {
+    const auto exclusiveShard = _shards[ShardIndex_(fingerprint)].LockExclusive();
+    const auto it = exclusiveShard->find(fingerprint);
+    if (exclusiveShard->end() != it and it->second.Pack == location.Pack and it->second.Offset == location.Offset) {
+        exclusiveShard->erase(it);
+        _dirty.store(true, std::memory_order_relaxed);
+    }
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::Append_(FLocation* outLocation, FPackTable& packs, const FRawMemoryConst& record) {
+    Assert(outLocation);
+    Assert(_writable);
+
+    if (packs.Writer and packs.Packs.back().SizeInBytes + record.SizeInBytes() > _options.MaxPackSizeInBytes)
+        packs.Writer.reset(); // seal the current pack
+
+    if (not packs.Writer) {
+        const u32 id = packs.NextId++;
+        packs.Writer = VFS_OpenBinaryWritable(PackFilename_(id), EAccessPolicy::Truncate_Binary | EAccessPolicy::ShareRead);
+        if (not packs.Writer) {
+            PPE_LOG(BuildGraph, Error, "failed to create build cache pack <{0}>", PackFilename_(id));
+            return false;
+        }
+
+        packs.Packs.push_back(FPack{ id, 0 });
+    }
+
+    FPack& pack = packs.Packs.back();
+
+    if (not packs.Writer->Write(record.Pointer(), checked_cast<std::streamsize>(record.SizeInBytes()))) {
+        // the torn record will be rejected when opening, never append after it
+        packs.Writer.reset();
+        return false;
+    }
+
+    // readers open the pack with their own handle
+    if (IBufferedStreamWriter* const buffered = packs.Writer->ToBufferedO())
+        buffered->Flush();
+
+    outLocation->Offset = pack.SizeInBytes;
+    outLocation->Pack = pack.Id;
+    outLocation->SizeInBytes = checked_cast<u32>(record.SizeInBytes());
+
+    pack.SizeInBytes += record.SizeInBytes();
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::Flush_(FPackTable& packs) {
+    Assert(_writable);
+
+    if (not _dirty.load(std::memory_order_relaxed))
+        return true;
+
+    size_t numEntries = 0;
+    for (const auto& shard : _shards)
+        numEntries += shard.LockShared()->size();
+
+    MEMORYSTREAM(BuildGraph) content;
+    content.reserve(sizeof(FIndexHeader_) + packs.Packs.size() * sizeof(FIndexPack_) + numEntries * sizeof(FIndexEntry_));
+    content.WritePOD(FIndexHeader_{}); // patched below, once the checksum is known
+
+    for (const FPack& pack : packs.Packs)
+        content.WritePOD(FIndexPack_{ pack.Id, 0, pack.SizeInBytes });
+
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        for (const auto& it : *sharedShard)
+            content.WritePOD(FIndexEntry_{ it.first, it.second.Offset, it.second.Pack, it.second.SizeInBytes, it.second.LastAccess, 0 });
+    }
+
+    const FRawMemoryConst body = content.MakeView().CutStartingAt(sizeof(FIndexHeader_));
+
+    FIndexHeader_ header{};
+    header.Magic = INDEX_MAGIC_;
+    header.Version = INDEX_VERSION_;
+    header.Generation = (_indexGeneration + 1);
+    header.AccessTick = _accessTick.load(std::memory_order_relaxed);
+    header.NextPack = packs.NextId;
+    header.NumPacks = checked_cast<u32>(packs.Packs.size());
+    header.NumEntries = numEntries;
+    header.Checksum = hash_mem64(body.Pointer(), body.SizeInBytes());
+    MakeRawView(&header, sizeof(header)).CopyTo(content.MakeView().CutBefore(sizeof(FIndexHeader_)));
+
+    // never overwrite the last valid snapshot
+    if (not VFS_WriteAll(IndexFilename_(header.Generation % 2), content.MakeView(), EAccessPolicy::Truncate_Binary))
+        return false;
+
+    _indexGeneration = header.Generation;
+    _dirty.store(false, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::Open_() {
+    const FTimepoint startedAt = FTimepoint::Now();
+
+    if (_writable and not VFS_CreateDirectory(_path))
+        PPE_LOG(BuildGraph, Error, "failed to create build cache directory <{0}>", _path);
+
+    // no concurrent access while opening
+    FPackTable& packs = _packs.Value_Unsafe();
+
+    if (not LoadIndex_(packs))
+        PPE_LOG(BuildGraph, Warning, "no valid build cache index in <{0}>, rebuilding from the packs", _path);
+
+    RecoverPacks_(packs);
+
+    // new entries are more recent than everything loaded
+    _accessTick.fetch_add(1, std::memory_order_relaxed);
+
+    PPE_LOG(BuildGraph, Info, "opened build cache <{0}> with {1} entries in {2} packs ({3} recovered) in {4}",
+        _path,
+        Statistics().NumEntries,
+        packs.Packs.size(),
+        _recoveredEntries.load(std::memory_order_relaxed),
+        Fmt::DurationInMs(FTimepoint::ElapsedSince(startedAt)) );
+}
+//----------------------------------------------------------------------------
+bool FPackedBuildCache::LoadIndex_(FPackTable& packs) {
+    FUniqueBuffer snapshot;
+    FIndexHeader_ header{};
+
+    forrange(slot, 0, 2) {
+        FUniqueBuffer content = VFS_ReadAll(IndexFilename_(slot), EAccessPolicy::Binary | EAccessPolicy::ShareRead);
+
+        FIndexHeader_ candidate;
+        if (not content or not ReadIndexHeader_(&candidate, content.MakeView()))
+            continue;
+
+        if (not snapshot or candidate.Generation > header.Generation) {
+            header = candidate;
+            snapshot = std::move(content);
+        }
+    }
+
+    if (not snapshot)
+        return false;
+
+    const FRawMemoryConst body = snapshot.MakeView().CutStartingAt(sizeof(FIndexHeader_));
+    const size_t packsSizeInBytes = (header.NumPacks * sizeof(FIndexPack_));
+    const TMemoryView<const FIndexPack_> indexPacks = body.CutBefore(packsSizeInBytes).Cast<const FIndexPack_>();
+    const TMemoryView<const FIndexEntry_> indexEntries = body.CutStartingAt(packsSizeInBytes).Cast<const FIndexEntry_>();
+
+    _indexGeneration = header.Generation;
+    _accessTick.store(header.AccessTick, std::memory_order_relaxed);
+
+    packs.NextId = header.NextPack;
+    packs.Packs.reserve(indexPacks.size());
+    for (const FIndexPack_& pack : indexPacks)
+        packs.Packs.push_back(FPack{ pack.Id, pack.SizeInBytes });
+
+    for (auto& shard : _shards)
+        shard.Value_Unsafe().reserve(indexEntries.size() / NumShards);
+
+    for (const FIndexEntry_& entry : indexEntries) {
+        Unused(_shards[ShardIndex_(entry.Fingerprint)].Value_Unsafe().try_emplace(entry.Fingerprint,
+            FLocation{ entry.Offset, entry.Pack, entry.SizeInBytes, entry.LastAccess }));
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::RecoverPacks_(FPackTable& packs) {
+    // the packs on disk are authoritative: the snapshot can miss packs created after, or list deleted ones
+    VECTOR(BuildGraph, FPack) onDisk;
+    VFS_GlobFiles(_path, L"*" PPE_PACKEDCACHE_PACK_EXTNAME, false, [&onDisk](const FFilename& fname) {
+        u32 id;
+        FFileStat stat;
+        if (Atoi(&id, fname.BasenameNoExt().MakeView(), 16) and VFS_FileStats(&stat, fname))
+            onDisk.push_back(FPack{ id, stat.SizeInBytes });
+    });
+
+    std::sort(onDisk.begin(), onDisk.end(), [](const FPack& lhs, const FPack& rhs) {
+        return (lhs.Id < rhs.Id);
+    });
+
+    // forget the entries stored in packs which were removed or truncated
+    size_t numLost = 0;
+    for (auto& shard : _shards) {
+        FIndex& index = shard.Value_Unsafe();
+        for (auto it = index.begin(); it != index.end(); ) {
+            const auto pack = FindPack_(onDisk, it->second.Pack);
+            if (onDisk.end() == pack or it->second.Offset + it->second.SizeInBytes > pack->SizeInBytes) {
+                it = index.erase_ReturnNext(it);
+                ++numLost;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    // scan the records appended after the snapshot, until the first torn record
+    const u32 accessTick = _accessTick.load(std::memory_order_relaxed);
+    size_t numRecovered = 0;
+    bool packsChanged = (onDisk.size() != packs.Packs.size());
+
+    for (FPack& disk : onDisk) {
+        u64 validSize = 0;
+        const auto snapshot = FindPack_(packs.Packs, disk.Id);
+        if (packs.Packs.end() != snapshot)
+            validSize = Min(snapshot->SizeInBytes, disk.SizeInBytes);
+        else
+            packsChanged = true;
+
+        if (disk.SizeInBytes > validSize) {
+            const FUniqueBuffer content = VFS_ReadAll(PackFilename_(disk.Id), EAccessPolicy::Binary | EAccessPolicy::ShareRead);
+            const FRawMemoryConst data = content.MakeView();
+
+            FRecordHeader_ header;
+            FRawMemoryConst payload;
+            while (validSize < data.SizeInBytes() and
+                ReadRecord_(&header, &payload, data.CutStartingAt(checked_cast<size_t>(validSize))) ) {
+                const u32 recordSize = checked_cast<u32>(sizeof(FRecordHeader_) + header.PayloadSizeInBytes);
+
+                if (_shards[ShardIndex_(header.Fingerprint)].Value_Unsafe().try_emplace(header.Fingerprint,
+                        FLocation{ validSize, disk.Id, recordSize, accessTick }).second)
+                    ++numRecovered;
+
+                validSize += recordSize;
+            }
+
+            if (validSize < disk.SizeInBytes)
+                PPE_LOG(BuildGraph, Warning, "ignoring {0} torn at the end of build cache pack <{1}>",
+                    Fmt::SizeInBytes(disk.SizeInBytes - validSize), PackFilename_(disk.Id) );
+
+            packsChanged = true;
+        }
+
+        disk.SizeInBytes = validSize;
+        packs.NextId = Max(packs.NextId, disk.Id + 1);
+    }
+
+    packs.Packs = std::move(onDisk);
+
+    _recoveredEntries.fetch_add(numRecovered, std::memory_order_relaxed);
+    if (numLost or numRecovered or packsChanged)
+        _dirty.store(true, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+size_t FPackedBuildCache::EvictEntries_() {
+    struct FCandidate {
+        FBuildFingerpint Fingerprint;
+        FLocation Location;
+    };
+
+    VECTOR(BuildGraph, FCandidate) candidates;
+    u64 liveSizeInBytes = 0;
+
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        candidates.reserve_Additional(sharedShard->size());
+        for (const auto& it : *sharedShard) {
+            candidates.push_back(FCandidate{ it.first, it.second });
+            liveSizeInBytes += it.second.SizeInBytes;
+        }
+    }
+
+    if (liveSizeInBytes <= _options.MaxSizeInBytes)
+        return 0;
+
+    // least recently used first, then in pack order so evictions tend to empty whole packs
+    std::sort(candidates.begin(), candidates.end(), [](const FCandidate& lhs, const FCandidate& rhs) {
+        if (lhs.Location.LastAccess != rhs.Location.LastAccess)
+            return (lhs.Location.LastAccess < rhs.Location.LastAccess);
+        if (lhs.Location.Pack != rhs.Location.Pack)
+            return (lhs.Location.Pack < rhs.Location.Pack);
+        return (lhs.Location.Offset < rhs.Location.Offset);
+    });
+
+    size_t numEvicted = 0;
+    for (const FCandidate& candidate : candidates) {
+        if (liveSizeInBytes <= _options.MaxSizeInBytes)
+            break;
+
+        Verify(_shards[ShardIndex_(candidate.Fingerprint)].LockExclusive()->erase(candidate.Fingerprint));
+        liveSizeInBytes -= candidate.Location.SizeInBytes;
+        ++numEvicted;
+    }
+
+    _evictions.fetch_add(numEvicted, std::memory_order_relaxed);
+    _dirty.store(true, std::memory_order_relaxed);
+    return numEvicted;
+}
+//----------------------------------------------------------------------------
+void FPackedBuildCache::CompactPacks_(FPackTable& packs) {
+    VECTOR(BuildGraph, u64) liveSizes;
+    liveSizes.resize(packs.Packs.size(), 0);
+
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        for (const auto& it : *sharedShard) {
+            const auto pack = FindPack_(packs.Packs, it.second.Pack);
+            Assert(packs.Packs.end() != pack);
+            liveSizes[std::distance(packs.Packs.begin(), pack)] += it.second.SizeInBytes;
+        }
+    }
+
+    // the pack opened for writing is never compacted
+    const u32 activePack = (packs.Writer ? packs.Packs.back().Id : static_cast<u32>(UMax));
+
+    VECTOR(BuildGraph, u32) sparsePacks;
+    forrange(i, 0, packs.Packs.size()) {
+        const FPack& pack = packs.Packs[i];
+        if (pack.Id != activePack and (0 == liveSizes[i] or liveSizes[i] < pack.SizeInBytes * static_cast<double>(_options.CompactionRatio)))
+            sparsePacks.push_back(pack.Id);
+    }
+
+    if (sparsePacks.empty())
+        return;
+
+    struct FMove {
+        FBuildFingerpint Fingerprint;
+        FLocation Location;
+    };
+
+    VECTOR(BuildGraph, FMove) moves;
+    for (const auto& shard : _shards) {
+        const auto sharedShard = shard.LockShared();
+        for (const auto& it : *sharedShard) {
+            if (std::binary_search(sparsePacks.begin(), sparsePacks.end(), it.second.Pack))
+                moves.push_back(FMove{ it.first, it.second });
+        }
+    }
+
+    // read each sparse pack once, sequentially
+    std::sort(moves.begin(), moves.end(), [](const FMove& lhs, const FMove& rhs) {
+        return (lhs.Location.Pack != rhs.Location.Pack
+            ? lhs.Location.Pack < rhs.Location.Pack
+            : lhs.Location.Offset < rhs.Location.Offset );
+    });
+
+    VECTOR(BuildGraph, u32) removedPacks;
+    auto move = moves.begin();
+
+    for (const u32 id : sparsePacks) {
+        FUniqueBuffer content;
+        if (moves.end() != move and move->Location.Pack == id)
+            content = VFS_ReadAll(PackFilename_(id), EAccessPolicy::Binary | EAccessPolicy::ShareRead);
+
+        bool relocatedAll = true;
+        for (; moves.end() != move and move->Location.Pack == id; ++move) {
+            const FLocation& location = move->Location;
+
+            FRecordHeader_ header;
+            FRawMemoryConst payload;
+            if (not content or
+                location.Offset + location.SizeInBytes > content.SizeInBytes() or
+                not ReadRecord_(&header, &payload, content.MakeView().SubRange(checked_cast<size_t>(location.Offset), location.SizeInBytes)) or
+                header.Fingerprint != move->Fingerprint ) {
+                Forget_(move->Fingerprint, location);
+                _corruptedEntries.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // records are copied as is, without decompressing them
+            FLocation relocated;
+            if (not Append_(&relocated, packs, content.MakeView().SubRange(checked_cast<size_t>(location.Offset), location.SizeInBytes))) {
+                relocatedAll = false; // keep the pack, the entry is still valid there
+                continue;
+            }
+
+            relocated.LastAccess = location.LastAccess;
+            _shards[ShardIndex_(move->Fingerprint)].LockExclusive()->insert_or_assign(move->Fingerprint, relocated);
+            _compactedSizeInBytes.fetch_add(location.SizeInBytes, std::memory_order_relaxed);
+        }
+
+        if (relocatedAll)
+            removedPacks.push_back(id);
+    }
+
+    if (removedPacks.empty())
+        return;
+
+    // packs are deleted before saving the index: when interrupted, the relocated entries are recovered from the tail of the current pack
+    for (const u32 id : removedPacks) {
+        if (not VFS_RemoveFile(PackFilename_(id)))
+            PPE_LOG(BuildGraph, Warning, "failed to remove build cache pack <{0}>", PackFilename_(id));
+    }
+
+    packs.Packs.erase(std::remove_if(packs.Packs.begin(), packs.Packs.end(), [&removedPacks](const FPack& pack) {
+        return std::binary_search(removedPacks.begin(), removedPacks.end(), pack.Id);
+    }), packs.Packs.end());
+
+    _dirty.store(true, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+#undef PPE_PACKEDCACHE_INDEX_EXTNAME
+#undef PPE_PACKEDCACHE_PACK_EXTNAME
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+UBuildCache MakePackedBuildCache(const FDirpath& path, bool writable, const FPackedBuildCacheOptions& options) {
+    return MakeUnique<FPackedBuildCache>(path, writable, options);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
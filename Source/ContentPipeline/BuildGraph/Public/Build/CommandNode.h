@@ -49,6 +49,9 @@ public: // FBuildNode:
     virtual EBuildResult Process(FBuildContext& ctx) override;
     virtual EBuildResult Clean(FCleanContext& ctx) override;
 
+    // runs an external process
+    virtual EBuildResourceClass ResourceClass() const override { return EBuildResourceClass::CpuHeavy; }
+
 protected:
     void SetInput(FBuildNode* input) NOEXCEPT;
     void SetExecutable(
@@ -57,6 +60,9 @@ protected:
         FParameters&& parameters) NOEXCEPT;
 
 private:
+    // persistent worker process, outputs are streamed back into the build cache
+    EBuildResult ProcessInWorker_(FBuildContext& ctx, FBuildWorkerFarm& farm);
+
     PBuildNode _input;
     FFilename _executable;
     FDirpath _workingDir;
@@ -35,6 +35,9 @@ public: // FBuildNode:
     virtual EBuildResult Process(FBuildContext& ctx) override;
     virtual EBuildResult Clean(FCleanContext& ctx) override;
 
+    virtual FWString BuildName() const override;
+    virtual EBuildResourceClass ResourceClass() const override { return EBuildResourceClass::IoHeavy; }
+
 protected:
     void SetPath(const FDirpath& path) NOEXCEPT;
     void SetPattern(FWString&& pattern) NOEXCEPT;
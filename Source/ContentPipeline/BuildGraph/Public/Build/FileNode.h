@@ -23,6 +23,7 @@ public:
 
     const FFilename& Filename() const { return _filename; }
     FTimestamp Timestamp() const { return _timestamp; }
+    const FBuildFingerpint& Fingerprint() const { return _fingerprint; }
 
 #ifdef WITH_RTTI_VERIFY_PREDICATES
     virtual void RTTI_VerifyPredicates() const PPE_THROW() override;
@@ -34,12 +35,16 @@ public: // FBuildNode:
     virtual EBuildResult Process(FBuildContext& ctx) override;
     virtual EBuildResult Clean(FCleanContext& ctx) override;
 
+    virtual FWString BuildName() const override;
+    virtual EBuildResourceClass ResourceClass() const override { return EBuildResourceClass::IoHeavy; }
+
 protected:
     void SetFilename(const FFilename& filename) NOEXCEPT;
 
 private:
     FFilename _filename;
     FTimestamp _timestamp;
+    FBuildFingerpint _fingerprint{ FBuildFingerpint::Zero() }; // content hash, decides if the file changed
 };
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
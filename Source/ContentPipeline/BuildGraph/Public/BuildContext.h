@@ -33,6 +33,8 @@ public:
 
     IBuildCache& Cache() const NOEXCEPT;
     IBuildLog& Log() const NOEXCEPT;
+    FFileStatCache& StatCache() const NOEXCEPT;
+    FBuildWorkerFarm* WorkerFarm(const FFilename& executable) const NOEXCEPT;
 
     bool HasRebuild() const { return (_flags & EBuildFlags::Rebuild); }
     bool HasCacheRead() const { return (_flags & EBuildFlags::CacheRead); }
@@ -47,6 +49,12 @@ public:
     size_t NumFailed() const { return _numFailed; }
     size_t NumUpToDate() const { return _numUpToDate; }
 
+    size_t NumFilesHashed() const { return _numFilesHashed; }
+    size_t NumFilesSkipped() const { return _numFilesSkipped; }
+
+    // content fingerprint through the stat cache, counts the files hashed or skipped
+    NODISCARD bool FileFingerprint(FBuildFingerpint* outFingerprint, const FFilename& filename);
+
     FDirpath MakeOutputDir(const FDirpath& relative) const NOEXCEPT;
     FFilename MakeOutputFile(const FFilename& relative) const NOEXCEPT;
 
@@ -76,6 +84,8 @@ protected:
     std::atomic<size_t> _numBuilt;
     std::atomic<size_t> _numFailed;
     std::atomic<size_t> _numUpToDate;
+    std::atomic<size_t> _numFilesHashed;
+    std::atomic<size_t> _numFilesSkipped;
 };
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -34,6 +34,25 @@ inline EBuildResult Combine(EBuildResult lhs, EBuildResult rhs) {
     return EBuildResult{ Max(int(lhs), int(rhs)) };
 }
 //----------------------------------------------------------------------------
+// Scan/Build/Clean span a whole node with its dependencies, Import/Process are the work done by the node
+enum class EBuildStep : u8 {
+    Scan        = 0,
+    Build,
+    Clean,
+    Import,
+    Process,
+};
+//----------------------------------------------------------------------------
+// the executor limits how many nodes of each class can work concurrently
+enum class EBuildResourceClass : u8 {
+    Light       = 0, // never limited
+    CpuHeavy,
+    IoHeavy,
+    MemoryHeavy,
+
+    _Count
+};
+//----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 } //!namespace ContentPipeline
@@ -49,6 +68,12 @@ PPE_BUILDGRAPH_API FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline:
 PPE_BUILDGRAPH_API FTextWriter& operator <<(FTextWriter& oss, ContentPipeline::EBuildResult result);
 PPE_BUILDGRAPH_API FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline::EBuildResult result);
 //----------------------------------------------------------------------------
+PPE_BUILDGRAPH_API FTextWriter& operator <<(FTextWriter& oss, ContentPipeline::EBuildStep step);
+PPE_BUILDGRAPH_API FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline::EBuildStep step);
+//----------------------------------------------------------------------------
+PPE_BUILDGRAPH_API FTextWriter& operator <<(FTextWriter& oss, ContentPipeline::EBuildResourceClass resource);
+PPE_BUILDGRAPH_API FWTextWriter& operator <<(FWTextWriter& oss, ContentPipeline::EBuildResourceClass resource);
+//----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 } //!namespace PPE
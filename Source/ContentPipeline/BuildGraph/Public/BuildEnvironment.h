@@ -2,8 +2,10 @@
 
 #include "BuildGraph_fwd.h"
 
+#include "Container/HashMap.h"
 #include "HAL/TargetPlatform_fwd.h"
 #include "IO/Dirpath.h"
+#include "IO/Filename.h"
 #include "IO/FileSystem_fwd.h"
 #include "RTTI/OpaqueData.h"
 
@@ -19,7 +21,14 @@ public:
         const FDirpath& outputDir,
         IBuildCache& cache,
         IBuildExecutor& executor,
-        IBuildLog& log ) NOEXCEPT;
+        IBuildLog& log ) NOEXCEPT; // uses a transient file stat cache
+    FBuildEnvironment(
+        const ITargetPlaftorm& platform,
+        const FDirpath& outputDir,
+        IBuildCache& cache,
+        IBuildExecutor& executor,
+        IBuildLog& log,
+        FFileStatCache& statCache ) NOEXCEPT;
     ~FBuildEnvironment();
 
     const ITargetPlaftorm& Platform() const { return _platform; }
@@ -28,6 +37,12 @@ public:
     IBuildCache& Cache() const { return _cache; }
     IBuildExecutor& Executor() const { return _executor; }
     IBuildLog& Log() const { return _log; }
+    FFileStatCache& StatCache() const { return _statCache; }
+
+    // command nodes run their tool in the farm registered for its executable, when there is one
+    // not thread-safe: farms must be registered before building
+    void RegisterWorkerFarm(FBuildWorkerFarm& farm);
+    FBuildWorkerFarm* WorkerFarm(const FFilename& executable) const NOEXCEPT;
 
     RTTI::FOpaqueData& OpaqueData() { return _opaqueData; }
     const RTTI::FOpaqueData& OpaqueData() const { return _opaqueData; }
@@ -43,6 +58,11 @@ private:
     IBuildExecutor& _executor;
     IBuildLog& _log;
 
+    TUniquePtr<FFileStatCache> _transientStatCache;
+    FFileStatCache& _statCache;
+
+    HASHMAP(BuildGraph, FFilename, FBuildWorkerFarm*) _workerFarms;
+
     RTTI::FOpaqueData _opaqueData;
 };
 //----------------------------------------------------------------------------
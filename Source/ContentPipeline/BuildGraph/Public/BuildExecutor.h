@@ -2,6 +2,8 @@
 
 #include "BuildGraph_fwd.h"
 
+#include "BuildEnums.h"
+
 #include "Memory/UniquePtr.h"
 #include "Thread/Task_fwd.h"
 
@@ -26,6 +28,11 @@ public:
 
     virtual void WaitForAll() = 0;
 
+    // wraps the work done by a node, but never the wait for its dependencies:
+    // the executor can limit the concurrency of each resource class and profile the work
+    using FWorkFunc = EBuildResult(*)(FPipelineContext& ctx, FBuildNode& node);
+    virtual EBuildResult Work(FPipelineContext& ctx, FBuildNode& node, EBuildStep step, FWorkFunc work) = 0;
+
 public: // helpers
     void Queue(const FScanContext& scan, const TMemoryView<const SBuildNode>& deps);
     void Queue(const FBuildContext& build, const TMemoryView<const SBuildNode>& deps);
@@ -36,7 +43,15 @@ public: // helpers
     EBuildResult QueueAndWaitFor(FCleanContext& clean, const TMemoryView<const SBuildNode>& deps);
 };
 //----------------------------------------------------------------------------
-PPE_BUILDGRAPH_API UBuildExecutor MakeParallelExecutor(FTaskManager& pool);
+struct FParallelExecutorOptions {
+    // optional, schedules the nodes by critical path and traces their work
+    FBuildProfiler* Profiler{ nullptr };
+    // max number of nodes working concurrently for each resource class, 0 for unlimited
+    // CpuHeavy nodes are limited to the number of workers when left to 0
+    u32 MaxConcurrency[static_cast<size_t>(EBuildResourceClass::_Count)]{ 0, 0, 8, 2 };
+};
+//----------------------------------------------------------------------------
+PPE_BUILDGRAPH_API UBuildExecutor MakeParallelExecutor(FTaskManager& pool, const FParallelExecutorOptions& options = {});
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
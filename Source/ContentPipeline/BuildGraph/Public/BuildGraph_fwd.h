@@ -22,11 +22,16 @@ using FBuildUniqueId = size_t;
 //----------------------------------------------------------------------------
 enum class EBuildFlags;
 enum class EBuildResult;
+enum class EBuildStep : u8;
+enum class EBuildResourceClass : u8;
 //----------------------------------------------------------------------------
 FWD_REFPTR(BuildNode);
 FWD_REFPTR(FileNode);
 //----------------------------------------------------------------------------
 class PPE_BUILDGRAPH_API FBuildEnvironment;
+class PPE_BUILDGRAPH_API FBuildProfiler;
+class PPE_BUILDGRAPH_API FBuildWorkerFarm;
+class PPE_BUILDGRAPH_API FFileStatCache;
 //----------------------------------------------------------------------------
 class PPE_BUILDGRAPH_API FPipelineContext;
     class PPE_BUILDGRAPH_API FBuildContext;
@@ -9,6 +9,7 @@
 #include "RTTI/Typedefs.h"
 
 #include "Container/Vector.h"
+#include "IO/String.h"
 #include "Memory/WeakPtr.h"
 #include "Thread/AtomicSpinLock.h"
 
@@ -52,6 +53,11 @@ public:
     virtual EBuildResult Process(FBuildContext& ctx) = 0;
     virtual EBuildResult Clean(FCleanContext& ctx) = 0;
 
+public: // scheduling and profiling
+    // identifies the node in the build history between runs, no history is kept when empty
+    virtual FWString BuildName() const;
+    virtual EBuildResourceClass ResourceClass() const { return EBuildResourceClass::Light; }
+
 protected:
     RTTI::FOpaqueData& OpaqueData() { return _opaqueData; }
 
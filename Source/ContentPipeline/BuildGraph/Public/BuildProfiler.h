@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include "BuildGraph_fwd.h"
+
+#include "BuildEnums.h"
+
+#include "Container/HashMap.h"
+#include "Container/Vector.h"
+#include "IO/Filename.h"
+#include "IO/String.h"
+#include "IO/StringView.h"
+#include "Thread/ThreadSafe.h"
+#include "Time/Time_fwd.h"
+#include "Time/Timepoint.h"
+
+#include <atomic>
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FBuildTraceEvent {
+    FWString Name;
+    FStringLiteral ClassName;
+    EBuildStep Step;
+    EBuildResourceClass Resource;
+    EBuildResult Result;
+    u32 ThreadIndex;
+    u64 StartInMicros; // relative to the profiler creation
+    u64 DurationInMicros;
+};
+//----------------------------------------------------------------------------
+// Duration history of the nodes, and trace of the build execution:
+// - the history keeps a moving average of the time spent in each node with its dependencies,
+//   which estimates the longest remaining path when the node is scheduled
+// - nodes are identified between runs by their class, build step and BuildName()
+// - the optional file keeps the history between runs, usually next to the build cache
+// - when tracing, the work done by the nodes can be exported for chrome://tracing or Perfetto
+// All methods are thread-safe, except Load().
+//----------------------------------------------------------------------------
+class PPE_BUILDGRAPH_API FBuildProfiler : Meta::FNonCopyableNorMovable {
+public:
+    STATIC_CONST_INTEGRAL(u32, NumShards, 16);
+
+    FBuildProfiler() NOEXCEPT; // memory only
+    explicit FBuildProfiler(const FFilename& historyPath); // loaded from path, if it exists
+    ~FBuildProfiler(); // flushes the history when persistent and dirty
+
+    const FFilename& HistoryPath() const { return _historyPath; }
+
+    bool Tracing() const { return _tracing.load(std::memory_order_relaxed); }
+    void SetTracing(bool enabled) { _tracing.store(enabled, std::memory_order_relaxed); }
+
+    // longest path estimated by the history since the last ResetCriticalPath()
+    NODISCARD FTimespan CriticalPath() const;
+    void ResetCriticalPath();
+
+    // returns false when the node has no history, also updates CriticalPath()
+    NODISCARD bool EstimatePath(FTimespan* outDuration, const FBuildFingerpint& key);
+    void RecordPath(const FBuildFingerpint& key, FTimespan duration);
+
+    // only recorded when tracing
+    void RecordWork(const FBuildNode& node, EBuildStep step, EBuildResult result, FTimepoint startedAt, FTimespan duration);
+
+    NODISCARD size_t NumHistoryEntries() const;
+    NODISCARD size_t NumTraceEvents() const;
+
+    NODISCARD VECTOR(BuildGraph, FBuildTraceEvent) TraceEvents() const;
+    void ClearTrace();
+
+    void ExportChromeTrace(FTextWriter& oss) const;
+    NODISCARD bool ExportChromeTrace(const FFilename& filename) const;
+
+    bool Load();
+    NODISCARD bool Flush();
+
+    // zero when the node has no BuildName()
+    NODISCARD static FBuildFingerpint HistoryKey(const FBuildNode& node, EBuildStep step);
+
+private:
+    struct FHistoryEntry {
+        u64 PathInMicros; // exponential moving average
+        u32 NumSamples;
+    };
+
+    using FHistory = HASHMAP(BuildGraph, FBuildFingerpint, FHistoryEntry);
+    using FTrace = VECTOR(BuildGraph, FBuildTraceEvent);
+
+    NODISCARD static u32 ShardIndex_(const FBuildFingerpint& key) { return static_cast<u32>(key.lo % NumShards); }
+
+    TThreadSafe<FHistory, EThreadBarrier::RWLock> _shards[NumShards];
+    TThreadSafe<FTrace, EThreadBarrier::CriticalSection> _trace;
+
+    const FFilename _historyPath;
+    const FTimepoint _createdAt;
+
+    std::atomic<bool> _dirty{ false };
+    std::atomic<bool> _tracing{ false };
+    std::atomic<u64> _criticalPathInMicros{ 0 };
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
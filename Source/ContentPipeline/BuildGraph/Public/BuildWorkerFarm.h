@@ -0,0 +1,148 @@
+﻿#pragma once
+
+#include "BuildGraph_fwd.h"
+
+#include "BuildEnums.h"
+
+#include "Container/RawStorage.h"
+#include "Container/Vector.h"
+#include "IO/Dirpath.h"
+#include "IO/Filename.h"
+#include "IO/String.h"
+#include "Memory/MemoryView.h"
+#include "Memory/UniquePtr.h"
+#include "Misc/Function.h"
+#include "Time/Time_fwd.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FBuildWorkerJob {
+    using FArguments = VECTORINSITU(BuildGraph, FString, 4); // utf-8 on the wire
+    using FInputs = VECTORINSITU(BuildGraph, FBuildFingerpint, 2);
+
+    FBuildFingerpint Fingerprint{ FBuildFingerpint::Zero() }; // key of the output in the build cache, see MakeFingerprint()
+    FArguments Arguments;
+    FInputs Inputs; // fingerprints of the input files and of the tool itself
+
+    NODISCARD static FBuildFingerpint MakeFingerprint(const FBuildWorkerJob& job) NOEXCEPT;
+};
+//----------------------------------------------------------------------------
+struct FBuildWorkerResult {
+    using FOutput = RAWSTORAGE(BuildGraph, u8);
+
+    int ExitCode{ -1 };
+    bool FromCache{ false };
+    FOutput Output; // streamed back by the worker, written to the build cache when it succeeded
+    FString Log;
+};
+//----------------------------------------------------------------------------
+struct FBuildWorkerFarmOptions {
+    u32 MaxWorkers{ 0 }; // 0 for the number of hardware threads
+    u32 MaxJobsPerBatch{ 8 };
+    u32 MaxJobsPerWorker{ 256 }; // recycled after, 1 spawns a process per job
+    u64 MaxMemoryPerWorker{ 2ull << 30 }; // recycled after a batch, when its physical memory exceeds this threshold
+    double StartupTimeoutInSeconds{ 30.0 };
+    double BatchTimeoutInSeconds{ 0.0 }; // 0 for no timeout
+};
+//----------------------------------------------------------------------------
+struct FBuildWorkerFarmStatistics {
+    size_t NumJobs{ 0 };
+    size_t NumBatches{ 0 };
+    size_t NumCacheHits{ 0 };
+    size_t NumSpawns{ 0 };
+    size_t NumRecycles{ 0 };
+    size_t NumCrashes{ 0 }; // dead workers, timeouts and protocol errors
+    size_t NumGracefulExits{ 0 }; // stopped workers which exited by themselves with a zero exit code
+};
+//----------------------------------------------------------------------------
+// Pool of persistent worker processes for an external tool, avoids paying its startup for each node:
+// - workers are spawned on demand with the tool executable and its worker arguments
+// - jobs are sent by batches on the worker stdin, results are streamed back on its stdout
+// - outputs are looked up and written in the build cache, keyed by the job fingerprint
+// - workers are recycled after MaxJobsPerWorker jobs or when exceeding MaxMemoryPerWorker
+// The tool implements the worker side with RunBuildWorker(). All methods are thread-safe.
+//----------------------------------------------------------------------------
+class PPE_BUILDGRAPH_API FBuildWorkerFarm : Meta::FNonCopyableNorMovable {
+public:
+    using FOptions = FBuildWorkerFarmOptions;
+    using FStatistics = FBuildWorkerFarmStatistics;
+
+    FBuildWorkerFarm(
+        const FFilename& executable,
+        const FWString& workerArguments,
+        const FDirpath& workingDir = FDirpath{},
+        const FOptions& options = FOptions{} );
+    ~FBuildWorkerFarm(); // stops all the workers, must not race with Execute()
+
+    const FFilename& Executable() const { return _executable; }
+    const FWString& WorkerArguments() const { return _workerArguments; }
+    const FDirpath& WorkingDir() const { return _workingDir; }
+    const FOptions& Options() const { return _options; }
+
+    // returns false when a worker died or broke the protocol, a tool failure is only reported in ExitCode
+    // the cache is read with EBuildFlags::CacheRead and written with EBuildFlags::CacheWrite
+    NODISCARD bool Execute(
+        FBuildWorkerResult* outResult,
+        const FBuildWorkerJob& job,
+        IBuildCache* cache = nullptr,
+        EBuildFlags flags = EBuildFlags::Cache );
+    NODISCARD bool ExecuteBatch(
+        const TMemoryView<FBuildWorkerResult>& results,
+        const TMemoryView<const FBuildWorkerJob>& jobs,
+        IBuildCache* cache = nullptr,
+        EBuildFlags flags = EBuildFlags::Cache );
+
+    // stops the idle workers, new workers are spawned by the next jobs
+    void Shutdown();
+
+    NODISCARD size_t NumWorkers() const;
+    NODISCARD FStatistics Statistics() const NOEXCEPT;
+    void ResetStatistics() NOEXCEPT;
+
+private:
+    class FWorker;
+    using UWorker = TUniquePtr<FWorker>;
+
+    NODISCARD UWorker AcquireWorker_();
+    void ReleaseWorker_(UWorker&& worker, bool recycle);
+    NODISCARD UWorker SpawnWorker_();
+    NODISCARD bool RunBatch_(FWorker& worker, const TMemoryView<FBuildWorkerResult>& results, const TMemoryView<const FBuildWorkerJob>& jobs);
+
+    const FFilename _executable;
+    const FWString _workerArguments;
+    const FDirpath _workingDir;
+    const FOptions _options;
+
+    mutable std::mutex _barrier;
+    std::condition_variable _onWorkerReleased;
+    VECTOR(BuildGraph, UWorker) _idleWorkers;
+    u32 _numWorkers{ 0 };
+    u32 _maxWorkers{ 0 };
+
+    std::atomic<size_t> _numJobs{ 0 };
+    std::atomic<size_t> _numBatches{ 0 };
+    std::atomic<size_t> _numCacheHits{ 0 };
+    std::atomic<size_t> _numSpawns{ 0 };
+    std::atomic<size_t> _numRecycles{ 0 };
+    std::atomic<size_t> _numCrashes{ 0 };
+    std::atomic<size_t> _numGracefulExits{ 0 };
+};
+//----------------------------------------------------------------------------
+// Worker side, for tools linking with BuildGraph: serves the batches read on stdin until it is closed.
+// The protocol keeps its own handle on stdout, everything else written there by the tool goes to stderr.
+// Returns the exit code of the worker process.
+//----------------------------------------------------------------------------
+using FBuildWorkerHandler = TFunction<void(FBuildWorkerResult* outResult, const FBuildWorkerJob& job)>;
+PPE_BUILDGRAPH_API int RunBuildWorker(const FBuildWorkerHandler& handler);
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
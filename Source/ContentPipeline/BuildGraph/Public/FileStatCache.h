@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include "BuildGraph_fwd.h"
+
+#include "Container/HashMap.h"
+#include "IO/Filename.h"
+#include "Thread/ThreadSafe.h"
+#include "Time/Timestamp.h"
+
+#include <atomic>
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FFileStatCacheStatistics {
+    size_t NumEntries{ 0 };
+
+    size_t FilesHashed{ 0 }; // stat data changed or unknown: the content was hashed again
+    size_t FilesSkipped{ 0 }; // stat data unchanged: the cached fingerprint was reused
+    size_t FilesMissing{ 0 }; // can't be stat'ed or read
+    u64 HashedSizeInBytes{ 0 };
+};
+//----------------------------------------------------------------------------
+// Content fingerprints of the source files, cached by their stat data:
+// - files are hashed with XXH3-128 by fixed size chunks, read and hashed in parallel for large files
+// - the fingerprint is reused while (size, last modified, inode) are unchanged
+// - entries hashed in the same second as the file was modified are always rehashed (racy timestamps)
+// - the optional file keeps the entries between runs, a corrupted file only costs rehashing
+// All methods are thread-safe, except Load() which must not race with lookups.
+//----------------------------------------------------------------------------
+class PPE_BUILDGRAPH_API FFileStatCache : Meta::FNonCopyableNorMovable {
+public:
+    using FStatistics = FFileStatCacheStatistics;
+
+    STATIC_CONST_INTEGRAL(u32, NumShards, 16);
+    STATIC_CONST_INTEGRAL(size_t, ChunkSizeInBytes, 4u << 20);
+
+    FFileStatCache() NOEXCEPT; // memory only
+    explicit FFileStatCache(const FFilename& path); // loaded from path, if it exists
+    ~FFileStatCache(); // flushes when persistent and dirty
+
+    const FFilename& Path() const { return _path; }
+
+    // outRehashed is true when the content was hashed, false when the cached fingerprint was reused
+    NODISCARD bool Fingerprint(FBuildFingerpint* outFingerprint, const FFilename& filename, bool* outRehashed = nullptr);
+
+    void Invalidate(const FFilename& filename);
+    void Clear();
+
+    bool Load();
+    NODISCARD bool Flush();
+
+    NODISCARD FStatistics Statistics() const NOEXCEPT;
+    void ResetStatistics() NOEXCEPT;
+
+    // hashes the content without looking at the cache, sizeInBytes must match the file size
+    NODISCARD static bool HashFile(FBuildFingerpint* outFingerprint, const FFilename& filename, u64 sizeInBytes);
+
+private:
+    struct FEntry {
+        u64 SizeInBytes;
+        u64 Inode;
+        FTimestamp LastModified;
+        FTimestamp HashedAt;
+        FBuildFingerpint Fingerprint;
+    };
+
+    using FShard = HASHMAP(BuildGraph, FFilename, FEntry);
+
+    NODISCARD static u32 ShardIndex_(const FFilename& filename) { return static_cast<u32>(hash_value(filename) % NumShards); }
+
+    TThreadSafe<FShard, EThreadBarrier::RWLock> _shards[NumShards];
+
+    const FFilename _path;
+
+    std::atomic<bool> _dirty{ false };
+    std::atomic<size_t> _filesHashed{ 0 };
+    std::atomic<size_t> _filesSkipped{ 0 };
+    std::atomic<size_t> _filesMissing{ 0 };
+    std::atomic<u64> _hashedSizeInBytes{ 0 };
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
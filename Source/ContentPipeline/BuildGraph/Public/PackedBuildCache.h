@@ -0,0 +1,150 @@
+﻿#pragma once
+
+#include "BuildGraph_fwd.h"
+
+#include "BuildCache.h"
+
+#include "Container/HashMap.h"
+#include "Container/Vector.h"
+#include "IO/Dirpath.h"
+#include "IO/Filename.h"
+#include "Memory/Compression.h"
+#include "Thread/ReadWriteLock.h"
+#include "Thread/ThreadSafe.h"
+#include "Time/Time_fwd.h"
+
+#include <atomic>
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FPackedBuildCacheOptions {
+    u64 MaxSizeInBytes{ 8ull << 30 }; // LRU budget for the live entries, enforced by Cleanup()
+    u64 MaxPackSizeInBytes{ 256ull << 20 }; // a new pack is started when the current one would grow past this size
+    float CompactionRatio{ 0.5f }; // Cleanup() rewrites sealed packs with less live data than this ratio
+    u32 MinCompressSizeInBytes{ 256 }; // smaller entries are stored uncompressed
+    Compression::ECompressMethod CompressMethod{ Compression::Fast };
+    bool Compress{ true };
+};
+//----------------------------------------------------------------------------
+struct FPackedBuildCacheStatistics {
+    size_t NumEntries{ 0 };
+    size_t NumPacks{ 0 };
+    u64 LiveSizeInBytes{ 0 }; // size of the records still referenced by the index
+    u64 PackSizeInBytes{ 0 }; // size of all the packs, including dead records
+
+    size_t Hits{ 0 };
+    size_t Misses{ 0 };
+    size_t Writes{ 0 };
+    size_t Duplicates{ 0 }; // writes of an entry already in the cache
+    size_t Evictions{ 0 };
+    size_t CorruptedEntries{ 0 };
+    size_t RecoveredEntries{ 0 }; // entries found in the packs but missing from the index when opening
+    u64 CompactedSizeInBytes{ 0 };
+};
+//----------------------------------------------------------------------------
+// Content-addressed build cache storing the entries in a few append-only pack files:
+// - each record is self-describing (fingerprint, sizes, checksum) and optionally compressed
+// - a sharded hash index maps the fingerprints to their pack/offset/size and last access tick
+// - the index is saved as a flat POD snapshot, alternating between 2 files so a torn write never loses both
+// - opening scans the pack tails past the snapshot, so records appended after the last Flush() are recovered
+// - Cleanup() evicts the least recently used entries above the budget, then rewrites sparse packs
+// Read() and Write() are thread-safe, Cleanup() and Flush() wait for them to complete.
+//----------------------------------------------------------------------------
+class PPE_BUILDGRAPH_API FPackedBuildCache final : public IBuildCache {
+public:
+    using FOptions = FPackedBuildCacheOptions;
+    using FStatistics = FPackedBuildCacheStatistics;
+
+    STATIC_CONST_INTEGRAL(u32, NumShards, 16);
+
+    FPackedBuildCache(const FDirpath& path, bool writable, const FOptions& options = {});
+    virtual ~FPackedBuildCache() override; // flushes the index when writable
+
+    const FDirpath& Path() const { return _path; }
+    const FOptions& Options() const { return _options; }
+    bool Writable() const { return _writable; }
+
+    // each call starts a new access tick for the LRU
+    virtual void Initialize(const FTimestamp& buildTime) override final;
+
+    virtual UStreamReader Read(FBuildFingerpint fingerprint) override final;
+    virtual bool Write(FBuildFingerpint fingerprint, const FRawMemoryConst& rawdata) override final;
+
+    virtual void Cleanup() override final;
+
+    NODISCARD bool Contains(FBuildFingerpint fingerprint) const;
+    NODISCARD bool Flush(); // saves the index snapshot
+
+    NODISCARD FStatistics Statistics() const;
+
+private:
+    struct FLocation {
+        u64 Offset;
+        u32 Pack;
+        u32 SizeInBytes; // header included
+        u32 LastAccess;
+    };
+
+    struct FPack {
+        u32 Id;
+        u64 SizeInBytes;
+    };
+
+    struct FPackTable {
+        VECTOR(BuildGraph, FPack) Packs; // sorted by id, the last one is appended to while Writer is opened
+        u32 NextId{ 0 };
+        UStreamWriter Writer;
+    };
+
+    using FIndex = HASHMAP(BuildGraph, FBuildFingerpint, FLocation);
+
+    NODISCARD static u32 ShardIndex_(const FBuildFingerpint& fingerprint) { return static_cast<u32>(fingerprint.lo % NumShards); }
+    NODISCARD FFilename PackFilename_(u32 pack) const;
+    NODISCARD FFilename IndexFilename_(u32 slot) const;
+
+    NODISCARD bool Find_(FLocation* outLocation, const FBuildFingerpint& fingerprint) const;
+    void Touch_(const FBuildFingerpint& fingerprint);
+    void Forget_(const FBuildFingerpint& fingerprint, const FLocation& location);
+
+    NODISCARD bool Append_(FLocation* outLocation, FPackTable& packs, const FRawMemoryConst& record);
+    NODISCARD bool Flush_(FPackTable& packs);
+
+    void Open_();
+    NODISCARD bool LoadIndex_(FPackTable& packs);
+    void RecoverPacks_(FPackTable& packs);
+    size_t EvictEntries_();
+    void CompactPacks_(FPackTable& packs);
+
+    const FDirpath _path;
+    const FOptions _options;
+    const bool _writable;
+
+    TThreadSafe<FIndex, EThreadBarrier::RWLock> _shards[NumShards];
+    TThreadSafe<FPackTable, EThreadBarrier::CriticalSection> _packs;
+
+    // shared by Read()/Write(), exclusive for Cleanup()/Flush() since they move or delete the packs
+    FReadWriteLock _maintenanceRW;
+
+    std::atomic<u32> _accessTick{ 0 };
+    u64 _indexGeneration{ 0 };
+    std::atomic<bool> _dirty{ false };
+
+    std::atomic<size_t> _hits{ 0 };
+    std::atomic<size_t> _misses{ 0 };
+    std::atomic<size_t> _writes{ 0 };
+    std::atomic<size_t> _duplicates{ 0 };
+    std::atomic<size_t> _evictions{ 0 };
+    std::atomic<size_t> _corruptedEntries{ 0 };
+    std::atomic<size_t> _recoveredEntries{ 0 };
+    std::atomic<u64> _compactedSizeInBytes{ 0 };
+};
+//----------------------------------------------------------------------------
+PPE_BUILDGRAPH_API UBuildCache MakePackedBuildCache(const FDirpath& path, bool writable, const FPackedBuildCacheOptions& options = {});
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
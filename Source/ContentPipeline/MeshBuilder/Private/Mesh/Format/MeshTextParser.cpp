@@ -0,0 +1,239 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Mesh/Format/MeshTextParser.h"
+
+#include "HAL/PlatformMaths.h"
+#include "Maths/SSEHelpers.h"
+
+#include "double-conversion-external.h"
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// all the powers of 10 exactly representable with a double
+static CONSTEXPR const double GExactPowersOf10_[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+//----------------------------------------------------------------------------
+static FORCE_INLINE bool IsDigit_(char ch) NOEXCEPT {
+    return (static_cast<u8>(ch - '0') < 10);
+}
+//----------------------------------------------------------------------------
+static FORCE_INLINE bool IsBlank_(char ch) NOEXCEPT {
+    return (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n');
+}
+//----------------------------------------------------------------------------
+static const double_conversion::StringToDoubleConverter& MeshStringToDoubleConverter_() {
+    ONE_TIME_INITIALIZE(
+        const double_conversion::StringToDoubleConverter,
+        GMeshStringToDoubleConverter_,
+        double_conversion::StringToDoubleConverter::ALLOW_TRAILING_JUNK,
+        0.0,
+        double_conversion::Double::NaN(),
+        "inf", "nan" );
+    return GMeshStringToDoubleConverter_;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FStringView FMeshTextParser::EatLine() NOEXCEPT {
+    FStringView remaining = Remaining();
+    FStringView line = EatUntil(remaining, '\n'); // SIMD search
+    _it += line.size();
+    Expect('\n');
+
+    if (not line.empty() && line.back() == '\r')
+        line = line.ShiftBack();
+
+    return line;
+}
+//----------------------------------------------------------------------------
+FStringView FMeshTextParser::EatToken() NOEXCEPT {
+    SkipBlanks();
+
+    const char* const first = _it;
+    while (_it != _end && not IsBlank_(*_it))
+        ++_it;
+
+    return FStringView(first, checked_cast<size_t>(_it - first));
+}
+//----------------------------------------------------------------------------
+bool FMeshTextParser::ReadFloat(float* dst) NOEXCEPT {
+    Assert(dst);
+    SkipBlanks();
+
+    const char* s = _it;
+    bool negative = false;
+    if (s != _end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    u64 mantissa = 0;
+    u32 numDigits = 0;
+    for (; s != _end && IsDigit_(*s); ++s, ++numDigits)
+        mantissa = mantissa * 10 + static_cast<u64>(*s - '0');
+
+    i32 exponent = 0;
+    if (s != _end && *s == '.') {
+        const char* const fraction = ++s;
+        for (; s != _end && IsDigit_(*s); ++s, ++numDigits)
+            mantissa = mantissa * 10 + static_cast<u64>(*s - '0');
+        exponent = -checked_cast<i32>(s - fraction);
+    }
+
+    if (0 == numDigits)
+        return ReadFloatSlow_(dst); // inf/nan
+
+    if (s != _end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negativeExponent = false;
+        if (e != _end && (*e == '-' || *e == '+')) {
+            negativeExponent = (*e == '-');
+            ++e;
+        }
+
+        if (e == _end || not IsDigit_(*e))
+            return ReadFloatSlow_(dst);
+
+        i32 explicitExponent = 0;
+        for (; e != _end && IsDigit_(*e); ++e) {
+            if (explicitExponent < 10000)
+                explicitExponent = explicitExponent * 10 + (*e - '0');
+        }
+
+        exponent += (negativeExponent ? -explicitExponent : explicitExponent);
+        s = e;
+    }
+
+    // Clinger's fast path: both the mantissa and the power of 10 are exact doubles,
+    // so a single correctly rounded operation gives the correctly rounded double
+    if (numDigits > 19 || mantissa > (u64(1) << 53) || exponent < -22 || exponent > 22)
+        return ReadFloatSlow_(dst);
+
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0)
+        value /= GExactPowersOf10_[-exponent];
+    else
+        value *= GExactPowersOf10_[exponent];
+
+    // the double is within half an ulp of the exact value, rounding it again to a float only gives the
+    // correctly rounded float if it's not within one ulp of a halfway point between 2 floats:
+    // those have the 29 bits dropped by the conversion set to 0x10000000 (always normal floats here)
+    const u64 droppedBits = (bit_cast<u64>(value) & ((u64(1) << 29) - 1));
+    if (droppedBits - (u64(1) << 28) + 1 <= 2)
+        return ReadFloatSlow_(dst);
+
+    *dst = static_cast<float>(negative ? -value : value);
+    _it = s;
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FMeshTextParser::ReadFloatSlow_(float* dst) NOEXCEPT {
+    int processed = 0;
+    *dst = MeshStringToDoubleConverter_().StringToFloat(_it, checked_cast<int>(_end - _it), &processed);
+
+    if (0 == processed)
+        return false;
+
+    _it += processed;
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FMeshTextParser::ReadInt(i32* dst) NOEXCEPT {
+    Assert(dst);
+    SkipBlanks();
+
+    const char* s = _it;
+    bool negative = false;
+    if (s != _end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    if (s == _end || not IsDigit_(*s))
+        return false;
+
+    // -2147483648 is valid, so the magnitude can be one more than INT32_MAX when negative
+    const i64 maxValue = (static_cast<i64>(INT32_MAX) + (negative ? 1 : 0));
+
+    i64 value = 0;
+    for (; s != _end && IsDigit_(*s); ++s) {
+        value = value * 10 + (*s - '0');
+        if (value > maxValue)
+            return false;
+    }
+
+    *dst = checked_cast<i32>(negative ? -value : value);
+    _it = s;
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FMeshTextParser::ReadUInt(u32* dst) NOEXCEPT {
+    Assert(dst);
+    SkipBlanks();
+
+    const char* s = _it;
+    if (s == _end || not IsDigit_(*s))
+        return false;
+
+    u64 value = 0;
+    for (; s != _end && IsDigit_(*s); ++s) {
+        value = value * 10 + static_cast<u64>(*s - '0');
+        if (value > UINT32_MAX)
+            return false;
+    }
+
+    *dst = static_cast<u32>(value);
+    _it = s;
+    return true;
+}
+//----------------------------------------------------------------------------
+size_t FMeshTextParser::CountLines(const FStringView& text) NOEXCEPT {
+    const char* it = text.data();
+    const char* const end = (it + text.size());
+
+    size_t numLines = 0;
+#if USE_PPE_SSE2
+    const m128i_t eol = ::_mm_set1_epi8('\n');
+    for (; it + 16 <= end; it += 16) {
+        const m128i_t block = ::_mm_loadu_si128(reinterpret_cast<const m128i_t*>(it));
+        const u32 mask = static_cast<u32>(::_mm_movemask_epi8(::_mm_cmpeq_epi8(block, eol)));
+        numLines += FPlatformMaths::popcnt(mask);
+    }
+#endif
+
+    for (; it != end; ++it)
+        numLines += (*it == '\n' ? 1 : 0);
+
+    return numLines;
+}
+//----------------------------------------------------------------------------
+void FMeshTextParser::SplitInChunks(TAppendable<FStringView> chunks, const FStringView& text, size_t chunkSize/* = ChunkSize */) {
+    Assert(chunkSize > 0);
+
+    FStringView remaining = text;
+    while (remaining.size() > chunkSize) {
+        FStringView tail = remaining.CutStartingAt(chunkSize - 1);
+        const size_t lineEnd = EatUntil(tail, '\n').size();
+
+        const size_t len = (tail.empty() ? remaining.size() : chunkSize + lineEnd/* includes '\n' */);
+        chunks.emplace_back(remaining.CutBefore(len));
+        remaining = remaining.CutStartingAt(len);
+    }
+
+    if (not remaining.empty())
+        chunks.emplace_back(remaining);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include "MeshBuilder_fwd.h"
+
+#include "Container/Appendable.h"
+#include "IO/StringView.h"
+
+// In place parsing of the text mesh formats, tuned for multi-GB files:
+// - SplitInChunks() cuts the text on line boundaries, so each chunk can be parsed by a different worker
+// - numbers are parsed directly from the text without any stream or temporary string
+// - decimal floats take a correctly rounded fast path when the mantissa holds in 53 bits and |exponent| <= 22,
+//   unless the double result is too close to a halfway point between 2 floats to be rounded again safely,
+//   other inputs (long mantissa, huge exponents, inf/nan, near halfway) fall back on double-conversion
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class FMeshTextParser {
+public:
+    STATIC_CONST_INTEGRAL(size_t, ChunkSize, 1 << 20); // 1 MiB of text per task
+
+    FMeshTextParser() = default;
+    explicit FMeshTextParser(const FStringView& text) NOEXCEPT
+    :   _it(text.data())
+    ,   _end(text.data() + text.size())
+    {}
+
+    bool empty() const { return (_it == _end); }
+    FStringView Remaining() const { return FStringView(_it, checked_cast<size_t>(_end - _it)); }
+
+    // returns the next line without its end of line, works with both LF and CRLF
+    FStringView EatLine() NOEXCEPT;
+    // returns the next token delimited by blanks
+    FStringView EatToken() NOEXCEPT;
+
+    void SkipBlanks() NOEXCEPT {
+        while (_it != _end && (*_it == ' ' || *_it == '\t' || *_it == '\r'))
+            ++_it;
+    }
+
+    bool Peek(char ch) const NOEXCEPT {
+        return (_it != _end && *_it == ch);
+    }
+
+    bool Expect(char ch) NOEXCEPT {
+        if (Peek(ch)) {
+            ++_it;
+            return true;
+        }
+        return false;
+    }
+
+    NODISCARD bool ReadFloat(float* dst) NOEXCEPT;
+    NODISCARD bool ReadInt(i32* dst) NOEXCEPT;
+    NODISCARD bool ReadUInt(u32* dst) NOEXCEPT;
+
+    NODISCARD static size_t CountLines(const FStringView& text) NOEXCEPT;
+    // each chunk ends with an end of line, except for the last one
+    static void SplitInChunks(TAppendable<FStringView> chunks, const FStringView& text, size_t chunkSize = ChunkSize);
+
+private:
+    NODISCARD bool ReadFloatSlow_(float* dst) NOEXCEPT;
+
+    const char* _it{ nullptr };
+    const char* _end{ nullptr };
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -2,13 +2,17 @@
 
 #include "Mesh/Format/PolygonFileFormat.h"
 
+#include "Mesh/Format/MeshTextParser.h"
 #include "Mesh/GenericMaterial.h"
 #include "Mesh/GenericMesh.h"
 
 #include "RHI/VertexDesc.h"
 
 #include "HAL/PlatformEndian.h"
+#include "HAL/PlatformMemory.h"
 
+#include "Container/Appendable.h"
+#include "Container/Vector.h"
 #include "Diagnostic/Logger.h"
 #include "IO/BufferedStream.h"
 #include "IO/ConstNames.h"
@@ -21,6 +25,7 @@
 #include "Memory/MemoryStream.h"
 #include "Memory/SharedBuffer.h"
 #include "Meta/AutoEnum.h"
+#include "Thread/Task/TaskHelpers.h"
 #include "VirtualFileSystem.h"
 
 namespace PPE {
@@ -364,29 +369,10 @@ struct FHeader {
 };
 } //!namespace PLY
 //----------------------------------------------------------------------------
-// Load
-//----------------------------------------------------------------------------
-bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename) {
-    EAccessPolicy policy = EAccessPolicy::Binary;
-    if (filename.Extname() == FFSConstNames::Z())
-        policy = policy + EAccessPolicy::Compress;
-
-    const FUniqueBuffer buf = VFS_ReadAll(filename, policy);
-    PPE_LOG_CHECK(MeshBuilder, buf);
-
-    return Load(dst, filename, buf.MakeView().Cast<const char>());
-}
-//----------------------------------------------------------------------------
-bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename, const FStringView& content) {
-    FMemoryViewReader reader{ content };
-    return Load(dst, filename, reader);
-}
+namespace {
 //----------------------------------------------------------------------------
-bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename, IBufferedStreamReader& input) {
-    Assert(dst);
-    dst->SetSourceFile(filename);
-
-    PLY::FHeader header;
+static bool ReadPlyHeader_(PLY::FHeader* pHeader, IBufferedStreamReader& input) {
+    PLY::FHeader& header = *pHeader;
 
     FTextReader reader{ &input };
     PPE_LOG_CHECK(MeshBuilder, reader.ExpectWord("ply"_view));
@@ -464,6 +450,11 @@ bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename, IBuf
     }
     PPE_LOG_CHECK(MeshBuilder, headerEnd);
 
+    return true;
+}
+//----------------------------------------------------------------------------
+// generic path, reads each property of each element from the stream
+static bool LoadPlyElements_(FGenericMesh* dst, const FFilename& filename, const PLY::FHeader& header, IBufferedStreamReader& input) {
     const TPtrRef<const PLY::FElement> face = header.Get(PLY::EElement::Face);
     const TPtrRef<const PLY::FElement> vertex = header.Get(PLY::EElement::Vertex);
     PPE_LOG_CHECK(MeshBuilder, vertex);
@@ -669,6 +660,559 @@ bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename, IBuf
     return true;
 }
 //----------------------------------------------------------------------------
+// Fast paths, used when loading from memory:
+// - binary vertices are converted in parallel, runs of little endian floats are copied directly
+// - binary triangles are copied in parallel, other polygons are triangulated sequentially
+// - ascii text is split in chunks parsed in parallel, each chunk knows its first line from CountLines()
+//----------------------------------------------------------------------------
+STATIC_CONST_INTEGRAL(size_t, PlyVerticesPerTask_, 64 * 1024);
+STATIC_CONST_INTEGRAL(size_t, PlyFacesPerTask_, 64 * 1024);
+//----------------------------------------------------------------------------
+inline constexpr PLY::EProperty EProperty_FastPath{ PLY::EProperty_Position | PLY::EProperty_Normal | PLY::EProperty_Color | PLY::EProperty_TexcoordUVW };
+//----------------------------------------------------------------------------
+// scalar vertex properties, then an optional face element with only vertex indices: everything else takes the generic path
+NODISCARD static bool PlyHasFastLayout_(const PLY::FHeader& header) NOEXCEPT {
+    const auto isInteger = [](PLY::EType type) NOEXCEPT {
+        return (type >= PLY::EType::Char && type <= PLY::EType::UInt);
+    };
+
+    if (header.Elements.empty() || header.Elements.size() > 2)
+        return false;
+
+    const PLY::FElement& vertex = header.Elements.front();
+    if (vertex.Name != PLY::EElement::Vertex)
+        return false;
+
+    PLY::EProperty present{ Default };
+    for (const PLY::FProperty& property : vertex.Properties) {
+        if (property.IsList() || not (EProperty_FastPath ^ property.Name) || (present ^ property.Name))
+            return false;
+
+        present |= property.Name;
+    }
+
+    if (header.Elements.size() == 2) {
+        const PLY::FElement& face = header.Elements.back();
+        if (face.Name != PLY::EElement::Face || face.Properties.size() != 1)
+            return false;
+
+        const PLY::FProperty& indices = face.Properties.front();
+        if (indices.Name != PLY::EProperty::Vertex_Indices || not indices.IsList() ||
+            not isInteger(indices.List) || not isInteger(indices.Type) )
+            return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+// same ranges than FProperty::FloatPromote, see EType_VertexFormat()
+NODISCARD static float PlyNormalizeScalar_(PLY::EType type, float value) NOEXCEPT {
+    switch (type) {
+    case PLY::EType::Char:
+        return Max(value / 127.f, -1.f);
+    case PLY::EType::UChar:
+        return (value / 255.f);
+    case PLY::EType::Short:
+        return Max(value / 32767.f, -1.f);
+    case PLY::EType::UShort:
+        return (value / 65535.f);
+    default:
+        return value;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename T>
+NODISCARD static T PlyReadBinary_(const u8* src, bool bigEndian) NOEXCEPT {
+    T value;
+    FPlatformMemory::Memcpy(&value, src, sizeof(T)); // records are not aligned
+    if (bigEndian)
+        FPlatformEndian::SwapInPlace(&value);
+    return value;
+}
+//----------------------------------------------------------------------------
+NODISCARD static float PlyReadFloat_(PLY::EType type, const u8* src, bool bigEndian) NOEXCEPT {
+    switch (type) {
+    case PLY::EType::Char:
+        return PlyNormalizeScalar_(type, PlyReadBinary_<i8>(src, bigEndian));
+    case PLY::EType::UChar:
+        return PlyNormalizeScalar_(type, PlyReadBinary_<u8>(src, bigEndian));
+    case PLY::EType::Short:
+        return PlyNormalizeScalar_(type, PlyReadBinary_<i16>(src, bigEndian));
+    case PLY::EType::UShort:
+        return PlyNormalizeScalar_(type, PlyReadBinary_<u16>(src, bigEndian));
+    case PLY::EType::Int:
+        return static_cast<float>(PlyReadBinary_<i32>(src, bigEndian));
+    case PLY::EType::UInt:
+        return static_cast<float>(PlyReadBinary_<u32>(src, bigEndian));
+    case PLY::EType::Float:
+        return PlyReadBinary_<float>(src, bigEndian);
+    case PLY::EType::Double:
+        return static_cast<float>(PlyReadBinary_<double>(src, bigEndian));
+
+    case PLY::EType::List: FALLTHROUGH();
+    case PLY::EType::Unknown:
+        AssertNotReached();
+    }
+    return 0.f;
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool PlyReadIndex_(PLY::EType type, const u8* src, bool bigEndian, u32* dst) NOEXCEPT {
+    switch (type) {
+    case PLY::EType::Char:
+    {
+        const i8 value = PlyReadBinary_<i8>(src, bigEndian);
+        *dst = static_cast<u32>(value);
+        return (value >= 0);
+    }
+    case PLY::EType::UChar:
+        *dst = PlyReadBinary_<u8>(src, bigEndian);
+        return true;
+    case PLY::EType::Short:
+    {
+        const i16 value = PlyReadBinary_<i16>(src, bigEndian);
+        *dst = static_cast<u32>(value);
+        return (value >= 0);
+    }
+    case PLY::EType::UShort:
+        *dst = PlyReadBinary_<u16>(src, bigEndian);
+        return true;
+    case PLY::EType::Int:
+    {
+        const i32 value = PlyReadBinary_<i32>(src, bigEndian);
+        *dst = static_cast<u32>(value);
+        return (value >= 0);
+    }
+    case PLY::EType::UInt:
+        *dst = PlyReadBinary_<u32>(src, bigEndian);
+        return true;
+
+    default:
+        AssertNotReached(); // checked by PlyHasFastLayout_()
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+// destination of the scalar vertex properties, sub-parts with missing components are filled with default values
+struct FPlyVertexStreams_ {
+    FPositions3f Positions;
+    FNormals3f Normals;
+    FColors4f Colors;
+    FTexcoords2f Texcoords2;
+    FTexcoords3f Texcoords3;
+    PLY::EProperty Present{ Default };
+    bool NeedDefaults{ false };
+
+    // must be called before resizing the mesh
+    void Create(FGenericMesh* dst, const PLY::FElement& vertex) {
+        for (const PLY::FProperty& property : vertex.Properties)
+            Present |= property.Name;
+
+        if (Present ^ PLY::EProperty_Position)
+            Positions = dst->Position3f(0);
+        if (Present ^ PLY::EProperty_Normal)
+            Normals = dst->Normal3f(0);
+        if (Present ^ PLY::EProperty_Color)
+            Colors = dst->Color4f(0);
+
+        if (Present ^ PLY::EProperty::Texcoord_w)
+            Texcoords3 = dst->Texcoord3f(0);
+        else if (Present ^ PLY::EProperty_TexcoordUVW)
+            Texcoords2 = dst->Texcoord2f(0);
+
+        NeedDefaults = (
+            (Positions && not (Present & PLY::EProperty_Position)) ||
+            (Normals && not (Present & PLY::EProperty_Normal)) ||
+            (Colors && not (Present & PLY::EProperty_Color)) ||
+            (Texcoords3 && not (Present & PLY::EProperty_TexcoordUVW)) ||
+            (Texcoords2 && not (Present & (PLY::EProperty::Texcoord_u | PLY::EProperty::Texcoord_v))) );
+    }
+
+    void WriteDefaults(size_t first, size_t last) const NOEXCEPT {
+        if (not NeedDefaults)
+            return;
+
+        const auto fill = [first, last](const auto& subPart, const auto& value) {
+            const auto vertices = subPart.MakeView().SubRange(first, last - first);
+            std::fill(vertices.begin(), vertices.end(), value);
+        };
+
+        if (Positions && not (Present & PLY::EProperty_Position))
+            fill(Positions, float3::Zero);
+        if (Normals && not (Present & PLY::EProperty_Normal))
+            fill(Normals, float3::Zero);
+        if (Colors && not (Present & PLY::EProperty_Color))
+            fill(Colors, float4::One); // alpha is often omitted
+        if (Texcoords3 && not (Present & PLY::EProperty_TexcoordUVW))
+            fill(Texcoords3, float3::Zero);
+        if (Texcoords2 && not (Present & (PLY::EProperty::Texcoord_u | PLY::EProperty::Texcoord_v)))
+            fill(Texcoords2, float2::Zero);
+    }
+
+    float* Component(PLY::EProperty name, u32* stride) const NOEXCEPT {
+        switch (name) {
+        case PLY::EProperty::X: return Component_(Positions.MakeView(), 0, stride);
+        case PLY::EProperty::Y: return Component_(Positions.MakeView(), 1, stride);
+        case PLY::EProperty::Z: return Component_(Positions.MakeView(), 2, stride);
+        case PLY::EProperty::NX: return Component_(Normals.MakeView(), 0, stride);
+        case PLY::EProperty::NY: return Component_(Normals.MakeView(), 1, stride);
+        case PLY::EProperty::NZ: return Component_(Normals.MakeView(), 2, stride);
+        case PLY::EProperty::Red: return Component_(Colors.MakeView(), 0, stride);
+        case PLY::EProperty::Green: return Component_(Colors.MakeView(), 1, stride);
+        case PLY::EProperty::Blue: return Component_(Colors.MakeView(), 2, stride);
+        case PLY::EProperty::Alpha: return Component_(Colors.MakeView(), 3, stride);
+        case PLY::EProperty::Texcoord_u: return (Texcoords3 ? Component_(Texcoords3.MakeView(), 0, stride) : Component_(Texcoords2.MakeView(), 0, stride));
+        case PLY::EProperty::Texcoord_v: return (Texcoords3 ? Component_(Texcoords3.MakeView(), 1, stride) : Component_(Texcoords2.MakeView(), 1, stride));
+        case PLY::EProperty::Texcoord_w: return Component_(Texcoords3.MakeView(), 2, stride);
+        default:
+            AssertNotReached(); // checked by PlyHasFastLayout_()
+        }
+        return nullptr;
+    }
+
+private:
+    template <typename T>
+    static float* Component_(const TMemoryView<T>& vertices, u32 index, u32* stride) NOEXCEPT {
+        *stride = static_cast<u32>(sizeof(T) / sizeof(float));
+        return (reinterpret_cast<float*>(vertices.data()) + index);
+    }
+};
+//----------------------------------------------------------------------------
+struct FPlyColumn_ {
+    PLY::EType Type{ Default };
+    u32 Offset{ 0 }; // in the binary record
+    u32 NumFloats{ 0 }; // > 0 when copied as is: contiguous little endian floats, in the record and in the sub-part
+    u32 Stride{ 0 }; // in floats
+    float* Dst{ nullptr };
+};
+//----------------------------------------------------------------------------
+static u32 MakePlyColumns_(VECTOR(MeshBuilder, FPlyColumn_)* pColumns, const PLY::FElement& vertex, const FPlyVertexStreams_& streams, PLY::EFormat format) {
+    const bool directCopy = (format == PLY::EFormat::Binary_little_endian);
+
+    u32 recordSize = 0;
+    for (const PLY::FProperty& property : vertex.Properties) {
+        FPlyColumn_ column;
+        column.Type = property.Type;
+        column.Offset = recordSize;
+        column.NumFloats = (directCopy && property.Type == PLY::EType::Float ? 1 : 0);
+        column.Dst = streams.Component(property.Name, &column.Stride);
+
+        recordSize += checked_cast<u32>(PLY::EType_SizeOf(property.Type));
+
+        if (not pColumns->empty()) {
+            FPlyColumn_& prev = pColumns->back();
+            if (prev.NumFloats && column.NumFloats && prev.Stride == column.Stride &&
+                prev.Dst + prev.NumFloats == column.Dst &&
+                prev.Offset + prev.NumFloats * sizeof(float) == column.Offset ) {
+                prev.NumFloats++; // merge with the previous run
+                continue;
+            }
+        }
+
+        pColumns->push_back(column);
+    }
+
+    return recordSize;
+}
+//----------------------------------------------------------------------------
+static bool LoadPlyBinaryFaces_(FGenericMesh* dst, const PLY::FProperty& property, size_t numFaces, size_t numVertices, const FRawMemoryConst& faces, bool bigEndian) {
+    const size_t countSize = PLY::EType_SizeOf(property.List);
+    const size_t indexSize = PLY::EType_SizeOf(property.Type);
+    const size_t triangleSize = (countSize + 3 * indexSize);
+
+    // optimistic: most files only hold triangles, stored as fixed size records which can be copied in parallel
+    if (faces.SizeInBytes() >= numFaces * triangleSize) {
+        dst->Resize(numFaces * 3, numVertices, false);
+        const TMemoryView<u32> indices = dst->Indices();
+
+        std::atomic<bool> onlyTriangles{ true };
+        std::atomic<bool> validIndices{ true };
+        ParallelFor(0, (numFaces + PlyFacesPerTask_ - 1) / PlyFacesPerTask_, [&](size_t task) {
+            const size_t first = task * PlyFacesPerTask_;
+            const size_t last = Min(first + PlyFacesPerTask_, numFaces);
+
+            bool triangles = true;
+            bool valid = true;
+            const u8* record = (faces.data() + first * triangleSize);
+            for (size_t f = first; triangles && f < last; ++f, record += triangleSize) {
+                u32 count;
+                triangles = (PlyReadIndex_(property.List, record, bigEndian, &count) && 3 == count);
+
+                forrange(i, 0, 3) {
+                    u32& index = indices[f * 3 + i];
+                    valid &= PlyReadIndex_(property.Type, record + countSize + i * indexSize, bigEndian, &index);
+                    valid &= (index < numVertices);
+                }
+            }
+
+            if (not triangles)
+                onlyTriangles = false;
+            if (not valid)
+                validIndices = false;
+        });
+
+        if (onlyTriangles) {
+            PPE_LOG_CHECK(MeshBuilder, validIndices);
+            return true;
+        }
+    }
+
+    // records have a variable size, polygons are triangulated as fans
+    VECTOR(MeshBuilder, u32) triangles;
+    triangles.reserve(numFaces * 3);
+
+    const u8* it = faces.data();
+    const u8* const end = (it + faces.SizeInBytes());
+    forrange(f, 0, numFaces) {
+        u32 count;
+        PPE_LOG_CHECK(MeshBuilder, checked_cast<size_t>(end - it) >= countSize);
+        PPE_LOG_CHECK(MeshBuilder, PlyReadIndex_(property.List, it, bigEndian, &count) && count >= 3);
+        it += countSize;
+
+        PPE_LOG_CHECK(MeshBuilder, checked_cast<size_t>(end - it) >= count * indexSize);
+
+        u32 first = 0, previous = 0;
+        forrange(i, 0, count) {
+            u32 current;
+            PPE_LOG_CHECK(MeshBuilder, PlyReadIndex_(property.Type, it, bigEndian, &current) && current < numVertices);
+            it += indexSize;
+
+            if (0 == i) {
+                first = current;
+            }
+            else if (i >= 2) {
+                triangles.push_back(first);
+                triangles.push_back(previous);
+                triangles.push_back(current);
+            }
+            previous = current;
+        }
+    }
+
+    dst->Resize(triangles.size(), numVertices, false);
+    FPlatformMemory::MemcpyLarge(dst->Indices().data(), triangles.data(), triangles.size() * sizeof(u32));
+    return true;
+}
+//----------------------------------------------------------------------------
+static bool LoadPlyBinary_(FGenericMesh* dst, const PLY::FHeader& header, const FRawMemoryConst& body) {
+    const bool bigEndian = (header.Format.Format == PLY::EFormat::Binary_big_endian);
+    const PLY::FElement& vertex = header.Elements.front();
+    const TPtrRef<const PLY::FElement> face = header.Get(PLY::EElement::Face);
+
+    const size_t numVertices = vertex.Num;
+    PPE_LOG_CHECK(MeshBuilder, numVertices <= UINT32_MAX);
+
+    FPlyVertexStreams_ streams;
+    streams.Create(dst, vertex);
+    dst->Resize(0, numVertices, false);
+
+    VECTOR(MeshBuilder, FPlyColumn_) columns;
+    const u32 recordSize = MakePlyColumns_(&columns, vertex, streams, header.Format.Format);
+
+    PPE_LOG_CHECK(MeshBuilder, body.SizeInBytes() >= numVertices * recordSize);
+    const FRawMemoryConst vertices = body.CutBefore(numVertices * recordSize);
+
+    // a single run covering both the record and the sub-part (only positions for instance) is copied in one go
+    const bool copyAll = (columns.size() == 1 &&
+        columns.front().NumFloats * sizeof(float) == recordSize &&
+        columns.front().NumFloats == columns.front().Stride );
+
+    ParallelFor(0, (numVertices + PlyVerticesPerTask_ - 1) / PlyVerticesPerTask_, [&](size_t task) {
+        const size_t first = task * PlyVerticesPerTask_;
+        const size_t last = Min(first + PlyVerticesPerTask_, numVertices);
+
+        const u8* record = (vertices.data() + first * recordSize);
+        if (copyAll) {
+            FPlatformMemory::MemcpyLarge(columns.front().Dst + first * columns.front().Stride, record, (last - first) * recordSize);
+            return;
+        }
+
+        streams.WriteDefaults(first, last);
+
+        for (size_t v = first; v < last; ++v, record += recordSize) {
+            for (const FPlyColumn_& column : columns) {
+                float* const pDst = (column.Dst + v * column.Stride);
+                if (column.NumFloats)
+                    FPlatformMemory::Memcpy(pDst, record + column.Offset, column.NumFloats * sizeof(float));
+                else
+                    *pDst = PlyReadFloat_(column.Type, record + column.Offset, bigEndian);
+            }
+        }
+    });
+
+    if (not face)
+        return true;
+
+    return LoadPlyBinaryFaces_(dst, face->Properties.front(), face->Num, numVertices,
+        body.CutStartingAt(vertices.SizeInBytes()), bigEndian );
+}
+//----------------------------------------------------------------------------
+struct FPlyAsciiChunk_ {
+    size_t FirstLine{ 0 };
+    size_t NumElements{ 0 }; // vertices and faces
+    VECTOR(MeshBuilder, u32) Indices; // triangulated faces
+    FStringView Error; // first invalid line
+};
+//----------------------------------------------------------------------------
+static bool LoadPlyAscii_(FGenericMesh* dst, const PLY::FHeader& header, const FStringView& body) {
+    const PLY::FElement& vertex = header.Elements.front();
+    const TPtrRef<const PLY::FElement> face = header.Get(PLY::EElement::Face);
+
+    const size_t numVertices = vertex.Num;
+    const size_t numFaces = (face ? face->Num : 0);
+    PPE_LOG_CHECK(MeshBuilder, numVertices <= UINT32_MAX);
+
+    FPlyVertexStreams_ streams;
+    streams.Create(dst, vertex);
+    dst->Resize(0, numVertices, false);
+
+    VECTOR(MeshBuilder, FPlyColumn_) columns;
+    Unused(MakePlyColumns_(&columns, vertex, streams, header.Format.Format));
+
+    VECTOR(MeshBuilder, FStringView) textChunks;
+    FMeshTextParser::SplitInChunks(MakeAppendable(textChunks), body);
+
+    // elements are identified by their line number: each chunk needs the number of lines before it
+    VECTOR(MeshBuilder, FPlyAsciiChunk_) chunks;
+    chunks.resize(textChunks.size());
+
+    ParallelFor(0, chunks.size(), [&textChunks, &chunks](size_t i) {
+        chunks[i].FirstLine = FMeshTextParser::CountLines(textChunks[i]);
+    });
+
+    size_t numLines = 0;
+    for (FPlyAsciiChunk_& chunk : chunks) {
+        const size_t numLinesInChunk = chunk.FirstLine;
+        chunk.FirstLine = numLines;
+        numLines += numLinesInChunk;
+    }
+
+    ParallelFor(0, chunks.size(), [&](size_t i) {
+        FPlyAsciiChunk_& chunk = chunks[i];
+
+        FMeshTextParser reader{ textChunks[i] };
+        for (size_t l = chunk.FirstLine; not reader.empty(); ++l) {
+            const FStringView line = reader.EatLine();
+            FMeshTextParser parser{ line };
+
+            bool valid = true;
+            if (l < numVertices) {
+                streams.WriteDefaults(l, l + 1);
+
+                for (const FPlyColumn_& column : columns) {
+                    float value;
+                    if (not parser.ReadFloat(&value)) {
+                        valid = false;
+                        break;
+                    }
+                    column.Dst[l * column.Stride] = PlyNormalizeScalar_(column.Type, value);
+                }
+
+                chunk.NumElements++;
+            }
+            else if (l < numVertices + numFaces) {
+                // polygons are triangulated as fans
+                u32 count, first, previous, current;
+                valid = (parser.ReadUInt(&count) && count >= 3 &&
+                    parser.ReadUInt(&first) && first < numVertices &&
+                    parser.ReadUInt(&previous) && previous < numVertices );
+
+                for (u32 n = 2; valid && n < count; ++n) {
+                    valid = (parser.ReadUInt(&current) && current < numVertices);
+                    chunk.Indices.push_back(first);
+                    chunk.Indices.push_back(previous);
+                    chunk.Indices.push_back(current);
+                    previous = current;
+                }
+
+                chunk.NumElements++;
+            }
+            else {
+                parser.SkipBlanks(); // only trailing empty lines
+                valid = parser.empty();
+            }
+
+            if (not valid) {
+                chunk.Error = line;
+                return;
+            }
+        }
+    });
+
+    size_t numElements = 0;
+    size_t numIndices = 0;
+    VECTOR(MeshBuilder, size_t) offsets;
+    offsets.resize_Uninitialized(chunks.size());
+
+    forrange(i, 0, chunks.size()) {
+        const FPlyAsciiChunk_& chunk = chunks[i];
+        if (not chunk.Error.empty()) {
+            PPE_LOG(MeshBuilder, Error, "invalid PLY ascii line: {0}", chunk.Error);
+            return false;
+        }
+
+        offsets[i] = numIndices;
+        numIndices += chunk.Indices.size();
+        numElements += chunk.NumElements;
+    }
+
+    PPE_LOG_CHECK(MeshBuilder, numVertices + numFaces == numElements);
+
+    dst->Resize(numIndices, numVertices, false);
+    const TMemoryView<u32> indices = dst->Indices();
+
+    ParallelFor(0, chunks.size(), [&](size_t i) {
+        const FPlyAsciiChunk_& chunk = chunks[i];
+        std::copy(chunk.Indices.begin(), chunk.Indices.end(), indices.data() + offsets[i]);
+    });
+
+    return true;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+// Load
+//----------------------------------------------------------------------------
+bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename) {
+    EAccessPolicy policy = EAccessPolicy::Binary;
+    if (filename.Extname() == FFSConstNames::Z())
+        policy = policy + EAccessPolicy::Compress;
+
+    const FUniqueBuffer buf = VFS_ReadAll(filename, policy);
+    PPE_LOG_CHECK(MeshBuilder, buf);
+
+    return Load(dst, filename, buf.MakeView().Cast<const char>());
+}
+//----------------------------------------------------------------------------
+bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename, const FStringView& content) {
+    Assert(dst);
+    dst->SetSourceFile(filename);
+
+    FMemoryViewReader input{ content };
+
+    PLY::FHeader header;
+    PPE_LOG_CHECK(MeshBuilder, ReadPlyHeader_(&header, input));
+
+    if (PlyHasFastLayout_(header)) {
+        const FStringView body = content.CutStartingAt(checked_cast<size_t>(input.TellI()));
+        if (header.Format.Format == PLY::EFormat::Ascii)
+            return LoadPlyAscii_(dst, header, body);
+
+        return LoadPlyBinary_(dst, header, body.Cast<const u8>());
+    }
+
+    return LoadPlyElements_(dst, filename, header, input);
+}
+//----------------------------------------------------------------------------
+bool FPolygonFileFormat::Load(FGenericMesh* dst, const FFilename& filename, IBufferedStreamReader& input) {
+    Assert(dst);
+    dst->SetSourceFile(filename);
+
+    PLY::FHeader header;
+    PPE_LOG_CHECK(MeshBuilder, ReadPlyHeader_(&header, input));
+
+    return LoadPlyElements_(dst, filename, header, input);
+}
+//----------------------------------------------------------------------------
 // Save
 //----------------------------------------------------------------------------
 bool FPolygonFileFormat::Save(const FGenericMesh& src, const FFilename& filename) {
@@ -783,8 +1327,11 @@ bool FPolygonFileFormat::ExportGenericMesh(IStreamWriter* output, const FGeneric
 }
 //----------------------------------------------------------------------------
 FMeshBuilderResult FPolygonFileFormat::ImportGenericMesh(const FRawMemoryConst& memory) const {
-    FMemoryViewReader reader{ memory };
-    return ImportGenericMesh(reader);
+    FGenericMesh result;
+    if (Load(&result, Default, memory.Cast<const char>()))
+        return Meta::MakeOptional(std::move(result));
+
+    return std::nullopt;
 }
 //----------------------------------------------------------------------------
 FMeshBuilderResult FPolygonFileFormat::ImportGenericMesh(IStreamReader& input) const {
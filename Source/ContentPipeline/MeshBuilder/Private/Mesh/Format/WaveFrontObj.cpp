@@ -2,11 +2,15 @@
 
 #include "Mesh/Format/WaveFrontObj.h"
 
+#include "Mesh/Format/MeshTextParser.h"
 #include "Mesh/GenericMaterial.h"
 #include "Mesh/GenericMesh.h"
 
+#include "Container/Appendable.h"
+#include "Container/HashMap.h"
 #include "Container/Vector.h"
 #include "Diagnostic/Logger.h"
+#include "HAL/PlatformMemory.h"
 #include "IO/BufferedStream.h"
 #include "IO/ConstNames.h"
 #include "IO/Filename.h"
@@ -17,6 +21,7 @@
 #include "Maths/ScalarVectorHelpers.h"
 #include "Memory/MemoryStream.h"
 #include "Memory/SharedBuffer.h"
+#include "Thread/Task/TaskHelpers.h"
 
 #include "VirtualFileSystem.h"
 
@@ -25,6 +30,206 @@ namespace ContentPipeline {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+STATIC_CONST_INTEGRAL(size_t, ObjVerticesPerTask_, 64 * 1024);
+STATIC_CONST_INTEGRAL(u32, ObjWeldPartitions_, 16); // must be a power of 2
+//----------------------------------------------------------------------------
+struct FObjChunkOffsets_ {
+    size_t Positions{ 0 };
+    size_t Texcoords{ 0 };
+    size_t Normals{ 0 };
+    size_t Corners{ 0 };
+};
+//----------------------------------------------------------------------------
+// Each chunk of text is parsed independently, corners are stored as (position, texcoord, normal) 0-based indices.
+// Negative (relative) indices depend on the number of elements in the previous chunks: they are flagged with
+// RelativeIndex and resolved once the chunks are merged, see ResolveIndex().
+struct FObjChunk_ {
+    STATIC_CONST_INTEGRAL(u32, NoIndex, UMax);
+    STATIC_CONST_INTEGRAL(u32, RelativeIndex, 1u << 31);
+    STATIC_CONST_INTEGRAL(i64, RelativeBias, 1 << 30);
+
+    VECTOR(MeshBuilder, float3) Positions;
+    VECTOR(MeshBuilder, float3) Colors; // empty or same size than Positions
+    VECTOR(MeshBuilder, float2) Texcoords;
+    VECTOR(MeshBuilder, float3) Normals;
+    VECTOR(MeshBuilder, uint3) Corners; // 3 corners per triangle
+
+    FStringView Error; // first invalid line
+    size_t NumIgnoredLines{ 0 };
+
+    static u32 ResolveIndex(u32 index, u32 chunkOffset) NOEXCEPT {
+        if (index == NoIndex || not (index & RelativeIndex))
+            return index;
+
+        const i64 absolute = (chunkOffset + static_cast<i64>(index & ~RelativeIndex) - RelativeBias);
+        return (absolute >= 0 ? static_cast<u32>(absolute) : NoIndex - 1/* will be out of bounds */);
+    }
+
+    void Parse(const FStringView& text);
+
+private:
+    bool ParseCorner_(FMeshTextParser& line, uint3* corner) const NOEXCEPT;
+
+    static bool ParseIndex_(FMeshTextParser& line, u32* index, size_t numElementsInChunk) NOEXCEPT {
+        i32 value;
+        if (not line.ReadInt(&value) || 0 == value)
+            return false;
+
+        if (value > 0) {
+            *index = static_cast<u32>(value - 1);
+            return (*index < RelativeIndex);
+        }
+
+        const i64 local = (static_cast<i64>(numElementsInChunk) + value); // can be negative, refers to a previous chunk
+        if (local + RelativeBias < 0 || local + RelativeBias >= RelativeIndex)
+            return false;
+
+        *index = (RelativeIndex | static_cast<u32>(local + RelativeBias));
+        return true;
+    }
+};
+//----------------------------------------------------------------------------
+bool FObjChunk_::ParseCorner_(FMeshTextParser& line, uint3* corner) const NOEXCEPT {
+    // v, v/vt, v//vn or v/vt/vn
+    *corner = uint3(NoIndex);
+
+    if (not ParseIndex_(line, &corner->x, Positions.size()))
+        return false;
+
+    if (line.Expect('/')) {
+        if (not line.Peek('/') && not ParseIndex_(line, &corner->y, Texcoords.size()))
+            return false;
+
+        if (line.Expect('/') && not ParseIndex_(line, &corner->z, Normals.size()))
+            return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+void FObjChunk_::Parse(const FStringView& text) {
+    // rough estimation to avoid most of the reallocations: ~40 bytes per line, ~2 faces per vertex
+    Positions.reserve(text.size() / 128);
+    Corners.reserve(text.size() / 64);
+
+    FMeshTextParser reader{ text };
+    while (not reader.empty()) {
+        const FStringView line = reader.EatLine();
+        FMeshTextParser parser{ line };
+
+        const FStringView header = parser.EatToken();
+        if (header.empty() || header.front() == '#')
+            continue;
+
+        bool valid = true;
+        if (header == "v"_view) {
+            float3 position;
+            valid = (parser.ReadFloat(&position.x) && parser.ReadFloat(&position.y) && parser.ReadFloat(&position.z));
+            Positions.push_back(position);
+
+            // optional color (x y z r g b) or weight (x y z w), missing colors are white
+            float3 color;
+            if (parser.ReadFloat(&color.x) && parser.ReadFloat(&color.y)) {
+                valid &= parser.ReadFloat(&color.z);
+
+                if (Colors.empty())
+                    Colors.resize(Positions.size() - 1, float3::One);
+                Colors.push_back(color);
+            }
+            else if (not Colors.empty()) {
+                Colors.push_back(float3::One);
+            }
+        }
+        else if (header == "vt"_view) {
+            float2 texcoord;
+            valid = (parser.ReadFloat(&texcoord.x) && parser.ReadFloat(&texcoord.y));
+            Texcoords.push_back(texcoord);
+        }
+        else if (header == "vn"_view) {
+            float3 normal;
+            valid = (parser.ReadFloat(&normal.x) && parser.ReadFloat(&normal.y) && parser.ReadFloat(&normal.z));
+            Normals.push_back(SafeNormalize(normal));
+        }
+        else if (header == "f"_view) {
+            // polygons are triangulated as fans
+            uint3 first, previous, current;
+            valid = (ParseCorner_(parser, &first) && ParseCorner_(parser, &previous));
+
+            size_t numTriangles = 0;
+            for (parser.SkipBlanks(); valid && not parser.empty(); parser.SkipBlanks()) {
+                valid = ParseCorner_(parser, &current);
+                Corners.push_back(first);
+                Corners.push_back(previous);
+                Corners.push_back(current);
+                previous = current;
+                ++numTriangles;
+            }
+
+            valid &= (numTriangles > 0);
+        }
+        else if (header == "o"_view || header == "g"_view || header == "s"_view || header == "mtllib"_view) {
+            // objects, groups and smoothing groups are merged in a single mesh
+        }
+        else {
+            NumIgnoredLines++;
+        }
+
+        if (not valid) {
+            if (Error.empty())
+                Error = line;
+            return;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+// Vertices sharing the same corner indices are welded on the fly, in parallel but deterministically:
+// each partition of the corners (by key) finds the first corner with the same key, then a linear pass
+// assigns the vertex indices in order of first appearance.
+static void WeldObjCorners_(
+    VECTOR(MeshBuilder, u32)* pIndices,
+    VECTOR(MeshBuilder, u32)* pVertices,
+    const TMemoryView<const uint3>& corners ) {
+    const auto partitionOf = [](const uint3& corner) NOEXCEPT -> u32 {
+        const u32 h = (corner.x * 0x9E3779B1u) ^ (corner.y * 0x85EBCA77u) ^ (corner.z * 0xC2B2AE3Du);
+        return (h >> 28) & (ObjWeldPartitions_ - 1);
+    };
+
+    VECTOR(MeshBuilder, u32)& indices = *pIndices;
+    indices.resize_Uninitialized(corners.size()); // first corner with the same key
+
+    ParallelFor(0, ObjWeldPartitions_, [&](size_t partition) {
+        HASHMAP(MeshBuilder, uint3, u32) firstCorners;
+        firstCorners.reserve(corners.size() / (ObjWeldPartitions_ * 2));
+
+        forrange(c, 0, checked_cast<u32>(corners.size())) {
+            const uint3& corner = corners[c];
+            if (partitionOf(corner) == partition)
+                indices[c] = firstCorners.insert({ corner, c }).first->second;
+        }
+    });
+
+    VECTOR(MeshBuilder, u32)& vertices = *pVertices;
+    vertices.reserve(corners.size() / 2);
+
+    forrange(c, 0, checked_cast<u32>(corners.size())) {
+        const u32 first = indices[c];
+        if (first == c) {
+            indices[c] = checked_cast<u32>(vertices.size());
+            vertices.push_back(c);
+        }
+        else {
+            Assert(first < c);
+            indices[c] = indices[first]; // already resolved
+        }
+    }
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
 const FExtname& FWaveFrontObj::Extname() NOEXCEPT {
     return FFSConstNames::Obj();
 }
@@ -39,8 +244,11 @@ bool FWaveFrontObj::ExportGenericMesh(IStreamWriter* output, const FGenericMesh&
 }
 //----------------------------------------------------------------------------
 FMeshBuilderResult FWaveFrontObj::ImportGenericMesh(const FRawMemoryConst& memory) const {
-    FMemoryViewReader reader{ memory };
-    return ImportGenericMesh(reader);
+    FGenericMesh result;
+    if (Load(&result, Default, memory.Cast<const char>()))
+        return Meta::MakeOptional(std::move(result));
+
+    return std::nullopt;
 }
 //----------------------------------------------------------------------------
 FMeshBuilderResult FWaveFrontObj::ImportGenericMesh(IStreamReader& input) const {
@@ -73,143 +281,138 @@ bool FWaveFrontObj::Load(FGenericMesh* dst, const FFilename& filename, IStreamRe
 //----------------------------------------------------------------------------
 bool FWaveFrontObj::Load(FGenericMesh* dst, const FFilename& filename, const FStringView& content) {
     Assert(dst);
+    Assert(dst->empty());
 
     if (not filename.empty())
         dst->SetSourceFile(filename);
 
-    struct FVertex_ {
-        u32 Position    = UMax;
-        u32 Texcoord    = UMax;
-        u32 Normal      = UMax;
-    };
+    // parse all the chunks in parallel
+    VECTOR(MeshBuilder, FStringView) textChunks;
+    FMeshTextParser::SplitInChunks(MakeAppendable(textChunks), content);
 
-    VECTOR(MeshBuilder, float3) positions;
-    VECTOR(MeshBuilder, float2) texcoords;
-    VECTOR(MeshBuilder, float3) normals;
-    VECTOR(MeshBuilder, float3) colors;
-    VECTOR(MeshBuilder, FVertex_) vertices;
+    VECTOR(MeshBuilder, FObjChunk_) chunks;
+    chunks.resize(textChunks.size());
 
-    FFilename mtllib;
-    FString meshName;
+    ParallelFor(0, chunks.size(), [&textChunks, &chunks](size_t i) {
+        chunks[i].Parse(textChunks[i]);
+    });
 
-    FStringView reader{ content };
+    // compute the offset of each chunk in the merged arrays
+    FObjChunkOffsets_ total;
+    bool hasColors = false;
+    size_t numIgnoredLines = 0;
+    VECTOR(MeshBuilder, FObjChunkOffsets_) offsets;
+    offsets.resize_Uninitialized(chunks.size());
+
+    forrange(i, 0, chunks.size()) {
+        const FObjChunk_& chunk = chunks[i];
+        if (not chunk.Error.empty()) {
+            PPE_LOG(MeshBuilder, Error, "invalid wavefront obj line: {0}", chunk.Error);
+            return false;
+        }
 
-    while (not reader.empty()) {
-        FStringView line = Strip(EatUntil(reader, '\n'));
-        EatSpaces(reader);
-        if (line.empty() || line.front() == '#')
-            continue;
+        offsets[i] = total;
+        total.Positions += chunk.Positions.size();
+        total.Texcoords += chunk.Texcoords.size();
+        total.Normals += chunk.Normals.size();
+        total.Corners += chunk.Corners.size();
 
-        const FStringView header = EatIdentifier(line);
-        EatSpaces(line);
+        hasColors |= (not chunk.Colors.empty());
+        numIgnoredLines += chunk.NumIgnoredLines;
+    }
 
-        FMemoryViewReader stream{ line };
-        FTextReader r{ &stream };
+    if (numIgnoredLines > 0)
+        PPE_LOG(MeshBuilder, Warning, "ignored {0} unsupported wavefront obj lines (materials, lines, points...)", numIgnoredLines);
 
-        if (EqualsI(header, "v")) {
-            float3 v;
-            if (r >> &v.x && r >> &v.y && r >> &v.z)
-                positions.push_back(v);
-            else
-                return false;
+    PPE_LOG_CHECK(MeshBuilder, total.Positions > 0);
+    PPE_LOG_CHECK(MeshBuilder, total.Positions < FObjChunk_::RelativeIndex);
 
-            // optional color
-            if (r >> &v.x && r >> &v.y && r >> &v.z)
-                colors.push_back(v);
-        }
-        else if (EqualsI(header, "vt")) {
-            float2 v;
-            if (r >> &v.x && r >> &v.y)
-                texcoords.push_back(v);
-            else
-                return false;
-        }
-        else if (EqualsI(header, "vn")) {
-            float3 v;
-            if (r >> &v.x && r >> &v.y && r >> &v.z)
-                normals.push_back(SafeNormalize(v));
+    // merge attributes and resolve corner indices, also in parallel
+    VECTOR(MeshBuilder, float3) positions;
+    VECTOR(MeshBuilder, float3) colors;
+    VECTOR(MeshBuilder, float2) texcoords;
+    VECTOR(MeshBuilder, float3) normals;
+    VECTOR(MeshBuilder, uint3) corners;
+    positions.resize_Uninitialized(total.Positions);
+    colors.resize_Uninitialized(hasColors ? total.Positions : 0);
+    texcoords.resize_Uninitialized(total.Texcoords);
+    normals.resize_Uninitialized(total.Normals);
+    corners.resize_Uninitialized(total.Corners);
+
+    std::atomic<bool> validIndices{ true };
+    ParallelFor(0, chunks.size(), [&](size_t i) {
+        const FObjChunk_& chunk = chunks[i];
+        const FObjChunkOffsets_& offset = offsets[i];
+
+        std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + offset.Positions);
+        std::copy(chunk.Texcoords.begin(), chunk.Texcoords.end(), texcoords.begin() + offset.Texcoords);
+        std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + offset.Normals);
+
+        if (hasColors) {
+            if (chunk.Colors.empty())
+                std::fill_n(colors.begin() + offset.Positions, chunk.Positions.size(), float3::One);
             else
-                return false;
+                std::copy(chunk.Colors.begin(), chunk.Colors.end(), colors.begin() + offset.Positions);
         }
-        else if (EqualsI(header, "f")) {
-            forrange(i, 0, 3) {
-                FVertex_ v;
-                if (r >> &v.Position && r.Expect('/') &&
-                    r >> &v.Texcoord && r.Expect('/') &&
-                    r >> &v.Normal)
-                    vertices.push_back(v);
-                else
-                    return false;
+
+        const uint3 base{ checked_cast<u32>(offset.Positions), checked_cast<u32>(offset.Texcoords), checked_cast<u32>(offset.Normals) };
+        const uint3 count{ checked_cast<u32>(total.Positions), checked_cast<u32>(total.Texcoords), checked_cast<u32>(total.Normals) };
+
+        bool valid = true;
+        auto dstCorner = corners.begin() + offset.Corners;
+        for (const uint3& corner : chunk.Corners) {
+            uint3 resolved;
+            forrange(a, 0, 3) {
+                resolved[a] = FObjChunk_::ResolveIndex(corner[a], base[a]);
+                valid &= (resolved[a] == FObjChunk_::NoIndex ? a > 0 : resolved[a] < count[a]);
             }
+            *dstCorner++ = resolved;
         }
-        else if (EqualsI(header, "mtllib")) {
-            mtllib = FFilename{UTF_8_TO_WCHAR(line)};
-        }
-        else if (EqualsI(header, "usemtl")) {
-            PPE_LOG(MeshBuilder, Warning, "no support for wavefront obj material sections: {} {}", header, line);
-        }
-        else if (EqualsI(header, "o")) {
-            meshName = line;
-        }
-        else {
-            PPE_LOG(MeshBuilder, Warning, "ignored unknown wavefront obj header: {} {}", header, line);
-        }
-    }
 
-    const bool hasPositions = (positions.size() > 0);
-    const bool hasTexcoords = (texcoords.size() > 0);
-    const bool hasNormals = (normals.size() > 0);
-    const bool hasColors = (colors.size() > 0);
+        if (not valid)
+            validIndices = false;
+    });
 
-    if (not hasPositions)
-        return false;
+    PPE_LOG_CHECK(MeshBuilder, validIndices);
+
+    // weld the vertices sharing the same indices
+    VECTOR(MeshBuilder, u32) indices;
+    VECTOR(MeshBuilder, u32) vertices; // unique corners
+    WeldObjCorners_(&indices, &vertices, corners.MakeConstView());
 
-    const size_t index = 0;
     const size_t vertexCount = vertices.size();
+    const FPositions3f sp_position3f = dst->Position3f(0);
+    const FTexcoords2f sp_texcoord2f = (texcoords.empty() ? FTexcoords2f{} : dst->Texcoord2f(0));
+    const FNormals3f sp_normal3f = (normals.empty() ? FNormals3f{} : dst->Normal3f(0));
+    const FColors4f sp_color4f = (colors.empty() ? FColors4f{} : dst->Color4f(0));
 
-    const TMemoryView<float3> sp_position3f = dst->Position3f(index).Append(vertexCount);
+    dst->Resize(indices.size(), vertexCount, false);
+    FPlatformMemory::MemcpyLarge(dst->Indices().data(), indices.data(), indices.size() * sizeof(u32));
 
-    TMemoryView<float2> sp_texcoord2f;
-    if (hasTexcoords)
-        sp_texcoord2f = dst->Texcoord2f(index).Append(vertexCount);
+    const TMemoryView<float3> dstPositions = sp_position3f.MakeView();
+    const TMemoryView<float2> dstTexcoords = sp_texcoord2f.MakeView();
+    const TMemoryView<float3> dstNormals = sp_normal3f.MakeView();
+    const TMemoryView<float4> dstColors = sp_color4f.MakeView();
 
-    TMemoryView<float3> sp_normal3f;
-    if (hasNormals)
-        sp_normal3f = dst->Normal3f(index).Append(vertexCount);
+    ParallelFor(0, (vertexCount + ObjVerticesPerTask_ - 1) / ObjVerticesPerTask_, [&](size_t task) {
+        const size_t first = task * ObjVerticesPerTask_;
+        const size_t last = Min(first + ObjVerticesPerTask_, vertexCount);
 
-    TMemoryView<float4> sp_color4f;
-    if (hasColors)
-        sp_color4f = dst->Color4f(index).Append(vertexCount);
+        forrange(v, first, last) {
+            const uint3& corner = corners[vertices[v]];
 
-    for (size_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex += 3) {
-        const FVertex_& v0 = vertices[vertexIndex + 0];
-        const FVertex_& v1 = vertices[vertexIndex + 1];
-        const FVertex_& v2 = vertices[vertexIndex + 2];
+            dstPositions[v] = positions[corner.x];
 
-        sp_position3f[vertexIndex + 0] = positions[v0.Position - 1];
-        sp_position3f[vertexIndex + 1] = positions[v1.Position - 1];
-        sp_position3f[vertexIndex + 2] = positions[v2.Position - 1];
+            if (sp_texcoord2f)
+                dstTexcoords[v] = (corner.y != FObjChunk_::NoIndex ? texcoords[corner.y] : float2::Zero);
 
-        if (hasTexcoords) {
-            sp_texcoord2f[vertexIndex + 0] = texcoords[v0.Texcoord - 1];
-            sp_texcoord2f[vertexIndex + 1] = texcoords[v1.Texcoord - 1];
-            sp_texcoord2f[vertexIndex + 2] = texcoords[v2.Texcoord - 1];
-        }
+            if (sp_normal3f)
+                dstNormals[v] = (corner.z != FObjChunk_::NoIndex ? normals[corner.z] : float3::Zero);
 
-        if (hasNormals) {
-            sp_normal3f[vertexIndex + 0] = normals[v0.Normal - 1];
-            sp_normal3f[vertexIndex + 1] = normals[v1.Normal - 1];
-            sp_normal3f[vertexIndex + 2] = normals[v2.Normal - 1];
+            if (sp_color4f)
+                dstColors[v] = float4(colors[corner.x], 1.f);
         }
-
-        if (hasColors) {
-            sp_color4f[vertexIndex + 0] = float4(colors[v0.Position - 1], 1.f);
-            sp_color4f[vertexIndex + 1] = float4(colors[v1.Position - 1], 1.f);
-            sp_color4f[vertexIndex + 2] = float4(colors[v2.Position - 1], 1.f);
-        }
-
-        dst->AddTriangle(vertexIndex + 0, vertexIndex + 1, vertexIndex + 2);
-    }
+    });
 
     return true;
 }
@@ -22,6 +22,7 @@
 #include "Maths/ScalarVector.h"
 #include "Maths/ScalarVectorHelpers.h"
 #include "Maths/Transform.h"
+#include "Maths/WideMaths.h"
 #include "Maths/Quaternion.h"
 #include "Maths/QuaternionHelpers.h"
 #include "Memory/UniqueView.h"
@@ -57,103 +58,6 @@ struct FVertexCache {
     };
 };
 //----------------------------------------------------------------------------
-static float3 ComputeNormal_(const float3& p0, const float3& p1, const float3& p2) {
-#if 0
-    return Cross(Normalize(p1 - p0), Normalize(p2 - p1));
-#elif 0
-    const float3 p10 = SafeNormalize(p1 - p0);
-    const float3 p21 = SafeNormalize(p2 - p1);
-    const float3 p02 = SafeNormalize(p0 - p2);
-
-    const float3 c012 = Cross(p10, p02);
-    const float3 c102 = Cross(p10, p21);
-    const float3 c201 = Cross(p02, p21);
-
-    const float d012 = LengthSq(c012);
-    const float d102 = LengthSq(c102);
-    const float d201 = LengthSq(c201);
-
-    return (d012 > d102)
-        ? (d012 > d201 ? c012 : c201)
-        : (d102 > d201 ? c102 : c201);
-#else
-    // Newell's method: sum cross product of all consecutive edges
-    // https://www.khronos.org/opengl/wiki/Calculating_a_Surface_Normal
-
-    auto crossEdge = [](const double3& a, const double3& b) -> double3 {
-        return (double3(a - b).yzx * double3(a + b).zxy);
-    };
-
-    const double3 d0{ p0 };
-    const double3 d1{ p1 };
-    const double3 d2{ p2 };
-
-    const double3 normal = crossEdge(d0, d1) + crossEdge(d1, d2) + crossEdge(d2, d0);
-    return float3(normal);
-#endif
-}
-//----------------------------------------------------------------------------
-static void ComputeTriangleBasis_(
-    float3 *pTangent,
-    float3 *pBinormal,
-    const float3& pos0, const float3& pos1, const float3& pos2,
-    const float2& tex0, const float2& tex1, const float2& tex2 ) {
-    // triangle 0, 1, 2
-    const float3 pos10 = pos1 - pos0;
-    const float3 pos20 = pos2 - pos0;
-
-    const float2 tex10 = tex1 - tex0;
-    const float2 tex20 = tex2 - tex0;
-
-    const float f012 = (tex10.x * tex20.y -
-                        tex10.y * tex20.x );
-
-    // triangle 1, 0, 2
-    const float3 pos01 = pos0 - pos1;
-    const float3 pos21 = pos2 - pos1;
-
-    const float2 tex01 = tex0 - tex1;
-    const float2 tex21 = tex2 - tex1;
-
-    const float f102 = (tex01.x * tex21.y -
-                        tex01.y * tex21.x );
-
-    // triangle 2, 0, 1
-    const float3 pos02 = pos0 - pos2;
-    const float3 pos12 = pos1 - pos2;
-
-    const float2 tex02 = tex0 - tex2;
-    const float2 tex12 = tex1 - tex2;
-
-    const float f201 = (tex02.x * tex12.y -
-                        tex02.y * tex12.x );
-
-    if (Abs(f012) > Abs(f102)) {
-        if (Abs(f012) > Abs(f201)) {
-            const float f = (Abs(f012) < EpsilonSQ) ? 1.0f : 1.0f/f012;
-            *pTangent = ((pos10 * tex20.y) - (pos20 * tex10.y)) * f;
-            *pBinormal = ((pos20 * tex10.x) - (pos10 * tex20.x)) * f;
-        }
-        else {
-            const float f = (Abs(f201) < EpsilonSQ) ? 1.0f : 1.0f/f201;
-            *pTangent = ((pos01 * tex21.y) - (pos21 * tex01.y)) * f;
-            *pBinormal = ((pos21 * tex01.x) - (pos01 * tex21.x)) * f;
-        }
-    }
-    else {
-        if (Abs(f102) > Abs(f201)) {
-            const float f = (Abs(f102) < EpsilonSQ) ? 1.0f : 1.0f/f102;
-            *pTangent = ((pos01 * tex21.y) - (pos21 * tex01.y)) * f;
-            *pBinormal = ((pos21 * tex01.x) - (pos01 * tex21.x)) * f;
-        }
-        else {
-            const float f = (Abs(f201) < EpsilonSQ) ? 1.0f : 1.0f/f201;
-            *pTangent = ((pos02 * tex12.y) - (pos12 * tex02.y)) * f;
-            *pBinormal = ((pos12 * tex02.x) - (pos02 * tex12.x)) * f;
-        }
-    }
-}
-//----------------------------------------------------------------------------
 }//!namespace
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -195,225 +99,409 @@ FAabb4f ComputeSubPartBounds(const TGenericVertexSubPart<float4>& subPart) {
 }
 //----------------------------------------------------------------------------
 namespace {
-static void ComputeNormals_(
-    const FGenericMesh& mesh,
-    const FPositions3f& sp_position3f,
-    const FPositions4f& sp_position4f,
-    const FNormals3f& sp_normal3f ) {
-    Assert((!sp_position3f) ^ (!sp_position4f));
-
-    const u32 indexCount = mesh.IndexCount();
-    const u32 vertexCount = mesh.VertexCount();
+//----------------------------------------------------------------------------
+CONSTEXPR size_t TrianglesPerTask_ = 8192; // multiple of FWideFloat::Lanes
+CONSTEXPR size_t VerticesPerTask_ = 8192;
+STATIC_ASSERT(TrianglesPerTask_ % FWideFloat::Lanes == 0);
+//----------------------------------------------------------------------------
+static const float3& Position3_(const float3& p) { return p; }
+static float3 Position3_(const float4& p) { return p.xyz; }
+//----------------------------------------------------------------------------
+// triangle corners adjacent to each vertex: each vertex sums its own contributions, in index
+// order, so the vertices can be split between workers without atomics and with stable results
+struct FVertexCorners_ {
+    VECTOR(MeshBuilder, u32) Offsets; // vertexCount + 1
+    VECTOR(MeshBuilder, u32) Corners; // index of the corner in the indices (triangle * 3 + corner)
+
+    FVertexCorners_(const TMemoryView<const u32>& indices, size_t vertexCount) {
+        Offsets.resize(vertexCount + 1, 0);
+        for (u32 v : indices)
+            Offsets[v + 1]++;
+        forrange(v, 0, vertexCount)
+            Offsets[v + 1] += Offsets[v];
+
+        VECTOR(MeshBuilder, u32) cursors;
+        cursors.assign(Offsets.begin(), Offsets.end() - 1);
+
+        Corners.resize_Uninitialized(indices.size());
+        forrange(i, 0, indices.size())
+            Corners[cursors[indices[i]]++] = checked_cast<u32>(i);
+    }
 
-    Assert(!sp_position3f || sp_position3f.size() == vertexCount);
-    Assert(!sp_position4f || sp_position4f.size() == vertexCount);
+    TMemoryView<const u32> Adjacency(size_t v) const {
+        return Corners.MakeConstView().SubRange(Offsets[v], Offsets[v + 1] - Offsets[v]);
+    }
+};
+//----------------------------------------------------------------------------
+// per triangle values in SoA streams, padded to whole FWideFloat
+struct FTriangleStreams_ {
+    VECTOR(MeshBuilder, float) Data;
+    size_t Stride{ 0 };
+
+    FTriangleStreams_(size_t numTriangles, size_t numStreams) {
+        Stride = (((numTriangles + FWideFloat::Lanes - 1) / FWideFloat::Lanes) * FWideFloat::Lanes);
+        Data.resize_Uninitialized(Stride * numStreams);
+    }
 
-    const TMemoryView<const u32> indices = mesh.Indices();
-    const TMemoryView<float3> normals3f = sp_normal3f.Resize(vertexCount);
+    float* Stream(size_t s) { return (Data.data() + s * Stride); }
+    const float* Stream(size_t s) const { return (Data.data() + s * Stride); }
+};
+//----------------------------------------------------------------------------
+// transposes the corners of FWideFloat::Lanes triangles, the lanes past the last triangle are zeroed
+template <typename _Position>
+static void GatherTriangles_(
+    FWideFloat3 (&p)[3],
+    FWideFloat (&uv)[3][2],
+    const TMemoryView<const u32>& indices,
+    const TMemoryView<const _Position>& positions,
+    const TMemoryView<const float2>& texcoords,
+    size_t firstTriangle, size_t numTriangles ) {
+    ALIGN(32) float px[3][FWideFloat::Lanes], py[3][FWideFloat::Lanes], pz[3][FWideFloat::Lanes];
+    ALIGN(32) float tu[3][FWideFloat::Lanes], tv[3][FWideFloat::Lanes];
+
+    forrange(lane, 0, FWideFloat::Lanes) {
+        const size_t t = (firstTriangle + lane);
+        forrange(c, 0, 3) {
+            if (t < numTriangles) {
+                const u32 v = indices[t * 3 + c];
+                const float3 pos = Position3_(positions[v]);
+                px[c][lane] = pos.x;
+                py[c][lane] = pos.y;
+                pz[c][lane] = pos.z;
+                tu[c][lane] = texcoords[v].x;
+                tv[c][lane] = texcoords[v].y;
+            }
+            else {
+                px[c][lane] = py[c][lane] = pz[c][lane] = 0;
+                tu[c][lane] = tv[c][lane] = 0;
+            }
+        }
+    }
 
-    const float3 zero = float3::Zero;
-    for (float3& n : normals3f)
-        n = zero;
+    forrange(c, 0, 3) {
+        p[c] = FWideFloat3{ FWideFloat::LoadAligned(px[c]), FWideFloat::LoadAligned(py[c]), FWideFloat::LoadAligned(pz[c]) };
+        uv[c][0] = FWideFloat::LoadAligned(tu[c]);
+        uv[c][1] = FWideFloat::LoadAligned(tv[c]);
+    }
+}
+//----------------------------------------------------------------------------
+static float3 ComputeNormal_(const float3& p0, const float3& p1, const float3& p2) {
+    // Newell's method: sum cross product of all consecutive edges
+    // https://www.khronos.org/opengl/wiki/Calculating_a_Surface_Normal
 
-    if (sp_position4f) {
-        Assert(!sp_position3f);
-        const TMemoryView<const float4> positions4f = sp_position4f.MakeView();
-        Assert(positions4f.size() == mesh.VertexCount());
+    auto crossEdge = [](const double3& a, const double3& b) -> double3 {
+        return (double3(a - b).yzx * double3(a + b).zxy);
+    };
 
-        for (u32 t = 0; t < indexCount; t += 3) {
-            const u32 i0 = indices[t + 0];
-            const u32 i1 = indices[t + 1];
-            const u32 i2 = indices[t + 2];
+    const double3 d0{ p0 };
+    const double3 d1{ p1 };
+    const double3 d2{ p2 };
 
+    const double3 normal = crossEdge(d0, d1) + crossEdge(d1, d2) + crossEdge(d2, d0);
+    return float3(normal);
+}
+//----------------------------------------------------------------------------
+// area weighted face normals (twice the area), accumulated in double precision: 3 streams
+template <typename _Position>
+static void ComputeFaceNormals_(
+    FTriangleStreams_& faces,
+    const TMemoryView<const u32>& indices,
+    const TMemoryView<const _Position>& positions ) {
+    const size_t numTriangles = (indices.size() / 3);
+
+    ParallelFor(0, (numTriangles + TrianglesPerTask_ - 1) / TrianglesPerTask_, [&](size_t chunk) {
+        const size_t last = Min(numTriangles, (chunk + 1) * TrianglesPerTask_);
+        forrange(t, chunk * TrianglesPerTask_, last) {
             const float3 n = ComputeNormal_(
-                positions4f[i0].xyz,
-                positions4f[i1].xyz,
-                positions4f[i2].xyz );
+                Position3_(positions[indices[t * 3 + 0]]),
+                Position3_(positions[indices[t * 3 + 1]]),
+                Position3_(positions[indices[t * 3 + 2]]) );
 
-            normals3f[i0] += n;
-            normals3f[i1] += n;
-            normals3f[i2] += n;
+            faces.Stream(0)[t] = n.x;
+            faces.Stream(1)[t] = n.y;
+            faces.Stream(2)[t] = n.z;
         }
-    }
-    else {
-        Assert(!sp_position4f);
-        const TMemoryView<const float3> positions3f = sp_position3f.MakeView();
-
-        for (u32 t = 0; t < indexCount; t += 3) {
-            const u32 i0 = indices[t + 0];
-            const u32 i1 = indices[t + 1];
-            const u32 i2 = indices[t + 2];
-
-            const float3 n = ComputeNormal_(
-                positions3f[i0],
-                positions3f[i1],
-                positions3f[i2] );
+    });
+}
+//----------------------------------------------------------------------------
+// unnormalized tangents and binormals of each triangle, plus the sign of its uv area: 7 streams
+template <typename _Position>
+static void ComputeFaceBases_(
+    FTriangleStreams_& faces,
+    const TMemoryView<const u32>& indices,
+    const TMemoryView<const _Position>& positions,
+    const TMemoryView<const float2>& texcoords ) {
+    const size_t numTriangles = (indices.size() / 3);
+
+    const FWideFloat zero = FWideFloat::Zero();
+    const FWideFloat one = FWideFloat::Broadcast(1.f);
+    const FWideFloat epsilon = FWideFloat::Broadcast(EpsilonSQ);
+
+    ParallelFor(0, (numTriangles + TrianglesPerTask_ - 1) / TrianglesPerTask_, [&](size_t chunk) {
+        const size_t last = Min(numTriangles, (chunk + 1) * TrianglesPerTask_);
+        for (size_t t = chunk * TrianglesPerTask_; t < last; t += FWideFloat::Lanes) {
+            FWideFloat3 p[3];
+            FWideFloat uv[3][2];
+            GatherTriangles_(p, uv, indices, positions, texcoords, t, numTriangles);
+
+            // basis seen from corner c, returns the uv area (degenerate uvs keep the raw edges)
+            const auto cornerBasis = [&](FWideFloat3* pTangent, FWideFloat3* pBinormal, size_t c) -> FWideFloat {
+                const size_t c1 = (c + 1) % 3;
+                const size_t c2 = (c + 2) % 3;
+
+                const FWideFloat3 e1 = (p[c1] - p[c]);
+                const FWideFloat3 e2 = (p[c2] - p[c]);
+                const FWideFloat du1 = (uv[c1][0] - uv[c][0]);
+                const FWideFloat dv1 = (uv[c1][1] - uv[c][1]);
+                const FWideFloat du2 = (uv[c2][0] - uv[c][0]);
+                const FWideFloat dv2 = (uv[c2][1] - uv[c][1]);
+
+                const FWideFloat det = (du1 * dv2 - du2 * dv1);
+                const FWideFloat r = Rcp(Select(Abs(det) < epsilon, one, det));
+
+                *pTangent = (e1 * dv2 - e2 * dv1) * r;
+                *pBinormal = (e2 * du1 - e1 * du2) * r;
+                return det;
+            };
+
+            // keep the corner with the largest uv area, it's the most precise one (the last corner wins the ties)
+            FWideFloat3 tangent, binormal;
+            FWideFloat det = cornerBasis(&tangent, &binormal, 2);
+            for (size_t c : { 1, 0 }) {
+                FWideFloat3 cornerTangent, cornerBinormal;
+                const FWideFloat cornerDet = cornerBasis(&cornerTangent, &cornerBinormal, c);
+
+                const FWideFloat better = (Abs(cornerDet) > Abs(det));
+                tangent = Select(better, cornerTangent, tangent);
+                binormal = Select(better, cornerBinormal, binormal);
+                det = Select(better, cornerDet, det);
+            }
 
-            normals3f[i0] += n;
-            normals3f[i1] += n;
-            normals3f[i2] += n;
+            tangent.Store(faces.Stream(0) + t, faces.Stream(1) + t, faces.Stream(2) + t);
+            binormal.Store(faces.Stream(3) + t, faces.Stream(4) + t, faces.Stream(5) + t);
+            Select(det < zero, -one, one).Store(faces.Stream(6) + t);
         }
-    }
-
-    for (float3& n : normals3f)
-        n = Normalize(n);
+    });
 }
-} //!namespace
 //----------------------------------------------------------------------------
-bool ComputeNormals(FGenericMesh& mesh, size_t index) {
-    const TGenericVertexSubPart<float3> sp_position3f = mesh.Position3f_IFP(index);
-    const TGenericVertexSubPart<float4> sp_position4f = mesh.Position4f_IFP(index);
-    if (!sp_position3f && !sp_position4f)
-        return false;
+template <typename _Position>
+static void ComputeNormals_(
+    const FGenericMesh& mesh,
+    const TMemoryView<const _Position>& positions,
+    const FNormals3f& sp_normal3f ) {
+    const size_t vertexCount = mesh.VertexCount();
+    Assert(positions.size() == vertexCount);
 
-    TGenericVertexSubPart<float3> sp_normal3f = mesh.Normal3f(index);
-    Assert(sp_normal3f);
+    const TMemoryView<const u32> indices = mesh.Indices();
+    const TMemoryView<float3> normals3f = sp_normal3f.Resize(vertexCount, false);
 
-    ComputeNormals_(mesh, sp_position3f, sp_position4f, sp_normal3f);
+    FTriangleStreams_ faces{ indices.size() / 3, 3 };
+    ComputeFaceNormals_(faces, indices, positions);
 
-    return true;
+    const FVertexCorners_ adjacency{ indices, vertexCount };
+
+    ParallelFor(0, (vertexCount + VerticesPerTask_ - 1) / VerticesPerTask_, [&](size_t chunk) {
+        const size_t last = Min(vertexCount, (chunk + 1) * VerticesPerTask_);
+        forrange(v, chunk * VerticesPerTask_, last) {
+            float3 n = float3::Zero;
+            for (u32 corner : adjacency.Adjacency(v)) {
+                const u32 t = (corner / 3);
+                n += float3(faces.Stream(0)[t], faces.Stream(1)[t], faces.Stream(2)[t]);
+            }
+            normals3f[v] = SafeNormalize(n);
+        }
+    });
 }
 //----------------------------------------------------------------------------
-void ComputeNormals(const FGenericMesh& mesh, const FPositions3f& positions, const FNormals3f& normals) {
-    Assert(positions);
-    Assert(normals);
+// area weighted sum of the triangle bases, orthogonalized against the vertex normal
+static void AveragedTangentSpace_(
+    float3* pTangent, float3* pBinormal, bool* pLeftHanded,
+    const FTriangleStreams_& faces,
+    const TMemoryView<const u32>& corners,
+    const float3& normal ) {
+    float3 tangent = float3::Zero;
+    float3 binormal = float3::Zero;
+    for (u32 corner : corners) {
+        const u32 t = (corner / 3);
+        tangent += float3(faces.Stream(0)[t], faces.Stream(1)[t], faces.Stream(2)[t]);
+        binormal += float3(faces.Stream(3)[t], faces.Stream(4)[t], faces.Stream(5)[t]);
+    }
 
-    ComputeNormals_(mesh, positions, FPositions4f(), normals);
+    if (float3(0) == tangent && float3(0) == binormal) {
+        tangent = float3(1, 0, 0);
+        binormal = Cross(normal, tangent);
+    }
+    else if (float3(0) == tangent) {
+        binormal = SafeNormalize(binormal);
+        tangent = Cross(normal, binormal);
+    }
+    else if (float3(0) == binormal) {
+        tangent = SafeNormalize(tangent);
+        binormal = Cross(normal, tangent);
+    }
+    else {
+        tangent = SafeNormalize(tangent);
+        binormal = SafeNormalize(binormal);
+    }
+
+    //Gram-Schmidt orthogonalization
+    tangent = SafeNormalize(tangent - normal * Dot(normal, tangent));
+
+    //Right handed TBN space ?
+    *pLeftHanded = (Dot(Cross(tangent, binormal), normal) < 0);
+    *pTangent = tangent;
+    *pBinormal = (*pLeftHanded ? -binormal : binormal);
 }
 //----------------------------------------------------------------------------
-void ComputeNormals(const FGenericMesh& mesh, const FPositions4f& positions, const FNormals3f& normals) {
-    Assert(positions);
-    Assert(normals);
+// http://www.mikktspace.com/ : triangle tangents are projected on the plane of the vertex normal,
+// normalized and weighted by the angle of the corner, then the sign of the uv area gives the handedness.
+// Unlike the reference implementation vertices are never split, the indexed mesh is kept as is.
+template <typename _Position>
+static void MikkTSpace_(
+    float3* pTangent, float3* pBinormal, bool* pLeftHanded,
+    const FTriangleStreams_& faces,
+    const TMemoryView<const u32>& corners,
+    const float3& normal,
+    const TMemoryView<const u32>& indices,
+    const TMemoryView<const _Position>& positions ) {
+    float3 tangent = float3::Zero;
+    float orientation = 0;
+    for (u32 corner : corners) {
+        const u32 t = (corner / 3);
+        const u32 c = (corner % 3);
+
+        const float3 faceTangent{ faces.Stream(0)[t], faces.Stream(1)[t], faces.Stream(2)[t] };
+        const float3 projected = (faceTangent - normal * Dot(normal, faceTangent));
+        const float lengthSq = LengthSq(projected);
+        if (not (lengthSq > 0))
+            continue;
+
+        const float3 p0 = Position3_(positions[indices[t * 3 + c]]);
+        const float3 p1 = Position3_(positions[indices[t * 3 + (c + 1) % 3]]);
+        const float3 p2 = Position3_(positions[indices[t * 3 + (c + 2) % 3]]);
+
+        const float3 e1 = SafeNormalize((p1 - p0) - normal * Dot(normal, p1 - p0));
+        const float3 e2 = SafeNormalize((p2 - p0) - normal * Dot(normal, p2 - p0));
+        const float angle = Acos(Dot(e1, e2));
+
+        tangent += projected * (angle / Sqrt(lengthSq));
+        orientation += faces.Stream(6)[t] * angle;
+    }
+
+    if (not (LengthSq(tangent) > 0)) {
+        // any direction orthogonal to the normal
+        tangent = (Abs(normal.x) < 0.9f ? float3(1, 0, 0) : float3(0, 1, 0));
+        tangent = SafeNormalize(tangent - normal * Dot(normal, tangent));
+    }
+    else {
+        tangent = SafeNormalize(tangent);
+    }
 
-    ComputeNormals_(mesh, FPositions3f(), positions, normals);
+    // binormal = sign * cross(normal, tangent)
+    *pLeftHanded = (orientation < 0);
+    *pTangent = tangent;
+    *pBinormal = Cross(normal, tangent) * (*pLeftHanded ? -1.f : 1.f);
 }
 //----------------------------------------------------------------------------
-//////////////////////////////////////////////////////////////////////////////
-//----------------------------------------------------------------------------
-namespace {
+template <typename _Position>
 static void ComputeTangentSpace_(
     const FGenericMesh& mesh,
-    const FPositions3f& sp_position3f,
-    const FPositions4f& sp_position4f,
+    const TMemoryView<const _Position>& positions,
     const FTexcoords2f& sp_texcoord2f,
     const FNormals3f& sp_normal3f,
     const FTangents3f& sp_tangent3f,
     const FTangents4f& sp_tangent4f,
-    const FBinormals3f& sp_binormal3f ) {
-    Assert((!sp_position3f) ^ (!sp_position4f));
+    const FBinormals3f& sp_binormal3f,
+    ETangentSpace mode ) {
     Assert((!sp_tangent4f) ^ (!sp_tangent3f));
+    Assert(!sp_tangent3f || sp_binormal3f);
 
-    const u32 indexCount = mesh.IndexCount();
-    const u32 vertexCount = mesh.VertexCount();
+    const size_t vertexCount = mesh.VertexCount();
 
-    Assert(!sp_position3f || sp_position3f.size() == vertexCount);
-    Assert(!sp_position4f || sp_position4f.size() == vertexCount);
+    Assert(positions.size() == vertexCount);
     Assert(sp_texcoord2f.size() == vertexCount);
     Assert(sp_normal3f.size() == vertexCount);
 
     const TMemoryView<const u32> indices = mesh.Indices();
-
-    const TMemoryView<const float3> positions3f = sp_position3f.MakeView();
-    const TMemoryView<const float4> positions4f = sp_position4f.MakeView();
     const TMemoryView<const float2> texcoords2f = sp_texcoord2f.MakeView();
     const TMemoryView<const float3> normals3f = sp_normal3f.MakeView();
 
-    VECTOR(MeshBuilder, float3) tmpTangents3f;
-    VECTOR(MeshBuilder, float3) tmpBinormals3f;
-
     TMemoryView<float3> tangents3f;
     TMemoryView<float4> tangents4f;
     TMemoryView<float3> binormals3f;
     if (sp_tangent4f) {
-        tmpTangents3f.resize_AssumeEmpty(vertexCount);
-        tmpBinormals3f.reserve_AssumeEmpty(vertexCount);
-
-        tangents3f = tmpTangents3f.MakeView();
-        binormals3f = tmpBinormals3f.MakeView();
-
-        tangents4f = sp_tangent4f.Resize(vertexCount);
+        tangents4f = sp_tangent4f.Resize(vertexCount, false);
     }
     else {
-        tangents3f = sp_tangent3f.Resize(vertexCount);
-        binormals3f = sp_binormal3f.Resize(vertexCount);
+        tangents3f = sp_tangent3f.Resize(vertexCount, false);
+        binormals3f = sp_binormal3f.Resize(vertexCount, false);
     }
 
-    const float3 zero = float3::Zero;
-    for (u32 i = 0; i < vertexCount; ++i)
-        tangents3f[i] = binormals3f[i] = zero;
-
-    for (u32 i = 0; i < indexCount; i += 3) {
-        const u32 i0 = indices[i + 0];
-        const u32 i1 = indices[i + 1];
-        const u32 i2 = indices[i + 2];
-
-        float3 tangent;
-        float3 binormal;
-
-        if (sp_position3f) {
-            ComputeTriangleBasis_(
-                &tangent, &binormal,
-                positions3f[i0], positions3f[i1], positions3f[i2],
-                texcoords2f[i0], texcoords2f[i1], texcoords2f[i2] );
-        }
-        else {
-            ComputeTriangleBasis_(
-                &tangent, &binormal,
-                positions4f[i0].xyz, positions4f[i1].xyz, positions4f[i2].xyz,
-                texcoords2f[i0], texcoords2f[i1], texcoords2f[i2] );
-        }
+    FTriangleStreams_ faces{ indices.size() / 3, 7 };
+    ComputeFaceBases_(faces, indices, positions, texcoords2f);
 
-        tangents3f[i0] += tangent;
-        tangents3f[i1] += tangent;
-        tangents3f[i2] += tangent;
+    const FVertexCorners_ adjacency{ indices, vertexCount };
 
-        binormals3f[i0] += binormal;
-        binormals3f[i1] += binormal;
-        binormals3f[i2] += binormal;
-    }
+    ParallelFor(0, (vertexCount + VerticesPerTask_ - 1) / VerticesPerTask_, [&](size_t chunk) {
+        const size_t last = Min(vertexCount, (chunk + 1) * VerticesPerTask_);
+        forrange(v, chunk * VerticesPerTask_, last) {
+            float3 tangent, binormal;
+            bool leftHanded;
 
-    ParallelFor(0, vertexCount, [&](size_t i) {
-        float3& tangent = tangents3f[i];
-        float3& binormal = binormals3f[i];
+            if (ETangentSpace::MikkTSpace == mode)
+                MikkTSpace_(&tangent, &binormal, &leftHanded, faces, adjacency.Adjacency(v), normals3f[v], indices, positions);
+            else
+                AveragedTangentSpace_(&tangent, &binormal, &leftHanded, faces, adjacency.Adjacency(v), normals3f[v]);
 
-        const float3& normal = normals3f[i];
-        if (float3(0) == tangent && float3(0) == binormal) {
-            tangent = float3(1, 0, 0);
-            binormal = Cross(normal, tangent);
-        }
-        else if (float3(0) == tangent) {
-            Assert(float3(0) != binormal);
-            binormal = SafeNormalize(binormal);
-            tangent = Cross(normal, binormal);
-        }
-        else if (float3(0) == binormal) {
-            Assert(float3(0) != tangent);
-            tangent = SafeNormalize(tangent);
-            binormal = Cross(normal, tangent);
-        }
-        else {
-            tangent = SafeNormalize(tangent);
-            binormal = SafeNormalize(binormal);
+            //Handedness packing IFP
+            if (not tangents4f.empty()) {
+                tangents4f[v] = (ETangentSpace::MikkTSpace == mode
+                    ? float4(tangent, leftHanded ? -1.0f : 1.0f)
+                    : float4(tangent, leftHanded ? 1.0f : 0.0f) );
+            }
+            else {
+                tangents3f[v] = tangent;
+                binormals3f[v] = binormal;
+            }
         }
+    });
+}
+} //!namespace
+//----------------------------------------------------------------------------
+bool ComputeNormals(FGenericMesh& mesh, size_t index) {
+    const TGenericVertexSubPart<float3> sp_position3f = mesh.Position3f_IFP(index);
+    const TGenericVertexSubPart<float4> sp_position4f = mesh.Position4f_IFP(index);
+    if (!sp_position3f && !sp_position4f)
+        return false;
 
-        //Gram-Schmidt orthogonalization
-        tangent = SafeNormalize(tangent - normal * Dot(normal, tangent));
+    TGenericVertexSubPart<float3> sp_normal3f = mesh.Normal3f(index);
+    Assert(sp_normal3f);
 
-        //Right handed TBN space ?
-        const bool leftHanded = (Dot(Cross(tangent, binormal), normal) < 0);
+    if (sp_position3f)
+        ComputeNormals_<float3>(mesh, sp_position3f.MakeView(), sp_normal3f);
+    else
+        ComputeNormals_<float4>(mesh, sp_position4f.MakeView(), sp_normal3f);
 
-        //Handedness packing IFP
-        if (leftHanded) {
-            binormal = -binormal;
+    return true;
+}
+//----------------------------------------------------------------------------
+void ComputeNormals(const FGenericMesh& mesh, const FPositions3f& positions, const FNormals3f& normals) {
+    Assert(positions);
+    Assert(normals);
 
-            if (sp_tangent4f)
-                tangents4f[i] = float4(tangent, leftHanded ? 1.0f : 0.0f);
-        }
-    });
+    ComputeNormals_<float3>(mesh, positions.MakeView(), normals);
 }
-} //!namespace
 //----------------------------------------------------------------------------
-bool ComputeTangentSpace(FGenericMesh& mesh, size_t index, bool packHandedness/* = false */) {
+void ComputeNormals(const FGenericMesh& mesh, const FPositions4f& positions, const FNormals3f& normals) {
+    Assert(positions);
+    Assert(normals);
+
+    ComputeNormals_<float4>(mesh, positions.MakeView(), normals);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+bool ComputeTangentSpace(FGenericMesh& mesh, size_t index, bool packHandedness/* = false */, ETangentSpace mode/* = Default */) {
     const TGenericVertexSubPart<float3> sp_position3f = mesh.Position3f_IFP(index);
     const TGenericVertexSubPart<float4> sp_position4f = mesh.Position4f_IFP(index);
     if (!sp_position3f && !sp_position4f)
@@ -446,25 +534,28 @@ bool ComputeTangentSpace(FGenericMesh& mesh, size_t index, bool packHandedness/*
         Assert(sp_binormal3f);
     }
 
-    ComputeTangentSpace_(mesh, sp_position3f, sp_position4f, sp_texcoord2f, sp_normal3f, sp_tangent3f, sp_tangent4f, sp_binormal3f);
+    if (sp_position3f)
+        ComputeTangentSpace_<float3>(mesh, sp_position3f.MakeView(), sp_texcoord2f, sp_normal3f, sp_tangent3f, sp_tangent4f, sp_binormal3f, mode);
+    else
+        ComputeTangentSpace_<float4>(mesh, sp_position4f.MakeView(), sp_texcoord2f, sp_normal3f, sp_tangent3f, sp_tangent4f, sp_binormal3f, mode);
 
     return true;
 }
 //----------------------------------------------------------------------------
-void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals) {
-    ComputeTangentSpace_(mesh, positions, FPositions4f(), uv, normals, tangents, FTangents4f(), binormals);
+void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals, ETangentSpace mode/* = Default */) {
+    ComputeTangentSpace_<float3>(mesh, positions.MakeView(), uv, normals, tangents, FTangents4f(), binormals, mode);
 }
 //----------------------------------------------------------------------------
-void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals) {
-    ComputeTangentSpace_(mesh, FPositions3f(), positions, uv, normals, tangents, FTangents4f(), binormals);
+void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals, ETangentSpace mode/* = Default */) {
+    ComputeTangentSpace_<float4>(mesh, positions.MakeView(), uv, normals, tangents, FTangents4f(), binormals, mode);
 }
 //----------------------------------------------------------------------------
-void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents) {
-    ComputeTangentSpace_(mesh, positions, FPositions4f(), uv, normals, FTangents3f(), tangents, FBinormals3f());
+void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents, ETangentSpace mode/* = Default */) {
+    ComputeTangentSpace_<float3>(mesh, positions.MakeView(), uv, normals, FTangents3f(), tangents, FBinormals3f(), mode);
 }
 //----------------------------------------------------------------------------
-void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents) {
-    ComputeTangentSpace_(mesh, FPositions3f(), positions, uv, normals, FTangents3f(), tangents, FBinormals3f());
+void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents, ETangentSpace mode/* = Default */) {
+    ComputeTangentSpace_<float4>(mesh, positions.MakeView(), uv, normals, FTangents3f(), tangents, FBinormals3f(), mode);
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
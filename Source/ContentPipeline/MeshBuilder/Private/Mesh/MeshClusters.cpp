@@ -0,0 +1,807 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Mesh/MeshClusters.h"
+
+#include "Mesh/GenericMesh.h"
+#include "Mesh/GenericMeshHelpers.h"
+#include "Mesh/MeshSimplifier.h"
+
+#include "Diagnostic/Logger.h"
+#include "IO/StreamProvider.h"
+#include "Maths/LinearOctree.h"
+#include "Maths/MathHelpers.h"
+#include "Maths/ScalarBoundingBox.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Thread/Task/TaskHelpers.h"
+
+#include <algorithm>
+
+// https://advances.realtimerendering.com/s2021/Karis_Nanite_SIGGRAPH_Advances_2021_final.pdf
+// https://github.com/zeux/meshoptimizer/blob/master/src/clusterizer.cpp (normal cones)
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+CONSTEXPR size_t ChunkTriangles_ = 64 * 1024; // triangles per parallel task for level 0
+CONSTEXPR float MinGroupReduction_ = 0.85f; // groups keeping more triangles than this ratio become roots
+CONSTEXPR u32 DAGMagic_ = 0x44434D50ul; // 'PMCD'
+CONSTEXPR u32 DAGVersion_ = 1;
+CONSTEXPR u8 NoSlot_ = 0xFF;
+//----------------------------------------------------------------------------
+struct FClusterBuffers_ {
+    VECTOR(MeshBuilder, FMeshCluster) Clusters;
+    VECTOR(MeshBuilder, u32) Vertices;
+    VECTOR(MeshBuilder, u8) Triangles;
+};
+//----------------------------------------------------------------------------
+struct FGroupResult_ {
+    FClusterBuffers_ Buffers;
+    float Error{ 0 };
+    bool Simplified{ false };
+};
+//----------------------------------------------------------------------------
+struct FClusterNeighbor_ {
+    u32 Cluster;
+    u32 SharedVertices;
+};
+//----------------------------------------------------------------------------
+static float3 TriangleCentroid_(const TMemoryView<const float3>& positions, const u32* triangle) {
+    return ((positions[triangle[0]] + positions[triangle[1]] + positions[triangle[2]]) * (1.0f / 3.0f));
+}
+//----------------------------------------------------------------------------
+// grows the first sphere to enclose the second one
+static void MergeSpheres_(float3* pCenter, float* pRadius, const float3& center, float radius) {
+    const float3 delta = (center - *pCenter);
+    const float distance = Length(delta);
+
+    if (*pRadius >= distance + radius)
+        return;
+
+    if (radius >= distance + *pRadius) {
+        *pCenter = center;
+        *pRadius = radius;
+        return;
+    }
+
+    const float merged = ((distance + *pRadius + radius) * 0.5f);
+    *pCenter += delta * ((merged - *pRadius) / distance);
+    *pRadius = merged;
+}
+//----------------------------------------------------------------------------
+static void FinalizeCluster_(
+    FMeshCluster* pCluster,
+    const TMemoryView<const float3>& positions,
+    const TMemoryView<const u32>& vertices,
+    const TMemoryView<const u8>& triangles ) {
+    FMeshCluster& cluster = *pCluster;
+
+    FAabb3f bounds = FAabb3f::EmptyValue();
+    for (u32 v : vertices)
+        bounds.Add(positions[v]);
+
+    cluster.Center = bounds.Center();
+
+    float radiusSq = 0;
+    for (u32 v : vertices)
+        radiusSq = Max(radiusSq, DistanceSq(cluster.Center, positions[v]));
+
+    cluster.Radius = Sqrt(radiusSq);
+
+    // the cone axis averages the triangle normals, the cutoff is given by the widest of them
+    float3 normals[255];
+    size_t numNormals = 0;
+    float3 axis = float3::Zero;
+
+    forrange(t, 0, triangles.size() / 3) {
+        const float3& p0 = positions[vertices[triangles[t * 3 + 0]]];
+        const float3& p1 = positions[vertices[triangles[t * 3 + 1]]];
+        const float3& p2 = positions[vertices[triangles[t * 3 + 2]]];
+
+        const float3 normal = Cross(p1 - p0, p2 - p0);
+        const float area2 = Length(normal);
+        if (not (area2 > 0))
+            continue;
+
+        normals[numNormals] = (normal / area2);
+        axis += normals[numNormals++];
+    }
+
+    cluster.ConeAxis = float3::Zero;
+    cluster.ConeCutoff = 1.0f;
+
+    if (numNormals && LengthSq(axis) > 0) {
+        axis = Normalize(axis);
+
+        float minDot = 1.0f;
+        forrange(n, 0, numNormals)
+            minDot = Min(minDot, Dot(axis, normals[n]));
+
+        if (minDot > 0) {
+            cluster.ConeAxis = axis;
+            cluster.ConeCutoff = Sqrt(Max(0.0f, 1.0f - minDot * minDot));
+        }
+    }
+
+    cluster.Group = FMeshCluster::NoGroup;
+    cluster.LodCenter = cluster.Center;
+    cluster.LodRadius = cluster.Radius;
+    cluster.LodError = 0;
+    cluster.ParentCenter = cluster.Center;
+    cluster.ParentRadius = cluster.Radius;
+    cluster.ParentError = FLT_MAX;
+}
+//----------------------------------------------------------------------------
+// greedy meshlet builder: grows each cluster with the adjacent triangle adding the fewest vertices,
+// ties are broken by the distance to the centroid of the cluster to keep it compact
+class FMeshletBuilder_ {
+public:
+    FMeshletBuilder_(const TMemoryView<const float3>& positions, const FMeshClusterDAG::FSettings& settings) NOEXCEPT
+    :   _positions(positions)
+    ,   _settings(settings)
+    {}
+
+    // indices reference the mesh vertices, the triangles are visited in order to seed new clusters
+    void Build(const TMemoryView<const u32>& indices, FClusterBuffers_* pOutput);
+
+private:
+    void AddTriangle_(u32 t, FMeshCluster* pCluster, FClusterBuffers_* pOutput);
+
+    TMemoryView<const float3> _positions;
+    const FMeshClusterDAG::FSettings& _settings;
+    TMemoryView<const u32> _indices;
+
+    VECTOR(MeshBuilder, u32) _vertices; // local -> mesh vertex, sorted
+    VECTOR(MeshBuilder, u32) _localIndices;
+    VECTOR(MeshBuilder, u32) _adjacencyOffsets; // local vertex -> first triangle in _adjacency
+    VECTOR(MeshBuilder, u32) _adjacency;
+    VECTOR(MeshBuilder, u8) _used;
+    VECTOR(MeshBuilder, u8) _candidate;
+    VECTOR(MeshBuilder, u8) _slots; // local vertex -> index in the current cluster, or NoSlot_
+    VECTOR(MeshBuilder, u32) _candidates;
+    VECTOR(MeshBuilder, u32) _clusterVertices; // local vertices in the current cluster
+    float3 _centroidSum{ float3::Zero };
+};
+//----------------------------------------------------------------------------
+void FMeshletBuilder_::Build(const TMemoryView<const u32>& indices, FClusterBuffers_* pOutput) {
+    Assert(pOutput);
+    Assert_NoAssume(indices.size() % 3 == 0);
+
+    _indices = indices;
+
+    _vertices.assign(indices.begin(), indices.end());
+    std::sort(_vertices.begin(), _vertices.end());
+    _vertices.erase(std::unique(_vertices.begin(), _vertices.end()), _vertices.end());
+
+    const size_t numVertices = _vertices.size();
+    const size_t numTriangles = (indices.size() / 3);
+
+    _localIndices.resize_Uninitialized(indices.size());
+    forrange(i, 0, indices.size())
+        _localIndices[i] = checked_cast<u32>(std::lower_bound(_vertices.begin(), _vertices.end(), indices[i]) - _vertices.begin());
+
+    // vertex -> triangles adjacency
+    _adjacencyOffsets.clear();
+    _adjacencyOffsets.resize(numVertices + 1, 0);
+    for (u32 v : _localIndices)
+        _adjacencyOffsets[v + 1]++;
+    forrange(v, 0, numVertices)
+        _adjacencyOffsets[v + 1] += _adjacencyOffsets[v];
+
+    _adjacency.resize_Uninitialized(indices.size());
+    _clusterVertices.assign(_adjacencyOffsets.begin(), _adjacencyOffsets.end() - 1); // used as insertion cursors
+    forrange(i, 0, indices.size())
+        _adjacency[_clusterVertices[_localIndices[i]]++] = checked_cast<u32>(i / 3);
+
+    _used.clear();
+    _used.resize(numTriangles, u8(0));
+    _candidate.clear();
+    _candidate.resize(numTriangles, u8(0));
+    _slots.clear();
+    _slots.resize(numVertices, NoSlot_);
+
+    for (u32 seed = 0; seed < numTriangles; ++seed) {
+        if (_used[seed])
+            continue;
+
+        FMeshCluster cluster;
+        cluster.FirstVertex = checked_cast<u32>(pOutput->Vertices.size());
+        cluster.FirstTriangle = checked_cast<u32>(pOutput->Triangles.size() / 3);
+        cluster.NumVertices = 0;
+        cluster.NumTriangles = 0;
+        cluster.Level = 0;
+
+        _candidates.clear();
+        _clusterVertices.clear();
+        _centroidSum = float3::Zero;
+
+        AddTriangle_(seed, &cluster, pOutput);
+
+        while (cluster.NumTriangles < _settings.MaxTriangles) {
+            const float3 centroid = (_centroidSum / float(cluster.NumTriangles));
+
+            u32 best = UMax;
+            u32 bestNewVertices = 4;
+            float bestDistanceSq = FLT_MAX;
+
+            // drops the candidates which were used or can't fit anymore, vertex count only grows
+            for (size_t i = 0; i < _candidates.size(); ) {
+                const u32 t = _candidates[i];
+
+                u32 newVertices = 0;
+                if (not _used[t]) {
+                    forrange(c, 0, 3)
+                        newVertices += (NoSlot_ == _slots[_localIndices[t * 3 + c]] ? 1 : 0);
+                }
+
+                if (_used[t] || cluster.NumVertices + newVertices > _settings.MaxVertices) {
+                    _candidate[t] = 0;
+                    _candidates[i] = _candidates.back();
+                    _candidates.pop_back();
+                    continue;
+                }
+
+                const float distanceSq = DistanceSq(centroid, TriangleCentroid_(_positions, &indices[t * 3]));
+                if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distanceSq < bestDistanceSq)) {
+                    best = t;
+                    bestNewVertices = newVertices;
+                    bestDistanceSq = distanceSq;
+                }
+
+                ++i;
+            }
+
+            if (UMax == best)
+                break;
+
+            AddTriangle_(best, &cluster, pOutput);
+        }
+
+        for (u32 t : _candidates)
+            _candidate[t] = 0;
+        for (u32 v : _clusterVertices)
+            _slots[v] = NoSlot_;
+
+        FinalizeCluster_(&cluster, _positions,
+            pOutput->Vertices.MakeConstView().SubRange(cluster.FirstVertex, cluster.NumVertices),
+            pOutput->Triangles.MakeConstView().SubRange(cluster.FirstTriangle * 3, cluster.NumTriangles * 3) );
+
+        pOutput->Clusters.push_back(cluster);
+    }
+}
+//----------------------------------------------------------------------------
+void FMeshletBuilder_::AddTriangle_(u32 t, FMeshCluster* pCluster, FClusterBuffers_* pOutput) {
+    Assert(not _used[t]);
+    _used[t] = 1;
+
+    forrange(c, 0, 3) {
+        const u32 v = _localIndices[t * 3 + c];
+        if (NoSlot_ == _slots[v]) {
+            _slots[v] = pCluster->NumVertices++;
+            _clusterVertices.push_back(v);
+            pOutput->Vertices.push_back(_vertices[v]);
+        }
+        pOutput->Triangles.push_back(_slots[v]);
+    }
+
+    pCluster->NumTriangles++;
+    _centroidSum += TriangleCentroid_(_positions, &_indices[t * 3]);
+
+    forrange(c, 0, 3) {
+        const u32 v = _localIndices[t * 3 + c];
+        forrange(i, _adjacencyOffsets[v], _adjacencyOffsets[v + 1]) {
+            const u32 neighbor = _adjacency[i];
+            if (not (_used[neighbor] | _candidate[neighbor])) {
+                _candidate[neighbor] = 1;
+                _candidates.push_back(neighbor);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static u32 AppendClusters_(FClusterBuffers_* pDst, const FClusterBuffers_& src, u32 level) {
+    const u32 firstCluster = checked_cast<u32>(pDst->Clusters.size());
+    const u32 vertexOffset = checked_cast<u32>(pDst->Vertices.size());
+    const u32 triangleOffset = checked_cast<u32>(pDst->Triangles.size() / 3);
+
+    pDst->Clusters.reserve_Additional(src.Clusters.size());
+    for (FMeshCluster cluster : src.Clusters) {
+        cluster.FirstVertex += vertexOffset;
+        cluster.FirstTriangle += triangleOffset;
+        cluster.Level = checked_cast<u16>(level);
+        pDst->Clusters.push_back(cluster);
+    }
+
+    pDst->Vertices.insert(pDst->Vertices.end(), src.Vertices.begin(), src.Vertices.end());
+    pDst->Triangles.insert(pDst->Triangles.end(), src.Triangles.begin(), src.Triangles.end());
+
+    return firstCluster;
+}
+//----------------------------------------------------------------------------
+// gathers up to clustersPerGroup clusters sharing the most vertices, seeds are visited in order
+static void GroupClusters_(
+    VECTOR(MeshBuilder, u32)* pGroupOffsets,
+    VECTOR(MeshBuilder, u32)* pGroupClusters,
+    const FClusterBuffers_& dag,
+    const TMemoryView<const u32>& active,
+    u32 clustersPerGroup ) {
+    const size_t numClusters = active.size();
+
+    // clusters sharing a vertex are adjacent, the weight of an edge is the number of shared vertices
+    VECTOR(MeshBuilder, u64) vertexClusters;
+    forrange(i, 0, numClusters) {
+        const FMeshCluster& cluster = dag.Clusters[active[i]];
+        forrange(v, cluster.FirstVertex, cluster.FirstVertex + cluster.NumVertices)
+            vertexClusters.push_back((u64(dag.Vertices[v]) << 32) | i);
+    }
+    std::sort(vertexClusters.begin(), vertexClusters.end());
+
+    VECTOR(MeshBuilder, u64) edges;
+    for (size_t first = 0; first < vertexClusters.size(); ) {
+        size_t last = first + 1;
+        while (last < vertexClusters.size() && (vertexClusters[last] >> 32) == (vertexClusters[first] >> 32))
+            ++last;
+
+        forrange(a, first, last) {
+            forrange(b, a + 1, last) {
+                const u32 ca = static_cast<u32>(vertexClusters[a]);
+                const u32 cb = static_cast<u32>(vertexClusters[b]);
+                edges.push_back((u64(Min(ca, cb)) << 32) | Max(ca, cb));
+            }
+        }
+
+        first = last;
+    }
+    std::sort(edges.begin(), edges.end());
+
+    VECTOR(MeshBuilder, u32) neighborOffsets;
+    neighborOffsets.resize(numClusters + 1, 0);
+    for (size_t e = 0; e < edges.size(); ) {
+        size_t run = e + 1;
+        while (run < edges.size() && edges[run] == edges[e])
+            ++run;
+
+        neighborOffsets[static_cast<u32>(edges[e] >> 32) + 1]++;
+        neighborOffsets[static_cast<u32>(edges[e]) + 1]++;
+        e = run;
+    }
+    forrange(i, 0, numClusters)
+        neighborOffsets[i + 1] += neighborOffsets[i];
+
+    VECTOR(MeshBuilder, FClusterNeighbor_) neighbors;
+    neighbors.resize_Uninitialized(neighborOffsets.back());
+
+    VECTOR(MeshBuilder, u32) cursors;
+    cursors.assign(neighborOffsets.begin(), neighborOffsets.end() - 1);
+    for (size_t e = 0; e < edges.size(); ) {
+        size_t run = e + 1;
+        while (run < edges.size() && edges[run] == edges[e])
+            ++run;
+
+        const u32 ca = static_cast<u32>(edges[e] >> 32);
+        const u32 cb = static_cast<u32>(edges[e]);
+        const u32 shared = checked_cast<u32>(run - e);
+        neighbors[cursors[ca]++] = FClusterNeighbor_{ cb, shared };
+        neighbors[cursors[cb]++] = FClusterNeighbor_{ ca, shared };
+        e = run;
+    }
+
+    // greedy grouping, the score of a candidate sums the vertices it shares with the whole group
+    VECTOR(MeshBuilder, u8) grouped;
+    grouped.resize(numClusters, u8(0));
+    VECTOR(MeshBuilder, u32) scores;
+    scores.resize(numClusters, 0);
+    VECTOR(MeshBuilder, u32) touched;
+
+    pGroupOffsets->clear();
+    pGroupClusters->clear();
+    pGroupOffsets->push_back(0);
+
+    forrange(seed, 0, numClusters) {
+        if (grouped[seed])
+            continue;
+
+        grouped[seed] = 1;
+        pGroupClusters->push_back(active[seed]);
+
+        for (u32 last = checked_cast<u32>(seed), size = 1; size < clustersPerGroup; ++size) {
+            forrange(i, neighborOffsets[last], neighborOffsets[last + 1]) {
+                const FClusterNeighbor_& neighbor = neighbors[i];
+                if (grouped[neighbor.Cluster])
+                    continue;
+                if (0 == scores[neighbor.Cluster])
+                    touched.push_back(neighbor.Cluster);
+                scores[neighbor.Cluster] += neighbor.SharedVertices;
+            }
+
+            u32 best = UMax;
+            u32 bestScore = 0;
+            for (u32 c : touched) {
+                if (not grouped[c] && scores[c] > bestScore) {
+                    best = c;
+                    bestScore = scores[c];
+                }
+            }
+
+            if (UMax == best)
+                break;
+
+            grouped[best] = 1;
+            pGroupClusters->push_back(active[best]);
+            last = best;
+        }
+
+        for (u32 c : touched)
+            scores[c] = 0;
+        touched.clear();
+
+        pGroupOffsets->push_back(checked_cast<u32>(pGroupClusters->size()));
+    }
+}
+//----------------------------------------------------------------------------
+// seams split the vertices sharing a position: they can't move without opening cracks
+static void LockSeams_(const TMemoryView<u8>& locked, const TMemoryView<const float3>& positions) {
+    VECTOR(MeshBuilder, u32) sorted;
+    sorted.resize_Uninitialized(positions.size());
+    forrange(v, 0, positions.size())
+        sorted[v] = checked_cast<u32>(v);
+
+    std::sort(sorted.begin(), sorted.end(), [&positions](u32 a, u32 b) {
+        const float3& pa = positions[a];
+        const float3& pb = positions[b];
+        return (pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z));
+    });
+
+    for (size_t i = 0; i < sorted.size(); ) {
+        size_t run = i + 1;
+        while (run < sorted.size() && positions[sorted[run]] == positions[sorted[i]])
+            ++run;
+        if (run - i > 1) {
+            forrange(j, i, run)
+                locked[sorted[j]] = 1;
+        }
+        i = run;
+    }
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+bool FMeshClusterDAG::Build(const FGenericMesh& mesh, size_t index/* = 0 */, ITaskContext* context/* = nullptr */) {
+    return Build(mesh, index, FSettings{}, context);
+}
+//----------------------------------------------------------------------------
+bool FMeshClusterDAG::Build(const FGenericMesh& mesh, size_t index, const FSettings& settings, ITaskContext* context/* = nullptr */) {
+    Assert(settings.MaxVertices >= 3 && settings.MaxVertices < NoSlot_);
+    Assert(settings.MaxTriangles >= 1 && settings.MaxTriangles <= 0xFF);
+    Assert(settings.ClustersPerGroup >= 2);
+    Assert(settings.MaxLevels >= 1);
+
+    Clear();
+
+    const FPositions3f positions3f = mesh.Position3f_IFP(index);
+    PPE_LOG_CHECK(MeshBuilder, positions3f);
+
+    const TMemoryView<const float3> positions = positions3f.MakeView();
+    const TMemoryView<const u32> indices = mesh.Indices();
+    const size_t numTriangles = mesh.TriangleCount();
+    if (0 == numTriangles)
+        return true;
+
+    // level 0: sort the triangles along a Morton curve, then build the clusters of each chunk in parallel
+    const FAabb3f bounds = ComputeBounds(mesh, index);
+    const float3 boundsMin = bounds.Min();
+    const float3 extents = bounds.Extents();
+    const float3 invExtents{
+        extents.x > 0 ? 1023.0f / extents.x : 0.0f,
+        extents.y > 0 ? 1023.0f / extents.y : 0.0f,
+        extents.z > 0 ? 1023.0f / extents.z : 0.0f };
+
+    VECTOR(MeshBuilder, u64) keys;
+    keys.resize_Uninitialized(numTriangles);
+    ParallelFor(0, (numTriangles + ChunkTriangles_ - 1) / ChunkTriangles_, [&](size_t chunk) {
+        const size_t last = Min(numTriangles, (chunk + 1) * ChunkTriangles_);
+        forrange(t, chunk * ChunkTriangles_, last) {
+            const float3 cell = (TriangleCentroid_(positions, &indices[t * 3]) - boundsMin) * invExtents;
+            const u64 morton = FLinearOctree::MortonCode(
+                static_cast<u32>(Clamp(cell.x, 0.0f, 1023.0f)),
+                static_cast<u32>(Clamp(cell.y, 0.0f, 1023.0f)),
+                static_cast<u32>(Clamp(cell.z, 0.0f, 1023.0f)) );
+            keys[t] = ((morton << 32) | t);
+        }
+    },  ETaskPriority::Normal, context);
+
+    std::sort(keys.begin(), keys.end());
+
+    VECTOR(MeshBuilder, u32) sortedIndices;
+    sortedIndices.resize_Uninitialized(numTriangles * 3);
+    forrange(t, 0, numTriangles) {
+        const u32 src = static_cast<u32>(keys[t]);
+        sortedIndices[t * 3 + 0] = indices[src * 3 + 0];
+        sortedIndices[t * 3 + 1] = indices[src * 3 + 1];
+        sortedIndices[t * 3 + 2] = indices[src * 3 + 2];
+    }
+
+    VECTOR(MeshBuilder, FClusterBuffers_) chunks;
+    chunks.resize((numTriangles + ChunkTriangles_ - 1) / ChunkTriangles_);
+    ParallelFor(0, chunks.size(), [&](size_t chunk) {
+        const size_t first = (chunk * ChunkTriangles_);
+        const size_t count = (Min(numTriangles, first + ChunkTriangles_) - first);
+
+        FMeshletBuilder_ builder{ positions, settings };
+        builder.Build(sortedIndices.MakeConstView().SubRange(first * 3, count * 3), &chunks[chunk]);
+    },  ETaskPriority::Normal, context);
+
+    FClusterBuffers_ dag;
+    for (const FClusterBuffers_& chunk : chunks)
+        AppendClusters_(&dag, chunk, 0);
+
+    chunks.clear_ReleaseMemory();
+    sortedIndices.clear_ReleaseMemory();
+    keys.clear_ReleaseMemory();
+
+    _levels.push_back(0);
+    _levels.push_back(checked_cast<u32>(dag.Clusters.size()));
+
+    // coarser levels: group, simplify with the group borders locked, then split again
+    VECTOR(MeshBuilder, u8) locked; // vertices which must never move again
+    locked.resize(positions.size(), u8(0));
+    LockSeams_(locked.MakeView(), positions);
+
+    VECTOR(MeshBuilder, u32) active;
+    active.resize_Uninitialized(dag.Clusters.size());
+    forrange(c, 0, dag.Clusters.size())
+        active[c] = checked_cast<u32>(c);
+
+    VECTOR(MeshBuilder, u32) groupOffsets;
+    VECTOR(MeshBuilder, u32) groupClusters;
+    VECTOR(MeshBuilder, u8) groupLocked;
+    VECTOR(MeshBuilder, u32) owners;
+    VECTOR(MeshBuilder, FGroupResult_) results;
+
+    for (u32 level = 0; level + 1 < settings.MaxLevels && active.size() > 1; ++level) {
+        GroupClusters_(&groupOffsets, &groupClusters, dag, active.MakeConstView(), settings.ClustersPerGroup);
+        const size_t numGroups = (groupOffsets.size() - 1);
+
+        // vertices shared by several groups are locked for this level
+        groupLocked.assign(locked.begin(), locked.end());
+        owners.clear();
+        owners.resize(positions.size(), u32(UMax));
+
+        forrange(g, 0, numGroups) {
+            forrange(i, groupOffsets[g], groupOffsets[g + 1]) {
+                const FMeshCluster& cluster = dag.Clusters[groupClusters[i]];
+                forrange(v, cluster.FirstVertex, cluster.FirstVertex + cluster.NumVertices) {
+                    u32& owner = owners[dag.Vertices[v]];
+                    if (UMax == owner)
+                        owner = checked_cast<u32>(g);
+                    else if (owner != g)
+                        groupLocked[dag.Vertices[v]] = 1;
+                }
+            }
+        }
+
+        results.clear();
+        results.resize(numGroups);
+
+        ParallelFor(0, numGroups, [&](size_t g) {
+            FGroupResult_& result = results[g];
+
+            VECTOR(MeshBuilder, u32) groupIndices;
+            VECTOR(MeshBuilder, u32) lockedVertices;
+            forrange(i, groupOffsets[g], groupOffsets[g + 1]) {
+                const FMeshCluster& cluster = dag.Clusters[groupClusters[i]];
+                forrange(t, cluster.FirstTriangle * 3, (cluster.FirstTriangle + cluster.NumTriangles) * 3)
+                    groupIndices.push_back(dag.Vertices[cluster.FirstVertex + dag.Triangles[t]]);
+                forrange(v, cluster.FirstVertex, cluster.FirstVertex + cluster.NumVertices) {
+                    if (groupLocked[dag.Vertices[v]])
+                        lockedVertices.push_back(dag.Vertices[v]);
+                }
+            }
+
+            std::sort(lockedVertices.begin(), lockedVertices.end());
+            lockedVertices.erase(std::unique(lockedVertices.begin(), lockedVertices.end()), lockedVertices.end());
+
+            const size_t numIndices = groupIndices.size();
+
+            FMeshSimplifier simplifier{ positions };
+            const size_t numSimplified = simplifier.Simplify(
+                groupIndices.MakeView(), lockedVertices.MakeConstView(),
+                (numIndices / 6) * 3, FLT_MAX, &result.Error );
+
+            result.Simplified = (float(numSimplified) <= float(numIndices) * MinGroupReduction_);
+            if (not result.Simplified)
+                return;
+
+            FMeshletBuilder_ builder{ positions, settings };
+            builder.Build(groupIndices.MakeConstView().CutBefore(numSimplified), &result.Buffers);
+        },  ETaskPriority::Normal, context);
+
+        // merged sequentially to stay deterministic
+        active.clear();
+
+        forrange(g, 0, numGroups) {
+            const FGroupResult_& result = results[g];
+            const TMemoryView<const u32> children = groupClusters.MakeConstView().SubRange(
+                groupOffsets[g], groupOffsets[g + 1] - groupOffsets[g] );
+
+            if (not result.Simplified) {
+                // those clusters stay roots, their neighbors must keep matching their borders
+                for (u32 c : children) {
+                    const FMeshCluster& cluster = dag.Clusters[c];
+                    forrange(v, cluster.FirstVertex, cluster.FirstVertex + cluster.NumVertices)
+                        locked[dag.Vertices[v]] = 1;
+                }
+                continue;
+            }
+
+            // parents must enclose their children and have a larger error to keep the cut monotonic
+            float3 center = dag.Clusters[children[0]].LodCenter;
+            float radius = dag.Clusters[children[0]].LodRadius;
+            float error = result.Error;
+            for (u32 c : children) {
+                const FMeshCluster& child = dag.Clusters[c];
+                MergeSpheres_(&center, &radius, child.LodCenter, child.LodRadius);
+                error = Max(error, child.LodError);
+            }
+
+            const u32 group = _numGroups++;
+            for (u32 c : children) {
+                FMeshCluster& child = dag.Clusters[c];
+                child.Group = group;
+                child.ParentCenter = center;
+                child.ParentRadius = radius;
+                child.ParentError = error;
+            }
+
+            const u32 firstParent = AppendClusters_(&dag, result.Buffers, level + 1);
+            forrange(p, firstParent, checked_cast<u32>(dag.Clusters.size())) {
+                FMeshCluster& parent = dag.Clusters[p];
+                parent.LodCenter = center;
+                parent.LodRadius = radius;
+                parent.LodError = error;
+                active.push_back(p);
+            }
+        }
+
+        if (active.empty())
+            break;
+
+        _levels.push_back(checked_cast<u32>(dag.Clusters.size()));
+    }
+
+    _clusters = std::move(dag.Clusters);
+    _vertices = std::move(dag.Vertices);
+    _triangles = std::move(dag.Triangles);
+
+    return true;
+}
+//----------------------------------------------------------------------------
+void FMeshClusterDAG::Clear() {
+    _clusters.clear();
+    _vertices.clear();
+    _triangles.clear();
+    _levels.clear();
+    _numGroups = 0;
+}
+//----------------------------------------------------------------------------
+bool FMeshClusterDAG::IsVisibleLod(const FMeshCluster& cluster, const float3& eye, float threshold) NOEXCEPT {
+    // compares errors projected on the nearest point of each sphere, without dividing by the distance
+    const float lodDistance = Max(0.0f, Distance(eye, cluster.LodCenter) - cluster.LodRadius);
+    const float parentDistance = Max(0.0f, Distance(eye, cluster.ParentCenter) - cluster.ParentRadius);
+    return (cluster.LodError <= threshold * lodDistance &&
+            cluster.ParentError > threshold * parentDistance );
+}
+//----------------------------------------------------------------------------
+bool FMeshClusterDAG::IsBackfacing(const FMeshCluster& cluster, const float3& eye) NOEXCEPT {
+    const float3 view = (cluster.Center - eye);
+    return (Dot(view, cluster.ConeAxis) >= cluster.ConeCutoff * Length(view) + cluster.Radius);
+}
+//----------------------------------------------------------------------------
+size_t FMeshClusterDAG::SelectClusters(const float3& eye, float threshold, VECTOR(MeshBuilder, u32)* pClusters) const {
+    Assert(pClusters);
+
+    const size_t numSelected = pClusters->size();
+    forrange(c, 0, _clusters.size()) {
+        if (IsVisibleLod(_clusters[c], eye, threshold))
+            pClusters->push_back(checked_cast<u32>(c));
+    }
+
+    return (pClusters->size() - numSelected);
+}
+//----------------------------------------------------------------------------
+void FMeshClusterDAG::Save(IStreamWriter& writer) const {
+    writer.WritePOD(DAGMagic_);
+    writer.WritePOD(DAGVersion_);
+    writer.WritePOD(_numGroups);
+    writer.WritePOD(checked_cast<u32>(_levels.size()));
+    writer.WritePOD(checked_cast<u32>(_clusters.size()));
+    writer.WritePOD(checked_cast<u32>(_vertices.size()));
+    writer.WritePOD(checked_cast<u32>(_triangles.size()));
+
+    writer.WriteView(_levels.MakeConstView());
+    writer.WriteView(_clusters.MakeConstView());
+    writer.WriteView(_vertices.MakeConstView());
+    writer.WriteView(_triangles.MakeConstView());
+}
+//----------------------------------------------------------------------------
+bool FMeshClusterDAG::Load(IStreamReader& reader) {
+    Clear();
+
+    if (Load_(reader))
+        return true;
+
+    Clear();
+    return false;
+}
+//----------------------------------------------------------------------------
+bool FMeshClusterDAG::Load_(IStreamReader& reader) {
+    u32 header[7];
+    PPE_LOG_CHECK(MeshBuilder, reader.ReadArray(header));
+    PPE_LOG_CHECK(MeshBuilder, DAGMagic_ == header[0]);
+    PPE_LOG_CHECK(MeshBuilder, DAGVersion_ == header[1]);
+
+    const u32 numGroups = header[2];
+    const u32 numLevels = header[3];
+    const u32 numClusters = header[4];
+    const u32 numVertices = header[5];
+    const u32 numTriangleIndices = header[6];
+
+    // don't allocate more than what the stream can hold
+    const u64 payloadInBytes = (
+        u64(numLevels) * sizeof(u32) +
+        u64(numClusters) * sizeof(FMeshCluster) +
+        u64(numVertices) * sizeof(u32) +
+        u64(numTriangleIndices) * sizeof(u8) );
+    if (reader.IsSeekableI())
+        PPE_LOG_CHECK(MeshBuilder, payloadInBytes <= u64(reader.SizeInBytes() - reader.TellI()));
+
+    // levels are the first cluster of each level, with a sentinel
+    PPE_LOG_CHECK(MeshBuilder, (0 == numClusters) == (0 == numLevels));
+    PPE_LOG_CHECK(MeshBuilder, 0 == numLevels || numLevels >= 2);
+    PPE_LOG_CHECK(MeshBuilder, 0 == numTriangleIndices % 3);
+
+    _numGroups = numGroups;
+    _levels.resize_Uninitialized(numLevels);
+    _clusters.resize_Uninitialized(numClusters);
+    _vertices.resize_Uninitialized(numVertices);
+    _triangles.resize_Uninitialized(numTriangleIndices);
+
+    PPE_LOG_CHECK(MeshBuilder, reader.ReadView(_levels.MakeView()));
+    PPE_LOG_CHECK(MeshBuilder, reader.ReadView(_clusters.MakeView()));
+    PPE_LOG_CHECK(MeshBuilder, reader.ReadView(_vertices.MakeView()));
+    PPE_LOG_CHECK(MeshBuilder, reader.ReadView(_triangles.MakeView()));
+
+    if (0 == numLevels)
+        return true;
+
+    PPE_LOG_CHECK(MeshBuilder, 0 == _levels.front());
+    PPE_LOG_CHECK(MeshBuilder, numClusters == _levels.back());
+
+    forrange(level, 0, numLevels - 1) {
+        PPE_LOG_CHECK(MeshBuilder, _levels[level] <= _levels[level + 1]);
+
+        forrange(c, _levels[level], _levels[level + 1]) {
+            const FMeshCluster& cluster = _clusters[c];
+            PPE_LOG_CHECK(MeshBuilder, level == cluster.Level);
+            PPE_LOG_CHECK(MeshBuilder, cluster.IsRoot() || cluster.Group < numGroups);
+            PPE_LOG_CHECK(MeshBuilder, u64(cluster.FirstVertex) + cluster.NumVertices <= numVertices);
+            PPE_LOG_CHECK(MeshBuilder, (u64(cluster.FirstTriangle) + cluster.NumTriangles) * 3 <= numTriangleIndices);
+
+            // local indices must stay in the vertices of their cluster
+            for (const u8 local : ClusterTriangles(cluster))
+                PPE_LOG_CHECK(MeshBuilder, local < cluster.NumVertices);
+        }
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
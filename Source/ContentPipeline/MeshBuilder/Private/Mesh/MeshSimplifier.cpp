@@ -0,0 +1,692 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Mesh/MeshSimplifier.h"
+
+#include "Mesh/GenericMesh.h"
+
+#include "Container/MinMaxHeap.h"
+#include "Diagnostic/Logger.h"
+#include "Maths/MathHelpers.h"
+#include "Maths/ScalarBoundingBox.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Thread/Task/TaskHelpers.h"
+
+#include <algorithm>
+
+// https://www.cs.cmu.edu/~garland/Papers/quadrics.pdf
+// https://hhoppe.com/newqem.pdf (attributes)
+// https://github.com/zeux/meshoptimizer/blob/master/src/simplifier.cpp (vertex kinds, collapse passes)
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+enum EVertexKind_ : u8 {
+    Vertex_Manifold = 0,
+    Vertex_Border, // only collapses along a border edge, onto another border vertex
+    Vertex_Locked,
+};
+//----------------------------------------------------------------------------
+CONSTEXPR float BorderWeight_ = 10.0f; // keeps the borders from moving away from their edges
+CONSTEXPR float FlipThreshold_ = 0.25f; // min cosine between a triangle normal before and after a collapse
+//----------------------------------------------------------------------------
+static bool HasVertex_(const u32* triangle, u32 v) {
+    return (triangle[0] == v || triangle[1] == v || triangle[2] == v);
+}
+//----------------------------------------------------------------------------
+struct FMeshAttributes_ {
+    VECTOR(MeshBuilder, float) Values; // NumChannels per vertex
+    size_t NumChannels{ 0 };
+    bool HasNormals{ false };
+    bool HasTexcoords{ false };
+    bool HasTangents{ false };
+
+    void Weights(VECTOR(MeshBuilder, float)* pWeights, const FMeshSimplifySettings& settings) const {
+        pWeights->clear();
+        if (HasNormals)
+            pWeights->append({ settings.NormalWeight, settings.NormalWeight, settings.NormalWeight });
+        if (HasTexcoords)
+            pWeights->append({ settings.TexcoordWeight, settings.TexcoordWeight });
+        if (HasTangents)
+            pWeights->append({ settings.TangentWeight, settings.TangentWeight, settings.TangentWeight });
+        Assert(pWeights->size() == NumChannels);
+    }
+};
+//----------------------------------------------------------------------------
+// interleaves the channels used by at least one of the settings
+static void GatherAttributes_(
+    FMeshAttributes_* pAttributes,
+    const FGenericMesh& mesh, size_t index,
+    const TMemoryView<const FMeshSimplifySettings>& settings,
+    ITaskContext* context ) {
+    float normalWeight = 0, texcoordWeight = 0, tangentWeight = 0;
+    for (const FMeshSimplifySettings& it : settings) {
+        normalWeight = Max(normalWeight, it.NormalWeight);
+        texcoordWeight = Max(texcoordWeight, it.TexcoordWeight);
+        tangentWeight = Max(tangentWeight, it.TangentWeight);
+    }
+
+    const FNormals3f normals = mesh.Normal3f_IFP(index);
+    const FTexcoords2f texcoords = mesh.Texcoord2f_IFP(index);
+    const FTangents3f tangents3f = mesh.Tangent3f_IFP(index);
+    const FTangents4f tangents4f = mesh.Tangent4f_IFP(index);
+
+    pAttributes->HasNormals = (normals && normalWeight > 0);
+    pAttributes->HasTexcoords = (texcoords && texcoordWeight > 0);
+    pAttributes->HasTangents = ((tangents3f || tangents4f) && tangentWeight > 0);
+    pAttributes->NumChannels = (
+        (pAttributes->HasNormals ? 3 : 0) +
+        (pAttributes->HasTexcoords ? 2 : 0) +
+        (pAttributes->HasTangents ? 3 : 0) );
+
+    const size_t numVertices = mesh.VertexCount();
+    const size_t numChannels = pAttributes->NumChannels;
+    pAttributes->Values.resize_Uninitialized(numVertices * numChannels);
+    if (0 == numChannels)
+        return;
+
+    const TMemoryView<float> values = pAttributes->Values.MakeView();
+    const TMemoryView<const float3> normalValues = normals.MakeView();
+    const TMemoryView<const float2> texcoordValues = texcoords.MakeView();
+    const TMemoryView<const float3> tangent3fValues = tangents3f.MakeView();
+    const TMemoryView<const float4> tangent4fValues = tangents4f.MakeView();
+    const FMeshAttributes_& attributes = *pAttributes;
+
+    CONSTEXPR size_t verticesPerTask = 64 * 1024;
+    ParallelFor(0, (numVertices + verticesPerTask - 1) / verticesPerTask, [&](size_t chunk) {
+        const size_t last = Min(numVertices, (chunk + 1) * verticesPerTask);
+        forrange(v, chunk * verticesPerTask, last) {
+            float* dst = &values[v * numChannels];
+            if (attributes.HasNormals) {
+                *dst++ = normalValues[v].x;
+                *dst++ = normalValues[v].y;
+                *dst++ = normalValues[v].z;
+            }
+            if (attributes.HasTexcoords) {
+                *dst++ = texcoordValues[v].x;
+                *dst++ = texcoordValues[v].y;
+            }
+            if (attributes.HasTangents) {
+                const float3 tangent = (tangent3fValues.empty() ? float3(tangent4fValues[v].xyz) : tangent3fValues[v]);
+                *dst++ = tangent.x;
+                *dst++ = tangent.y;
+                *dst++ = tangent.z;
+            }
+        }
+    },  ETaskPriority::Normal, context);
+}
+//----------------------------------------------------------------------------
+static size_t TargetIndexCount_(const FGenericMesh& mesh, const FMeshSimplifySettings& settings) {
+    const size_t numTriangles = (settings.TargetTriangles
+        ? settings.TargetTriangles
+        : static_cast<size_t>(mesh.TriangleCount() * Saturate(settings.TargetRatio)) );
+    return (numTriangles * 3);
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// W is left to the caller: attribute planes don't weight the average error
+void FMeshSimplifier::FQuadric_::AddPlane(const float3& normal, float distance, float weight) NOEXCEPT {
+    const float3 wn = normal * weight;
+    A00 += wn.x * normal.x;
+    A11 += wn.y * normal.y;
+    A22 += wn.z * normal.z;
+    A10 += wn.y * normal.x;
+    A20 += wn.z * normal.x;
+    A21 += wn.z * normal.y;
+    B0 += wn.x * distance;
+    B1 += wn.y * distance;
+    B2 += wn.z * distance;
+    C += weight * distance * distance;
+}
+//----------------------------------------------------------------------------
+void FMeshSimplifier::FQuadric_::Add(const FQuadric_& other) NOEXCEPT {
+    A00 += other.A00;
+    A11 += other.A11;
+    A22 += other.A22;
+    A10 += other.A10;
+    A20 += other.A20;
+    A21 += other.A21;
+    B0 += other.B0;
+    B1 += other.B1;
+    B2 += other.B2;
+    C += other.C;
+    W += other.W;
+}
+//----------------------------------------------------------------------------
+float FMeshSimplifier::FQuadric_::Evaluate(const float3& p) const NOEXCEPT {
+    const float rx = A00 * p.x + A10 * p.y + A20 * p.z;
+    const float ry = A10 * p.x + A11 * p.y + A21 * p.z;
+    const float rz = A20 * p.x + A21 * p.y + A22 * p.z;
+    return (p.x * rx + p.y * ry + p.z * rz + 2.0f * (B0 * p.x + B1 * p.y + B2 * p.z) + C);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+size_t FMeshSimplifier::Simplify(
+    const TMemoryView<u32>& indices,
+    const TMemoryView<const u32>& lockedVertices,
+    size_t targetIndexCount,
+    float maxError/* = FLT_MAX */,
+    float* pResultError/* = nullptr */ ) {
+    Assert_NoAssume(indices.size() % 3 == 0);
+    Assert_NoAssume(std::is_sorted(lockedVertices.begin(), lockedVertices.end()));
+
+    if (pResultError)
+        *pResultError = 0;
+    if (indices.size() <= targetIndexCount)
+        return indices.size();
+
+    Setup_(indices, lockedVertices);
+    ComputeQuadrics_();
+
+    // costs are squared distances in the unit cube
+    const float maxCost = (maxError < FLT_MAX ? Sqr(maxError / _scale) : FLT_MAX);
+    const size_t targetTriangles = (targetIndexCount / 3);
+
+    size_t numTriangles = checked_cast<size_t>(std::count(_alive.begin(), _alive.end(), u8(1)));
+    float resultCost = 0;
+    while (numTriangles > targetTriangles) {
+        BuildAdjacency_();
+        CollectEdges_();
+
+        const size_t removed = CollapsePass_(numTriangles - targetTriangles, maxCost, &resultCost);
+        if (0 == removed)
+            break;
+
+        Assert(removed <= numTriangles);
+        numTriangles -= removed;
+    }
+
+    size_t numIndices = 0;
+    forrange(t, 0, _alive.size()) {
+        if (not _alive[t])
+            continue;
+
+        const u32* const triangle = &_triangles[t * 3];
+        indices[numIndices++] = _vertices[triangle[0]];
+        indices[numIndices++] = _vertices[triangle[1]];
+        indices[numIndices++] = _vertices[triangle[2]];
+    }
+    Assert(numIndices == numTriangles * 3);
+
+    if (pResultError)
+        *pResultError = (Sqrt(resultCost) * _scale);
+
+    return numIndices;
+}
+//----------------------------------------------------------------------------
+void FMeshSimplifier::Setup_(const TMemoryView<const u32>& indices, const TMemoryView<const u32>& lockedVertices) {
+    // remap the vertices to a dense local range
+    _vertices.assign(indices.begin(), indices.end());
+    std::sort(_vertices.begin(), _vertices.end());
+    _vertices.erase(std::unique(_vertices.begin(), _vertices.end()), _vertices.end());
+
+    const size_t numVertices = _vertices.size();
+    const size_t numTriangles = (indices.size() / 3);
+
+    _triangles.resize_Uninitialized(indices.size());
+    forrange(i, 0, indices.size())
+        _triangles[i] = checked_cast<u32>(std::lower_bound(_vertices.begin(), _vertices.end(), indices[i]) - _vertices.begin());
+
+    _alive.resize_Uninitialized(numTriangles);
+    forrange(t, 0, numTriangles) {
+        const u32* const triangle = &_triangles[t * 3];
+        _alive[t] = u8((triangle[0] != triangle[1]) & (triangle[1] != triangle[2]) & (triangle[2] != triangle[0]));
+    }
+
+    // rescale the positions to keep the quadrics precise with floats
+    FAabb3f bounds = FAabb3f::EmptyValue();
+    for (u32 v : _vertices)
+        bounds.Add(_positions[v]);
+
+    _scale = bounds.Extents().MaxComponent();
+    if (not (_scale > 0))
+        _scale = 1.0f;
+
+    const float invScale = (1.0f / _scale);
+    _localPositions.resize_Uninitialized(numVertices);
+    forrange(v, 0, numVertices)
+        _localPositions[v] = (_positions[_vertices[v]] - bounds.Min()) * invScale;
+
+    // vertex kinds
+    _kinds.clear();
+    _kinds.resize(numVertices, u8(Vertex_Manifold));
+
+    auto pLocked = lockedVertices.begin();
+    forrange(v, 0, numVertices) {
+        while (pLocked != lockedVertices.end() && *pLocked < _vertices[v])
+            ++pLocked;
+        if (pLocked != lockedVertices.end() && *pLocked == _vertices[v])
+            _kinds[v] = Vertex_Locked;
+    }
+
+    // seams split the vertices sharing a position, they must stay in place to keep the surface closed
+    _adjacency.resize_Uninitialized(numVertices);
+    forrange(v, 0, numVertices)
+        _adjacency[v] = checked_cast<u32>(v);
+
+    const auto positionLess = [this](u32 a, u32 b) {
+        const float3& pa = _localPositions[a];
+        const float3& pb = _localPositions[b];
+        return (pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z));
+    };
+    std::sort(_adjacency.begin(), _adjacency.end(), positionLess);
+
+    for (size_t i = 0; i < numVertices; ) {
+        size_t run = i + 1;
+        while (run < numVertices && _localPositions[_adjacency[run]] == _localPositions[_adjacency[i]])
+            ++run;
+        if (run - i > 1) {
+            forrange(j, i, run)
+                _kinds[_adjacency[j]] = Vertex_Locked;
+        }
+        i = run;
+    }
+
+    // borders have edges with a single triangle, and non-manifold edges are locked
+    CollectEdges_();
+
+    for (size_t e = 0; e < _edges.size(); ) {
+        size_t run = e + 1;
+        while (run < _edges.size() && _edges[run] == _edges[e])
+            ++run;
+
+        const u32 a = static_cast<u32>(_edges[e] >> 32);
+        const u32 b = static_cast<u32>(_edges[e]);
+
+        if (run - e == 1) {
+            if (Vertex_Manifold == _kinds[a]) _kinds[a] = Vertex_Border;
+            if (Vertex_Manifold == _kinds[b]) _kinds[b] = Vertex_Border;
+        }
+        else if (run - e > 2) {
+            _kinds[a] = Vertex_Locked;
+            _kinds[b] = Vertex_Locked;
+        }
+
+        e = run;
+    }
+
+    if (_lockBorders) {
+        for (u8& kind : _kinds) {
+            if (Vertex_Border == kind)
+                kind = Vertex_Locked;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void FMeshSimplifier::ComputeQuadrics_() {
+    const size_t numChannels = _attributeWeights.size();
+
+    _quadrics.clear();
+    _quadrics.resize(_vertices.size(), FQuadric_{});
+    _attributeQuadrics.clear();
+    _attributeQuadrics.resize(_vertices.size() * numChannels, FAttributeQuadric_{ float3::Zero, 0.0f, 0.0f });
+
+    // _edges still holds the edges of the input triangles
+    const auto isBorderEdge = [this](u32 a, u32 b) {
+        const u64 key = ((u64(Min(a, b)) << 32) | Max(a, b));
+        const auto it = std::lower_bound(_edges.begin(), _edges.end(), key);
+        Assert(it != _edges.end() && *it == key);
+        return (it + 1 == _edges.end() || *(it + 1) != key);
+    };
+
+    forrange(t, 0, _alive.size()) {
+        if (not _alive[t])
+            continue;
+
+        const u32* const triangle = &_triangles[t * 3];
+        const float3& p0 = _localPositions[triangle[0]];
+        const float3& p1 = _localPositions[triangle[1]];
+        const float3& p2 = _localPositions[triangle[2]];
+
+        float3 normal = Cross(p1 - p0, p2 - p0);
+        const float area2 = Length(normal);
+        if (not (area2 > 0))
+            continue;
+
+        normal /= area2;
+        const float distance = -Dot(normal, p0);
+        const float area = (area2 * 0.5f);
+
+        forrange(c, 0, 3) {
+            _quadrics[triangle[c]].AddPlane(normal, distance, area);
+            _quadrics[triangle[c]].W += area;
+        }
+
+        // attributes are interpolated linearly over the triangle: a(p) = dot(gradient, p) + offset
+        const float3 e1 = (p1 - p0);
+        const float3 e2 = (p2 - p0);
+        const float d11 = Dot(e1, e1);
+        const float d12 = Dot(e1, e2);
+        const float d22 = Dot(e2, e2);
+        const float det = (d11 * d22 - d12 * d12);
+
+        if (numChannels && det > 0) {
+            const float invDet = (1.0f / det);
+            const float* const a0 = &_attributes[_vertices[triangle[0]] * numChannels];
+            const float* const a1 = &_attributes[_vertices[triangle[1]] * numChannels];
+            const float* const a2 = &_attributes[_vertices[triangle[2]] * numChannels];
+
+            forrange(k, 0, numChannels) {
+                const float weight = (area * _attributeWeights[k]);
+                if (not (weight > 0))
+                    continue;
+
+                const float da1 = (a1[k] - a0[k]);
+                const float da2 = (a2[k] - a0[k]);
+                const float3 gradient = (e1 * ((d22 * da1 - d12 * da2) * invDet) + e2 * ((d11 * da2 - d12 * da1) * invDet));
+                const float offset = (a0[k] - Dot(gradient, p0));
+
+                // (dot(gradient, p) + offset - a)^2 = quadric in p + cross terms in a + a^2
+                forrange(c, 0, 3) {
+                    _quadrics[triangle[c]].AddPlane(gradient, offset, weight);
+
+                    FAttributeQuadric_& attribute = _attributeQuadrics[triangle[c] * numChannels + k];
+                    attribute.Gradient += gradient * weight;
+                    attribute.Offset += offset * weight;
+                    attribute.Weight += weight;
+                }
+            }
+        }
+
+        // penalize the moves orthogonal to the borders
+        forrange(c, 0, 3) {
+            const u32 a = triangle[c];
+            const u32 b = triangle[(c + 1) % 3];
+            if (not isBorderEdge(a, b))
+                continue;
+
+            const float3 edge = (_localPositions[b] - _localPositions[a]);
+            const float3 borderNormal = SafeNormalize(Cross(edge, normal));
+            const float borderDistance = -Dot(borderNormal, _localPositions[a]);
+            const float weight = (LengthSq(edge) * BorderWeight_);
+
+            _quadrics[a].AddPlane(borderNormal, borderDistance, weight);
+            _quadrics[a].W += weight;
+            _quadrics[b].AddPlane(borderNormal, borderDistance, weight);
+            _quadrics[b].W += weight;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void FMeshSimplifier::BuildAdjacency_() {
+    const size_t numVertices = _vertices.size();
+
+    _adjacencyOffsets.clear();
+    _adjacencyOffsets.resize(numVertices + 1, 0);
+
+    forrange(t, 0, _alive.size()) {
+        if (_alive[t]) {
+            forrange(c, 0, 3)
+                _adjacencyOffsets[_triangles[t * 3 + c]]++;
+        }
+    }
+
+    u32 offset = 0;
+    forrange(v, 0, numVertices + 1) {
+        const u32 count = _adjacencyOffsets[v];
+        _adjacencyOffsets[v] = offset;
+        offset += count;
+    }
+
+    _adjacency.resize_Uninitialized(offset);
+    forrange(t, 0, _alive.size()) {
+        if (_alive[t]) {
+            forrange(c, 0, 3)
+                _adjacency[_adjacencyOffsets[_triangles[t * 3 + c]]++] = checked_cast<u32>(t);
+        }
+    }
+
+    // offsets were shifted by one vertex while filling
+    for (size_t v = numVertices; v > 0; --v)
+        _adjacencyOffsets[v] = _adjacencyOffsets[v - 1];
+    _adjacencyOffsets[0] = 0;
+}
+//----------------------------------------------------------------------------
+void FMeshSimplifier::CollectEdges_() {
+    _edges.clear();
+    _edges.reserve(_triangles.size());
+
+    forrange(t, 0, _alive.size()) {
+        if (not _alive[t])
+            continue;
+
+        const u32* const triangle = &_triangles[t * 3];
+        forrange(c, 0, 3) {
+            const u32 a = triangle[c];
+            const u32 b = triangle[(c + 1) % 3];
+            _edges.push_back((u64(Min(a, b)) << 32) | Max(a, b));
+        }
+    }
+
+    std::sort(_edges.begin(), _edges.end());
+}
+//----------------------------------------------------------------------------
+bool FMeshSimplifier::CanCollapse_(u32 from, u32 to, bool borderEdge) const NOEXCEPT {
+    switch (_kinds[from]) {
+    case Vertex_Manifold:
+        return true;
+    case Vertex_Border:
+        return (borderEdge && Vertex_Manifold != _kinds[to]);
+    default:
+        return false;
+    }
+}
+//----------------------------------------------------------------------------
+bool FMeshSimplifier::FlipsTriangles_(u32 from, u32 to) const NOEXCEPT {
+    const float3& target = _localPositions[to];
+
+    forrange(i, _adjacencyOffsets[from], _adjacencyOffsets[from + 1]) {
+        const u32* const triangle = &_triangles[_adjacency[i] * 3];
+        if (HasVertex_(triangle, to))
+            continue; // collapsed
+
+        float3 p[3];
+        forrange(c, 0, 3)
+            p[c] = _localPositions[triangle[c]];
+
+        const float3 before = Cross(p[1] - p[0], p[2] - p[0]);
+        if (not (LengthSq(before) > 0))
+            continue;
+
+        forrange(c, 0, 3) {
+            if (triangle[c] == from)
+                p[c] = target;
+        }
+
+        const float3 after = Cross(p[1] - p[0], p[2] - p[0]);
+        if (Dot(before, after) <= FlipThreshold_ * Sqrt(LengthSq(before) * LengthSq(after)))
+            return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+float FMeshSimplifier::CollapseCost_(u32 from, u32 to) const NOEXCEPT {
+    FQuadric_ merged = _quadrics[from];
+    merged.Add(_quadrics[to]);
+
+    const float3& p = _localPositions[to];
+    float error = merged.Evaluate(p);
+
+    // the surviving vertex keeps its attributes
+    const size_t numChannels = _attributeWeights.size();
+    if (numChannels) {
+        const float* const values = &_attributes[_vertices[to] * numChannels];
+        const FAttributeQuadric_* const qFrom = &_attributeQuadrics[from * numChannels];
+        const FAttributeQuadric_* const qTo = &_attributeQuadrics[to * numChannels];
+
+        forrange(k, 0, numChannels) {
+            const float a = values[k];
+            const float interpolated = (Dot(qFrom[k].Gradient + qTo[k].Gradient, p) + qFrom[k].Offset + qTo[k].Offset);
+            error += a * ((qFrom[k].Weight + qTo[k].Weight) * a - 2.0f * interpolated);
+        }
+    }
+
+    return (merged.W > 0 ? Abs(error) / merged.W : 0.0f);
+}
+//----------------------------------------------------------------------------
+void FMeshSimplifier::MergeQuadrics_(u32 from, u32 to) NOEXCEPT {
+    _quadrics[to].Add(_quadrics[from]);
+
+    const size_t numChannels = _attributeWeights.size();
+    forrange(k, 0, numChannels) {
+        FAttributeQuadric_& dst = _attributeQuadrics[to * numChannels + k];
+        const FAttributeQuadric_& src = _attributeQuadrics[from * numChannels + k];
+        dst.Gradient += src.Gradient;
+        dst.Offset += src.Offset;
+        dst.Weight += src.Weight;
+    }
+}
+//----------------------------------------------------------------------------
+size_t FMeshSimplifier::CollapsePass_(size_t maxRemoved, float maxCost, float* pMaxCost) {
+    Assert(pMaxCost);
+
+    // keep the cheapest collapses, one collapse removes up to 2 triangles
+    const size_t budget = Clamp(maxRemoved / 2 + 1, size_t(2), size_t(MaxCollapsesPerPass));
+
+    _heap.clear();
+    _heap.reserve(budget);
+
+    for (size_t e = 0; e < _edges.size(); ) {
+        size_t run = e + 1;
+        while (run < _edges.size() && _edges[run] == _edges[e])
+            ++run;
+
+        const bool borderEdge = (run - e == 1);
+        const u32 a = static_cast<u32>(_edges[e] >> 32);
+        const u32 b = static_cast<u32>(_edges[e]);
+        e = run;
+
+        FCollapse_ collapse{ FLT_MAX, UMax, UMax };
+        if (CanCollapse_(a, b, borderEdge))
+            collapse = FCollapse_{ CollapseCost_(a, b), a, b };
+        if (CanCollapse_(b, a, borderEdge)) {
+            const float cost = CollapseCost_(b, a);
+            if (cost < collapse.Cost)
+                collapse = FCollapse_{ cost, b, a };
+        }
+
+        if (UMax == collapse.From || collapse.Cost > maxCost)
+            continue;
+
+        if (_heap.size() < budget) {
+            _heap.push_back(collapse);
+            Push_MinMaxHeap(_heap.begin(), _heap.end());
+        }
+        else {
+            SwapMax_MinMaxHeap(_heap.begin(), _heap.end(), &collapse);
+        }
+    }
+
+    _dirty.clear();
+    _dirty.resize(_vertices.size(), u8(0));
+
+    size_t removed = 0;
+    while (not _heap.empty() && removed < maxRemoved) {
+        PopMin_MinMaxHeap(_heap.begin(), _heap.end());
+        const FCollapse_ collapse = _heap.back();
+        _heap.pop_back();
+
+        // the 1-rings of clean vertices are still described by the adjacency
+        if (_dirty[collapse.From] | _dirty[collapse.To])
+            continue;
+        if (FlipsTriangles_(collapse.From, collapse.To))
+            continue;
+
+        MergeQuadrics_(collapse.From, collapse.To);
+
+        for (u32 v : { collapse.From, collapse.To }) {
+            forrange(i, _adjacencyOffsets[v], _adjacencyOffsets[v + 1]) {
+                const u32* const triangle = &_triangles[_adjacency[i] * 3];
+                _dirty[triangle[0]] = _dirty[triangle[1]] = _dirty[triangle[2]] = 1;
+            }
+        }
+
+        forrange(i, _adjacencyOffsets[collapse.From], _adjacencyOffsets[collapse.From + 1]) {
+            const u32 t = _adjacency[i];
+            u32* const triangle = &_triangles[t * 3];
+
+            if (HasVertex_(triangle, collapse.To)) {
+                Assert(_alive[t]);
+                _alive[t] = 0;
+                ++removed;
+            }
+            else {
+                forrange(c, 0, 3) {
+                    if (triangle[c] == collapse.From)
+                        triangle[c] = collapse.To;
+                }
+            }
+        }
+
+        *pMaxCost = Max(*pMaxCost, collapse.Cost);
+    }
+
+    return removed;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+bool SimplifyMesh(FGenericMesh& mesh, size_t index, const FMeshSimplifySettings& settings, float* pResultError/* = nullptr */) {
+    const FPositions3f positions = mesh.Position3f_IFP(index);
+    PPE_LOG_CHECK(MeshBuilder, positions);
+
+    FMeshAttributes_ attributes;
+    GatherAttributes_(&attributes, mesh, index, MakeView(&settings, &settings + 1), nullptr);
+
+    VECTOR(MeshBuilder, float) weights;
+    attributes.Weights(&weights, settings);
+
+    FMeshSimplifier simplifier{ positions.MakeView(), attributes.Values.MakeConstView(), weights.MakeConstView() };
+    simplifier.SetLockBorders(settings.LockBorders);
+
+    const size_t numIndices = simplifier.Simplify(mesh.Indices(), Default, TargetIndexCount_(mesh, settings), settings.MaxError, pResultError);
+    if (numIndices < mesh.IndexCount())
+        mesh.Resize(numIndices, mesh.VertexCount(), true);
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool GenerateLODChain(
+    const TMemoryView<FMeshLOD>& lods,
+    const FGenericMesh& mesh, size_t index,
+    const TMemoryView<const FMeshSimplifySettings>& settings,
+    ITaskContext* context/* = nullptr */) {
+    PPE_LOG_CHECK(MeshBuilder, lods.size() == settings.size());
+
+    const FPositions3f positions = mesh.Position3f_IFP(index);
+    PPE_LOG_CHECK(MeshBuilder, positions);
+
+    FMeshAttributes_ attributes;
+    GatherAttributes_(&attributes, mesh, index, settings, context);
+
+    // every LOD starts from the source mesh: no error accumulates along the chain
+    ParallelFor(0, lods.size(), [&](size_t lod) {
+        VECTOR(MeshBuilder, float) weights;
+        attributes.Weights(&weights, settings[lod]);
+
+        FMeshSimplifier simplifier{ positions.MakeView(), attributes.Values.MakeConstView(), weights.MakeConstView() };
+        simplifier.SetLockBorders(settings[lod].LockBorders);
+
+        FMeshLOD& dst = lods[lod];
+        dst.Indices.assign(mesh.Indices());
+
+        const size_t numIndices = simplifier.Simplify(dst.Indices.MakeView(), Default,
+            TargetIndexCount_(mesh, settings[lod]), settings[lod].MaxError, &dst.Error );
+        dst.Indices.resize(numIndices);
+    },  ETaskPriority::Normal, context);
+
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -17,15 +17,24 @@ NODISCARD PPE_MESHBUILDER_API FAabb3f ComputeBounds(const FGenericMesh& mesh, si
 NODISCARD PPE_MESHBUILDER_API FAabb3f ComputeSubPartBounds(const TGenericVertexSubPart<float3>& subPart);
 NODISCARD PPE_MESHBUILDER_API FAabb4f ComputeSubPartBounds(const TGenericVertexSubPart<float4>& subPart);
 //----------------------------------------------------------------------------
+// area weighted average of the adjacent triangle normals, computed with Newell's method in double precision
 NODISCARD PPE_MESHBUILDER_API bool ComputeNormals(FGenericMesh& mesh, size_t index);
 PPE_MESHBUILDER_API void ComputeNormals(const FGenericMesh& mesh, const FPositions3f& positions, const FNormals3f& normals);
 PPE_MESHBUILDER_API void ComputeNormals(const FGenericMesh& mesh, const FPositions4f& positions, const FNormals3f& normals);
 //----------------------------------------------------------------------------
-NODISCARD PPE_MESHBUILDER_API bool ComputeTangentSpace(FGenericMesh& mesh, size_t index, bool packHandedness = false);
-PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals);
-PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals);
-PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents);
-PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents);
+enum class ETangentSpace : u8 {
+    Averaged = 0, // area weighted triangle bases, handedness packed as 1 (left) or 0 (right)
+    MikkTSpace, // angle weighted like mikktspace.com without splitting vertices, handedness packed as -1 or +1
+
+    Default = Averaged,
+};
+//----------------------------------------------------------------------------
+// triangles are processed in parallel in SoA batches, then each vertex gathers its adjacent triangles
+NODISCARD PPE_MESHBUILDER_API bool ComputeTangentSpace(FGenericMesh& mesh, size_t index, bool packHandedness = false, ETangentSpace mode = ETangentSpace::Default);
+PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals, ETangentSpace mode = ETangentSpace::Default);
+PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents3f& tangents, const FBinormals3f& binormals, ETangentSpace mode = ETangentSpace::Default);
+PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions3f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents, ETangentSpace mode = ETangentSpace::Default);
+PPE_MESHBUILDER_API void ComputeTangentSpace(const FGenericMesh& mesh, const FPositions4f& positions, const FTexcoords2f& uv, const FNormals3f& normals, const FTangents4f& tangents, ETangentSpace mode = ETangentSpace::Default);
 //----------------------------------------------------------------------------
 NODISCARD PPE_MESHBUILDER_API bool TangentSpaceToQuaternion(FGenericMesh& mesh, size_t index, bool removeTBN = true);
 PPE_MESHBUILDER_API void TangentSpaceToQuaternion(const FGenericMesh& mesh, const FNormals3f& normals, const FBinormals3f& binormals, const FTangents3f& tangents, const FNormals4f& quaternions);
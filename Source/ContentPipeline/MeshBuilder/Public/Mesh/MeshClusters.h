@@ -0,0 +1,120 @@
+#pragma once
+
+#include "MeshBuilder_fwd.h"
+
+#include "Container/Vector.h"
+#include "IO/Stream_fwd.h"
+#include "Maths/ScalarVector.h"
+#include "Memory/MemoryView.h"
+#include "Thread/Task_fwd.h"
+
+// Meshlets and hierarchical cluster LODs (DAG) for GPU-driven rendering:
+// - level 0 splits the triangles in clusters of at most MaxVertices/MaxTriangles, built in parallel over Morton sorted chunks
+// - each cluster has a bounding sphere and a normal cone for culling, and 8 bits indices local to its vertices
+// - coarser levels group adjacent clusters, simplify each group with its borders locked and split the result in new clusters
+// - a cluster is drawn when its own error is small enough but not its parent's: errors and spheres grow with the levels,
+//   and every cluster of a group shares the same parent error, so any cut through the DAG is free of cracks
+// - all the levels index the vertices of the source mesh, simplification only collapses vertices
+// The DAG can be saved to a stream to be loaded back at runtime without rebuilding it.
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FMeshCluster {
+    STATIC_CONST_INTEGRAL(u32, NoGroup, 0xFFFFFFFFul);
+
+    u32 FirstVertex; // in FMeshClusterDAG::Vertices()
+    u32 FirstTriangle; // in FMeshClusterDAG::Triangles(), 3 local indices per triangle
+    u8 NumVertices;
+    u8 NumTriangles;
+    u16 Level;
+    u32 Group; // group simplified in the parents of this cluster, or NoGroup for the roots
+
+    // culling
+    float3 Center;
+    float Radius;
+    float3 ConeAxis;
+    float ConeCutoff; // sine of the cone half-angle, 1 when the cone is degenerate
+
+    // LOD selection, both spheres enclose the clusters they were simplified from
+    float3 LodCenter;
+    float LodRadius;
+    float LodError; // 0 for level 0
+    float3 ParentCenter;
+    float ParentRadius;
+    float ParentError; // FLT_MAX for the roots
+
+    bool IsRoot() const { return (NoGroup == Group); }
+};
+//----------------------------------------------------------------------------
+class PPE_MESHBUILDER_API FMeshClusterDAG {
+public:
+    STATIC_CONST_INTEGRAL(u32, MaxVertices, 64);
+    STATIC_CONST_INTEGRAL(u32, MaxTriangles, 124);
+
+    struct FSettings {
+        u32 MaxVertices{ FMeshClusterDAG::MaxVertices }; // <= 255
+        u32 MaxTriangles{ FMeshClusterDAG::MaxTriangles }; // <= 255
+        u32 ClustersPerGroup{ 4 };
+        u32 MaxLevels{ 16 };
+    };
+
+    FMeshClusterDAG() = default;
+
+    FMeshClusterDAG(const FMeshClusterDAG&) = delete;
+    FMeshClusterDAG& operator =(const FMeshClusterDAG&) = delete;
+
+    FMeshClusterDAG(FMeshClusterDAG&&) = default;
+    FMeshClusterDAG& operator =(FMeshClusterDAG&&) = default;
+
+    bool empty() const { return _clusters.empty(); }
+    u32 NumLevels() const { return checked_cast<u32>(_levels.size() ? _levels.size() - 1 : 0); }
+    u32 NumGroups() const { return _numGroups; }
+
+    TMemoryView<const FMeshCluster> Clusters() const { return _clusters.MakeConstView(); }
+    TMemoryView<const FMeshCluster> Level(u32 level) const {
+        return _clusters.MakeConstView().SubRange(_levels[level], _levels[level + 1] - _levels[level]);
+    }
+
+    TMemoryView<const u32> Vertices() const { return _vertices.MakeConstView(); }
+    TMemoryView<const u8> Triangles() const { return _triangles.MakeConstView(); }
+
+    TMemoryView<const u32> ClusterVertices(const FMeshCluster& cluster) const {
+        return _vertices.MakeConstView().SubRange(cluster.FirstVertex, cluster.NumVertices);
+    }
+    TMemoryView<const u8> ClusterTriangles(const FMeshCluster& cluster) const {
+        return _triangles.MakeConstView().SubRange(cluster.FirstTriangle * 3, cluster.NumTriangles * 3);
+    }
+
+    // uses Position3f(index) of the mesh, returns false when it's missing
+    NODISCARD bool Build(const FGenericMesh& mesh, size_t index = 0, ITaskContext* context = nullptr);
+    NODISCARD bool Build(const FGenericMesh& mesh, size_t index, const FSettings& settings, ITaskContext* context = nullptr);
+    void Clear();
+
+    // threshold is the tolerated error per unit of distance to the eye (pixel error * 2 * tan(fov / 2) / screen height)
+    NODISCARD static bool IsVisibleLod(const FMeshCluster& cluster, const float3& eye, float threshold) NOEXCEPT;
+    // cone culling, eye must be in the same space than the mesh
+    NODISCARD static bool IsBackfacing(const FMeshCluster& cluster, const float3& eye) NOEXCEPT;
+    // CPU reference for the cut evaluated on GPU, returns the number of selected clusters
+    size_t SelectClusters(const float3& eye, float threshold, VECTOR(MeshBuilder, u32)* pClusters) const;
+
+    void Save(IStreamWriter& writer) const;
+    // the stream is untrusted: every count and range is validated, and the DAG is left empty on failure
+    NODISCARD bool Load(IStreamReader& reader);
+
+private:
+    NODISCARD bool Load_(IStreamReader& reader);
+
+    VECTOR(MeshBuilder, FMeshCluster) _clusters; // sorted by level
+    VECTOR(MeshBuilder, u32) _vertices; // mesh vertex indices
+    VECTOR(MeshBuilder, u8) _triangles; // local indices in the vertices of each cluster
+    VECTOR(MeshBuilder, u32) _levels; // first cluster of each level, with a sentinel
+    u32 _numGroups{ 0 };
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
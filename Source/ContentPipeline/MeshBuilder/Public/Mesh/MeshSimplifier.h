@@ -0,0 +1,157 @@
+#pragma once
+
+#include "MeshBuilder_fwd.h"
+
+#include "Container/Vector.h"
+#include "Maths/ScalarVector.h"
+#include "Memory/MemoryView.h"
+#include "Thread/Task_fwd.h"
+
+// Edge collapse simplifier driven by quadric error metrics (Garland & Heckbert 97, Hoppe 99 for the attributes):
+// - works on indexed triangles, collapses are half-edges: the surviving vertices keep their index
+// - vertices on a border only slide along it, locked vertices and seams (same position, different index) never move
+// - each pass costs all the edges, then applies the cheapest ones popped from a bounded TMinMaxHeap
+// - a collapse is rejected when its 1-ring was modified by the same pass or when it would flip a triangle
+// - errors are measured in the units of the positions, as the distance to the planes of the merged triangles
+// - each attribute channel adds a quadric measuring how far a collapse moves it from its interpolated value,
+//   scaled by its weight: with attributes the error is not a pure distance anymore, but the sum of both terms
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class PPE_MESHBUILDER_API FMeshSimplifier {
+public:
+    // same budget in all the configurations, or debug and release builds wouldn't output the same meshes
+    STATIC_CONST_INTEGRAL(u32, MaxCollapsesPerPass, 1u << 20);
+
+    // positions are indexed by the vertex ids found in the indices
+    explicit FMeshSimplifier(const TMemoryView<const float3>& positions) NOEXCEPT
+    :   _positions(positions)
+    {}
+
+    // attributes holds attributeWeights.size() channels per vertex, indexed like the positions
+    FMeshSimplifier(
+        const TMemoryView<const float3>& positions,
+        const TMemoryView<const float>& attributes,
+        const TMemoryView<const float>& attributeWeights ) NOEXCEPT
+    :   _positions(positions)
+    ,   _attributes(attributes)
+    ,   _attributeWeights(attributeWeights) {
+        Assert_NoAssume(_attributes.size() == _positions.size() * _attributeWeights.size());
+    }
+
+    FMeshSimplifier(const FMeshSimplifier&) = delete;
+    FMeshSimplifier& operator =(const FMeshSimplifier&) = delete;
+
+    // all the borders are locked, for meshes stitched to other meshes
+    bool LockBorders() const { return _lockBorders; }
+    void SetLockBorders(bool value) { _lockBorders = value; }
+
+    // collapses edges until targetIndexCount or maxError is reached, returns the new index count:
+    // - indices are rewritten in place and only reference a subset of their original vertices
+    // - lockedVertices must be sorted, they can be absent from the indices
+    // - maxError and pResultError combine the distance to the planes and the weighted attribute deviations,
+    //   they are only in the units of the positions when there is no attribute (or all their weights are 0)
+    size_t Simplify(
+        const TMemoryView<u32>& indices,
+        const TMemoryView<const u32>& lockedVertices,
+        size_t targetIndexCount,
+        float maxError = FLT_MAX,
+        float* pResultError = nullptr );
+
+private:
+    struct FQuadric_ {
+        float A00, A11, A22, A10, A20, A21;
+        float B0, B1, B2;
+        float C;
+        float W; // sum of the geometric weights, errors are averaged
+
+        void AddPlane(const float3& normal, float distance, float weight) NOEXCEPT;
+        void Add(const FQuadric_& other) NOEXCEPT;
+        float Evaluate(const float3& p) const NOEXCEPT;
+    };
+
+    // cross terms between the position and one attribute channel
+    struct FAttributeQuadric_ {
+        float3 Gradient;
+        float Offset;
+        float Weight;
+    };
+
+    struct FCollapse_ {
+        float Cost;
+        u32 From;
+        u32 To;
+
+        bool operator <(const FCollapse_& other) const { return (Cost < other.Cost); }
+    };
+
+    void Setup_(const TMemoryView<const u32>& indices, const TMemoryView<const u32>& lockedVertices);
+    void ComputeQuadrics_();
+    void BuildAdjacency_();
+    void CollectEdges_();
+    size_t CollapsePass_(size_t targetTriangles, float maxCost, float* pMaxCost);
+    bool CanCollapse_(u32 from, u32 to, bool borderEdge) const NOEXCEPT;
+    bool FlipsTriangles_(u32 from, u32 to) const NOEXCEPT;
+    float CollapseCost_(u32 from, u32 to) const NOEXCEPT;
+    void MergeQuadrics_(u32 from, u32 to) NOEXCEPT;
+
+    TMemoryView<const float3> _positions;
+    TMemoryView<const float> _attributes;
+    TMemoryView<const float> _attributeWeights;
+    bool _lockBorders{ false };
+
+    // local to each call of Simplify(), vertices are remapped to [0, _vertices.size())
+    VECTOR(MeshBuilder, u32) _vertices; // local -> input vertex id, sorted
+    VECTOR(MeshBuilder, float3) _localPositions; // rescaled in the unit cube
+    VECTOR(MeshBuilder, FQuadric_) _quadrics;
+    VECTOR(MeshBuilder, FAttributeQuadric_) _attributeQuadrics; // one per channel for each vertex
+    VECTOR(MeshBuilder, u8) _kinds;
+    VECTOR(MeshBuilder, u32) _triangles; // 3 local indices per triangle
+    VECTOR(MeshBuilder, u8) _alive;
+
+    VECTOR(MeshBuilder, u32) _adjacencyOffsets; // vertex -> first triangle in _adjacency
+    VECTOR(MeshBuilder, u32) _adjacency;
+    VECTOR(MeshBuilder, u64) _edges; // (min << 32) | max, sorted with duplicates
+    VECTOR(MeshBuilder, FCollapse_) _heap;
+    VECTOR(MeshBuilder, u8) _dirty;
+
+    float _scale{ 1.0f };
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FMeshSimplifySettings {
+    float TargetRatio{ 0.5f }; // of the source triangles
+    u32 TargetTriangles{ 0 }; // overrides TargetRatio when not 0
+    float MaxError{ FLT_MAX }; // in the units of the positions, plus the weighted attribute deviations (see FMeshSimplifier)
+
+    // attribute channels are ignored when their weight is 0 or when the mesh doesn't have them
+    float NormalWeight{ 1.0f };
+    float TexcoordWeight{ 1.0f };
+    float TangentWeight{ 0.5f };
+
+    bool LockBorders{ false };
+};
+//----------------------------------------------------------------------------
+struct FMeshLOD {
+    VECTOR(MeshBuilder, u32) Indices; // references the vertices of the source mesh
+    float Error{ 0 };
+};
+//----------------------------------------------------------------------------
+// simplifies the indices in place, call RemoveUnusedVertices() to compact the vertices
+NODISCARD PPE_MESHBUILDER_API bool SimplifyMesh(FGenericMesh& mesh, size_t index, const FMeshSimplifySettings& settings, float* pResultError = nullptr);
+//----------------------------------------------------------------------------
+// each LOD is simplified from the source mesh with its own settings, all of them in parallel
+NODISCARD PPE_MESHBUILDER_API bool GenerateLODChain(
+    const TMemoryView<FMeshLOD>& lods,
+    const FGenericMesh& mesh, size_t index,
+    const TMemoryView<const FMeshSimplifySettings>& settings,
+    ITaskContext* context = nullptr );
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
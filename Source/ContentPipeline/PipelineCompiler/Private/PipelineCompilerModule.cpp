@@ -37,6 +37,7 @@ static void CreateVulkanDeviceCompiler_(const FVulkanDevice& device, ERHIFeature
 #if USE_PPE_FINAL_RELEASE
     Unused(features);
     compilationFlags += EShaderCompilationFlags::Quiet;
+    compilationFlags += EShaderCompilationFlags::StripDebugInfo;
 
 #else
     if (features & ERHIFeature::Debugging)
@@ -55,6 +56,10 @@ static void CreateVulkanDeviceCompiler_(const FVulkanDevice& device, ERHIFeature
         compilationFlags += EShaderCompilationFlags::Quiet;
     if (proc.HasArgument(L"-SPIRVNoQuiet"))
         compilationFlags -= EShaderCompilationFlags::Quiet;
+    if (proc.HasArgument(L"-SPIRVStrongOptimize"))
+        compilationFlags += EShaderCompilationFlags::StrongOptimization;
+    if (proc.HasArgument(L"-SPIRVStrip"))
+        compilationFlags += EShaderCompilationFlags::StripDebugInfo;
     if (proc.HasArgument(L"-SPIRVValidate"))
         compilationFlags += EShaderCompilationFlags::Validate;
     if (proc.HasArgument(L"-SPIRVNoValidate"))
@@ -65,6 +70,10 @@ static void CreateVulkanDeviceCompiler_(const FVulkanDevice& device, ERHIFeature
     TRefPtr compiler{ NEW_REF(PipelineCompiler, FVulkanPipelineCompiler, device) };
     compiler->SetCompilationFlags(compilationFlags);
 
+    // compiled SPIRV is persisted between runs, unless explicitly disabled
+    if (not FCurrentProcess::Get().HasArgument(L"-SPIRVNoCache"))
+        compiler->SetSpirvCacheDirectory(FDirpath{ L"Saved:/Cache/SPIRV" });
+
     auto& rhiModule = FRHIModule::Get(FModularDomain::Get());
     rhiModule.RegisterCompiler(GVulkanPipelineFormat_, PPipelineCompiler{ std::move(compiler) });
 }
@@ -4,6 +4,7 @@
 
 #include "Vulkan/Instance/VulkanInstance.h"
 #include "Vulkan/Pipeline/VulkanDebuggableShaderData.h"
+#include "Vulkan/Pipeline/VulkanSpirvCache.h"
 #include "Vulkan/Pipeline/VulkanSpirvCompiler.h"
 
 #if USE_PPE_RHIDEBUG
@@ -11,9 +12,11 @@
 #endif
 
 #include "Diagnostic/Logger.h"
+#include "Memory/HashFunctions.h"
 #include "Meta/Functor.h"
 #include "IO/Format.h"
 #include "Memory/SharedBuffer.h"
+#include "Thread/Task/TaskHelpers.h"
 
 namespace PPE {
 namespace RHI {
@@ -433,6 +436,136 @@ NODISCARD static bool CheckDescriptorBindings_(const FPipelineDesc& desc) {
 }
 #endif
 //----------------------------------------------------------------------------
+// Batch compilation: stages are compiled once for all the pipelines referencing them
+//----------------------------------------------------------------------------
+struct FBatchStage_ {
+    EShaderType Type{ Default };
+    EShaderLangFormat SrcFormat{ Default };
+    PShaderSource Source;
+    FConstChar SourceFile{ "@unknown" };
+    u32 NumPipelines{ 0 };
+    bool Succeed{ false };
+
+    FPipelineDesc::FShader Shader;
+    FVulkanSpirvCompiler::FShaderReflection Reflection;
+};
+//----------------------------------------------------------------------------
+struct FBatchPipeline_ {
+    u32 FirstStage{ 0 };
+    u32 NumStages{ 0 };
+    bool Succeed{ true };
+};
+//----------------------------------------------------------------------------
+NODISCARD static FShaderDataFingerprint BatchStageKey_(EShaderType type, EShaderLangFormat srcFormat, const PShaderSource& source) {
+    // sources loaded from files are fingerprinted by name: they can't change while the batch is compiling
+    FShaderDataFingerprint key = Fingerprint128(source->EntryPoint().MakeView(), source->Fingerprint());
+    key = Fingerprint128(&type, sizeof(type), key);
+    key = Fingerprint128(&srcFormat, sizeof(srcFormat), key);
+    return key;
+}
+//----------------------------------------------------------------------------
+NODISCARD CONSTEXPR FStringLiteral BatchPipelineName_(const FMeshPipelineDesc&) { return "Mesh"; }
+NODISCARD CONSTEXPR FStringLiteral BatchPipelineName_(const FGraphicsPipelineDesc&) { return "Graphics"; }
+NODISCARD CONSTEXPR FStringLiteral BatchPipelineName_(const FComputePipelineDesc&) { return "Compute"; }
+//----------------------------------------------------------------------------
+template <typename _PipelineDesc, typename _Each>
+static void ForeachBatchStage_(const _PipelineDesc& desc, _Each&& each) {
+    for (const auto& sh : desc.Shaders)
+        each(sh.first, sh.second.Data);
+}
+template <typename _Each>
+static void ForeachBatchStage_(const FComputePipelineDesc& desc, _Each&& each) {
+    each(EShaderType::Compute, desc.Shader.Data);
+}
+//----------------------------------------------------------------------------
+// merges the reflection of one compiled stage in its pipeline, shared by Compile() and CompileBatch_()
+NODISCARD static bool MergePipelineStage_(
+    FMeshPipelineDesc* ppln, EShaderType type,
+    FPipelineDesc::FShader&& shader, FVulkanSpirvCompiler::FShaderReflection&& reflection,
+    EShaderCompilationFlags flags ) {
+    if (not MergePipelineResources_(&ppln->PipelineLayout, reflection.Layout, flags))
+        return false;
+
+    switch (type) {
+    case EShaderType::MeshTask:
+        ppln->DefaultTaskGroupSize = reflection.Mesh.TaskGroupSize;
+        ppln->TaskSizeSpecialization = reflection.Mesh.TaskGroupSpecialization;
+        break;
+    case EShaderType::Mesh:
+        ppln->MaxIndices = reflection.Mesh.MaxIndices;
+        ppln->MaxVertices = reflection.Mesh.MaxVertices;
+        ppln->Topology = reflection.Mesh.Topology;
+        ppln->DefaultMeshGroupSize = reflection.Mesh.MeshGroupSize;
+        ppln->MeshSizeSpecialization = reflection.Mesh.MeshGroupSpecialization;
+        break;
+    case EShaderType::Fragment:
+        ppln->FragmentOutputs = reflection.Fragment.FragmentOutputs;
+        ppln->EarlyFragmentTests = reflection.Fragment.EarlyFragmentTests;
+        break;
+
+    default: AssertNotImplemented();
+    }
+
+    ppln->Shaders.Insert_Overwrite(EShaderType{ type }, std::move(shader));
+    return true;
+}
+NODISCARD static bool MergePipelineStage_(
+    FGraphicsPipelineDesc* ppln, EShaderType type,
+    FPipelineDesc::FShader&& shader, FVulkanSpirvCompiler::FShaderReflection&& reflection,
+    EShaderCompilationFlags flags ) {
+    if (not MergePipelineResources_(&ppln->PipelineLayout, reflection.Layout, flags))
+        return false;
+
+    ppln->SupportedTopology |= reflection.Vertex.SupportedTopology;
+
+    switch (type) {
+    case EShaderType::Vertex:
+        ppln->VertexAttributes = reflection.Vertex.VertexAttributes;
+        break;
+    case EShaderType::TessControl:
+        ppln->PatchControlPoints = reflection.Tesselation.PatchControlPoints;
+        break;
+    case EShaderType::TessEvaluation:
+        break;
+    case EShaderType::Geometry:
+        break;
+    case EShaderType::Fragment:
+        ppln->FragmentOutputs = reflection.Fragment.FragmentOutputs;
+        ppln->EarlyFragmentTests = reflection.Fragment.EarlyFragmentTests;
+        break;
+
+    default: AssertNotImplemented();
+    }
+
+    ppln->Shaders.Insert_Overwrite(EShaderType{ type }, std::move(shader));
+    return true;
+}
+NODISCARD static bool MergePipelineStage_(
+    FComputePipelineDesc* ppln, EShaderType type,
+    FPipelineDesc::FShader&& shader, FVulkanSpirvCompiler::FShaderReflection&& reflection,
+    EShaderCompilationFlags ) {
+    Assert_NoAssume(EShaderType::Compute == type);
+    Unused(type);
+
+    ppln->Shader = std::move(shader);
+    ppln->DefaultLocalGroupSize = reflection.Compute.LocalGroupSize;
+    ppln->LocalSizeSpecialization = reflection.Compute.LocalGroupSpecialization;
+    ppln->PipelineLayout = std::move(reflection.Layout);
+    return true;
+}
+//----------------------------------------------------------------------------
+// once all the stages are merged
+static void FinalizePipeline_(FMeshPipelineDesc* ppln) {
+    UpdateBufferDynamicOffsets_(&ppln->PipelineLayout.DescriptorSets);
+}
+static void FinalizePipeline_(FGraphicsPipelineDesc* ppln) {
+    ValidatePrimitiveTopology_(&ppln->SupportedTopology);
+    UpdateBufferDynamicOffsets_(&ppln->PipelineLayout.DescriptorSets);
+}
+static void FinalizePipeline_(FComputePipelineDesc* ppln) {
+    UpdateBufferDynamicOffsets_(&ppln->PipelineLayout.DescriptorSets);
+}
+//----------------------------------------------------------------------------
 } //!namespace
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -460,10 +593,12 @@ hash_t FVulkanPipelineCompiler::FShaderBinaryDataTraits::operator ()(const PShad
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 FVulkanPipelineCompiler::FVulkanPipelineCompiler(Meta::FForceInit)
-:   _defaultLogger(VulkanPipelineCompilerLogger_()) {
+:   _spirvCache(MakeUnique<FVulkanSpirvCache>())
+,   _defaultLogger(VulkanPipelineCompilerLogger_()) {
     const auto exclusiveData = _data.LockExclusive();
     exclusiveData->SpirvCompiler.create<FVulkanSpirvCompiler>(
         exclusiveData->Directories );
+    exclusiveData->SpirvCompiler->SetSpirvCache(_spirvCache.get());
 
     exclusiveData->SpirvCompiler->SetShaderClockFeatures(true, true);
     exclusiveData->SpirvCompiler->SetShaderFeatures(true, true);
@@ -471,6 +606,7 @@ FVulkanPipelineCompiler::FVulkanPipelineCompiler(Meta::FForceInit)
 //----------------------------------------------------------------------------
 FVulkanPipelineCompiler::FVulkanPipelineCompiler(const FVulkanDevice& device)
 :   _device(device)
+,   _spirvCache(MakeUnique<FVulkanSpirvCache>())
 ,   _defaultLogger(VulkanPipelineCompilerLogger_()) {
     Assert(_device->vkInstance());
     Assert(_device->vkPhysicalDevice());
@@ -479,6 +615,7 @@ FVulkanPipelineCompiler::FVulkanPipelineCompiler(const FVulkanDevice& device)
     const auto exclusiveData = _data.LockExclusive();
     exclusiveData->SpirvCompiler.create<FVulkanSpirvCompiler>(
         exclusiveData->Directories );
+    exclusiveData->SpirvCompiler->SetSpirvCache(_spirvCache.get());
 
     exclusiveData->SpirvCompiler->SetShaderClockFeatures(true, true);
     exclusiveData->SpirvCompiler->SetShaderFeatures(true, true);
@@ -555,9 +692,9 @@ void FVulkanPipelineCompiler::ReleaseUnusedShaders() {
     if (nullptr == _device)
         return; // not device specific -> can't prune unused variants
 
-    const auto exclusiveData = _data.LockExclusive();
+    const auto exclusiveCache = _shaderCache.LockExclusive();
 
-    for (auto it = exclusiveData->ShaderCache.begin(); it != exclusiveData->ShaderCache.end(); ) {
+    for (auto it = exclusiveCache->begin(); it != exclusiveCache->end(); ) {
         if (it->second->RefCount() > 1) {
             ++it;
             continue;
@@ -565,7 +702,7 @@ void FVulkanPipelineCompiler::ReleaseUnusedShaders() {
 
         it->second.as<FVulkanDebuggableShaderModule>()->TearDown(*_device);
 
-        it = exclusiveData->ShaderCache.erase_ReturnNext(it);
+        it = exclusiveCache->erase_ReturnNext(it);
     }
 }
 //----------------------------------------------------------------------------
@@ -573,14 +710,36 @@ void FVulkanPipelineCompiler::ReleaseShaderCache() {
     if (nullptr == _device)
         return; // not device specific -> can't prune unused variants
 
-    const auto exclusiveData = _data.LockExclusive();
+    const auto exclusiveCache = _shaderCache.LockExclusive();
 
-    for (const auto& it : exclusiveData->ShaderCache) {
+    for (const auto& it : *exclusiveCache) {
         Assert_NoAssume(it.second->RefCount() == 1);
         it.second.as<FVulkanDebuggableShaderModule>()->TearDown(*_device);
     }
 
-    exclusiveData->ShaderCache.clear_ReleaseMemory();
+    exclusiveCache->clear_ReleaseMemory();
+}
+//----------------------------------------------------------------------------
+FDirpath FVulkanPipelineCompiler::SpirvCacheDirectory() const {
+    const auto sharedData = _data.LockShared();
+    return _spirvCache->Directory();
+}
+//----------------------------------------------------------------------------
+void FVulkanPipelineCompiler::SetSpirvCacheDirectory(const FDirpath& path) {
+    const auto exclusiveData = _data.LockExclusive(); // waits for pending compilations
+    _spirvCache->SetDirectory(path);
+}
+//----------------------------------------------------------------------------
+void FVulkanPipelineCompiler::ReleaseSpirvCache() {
+    _spirvCache->Clear();
+}
+//----------------------------------------------------------------------------
+FVulkanSpirvCacheStatistics FVulkanPipelineCompiler::SpirvCacheStatistics() const NOEXCEPT {
+    return _spirvCache->Statistics();
+}
+//----------------------------------------------------------------------------
+void FVulkanPipelineCompiler::ResetSpirvCacheStatistics() NOEXCEPT {
+    _spirvCache->ResetStatistics();
 }
 //----------------------------------------------------------------------------
 // IsSupported()
@@ -642,7 +801,7 @@ bool FVulkanPipelineCompiler::IsSupported(const FComputePipelineDesc& desc, ESha
 bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat fmt, const FLogger& logger) {
     Assert_NoAssume(IsSupported(desc, fmt));
 
-    const auto exclusiveData = _data.LockExclusive();
+    const auto sharedData = _data.LockShared();
     const bool createModule = (Meta::EnumAnd(fmt, EShaderLangFormat::_StorageFormatMask) == EShaderLangFormat::ShaderModule);
     const EShaderLangFormat spirvFormat = (not createModule ? fmt : (fmt - EShaderLangFormat::_StorageFormatMask) | EShaderLangFormat::SPIRV);
 
@@ -683,7 +842,7 @@ bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat
             }
             content.Materialize();
 
-            if (not exclusiveData->SpirvCompiler->Compile(
+            if (not sharedData->SpirvCompiler->Compile(
                 &shader, &reflection, logger,
                 sh.first, it->first, spirvFormat,
                 (*pShaderSourceRef)->EntryPoint(),
@@ -691,7 +850,7 @@ bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat
                 return false;
             }
 
-            if (createModule && not CreateVulkanShader_(&shader, exclusiveData->ShaderCache, logger)) {
+            if (createModule && not CreateVulkanShader_(&shader, logger)) {
                 logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to create vulkan shader module!"_view, {
                     {"Pipeline", "Mesh"},
                     {"ShaderType", Meta::EnumOrd(sh.first)},
@@ -701,7 +860,7 @@ bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat
                 return false;
             }
 
-            if (not MergePipelineResources_(&ppln.PipelineLayout, reflection.Layout, exclusiveData->CompilationFlags)) {
+            if (not MergePipelineStage_(&ppln, sh.first, std::move(shader), std::move(reflection), sharedData->CompilationFlags)) {
                 logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to merge vulkan pipeline layout!"_view, {
                     {"Pipeline", "Mesh"},
                     {"ShaderType", Meta::EnumOrd(sh.first)},
@@ -710,28 +869,6 @@ bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat
                 });
                 return false;
             }
-
-            switch (sh.first) {
-            case EShaderType::MeshTask:
-                ppln.DefaultTaskGroupSize = reflection.Mesh.TaskGroupSize;
-                ppln.TaskSizeSpecialization = reflection.Mesh.TaskGroupSpecialization;
-                break;
-            case EShaderType::Mesh:
-                ppln.MaxIndices = reflection.Mesh.MaxIndices;
-                ppln.MaxVertices = reflection.Mesh.MaxVertices;
-                ppln.Topology = reflection.Mesh.Topology;
-                ppln.DefaultMeshGroupSize = reflection.Mesh.MeshGroupSize;
-                ppln.MeshSizeSpecialization = reflection.Mesh.MeshGroupSpecialization;
-                break;
-            case EShaderType::Fragment:
-                ppln.FragmentOutputs = reflection.Fragment.FragmentOutputs;
-                ppln.EarlyFragmentTests = reflection.Fragment.EarlyFragmentTests;
-                break;
-
-            default: AssertNotImplemented();
-            }
-
-            ppln.Shaders.Insert_Overwrite(EShaderType{ sh.first }, std::move(shader));
         }
         else {
             logger(ELoggerVerbosity::Error, "@unknown", 0, "invalid shader data type, expected a source!"_view, {
@@ -745,7 +882,7 @@ bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat
         }
     }
 
-    UpdateBufferDynamicOffsets_(&ppln.PipelineLayout.DescriptorSets);
+    FinalizePipeline_(&ppln);
 
     desc = std::move(ppln);
 
@@ -756,7 +893,7 @@ bool FVulkanPipelineCompiler::Compile(FMeshPipelineDesc& desc, EShaderLangFormat
 bool FVulkanPipelineCompiler::Compile(FRayTracingPipelineDesc& desc, EShaderLangFormat fmt, const FLogger& logger) {
     Assert_NoAssume(IsSupported(desc, fmt));
 
-    const auto exclusiveData = _data.LockExclusive();
+    const auto sharedData = _data.LockShared();
     const bool createModule = (Meta::EnumAnd(fmt, EShaderLangFormat::_StorageFormatMask) == EShaderLangFormat::ShaderModule);
     const EShaderLangFormat spirvFormat = (not createModule ? fmt : (fmt - EShaderLangFormat::_StorageFormatMask) | EShaderLangFormat::SPIRV);
 
@@ -796,7 +933,7 @@ bool FVulkanPipelineCompiler::Compile(FRayTracingPipelineDesc& desc, EShaderLang
 
             FRayTracingPipelineDesc::FRTShader shader;
             FVulkanSpirvCompiler::FShaderReflection reflection;
-            if (not exclusiveData->SpirvCompiler->Compile(
+            if (not sharedData->SpirvCompiler->Compile(
                 &shader, &reflection, logger,
                 sh.second.Type, it->first, spirvFormat,
                 (*pShaderSourceRef)->EntryPoint(),
@@ -804,7 +941,7 @@ bool FVulkanPipelineCompiler::Compile(FRayTracingPipelineDesc& desc, EShaderLang
                 return false;
             }
 
-            if (createModule && not CreateVulkanShader_(&shader, exclusiveData->ShaderCache, logger)) {
+            if (createModule && not CreateVulkanShader_(&shader, logger)) {
                 logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to create vulkan shader module!"_view, {
                     {"Pipeline", "RayTracing"},
                     {"ShaderName", sh.first.MakeView()},
@@ -814,7 +951,7 @@ bool FVulkanPipelineCompiler::Compile(FRayTracingPipelineDesc& desc, EShaderLang
                 return false;
             }
 
-            if (not MergePipelineResources_(&ppln.PipelineLayout, reflection.Layout, exclusiveData->CompilationFlags)) {
+            if (not MergePipelineResources_(&ppln.PipelineLayout, reflection.Layout, sharedData->CompilationFlags)) {
                 logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to merge vulkan pipeline layout!"_view, {
                     {"Pipeline", "RayTracing"},
                     {"ShaderName", sh.first.MakeView()},
@@ -862,7 +999,7 @@ bool FVulkanPipelineCompiler::Compile(FRayTracingPipelineDesc& desc, EShaderLang
 bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFormat fmt, const FLogger& logger) {
     Assert_NoAssume(IsSupported(desc, fmt));
 
-    const auto exclusiveData = _data.LockExclusive();
+    const auto sharedData = _data.LockShared();
     const bool createModule = (Meta::EnumAnd(fmt, EShaderLangFormat::_StorageFormatMask) == EShaderLangFormat::ShaderModule);
     const EShaderLangFormat spirvFormat = (not createModule ? fmt : (fmt - EShaderLangFormat::_StorageFormatMask) | EShaderLangFormat::SPIRV);
 
@@ -902,7 +1039,7 @@ bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFo
 
             FGraphicsPipelineDesc::FShader shader;
             FVulkanSpirvCompiler::FShaderReflection reflection;
-            if (not exclusiveData->SpirvCompiler->Compile(
+            if (not sharedData->SpirvCompiler->Compile(
                 &shader, &reflection, logger,
                 sh.first, it->first, spirvFormat,
                 (*pShaderSourceRef)->EntryPoint(),
@@ -910,7 +1047,7 @@ bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFo
                 return false;
             }
 
-            if (createModule && not CreateVulkanShader_(&shader, exclusiveData->ShaderCache, logger)) {
+            if (createModule && not CreateVulkanShader_(&shader, logger)) {
                 logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to create vulkan shader module!"_view, {
                     {"Pipeline", "Graphics"},
                     {"ShaderType", Meta::EnumOrd(sh.first)},
@@ -920,7 +1057,7 @@ bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFo
                 return false;
             }
 
-            if (not MergePipelineResources_(&ppln.PipelineLayout, reflection.Layout, exclusiveData->CompilationFlags)) {
+            if (not MergePipelineStage_(&ppln, sh.first, std::move(shader), std::move(reflection), sharedData->CompilationFlags)) {
                 logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to merge vulkan pipeline layout!"_view, {
                     {"Pipeline", "Graphics"},
                     {"ShaderType", Meta::EnumOrd(sh.first)},
@@ -929,29 +1066,6 @@ bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFo
                 });
                 return false;
             }
-
-            ppln.SupportedTopology |= reflection.Vertex.SupportedTopology;
-
-            switch (sh.first) {
-            case EShaderType::Vertex:
-                ppln.VertexAttributes = reflection.Vertex.VertexAttributes;
-                break;
-            case EShaderType::TessControl:
-                ppln.PatchControlPoints = reflection.Tesselation.PatchControlPoints;
-                break;
-            case EShaderType::TessEvaluation:
-                break;
-            case EShaderType::Geometry:
-                break;
-            case EShaderType::Fragment:
-                ppln.FragmentOutputs = reflection.Fragment.FragmentOutputs;
-                ppln.EarlyFragmentTests = reflection.Fragment.EarlyFragmentTests;
-                break;
-
-            default: AssertNotImplemented();
-            }
-
-            ppln.Shaders.Insert_Overwrite(EShaderType{ sh.first }, std::move(shader));
         }
         else {
             logger(ELoggerVerbosity::Error, "@unknown", 0, "invalid shader data type, expected a source!"_view, {
@@ -965,8 +1079,7 @@ bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFo
         }
     }
 
-    ValidatePrimitiveTopology_(&ppln.SupportedTopology);
-    UpdateBufferDynamicOffsets_(&ppln.PipelineLayout.DescriptorSets);
+    FinalizePipeline_(&ppln);
 
     desc = std::move(ppln);
 
@@ -977,7 +1090,7 @@ bool FVulkanPipelineCompiler::Compile(FGraphicsPipelineDesc& desc, EShaderLangFo
 bool FVulkanPipelineCompiler::Compile(FComputePipelineDesc& desc, EShaderLangFormat fmt, const FLogger& logger) {
     Assert_NoAssume(IsSupported(desc, fmt));
 
-    const auto exclusiveData = _data.LockExclusive();
+    const auto sharedData = _data.LockShared();
     const bool createModule = (Meta::EnumAnd(fmt, EShaderLangFormat::_StorageFormatMask) == EShaderLangFormat::ShaderModule);
     const EShaderLangFormat spirvFormat = (not createModule ? fmt : (fmt - EShaderLangFormat::_StorageFormatMask) | EShaderLangFormat::SPIRV);
 
@@ -1012,16 +1125,17 @@ bool FVulkanPipelineCompiler::Compile(FComputePipelineDesc& desc, EShaderLangFor
         }
         content.Materialize();
 
+        FComputePipelineDesc::FShader shader;
         FVulkanSpirvCompiler::FShaderReflection reflection;
-        if (not exclusiveData->SpirvCompiler->Compile(
-            &ppln.Shader, &reflection, logger,
+        if (not sharedData->SpirvCompiler->Compile(
+            &shader, &reflection, logger,
             EShaderType::Compute, it->first, spirvFormat,
             (*pShaderSourceRef)->EntryPoint(),
             content, sourceFile )) {
             return false;
         }
 
-        if (createModule && not CreateVulkanShader_(&ppln.Shader, exclusiveData->ShaderCache, logger)) {
+        if (createModule && not CreateVulkanShader_(&shader, logger)) {
             logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to create vulkan shader module!"_view, {
                 {"Pipeline", "Comptue"},
                 {"ShaderLangFormat", Meta::EnumOrd(it->first)},
@@ -1030,9 +1144,7 @@ bool FVulkanPipelineCompiler::Compile(FComputePipelineDesc& desc, EShaderLangFor
             return false;
         }
 
-        ppln.DefaultLocalGroupSize = reflection.Compute.LocalGroupSize;
-        ppln.LocalSizeSpecialization = reflection.Compute.LocalGroupSpecialization;
-        ppln.PipelineLayout = std::move(reflection.Layout);
+        Verify(MergePipelineStage_(&ppln, EShaderType::Compute, std::move(shader), std::move(reflection), sharedData->CompilationFlags));
     }
     else {
         logger(ELoggerVerbosity::Error, "@unknown", 0, "invalid shader data type, expected a source!"_view, {
@@ -1044,7 +1156,7 @@ bool FVulkanPipelineCompiler::Compile(FComputePipelineDesc& desc, EShaderLangFor
         return false;
     }
 
-    UpdateBufferDynamicOffsets_(&ppln.PipelineLayout.DescriptorSets);
+    FinalizePipeline_(&ppln);
 
     desc = std::move(ppln);
 
@@ -1052,11 +1164,186 @@ bool FVulkanPipelineCompiler::Compile(FComputePipelineDesc& desc, EShaderLangFor
     return true;
 }
 //----------------------------------------------------------------------------
-bool FVulkanPipelineCompiler::CreateVulkanShader_(FPipelineDesc::FShader* shader, FShaderCompiledModuleCache& shaderCache, const FLogger& logger) const {
+bool FVulkanPipelineCompiler::CompileBatch(const TMemoryView<FMeshPipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) {
+    return CompileBatch_(descs, fmt, logger);
+}
+//----------------------------------------------------------------------------
+bool FVulkanPipelineCompiler::CompileBatch(const TMemoryView<FGraphicsPipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) {
+    return CompileBatch_(descs, fmt, logger);
+}
+//----------------------------------------------------------------------------
+bool FVulkanPipelineCompiler::CompileBatch(const TMemoryView<FComputePipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) {
+    return CompileBatch_(descs, fmt, logger);
+}
+//----------------------------------------------------------------------------
+template <typename _PipelineDesc>
+bool FVulkanPipelineCompiler::CompileBatch_(const TMemoryView<_PipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) {
+    if (descs.empty())
+        return true;
+
+    const auto sharedData = _data.LockShared();
+    const bool createModule = (Meta::EnumAnd(fmt, EShaderLangFormat::_StorageFormatMask) == EShaderLangFormat::ShaderModule);
+    const EShaderLangFormat spirvFormat = (not createModule ? fmt : (fmt - EShaderLangFormat::_StorageFormatMask) | EShaderLangFormat::SPIRV);
+    const FStringLiteral pipelineName = BatchPipelineName_(descs.front());
+
+    VECTOR(PipelineCompiler, FBatchStage_) stages;
+    VECTOR(PipelineCompiler, u32) stageIndices;
+    VECTOR(PipelineCompiler, FBatchPipeline_) pipelines;
+    pipelines.resize(descs.size());
+
+    // gather unique stages, pipelines only keep the indices of their stages
+    {
+        HASHMAP(PipelineCompiler, FShaderDataFingerprint, u32) uniqueStages;
+
+        forrange(i, 0, descs.size()) {
+            Assert_NoAssume(IsSupported(descs[i], fmt));
+
+            FBatchPipeline_& batch = pipelines[i];
+            batch.FirstStage = checked_cast<u32>(stageIndices.size());
+
+            ForeachBatchStage_(descs[i], [&](EShaderType type, const FShaderDataMap& data) {
+                Assert(not data.empty());
+
+                const auto it = HighestPriorityShaderFormat_(data, spirvFormat);
+                if (data.end() == it) {
+                    logger(ELoggerVerbosity::Error, "@unknown", 0, "no suitable shader format found!"_view, {
+                        {"Pipeline", pipelineName},
+                        {"ShaderType", Meta::EnumOrd(type)},
+                        {"SpirvFormat", Meta::EnumOrd(spirvFormat)}
+                    });
+                    batch.Succeed = false;
+                    return;
+                }
+
+                const auto* const pShaderSourceRef = std::get_if<PShaderSource>(&it->second);
+                if (nullptr == pShaderSourceRef) {
+                    logger(ELoggerVerbosity::Error, "@unknown", 0, "invalid shader data type, expected a source!"_view, {
+                        {"Pipeline", pipelineName},
+                        {"ShaderType", Meta::EnumOrd(type)},
+                        {"ShaderLangFormat", Meta::EnumOrd(it->first)},
+                        {"SpirvFormat", Meta::EnumOrd(spirvFormat)},
+                        {"ShaderDataType", it->second.index()},
+                    });
+                    batch.Succeed = false;
+                    return;
+                }
+
+                const auto unique = uniqueStages.insert({
+                    BatchStageKey_(type, it->first, *pShaderSourceRef),
+                    checked_cast<u32>(stages.size()) });
+                if (unique.second) {
+                    stages.emplace_back();
+                    FBatchStage_& stage = stages.back();
+                    stage.Type = type;
+                    stage.SrcFormat = it->first;
+                    stage.Source = *pShaderSourceRef;
+#if USE_PPE_RHIDEBUG
+                    stage.SourceFile = stage.Source->DebugName();
+#endif
+                }
+
+                stages[unique.first->second].NumPipelines++;
+                stageIndices.push_back(unique.first->second);
+                batch.NumStages++;
+            });
+        }
+    }
+
+    // compile all unique stages concurrently
+    ParallelFor(0, stages.size(), [&](size_t s) {
+        FBatchStage_& stage = stages[s];
+        const FConstChar sourceFile = stage.SourceFile;
+
+        FSharedBuffer content{ stage.Source->Data()->LoadShaderSource() };
+        if (not content) {
+            logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to load shader source!"_view, {
+                {"Pipeline", pipelineName},
+                {"ShaderType", Meta::EnumOrd(stage.Type)},
+                {"ShaderLangFormat", Meta::EnumOrd(stage.SrcFormat)},
+                {"SpirvFormat", Meta::EnumOrd(spirvFormat)}
+            });
+            return;
+        }
+        content.Materialize();
+
+        if (not sharedData->SpirvCompiler->Compile(
+            &stage.Shader, &stage.Reflection, logger,
+            stage.Type, stage.SrcFormat, spirvFormat,
+            stage.Source->EntryPoint(),
+            content, sourceFile )) {
+            return;
+        }
+
+        if (createModule && not CreateVulkanShader_(&stage.Shader, logger)) {
+            logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to create vulkan shader module!"_view, {
+                {"Pipeline", pipelineName},
+                {"ShaderType", Meta::EnumOrd(stage.Type)},
+                {"ShaderLangFormat", Meta::EnumOrd(stage.SrcFormat)},
+                {"SpirvFormat", Meta::EnumOrd(spirvFormat)}
+            });
+            return;
+        }
+
+        stage.Succeed = true;
+    });
+
+    // merge the reflection of each pipeline once all its stages are compiled
+    ParallelFor(0, descs.size(), [&](size_t i) {
+        FBatchPipeline_& batch = pipelines[i];
+        if (not batch.Succeed)
+            return;
+
+        _PipelineDesc ppln;
+
+        for (const u32 s : stageIndices.MakeConstView().SubRange(batch.FirstStage, batch.NumStages)) {
+            FBatchStage_& stage = stages[s];
+            if (not stage.Succeed) {
+                batch.Succeed = false;
+                return;
+            }
+
+            // stages used by only one pipeline can be consumed, the others are copied
+            FPipelineDesc::FShader shader;
+            FVulkanSpirvCompiler::FShaderReflection reflection;
+            if (stage.NumPipelines == 1) {
+                shader = std::move(stage.Shader);
+                reflection = std::move(stage.Reflection);
+            }
+            else {
+                shader = stage.Shader;
+                FVulkanSpirvCompiler::CopyReflection(&reflection, stage.Reflection);
+            }
+
+            if (not MergePipelineStage_(&ppln, stage.Type, std::move(shader), std::move(reflection), sharedData->CompilationFlags)) {
+                logger(ELoggerVerbosity::Error, stage.SourceFile, 0, "failed to merge vulkan pipeline layout!"_view, {
+                    {"Pipeline", pipelineName},
+                    {"ShaderType", Meta::EnumOrd(stage.Type)},
+                    {"ShaderLangFormat", Meta::EnumOrd(stage.SrcFormat)},
+                    {"SpirvFormat", Meta::EnumOrd(spirvFormat)}
+                });
+                batch.Succeed = false;
+                return;
+            }
+        }
+
+        FinalizePipeline_(&ppln);
+
+        descs[i] = std::move(ppln);
+
+        ONLY_IF_RHIDEBUG(AssertRelease_NoAssume(CheckDescriptorBindings_(descs[i])));
+    });
+
+    return std::all_of(pipelines.begin(), pipelines.end(),
+        [](const FBatchPipeline_& batch) NOEXCEPT { return batch.Succeed; });
+}
+//----------------------------------------------------------------------------
+bool FVulkanPipelineCompiler::CreateVulkanShader_(FPipelineDesc::FShader* shader, const FLogger& logger) {
     Assert(shader);
     Assert(_device);
 
     u32 numSpirvData = 0;
+    const auto exclusiveCache = _shaderCache.LockExclusive();
+    FShaderCompiledModuleCache& shaderCache = *exclusiveCache;
 
     for (auto sh = shader->Data.begin(); sh != shader->Data.end(); ) {
         switch (Meta::EnumAnd(sh->first, EShaderLangFormat::_StorageFormatMask)) {
@@ -0,0 +1,437 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Vulkan/Pipeline/VulkanSpirvCache.h"
+
+#include "RHI/Config.h"
+
+#include "HAL/PlatformFile.h"
+#include "IO/Extname.h"
+#include "IO/FileSystemProperties.h"
+#include "IO/Format.h"
+#include "IO/TextWriter.h"
+#include "Memory/HashFunctions.h"
+#include "Memory/MemoryProvider.h"
+#include "Memory/MemoryStream.h"
+#include "Memory/SharedBuffer.h"
+#include "Misc/FourCC.h"
+#include "Thread/AtomicSpinLock.h"
+#include "Time/Timepoint.h"
+#include "Time/Timestamp.h"
+#include "VirtualFileSystem_fwd.h"
+
+namespace PPE {
+namespace RHI {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+#define PPE_SPIRVCACHE_EXTNAME L".spvc"
+//----------------------------------------------------------------------------
+static const FFourCC FILE_MAGIC_    ("SPVC");
+static const FFourCC FILE_VERSION_  ("1.00");
+//----------------------------------------------------------------------------
+// reflection is stored as raw POD: any layout change must invalidate the files
+static const u64 GReflectionLayout_ = static_cast<u64>(hash_tuple(
+    sizeof(FPipelineDesc::FDescriptorSet),
+    sizeof(TPair<FUniformID, FPipelineDesc::FVariantUniform>),
+    sizeof(TPair<FPushConstantID, FPipelineDesc::FPushConstant>),
+    sizeof(TPair<FSpecializationID, u32>),
+    sizeof(FVulkanSpirvCache::FShaderReflection::FTopologyBits),
+    sizeof(FVertexAttribute),
+    sizeof(FPipelineDesc::FFragmentOutput),
+    sizeof(FVulkanSpirvCache::FShaderReflection::Compute),
+    sizeof(FVulkanSpirvCache::FShaderReflection::Mesh) ));
+//----------------------------------------------------------------------------
+struct FFileHeader_ {
+    FFourCC Magic;
+    FFourCC Version;
+    u64 ReflectionLayout;
+    FShaderDataFingerprint Key;
+    FShaderDataFingerprint PayloadFingerprint;
+    u64 PayloadSizeInBytes;
+};
+STATIC_ASSERT(Meta::is_pod_v<FFileHeader_>);
+//----------------------------------------------------------------------------
+NODISCARD static u64 TimespanInMicros_(FTimespan elapsed) {
+    return static_cast<u64>(Max(0.0, elapsed.Value()) * 1000.0);
+}
+//----------------------------------------------------------------------------
+template <typename T>
+static void WritePodArray_(IStreamWriter& writer, const TMemoryView<T>& values) {
+    writer.WritePOD(checked_cast<u32>(values.size()));
+    writer.WriteView(values);
+}
+//----------------------------------------------------------------------------
+template <typename T, typename _Push>
+NODISCARD static bool ReadPodArray_(IBufferedStreamReader& reader, u32 capacity, _Push&& push) {
+    u32 count = 0;
+    if (not reader.ReadPOD(&count) or count > capacity)
+        return false;
+
+    forrange(i, 0, count) {
+        T value{};
+        if (not reader.ReadPOD(&value))
+            return false;
+        push(std::move(value));
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class FVulkanSpirvCache::FEntry : public FRefCountable {
+public:
+    FShaderDataFingerprint ShaderFingerprint{};
+    FRawData Spirv;
+    FShaderReflection Reflection;
+    FIncludes Includes;
+
+    // stat() every include and only re-hash those which changed since the last validation,
+    // so memory hits don't read back all the includes each time
+    NODISCARD bool ValidateIncludes() const {
+        forrange(i, 0, Includes.size()) {
+            const FInclude& include = Includes[i];
+
+            FFileStat fstat;
+            if (not VFS_FileStats(&fstat, include.Filename))
+                return false;
+
+            const FIncludeStat_ stat{ fstat.SizeInBytes, fstat.LastModified };
+            {
+                const FAtomicSpinLock::FScope scopeLock(_barrier);
+                if (_validatedStats.size() == Includes.size() and _validatedStats[i] == stat)
+                    continue;
+            }
+
+            const FUniqueBuffer source = VFS_ReadAll(include.Filename, EAccessPolicy::Text);
+            if (not source or IncludeFingerprint(source.MakeView()) != include.Fingerprint)
+                return false;
+
+            const FAtomicSpinLock::FScope scopeLock(_barrier);
+            if (_validatedStats.size() != Includes.size())
+                _validatedStats.resize(Includes.size());
+            _validatedStats[i] = stat;
+        }
+        return true;
+    }
+
+    void Serialize(IStreamWriter& writer) const {
+        writer.WritePOD(ShaderFingerprint);
+        WritePodArray_(writer, Spirv.MakeConstView());
+
+        writer.WritePOD(checked_cast<u32>(Includes.size()));
+        for (const FInclude& include : Includes) {
+            const FWString filename = include.Filename.ToWString();
+            writer.WritePOD(checked_cast<u32>(filename.size()));
+            writer.WriteView(filename.MakeView());
+            writer.WritePOD(include.Fingerprint);
+        }
+
+        writer.WritePOD(checked_cast<u32>(Reflection.Layout.DescriptorSets.size()));
+        for (const FPipelineDesc::FDescriptorSet& ds : Reflection.Layout.DescriptorSets) {
+            writer.WritePOD(ds.Id);
+            writer.WritePOD(ds.BindingIndex);
+            if (ds.Uniforms)
+                WritePodArray_(writer, ds.Uniforms->MakeView());
+            else
+                writer.WritePOD(u32(0));
+        }
+
+        WritePodArray_(writer, Reflection.Layout.PushConstants.MakeView());
+        WritePodArray_(writer, Reflection.Specializations.MakeView());
+
+        writer.WritePOD(Reflection.Vertex.SupportedTopology);
+        WritePodArray_(writer, Reflection.Vertex.VertexAttributes.MakeView());
+        writer.WritePOD(Reflection.Tesselation.PatchControlPoints);
+        WritePodArray_(writer, Reflection.Fragment.FragmentOutputs.MakeView());
+        writer.WritePOD(Reflection.Fragment.EarlyFragmentTests);
+        writer.WritePOD(Reflection.Compute);
+        writer.WritePOD(Reflection.Mesh);
+    }
+
+    NODISCARD bool Deserialize(IBufferedStreamReader& reader) {
+        if (not reader.ReadPOD(&ShaderFingerprint))
+            return false;
+
+        u32 spirvSize = 0;
+        if (not reader.ReadPOD(&spirvSize) or 0 == spirvSize or std::streamsize(spirvSize) > reader.SizeInBytes())
+            return false;
+        Spirv.Resize_DiscardData(spirvSize);
+        if (not reader.ReadView(Spirv.MakeView()))
+            return false;
+
+        u32 numIncludes = 0;
+        if (not reader.ReadPOD(&numIncludes))
+            return false;
+        forrange(i, 0, numIncludes) {
+            u32 length = 0;
+            if (not reader.ReadPOD(&length) or 0 == length or length > FileSystem::MaxPathLength)
+                return false;
+
+            wchar_t filename[FileSystem::MaxPathLength];
+            const TMemoryView<wchar_t> filenameView = MakeView(filename).FirstNElements(length);
+            if (not reader.ReadView(filenameView))
+                return false;
+
+            FInclude& include = Includes.push_back_Default();
+            include.Filename = FFilename{ FWStringView{ filenameView } };
+            if (not reader.ReadPOD(&include.Fingerprint))
+                return false;
+        }
+
+        u32 numDescriptorSets = 0;
+        if (not reader.ReadPOD(&numDescriptorSets) or numDescriptorSets > MaxDescriptorSets)
+            return false;
+        forrange(i, 0, numDescriptorSets) {
+            FDescriptorSetID id;
+            u32 bindingIndex = 0;
+            if (not reader.ReadPOD(&id) or not reader.ReadPOD(&bindingIndex))
+                return false;
+
+            FPipelineDesc::PUniformMap uniforms = NEW_REF(RHIPipeline, FPipelineDesc::FUniformMap);
+            if (not ReadPodArray_<TPair<FUniformID, FPipelineDesc::FVariantUniform>>(reader, MaxUniforms,
+                [&uniforms](auto&& it) { uniforms->Insert_AssertUnique(std::move(it.first), std::move(it.second)); }))
+                return false;
+
+            Reflection.Layout.DescriptorSets.Push(id, bindingIndex, std::move(uniforms));
+        }
+
+        if (not ReadPodArray_<TPair<FPushConstantID, FPipelineDesc::FPushConstant>>(reader, MaxPushConstantsCount,
+                [this](auto&& it) { Reflection.Layout.PushConstants.Insert_AssertUnique(std::move(it.first), std::move(it.second)); }) or
+            not ReadPodArray_<TPair<FSpecializationID, u32>>(reader, MaxSpecializationConstants,
+                [this](auto&& it) { Reflection.Specializations.Insert_AssertUnique(std::move(it.first), std::move(it.second)); }) )
+            return false;
+
+        if (not reader.ReadPOD(&Reflection.Vertex.SupportedTopology) or
+            not ReadPodArray_<FVertexAttribute>(reader, MaxVertexAttribs,
+                [this](FVertexAttribute&& attrib) { Reflection.Vertex.VertexAttributes.Push(std::move(attrib)); }) or
+            not reader.ReadPOD(&Reflection.Tesselation.PatchControlPoints) or
+            not ReadPodArray_<FPipelineDesc::FFragmentOutput>(reader, MaxColorBuffers,
+                [this](FPipelineDesc::FFragmentOutput&& output) { Reflection.Fragment.FragmentOutputs.Push(std::move(output)); }) or
+            not reader.ReadPOD(&Reflection.Fragment.EarlyFragmentTests) or
+            not reader.ReadPOD(&Reflection.Compute) or
+            not reader.ReadPOD(&Reflection.Mesh) )
+            return false;
+
+        return reader.Eof();
+    }
+
+private:
+    struct FIncludeStat_ {
+        u64 SizeInBytes{ 0 };
+        FTimestamp LastModified;
+
+        bool operator ==(const FIncludeStat_& other) const {
+            return (SizeInBytes == other.SizeInBytes and LastModified == other.LastModified);
+        }
+    };
+
+    mutable FAtomicSpinLock _barrier;
+    mutable VECTORINSITU(PipelineCompiler, FIncludeStat_, 2) _validatedStats; // empty until first validation
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FVulkanSpirvCache::FVulkanSpirvCache() = default;
+//----------------------------------------------------------------------------
+FVulkanSpirvCache::~FVulkanSpirvCache() = default;
+//----------------------------------------------------------------------------
+void FVulkanSpirvCache::SetDirectory(const FDirpath& path) {
+    _directory = path; // sub-directories are created when writing the entries
+}
+//----------------------------------------------------------------------------
+bool FVulkanSpirvCache::Find(
+    FShaderDataFingerprint* outShaderFingerprint,
+    FRawData* outSpirv,
+    FShaderReflection* outReflection,
+    const FShaderDataFingerprint& key ) {
+    Assert(outShaderFingerprint);
+    Assert(outSpirv);
+    Assert(outReflection);
+
+    const FTimepoint startedAt = FTimepoint::Now();
+    auto& shard = _shards[ShardIndex_(key)];
+
+    PEntry entry;
+    bool fromDisk = false;
+    {
+        const auto sharedShard = shard.LockShared();
+        const auto it = sharedShard->find(key);
+        if (sharedShard->end() != it)
+            entry = it->second;
+    }
+
+    if (not entry) {
+        entry = LoadEntry_(key);
+        fromDisk = true;
+    }
+
+    if (not entry) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (not entry->ValidateIncludes()) {
+        _staleEntries.fetch_add(1, std::memory_order_relaxed);
+        _misses.fetch_add(1, std::memory_order_relaxed);
+
+        if (not fromDisk) {
+            const auto exclusiveShard = shard.LockExclusive();
+            const auto it = exclusiveShard->find(key);
+            if (exclusiveShard->end() != it and it->second == entry)
+                exclusiveShard->erase(it);
+        }
+        return false;
+    }
+
+    if (fromDisk) {
+        const auto exclusiveShard = shard.LockExclusive();
+        exclusiveShard->insert_or_assign({ key, entry });
+    }
+
+    *outShaderFingerprint = entry->ShaderFingerprint;
+    *outSpirv = FRawData{ entry->Spirv.MakeConstView() };
+    FVulkanSpirvCompiler::CopyReflection(outReflection, entry->Reflection);
+
+    (fromDisk ? _diskHits : _memoryHits).fetch_add(1, std::memory_order_relaxed);
+    _lookupTimeInMicros.fetch_add(TimespanInMicros_(FTimepoint::ElapsedSince(startedAt)), std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------------------------------------------
+void FVulkanSpirvCache::Add(
+    const FShaderDataFingerprint& key,
+    const FShaderDataFingerprint& shaderFingerprint,
+    const FRawData& spirv,
+    const FShaderReflection& reflection,
+    FIncludes&& includes,
+    FTimespan compilationTime ) {
+    Assert_NoAssume(not spirv.empty());
+
+    _compilationTimeInMicros.fetch_add(TimespanInMicros_(compilationTime), std::memory_order_relaxed);
+
+    PEntry entry = NEW_REF(PipelineCompiler, FEntry);
+    entry->ShaderFingerprint = shaderFingerprint;
+    entry->Spirv = FRawData{ spirv.MakeConstView() };
+    entry->Includes = std::move(includes);
+    FVulkanSpirvCompiler::CopyReflection(&entry->Reflection, reflection);
+
+    if (not _directory.empty() and SaveEntry_(key, *entry))
+        _diskWrites.fetch_add(1, std::memory_order_relaxed);
+
+    const auto exclusiveShard = _shards[ShardIndex_(key)].LockExclusive();
+    exclusiveShard->insert_or_assign({ key, std::move(entry) });
+}
+//----------------------------------------------------------------------------
+void FVulkanSpirvCache::Clear() {
+    for (auto& shard : _shards)
+        shard.LockExclusive()->clear_ReleaseMemory();
+}
+//----------------------------------------------------------------------------
+auto FVulkanSpirvCache::Statistics() const NOEXCEPT -> FStatistics {
+    FStatistics stats;
+    stats.MemoryHits = _memoryHits.load(std::memory_order_relaxed);
+    stats.DiskHits = _diskHits.load(std::memory_order_relaxed);
+    stats.Misses = _misses.load(std::memory_order_relaxed);
+    stats.StaleEntries = _staleEntries.load(std::memory_order_relaxed);
+    stats.DiskWrites = _diskWrites.load(std::memory_order_relaxed);
+    stats.CompilationTime = FTimespan{ _compilationTimeInMicros.load(std::memory_order_relaxed) / 1000.0 };
+    stats.LookupTime = FTimespan{ _lookupTimeInMicros.load(std::memory_order_relaxed) / 1000.0 };
+    return stats;
+}
+//----------------------------------------------------------------------------
+void FVulkanSpirvCache::ResetStatistics() NOEXCEPT {
+    _memoryHits.store(0, std::memory_order_relaxed);
+    _diskHits.store(0, std::memory_order_relaxed);
+    _misses.store(0, std::memory_order_relaxed);
+    _staleEntries.store(0, std::memory_order_relaxed);
+    _diskWrites.store(0, std::memory_order_relaxed);
+    _compilationTimeInMicros.store(0, std::memory_order_relaxed);
+    _lookupTimeInMicros.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+FShaderDataFingerprint FVulkanSpirvCache::IncludeFingerprint(const FRawMemoryConst& source) NOEXCEPT {
+    return Fingerprint128(source);
+}
+//----------------------------------------------------------------------------
+FFilename FVulkanSpirvCache::EntryFilename_(const FShaderDataFingerprint& key) const {
+    Assert(not _directory.empty());
+
+    wchar_t tmp[40];
+    FWFixedSizeTextWriter oss(tmp);
+
+    Format(oss, L"{0:#2x}", key.lo & 0xFF);
+    FDirpath dirname = _directory;
+    dirname.Concat(FDirname(oss.Written()));
+    oss.Reset();
+
+    Format(oss, L"{0:#16x}-{1:#16x}", key.lo, key.hi);
+    return FFilename(dirname, FBasenameNoExt{ oss.Written() }, FExtname{ MakeStringView(PPE_SPIRVCACHE_EXTNAME) });
+}
+//----------------------------------------------------------------------------
+auto FVulkanSpirvCache::LoadEntry_(const FShaderDataFingerprint& key) const -> PEntry {
+    if (_directory.empty())
+        return PEntry{};
+
+    const FFilename filename = EntryFilename_(key);
+    const FUniqueBuffer content = VFS_ReadAll(filename, EAccessPolicy::Binary | EAccessPolicy::ShareRead);
+    if (not content)
+        return PEntry{};
+
+    FMemoryViewReader reader{ content.MakeView() };
+
+    FFileHeader_ header;
+    if (not reader.ReadPOD(&header) or
+        header.Magic != FILE_MAGIC_ or
+        header.Version != FILE_VERSION_ or
+        header.ReflectionLayout != GReflectionLayout_ or
+        header.Key != key or
+        header.PayloadSizeInBytes != (content.SizeInBytes() - sizeof(FFileHeader_)) )
+        return PEntry{};
+
+    // writes are not atomic: reject truncated or concurrently written files
+    const FRawMemoryConst payload = content.MakeView().CutStartingAt(sizeof(FFileHeader_));
+    if (Fingerprint128(payload) != header.PayloadFingerprint)
+        return PEntry{};
+
+    FMemoryViewReader payloadReader{ payload };
+
+    PEntry entry = NEW_REF(PipelineCompiler, FEntry);
+    if (not entry->Deserialize(payloadReader)) {
+        PPE_LOG(PipelineCompiler, Warning, "ignoring corrupted SPIRV cache entry <{0}>", filename);
+        return PEntry{};
+    }
+
+    return entry;
+}
+//----------------------------------------------------------------------------
+bool FVulkanSpirvCache::SaveEntry_(const FShaderDataFingerprint& key, const FEntry& entry) const {
+    MEMORYSTREAM(PipelineCompiler) payload;
+    entry.Serialize(payload);
+
+    FFileHeader_ header;
+    header.Magic = FILE_MAGIC_;
+    header.Version = FILE_VERSION_;
+    header.ReflectionLayout = GReflectionLayout_;
+    header.Key = key;
+    header.PayloadFingerprint = Fingerprint128(payload.MakeView());
+    header.PayloadSizeInBytes = payload.size();
+
+    MEMORYSTREAM(PipelineCompiler) content;
+    content.reserve(sizeof(header) + payload.size());
+    content.WritePOD(header);
+    content.WriteView(payload.MakeView());
+
+    // concurrent writers of the same entry write the same content, torn files are rejected by LoadEntry_()
+    return VFS_WriteAll(EntryFilename_(key), content.MakeView(), EAccessPolicy::Truncate_Binary);
+}
+//----------------------------------------------------------------------------
+#undef PPE_SPIRVCACHE_EXTNAME
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace RHI
+} //!namespace PPE
@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include "PipelineCompiler_fwd.h"
+
+#include "Vulkan/Pipeline/VulkanPipelineCompiler.h"
+#include "Vulkan/Pipeline/VulkanSpirvCompiler.h"
+
+#include "Container/HashMap.h"
+#include "Container/Vector.h"
+#include "IO/Dirpath.h"
+#include "IO/Filename.h"
+#include "Thread/ThreadSafe.h"
+
+#include <atomic>
+
+namespace PPE {
+namespace RHI {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Content-addressed cache for SPIRV and its reflection, looked up before parsing the shader:
+// - the key hashes the source, entry point, formats, stage, compilation flags, resource limits and compiler version
+// - entries record their include files with a fingerprint, the entry is stale when one of them changed
+// - a sharded memo table serves the entries in memory, the optional directory keeps them between runs
+// All methods are thread-safe, except SetDirectory() which must not race with lookups.
+//----------------------------------------------------------------------------
+class FVulkanSpirvCache : Meta::FNonCopyable {
+public:
+    using FShaderReflection = FVulkanSpirvCompiler::FShaderReflection;
+    using FStatistics = FVulkanSpirvCacheStatistics;
+
+    STATIC_CONST_INTEGRAL(u32, NumShards, 16);
+
+    struct FInclude {
+        FFilename Filename;
+        FShaderDataFingerprint Fingerprint;
+    };
+    using FIncludes = VECTORINSITU(PipelineCompiler, FInclude, 2);
+
+    FVulkanSpirvCache();
+    ~FVulkanSpirvCache();
+
+    const FDirpath& Directory() const { return _directory; }
+    void SetDirectory(const FDirpath& path); // empty to disable persistence
+
+    // outputs private copies: the caller is free to patch the returned layout
+    NODISCARD bool Find(
+        FShaderDataFingerprint* outShaderFingerprint,
+        FRawData* outSpirv,
+        FShaderReflection* outReflection,
+        const FShaderDataFingerprint& key );
+
+    void Add(
+        const FShaderDataFingerprint& key,
+        const FShaderDataFingerprint& shaderFingerprint,
+        const FRawData& spirv,
+        const FShaderReflection& reflection,
+        FIncludes&& includes,
+        FTimespan compilationTime );
+
+    void Clear(); // only releases the memo table
+
+    NODISCARD FStatistics Statistics() const NOEXCEPT;
+    void ResetStatistics() NOEXCEPT;
+
+    NODISCARD static FShaderDataFingerprint IncludeFingerprint(const FRawMemoryConst& source) NOEXCEPT;
+
+private:
+    class FEntry;
+    using PEntry = TRefPtr<FEntry>;
+    using FMemoTable = HASHMAP(PipelineCompiler, FShaderDataFingerprint, PEntry);
+
+    NODISCARD static u32 ShardIndex_(const FShaderDataFingerprint& key) { return static_cast<u32>(key.lo % NumShards); }
+    NODISCARD FFilename EntryFilename_(const FShaderDataFingerprint& key) const;
+
+    NODISCARD PEntry LoadEntry_(const FShaderDataFingerprint& key) const;
+    NODISCARD bool SaveEntry_(const FShaderDataFingerprint& key, const FEntry& entry) const;
+
+    TThreadSafe<FMemoTable, EThreadBarrier::RWLock> _shards[NumShards];
+
+    FDirpath _directory;
+
+    std::atomic<size_t> _memoryHits{ 0 };
+    std::atomic<size_t> _diskHits{ 0 };
+    std::atomic<size_t> _misses{ 0 };
+    std::atomic<size_t> _staleEntries{ 0 };
+    std::atomic<size_t> _diskWrites{ 0 };
+    std::atomic<u64> _compilationTimeInMicros{ 0 };
+    std::atomic<u64> _lookupTimeInMicros{ 0 };
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace RHI
+} //!namespace PPE
@@ -5,6 +5,8 @@
 #include "Vulkan/Instance/VulkanInstance.h"
 #include "Vulkan/Instance/VulkanDevice.h"
 #include "Vulkan/Pipeline/VulkanDebuggableShaderData.h"
+#include "Vulkan/Pipeline/VulkanSpirvCache.h"
+#include "Vulkan/Pipeline/VulkanSpirvOptimizer.h"
 
 #include "RHI/EnumHelpers.h"
 #include "RHI/PipelineCompiler.h"
@@ -20,6 +22,7 @@
 #include "Memory/UniquePtr.h"
 #include "Meta/Functor.h"
 #include "Misc/Guid.h"
+#include "Time/Timepoint.h"
 #include "VirtualFileSystem_fwd.h"
 
 #include "glslang-external.h"
@@ -282,6 +285,27 @@ FVulkanSpirvCompiler::~FVulkanSpirvCompiler() {
     glslang::FinalizeProcess();
 }
 //----------------------------------------------------------------------------
+void FVulkanSpirvCompiler::CopyReflection(FShaderReflection* dst, const FShaderReflection& src) {
+    Assert(dst);
+
+    dst->Layout.DescriptorSets.clear();
+    for (const FPipelineDesc::FDescriptorSet& ds : src.Layout.DescriptorSets) {
+        FPipelineDesc::PUniformMap uniforms;
+        if (ds.Uniforms)
+            uniforms = NEW_REF(RHIPipeline, FPipelineDesc::FUniformMap, *ds.Uniforms);
+
+        dst->Layout.DescriptorSets.Push(ds.Id, ds.BindingIndex, std::move(uniforms));
+    }
+
+    dst->Layout.PushConstants = src.Layout.PushConstants;
+    dst->Specializations = src.Specializations;
+    dst->Vertex = src.Vertex;
+    dst->Tesselation = src.Tesselation;
+    dst->Fragment = src.Fragment;
+    dst->Compute = src.Compute;
+    dst->Mesh = src.Mesh;
+}
+//----------------------------------------------------------------------------
 void FVulkanSpirvCompiler::SetCompilationFlags(EShaderCompilationFlags flags) {
     _compilationFlags = flags;
 }
@@ -354,8 +378,21 @@ bool FVulkanSpirvCompiler::Compile(
     const FShaderDataFingerprint sourceFingerprint = Fingerprint128(sourceData,
         Fingerprint128(entry.MakeView(), _glslangFingerprint));
 
+    // lookup before parsing, the includes are validated by the cache
+    const FShaderDataFingerprint cacheKey = SpirvCacheKey_(
+        sourceFingerprint, compilationContext.CurrentStage,
+        srcShaderFormat, dstShaderFormat );
+
+    FShaderDataFingerprint cachedFingerprint;
+    FRawData cachedSpirv;
+    if (_spirvCache and _spirvCache->Find(&cachedFingerprint, &cachedSpirv, outReflection, cacheKey)) {
+        outShader->Specializations = outReflection->Specializations;
+        outShader->AddShader(dstShaderFormat, entry, std::move(cachedSpirv), cachedFingerprint ARGS_IF_RHIDEBUG(sourceFile));
+    }
     // compiler shader without debug info
-    {
+    else {
+        const FTimepoint startedAt = FTimepoint::Now();
+
         FGLSLangResult glslang;
         FIncludeResolver resolver{ _directories };
 
@@ -383,10 +420,9 @@ bool FVulkanSpirvCompiler::Compile(
         for (const auto& process : glslang.Shader->getIntermediate()->getProcesses())
             shaderFingerprint = Fingerprint128(process.data(), process.size() * sizeof(*process.data()), shaderFingerprint);
 
-        // #TODO: caching with shaderFingerprint?
-
         FRawData spirv;
         PPE_LOG_CHECK(PipelineCompiler, CompileSPIRV_(&spirv, compilationContext));
+        PPE_LOG_CHECK(PipelineCompiler, OptimizeSPIRV_(&spirv, compilationContext));
         PPE_LOG_CHECK(PipelineCompiler, BuildReflection_(compilationContext));
 
         if (_compilationFlags & EShaderCompilationFlags::ParseAnnotations) {
@@ -396,6 +432,16 @@ bool FVulkanSpirvCompiler::Compile(
                 PPE_LOG_CHECK(PipelineCompiler, ParseAnnotations_(compilationContext, file->Source(), file->headerName.c_str()));
         }
 
+        if (_spirvCache) {
+            FVulkanSpirvCache::FIncludes includes;
+            includes.reserve(resolver.IncludedFiles().size());
+            for (const auto& it : resolver.IncludedFiles())
+                includes.push_back({ it.first, FVulkanSpirvCache::IncludeFingerprint(it.second->RawData.MakeView()) });
+
+            _spirvCache->Add(cacheKey, shaderFingerprint, spirv, *outReflection,
+                std::move(includes), FTimepoint::ElapsedSince(startedAt) );
+        }
+
         outShader->Specializations = outReflection->Specializations;
         outShader->AddShader(dstShaderFormat, entry, std::move(spirv), shaderFingerprint ARGS_IF_RHIDEBUG(sourceFile));
     }
@@ -547,22 +593,18 @@ bool FVulkanSpirvCompiler::ParseGLSL_(
         case 100:
             clientVersion = EShTargetVulkan_1_0;
             targetVersion = EShTargetSpv_1_0;
-            ctx.SpirvTargetEnvironment = SPV_ENV_VULKAN_1_0;
             break;
         case 110:
             clientVersion = EShTargetVulkan_1_1;
             targetVersion = EShTargetSpv_1_3;
-            ctx.SpirvTargetEnvironment = SPV_ENV_VULKAN_1_1;
             break;
         case 120:
             clientVersion = EShTargetVulkan_1_2;
             targetVersion = EShTargetSpv_1_4;
-            ctx.SpirvTargetEnvironment = SPV_ENV_VULKAN_1_1_SPIRV_1_4;
             break;
         case 130:
             clientVersion = EShTargetVulkan_1_3;
             targetVersion = EShTargetSpv_1_6;
-            ctx.SpirvTargetEnvironment = SPV_ENV_VULKAN_1_3;
             break;
         default:
             ctx.Log->Invoke(ELoggerVerbosity::Error, ctx.SourceFile, 0, "unsupported vulkan version"_view, {
@@ -576,7 +618,6 @@ bool FVulkanSpirvCompiler::ParseGLSL_(
         if (Meta::EnumAnd(dstShaderFormat, EShaderLangFormat::_FormatMask) == EShaderLangFormat::SPIRV) {
             target = EShTargetSpv;
             targetVersion = EShTargetSpv_1_0;
-            ctx.SpirvTargetEnvironment = SPV_ENV_OPENGL_4_5;
         }
         break;
     }
@@ -587,6 +628,10 @@ bool FVulkanSpirvCompiler::ParseGLSL_(
         return false;
     }
 
+    // same mapping than the optimizer, OptimizeSPIRV_() uses the target environment of the context
+    if (EShTargetSpv == target)
+        ctx.SpirvTargetEnvironment = static_cast<spv_target_env>(FVulkanSpirvOptimizer::TargetEnvironment(dstShaderFormat));
+
     Assert(shSource < EShSourceCount);
 
     EShMessages messages = EShMsgDefault;
@@ -622,65 +667,6 @@ bool FVulkanSpirvCompiler::ParseGLSL_(
     return true;
 }
 //----------------------------------------------------------------------------
-#if defined(INCLUDE_SPIRV_TOOLS_OPTIMIZER_HPP_)
-NODISCARD static bool OptimizeSPIRV_(
-    FWStringBuilder& log,
-    std::vector<unsigned>& spirv,
-    spv_target_env targetEnv ) {
-
-    spvtools::Optimizer optimizer{ targetEnv };
-    optimizer.RegisterLegalizationPasses();
-    optimizer.RegisterSizePasses();
-    optimizer.RegisterPerformancePasses();
-
-    optimizer.RegisterPass(spvtools::CreateCompactIdsPass());
-    optimizer.RegisterPass(spvtools::CreateDeadBranchElimPass());
-    optimizer.RegisterPass(spvtools::CreateLocalAccessChainConvertPass());
-    optimizer.RegisterPass(spvtools::CreateAggressiveDCEPass());
-    optimizer.RegisterPass(spvtools::CreateRemoveDuplicatesPass());
-    optimizer.RegisterPass(spvtools::CreateCFGCleanupPass());
-
-    optimizer.SetMessageConsumer(
-        [&log](spv_message_level_t level, const char* source, const spv_position_t& position, const char* message) {
-            switch (level) {
-            case SPV_MSG_FATAL:
-                log << "fatal: ";
-                break;
-            case SPV_MSG_INTERNAL_ERROR:
-                log << "internal error: ";
-                break;
-            case SPV_MSG_ERROR:
-                log << "error: ";
-                break;
-            case SPV_MSG_WARNING:
-                log << "warning: ";
-                break;
-            case SPV_MSG_INFO:
-                log << "info: ";
-                break;
-            case SPV_MSG_DEBUG:
-                log << "debug: ";
-                break;
-            }
-
-            if (source)
-                log << MakeCStringView(source) << ':';
-
-            log << position.line << ':' << position.column << ':' << position.index << ':';
-
-            if (message)
-                log << ' ' << MakeCStringView(message);
-        });
-
-    spvtools::OptimizerOptions options{};
-    options.set_run_validator(false);
-
-    optimizer.Run(spirv.data(), spirv.size(), &spirv, options);
-
-    return true;
-}
-#endif
-//----------------------------------------------------------------------------
 bool FVulkanSpirvCompiler::CompileSPIRV_(FRawData* outSPIRV, const FCompilationContext& ctx) const {
     Assert(outSPIRV);
     Assert(ctx.Log);
@@ -722,15 +708,60 @@ bool FVulkanSpirvCompiler::CompileSPIRV_(FRawData* outSPIRV, const FCompilationC
         ctx.Log->Invoke(verbosity, ctx.SourceFile, 0, messageLine, {});
     }
 
-#ifdef INCLUDE_SPIRV_TOOLS_OPTIMIZER_HPP_
-    if (_compilationFlags & EShaderCompilationFlags::StrongOptimization)
-        PPE_LOG_CHECK(PipelineCompiler, OptimizeSPIRV_(*ctx.Log, spirvTmp, ctx.SpirvTargetEnvironment));
-#endif
-
     *outSPIRV = FRawData{ MakeView(spirvTmp).Cast<const u8>() };
     return true;
 }
 //----------------------------------------------------------------------------
+bool FVulkanSpirvCompiler::OptimizeSPIRV_(FRawData* inoutSPIRV, const FCompilationContext& ctx) const {
+    Assert(inoutSPIRV);
+    Assert(ctx.Log);
+
+    FVulkanSpirvOptimizerOptions options;
+    options.Recipe = ESpirvOptimization::None;
+    options.FoldConstants = options.EliminateDeadCode = false;
+
+    if (_compilationFlags & EShaderCompilationFlags::StrongOptimization) {
+        options.Recipe = (_compilationFlags & EShaderCompilationFlags::OptimizeSize
+            ? ESpirvOptimization::Size
+            : ESpirvOptimization::Performance );
+        options.FoldConstants = options.EliminateDeadCode = true;
+    }
+
+    if (_compilationFlags & EShaderCompilationFlags::StripDebugInfo)
+        options.StripDebugInfo = options.StripReflection = true;
+
+    if (options.Recipe == ESpirvOptimization::None and not options.StripDebugInfo)
+        return true;
+
+    options.Validate = (_compilationFlags & EShaderCompilationFlags::Validate);
+
+    Assert_NoAssume(SPV_ENV_MAX != ctx.SpirvTargetEnvironment);
+
+    return FVulkanSpirvOptimizer{ options }.Optimize(inoutSPIRV, static_cast<u32>(ctx.SpirvTargetEnvironment), *ctx.Log, ctx.SourceFile);
+}
+//----------------------------------------------------------------------------
+FShaderDataFingerprint FVulkanSpirvCompiler::SpirvCacheKey_(
+    const FShaderDataFingerprint& sourceFingerprint,
+    EShaderStages stage,
+    EShaderLangFormat srcShaderFormat,
+    EShaderLangFormat dstShaderFormat ) const {
+    FShaderDataFingerprint key = MakeShaderFingerprint_(
+        sourceFingerprint,
+        EDebugFlags::Unknown,
+        srcShaderFormat,
+        dstShaderFormat,
+        stage,
+        _compilationFlags,
+        _builtInResources,
+        _features );
+
+    // the same include can resolve to another file when the directories change
+    for (const FDirpath& path : _directories)
+        key = Fingerprint128(path.ToWString().MakeView(), key);
+
+    return key;
+}
+//----------------------------------------------------------------------------
 void FVulkanSpirvCompiler::OnCompilationFailed_(
     const FCompilationContext& ctx,
     const FConstChar compilerLog,
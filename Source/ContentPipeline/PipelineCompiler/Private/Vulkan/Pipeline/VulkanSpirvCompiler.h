@@ -22,6 +22,7 @@
 
 namespace PPE {
 namespace RHI {
+class FVulkanSpirvCache;
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
@@ -81,6 +82,9 @@ public:
         }   Mesh;
     };
 
+    // deep copy: the uniform maps are patched in place when merging pipelines
+    static void CopyReflection(FShaderReflection* dst, const FShaderReflection& src);
+
     using FDirectories = VECTORINSITU(PipelineCompiler, FDirpath, 3);
 
     explicit FVulkanSpirvCompiler(const FDirectories& directories);
@@ -97,6 +101,9 @@ public:
     void SetDefaultResourceLimits();
     void SetCurrentResourceLimits(const FVulkanDevice& device);
 
+    // shaders without debug modes are looked up there before being parsed (thread-safe)
+    void SetSpirvCache(FVulkanSpirvCache* cache) { _spirvCache = cache; }
+
 #if USE_PPE_RHIDEBUG
     void SetShaderDebugFlags(EShaderLangFormat flags);
 #endif
@@ -130,6 +137,13 @@ private:
         FIncludeResolver& resolver ) const;
 
     NODISCARD bool CompileSPIRV_(FRawData* outSPIRV, const FCompilationContext& ctx) const;
+    NODISCARD bool OptimizeSPIRV_(FRawData* inoutSPIRV, const FCompilationContext& ctx) const;
+
+    NODISCARD FShaderDataFingerprint SpirvCacheKey_(
+        const FShaderDataFingerprint& sourceFingerprint,
+        EShaderStages stage,
+        EShaderLangFormat srcShaderFormat,
+        EShaderLangFormat dstShaderFormat ) const;
 
     NODISCARD bool BuildReflection_(FCompilationContext& ctx) const;
     NODISCARD bool ParseAnnotations_(const FCompilationContext& ctx, FStringView content, FConstChar sourceFile) const;
@@ -166,6 +180,7 @@ private: // GLSL deserializer
 
 private:
     const FDirectories& _directories;
+    FVulkanSpirvCache* _spirvCache{ nullptr };
     TBuiltInResource _builtInResources{};
     FShaderDataFingerprint _glslangFingerprint;
 
@@ -0,0 +1,443 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Vulkan/Pipeline/VulkanSpirvOptimizer.h"
+
+#include "RHI/EnumHelpers.h"
+
+#include "Diagnostic/Logger.h"
+#include "IO/Format.h"
+#include "IO/FormatHelpers.h"
+#include "IO/TextWriter.h"
+#include "Memory/HashFunctions.h"
+
+#include "spirv-tools-external.h"
+
+namespace PPE {
+namespace RHI {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// https://registry.khronos.org/SPIR-V/specs/unified1/SPIRV.html
+CONSTEXPR u32 SpirvMagic_ = 0x07230203;
+CONSTEXPR u32 SpirvHeaderWords_ = 5;
+enum ESpirvOp_ : u16 {
+    OpSourceContinued_ = 2,
+    OpSource_ = 3,
+    OpSourceExtension_ = 4,
+    OpName_ = 5,
+    OpMemberName_ = 6,
+    OpString_ = 7,
+    OpLine_ = 8,
+    OpConstantTrue_ = 41,
+    OpConstantFalse_ = 42,
+    OpConstant_ = 43,
+    OpConstantComposite_ = 44,
+    OpConstantNull_ = 46,
+    OpSpecConstantTrue_ = 48,
+    OpSpecConstantFalse_ = 49,
+    OpSpecConstant_ = 50,
+    OpSpecConstantComposite_ = 51,
+    OpSpecConstantOp_ = 52,
+    OpFunction_ = 54,
+    OpDecorate_ = 71,
+    OpMemberDecorate_ = 72,
+    OpDecorationGroup_ = 73,
+    OpNoLine_ = 317,
+    OpModuleProcessed_ = 330,
+    OpDecorateId_ = 332,
+    OpDecorateString_ = 5632,
+    OpMemberDecorateString_ = 5633,
+};
+CONSTEXPR u32 DecorationSpecId_ = 1;
+//----------------------------------------------------------------------------
+NODISCARD static u16 SpirvOpCode_(u32 word) { return static_cast<u16>(word & 0xFFFF); }
+NODISCARD static u32 SpirvWordCount_(u32 word) { return (word >> 16); }
+//----------------------------------------------------------------------------
+// iterates the instructions after the header, fails if the stream is truncated
+template <typename _Each>
+NODISCARD static bool ForeachSpirvInstruction_(const TMemoryView<const u32>& words, _Each&& each) {
+    if (words.size() < SpirvHeaderWords_ or words[0] != SpirvMagic_)
+        return false;
+
+    for (size_t i = SpirvHeaderWords_; i < words.size(); ) {
+        const u32 wordCount = SpirvWordCount_(words[i]);
+        if (0 == wordCount or i + wordCount > words.size())
+            return false;
+
+        each(words.SubRange(i, wordCount));
+        i += wordCount;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+// specialization constants are rewritten as regular constants, their SpecId decoration is removed,
+// 64 bits constants can't be frozen with a 32 bits value and stay specializable
+NODISCARD static bool FreezeSpecializations_(
+    std::vector<u32>* outSpirv,
+    const TMemoryView<const u32>& spirv,
+    const FVulkanSpirvOptimizerOptions::FFrozenSpecializations& frozen ) {
+    Assert(outSpirv);
+
+    // first pass: result id -> constant_id, annotations are always declared before the constants
+    TFixedSizeFlatMap<u32, u32, MaxSpecializationConstants> specIds;
+    PPE_LOG_CHECK(PipelineCompiler, ForeachSpirvInstruction_(spirv, [&](const TMemoryView<const u32>& inst) {
+        const u16 op = SpirvOpCode_(inst[0]);
+        if (op == OpDecorate_ and inst.size() == 4 and inst[2] == DecorationSpecId_ and frozen.Contains(inst[3]))
+            specIds.Emplace_Overwrite(inst[1], inst[3]);
+        else if (op == OpSpecConstant_ and inst.size() > 4)
+            specIds.Erase(inst[2]); // 64 bits constant: keep the SpecId decoration
+    }));
+
+    outSpirv->clear();
+    outSpirv->reserve(spirv.size());
+    outSpirv->insert(outSpirv->end(), spirv.begin(), spirv.begin() + SpirvHeaderWords_);
+
+    return ForeachSpirvInstruction_(spirv, [&](const TMemoryView<const u32>& inst) {
+        const u16 op = SpirvOpCode_(inst[0]);
+
+        if (op == OpDecorate_ and inst.size() == 4 and inst[2] == DecorationSpecId_ and specIds.Contains(inst[1]))
+            return; // strip the decoration, this constant can't be specialized anymore
+
+        const size_t first = outSpirv->size();
+        outSpirv->insert(outSpirv->end(), inst.begin(), inst.end());
+
+        if (inst.size() < 3)
+            return;
+
+        u32 constantId;
+        if (not specIds.TryGet(inst[2], &constantId))
+            return;
+
+        const u32 value = frozen.Get(constantId);
+        switch (op) {
+        case OpSpecConstantTrue_:
+        case OpSpecConstantFalse_:
+            (*outSpirv)[first] = ((inst[0] & 0xFFFF0000u) | (value ? OpConstantTrue_ : OpConstantFalse_));
+            break;
+        case OpSpecConstant_:
+            (*outSpirv)[first] = ((inst[0] & 0xFFFF0000u) | OpConstant_);
+            Assert_NoAssume(inst.size() == 4);
+            (*outSpirv)[first + 3] = value;
+            break;
+        default: break; // OpSpecConstantComposite/Op are folded by the optimizer
+        }
+    });
+}
+//----------------------------------------------------------------------------
+#if defined(INCLUDE_SPIRV_TOOLS_OPTIMIZER_HPP_)
+NODISCARD static ELoggerVerbosity SpirvMessageVerbosity_(spv_message_level_t level) {
+    switch (level) {
+    case SPV_MSG_FATAL:
+    case SPV_MSG_INTERNAL_ERROR:
+    case SPV_MSG_ERROR:
+        return ELoggerVerbosity::Error;
+    case SPV_MSG_WARNING:
+        return ELoggerVerbosity::Warning;
+    case SPV_MSG_INFO:
+        return ELoggerVerbosity::Info;
+    case SPV_MSG_DEBUG:
+        return ELoggerVerbosity::Debug;
+    }
+    return ELoggerVerbosity::Error;
+}
+#endif
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+bool FVulkanSpirvOptimizerOptions::Freeze(
+    const FPipelineDesc::FSpecializationConstants& specializations,
+    const FSpecializationID& id, u32 value ) {
+    u32 constantId;
+    if (not specializations.TryGet(id, &constantId))
+        return false;
+
+    FrozenSpecializations.Emplace_Overwrite(constantId, value);
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FVulkanSpirvStatistics& FVulkanSpirvStatistics::operator +=(const FVulkanSpirvStatistics& other) {
+    SizeInBytes += other.SizeInBytes;
+    IdBound += other.IdBound;
+    NumInstructions += other.NumInstructions;
+    NumDebugInstructions += other.NumDebugInstructions;
+    NumDecorations += other.NumDecorations;
+    NumFunctions += other.NumFunctions;
+    NumConstants += other.NumConstants;
+    NumSpecConstants += other.NumSpecConstants;
+    return (*this);
+}
+//----------------------------------------------------------------------------
+bool FVulkanSpirvStatistics::Parse(FVulkanSpirvStatistics* outStatistics, const FRawMemoryConst& spirv) {
+    Assert(outStatistics);
+    PPE_LOG_CHECK(PipelineCompiler, Meta::IsAlignedPow2(sizeof(u32), spirv.SizeInBytes()));
+
+    const TMemoryView<const u32> words = spirv.Cast<const u32>();
+
+    FVulkanSpirvStatistics stats;
+    stats.SizeInBytes = checked_cast<u32>(spirv.SizeInBytes());
+    stats.IdBound = (words.size() > 3 ? words[3] : 0);
+
+    PPE_LOG_CHECK(PipelineCompiler, ForeachSpirvInstruction_(words, [&stats](const TMemoryView<const u32>& inst) {
+        stats.NumInstructions++;
+
+        switch (SpirvOpCode_(inst[0])) {
+        case OpSourceContinued_:
+        case OpSource_:
+        case OpSourceExtension_:
+        case OpName_:
+        case OpMemberName_:
+        case OpString_:
+        case OpLine_:
+        case OpNoLine_:
+        case OpModuleProcessed_:
+            stats.NumDebugInstructions++;
+            break;
+        case OpDecorate_:
+        case OpMemberDecorate_:
+        case OpDecorationGroup_:
+        case OpDecorateId_:
+        case OpDecorateString_:
+        case OpMemberDecorateString_:
+            stats.NumDecorations++;
+            break;
+        case OpFunction_:
+            stats.NumFunctions++;
+            break;
+        case OpConstantTrue_:
+        case OpConstantFalse_:
+        case OpConstant_:
+        case OpConstantComposite_:
+        case OpConstantNull_:
+            stats.NumConstants++;
+            break;
+        case OpSpecConstantTrue_:
+        case OpSpecConstantFalse_:
+        case OpSpecConstant_:
+        case OpSpecConstantComposite_:
+        case OpSpecConstantOp_:
+            stats.NumSpecConstants++;
+            break;
+        default: break;
+        }
+    }));
+
+    *outStatistics = stats;
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FVulkanSpirvOptimizer::FVulkanSpirvOptimizer(const FVulkanSpirvOptimizerOptions& options) NOEXCEPT
+:   _options(options)
+{}
+//----------------------------------------------------------------------------
+u32 FVulkanSpirvOptimizer::TargetEnvironment(EShaderLangFormat spirvFormat) NOEXCEPT {
+    if (Meta::EnumAnd(spirvFormat, EShaderLangFormat::_ApiMask) == EShaderLangFormat::OpenGL)
+        return SPV_ENV_OPENGL_4_5;
+
+    switch (EShaderLangFormat_Version(spirvFormat)) {
+    case 100: return SPV_ENV_VULKAN_1_0;
+    case 110: return SPV_ENV_VULKAN_1_1;
+    case 120: return SPV_ENV_VULKAN_1_1_SPIRV_1_4;
+    case 130: return SPV_ENV_VULKAN_1_3;
+    default: return SPV_ENV_UNIVERSAL_1_0;
+    }
+}
+//----------------------------------------------------------------------------
+bool FVulkanSpirvOptimizer::Optimize(
+    FRawData* spirv,
+    u32 targetEnvironment,
+    const FLogger& logger,
+    FConstChar sourceFile ) const {
+    Assert(spirv);
+    PPE_LOG_CHECK(PipelineCompiler, Meta::IsAlignedPow2(sizeof(u32), spirv->SizeInBytes()));
+
+    std::vector<u32> words;
+
+    if (not _options.FrozenSpecializations.empty()) {
+        if (not FreezeSpecializations_(&words, spirv->MakeConstView().Cast<const u32>(), _options.FrozenSpecializations)) {
+            logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to freeze specialization constants, invalid SPIRV!"_view, {});
+            return false;
+        }
+    }
+    else {
+        const TMemoryView<const u32> src = spirv->MakeConstView().Cast<const u32>();
+        words.assign(src.begin(), src.end());
+    }
+
+#if defined(INCLUDE_SPIRV_TOOLS_OPTIMIZER_HPP_)
+    // spvtools::Optimizer isn't reentrant: use a new instance for each call
+    spvtools::Optimizer optimizer{ static_cast<spv_target_env>(targetEnvironment) };
+
+    optimizer.SetMessageConsumer(
+        [&logger, sourceFile](spv_message_level_t level, const char* , const spv_position_t& position, const char* message) {
+            logger(SpirvMessageVerbosity_(level), sourceFile, checked_cast<u32>(position.line),
+                MakeCStringView(message ? message : "@unknown"), {
+                    {"Column", checked_cast<u64>(position.column)},
+                    {"Index", checked_cast<u64>(position.index)}
+                });
+        });
+
+    if (not _options.FrozenSpecializations.empty())
+        optimizer.RegisterPass(spvtools::CreateFoldSpecConstantOpAndCompositePass());
+
+    switch (_options.Recipe) {
+    case ESpirvOptimization::None: break;
+    case ESpirvOptimization::Performance:
+        optimizer.RegisterPerformancePasses();
+        break;
+    case ESpirvOptimization::Size:
+        optimizer.RegisterSizePasses();
+        break;
+    }
+
+    if (_options.FoldConstants) {
+        optimizer.RegisterPass(spvtools::CreateFoldSpecConstantOpAndCompositePass());
+        optimizer.RegisterPass(spvtools::CreateCCPPass());
+        optimizer.RegisterPass(spvtools::CreateUnifyConstantPass());
+    }
+
+    if (_options.EliminateDeadCode) {
+        optimizer.RegisterPass(spvtools::CreateDeadBranchElimPass());
+        optimizer.RegisterPass(spvtools::CreateAggressiveDCEPass());
+        optimizer.RegisterPass(spvtools::CreateEliminateDeadFunctionsPass());
+        optimizer.RegisterPass(spvtools::CreateEliminateDeadConstantPass());
+        optimizer.RegisterPass(spvtools::CreateCFGCleanupPass());
+    }
+
+    if (_options.StripDebugInfo)
+        optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
+    if (_options.StripReflection)
+        optimizer.RegisterPass(spvtools::CreateStripNonSemanticInfoPass());
+
+    optimizer.RegisterPass(spvtools::CreateRemoveDuplicatesPass());
+    optimizer.RegisterPass(spvtools::CreateCompactIdsPass());
+
+    spvtools::OptimizerOptions options{};
+    options.set_run_validator(_options.Validate);
+
+    std::vector<u32> optimized;
+    if (not optimizer.Run(words.data(), words.size(), &optimized, options)) {
+        logger(ELoggerVerbosity::Error, sourceFile, 0, "failed to optimize SPIRV!"_view, {
+            {"Recipe", Meta::EnumOrd(_options.Recipe)}
+        });
+        return false;
+    }
+
+    words = std::move(optimized);
+
+#else
+    Unused(targetEnvironment);
+
+    if (_options.Recipe != ESpirvOptimization::None or
+        _options.FoldConstants or _options.EliminateDeadCode or
+        _options.StripDebugInfo or _options.StripReflection ) {
+        logger(ELoggerVerbosity::Warning, sourceFile, 0, "spirv-tools optimizer is not available, only frozen specializations were applied"_view, {});
+    }
+
+#endif
+
+    *spirv = FRawData{ MakeView(words).Cast<const u8>() };
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FVulkanSpirvOptimizationReport::FVulkanSpirvOptimizationReport(const FVulkanSpirvOptimizer& optimizer) NOEXCEPT
+:   _optimizer(optimizer)
+{}
+//----------------------------------------------------------------------------
+auto FVulkanSpirvOptimizationReport::Total() const -> FEntry {
+    FEntry total;
+    total.Name = "Total";
+
+    for (const FEntry& it : _entries) {
+        total.Before += it.Before;
+        total.After += it.After;
+        total.Duration += it.Duration;
+    }
+
+    return total;
+}
+//----------------------------------------------------------------------------
+bool FVulkanSpirvOptimizationReport::Optimize(FStringView name, FPipelineDesc::FShader* shader, const FLogger& logger) {
+    Assert(shader);
+
+    // iterates a copy: AddShader() overwrites the entries of the map
+    const FPipelineDesc::FShaderDataMap data{ shader->Data };
+
+    for (const auto& it : data) {
+        if (Meta::EnumAnd(it.first, EShaderLangFormat::_StorageFormatMask) != EShaderLangFormat::SPIRV or
+            Meta::EnumAnd(it.first, EShaderLangFormat::_DebugModeMask) != EShaderLangFormat::Unknown)
+            continue; // debuggable shaders keep their instrumentation untouched
+
+        const PShaderBinaryData* const pBinary = std::get_if<PShaderBinaryData>(&it.second);
+        if (nullptr == pBinary or not *pBinary)
+            continue;
+
+        FRawData spirv{ (*pBinary)->Data()->MakeConstView() };
+        if (not Optimize(name, &spirv, it.first, logger))
+            return false;
+
+        const FShaderDataFingerprint fingerprint = Fingerprint128(spirv.MakeConstView());
+
+        shader->AddShader(it.first, (*pBinary)->EntryPoint(), std::move(spirv), fingerprint ARGS_IF_RHIDEBUG((*pBinary)->DebugName()));
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FVulkanSpirvOptimizationReport::Optimize(FStringView name, FRawData* spirv, EShaderLangFormat spirvFormat, const FLogger& logger) {
+    Assert(spirv);
+
+    FEntry entry;
+    entry.Name = name;
+
+    PPE_LOG_CHECK(PipelineCompiler, FVulkanSpirvStatistics::Parse(&entry.Before, spirv->MakeConstView()));
+
+    const FTimepoint startedAt = FTimepoint::Now();
+    if (not _optimizer.Optimize(spirv, spirvFormat, logger))
+        return false;
+    entry.Duration = FTimepoint::ElapsedSince(startedAt);
+
+    PPE_LOG_CHECK(PipelineCompiler, FVulkanSpirvStatistics::Parse(&entry.After, spirv->MakeConstView()));
+
+    _entries.push_back(std::move(entry));
+    return true;
+}
+//----------------------------------------------------------------------------
+void FVulkanSpirvOptimizationReport::Dump(FTextWriter& oss) const {
+    const auto dumpRow = [&oss](const FEntry& it) {
+        Format(oss, " {0:-40} | {1:8} -> {2:8} {3:6f1}% | {4:6} -> {5:6} {6:6f1}% | {7:5} -> {8:5} | {9:5} -> {10:5} | {11:8f3}",
+            it.Name,
+            Fmt::SizeInBytes(it.Before.SizeInBytes), Fmt::SizeInBytes(it.After.SizeInBytes),
+            (it.Before.SizeInBytes ? it.After.SizeInBytes * 100.f / it.Before.SizeInBytes : 0.f),
+            it.Before.NumInstructions, it.After.NumInstructions,
+            (it.Before.NumInstructions ? it.After.NumInstructions * 100.f / it.Before.NumInstructions : 0.f),
+            it.Before.NumDebugInstructions, it.After.NumDebugInstructions,
+            it.Before.NumSpecConstants, it.After.NumSpecConstants,
+            Fmt::DurationInMs(it.Duration) )
+            << Eol;
+    };
+
+    Format(oss, " {0:-40} | {1:-27} | {2:-25} | {3:-14} | {4:-14} | {5}",
+        "Shader", "Bytes", "Instructions", "Debug", "SpecConstants", "Time")
+        << Eol;
+
+    for (const FEntry& it : _entries)
+        dumpRow(it);
+
+    dumpRow(Total());
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace RHI
+} //!namespace PPE
@@ -11,14 +11,30 @@
 #include "Container/HashHelpers.h"
 #include "Container/Vector.h"
 #include "IO/Dirpath.h"
+#include "Thread/ThreadSafe.h"
+#include "Time/Timepoint.h"
 
 namespace PPE {
 namespace RHI {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+class FVulkanSpirvCache;
 class FVulkanSpirvCompiler;
 //----------------------------------------------------------------------------
+struct FVulkanSpirvCacheStatistics {
+    size_t MemoryHits{ 0 };
+    size_t DiskHits{ 0 };
+    size_t Misses{ 0 };
+    size_t StaleEntries{ 0 }; // an include changed since the entry was compiled
+    size_t DiskWrites{ 0 };
+    FTimespan CompilationTime{ 0 }; // cold: spent compiling the misses
+    FTimespan LookupTime{ 0 }; // warm: spent serving the hits, disk reads included
+
+    size_t NumLookups() const { return (MemoryHits + DiskHits + Misses); }
+    float HitRate() const { return (NumLookups() ? static_cast<float>(MemoryHits + DiskHits) / NumLookups() : 0.f); }
+};
+//----------------------------------------------------------------------------
 class PPE_PIPELINECOMPILER_API FVulkanPipelineCompiler final : public IPipelineCompiler {
 public:
     using FShaderDataMap = FPipelineDesc::FShaderDataMap;
@@ -39,6 +55,14 @@ public:
     void ReleaseShaderCache();
     void ReleaseUnusedShaders();
 
+    // compiled SPIRV is memoized by content, and persisted in this directory when not empty
+    NODISCARD FDirpath SpirvCacheDirectory() const;
+    void SetSpirvCacheDirectory(const FDirpath& path);
+    void ReleaseSpirvCache();
+
+    NODISCARD FVulkanSpirvCacheStatistics SpirvCacheStatistics() const NOEXCEPT;
+    void ResetSpirvCacheStatistics() NOEXCEPT;
+
 public: // IPipelineCompiler
     FStringLiteral DisplayName() const NOEXCEPT override { return "VulkanPipelineCompiler"; }
     const FLogger& DefaultLogger() const NOEXCEPT override { return _defaultLogger; }
@@ -54,7 +78,11 @@ public: // IPipelineCompiler
     bool Compile(FGraphicsPipelineDesc& desc, EShaderLangFormat fmt, const FLogger& logger) override;
     bool Compile(FComputePipelineDesc& desc, EShaderLangFormat fmt, const FLogger& logger) override;
 
-    void ReleaseUnusedMemory() override { ReleaseUnusedShaders(); }
+    bool CompileBatch(const TMemoryView<FMeshPipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) override;
+    bool CompileBatch(const TMemoryView<FGraphicsPipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) override;
+    bool CompileBatch(const TMemoryView<FComputePipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) override;
+
+    void ReleaseUnusedMemory() override { ReleaseUnusedShaders(); ReleaseSpirvCache(); }
 
 private:
     struct FShaderBinaryDataTraits {
@@ -72,9 +100,9 @@ private:
         FShaderBinaryMemoizedData,
         PVulkanDebuggableShaderModule);
 
+    // compilation only needs a shared lock: FVulkanSpirvCompiler::Compile() is reentrant
     struct FInternalData {
         VECTORINSITU(PipelineCompiler, FDirpath, 3) Directories;
-        FShaderCompiledModuleCache ShaderCache;
         FLogger DefaultLogger;
         TUniquePtr<FVulkanSpirvCompiler> SpirvCompiler;
         EShaderCompilationFlags CompilationFlags{ Default };
@@ -82,12 +110,19 @@ private:
 
     NODISCARD bool CreateVulkanShader_(
         FPipelineDesc::FShader* shader,
-        FShaderCompiledModuleCache& shaderCache,
-        const FLogger& logger ) const;
+        const FLogger& logger );
+
+    template <typename _PipelineDesc>
+    NODISCARD bool CompileBatch_(
+        const TMemoryView<_PipelineDesc>& descs,
+        EShaderLangFormat fmt,
+        const FLogger& logger );
 
     const TPtrRef<const FVulkanDevice> _device;
 
-    TThreadSafe<FInternalData, EThreadBarrier::CriticalSection> _data;
+    TThreadSafe<FInternalData, EThreadBarrier::RWLock> _data;
+    TThreadSafe<FShaderCompiledModuleCache, EThreadBarrier::CriticalSection> _shaderCache;
+    const TUniquePtr<FVulkanSpirvCache> _spirvCache;
 
     const FLogger _defaultLogger;
 };
@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include "PipelineCompiler_fwd.h"
+
+#include "RHI/PipelineCompiler.h"
+#include "RHI/PipelineDesc.h"
+
+#include "Container/FlatMap.h"
+#include "Container/Vector.h"
+#include "IO/String.h"
+#include "Time/Timepoint.h"
+
+namespace PPE {
+namespace RHI {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+enum class ESpirvOptimization : u8 {
+    None = 0,
+    Performance,
+    Size,
+};
+//----------------------------------------------------------------------------
+struct FVulkanSpirvOptimizerOptions {
+    // constant_id -> value, frozen constants are replaced by regular constants and folded (64 bits constants are left specializable)
+    using FFrozenSpecializations = TFixedSizeFlatMap<u32, u32, MaxSpecializationConstants>;
+
+    ESpirvOptimization Recipe{ ESpirvOptimization::Performance };
+    bool FoldConstants{ true };
+    bool EliminateDeadCode{ true };
+    bool StripDebugInfo{ false }; // names, lines and sources: for shipping
+    bool StripReflection{ false }; // non-semantic instructions and reflection decorations: for shipping
+    bool Validate{ false };
+
+    FFrozenSpecializations FrozenSpecializations;
+
+    // uses the reflected specializations to retrieve the constant_id
+    PPE_PIPELINECOMPILER_API bool Freeze(
+        const FPipelineDesc::FSpecializationConstants& specializations,
+        const FSpecializationID& id, u32 value );
+};
+//----------------------------------------------------------------------------
+struct FVulkanSpirvStatistics {
+    u32 SizeInBytes{ 0 };
+    u32 IdBound{ 0 };
+    u32 NumInstructions{ 0 };
+    u32 NumDebugInstructions{ 0 };
+    u32 NumDecorations{ 0 };
+    u32 NumFunctions{ 0 };
+    u32 NumConstants{ 0 };
+    u32 NumSpecConstants{ 0 };
+
+    PPE_PIPELINECOMPILER_API FVulkanSpirvStatistics& operator +=(const FVulkanSpirvStatistics& other);
+
+    // only walks the instruction stream, does not validate the module
+    NODISCARD PPE_PIPELINECOMPILER_API static bool Parse(FVulkanSpirvStatistics* outStatistics, const FRawMemoryConst& spirv);
+};
+//----------------------------------------------------------------------------
+// Offline optimization stage for SPIRV, does not need a device:
+// - frozen specialization constants are patched directly in the module
+// - the other passes need spirv-tools, they are skipped with a warning when it is not available
+//----------------------------------------------------------------------------
+class PPE_PIPELINECOMPILER_API FVulkanSpirvOptimizer {
+public:
+    using FLogger = IPipelineCompiler::FLogger;
+
+    explicit FVulkanSpirvOptimizer(const FVulkanSpirvOptimizerOptions& options) NOEXCEPT;
+
+    const FVulkanSpirvOptimizerOptions& Options() const { return _options; }
+
+    // spv_target_env of spirv-tools for a SPIRV format, also used by FVulkanSpirvCompiler
+    NODISCARD static u32 TargetEnvironment(EShaderLangFormat spirvFormat) NOEXCEPT;
+
+    // thread-safe
+    NODISCARD bool Optimize(
+        FRawData* spirv,
+        EShaderLangFormat spirvFormat,
+        const FLogger& logger,
+        FConstChar sourceFile = "@unknown" ) const {
+        return Optimize(spirv, TargetEnvironment(spirvFormat), logger, sourceFile);
+    }
+
+    // thread-safe, targetEnvironment is a spv_target_env
+    NODISCARD bool Optimize(
+        FRawData* spirv,
+        u32 targetEnvironment,
+        const FLogger& logger,
+        FConstChar sourceFile = "@unknown" ) const;
+
+private:
+    FVulkanSpirvOptimizerOptions _options;
+};
+//----------------------------------------------------------------------------
+// Collects the statistics before and after optimization for a corpus of shaders
+//----------------------------------------------------------------------------
+class PPE_PIPELINECOMPILER_API FVulkanSpirvOptimizationReport {
+public:
+    using FLogger = IPipelineCompiler::FLogger;
+
+    struct FEntry {
+        FString Name;
+        FVulkanSpirvStatistics Before;
+        FVulkanSpirvStatistics After;
+        FTimespan Duration{ 0 };
+    };
+
+    explicit FVulkanSpirvOptimizationReport(const FVulkanSpirvOptimizer& optimizer) NOEXCEPT;
+
+    TMemoryView<const FEntry> Entries() const { return _entries.MakeConstView(); }
+    NODISCARD FEntry Total() const;
+
+    // replaces every SPIRV found in the shader by its optimized version
+    NODISCARD bool Optimize(FStringView name, FPipelineDesc::FShader* shader, const FLogger& logger);
+    NODISCARD bool Optimize(FStringView name, FRawData* spirv, EShaderLangFormat spirvFormat, const FLogger& logger);
+
+    void Clear() { _entries.clear(); }
+
+    void Dump(FTextWriter& oss) const;
+
+private:
+    const FVulkanSpirvOptimizer& _optimizer;
+    VECTOR(PipelineCompiler, FEntry) _entries;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace RHI
+} //!namespace PPE
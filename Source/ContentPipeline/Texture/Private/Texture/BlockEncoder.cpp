@@ -0,0 +1,1687 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Texture/BlockEncoder.h"
+
+#include "RHI/PixelFormatHelpers.h"
+
+#include "Container/Vector.h"
+#include "Diagnostic/Logger.h"
+#include "HAL/PlatformMemory.h"
+#include "Maths/MathHelpers.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Maths/SSEHelpers.h"
+#include "Maths/WideMaths.h"
+#include "Thread/Task/TaskHelpers.h"
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// Block helpers
+//----------------------------------------------------------------------------
+using FBlockTexels_ = FBlockEncoder::FBlockTexels;
+CONSTEXPR u32 NumTexels_ = FBlockEncoder::TexelsPerBlock;
+STATIC_ASSERT(NumTexels_ % FWideFloat::Lanes == 0);
+//----------------------------------------------------------------------------
+// texels of a block in SoA, channels in [0,255]
+struct ALIGN(32) FBlockSoA_ {
+    float Channels[4][NumTexels_];
+};
+//----------------------------------------------------------------------------
+static void LoadBlockSoA_(FBlockSoA_* dst, const FBlockTexels_& src) NOEXCEPT {
+    forrange(t, 0, NumTexels_) {
+        forrange(c, 0, 4)
+            dst->Channels[c][t] = static_cast<float>(src.Rgba[t][c]);
+    }
+}
+//----------------------------------------------------------------------------
+// subset of each texel, stored as float for SIMD masks
+struct ALIGN(32) FPartition_ {
+    float SubsetOf[NumTexels_];
+    u32 NumSubsets;
+    u32 Anchors[2]; // texel whose index omits its MSB, in each subset (BC7)
+};
+//----------------------------------------------------------------------------
+static const FPartition_& SingleSubset_() NOEXCEPT {
+    static const FPartition_ GSingleSubset{ {}, 1, { 0, 0 } };
+    return GSingleSubset;
+}
+//----------------------------------------------------------------------------
+// decoded colors of a subset, in [0,255]
+struct FPalette_ {
+    u32 NumEntries;
+    float Colors[16][4];
+};
+//----------------------------------------------------------------------------
+// two endpoints in [0,255], channels not fitted are left untouched
+struct FEndpoints_ {
+    float E[2][4];
+};
+//----------------------------------------------------------------------------
+NODISCARD static FWideFloat SubsetMask_(const FPartition_& partition, u32 subset, u32 t) NOEXCEPT {
+    return (FWideFloat::LoadAligned(partition.SubsetOf + t) == FWideFloat::Broadcast(static_cast<float>(subset)));
+}
+//----------------------------------------------------------------------------
+// matches each texel of subset with the nearest entry of palette, on channels [firstChannel, lastChannel)
+// other texels are left untouched, returns the sum of squared errors of the subset
+static float FitIndices_(
+    u8 (&indices)[NumTexels_],
+    const FBlockSoA_& block, const FPalette_& palette,
+    const FPartition_& partition, u32 subset,
+    u32 firstChannel, u32 lastChannel ) NOEXCEPT {
+    Assert(firstChannel < lastChannel && lastChannel <= 4);
+    Assert(palette.NumEntries > 0 && palette.NumEntries <= 16);
+
+    ALIGN(32) float bestIndices[NumTexels_];
+    FWideFloat totalError = FWideFloat::Zero();
+
+    for (u32 t = 0; t < NumTexels_; t += FWideFloat::Lanes) {
+        const FWideFloat inSubset = SubsetMask_(partition, subset, t);
+        if (0 == inSubset.MoveMask())
+            continue;
+
+        FWideFloat texel[4];
+        for (u32 c = firstChannel; c < lastChannel; ++c)
+            texel[c] = FWideFloat::LoadAligned(block.Channels[c] + t);
+
+        FWideFloat bestError = FWideFloat::Broadcast(FLT_MAX);
+        FWideFloat bestIndex = FWideFloat::Zero();
+
+        forrange(e, 0, palette.NumEntries) {
+            FWideFloat error = FWideFloat::Zero();
+            for (u32 c = firstChannel; c < lastChannel; ++c) {
+                const FWideFloat d = (texel[c] - FWideFloat::Broadcast(palette.Colors[e][c]));
+                error += d * d;
+            }
+
+            const FWideFloat better = (error < bestError);
+            bestError = Select(better, error, bestError);
+            bestIndex = Select(better, FWideFloat::Broadcast(static_cast<float>(e)), bestIndex);
+        }
+
+        bestIndex.StoreAligned(bestIndices + t);
+        totalError += (bestError & inSubset);
+    }
+
+    forrange(t, 0, NumTexels_) {
+        if (partition.SubsetOf[t] == static_cast<float>(subset))
+            indices[t] = static_cast<u8>(bestIndices[t]);
+    }
+
+    ALIGN(32) float laneErrors[FWideFloat::Lanes];
+    totalError.StoreAligned(laneErrors);
+
+    float sumError = 0;
+    forrange(i, 0, FWideFloat::Lanes)
+        sumError += laneErrors[i];
+    return sumError;
+}
+//----------------------------------------------------------------------------
+// mean and principal axis of the texels of subset, with power iterations on the covariance matrix
+static void PrincipalAxis_(
+    float (&mean)[4], float (&axis)[4],
+    const FBlockSoA_& block,
+    const FPartition_& partition, u32 subset,
+    u32 firstChannel, u32 lastChannel ) NOEXCEPT {
+    float count = 0;
+    for (u32 c = firstChannel; c < lastChannel; ++c) {
+        mean[c] = 0;
+        axis[c] = 0;
+    }
+
+    forrange(t, 0, NumTexels_) {
+        if (partition.SubsetOf[t] != static_cast<float>(subset))
+            continue;
+        count += 1;
+        for (u32 c = firstChannel; c < lastChannel; ++c)
+            mean[c] += block.Channels[c][t];
+    }
+    if (count == 0)
+        return;
+
+    for (u32 c = firstChannel; c < lastChannel; ++c)
+        mean[c] /= count;
+
+    float covariance[4][4] = {};
+    forrange(t, 0, NumTexels_) {
+        if (partition.SubsetOf[t] != static_cast<float>(subset))
+            continue;
+        for (u32 i = firstChannel; i < lastChannel; ++i) {
+            const float di = (block.Channels[i][t] - mean[i]);
+            for (u32 j = i; j < lastChannel; ++j)
+                covariance[i][j] += di * (block.Channels[j][t] - mean[j]);
+        }
+    }
+
+    // start from the channel with the largest variance
+    u32 largest = firstChannel;
+    for (u32 i = firstChannel; i < lastChannel; ++i) {
+        for (u32 j = firstChannel; j < i; ++j)
+            covariance[i][j] = covariance[j][i];
+        if (covariance[i][i] > covariance[largest][largest])
+            largest = i;
+    }
+    if (covariance[largest][largest] <= 0)
+        return; // constant subset, axis is left null
+
+    for (u32 c = firstChannel; c < lastChannel; ++c)
+        axis[c] = covariance[largest][c];
+
+    forrange(iteration, 0, 8) {
+        float next[4] = {};
+        float norm = 0;
+        for (u32 i = firstChannel; i < lastChannel; ++i) {
+            for (u32 j = firstChannel; j < lastChannel; ++j)
+                next[i] += covariance[i][j] * axis[j];
+            norm = Max(norm, Abs(next[i]));
+        }
+        if (norm <= 0)
+            break;
+        for (u32 c = firstChannel; c < lastChannel; ++c)
+            axis[c] = next[c] / norm;
+    }
+
+    float lengthSq = 0;
+    for (u32 c = firstChannel; c < lastChannel; ++c)
+        lengthSq += Sqr(axis[c]);
+    const float invLength = 1.f / Sqrt(lengthSq);
+    for (u32 c = firstChannel; c < lastChannel; ++c)
+        axis[c] *= invLength;
+}
+//----------------------------------------------------------------------------
+// endpoints are the extremes of the texels projected on the principal axis
+static void FitPrincipalAxis_(
+    FEndpoints_* endpoints,
+    const FBlockSoA_& block,
+    const FPartition_& partition, u32 subset,
+    u32 firstChannel, u32 lastChannel ) NOEXCEPT {
+    float mean[4], axis[4];
+    PrincipalAxis_(mean, axis, block, partition, subset, firstChannel, lastChannel);
+
+    float tmin = FLT_MAX, tmax = -FLT_MAX;
+    forrange(t, 0, NumTexels_) {
+        if (partition.SubsetOf[t] != static_cast<float>(subset))
+            continue;
+        float d = 0;
+        for (u32 c = firstChannel; c < lastChannel; ++c)
+            d += (block.Channels[c][t] - mean[c]) * axis[c];
+        tmin = Min(tmin, d);
+        tmax = Max(tmax, d);
+    }
+    if (tmin > tmax)
+        tmin = tmax = 0; // empty subset
+
+    for (u32 c = firstChannel; c < lastChannel; ++c) {
+        endpoints->E[0][c] = Clamp(mean[c] + axis[c] * tmin, 0.f, 255.f);
+        endpoints->E[1][c] = Clamp(mean[c] + axis[c] * tmax, 0.f, 255.f);
+    }
+}
+//----------------------------------------------------------------------------
+// bounding box diagonal, oriented with the covariance of the widest channel, then inset
+static void FitRange_(
+    FEndpoints_* endpoints,
+    const FBlockSoA_& block,
+    u32 firstChannel, u32 lastChannel,
+    float inset ) NOEXCEPT {
+    float vmin[4], vmax[4], mean[4];
+    u32 widest = firstChannel;
+    for (u32 c = firstChannel; c < lastChannel; ++c) {
+        vmin[c] = FLT_MAX;
+        vmax[c] = -FLT_MAX;
+        mean[c] = 0;
+        forrange(t, 0, NumTexels_) {
+            vmin[c] = Min(vmin[c], block.Channels[c][t]);
+            vmax[c] = Max(vmax[c], block.Channels[c][t]);
+            mean[c] += block.Channels[c][t];
+        }
+        mean[c] /= NumTexels_;
+        if (vmax[c] - vmin[c] > vmax[widest] - vmin[widest])
+            widest = c;
+    }
+
+    for (u32 c = firstChannel; c < lastChannel; ++c) {
+        float covariance = 0;
+        forrange(t, 0, NumTexels_)
+            covariance += (block.Channels[c][t] - mean[c]) * (block.Channels[widest][t] - mean[widest]);
+
+        const float d = (vmax[c] - vmin[c]) * inset;
+        float lo = (vmin[c] + d), hi = (vmax[c] - d);
+        if (covariance < 0)
+            std::swap(lo, hi);
+
+        endpoints->E[0][c] = lo;
+        endpoints->E[1][c] = hi;
+    }
+}
+//----------------------------------------------------------------------------
+// least squares endpoints for the current indices of subset, weights[i] is the position of index i between the endpoints
+NODISCARD static bool LeastSquares_(
+    FEndpoints_* endpoints,
+    const FBlockSoA_& block,
+    const u8 (&indices)[NumTexels_], const float* weights,
+    const FPartition_& partition, u32 subset,
+    u32 firstChannel, u32 lastChannel ) NOEXCEPT {
+    float alpha2 = 0, beta2 = 0, alphaBeta = 0;
+    float alphaX[4] = {}, betaX[4] = {};
+
+    forrange(t, 0, NumTexels_) {
+        if (partition.SubsetOf[t] != static_cast<float>(subset))
+            continue;
+        const float beta = weights[indices[t]];
+        const float alpha = (1.f - beta);
+        alpha2 += alpha * alpha;
+        beta2 += beta * beta;
+        alphaBeta += alpha * beta;
+        for (u32 c = firstChannel; c < lastChannel; ++c) {
+            alphaX[c] += alpha * block.Channels[c][t];
+            betaX[c] += beta * block.Channels[c][t];
+        }
+    }
+
+    const float det = (alpha2 * beta2 - alphaBeta * alphaBeta);
+    if (Abs(det) < 1e-6f)
+        return false; // all texels on the same index
+
+    const float invDet = (1.f / det);
+    for (u32 c = firstChannel; c < lastChannel; ++c) {
+        endpoints->E[0][c] = Clamp((alphaX[c] * beta2 - betaX[c] * alphaBeta) * invDet, 0.f, 255.f);
+        endpoints->E[1][c] = Clamp((betaX[c] * alpha2 - alphaX[c] * alphaBeta) * invDet, 0.f, 255.f);
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+// BC1 color block
+//----------------------------------------------------------------------------
+CONSTEXPR float BC1Weights_[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+//----------------------------------------------------------------------------
+NODISCARD static CONSTEXPR u32 Expand5_(u32 x) { return ((x << 3) | (x >> 2)); }
+NODISCARD static CONSTEXPR u32 Expand6_(u32 x) { return ((x << 2) | (x >> 4)); }
+//----------------------------------------------------------------------------
+NODISCARD static u16 QuantizeRGB565_(const float (&rgb)[4]) NOEXCEPT {
+    const u32 r = checked_cast<u32>(RoundToInt(Clamp(rgb[0], 0.f, 255.f) * (31.f / 255.f)));
+    const u32 g = checked_cast<u32>(RoundToInt(Clamp(rgb[1], 0.f, 255.f) * (63.f / 255.f)));
+    const u32 b = checked_cast<u32>(RoundToInt(Clamp(rgb[2], 0.f, 255.f) * (31.f / 255.f)));
+    return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+//----------------------------------------------------------------------------
+static void ExpandRGB565_(u32 (&rgb)[3], u16 c) NOEXCEPT {
+    rgb[0] = Expand5_((c >> 11) & 31);
+    rgb[1] = Expand6_((c >> 5) & 63);
+    rgb[2] = Expand5_(c & 31);
+}
+//----------------------------------------------------------------------------
+// always in 4 colors mode, see WriteBC1_()
+static void PaletteBC1_(FPalette_* palette, u16 c0, u16 c1) NOEXCEPT {
+    u32 rgb0[3], rgb1[3];
+    ExpandRGB565_(rgb0, c0);
+    ExpandRGB565_(rgb1, c1);
+
+    palette->NumEntries = 4;
+    forrange(c, 0, 3) {
+        palette->Colors[0][c] = static_cast<float>(rgb0[c]);
+        palette->Colors[1][c] = static_cast<float>(rgb1[c]);
+        palette->Colors[2][c] = (2.f * rgb0[c] + rgb1[c]) / 3.f;
+        palette->Colors[3][c] = (rgb0[c] + 2.f * rgb1[c]) / 3.f;
+    }
+}
+//----------------------------------------------------------------------------
+struct FBC1Block_ {
+    u16 Colors[2];
+    u8 Indices[NumTexels_];
+    float Error{ FLT_MAX };
+};
+//----------------------------------------------------------------------------
+static void EvalBC1_(FBC1Block_* best, const FBlockSoA_& block, const FEndpoints_& endpoints) NOEXCEPT {
+    FBC1Block_ candidate;
+    candidate.Colors[0] = QuantizeRGB565_(endpoints.E[0]);
+    candidate.Colors[1] = QuantizeRGB565_(endpoints.E[1]);
+
+    FPalette_ palette;
+    PaletteBC1_(&palette, candidate.Colors[0], candidate.Colors[1]);
+    candidate.Error = FitIndices_(candidate.Indices, block, palette, SingleSubset_(), 0, 0, 3);
+
+    if (candidate.Error < best->Error)
+        *best = candidate;
+}
+//----------------------------------------------------------------------------
+// optimal endpoints for a single color, with all texels on index 2: (2 * c0 + c1) / 3 = v
+struct FBC1SolidTables_ {
+    u8 Match5[256][2];
+    u8 Match6[256][2];
+
+    FBC1SolidTables_() NOEXCEPT {
+        Init(Match5, 31, &Expand5_);
+        Init(Match6, 63, &Expand6_);
+    }
+
+    static void Init(u8 (&match)[256][2], u32 maxValue, u32 (*expand)(u32)) NOEXCEPT {
+        forrange(v, 0, 256) {
+            float bestError = FLT_MAX;
+            forrange(a, 0, maxValue + 1) {
+                forrange(b, 0, maxValue + 1) {
+                    const float error = Abs((2.f * expand(a) + expand(b)) / 3.f - v);
+                    if (error < bestError) {
+                        bestError = error;
+                        match[v][0] = static_cast<u8>(a);
+                        match[v][1] = static_cast<u8>(b);
+                    }
+                }
+            }
+        }
+    }
+};
+//----------------------------------------------------------------------------
+static void EncodeBC1Solid_(FBC1Block_* dst, const FBlockTexels_& texels) NOEXCEPT {
+    static const FBC1SolidTables_ GTables;
+
+    const u8* const rgb = texels.Rgba[0];
+    dst->Colors[0] = static_cast<u16>(
+        (GTables.Match5[rgb[0]][0] << 11) |
+        (GTables.Match6[rgb[1]][0] << 5) |
+        (GTables.Match5[rgb[2]][0]) );
+    dst->Colors[1] = static_cast<u16>(
+        (GTables.Match5[rgb[0]][1] << 11) |
+        (GTables.Match6[rgb[1]][1] << 5) |
+        (GTables.Match5[rgb[2]][1]) );
+
+    forrange(t, 0, NumTexels_)
+        dst->Indices[t] = 2;
+    dst->Error = 0;
+}
+//----------------------------------------------------------------------------
+// texels sorted along the principal axis are split in 4 contiguous clusters, each cluster is assigned
+// to a palette entry and endpoints are solved by least squares for every split: the splits [i,j,k)
+// are evaluated FWideFloat::Lanes values of k at a time
+static void ClusterFitBC1_(FBC1Block_* best, const FBlockSoA_& block) NOEXCEPT {
+    float mean[4], axis[4];
+    PrincipalAxis_(mean, axis, block, SingleSubset_(), 0, 0, 3);
+
+    u8 order[NumTexels_];
+    float keys[NumTexels_];
+    forrange(t, 0, NumTexels_) {
+        const float key = (block.Channels[0][t] * axis[0] + block.Channels[1][t] * axis[1] + block.Channels[2][t] * axis[2]);
+        u32 i = t;
+        for (; i > 0 && keys[i - 1] > key; --i) {
+            keys[i] = keys[i - 1];
+            order[i] = order[i - 1];
+        }
+        keys[i] = key;
+        order[i] = static_cast<u8>(t);
+    }
+
+    // prefix sums of the sorted texels, padded with the total for the last batch of k
+    ALIGN(32) float prefix[3][NumTexels_ + 1 + FWideFloat::Lanes];
+    forrange(c, 0, 3) {
+        prefix[c][0] = 0;
+        forrange(i, 0, NumTexels_)
+            prefix[c][i + 1] = prefix[c][i] + block.Channels[c][order[i]];
+        forrange(i, NumTexels_ + 1, NumTexels_ + 1 + FWideFloat::Lanes)
+            prefix[c][i] = prefix[c][NumTexels_];
+    }
+
+    // snaps x in [0,scale] to the nearest integer, using the float mantissa
+    const FWideFloat roundMagic = FWideFloat::Broadcast(12582912.f); // 1.5 * 2^23
+    const FWideFloat zero = FWideFloat::Zero();
+    const FWideFloat numTexels = FWideFloat::Broadcast(static_cast<float>(NumTexels_));
+    const FWideFloat scales[3] = { FWideFloat::Broadcast(31.f), FWideFloat::Broadcast(63.f), FWideFloat::Broadcast(31.f) };
+    const FWideFloat toGrid[3] = { FWideFloat::Broadcast(31.f / 255.f), FWideFloat::Broadcast(63.f / 255.f), FWideFloat::Broadcast(31.f / 255.f) };
+    const FWideFloat fromGrid[3] = { FWideFloat::Broadcast(255.f / 31.f), FWideFloat::Broadcast(255.f / 63.f), FWideFloat::Broadcast(255.f / 31.f) };
+    const FWideFloat oneThird = FWideFloat::Broadcast(1.f / 3.f);
+    const FWideFloat twoThirds = FWideFloat::Broadcast(2.f / 3.f);
+    const FWideFloat oneNinth = FWideFloat::Broadcast(1.f / 9.f);
+    const FWideFloat twoNinths = FWideFloat::Broadcast(2.f / 9.f);
+    const FWideFloat fourNinths = FWideFloat::Broadcast(4.f / 9.f);
+    const FWideFloat two = FWideFloat::Broadcast(2.f);
+
+    float bestError = FLT_MAX;
+    u32 bestSplit[3] = { 0, 0, 0 };
+
+    forrange(i, 0, NumTexels_ + 1) {
+        forrange(j, i, NumTexels_ + 1) {
+            const FWideFloat n0 = FWideFloat::Broadcast(static_cast<float>(i));
+            const FWideFloat n1 = FWideFloat::Broadcast(static_cast<float>(j - i));
+
+            for (u32 k0 = j; k0 <= NumTexels_; k0 += FWideFloat::Lanes) {
+                const FWideFloat k = FWideFloat::Iota(static_cast<float>(k0));
+                const FWideFloat n2 = (k - FWideFloat::Broadcast(static_cast<float>(j)));
+                const FWideFloat n3 = (numTexels - k);
+
+                const FWideFloat alpha2 = (n0 + n1 * fourNinths + n2 * oneNinth);
+                const FWideFloat beta2 = (n1 * oneNinth + n2 * fourNinths + n3);
+                const FWideFloat alphaBeta = ((n1 + n2) * twoNinths);
+                const FWideFloat det = (alpha2 * beta2 - alphaBeta * alphaBeta);
+                const FWideFloat valid = ((det > FWideFloat::Broadcast(1e-6f)) & (k <= numTexels));
+                const FWideFloat invDet = Rcp(Select(valid, det, FWideFloat::Broadcast(1.f)));
+
+                FWideFloat error = zero;
+                forrange(c, 0, 3) {
+                    const FWideFloat s0 = FWideFloat::Broadcast(prefix[c][i]);
+                    const FWideFloat sj = FWideFloat::Broadcast(prefix[c][j]);
+                    const FWideFloat sk = FWideFloat::Load(prefix[c] + k0);
+                    const FWideFloat total = FWideFloat::Broadcast(prefix[c][NumTexels_]);
+
+                    const FWideFloat alphaX = (s0 + (sj - s0) * twoThirds + (sk - sj) * oneThird);
+                    const FWideFloat betaX = ((sj - s0) * oneThird + (sk - sj) * twoThirds + (total - sk));
+
+                    // snap to the 565 grid before estimating the error
+                    FWideFloat a = Clamp((alphaX * beta2 - betaX * alphaBeta) * invDet * toGrid[c], zero, scales[c]);
+                    FWideFloat b = Clamp((betaX * alpha2 - alphaX * alphaBeta) * invDet * toGrid[c], zero, scales[c]);
+                    a = ((a + roundMagic) - roundMagic) * fromGrid[c];
+                    b = ((b + roundMagic) - roundMagic) * fromGrid[c];
+
+                    error += (a * a * alpha2 + b * b * beta2 + two * (a * b * alphaBeta - a * alphaX - b * betaX));
+                }
+
+                const u32 better = ((error < FWideFloat::Broadcast(bestError)) & valid).MoveMask();
+                if (better) {
+                    forrange(lane, 0, FWideFloat::Lanes) {
+                        const float laneError = error.Lane(lane);
+                        if ((better & (1u << lane)) && laneError < bestError) {
+                            bestError = laneError;
+                            bestSplit[0] = i;
+                            bestSplit[1] = j;
+                            bestSplit[2] = k0 + lane;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (bestError == FLT_MAX)
+        return;
+
+    // solves again the best split, EvalBC1_() will quantize the endpoints
+    FBC1Block_ clusters;
+    forrange(t, 0, NumTexels_) {
+        const u32 rank = static_cast<u32>(std::find(order, order + NumTexels_, static_cast<u8>(t)) - order);
+        clusters.Indices[t] = static_cast<u8>(rank < bestSplit[0] ? 0 : rank < bestSplit[1] ? 2 : rank < bestSplit[2] ? 3 : 1);
+    }
+
+    FEndpoints_ endpoints;
+    if (LeastSquares_(&endpoints, block, clusters.Indices, BC1Weights_, SingleSubset_(), 0, 0, 3))
+        EvalBC1_(best, block, endpoints);
+}
+//----------------------------------------------------------------------------
+static void WriteBC1_(u8* dst, const FBC1Block_& bc1) NOEXCEPT {
+    u16 c0 = bc1.Colors[0], c1 = bc1.Colors[1];
+    u32 indices = 0;
+
+    if (c0 == c1) {
+        // would select the 3 colors mode, all texels use the first endpoint
+    }
+    else {
+        // c0 > c1 selects the 4 colors mode, swapping endpoints swaps indices 0<->1 and 2<->3
+        const u32 flip = (c0 < c1 ? 1 : 0);
+        if (flip)
+            std::swap(c0, c1);
+        forrange(t, 0, NumTexels_)
+            indices |= (static_cast<u32>(bc1.Indices[t]) ^ flip) << (2 * t);
+    }
+
+    dst[0] = static_cast<u8>(c0);
+    dst[1] = static_cast<u8>(c0 >> 8);
+    dst[2] = static_cast<u8>(c1);
+    dst[3] = static_cast<u8>(c1 >> 8);
+    forrange(i, 0, 4)
+        dst[4 + i] = static_cast<u8>(indices >> (8 * i));
+}
+//----------------------------------------------------------------------------
+static void EncodeBC1_(u8* dst, const FBlockTexels_& texels, ETextureCompressionQuality quality) NOEXCEPT {
+    FBC1Block_ best;
+
+    bool solid = true;
+    forrange(t, 1, NumTexels_) {
+        solid &= (texels.Rgba[t][0] == texels.Rgba[0][0] &&
+                  texels.Rgba[t][1] == texels.Rgba[0][1] &&
+                  texels.Rgba[t][2] == texels.Rgba[0][2] );
+    }
+
+    if (solid) {
+        EncodeBC1Solid_(&best, texels);
+    }
+    else {
+        FBlockSoA_ block;
+        LoadBlockSoA_(&block, texels);
+
+        FEndpoints_ endpoints;
+        if (quality == ETextureCompressionQuality::Low)
+            FitRange_(&endpoints, block, 0, 3, 1.f / 16);
+        else
+            FitPrincipalAxis_(&endpoints, block, SingleSubset_(), 0, 0, 3);
+
+        EvalBC1_(&best, block, endpoints);
+
+        if (quality != ETextureCompressionQuality::Low) {
+            const u32 numIterations = (quality == ETextureCompressionQuality::High ? 3 : 1);
+            forrange(iteration, 0, numIterations) {
+                const float previousError = best.Error;
+                if (not LeastSquares_(&endpoints, block, best.Indices, BC1Weights_, SingleSubset_(), 0, 0, 3))
+                    break;
+                EvalBC1_(&best, block, endpoints);
+                if (best.Error >= previousError)
+                    break;
+            }
+        }
+
+        if (quality == ETextureCompressionQuality::High && best.Error > 0)
+            ClusterFitBC1_(&best, block);
+    }
+
+    WriteBC1_(dst, best);
+}
+//----------------------------------------------------------------------------
+// BC4 channel block
+//----------------------------------------------------------------------------
+// palette entries are matched as u8 codes: unsigned values, or signed values + 128
+struct FBC4Palette_ {
+    i32 Endpoints[2];
+    u8 Codes[8];
+};
+//----------------------------------------------------------------------------
+NODISCARD static CONSTEXPR i32 RoundDiv_(i32 num, i32 den) {
+    return (num >= 0 ? (num + den / 2) / den : -((den / 2 - num) / den));
+}
+//----------------------------------------------------------------------------
+static void PaletteBC4_(FBC4Palette_* palette, i32 a0, i32 a1, bool bSigned) NOEXCEPT {
+    i32 values[8];
+    values[0] = a0;
+    values[1] = a1;
+
+    if (a0 > a1) {
+        forrange(k, 2, 8)
+            values[k] = RoundDiv_(static_cast<i32>(8 - k) * a0 + static_cast<i32>(k - 1) * a1, 7);
+    }
+    else {
+        forrange(k, 2, 6)
+            values[k] = RoundDiv_(static_cast<i32>(6 - k) * a0 + static_cast<i32>(k - 1) * a1, 5);
+        values[6] = (bSigned ? -127 : 0);
+        values[7] = (bSigned ? 127 : 255);
+    }
+
+    palette->Endpoints[0] = a0;
+    palette->Endpoints[1] = a1;
+    forrange(k, 0, 8)
+        palette->Codes[k] = static_cast<u8>(values[k] + (bSigned ? 128 : 0));
+}
+//----------------------------------------------------------------------------
+// 16 texels matched at once with saturated absolute differences
+NODISCARD static u32 FitBC4_(u8 (&indices)[NumTexels_], const __m128i codes, const FBC4Palette_& palette) NOEXCEPT {
+    __m128i bestDiff = _mm_set1_epi8(static_cast<char>(0xFF));
+    __m128i bestIndex = _mm_setzero_si128();
+
+    forrange(k, 0, 8) {
+        const __m128i entry = _mm_set1_epi8(static_cast<char>(palette.Codes[k]));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(codes, entry), _mm_subs_epu8(entry, codes));
+        // diff < bestDiff <=> min(diff, bestDiff) != bestDiff
+        const __m128i better = _mm_xor_si128(
+            _mm_cmpeq_epi8(_mm_min_epu8(diff, bestDiff), bestDiff),
+            _mm_set1_epi8(static_cast<char>(0xFF)) );
+        bestDiff = _mm_min_epu8(diff, bestDiff);
+        bestIndex = _mm_or_si128(
+            _mm_and_si128(better, _mm_set1_epi8(static_cast<char>(k))),
+            _mm_andnot_si128(better, bestIndex) );
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_unpacklo_epi8(bestDiff, zero);
+    const __m128i hi = _mm_unpackhi_epi8(bestDiff, zero);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<u32>(_mm_cvtsi128_si32(sum));
+}
+//----------------------------------------------------------------------------
+// snorm values in [-127,127] map [0,255] to [-1,1]
+NODISCARD static i32 UNormToSNorm_(u8 v) NOEXCEPT {
+    return (RoundDiv_(static_cast<i32>(v) * 254, 255) - 127);
+}
+NODISCARD static u8 SNormToUNorm_(i32 s) NOEXCEPT {
+    return static_cast<u8>(RoundDiv_((Clamp(s, -127, 127) + 127) * 255, 254));
+}
+//----------------------------------------------------------------------------
+static void EncodeBC4_(u8* dst, const FBlockTexels_& texels, u32 channel, bool bSigned, ETextureCompressionQuality quality) NOEXCEPT {
+    const i32 domainMin = (bSigned ? -127 : 0);
+    const i32 domainMax = (bSigned ? 127 : 255);
+
+    ALIGN(16) u8 codes[NumTexels_];
+    i32 vmin = domainMax, vmax = domainMin;
+    i32 innerMin = domainMax, innerMax = domainMin; // without the extremes of the domain, for the 6 values mode
+    forrange(t, 0, NumTexels_) {
+        const i32 v = (bSigned ? UNormToSNorm_(texels.Rgba[t][channel]) : texels.Rgba[t][channel]);
+        codes[t] = static_cast<u8>(v + (bSigned ? 128 : 0));
+        vmin = Min(vmin, v);
+        vmax = Max(vmax, v);
+        if (v != domainMin && v != domainMax) {
+            innerMin = Min(innerMin, v);
+            innerMax = Max(innerMax, v);
+        }
+    }
+
+    const __m128i codes16 = _mm_load_si128(reinterpret_cast<const __m128i*>(codes));
+
+    FBC4Palette_ palette;
+    FBC4Palette_ bestPalette;
+    u8 indices[NumTexels_];
+    u8 bestIndices[NumTexels_];
+    u32 bestError = UINT32_MAX;
+
+    const auto evaluate = [&](i32 a0, i32 a1) {
+        PaletteBC4_(&palette, a0, a1, bSigned);
+        const u32 error = FitBC4_(indices, codes16, palette);
+        if (error < bestError) {
+            bestError = error;
+            bestPalette = palette;
+            FPlatformMemory::Memcpy(bestIndices, indices, sizeof(indices));
+        }
+    };
+
+    // 8 values mode: a0 > a1
+    if (vmax > vmin)
+        evaluate(vmax, vmin);
+    else
+        evaluate(vmin, vmin);
+
+    // 6 values mode with explicit extremes: a0 <= a1
+    if (quality != ETextureCompressionQuality::Low && bestError > 0) {
+        if (innerMin > innerMax)
+            innerMin = innerMax = vmin; // only extremes, matched by indices 6 and 7
+        evaluate(innerMin, innerMax);
+    }
+
+    // search around the endpoints, the interpolated values do not always align with the texels
+    if (quality == ETextureCompressionQuality::High && bestError > 0) {
+        const i32 radius = 2;
+        const i32 e0 = bestPalette.Endpoints[0];
+        const i32 e1 = bestPalette.Endpoints[1];
+        const bool mode8 = (e0 > e1);
+        for (i32 d0 = -radius; d0 <= radius; ++d0) {
+            for (i32 d1 = -radius; d1 <= radius; ++d1) {
+                const i32 a0 = Clamp(e0 + d0, domainMin, domainMax);
+                const i32 a1 = Clamp(e1 + d1, domainMin, domainMax);
+                if ((a0 > a1) == mode8)
+                    evaluate(a0, a1);
+            }
+        }
+    }
+
+    dst[0] = static_cast<u8>(bestPalette.Endpoints[0]);
+    dst[1] = static_cast<u8>(bestPalette.Endpoints[1]);
+
+    u64 bits = 0;
+    forrange(t, 0, NumTexels_)
+        bits |= static_cast<u64>(bestIndices[t]) << (3 * t);
+    forrange(i, 0, 6)
+        dst[2 + i] = static_cast<u8>(bits >> (8 * i));
+}
+//----------------------------------------------------------------------------
+// BC7
+//----------------------------------------------------------------------------
+struct FBC7Mode_ {
+    u8 Mode;
+    u8 NumSubsets;
+    u8 PartitionBits;
+    u8 RotationBits;
+    u8 ColorBits; // without p-bit
+    u8 AlphaBits; // 0 when alpha is not stored (decoded as 255)
+    u8 PBits; // 0: none, 1: shared by the endpoints of a subset, 2: one per endpoint
+    u8 IndexBits;
+    u8 AlphaIndexBits; // separate alpha indices
+};
+//----------------------------------------------------------------------------
+// only the modes searched by the encoder, 3 subsets modes are not worth their cost here
+CONSTEXPR FBC7Mode_ BC7Mode1_{ 1, 2, 6, 0, 6, 0, 1, 3, 0 };
+CONSTEXPR FBC7Mode_ BC7Mode3_{ 3, 2, 6, 0, 7, 0, 2, 2, 0 };
+CONSTEXPR FBC7Mode_ BC7Mode5_{ 5, 1, 0, 2, 7, 8, 0, 2, 2 };
+CONSTEXPR FBC7Mode_ BC7Mode6_{ 6, 1, 0, 0, 7, 7, 2, 4, 0 };
+CONSTEXPR FBC7Mode_ BC7Mode7_{ 7, 2, 6, 0, 5, 5, 2, 2, 0 };
+//----------------------------------------------------------------------------
+NODISCARD static const FBC7Mode_* BC7Mode_(u32 mode) NOEXCEPT {
+    switch (mode) {
+    case 1: return &BC7Mode1_;
+    case 3: return &BC7Mode3_;
+    case 5: return &BC7Mode5_;
+    case 6: return &BC7Mode6_;
+    case 7: return &BC7Mode7_;
+    default: return nullptr;
+    }
+}
+//----------------------------------------------------------------------------
+// 2 subsets partitions: bit t is the subset of texel t
+CONSTEXPR u16 BC7Partitions2_[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+//----------------------------------------------------------------------------
+// anchor texel of the second subset
+CONSTEXPR u8 BC7Anchors2_[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,
+     2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,
+     2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2,
+    15, 15, 15, 15, 15,  2,  2, 15,
+};
+//----------------------------------------------------------------------------
+struct FBC7Partitions2_ {
+    FPartition_ Partitions[64];
+    ALIGN(32) float SubsetOfTexel[NumTexels_][64]; // transposed, to rank the partitions FWideFloat::Lanes at a time
+
+    FBC7Partitions2_() NOEXCEPT {
+        forrange(p, 0, 64) {
+            FPartition_& partition = Partitions[p];
+            partition.NumSubsets = 2;
+            partition.Anchors[0] = 0;
+            partition.Anchors[1] = BC7Anchors2_[p];
+            forrange(t, 0, NumTexels_) {
+                partition.SubsetOf[t] = static_cast<float>((BC7Partitions2_[p] >> t) & 1);
+                SubsetOfTexel[t][p] = partition.SubsetOf[t];
+            }
+            Assert_NoAssume(partition.SubsetOf[partition.Anchors[1]] == 1.f);
+        }
+    }
+
+    static const FBC7Partitions2_& Get() NOEXCEPT {
+        static const FBC7Partitions2_ GPartitions2;
+        return GPartitions2;
+    }
+};
+STATIC_ASSERT(64 % FWideFloat::Lanes == 0);
+//----------------------------------------------------------------------------
+NODISCARD static const FPartition_& BC7Partition_(const FBC7Mode_& mode, u32 partition) NOEXCEPT {
+    if (mode.NumSubsets == 1)
+        return SingleSubset_();
+
+    Assert(partition < 64);
+    return FBC7Partitions2_::Get().Partitions[partition];
+}
+//----------------------------------------------------------------------------
+CONSTEXPR u8 BC7Weights2_[4] = { 0, 21, 43, 64 };
+CONSTEXPR u8 BC7Weights3_[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+CONSTEXPR u8 BC7Weights4_[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+//----------------------------------------------------------------------------
+NODISCARD static const u8* BC7Weights_(u32 indexBits) NOEXCEPT {
+    switch (indexBits) {
+    case 2: return BC7Weights2_;
+    case 3: return BC7Weights3_;
+    case 4: return BC7Weights4_;
+    default: AssertNotReached(); return nullptr;
+    }
+}
+//----------------------------------------------------------------------------
+NODISCARD static CONSTEXPR u32 BC7Interpolate_(u32 e0, u32 e1, u32 weight) {
+    return (((64 - weight) * e0 + weight * e1 + 32) >> 6);
+}
+//----------------------------------------------------------------------------
+// n bits value expanded to 8 bits by replicating its MSBs
+NODISCARD static CONSTEXPR u32 BC7Expand_(u32 x, u32 n) {
+    return (n >= 8 ? x : ((x << (8 - n)) | (x >> (2 * n - 8))));
+}
+//----------------------------------------------------------------------------
+// nearest value of `bits` bits with p-bit pbit (or none when < 0), returns the quantized value without the p-bit
+NODISCARD static u8 BC7Quantize_(u32* expanded, float v, u32 bits, i32 pbit) NOEXCEPT {
+    const u32 n = bits + (pbit >= 0 ? 1 : 0);
+    const i32 maxValue = static_cast<i32>((1u << bits) - 1);
+    const float scaled = (v * ((1u << n) - 1) / 255.f);
+    const i32 guess = (pbit >= 0 ? RoundToInt((scaled - pbit) * 0.5f) : RoundToInt(scaled));
+
+    u8 best = 0;
+    float bestError = FLT_MAX;
+    for (i32 q = Max(0, guess - 1); q <= Min(maxValue, guess + 1); ++q) {
+        const u32 x = (pbit >= 0 ? ((static_cast<u32>(q) << 1) | static_cast<u32>(pbit)) : static_cast<u32>(q));
+        const u32 e = BC7Expand_(x, n);
+        const float error = Abs(static_cast<float>(e) - v);
+        if (error < bestError) {
+            bestError = error;
+            best = static_cast<u8>(q);
+            *expanded = e;
+        }
+    }
+    return best;
+}
+//----------------------------------------------------------------------------
+struct FBC7Block_ {
+    const FBC7Mode_* Mode{ nullptr };
+    u32 Partition{ 0 };
+    u32 Rotation{ 0 };
+    u8 Endpoints[2][2][4]{}; // [subset][endpoint][channel], quantized without p-bits
+    u8 PBits[2][2]{}; // [subset][endpoint]
+    u8 Indices[NumTexels_]{};
+    u8 AlphaIndices[NumTexels_]{};
+    float Error{ FLT_MAX };
+};
+//----------------------------------------------------------------------------
+// quantizes the endpoints of subset for every p-bits combination and keeps the best fit
+static float QuantizeBC7Subset_(
+    FBC7Block_* dst,
+    const FBlockSoA_& block, const FPartition_& partition, u32 subset,
+    const FEndpoints_& endpoints ) NOEXCEPT {
+    const FBC7Mode_& mode = *dst->Mode;
+    const bool separateAlpha = (mode.AlphaIndexBits > 0);
+    const u32 colorChannels = (mode.AlphaBits && not separateAlpha ? 4 : 3);
+    const u8* const weights = BC7Weights_(mode.IndexBits);
+    const u32 numCombinations = (mode.PBits == 0 ? 1 : mode.PBits == 1 ? 2 : 4);
+
+    // endpoints quantized with each p-bit value: [pbit][endpoint][channel]
+    u8 quantizedWithPBit[2][2][4] = {};
+    u32 expandedWithPBit[2][2][4] = {};
+    forrange(pbit, 0, mode.PBits ? 2 : 1) {
+        forrange(ep, 0, 2) {
+            forrange(c, 0, colorChannels) {
+                const u32 bits = (c < 3 ? mode.ColorBits : mode.AlphaBits);
+                quantizedWithPBit[pbit][ep][c] = BC7Quantize_(&expandedWithPBit[pbit][ep][c], endpoints.E[ep][c], bits, mode.PBits ? static_cast<i32>(pbit) : -1);
+            }
+            if (separateAlpha)
+                quantizedWithPBit[pbit][ep][3] = BC7Quantize_(&expandedWithPBit[pbit][ep][3], endpoints.E[ep][3], mode.AlphaBits, -1);
+        }
+    }
+
+    float bestError = FLT_MAX;
+    forrange(combination, 0, numCombinations) {
+        u32 pbits[2] = { 0, 0 };
+        if (mode.PBits == 1)
+            pbits[0] = pbits[1] = combination;
+        else if (mode.PBits == 2)
+            pbits[0] = (combination & 1), pbits[1] = (combination >> 1);
+
+        const u8 (&quantized0)[4] = quantizedWithPBit[pbits[0]][0];
+        const u8 (&quantized1)[4] = quantizedWithPBit[pbits[1]][1];
+        const u32 (&expanded0)[4] = expandedWithPBit[pbits[0]][0];
+        const u32 (&expanded1)[4] = expandedWithPBit[pbits[1]][1];
+
+        FPalette_ palette;
+        palette.NumEntries = (1u << mode.IndexBits);
+        forrange(k, 0, palette.NumEntries) {
+            forrange(c, 0, colorChannels)
+                palette.Colors[k][c] = static_cast<float>(BC7Interpolate_(expanded0[c], expanded1[c], weights[k]));
+        }
+
+        u8 indices[NumTexels_];
+        float error = FitIndices_(indices, block, palette, partition, subset, 0, colorChannels);
+
+        u8 alphaIndices[NumTexels_];
+        if (separateAlpha) {
+            const u8* const alphaWeights = BC7Weights_(mode.AlphaIndexBits);
+            FPalette_ alphaPalette;
+            alphaPalette.NumEntries = (1u << mode.AlphaIndexBits);
+            forrange(k, 0, alphaPalette.NumEntries)
+                alphaPalette.Colors[k][3] = static_cast<float>(BC7Interpolate_(expanded0[3], expanded1[3], alphaWeights[k]));
+
+            error += FitIndices_(alphaIndices, block, alphaPalette, partition, subset, 3, 4);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            forrange(c, 0, 4) {
+                dst->Endpoints[subset][0][c] = quantized0[c];
+                dst->Endpoints[subset][1][c] = quantized1[c];
+            }
+            dst->PBits[subset][0] = static_cast<u8>(pbits[0]);
+            dst->PBits[subset][1] = static_cast<u8>(pbits[1]);
+            forrange(t, 0, NumTexels_) {
+                if (partition.SubsetOf[t] == static_cast<float>(subset)) {
+                    dst->Indices[t] = indices[t];
+                    if (separateAlpha)
+                        dst->AlphaIndices[t] = alphaIndices[t];
+                }
+            }
+        }
+    }
+
+    return bestError;
+}
+//----------------------------------------------------------------------------
+static void EncodeBC7Mode_(
+    FBC7Block_* best,
+    const FBlockSoA_& block,
+    const FBC7Mode_& mode, u32 partitionIndex, u32 rotation,
+    ETextureCompressionQuality quality ) NOEXCEPT {
+    const FPartition_& partition = BC7Partition_(mode, partitionIndex);
+    const bool separateAlpha = (mode.AlphaIndexBits > 0);
+    const u32 colorChannels = (mode.AlphaBits && not separateAlpha ? 4 : 3);
+
+    float weights[16];
+    forrange(k, 0, 1u << mode.IndexBits)
+        weights[k] = BC7Weights_(mode.IndexBits)[k] / 64.f;
+    float alphaWeights[4];
+    if (separateAlpha) {
+        forrange(k, 0, 1u << mode.AlphaIndexBits)
+            alphaWeights[k] = BC7Weights_(mode.AlphaIndexBits)[k] / 64.f;
+    }
+
+    FBC7Block_ candidate;
+    candidate.Mode = &mode;
+    candidate.Partition = partitionIndex;
+    candidate.Rotation = rotation;
+    candidate.Error = 0;
+
+    forrange(subset, 0, partition.NumSubsets) {
+        FEndpoints_ endpoints;
+        FitPrincipalAxis_(&endpoints, block, partition, subset, 0, colorChannels);
+        if (separateAlpha) // single subset
+            FitRange_(&endpoints, block, 3, 4, 0.f);
+
+        float error = QuantizeBC7Subset_(&candidate, block, partition, subset, endpoints);
+
+        if (quality == ETextureCompressionQuality::High && error > 0) {
+            FBC7Block_ refined = candidate;
+            bool refit = LeastSquares_(&endpoints, block, candidate.Indices, weights, partition, subset, 0, colorChannels);
+            if (separateAlpha)
+                refit |= LeastSquares_(&endpoints, block, candidate.AlphaIndices, alphaWeights, partition, subset, 3, 4);
+            if (refit) {
+                const float refinedError = QuantizeBC7Subset_(&refined, block, partition, subset, endpoints);
+                if (refinedError < error) {
+                    error = refinedError;
+                    candidate = refined;
+                }
+            }
+        }
+
+        candidate.Error += error;
+        if (candidate.Error >= best->Error)
+            return;
+    }
+
+    *best = candidate;
+}
+//----------------------------------------------------------------------------
+// the MSB of the anchor index is implicitly 0: swap the endpoints of the subsets where it is not
+static void FixBC7Anchors_(FBC7Block_* bc7) NOEXCEPT {
+    const FBC7Mode_& mode = *bc7->Mode;
+    const FPartition_& partition = BC7Partition_(mode, bc7->Partition);
+    const bool separateAlpha = (mode.AlphaIndexBits > 0);
+
+    const auto fix = [&](u8 (&indices)[NumTexels_], u32 indexBits, u32 firstChannel, u32 lastChannel, bool swapPBits) {
+        const u32 maxIndex = ((1u << indexBits) - 1);
+        forrange(subset, 0, partition.NumSubsets) {
+            if (indices[partition.Anchors[subset]] <= (maxIndex >> 1))
+                continue;
+
+            forrange(c, firstChannel, lastChannel)
+                std::swap(bc7->Endpoints[subset][0][c], bc7->Endpoints[subset][1][c]);
+            if (swapPBits)
+                std::swap(bc7->PBits[subset][0], bc7->PBits[subset][1]);
+            forrange(t, 0, NumTexels_) {
+                if (partition.SubsetOf[t] == static_cast<float>(subset))
+                    indices[t] = static_cast<u8>(maxIndex - indices[t]);
+            }
+        }
+    };
+
+    fix(bc7->Indices, mode.IndexBits, 0, (separateAlpha ? 3 : 4), true);
+    if (separateAlpha)
+        fix(bc7->AlphaIndices, mode.AlphaIndexBits, 3, 4, false);
+}
+//----------------------------------------------------------------------------
+// BC7 blocks are little endian bit streams
+struct FBC7BitWriter_ {
+    u64 Words[2]{};
+    u32 Position{ 0 };
+
+    void Write(u32 value, u32 numBits) NOEXCEPT {
+        Assert(numBits <= 32 && Position + numBits <= 128);
+        Assert_NoAssume(numBits == 32 || (value >> numBits) == 0);
+        if (Position < 64) {
+            Words[0] |= static_cast<u64>(value) << Position;
+            if (Position + numBits > 64)
+                Words[1] |= static_cast<u64>(value) >> (64 - Position);
+        }
+        else {
+            Words[1] |= static_cast<u64>(value) << (Position - 64);
+        }
+        Position += numBits;
+    }
+};
+//----------------------------------------------------------------------------
+struct FBC7BitReader_ {
+    u64 Words[2]{};
+    u32 Position{ 0 };
+
+    NODISCARD u32 Read(u32 numBits) NOEXCEPT {
+        Assert(numBits <= 32 && Position + numBits <= 128);
+        u64 value;
+        if (Position < 64) {
+            value = (Words[0] >> Position);
+            if (Position + numBits > 64)
+                value |= (Words[1] << (64 - Position));
+        }
+        else {
+            value = (Words[1] >> (Position - 64));
+        }
+        Position += numBits;
+        return static_cast<u32>(value & ((u64(1) << numBits) - 1));
+    }
+};
+//----------------------------------------------------------------------------
+static void WriteBC7_(u8* dst, const FBC7Block_& bc7) NOEXCEPT {
+    const FBC7Mode_& mode = *bc7.Mode;
+    const FPartition_& partition = BC7Partition_(mode, bc7.Partition);
+
+    FBC7BitWriter_ writer;
+    writer.Write(1u << mode.Mode, mode.Mode + 1);
+    if (mode.PartitionBits)
+        writer.Write(bc7.Partition, mode.PartitionBits);
+    if (mode.RotationBits)
+        writer.Write(bc7.Rotation, mode.RotationBits);
+
+    forrange(c, 0, 3) {
+        forrange(subset, 0, partition.NumSubsets) {
+            writer.Write(bc7.Endpoints[subset][0][c], mode.ColorBits);
+            writer.Write(bc7.Endpoints[subset][1][c], mode.ColorBits);
+        }
+    }
+    if (mode.AlphaBits) {
+        forrange(subset, 0, partition.NumSubsets) {
+            writer.Write(bc7.Endpoints[subset][0][3], mode.AlphaBits);
+            writer.Write(bc7.Endpoints[subset][1][3], mode.AlphaBits);
+        }
+    }
+
+    if (mode.PBits == 2) {
+        forrange(subset, 0, partition.NumSubsets) {
+            writer.Write(bc7.PBits[subset][0], 1);
+            writer.Write(bc7.PBits[subset][1], 1);
+        }
+    }
+    else if (mode.PBits == 1) {
+        forrange(subset, 0, partition.NumSubsets)
+            writer.Write(bc7.PBits[subset][0], 1);
+    }
+
+    forrange(t, 0, NumTexels_) {
+        const bool anchor = (t == 0 || (partition.NumSubsets == 2 && t == partition.Anchors[1]));
+        writer.Write(bc7.Indices[t], mode.IndexBits - (anchor ? 1 : 0));
+    }
+    if (mode.AlphaIndexBits) {
+        forrange(t, 0, NumTexels_)
+            writer.Write(bc7.AlphaIndices[t], mode.AlphaIndexBits - (t == 0 ? 1 : 0));
+    }
+
+    Assert_NoAssume(128 == writer.Position);
+    forrange(i, 0, 16)
+        dst[i] = static_cast<u8>(writer.Words[i / 8] >> (8 * (i % 8)));
+}
+//----------------------------------------------------------------------------
+// estimates the error of each 2 subsets partition by the residual of the texels around the principal axis of each subset:
+// trace(covariance) - largest eigenvalue, evaluated for FWideFloat::Lanes partitions at a time
+static void RankBC7Partitions_(u8* bestPartitions, u32 numPartitions, const FBlockSoA_& block, u32 numChannels) NOEXCEPT {
+    const FBC7Partitions2_& table = FBC7Partitions2_::Get();
+    const FWideFloat zero = FWideFloat::Zero();
+    const FWideFloat one = FWideFloat::Broadcast(1.f);
+
+    float totalSums[4] = {};
+    float totalProducts[4][4] = {};
+    forrange(t, 0, NumTexels_) {
+        forrange(i, 0, numChannels) {
+            totalSums[i] += block.Channels[i][t];
+            forrange(j, i, numChannels)
+                totalProducts[i][j] += block.Channels[i][t] * block.Channels[j][t];
+        }
+    }
+
+    ALIGN(32) float errors[64];
+    for (u32 p = 0; p < 64; p += FWideFloat::Lanes) {
+        // moments of the second subset, the first subset is deduced from the totals
+        FWideFloat counts[2] = { zero, zero };
+        FWideFloat sums[2][4];
+        FWideFloat products[2][4][4];
+        forrange(i, 0, numChannels) {
+            sums[1][i] = zero;
+            forrange(j, i, numChannels)
+                products[1][i][j] = zero;
+        }
+
+        forrange(t, 0, NumTexels_) {
+            const FWideFloat mask = FWideFloat::LoadAligned(table.SubsetOfTexel[t] + p);
+            counts[1] += mask;
+            forrange(i, 0, numChannels) {
+                const float xi = block.Channels[i][t];
+                sums[1][i] += mask * FWideFloat::Broadcast(xi);
+                forrange(j, i, numChannels)
+                    products[1][i][j] += mask * FWideFloat::Broadcast(xi * block.Channels[j][t]);
+            }
+        }
+
+        counts[0] = (FWideFloat::Broadcast(static_cast<float>(NumTexels_)) - counts[1]);
+        forrange(i, 0, numChannels) {
+            sums[0][i] = (FWideFloat::Broadcast(totalSums[i]) - sums[1][i]);
+            forrange(j, i, numChannels)
+                products[0][i][j] = (FWideFloat::Broadcast(totalProducts[i][j]) - products[1][i][j]);
+        }
+
+        FWideFloat error = zero;
+        forrange(subset, 0, 2) {
+            const FWideFloat invCount = Rcp(Select(counts[subset] > zero, counts[subset], one));
+
+            FWideFloat covariance[4][4];
+            forrange(i, 0, numChannels) {
+                forrange(j, i, numChannels)
+                    covariance[i][j] = covariance[j][i] = (products[subset][i][j] - sums[subset][i] * sums[subset][j] * invCount);
+                error += covariance[i][i];
+            }
+
+            // largest eigenvalue with power iterations
+            FWideFloat v[4] = { one, one, one, one };
+            FWideFloat lambda = zero;
+            forrange(iteration, 0, 4) {
+                FWideFloat next[4];
+                lambda = zero;
+                forrange(i, 0, numChannels) {
+                    next[i] = zero;
+                    forrange(j, 0, numChannels)
+                        next[i] += covariance[i][j] * v[j];
+                    lambda = Max(lambda, Abs(next[i]));
+                }
+                const FWideFloat invLambda = Rcp(Select(lambda > zero, lambda, one));
+                forrange(i, 0, numChannels)
+                    v[i] = next[i] * invLambda;
+            }
+
+            error -= lambda;
+        }
+
+        error.StoreAligned(errors + p);
+    }
+
+    // partial selection sort, numPartitions is small
+    bool selected[64] = {};
+    forrange(i, 0, numPartitions) {
+        u32 best = 0;
+        while (selected[best])
+            ++best;
+        forrange(p, best + 1, 64) {
+            if (not selected[p] && errors[p] < errors[best])
+                best = p;
+        }
+        selected[best] = true;
+        bestPartitions[i] = static_cast<u8>(best);
+    }
+}
+//----------------------------------------------------------------------------
+static void EncodeBC7_(u8* dst, const FBlockTexels_& texels, ETextureCompressionQuality quality) NOEXCEPT {
+    FBlockSoA_ block;
+    LoadBlockSoA_(&block, texels);
+
+    bool opaque = true;
+    forrange(t, 0, NumTexels_)
+        opaque &= (texels.Rgba[t][3] == 0xFF);
+
+    FBC7Block_ best;
+    EncodeBC7Mode_(&best, block, BC7Mode6_, 0, 0, quality);
+
+    if (quality != ETextureCompressionQuality::Low && best.Error > 0) {
+        const u32 numPartitions = (quality == ETextureCompressionQuality::High ? 8 : 2);
+        u8 partitions[8];
+
+        if (opaque) {
+            RankBC7Partitions_(partitions, numPartitions, block, 3);
+            forrange(i, 0, numPartitions) {
+                EncodeBC7Mode_(&best, block, BC7Mode1_, partitions[i], 0, quality);
+                if (quality == ETextureCompressionQuality::High)
+                    EncodeBC7Mode_(&best, block, BC7Mode3_, partitions[i], 0, quality);
+            }
+        }
+        else {
+            EncodeBC7Mode_(&best, block, BC7Mode5_, 0, 0, quality);
+
+            if (quality == ETextureCompressionQuality::High) {
+                // rotations swap alpha with a color channel, to give it the separate indices
+                forrange(rotation, 1, 4) {
+                    FBlockSoA_ rotated = block;
+                    std::swap(rotated.Channels[3], rotated.Channels[rotation - 1]);
+                    EncodeBC7Mode_(&best, rotated, BC7Mode5_, 0, rotation, quality);
+                }
+
+                RankBC7Partitions_(partitions, numPartitions, block, 4);
+                forrange(i, 0, numPartitions)
+                    EncodeBC7Mode_(&best, block, BC7Mode7_, partitions[i], 0, quality);
+            }
+        }
+    }
+
+    FixBC7Anchors_(&best);
+    WriteBC7_(dst, best);
+}
+//----------------------------------------------------------------------------
+static void DecodeBC7_(FBlockTexels_* dst, const u8* src) NOEXCEPT {
+    FBC7BitReader_ reader;
+    forrange(i, 0, 16)
+        reader.Words[i / 8] |= static_cast<u64>(src[i]) << (8 * (i % 8));
+
+    u32 modeIndex = 0;
+    while (modeIndex < 8 && reader.Read(1) == 0)
+        ++modeIndex;
+
+    const FBC7Mode_* const pMode = BC7Mode_(modeIndex);
+    if (nullptr == pMode) {
+        FPlatformMemory::Memzero(dst, sizeof(*dst));
+        return;
+    }
+
+    const FBC7Mode_& mode = *pMode;
+    const u32 partitionIndex = (mode.PartitionBits ? reader.Read(mode.PartitionBits) : 0);
+    const u32 rotation = (mode.RotationBits ? reader.Read(mode.RotationBits) : 0);
+    const FPartition_& partition = BC7Partition_(mode, partitionIndex);
+
+    u32 endpoints[2][2][4];
+    forrange(c, 0, 3) {
+        forrange(subset, 0, partition.NumSubsets) {
+            endpoints[subset][0][c] = reader.Read(mode.ColorBits);
+            endpoints[subset][1][c] = reader.Read(mode.ColorBits);
+        }
+    }
+    forrange(subset, 0, partition.NumSubsets) {
+        endpoints[subset][0][3] = (mode.AlphaBits ? reader.Read(mode.AlphaBits) : 0xFF);
+        endpoints[subset][1][3] = (mode.AlphaBits ? reader.Read(mode.AlphaBits) : 0xFF);
+    }
+
+    u32 pbits[2][2] = {};
+    if (mode.PBits == 2) {
+        forrange(subset, 0, partition.NumSubsets) {
+            pbits[subset][0] = reader.Read(1);
+            pbits[subset][1] = reader.Read(1);
+        }
+    }
+    else if (mode.PBits == 1) {
+        forrange(subset, 0, partition.NumSubsets)
+            pbits[subset][0] = pbits[subset][1] = reader.Read(1);
+    }
+
+    forrange(subset, 0, partition.NumSubsets) {
+        forrange(ep, 0, 2) {
+            forrange(c, 0, 4) {
+                u32& e = endpoints[subset][ep][c];
+                const u32 bits = (c < 3 ? mode.ColorBits : mode.AlphaBits);
+                if (c == 3 && 0 == mode.AlphaBits)
+                    continue;
+                if (mode.PBits)
+                    e = BC7Expand_((e << 1) | pbits[subset][ep], bits + 1);
+                else
+                    e = BC7Expand_(e, bits);
+            }
+        }
+    }
+
+    u32 indices[NumTexels_];
+    forrange(t, 0, NumTexels_) {
+        const bool anchor = (t == 0 || (partition.NumSubsets == 2 && t == partition.Anchors[1]));
+        indices[t] = reader.Read(mode.IndexBits - (anchor ? 1 : 0));
+    }
+    u32 alphaIndices[NumTexels_];
+    if (mode.AlphaIndexBits) {
+        forrange(t, 0, NumTexels_)
+            alphaIndices[t] = reader.Read(mode.AlphaIndexBits - (t == 0 ? 1 : 0));
+    }
+    Assert_NoAssume(128 == reader.Position);
+
+    const u8* const weights = BC7Weights_(mode.IndexBits);
+    forrange(t, 0, NumTexels_) {
+        const u32 subset = static_cast<u32>(partition.SubsetOf[t]);
+        const u32 (&e)[2][4] = endpoints[subset];
+        u8* const rgba = dst->Rgba[t];
+        forrange(c, 0, 3)
+            rgba[c] = static_cast<u8>(BC7Interpolate_(e[0][c], e[1][c], weights[indices[t]]));
+        if (mode.AlphaIndexBits)
+            rgba[3] = static_cast<u8>(BC7Interpolate_(e[0][3], e[1][3], BC7Weights_(mode.AlphaIndexBits)[alphaIndices[t]]));
+        else
+            rgba[3] = static_cast<u8>(BC7Interpolate_(e[0][3], e[1][3], weights[indices[t]]));
+        if (rotation)
+            std::swap(rgba[3], rgba[rotation - 1]);
+    }
+}
+//----------------------------------------------------------------------------
+// Decoders
+//----------------------------------------------------------------------------
+static void DecodeBC1_(FBlockTexels_* dst, const u8* src, bool forceFourColors) NOEXCEPT {
+    const u16 c0 = static_cast<u16>(src[0] | (src[1] << 8));
+    const u16 c1 = static_cast<u16>(src[2] | (src[3] << 8));
+
+    u32 rgb[4][4];
+    ExpandRGB565_(reinterpret_cast<u32(&)[3]>(rgb[0]), c0);
+    ExpandRGB565_(reinterpret_cast<u32(&)[3]>(rgb[1]), c1);
+    rgb[0][3] = rgb[1][3] = rgb[2][3] = 0xFF;
+
+    if (c0 > c1 || forceFourColors) {
+        forrange(c, 0, 3) {
+            rgb[2][c] = (2 * rgb[0][c] + rgb[1][c] + 1) / 3;
+            rgb[3][c] = (rgb[0][c] + 2 * rgb[1][c] + 1) / 3;
+        }
+        rgb[3][3] = 0xFF;
+    }
+    else {
+        forrange(c, 0, 3) {
+            rgb[2][c] = (rgb[0][c] + rgb[1][c]) / 2;
+            rgb[3][c] = 0;
+        }
+        rgb[3][3] = 0; // transparent black, alpha is ignored by opaque formats
+    }
+
+    const u32 indices = (src[4] | (src[5] << 8) | (src[6] << 16) | (static_cast<u32>(src[7]) << 24));
+    forrange(t, 0, NumTexels_) {
+        const u32 index = ((indices >> (2 * t)) & 3);
+        forrange(c, 0, 4)
+            dst->Rgba[t][c] = static_cast<u8>(rgb[index][c]);
+    }
+}
+//----------------------------------------------------------------------------
+static void DecodeBC4_(FBlockTexels_* dst, const u8* src, u32 channel, bool bSigned) NOEXCEPT {
+    const i32 a0 = (bSigned ? Max(-127, static_cast<i32>(static_cast<i8>(src[0]))) : src[0]);
+    const i32 a1 = (bSigned ? Max(-127, static_cast<i32>(static_cast<i8>(src[1]))) : src[1]);
+
+    FBC4Palette_ palette;
+    PaletteBC4_(&palette, a0, a1, bSigned);
+
+    u64 bits = 0;
+    forrange(i, 0, 6)
+        bits |= static_cast<u64>(src[2 + i]) << (8 * i);
+
+    forrange(t, 0, NumTexels_) {
+        const u8 code = palette.Codes[(bits >> (3 * t)) & 7];
+        dst->Rgba[t][channel] = (bSigned ? SNormToUNorm_(static_cast<i32>(code) - 128) : code);
+    }
+}
+//----------------------------------------------------------------------------
+// Images
+//----------------------------------------------------------------------------
+// two channels targets (BC5) only encode R and G: luminance+alpha is stored as RG
+static void ReadTexel_(u8 (&rgba)[4], const u8* src, ETextureSourceFormat format, bool bTwoChannels) NOEXCEPT {
+    switch (format) {
+    case ETextureSourceFormat::G8:
+        rgba[0] = rgba[1] = rgba[2] = src[0];
+        rgba[3] = 0xFF;
+        break;
+    case ETextureSourceFormat::RA8:
+        if (bTwoChannels) {
+            rgba[0] = src[0];
+            rgba[1] = src[1];
+            rgba[2] = 0;
+            rgba[3] = 0xFF;
+        }
+        else {
+            rgba[0] = rgba[1] = rgba[2] = src[0];
+            rgba[3] = src[1];
+        }
+        break;
+    case ETextureSourceFormat::RG8:
+        rgba[0] = src[0];
+        rgba[1] = src[1];
+        rgba[2] = 0;
+        rgba[3] = 0xFF;
+        break;
+    case ETextureSourceFormat::RGBA8:
+        FPlatformMemory::Memcpy(rgba, src, 4);
+        break;
+    case ETextureSourceFormat::BGRA8:
+        rgba[0] = src[2];
+        rgba[1] = src[1];
+        rgba[2] = src[0];
+        rgba[3] = src[3];
+        break;
+    default:
+        AssertNotReached();
+    }
+}
+//----------------------------------------------------------------------------
+static void LoadBlock_(FBlockTexels_* dst, const FBlockEncoder::FTile& tile, u32 bx, u32 by, bool bTwoChannels) NOEXCEPT {
+    const u32 bytesPerPixel = ETextureSourceFormat_BytesPerPixel(tile.SourceFormat);
+    const size_t rowPitch = (static_cast<size_t>(bytesPerPixel) * tile.Dimensions.x);
+
+    forrange(y, 0, FBlockEncoder::BlockDim) {
+        const u32 sy = Min(by * FBlockEncoder::BlockDim + y, tile.Dimensions.y - 1);
+        const u8* const row = (tile.Source.data() + sy * rowPitch);
+        forrange(x, 0, FBlockEncoder::BlockDim) {
+            const u32 sx = Min(bx * FBlockEncoder::BlockDim + x, tile.Dimensions.x - 1);
+            ReadTexel_(dst->Rgba[y * FBlockEncoder::BlockDim + x], row + sx * bytesPerPixel, tile.SourceFormat, bTwoChannels);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+bool FBlockEncoder::SupportsFormat(RHI::EPixelFormat format) NOEXCEPT {
+    switch (format) {
+    case RHI::EPixelFormat::BC1_RGB8_UNorm:
+    case RHI::EPixelFormat::BC1_sRGB8:
+    case RHI::EPixelFormat::BC3_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC3_sRGB8_A8:
+    case RHI::EPixelFormat::BC4_R8_UNorm:
+    case RHI::EPixelFormat::BC4_R8_SNorm:
+    case RHI::EPixelFormat::BC5_RG8_UNorm:
+    case RHI::EPixelFormat::BC5_RG8_SNorm:
+    case RHI::EPixelFormat::BC7_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC7_sRGB8_A8:
+        return true;
+    default:
+        return false;
+    }
+}
+//----------------------------------------------------------------------------
+bool FBlockEncoder::SupportsSourceFormat(ETextureSourceFormat format) NOEXCEPT {
+    return (format > ETextureSourceFormat::Unknown && format < ETextureSourceFormat::_Last &&
+            ETextureSourceCompression_IsNorm8(format) );
+}
+//----------------------------------------------------------------------------
+u32 FBlockEncoder::BlockSizeInBytes(RHI::EPixelFormat format) NOEXCEPT {
+    switch (format) {
+    case RHI::EPixelFormat::BC1_RGB8_UNorm:
+    case RHI::EPixelFormat::BC1_sRGB8:
+    case RHI::EPixelFormat::BC4_R8_UNorm:
+    case RHI::EPixelFormat::BC4_R8_SNorm:
+        return 8;
+    case RHI::EPixelFormat::BC3_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC3_sRGB8_A8:
+    case RHI::EPixelFormat::BC5_RG8_UNorm:
+    case RHI::EPixelFormat::BC5_RG8_SNorm:
+    case RHI::EPixelFormat::BC7_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC7_sRGB8_A8:
+        return 16;
+    default:
+        AssertNotReached();
+        return 0;
+    }
+}
+//----------------------------------------------------------------------------
+uint2 FBlockEncoder::NumBlocks(const uint2& dimensions) NOEXCEPT {
+    return IntDivCeil(dimensions, uint2(BlockDim));
+}
+//----------------------------------------------------------------------------
+size_t FBlockEncoder::SizeInBytes(RHI::EPixelFormat format, const uint2& dimensions) NOEXCEPT {
+    const uint2 numBlocks = NumBlocks(dimensions);
+    return (static_cast<size_t>(numBlocks.x) * numBlocks.y * BlockSizeInBytes(format));
+}
+//----------------------------------------------------------------------------
+void FBlockEncoder::EncodeBlock(RHI::EPixelFormat format, u8* dst, const FBlockTexels& src, ETextureCompressionQuality quality) NOEXCEPT {
+    Assert(dst);
+
+    switch (format) {
+    case RHI::EPixelFormat::BC1_RGB8_UNorm:
+    case RHI::EPixelFormat::BC1_sRGB8:
+        EncodeBC1_(dst, src, quality);
+        break;
+    case RHI::EPixelFormat::BC3_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC3_sRGB8_A8:
+        EncodeBC4_(dst, src, 3, false, quality);
+        EncodeBC1_(dst + 8, src, quality);
+        break;
+    case RHI::EPixelFormat::BC4_R8_UNorm:
+        EncodeBC4_(dst, src, 0, false, quality);
+        break;
+    case RHI::EPixelFormat::BC4_R8_SNorm:
+        EncodeBC4_(dst, src, 0, true, quality);
+        break;
+    case RHI::EPixelFormat::BC5_RG8_UNorm:
+        EncodeBC4_(dst, src, 0, false, quality);
+        EncodeBC4_(dst + 8, src, 1, false, quality);
+        break;
+    case RHI::EPixelFormat::BC5_RG8_SNorm:
+        EncodeBC4_(dst, src, 0, true, quality);
+        EncodeBC4_(dst + 8, src, 1, true, quality);
+        break;
+    case RHI::EPixelFormat::BC7_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC7_sRGB8_A8:
+        EncodeBC7_(dst, src, quality);
+        break;
+    default:
+        AssertNotImplemented();
+    }
+}
+//----------------------------------------------------------------------------
+void FBlockEncoder::DecodeBlock(RHI::EPixelFormat format, FBlockTexels* dst, const u8* src) NOEXCEPT {
+    Assert(dst);
+    Assert(src);
+
+    switch (format) {
+    case RHI::EPixelFormat::BC1_RGB8_UNorm:
+    case RHI::EPixelFormat::BC1_sRGB8:
+        DecodeBC1_(dst, src, false);
+        forrange(t, 0, TexelsPerBlock)
+            dst->Rgba[t][3] = 0xFF;
+        break;
+    case RHI::EPixelFormat::BC3_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC3_sRGB8_A8:
+        DecodeBC1_(dst, src + 8, true);
+        DecodeBC4_(dst, src, 3, false);
+        break;
+    case RHI::EPixelFormat::BC4_R8_UNorm:
+    case RHI::EPixelFormat::BC4_R8_SNorm:
+        forrange(t, 0, TexelsPerBlock) {
+            dst->Rgba[t][1] = dst->Rgba[t][2] = 0;
+            dst->Rgba[t][3] = 0xFF;
+        }
+        DecodeBC4_(dst, src, 0, format == RHI::EPixelFormat::BC4_R8_SNorm);
+        break;
+    case RHI::EPixelFormat::BC5_RG8_UNorm:
+    case RHI::EPixelFormat::BC5_RG8_SNorm:
+        forrange(t, 0, TexelsPerBlock) {
+            dst->Rgba[t][2] = 0;
+            dst->Rgba[t][3] = 0xFF;
+        }
+        DecodeBC4_(dst, src, 0, format == RHI::EPixelFormat::BC5_RG8_SNorm);
+        DecodeBC4_(dst, src + 8, 1, format == RHI::EPixelFormat::BC5_RG8_SNorm);
+        break;
+    case RHI::EPixelFormat::BC7_RGBA8_UNorm:
+    case RHI::EPixelFormat::BC7_sRGB8_A8:
+        DecodeBC7_(dst, src);
+        break;
+    default:
+        AssertNotImplemented();
+    }
+}
+//----------------------------------------------------------------------------
+void FBlockEncoder::EncodeTile(RHI::EPixelFormat format, const FTile& tile, ETextureCompressionQuality quality) NOEXCEPT {
+    const u32 blockSize = BlockSizeInBytes(format);
+    const uint2 numBlocks = NumBlocks(tile.Dimensions);
+    const size_t dstRowPitch = (static_cast<size_t>(numBlocks.x) * blockSize);
+    Assert(tile.LastBlockRow <= numBlocks.y);
+    Assert_NoAssume(tile.Dest.SizeInBytes() == dstRowPitch * numBlocks.y);
+
+    const bool bTwoChannels = (
+        format == RHI::EPixelFormat::BC5_RG8_UNorm ||
+        format == RHI::EPixelFormat::BC5_RG8_SNorm );
+
+    FBlockTexels texels;
+    forrange(by, tile.FirstBlockRow, tile.LastBlockRow) {
+        u8* const dstRow = (tile.Dest.data() + by * dstRowPitch);
+        forrange(bx, 0, numBlocks.x) {
+            LoadBlock_(&texels, tile, bx, by, bTwoChannels);
+            EncodeBlock(format, dstRow + bx * blockSize, texels, quality);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void FBlockEncoder::MakeTiles(
+    TAppendable<FTile> outTiles,
+    RHI::EPixelFormat format, const FRawMemory& dst,
+    const uint2& dimensions, ETextureSourceFormat srcFormat, const FRawMemoryConst& src ) {
+    Assert_NoAssume(dst.SizeInBytes() == SizeInBytes(format, dimensions));
+    Assert_NoAssume(src.SizeInBytes() == ETextureSourceFormat_SizeInBytes(srcFormat, uint3{ dimensions, 1 }));
+    Unused(format);
+
+    const uint2 numBlocks = NumBlocks(dimensions);
+    const u32 rowsPerTile = Max(1u, BlocksPerTile / numBlocks.x);
+
+    for (u32 by = 0; by < numBlocks.y; by += rowsPerTile) {
+        FTile tile;
+        tile.Dimensions = dimensions;
+        tile.SourceFormat = srcFormat;
+        tile.Source = src;
+        tile.Dest = dst;
+        tile.FirstBlockRow = by;
+        tile.LastBlockRow = Min(by + rowsPerTile, numBlocks.y);
+        outTiles.push_back(std::move(tile));
+    }
+}
+//----------------------------------------------------------------------------
+bool FBlockEncoder::EncodeImage(
+    RHI::EPixelFormat format, const FRawMemory& dst,
+    const uint2& dimensions, ETextureSourceFormat srcFormat, const FRawMemoryConst& src,
+    ETextureCompressionQuality quality,
+    ITaskContext* context ) {
+    PPE_LOG_CHECK(Texture, SupportsFormat(format));
+    PPE_LOG_CHECK(Texture, SupportsSourceFormat(srcFormat));
+    PPE_LOG_CHECK(Texture, dimensions.x > 0 && dimensions.y > 0);
+    PPE_LOG_CHECK(Texture, dst.SizeInBytes() == SizeInBytes(format, dimensions));
+    PPE_LOG_CHECK(Texture, src.SizeInBytes() == ETextureSourceFormat_SizeInBytes(srcFormat, uint3{ dimensions, 1 }));
+
+    VECTOR(Texture, FTile) tiles;
+    MakeTiles(MakeAppendable(tiles), format, dst, dimensions, srcFormat, src);
+
+    ParallelFor(0, tiles.size(), [&](size_t i) {
+        EncodeTile(format, tiles[i], quality);
+    },  ETaskPriority::Normal, context);
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FBlockEncoder::DecodeImage(
+    RHI::EPixelFormat format, const FRawMemory& dst,
+    const uint2& dimensions, const FRawMemoryConst& src ) {
+    PPE_LOG_CHECK(Texture, SupportsFormat(format));
+    PPE_LOG_CHECK(Texture, dimensions.x > 0 && dimensions.y > 0);
+    PPE_LOG_CHECK(Texture, dst.SizeInBytes() == static_cast<size_t>(dimensions.x) * dimensions.y * 4);
+    PPE_LOG_CHECK(Texture, src.SizeInBytes() == SizeInBytes(format, dimensions));
+
+    const u32 blockSize = BlockSizeInBytes(format);
+    const uint2 numBlocks = NumBlocks(dimensions);
+
+    FBlockTexels texels;
+    forrange(by, 0, numBlocks.y) {
+        forrange(bx, 0, numBlocks.x) {
+            DecodeBlock(format, &texels, src.data() + (static_cast<size_t>(by) * numBlocks.x + bx) * blockSize);
+
+            forrange(y, 0, BlockDim) {
+                const u32 dy = (by * BlockDim + y);
+                if (dy >= dimensions.y)
+                    break;
+                forrange(x, 0, BlockDim) {
+                    const u32 dx = (bx * BlockDim + x);
+                    if (dx >= dimensions.x)
+                        break;
+                    FPlatformMemory::Memcpy(dst.data() + (static_cast<size_t>(dy) * dimensions.x + dx) * 4, texels.Rgba[y * BlockDim + x], 4);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
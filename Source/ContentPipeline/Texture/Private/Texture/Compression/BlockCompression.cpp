@@ -0,0 +1,320 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Texture/Compression/BlockCompression.h"
+
+#include "Texture/BlockEncoder.h"
+#include "Texture/TextureEnums.h"
+#include "Texture/Texture.h"
+#include "Texture/Texture2D.h"
+#include "Texture/Texture2DArray.h"
+#include "Texture/Texture3D.h"
+#include "Texture/TextureCube.h"
+#include "Texture/TextureCubeArray.h"
+#include "Texture/TextureSource.h"
+
+#include "RHI/PixelFormatHelpers.h"
+#include "RHI/ResourceEnums.h"
+#include "RHI/RenderStateEnums.h"
+
+#include "Container/Appendable.h"
+#include "Container/Vector.h"
+#include "Diagnostic/Logger.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Thread/Task.h"
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+static ETextureAddressMode BlockCompression_AddressMode(const FTextureSource& src) NOEXCEPT {
+    if (src.IsTilable())
+        return ETextureAddressMode::Repeat;
+    else
+        return ETextureAddressMode::Unknown;
+}
+//----------------------------------------------------------------------------
+static bool BlockCompression_SupportsImageView(RHI::EImageView view) NOEXCEPT {
+    switch (view) {
+    case RHI::EImageView::_1D:
+        FALLTHROUGH();
+    case RHI::EImageView::_1DArray:
+        return false;
+
+    case RHI::EImageView::_2D:
+        FALLTHROUGH();
+    case RHI::EImageView::_2DArray:
+        FALLTHROUGH();
+    case RHI::EImageView::_3D:
+        FALLTHROUGH();
+    case RHI::EImageView::_Cube:
+        FALLTHROUGH();
+    case RHI::EImageView::_CubeArray:
+        return true;
+
+    case RHI::EImageView::Unknown:
+        AssertNotImplemented();
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+static bool BlockCompression_SupportsSource(RHI::EPixelFormat dst, const FTextureSourceProperties& src, const FTextureCompressionSettings& settings) NOEXCEPT {
+    Unused(settings);
+    Assert_NoAssume(FBlockEncoder::SupportsFormat(dst));
+
+    // check image dimensions (2D vs 3D vs Cube vs *Array)
+    if (not BlockCompression_SupportsImageView(src.ImageView))
+        return false;
+
+    // check component type
+    if (not FBlockEncoder::SupportsSourceFormat(src.Format))
+        return false;
+
+    // check number of channels
+    const RHI::FPixelFormatInfo dstInfo = EPixelFormat_Infos(dst);
+    const u32 srcChannels = Min(ETextureSourceFormat_Components(src.Format), EColorMask_NumChannels(src.ColorMask));
+    if (dstInfo.Channels != srcChannels) {
+        // BC7 also handles opaque sources, with modes tuned for opaque blocks
+        if (dstInfo.Channels != 4 || srcChannels != 3 ||
+            (dst != RHI::EPixelFormat::BC7_RGBA8_UNorm && dst != RHI::EPixelFormat::BC7_sRGB8_A8))
+            return false;
+    }
+
+    // check color space
+    switch (src.Gamma) {
+    /** No gamma correction is applied to this space, the incoming colors are assumed to already be in linear space. */
+    case ETextureGammaSpace::Linear:
+        if (dstInfo.ValueType.Flags ^ RHI::EPixelValueType::sRGB)
+            return false;
+        break;
+    /** A simplified sRGB gamma correction is applied, pow(1/2.2). */
+    case ETextureGammaSpace::Pow22:
+        FALLTHROUGH();
+    /** Use the standard sRGB conversion. */
+    case ETextureGammaSpace::sRGB:
+        if (not (dstInfo.ValueType.Flags ^ RHI::EPixelValueType::sRGB))
+            return false;
+        break;
+    /** Use the new ACES standard for HDR values. */
+    case ETextureGammaSpace::ACES:
+        return false; // need BC6h
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+static bool BlockCompression_CompressTextureData(
+    FBulkData* outBulk,
+    FTextureProperties* outProperties,
+    const FTextureSource& src,
+    const FTextureCompressionSettings& settings) {
+    PPE_LOG_CHECK(Texture, BlockCompression_SupportsSource(_PixelFormat, src.Properties(), settings));
+
+    const RHI::FPixelFormatInfo pixelInfo = RHI::EPixelFormat_Infos(_PixelFormat);
+    Assert(pixelInfo.BlockDim == uint2(FBlockEncoder::BlockDim));
+
+    outProperties->Format = _PixelFormat;
+    outProperties->Gamma = src.Gamma();
+    outProperties->ImageView = src.ImageView();
+    outProperties->NumMips = checked_cast<u8>(Min(src.NumMips(), pixelInfo.FullMipCount(src.Dimensions())));
+
+    outBulk->AttachSourceFile(src.Data().SourceFile());
+    outBulk->Resize_DiscardData(pixelInfo.SizeInBytes(
+        RHI::EImageAspect::Color,
+        src.Dimensions(),
+        outProperties->NumMips,
+        src.NumSlices()));
+
+    FUniqueBuffer exclusiveDst = outBulk->LockWrite();
+    DEFERRED{ outBulk->UnlockWrite(std::move(exclusiveDst)); };
+    FRawMemory dstData = exclusiveDst.MakeView();
+    const size_t dstSlicePitch = pixelInfo.SlicePitch(RHI::EImageAspect::Color, src.Dimensions(), outProperties->NumMips);
+
+    const FTextureSource::FReaderScope sharedSrc{ src };
+    FRawMemoryConst srcData = sharedSrc.MakeView();
+    const size_t srcSlicePitch = ETextureSourceFormat_SizeInBytes(src.Format(), src.Dimensions(), src.NumMips());
+
+    // gather the tiles of all slices and mips first, so small mips don't end up in tiny tasks
+    VECTOR(Texture, FBlockEncoder::FTile) tiles;
+    const TAppendable<FBlockEncoder::FTile> appendTiles = MakeAppendable(tiles);
+
+    forrange(slice, 0, src.NumSlices()) {
+        FRawMemory sliceDst = dstData.Eat(dstSlicePitch);
+        FRawMemoryConst sliceSrc = srcData.Eat(srcSlicePitch);
+
+        uint3 mipDimensions = src.Dimensions();
+        forrange(mip, 0, u32(outProperties->NumMips)) {
+            FRawMemory mipDst = sliceDst.Eat(pixelInfo.SizeInBytes(RHI::EImageAspect::Color, mipDimensions));
+            FRawMemoryConst mipSrc = sliceSrc.Eat(ETextureSourceFormat_SizeInBytes(src.Format(), mipDimensions));
+
+            // each depth layer of a 3D texture is compressed as a 2D image
+            const size_t dstLayerSize = FBlockEncoder::SizeInBytes(_PixelFormat, mipDimensions.xy);
+            const size_t srcLayerSize = ETextureSourceFormat_SizeInBytes(src.Format(), uint3(mipDimensions.xy, 1));
+            Assert_NoAssume(mipDst.SizeInBytes() == dstLayerSize * mipDimensions.z);
+            Assert_NoAssume(mipSrc.SizeInBytes() == srcLayerSize * mipDimensions.z);
+
+            forrange(layer, 0, mipDimensions.z) {
+                FBlockEncoder::MakeTiles(appendTiles, _PixelFormat,
+                    mipDst.Eat(dstLayerSize), mipDimensions.xy,
+                    src.Format(), mipSrc.Eat(srcLayerSize) );
+            }
+
+            Assert_NoAssume(mipDst.empty());
+            Assert_NoAssume(mipSrc.empty());
+            mipDimensions = RHI::FPixelFormatInfo::NextMipDimensions(mipDimensions);
+        }
+
+        Assert_NoAssume(sliceDst.empty());
+    }
+
+    Assert_NoAssume(dstData.empty());
+    Assert_NoAssume(srcData.empty());
+
+    VECTOR(Texture, FTaskFunc) tasks;
+    tasks.reserve(tiles.size());
+
+    const ETextureCompressionQuality quality = settings.Quality;
+    for (const FBlockEncoder::FTile& tile : tiles) {
+        tasks.emplace_back([&tile, quality](ITaskContext&) {
+            FBlockEncoder::EncodeTile(_PixelFormat, tile, quality);
+        });
+    }
+
+    FGlobalThreadPool::Get().RunAndWaitFor(tasks);
+    return true;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+bool TBlockCompression<_PixelFormat>::SupportsTextureSource(const FTextureSourceProperties& src, const FTextureCompressionSettings& settings) const NOEXCEPT {
+    if (BlockCompression_SupportsSource(_PixelFormat, src, settings)) {
+        switch (src.ImageView) {
+        case RHI::EImageView::_1D:
+            FALLTHROUGH();
+        case RHI::EImageView::_1DArray:
+            return false;
+
+        case RHI::EImageView::_2D:
+            FALLTHROUGH();
+        case RHI::EImageView::_2DArray:
+            FALLTHROUGH();
+        case RHI::EImageView::_3D:
+            FALLTHROUGH();
+        case RHI::EImageView::_Cube:
+            FALLTHROUGH();
+        case RHI::EImageView::_CubeArray:
+            break;
+
+        case RHI::EImageView::Unknown:
+            AssertNotImplemented();
+        }
+
+        return true;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+bool TBlockCompression<_PixelFormat>::CompressTexture(FTexture2D& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const {
+    PPE_LOG_CHECK(Texture, src.ImageView() == RHI::EImageView_2D);
+
+    FBulkData textureData;
+    FTextureProperties textureProperties;
+    if (BlockCompression_CompressTextureData<_PixelFormat>(&textureData, &textureProperties, src, settings)) {
+        const ETextureAddressMode addressMode = BlockCompression_AddressMode(src);
+        dst = FTexture2D(src.Dimensions().xy, textureProperties, std::move(textureData), addressMode, addressMode);
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+bool TBlockCompression<_PixelFormat>::CompressTexture(FTexture2DArray& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const {
+    PPE_LOG_CHECK(Texture, src.ImageView() == RHI::EImageView_2DArray);
+
+    FBulkData textureData;
+    FTextureProperties textureProperties;
+    if (BlockCompression_CompressTextureData<_PixelFormat>(&textureData, &textureProperties, src, settings)) {
+        const ETextureAddressMode addressMode = BlockCompression_AddressMode(src);
+        dst = FTexture2DArray(src.Dimensions().xy, src.NumSlices(), textureProperties, std::move(textureData), addressMode, addressMode);
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+bool TBlockCompression<_PixelFormat>::CompressTexture(FTexture3D& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const {
+    PPE_LOG_CHECK(Texture, src.ImageView() == RHI::EImageView_3D);
+
+    FBulkData textureData;
+    FTextureProperties textureProperties;
+    if (BlockCompression_CompressTextureData<_PixelFormat>(&textureData, &textureProperties, src, settings)) {
+        const ETextureAddressMode addressMode = BlockCompression_AddressMode(src);
+        dst = FTexture3D(src.Dimensions(), textureProperties, std::move(textureData), addressMode, addressMode, addressMode);
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+bool TBlockCompression<_PixelFormat>::CompressTexture(FTextureCube& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const {
+    PPE_LOG_CHECK(Texture, src.ImageView() == RHI::EImageView_Cube);
+
+    FBulkData textureData;
+    FTextureProperties textureProperties;
+    if (BlockCompression_CompressTextureData<_PixelFormat>(&textureData, &textureProperties, src, settings)) {
+        const ETextureAddressMode addressMode = BlockCompression_AddressMode(src);
+        dst = FTextureCube(src.Dimensions().xy, textureProperties, std::move(textureData), addressMode, addressMode);
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+bool TBlockCompression<_PixelFormat>::CompressTexture(FTextureCubeArray& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const {
+    PPE_LOG_CHECK(Texture, src.ImageView() == RHI::EImageView_CubeArray);
+
+    FBulkData textureData;
+    FTextureProperties textureProperties;
+    if (BlockCompression_CompressTextureData<_PixelFormat>(&textureData, &textureProperties, src, settings)) {
+        const ETextureAddressMode addressMode = BlockCompression_AddressMode(src);
+        dst = FTextureCubeArray(src.Dimensions().xy, src.NumSlices(), textureProperties, std::move(textureData), addressMode, addressMode);
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+#define PPE_BLOCK_COMPRESSION_DEF(_PIXEL_FORMAT) \
+    template class TBlockCompression<RHI::EPixelFormat::_PIXEL_FORMAT>;
+//----------------------------------------------------------------------------
+PPE_BLOCK_COMPRESSION_DEF(BC1_RGB8_UNorm     )
+PPE_BLOCK_COMPRESSION_DEF(BC1_sRGB8          )
+PPE_BLOCK_COMPRESSION_DEF(BC3_RGBA8_UNorm    )
+PPE_BLOCK_COMPRESSION_DEF(BC3_sRGB8_A8       )
+PPE_BLOCK_COMPRESSION_DEF(BC4_R8_UNorm       )
+PPE_BLOCK_COMPRESSION_DEF(BC4_R8_SNorm       )
+PPE_BLOCK_COMPRESSION_DEF(BC5_RG8_UNorm      )
+PPE_BLOCK_COMPRESSION_DEF(BC5_RG8_SNorm      )
+PPE_BLOCK_COMPRESSION_DEF(BC7_RGBA8_UNorm    )
+PPE_BLOCK_COMPRESSION_DEF(BC7_sRGB8_A8       )
+//----------------------------------------------------------------------------
+#undef PPE_BLOCK_COMPRESSION_DEF
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
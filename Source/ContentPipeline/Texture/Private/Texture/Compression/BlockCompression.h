@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "Texture_fwd.h"
+
+#include "Texture/TextureCompression.h"
+
+#include "RHI/ResourceEnums.h"
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Block compression with FBlockEncoder, the tiles of every slice and mip are encoded in parallel
+//----------------------------------------------------------------------------
+template <RHI::EPixelFormat _PixelFormat>
+class TBlockCompression final : public ITextureCompression {
+public:
+    NODISCARD virtual RHI::EPixelFormat Format() const NOEXCEPT override { return _PixelFormat; }
+    NODISCARD virtual i32 Priority() const NOEXCEPT override { return 1; } // preferred to stb_dxt
+
+    NODISCARD virtual bool SupportsTextureSource(const FTextureSourceProperties& src, const FTextureCompressionSettings& settings) const NOEXCEPT override;
+
+    NODISCARD virtual bool CompressTexture(FTexture2D& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const override;
+    NODISCARD virtual bool CompressTexture(FTexture2DArray& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const override;
+    NODISCARD virtual bool CompressTexture(FTexture3D& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const override;
+    NODISCARD virtual bool CompressTexture(FTextureCube& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const override;
+    NODISCARD virtual bool CompressTexture(FTextureCubeArray& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const override;
+};
+//----------------------------------------------------------------------------
+// Template instantiations
+//----------------------------------------------------------------------------
+#define PPE_BLOCK_COMPRESSION_DECL(_PIXEL_FORMAT) \
+    extern template class TBlockCompression<RHI::EPixelFormat::_PIXEL_FORMAT>; \
+    using CONCAT(FBlockCompression_, _PIXEL_FORMAT) = TBlockCompression<RHI::EPixelFormat::_PIXEL_FORMAT>;
+//----------------------------------------------------------------------------
+PPE_BLOCK_COMPRESSION_DECL(BC1_RGB8_UNorm     )
+PPE_BLOCK_COMPRESSION_DECL(BC1_sRGB8          )
+PPE_BLOCK_COMPRESSION_DECL(BC3_RGBA8_UNorm    )
+PPE_BLOCK_COMPRESSION_DECL(BC3_sRGB8_A8       )
+PPE_BLOCK_COMPRESSION_DECL(BC4_R8_UNorm       )
+PPE_BLOCK_COMPRESSION_DECL(BC4_R8_SNorm       )
+PPE_BLOCK_COMPRESSION_DECL(BC5_RG8_UNorm      )
+PPE_BLOCK_COMPRESSION_DECL(BC5_RG8_SNorm      )
+PPE_BLOCK_COMPRESSION_DECL(BC7_RGBA8_UNorm    )
+PPE_BLOCK_COMPRESSION_DECL(BC7_sRGB8_A8       )
+//----------------------------------------------------------------------------
+#undef PPE_BLOCK_COMPRESSION_DECL
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -0,0 +1,738 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Texture/ImageResampler.h"
+
+#include "Color/Color.h"
+#include "Diagnostic/Logger.h"
+#include "HAL/PlatformMemory.h"
+#include "Maths/MathHelpers.h"
+#include "Maths/PackingHelpers.h"
+#include "Maths/SSEHelpers.h"
+#include "Maths/WideMaths.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/Task/TaskContext.h"
+#include "Thread/Task/TaskHelpers.h"
+
+// https://www.cs.utexas.edu/~fussell/courses/cs384g-fall2013/lectures/mitchell/Mitchell.pdf (cubic filters)
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+CONSTEXPR float KernelEpsilon_ = 1e-6f;
+CONSTEXPR u32 CodecRowsPerTask_ = 32;
+CONSTEXPR u32 SRGB8TableSize_ = 8192;
+//----------------------------------------------------------------------------
+// Kernels
+//----------------------------------------------------------------------------
+NODISCARD static float MitchellNetrevalli_(float x, float B, float C) NOEXCEPT {
+    x = Abs(x);
+    if (x < 1.f)
+        return ((((12.f - 9.f * B - 6.f * C) * x + (-18.f + 12.f * B + 6.f * C)) * x) * x + (6.f - 2.f * B)) / 6.f;
+    if (x < 2.f)
+        return ((((-B - 6.f * C) * x + (6.f * B + 30.f * C)) * x + (-12.f * B - 48.f * C)) * x + (8.f * B + 24.f * C)) / 6.f;
+    return 0.f;
+}
+//----------------------------------------------------------------------------
+NODISCARD static CONSTEXPR float FilterRadius_(EImageResampleFilter filter) NOEXCEPT {
+    switch (filter) {
+    case EImageResampleFilter::Box: return 0.5f;
+    case EImageResampleFilter::CubicBSpline: return 2.f;
+    case EImageResampleFilter::CatmullRom: return 2.f;
+    case EImageResampleFilter::MitchellNetrevalli: return 2.f;
+    case EImageResampleFilter::PointSample: return 0.5f;
+    }
+    AssertNotReached();
+    return 0.f;
+}
+//----------------------------------------------------------------------------
+// x is the distance to the center of the footprint in source texels, footprint >= 1 when downsampling
+NODISCARD static float FilterWeight_(EImageResampleFilter filter, float x, float footprint) NOEXCEPT {
+    switch (filter) {
+    case EImageResampleFilter::Box: {
+        // coverage of the texel [x-0.5,x+0.5] by the footprint: trapezoid with 1-texel ramps
+        const float halfWidth = 0.5f * footprint;
+        return Max(0.f, Min(x + 0.5f, halfWidth) - Max(x - 0.5f, -halfWidth));
+    }
+    case EImageResampleFilter::CubicBSpline: return MitchellNetrevalli_(x / footprint, 1.f, 0.f);
+    case EImageResampleFilter::CatmullRom: return MitchellNetrevalli_(x / footprint, 0.f, 0.5f);
+    case EImageResampleFilter::MitchellNetrevalli: return MitchellNetrevalli_(x / footprint, 1.f / 3.f, 1.f / 3.f);
+    case EImageResampleFilter::PointSample: break;
+    }
+    AssertNotReached();
+    return 0.f;
+}
+//----------------------------------------------------------------------------
+static void BuildAxisKernel_(FImageResampler::FAxisKernel* kernel, u32 srcSize, u32 dstSize, EImageResampleFilter filter) {
+    Assert(kernel);
+    Assert(srcSize > 0);
+    Assert(dstSize > 0);
+
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    const float footprint = Max(1.f, scale); // widen the filter when downsampling
+    const float support = FilterRadius_(filter) * footprint;
+    const u32 maxTaps = (filter == EImageResampleFilter::PointSample ? 1 : checked_cast<u32>(CeilToInt(2.f * support)) + 4);
+
+    // first pass with the worst case number of taps, trimmed and compacted below
+    VECTOR(Texture, float) weights;
+    weights.resize_Uninitialized(dstSize * maxTaps);
+    Broadcast(weights.MakeView(), 0.f);
+
+    kernel->First.clear();
+    kernel->First.resize_Uninitialized(dstSize);
+
+    u32 numTaps = 1;
+    forrange(i, 0, dstSize) {
+        float* const w = &weights[i * maxTaps];
+
+        if (filter == EImageResampleFilter::PointSample) {
+            kernel->First[i] = Min(FloorToInt((i + 0.5f) * scale), static_cast<int>(srcSize) - 1);
+            w[0] = 1.f;
+            continue;
+        }
+
+        const float center = (i + 0.5f) * scale - 0.5f;
+        const i32 lo = FloorToInt(center - support - 0.5f);
+        const i32 hi = CeilToInt(center + support + 0.5f);
+        Assert_NoAssume(hi - lo < static_cast<i32>(maxTaps));
+
+        i32 first = hi + 1, last = lo - 1;
+        float sum = 0.f;
+        for (i32 j = lo; j <= hi; ++j) {
+            const float wj = FilterWeight_(filter, static_cast<float>(j) - center, footprint);
+            if (Abs(wj) < KernelEpsilon_)
+                continue;
+
+            first = Min(first, j);
+            last = Max(last, j);
+            w[j - lo] = wj;
+            sum += wj;
+        }
+
+        if (first > last || Abs(sum) < KernelEpsilon_) {
+            // degenerated footprint: fall back to the nearest texel
+            Broadcast(MakeView(w, w + maxTaps), 0.f);
+            kernel->First[i] = Clamp(RoundToInt(center), 0, static_cast<int>(srcSize) - 1);
+            w[0] = 1.f;
+            continue;
+        }
+
+        // normalize and shift the taps to the front
+        const float rcpSum = 1.f / sum;
+        const u32 count = checked_cast<u32>(last - first + 1);
+        forrange(t, 0, count)
+            w[t] = w[first - lo + t] * rcpSum;
+        forrange(t, count, maxTaps)
+            w[t] = 0.f;
+
+        kernel->First[i] = first;
+        numTaps = Max(numTaps, count);
+    }
+
+    kernel->NumTaps = numTaps;
+    kernel->Weights.clear();
+    kernel->Weights.resize_Uninitialized(dstSize * numTaps);
+    kernel->BorderBefore = kernel->BorderAfter = 0;
+
+    forrange(i, 0, dstSize) {
+        FPlatformMemory::Memcpy(&kernel->Weights[i * numTaps], &weights[i * maxTaps], numTaps * sizeof(float));
+
+        const i32 first = kernel->First[i];
+        const i32 after = first + static_cast<i32>(numTaps) - static_cast<i32>(srcSize);
+        kernel->BorderBefore = Max(kernel->BorderBefore, checked_cast<u32>(Max(0, -first)));
+        kernel->BorderAfter = Max(kernel->BorderAfter, checked_cast<u32>(Max(0, after)));
+    }
+}
+//----------------------------------------------------------------------------
+NODISCARD FORCE_INLINE static u32 ResolveEdge_(i32 index, u32 size, bool bWrap) NOEXCEPT {
+    const i32 n = static_cast<i32>(size);
+    if (bWrap)
+        return static_cast<u32>(((index % n) + n) % n);
+    return static_cast<u32>(Clamp(index, 0, n - 1));
+}
+//----------------------------------------------------------------------------
+// Codecs
+//----------------------------------------------------------------------------
+NODISCARD static CONSTEXPR bool HasAlphaChannel_(ETextureSourceFormat format) NOEXCEPT {
+    switch (format) {
+    case ETextureSourceFormat::BGRA8:
+    case ETextureSourceFormat::RA16:
+    case ETextureSourceFormat::RA8:
+    case ETextureSourceFormat::RGBA16:
+    case ETextureSourceFormat::RGBA16f:
+    case ETextureSourceFormat::RGBA32f:
+    case ETextureSourceFormat::RGBA8:
+        return true;
+    default:
+        return false;
+    }
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool IsAlphaWeighted_(const FImageResampleLayout& layout) NOEXCEPT {
+    return (HasAlphaChannel_(layout.Format) && not (layout.Flags & ETextureSourceFlags::PreMultipliedAlpha));
+}
+//----------------------------------------------------------------------------
+// only 8 bits formats are stored with sRGB gamma, like stb_image_resize2 did
+NODISCARD static bool IsSRGB8_(const FImageResampleLayout& layout) NOEXCEPT {
+    return (layout.Gamma == ETextureGammaSpace::sRGB &&
+            ETextureSourceCompression_IsNorm8(layout.Format));
+}
+//----------------------------------------------------------------------------
+// inverse of SRGB_to_Linear(u8), steepest slope is 12.92 so the error stays under 1/4 LSB with 8192 entries
+struct FLinearToSRGB8Table_ {
+    u8 Entries[SRGB8TableSize_ + 1];
+
+    FLinearToSRGB8Table_() NOEXCEPT {
+        forrange(i, 0, SRGB8TableSize_ + 1)
+            Entries[i] = static_cast<u8>(RoundToInt(Saturate(Linear_to_SRGB(static_cast<float>(i) / SRGB8TableSize_)) * 255.f));
+    }
+
+    static const FLinearToSRGB8Table_& Get() NOEXCEPT {
+        static const FLinearToSRGB8Table_ GInstance;
+        return GInstance;
+    }
+
+    FORCE_INLINE u8 operator ()(float linear) const NOEXCEPT {
+        return Entries[static_cast<u32>(Saturate(linear) * SRGB8TableSize_ + 0.5f)];
+    }
+};
+//----------------------------------------------------------------------------
+FORCE_INLINE static ::__m128 LoadUNorm8x4_(const u8* src) NOEXCEPT {
+    i32 packed;
+    FPlatformMemory::Memcpy(&packed, src, sizeof(packed));
+    return ::_mm_mul_ps(
+        ::_mm_cvtepi32_ps(::_mm_cvtepu8_epi32(::_mm_cvtsi32_si128(packed))),
+        ::_mm_set1_ps(1.f / 255.f) );
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static void StoreUNorm8x4_(u8* dst, ::__m128 value) NOEXCEPT {
+    value = ::_mm_min_ps(::_mm_max_ps(value, ::_mm_setzero_ps()), ::_mm_set1_ps(1.f));
+    const ::__m128i i32x4 = ::_mm_cvttps_epi32(::_mm_add_ps(::_mm_mul_ps(value, ::_mm_set1_ps(255.f)), ::_mm_set1_ps(0.5f)));
+    const ::__m128i u16x8 = ::_mm_packus_epi32(i32x4, i32x4);
+    const i32 packed = ::_mm_cvtsi128_si32(::_mm_packus_epi16(u16x8, u16x8));
+    FPlatformMemory::Memcpy(dst, &packed, sizeof(packed));
+}
+//----------------------------------------------------------------------------
+NODISCARD FORCE_INLINE static float UNorm16_(const u8* src) NOEXCEPT {
+    u16 value;
+    FPlatformMemory::Memcpy(&value, src, sizeof(value));
+    return (value * (1.f / 65535.f));
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static void StoreUNorm16_(u8* dst, float value) NOEXCEPT {
+    const u16 packed = static_cast<u16>(Saturate(value) * 65535.f + 0.5f);
+    FPlatformMemory::Memcpy(dst, &packed, sizeof(packed));
+}
+//----------------------------------------------------------------------------
+NODISCARD FORCE_INLINE static float Half_(const u8* src) NOEXCEPT {
+    u16 value;
+    FPlatformMemory::Memcpy(&value, src, sizeof(value));
+    return FP16_to_FP32(value);
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static void StoreHalf_(u8* dst, float value) NOEXCEPT {
+    const u16 packed = FP32_to_FP16(value);
+    FPlatformMemory::Memcpy(dst, &packed, sizeof(packed));
+}
+//----------------------------------------------------------------------------
+static void DecodeRow_(float4* dst, const u8* src, u32 width, const FImageResampleLayout& layout) NOEXCEPT {
+    const bool bSRGB = IsSRGB8_(layout);
+
+    switch (layout.Format) {
+    case ETextureSourceFormat::RGBA8:
+    case ETextureSourceFormat::BGRA8:
+    case ETextureSourceFormat::BGRE8:
+        if (bSRGB && layout.Format != ETextureSourceFormat::BGRE8) {
+            forrange(x, 0, width) {
+                const u8* const texel = src + x * 4;
+                dst[x] = float4(SRGB_to_Linear(texel[0]), SRGB_to_Linear(texel[1]), SRGB_to_Linear(texel[2]), texel[3] / 255.f);
+            }
+        }
+        else {
+            forrange(x, 0, width)
+                ::_mm_storeu_ps(&dst[x].x, LoadUNorm8x4_(src + x * 4));
+        }
+        if (layout.Format == ETextureSourceFormat::BGRA8) {
+            forrange(x, 0, width) {
+                const ::__m128 bgra = ::_mm_loadu_ps(&dst[x].x);
+                ::_mm_storeu_ps(&dst[x].x, ::_mm_shuffle_ps(bgra, bgra, _MM_SHUFFLE(3, 0, 1, 2)));
+            }
+        }
+        break;
+    case ETextureSourceFormat::RA8:
+        forrange(x, 0, width)
+            dst[x] = float4(bSRGB ? SRGB_to_Linear(src[x * 2]) : src[x * 2] / 255.f, 0.f, 0.f, src[x * 2 + 1] / 255.f);
+        break;
+    case ETextureSourceFormat::RG8:
+        forrange(x, 0, width) {
+            dst[x] = (bSRGB
+                ? float4(SRGB_to_Linear(src[x * 2]), SRGB_to_Linear(src[x * 2 + 1]), 0.f, 1.f)
+                : float4(src[x * 2] / 255.f, src[x * 2 + 1] / 255.f, 0.f, 1.f) );
+        }
+        break;
+    case ETextureSourceFormat::G8:
+        forrange(x, 0, width)
+            dst[x] = float4(bSRGB ? SRGB_to_Linear(src[x]) : src[x] / 255.f, 0.f, 0.f, 1.f);
+        break;
+
+    case ETextureSourceFormat::RGBA16:
+        forrange(x, 0, width) {
+            const u8* const texel = src + x * 8;
+            dst[x] = float4(UNorm16_(texel), UNorm16_(texel + 2), UNorm16_(texel + 4), UNorm16_(texel + 6));
+        }
+        break;
+    case ETextureSourceFormat::RA16:
+        forrange(x, 0, width)
+            dst[x] = float4(UNorm16_(src + x * 4), 0.f, 0.f, UNorm16_(src + x * 4 + 2));
+        break;
+    case ETextureSourceFormat::RG16:
+        forrange(x, 0, width)
+            dst[x] = float4(UNorm16_(src + x * 4), UNorm16_(src + x * 4 + 2), 0.f, 1.f);
+        break;
+    case ETextureSourceFormat::G16:
+        forrange(x, 0, width)
+            dst[x] = float4(UNorm16_(src + x * 2), 0.f, 0.f, 1.f);
+        break;
+
+    case ETextureSourceFormat::RGBA16f:
+        forrange(x, 0, width) {
+            const u8* const texel = src + x * 8;
+            dst[x] = float4(Half_(texel), Half_(texel + 2), Half_(texel + 4), Half_(texel + 6));
+        }
+        break;
+    case ETextureSourceFormat::R16f:
+        forrange(x, 0, width)
+            dst[x] = float4(Half_(src + x * 2), 0.f, 0.f, 1.f);
+        break;
+
+    case ETextureSourceFormat::RGBA32f:
+        FPlatformMemory::Memcpy(dst, src, width * sizeof(float4));
+        break;
+
+    case ETextureSourceFormat::Unknown:
+    case ETextureSourceFormat::_Last:
+        AssertNotReached();
+    }
+
+    if (IsAlphaWeighted_(layout)) {
+        forrange(x, 0, width) {
+            const ::__m128 rgba = ::_mm_loadu_ps(&dst[x].x);
+            const ::__m128 aaa1 = ::_mm_blend_ps(::_mm_shuffle_ps(rgba, rgba, _MM_SHUFFLE(3, 3, 3, 3)), ::_mm_set1_ps(1.f), 0x8);
+            ::_mm_storeu_ps(&dst[x].x, ::_mm_mul_ps(rgba, aaa1));
+        }
+    }
+}
+//----------------------------------------------------------------------------
+// src can be modified, the row is discarded after encoding
+static void EncodeRow_(u8* dst, float4* src, u32 width, const FImageResampleLayout& layout) NOEXCEPT {
+    if (IsAlphaWeighted_(layout)) {
+        forrange(x, 0, width) {
+            const ::__m128 rgba = ::_mm_loadu_ps(&src[x].x);
+            const float alpha = src[x].w;
+            if (alpha > KernelEpsilon_) {
+                const ::__m128 aaa1 = ::_mm_blend_ps(::_mm_set1_ps(alpha), ::_mm_set1_ps(1.f), 0x8);
+                ::_mm_storeu_ps(&src[x].x, ::_mm_div_ps(rgba, aaa1));
+            }
+        }
+    }
+
+    const bool bSRGB = IsSRGB8_(layout);
+    const FLinearToSRGB8Table_& toSRGB = FLinearToSRGB8Table_::Get();
+    const auto unorm8 = [](float f) -> u8 {
+        return static_cast<u8>(Saturate(f) * 255.f + 0.5f);
+    };
+
+    switch (layout.Format) {
+    case ETextureSourceFormat::RGBA8:
+    case ETextureSourceFormat::BGRA8:
+    case ETextureSourceFormat::BGRE8:
+        if (layout.Format == ETextureSourceFormat::BGRA8) {
+            forrange(x, 0, width) {
+                const ::__m128 rgba = ::_mm_loadu_ps(&src[x].x);
+                ::_mm_storeu_ps(&src[x].x, ::_mm_shuffle_ps(rgba, rgba, _MM_SHUFFLE(3, 0, 1, 2)));
+            }
+        }
+        if (bSRGB && layout.Format != ETextureSourceFormat::BGRE8) {
+            forrange(x, 0, width) {
+                u8* const texel = dst + x * 4;
+                texel[0] = toSRGB(src[x].x);
+                texel[1] = toSRGB(src[x].y);
+                texel[2] = toSRGB(src[x].z);
+                texel[3] = unorm8(src[x].w);
+            }
+        }
+        else {
+            forrange(x, 0, width)
+                StoreUNorm8x4_(dst + x * 4, ::_mm_loadu_ps(&src[x].x));
+        }
+        break;
+    case ETextureSourceFormat::RA8:
+        forrange(x, 0, width) {
+            dst[x * 2 + 0] = (bSRGB ? toSRGB(src[x].x) : unorm8(src[x].x));
+            dst[x * 2 + 1] = unorm8(src[x].w);
+        }
+        break;
+    case ETextureSourceFormat::RG8:
+        forrange(x, 0, width) {
+            dst[x * 2 + 0] = (bSRGB ? toSRGB(src[x].x) : unorm8(src[x].x));
+            dst[x * 2 + 1] = (bSRGB ? toSRGB(src[x].y) : unorm8(src[x].y));
+        }
+        break;
+    case ETextureSourceFormat::G8:
+        forrange(x, 0, width)
+            dst[x] = (bSRGB ? toSRGB(src[x].x) : unorm8(src[x].x));
+        break;
+
+    case ETextureSourceFormat::RGBA16:
+        forrange(x, 0, width) {
+            u8* const texel = dst + x * 8;
+            StoreUNorm16_(texel + 0, src[x].x);
+            StoreUNorm16_(texel + 2, src[x].y);
+            StoreUNorm16_(texel + 4, src[x].z);
+            StoreUNorm16_(texel + 6, src[x].w);
+        }
+        break;
+    case ETextureSourceFormat::RA16:
+        forrange(x, 0, width) {
+            StoreUNorm16_(dst + x * 4 + 0, src[x].x);
+            StoreUNorm16_(dst + x * 4 + 2, src[x].w);
+        }
+        break;
+    case ETextureSourceFormat::RG16:
+        forrange(x, 0, width) {
+            StoreUNorm16_(dst + x * 4 + 0, src[x].x);
+            StoreUNorm16_(dst + x * 4 + 2, src[x].y);
+        }
+        break;
+    case ETextureSourceFormat::G16:
+        forrange(x, 0, width)
+            StoreUNorm16_(dst + x * 2, src[x].x);
+        break;
+
+    case ETextureSourceFormat::RGBA16f:
+        forrange(x, 0, width) {
+            u8* const texel = dst + x * 8;
+            StoreHalf_(texel + 0, src[x].x);
+            StoreHalf_(texel + 2, src[x].y);
+            StoreHalf_(texel + 4, src[x].z);
+            StoreHalf_(texel + 6, src[x].w);
+        }
+        break;
+    case ETextureSourceFormat::R16f:
+        forrange(x, 0, width)
+            StoreHalf_(dst + x * 2, src[x].x);
+        break;
+
+    case ETextureSourceFormat::RGBA32f:
+        FPlatformMemory::Memcpy(dst, src, width * sizeof(float4));
+        break;
+
+    case ETextureSourceFormat::Unknown:
+    case ETextureSourceFormat::_Last:
+        AssertNotReached();
+    }
+}
+//----------------------------------------------------------------------------
+// Passes
+//----------------------------------------------------------------------------
+// row points to the first texel of the border, all taps are contiguous
+static void HorizontalPass_(float4* dst, const float4* row, u32 width, const FImageResampler::FAxisKernel& kernel) NOEXCEPT {
+    const u32 numTaps = kernel.NumTaps;
+    const float* weights = kernel.Weights.data();
+    const float* const texels = &row[kernel.BorderBefore].x;
+
+    forrange(x, 0, width) {
+        const float* src = texels + static_cast<intptr_t>(kernel.First[x]) * 4;
+
+        u32 t = 0;
+#if USE_PPE_AVX2
+        // 2 taps per iteration
+        ::__m256 acc8 = ::_mm256_setzero_ps();
+        for (; t + 2 <= numTaps; t += 2, src += 8) {
+            const ::__m256 w = ::_mm256_insertf128_ps(::_mm256_castps128_ps256(::_mm_set1_ps(weights[t])), ::_mm_set1_ps(weights[t + 1]), 1);
+            acc8 = ::_mm256_add_ps(acc8, ::_mm256_mul_ps(w, ::_mm256_loadu_ps(src)));
+        }
+        ::__m128 acc = ::_mm_add_ps(::_mm256_castps256_ps128(acc8), ::_mm256_extractf128_ps(acc8, 1));
+#else
+        ::__m128 acc = ::_mm_setzero_ps();
+#endif
+        for (; t < numTaps; ++t, src += 4)
+            acc = ::_mm_add_ps(acc, ::_mm_mul_ps(::_mm_set1_ps(weights[t]), ::_mm_loadu_ps(src)));
+
+        ::_mm_storeu_ps(&dst[x].x, acc);
+        weights += numTaps;
+    }
+}
+//----------------------------------------------------------------------------
+// rows are contiguous in the band cache, the whole row is processed FWideFloat::Lanes floats at a time
+static void VerticalPass_(float4* dst, const float4* rows, u32 width, const float* weights, u32 numTaps) NOEXCEPT {
+    const size_t numFloats = static_cast<size_t>(width) * 4;
+    const size_t rowStride = numFloats;
+
+    float* const out = &dst->x;
+    const float* const in = &rows->x;
+
+    size_t i = 0;
+    for (; i + FWideFloat::Lanes <= numFloats; i += FWideFloat::Lanes) {
+        FWideFloat acc = FWideFloat::Broadcast(weights[0]) * FWideFloat::Load(in + i);
+        forrange(t, 1, numTaps)
+            acc += FWideFloat::Broadcast(weights[t]) * FWideFloat::Load(in + t * rowStride + i);
+        acc.Store(out + i);
+    }
+
+    if (i < numFloats) {
+        const u32 n = checked_cast<u32>(numFloats - i);
+        FWideFloat acc = FWideFloat::Broadcast(weights[0]) * FWideFloat::LoadPartial(in + i, n);
+        forrange(t, 1, numTaps)
+            acc += FWideFloat::Broadcast(weights[t]) * FWideFloat::LoadPartial(in + t * rowStride + i, n);
+        acc.StorePartial(out + i, n);
+    }
+}
+//----------------------------------------------------------------------------
+// Readers/Writers
+//----------------------------------------------------------------------------
+struct FLinearReader_ {
+    const float4* Data;
+    u32 Width;
+
+    const float4* Direct(u32 y) const { return (Data + static_cast<size_t>(y) * Width); }
+    void Decode(float4* dst, u32 y) const {
+        FPlatformMemory::Memcpy(dst, Direct(y), Width * sizeof(float4));
+    }
+};
+//----------------------------------------------------------------------------
+struct FDecodeReader_ {
+    const FImageResampleLayout* Layout;
+    const u8* Data;
+    size_t Stride;
+
+    const float4* Direct(u32) const { return nullptr; }
+    void Decode(float4* dst, u32 y) const {
+        DecodeRow_(dst, Data + y * Stride, Layout->Dimensions.x, *Layout);
+    }
+};
+//----------------------------------------------------------------------------
+struct FLinearWriter_ {
+    float4* Data;
+    u32 Width;
+
+    float4* Begin(u32 y, float4*) const { return (Data + static_cast<size_t>(y) * Width); }
+    void End(u32, float4*) const {}
+};
+//----------------------------------------------------------------------------
+struct FEncodeWriter_ {
+    const FImageResampleLayout* Layout;
+    u8* Data;
+    size_t Stride;
+
+    float4* Begin(u32, float4* scratch) const { return scratch; }
+    void End(u32 y, float4* row) const {
+        EncodeRow_(Data + y * Stride, row, Layout->Dimensions.x, *Layout);
+    }
+};
+//----------------------------------------------------------------------------
+NODISCARD static bool CheckLayout_(const FImageResampleLayout& layout, size_t sizeInBytes) {
+    PPE_LOG_CHECK(Texture, FImageResampler::SupportsFormat(layout.Format));
+    PPE_LOG_CHECK(Texture, layout.Dimensions.x > 0 && layout.Dimensions.y > 0);
+    PPE_LOG_CHECK(Texture, layout.SizeInBytes() == sizeInBytes);
+    return true;
+}
+//----------------------------------------------------------------------------
+NODISCARD static size_t NumWorkers_(ITaskContext* context) {
+    return (context ? context->WorkerCount() : FGlobalThreadPool::Get().WorkerCount());
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FImageResampler::FImageResampler(const uint2& srcDimensions, const uint2& dstDimensions, EImageResampleFilter filter, bool bWrapEdges)
+:   _srcDimensions(srcDimensions)
+,   _dstDimensions(dstDimensions)
+,   _filter(filter)
+,   _bWrapEdges(bWrapEdges) {
+    Assert(_srcDimensions.x > 0 && _srcDimensions.y > 0);
+    Assert(_dstDimensions.x > 0 && _dstDimensions.y > 0);
+
+    BuildAxisKernel_(&_kernelX, _srcDimensions.x, _dstDimensions.x, _filter);
+    BuildAxisKernel_(&_kernelY, _srcDimensions.y, _dstDimensions.y, _filter);
+}
+//----------------------------------------------------------------------------
+bool FImageResampler::SupportsFormat(ETextureSourceFormat format) NOEXCEPT {
+    return (format > ETextureSourceFormat::Unknown && format < ETextureSourceFormat::_Last);
+}
+//----------------------------------------------------------------------------
+bool FImageResampler::Resample(
+    const FImageResampleLayout& dst, const FRawMemory& dstData,
+    const FImageResampleLayout& src, const FRawMemoryConst& srcData,
+    ITaskContext* context ) const {
+    PPE_LOG_CHECK(Texture, CheckLayout_(dst, dstData.SizeInBytes()));
+    PPE_LOG_CHECK(Texture, CheckLayout_(src, srcData.SizeInBytes()));
+    PPE_LOG_CHECK(Texture, dst.Dimensions == _dstDimensions);
+    PPE_LOG_CHECK(Texture, src.Dimensions == _srcDimensions);
+
+    const FDecodeReader_ reader{ &src, srcData.data(), ETextureSourceFormat_BytesPerPixel(src.Format) * static_cast<size_t>(src.Dimensions.x) };
+    const FEncodeWriter_ writer{ &dst, dstData.data(), ETextureSourceFormat_BytesPerPixel(dst.Format) * static_cast<size_t>(dst.Dimensions.x) };
+
+    Resample_(reader, writer, context);
+    return true;
+}
+//----------------------------------------------------------------------------
+void FImageResampler::ResampleLinear(
+    const TMemoryView<float4>& dst,
+    const TMemoryView<const float4>& src,
+    ITaskContext* context ) const {
+    Assert_NoAssume(dst.size() == static_cast<size_t>(_dstDimensions.x) * _dstDimensions.y);
+    Assert_NoAssume(src.size() == static_cast<size_t>(_srcDimensions.x) * _srcDimensions.y);
+
+    const FLinearReader_ reader{ src.data(), _srcDimensions.x };
+    const FLinearWriter_ writer{ dst.data(), _dstDimensions.x };
+
+    Resample_(reader, writer, context);
+}
+//----------------------------------------------------------------------------
+bool FImageResampler::ResampleLinear(
+    const TMemoryView<float4>& dst,
+    const FImageResampleLayout& src, const FRawMemoryConst& srcData,
+    ITaskContext* context ) const {
+    PPE_LOG_CHECK(Texture, CheckLayout_(src, srcData.SizeInBytes()));
+    PPE_LOG_CHECK(Texture, src.Dimensions == _srcDimensions);
+    PPE_LOG_CHECK(Texture, dst.size() == static_cast<size_t>(_dstDimensions.x) * _dstDimensions.y);
+
+    const FDecodeReader_ reader{ &src, srcData.data(), ETextureSourceFormat_BytesPerPixel(src.Format) * static_cast<size_t>(src.Dimensions.x) };
+    const FLinearWriter_ writer{ dst.data(), _dstDimensions.x };
+
+    Resample_(reader, writer, context);
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FImageResampler::DecodeLinear(
+    const TMemoryView<float4>& dst,
+    const FImageResampleLayout& src, const FRawMemoryConst& srcData,
+    ITaskContext* context ) {
+    PPE_LOG_CHECK(Texture, CheckLayout_(src, srcData.SizeInBytes()));
+    PPE_LOG_CHECK(Texture, dst.size() == static_cast<size_t>(src.Dimensions.x) * src.Dimensions.y);
+
+    const size_t stride = ETextureSourceFormat_BytesPerPixel(src.Format) * static_cast<size_t>(src.Dimensions.x);
+    const u32 numTasks = (src.Dimensions.y + CodecRowsPerTask_ - 1) / CodecRowsPerTask_;
+
+    ParallelFor(0, numTasks, [&](size_t task) {
+        const u32 y0 = checked_cast<u32>(task * CodecRowsPerTask_);
+        const u32 y1 = Min(y0 + CodecRowsPerTask_, src.Dimensions.y);
+        forrange(y, y0, y1)
+            DecodeRow_(dst.data() + static_cast<size_t>(y) * src.Dimensions.x, srcData.data() + y * stride, src.Dimensions.x, src);
+    },  ETaskPriority::Normal, context);
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool FImageResampler::EncodeLinear(
+    const FImageResampleLayout& dst, const FRawMemory& dstData,
+    const TMemoryView<const float4>& src,
+    ITaskContext* context ) {
+    PPE_LOG_CHECK(Texture, CheckLayout_(dst, dstData.SizeInBytes()));
+    PPE_LOG_CHECK(Texture, src.size() == static_cast<size_t>(dst.Dimensions.x) * dst.Dimensions.y);
+
+    const size_t stride = ETextureSourceFormat_BytesPerPixel(dst.Format) * static_cast<size_t>(dst.Dimensions.x);
+    const u32 numTasks = (dst.Dimensions.y + CodecRowsPerTask_ - 1) / CodecRowsPerTask_;
+
+    ParallelFor(0, numTasks, [&](size_t task) {
+        // EncodeRow_() modifies its input for alpha and swizzling
+        VECTOR(Texture, float4) row;
+        row.resize_Uninitialized(dst.Dimensions.x);
+
+        const u32 y0 = checked_cast<u32>(task * CodecRowsPerTask_);
+        const u32 y1 = Min(y0 + CodecRowsPerTask_, dst.Dimensions.y);
+        forrange(y, y0, y1) {
+            FPlatformMemory::Memcpy(row.data(), src.data() + static_cast<size_t>(y) * dst.Dimensions.x, dst.Dimensions.x * sizeof(float4));
+            EncodeRow_(dstData.data() + y * stride, row.data(), dst.Dimensions.x, dst);
+        }
+    },  ETaskPriority::Normal, context);
+
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename _Reader, typename _Writer>
+void FImageResampler::Resample_(const _Reader& reader, const _Writer& writer, ITaskContext* context) const {
+    const u32 srcW = _srcDimensions.x;
+    const u32 srcH = _srcDimensions.y;
+    const u32 dstW = _dstDimensions.x;
+    const u32 dstH = _dstDimensions.y;
+
+    // split output rows in bands, the horizontal cache of a band holds all the input rows it reads
+    const size_t cacheRowSizeInBytes = dstW * sizeof(float4);
+    const float inputRowsPerOutput = Max(1.f, static_cast<float>(srcH) / dstH);
+    const float cacheRows = static_cast<float>(Max(TileCacheSizeInBytes / cacheRowSizeInBytes, size_t(1)));
+
+    // but keep at least one band per worker
+    const u32 numWorkers = checked_cast<u32>(Max(NumWorkers_(context), size_t(1)));
+
+    u32 bandRows = checked_cast<u32>(Max(1, FloorToInt((cacheRows - _kernelY.NumTaps) / inputRowsPerOutput)));
+    bandRows = Max(Min(bandRows, (dstH + numWorkers - 1) / numWorkers), 1_u32);
+
+    const u32 numBands = (dstH + bandRows - 1) / bandRows;
+    const bool bDirectRows = (0 == _kernelX.BorderBefore && 0 == _kernelX.BorderAfter);
+    const bool bWrapEdges = _bWrapEdges;
+
+    const auto processBand = [&](size_t band) {
+        const u32 y0 = checked_cast<u32>(band * bandRows);
+        const u32 y1 = Min(y0 + bandRows, dstH);
+
+        i32 lo = INT32_MAX, hi = INT32_MIN;
+        forrange(y, y0, y1) {
+            lo = Min(lo, _kernelY.First[y]);
+            hi = Max(hi, _kernelY.First[y] + static_cast<i32>(_kernelY.NumTaps));
+        }
+
+        VECTOR(Texture, float4) cache;
+        cache.resize_Uninitialized(static_cast<size_t>(hi - lo) * dstW);
+
+        VECTOR(Texture, float4) input;
+        input.resize_Uninitialized(_kernelX.BorderBefore + srcW + _kernelX.BorderAfter);
+
+        VECTOR(Texture, float4) output;
+        output.resize_Uninitialized(dstW);
+
+        // horizontal pass on each input row of the band
+        for (i32 j = lo; j < hi; ++j) {
+            const u32 srcY = ResolveEdge_(j, srcH, bWrapEdges);
+
+            const float4* row = (bDirectRows ? reader.Direct(srcY) : nullptr);
+            if (nullptr == row) {
+                float4* const texels = input.data() + _kernelX.BorderBefore;
+                reader.Decode(texels, srcY);
+
+                forrange(b, 0, _kernelX.BorderBefore)
+                    input[b] = texels[ResolveEdge_(static_cast<i32>(b) - static_cast<i32>(_kernelX.BorderBefore), srcW, bWrapEdges)];
+                forrange(a, 0, _kernelX.BorderAfter)
+                    texels[srcW + a] = texels[ResolveEdge_(static_cast<i32>(srcW + a), srcW, bWrapEdges)];
+
+                row = input.data();
+            }
+
+            HorizontalPass_(cache.data() + static_cast<size_t>(j - lo) * dstW, row, dstW, _kernelX);
+        }
+
+        // vertical pass from the cache
+        forrange(y, y0, y1) {
+            float4* const dst = writer.Begin(y, output.data());
+            VerticalPass_(dst,
+                cache.data() + static_cast<size_t>(_kernelY.First[y] - lo) * dstW,
+                dstW, &_kernelY.Weights[y * _kernelY.NumTaps], _kernelY.NumTaps );
+            writer.End(y, dst);
+        }
+    };
+
+    if (numBands > 1)
+        ParallelFor(0, numBands, processBand, ETaskPriority::Normal, context);
+    else
+        processBand(0);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
@@ -2,6 +2,7 @@
 
 #include "Texture/TextureGeneration.h"
 
+#include "Texture/ImageResampler.h"
 #include "Texture/TextureEnums.h"
 #include "Texture/TextureSource.h"
 #include "TextureService.h"
@@ -30,9 +31,6 @@
 #   include "Texture/EnumToString.h"
 #endif
 
-// will compile stb_image_resize2 in this translation unit:
-#include "stb_image_resize2-impl.h"
-
 namespace PPE {
 namespace ContentPipeline {
 //----------------------------------------------------------------------------
@@ -40,66 +38,48 @@ namespace ContentPipeline {
 //----------------------------------------------------------------------------
 namespace {
 //----------------------------------------------------------------------------
-NODISCARD CONSTEXPR ::stbir_datatype STBImageDataType_(ETextureSourceFormat fmt, ETextureGammaSpace gamma) {
-    switch (fmt) {
-    case ETextureSourceFormat::G8:
-    case ETextureSourceFormat::RA8:
-    case ETextureSourceFormat::RG8:
-    case ETextureSourceFormat::BGRA8:
-    case ETextureSourceFormat::BGRE8:
-    case ETextureSourceFormat::RGBA8:
-        return (gamma == ETextureGammaSpace::sRGB ? STBIR_TYPE_UINT8_SRGB : STBIR_TYPE_UINT8);
-
-    case ETextureSourceFormat::G16:
-    case ETextureSourceFormat::RA16:
-    case ETextureSourceFormat::RG16:
-    case ETextureSourceFormat::RGBA16:
-        return STBIR_TYPE_UINT16;
-
-    case ETextureSourceFormat::R16f:
-    case ETextureSourceFormat::RGBA16f:
-        return STBIR_TYPE_HALF_FLOAT;
-
-    case ETextureSourceFormat::RGBA32f:
-        return STBIR_TYPE_FLOAT;
-
-    case ETextureSourceFormat::Unknown:
-    case ETextureSourceFormat::_Last:
-        AssertNotImplemented();
+// ETextureMipGeneration::Default matches what stb_image_resize2 picked before
+NODISCARD CONSTEXPR EImageResampleFilter ImageResampleFilter_(ETextureMipGeneration mipGen, bool bHasAlpha, bool bUpsampling) {
+    switch (mipGen) {
+    case ETextureMipGeneration::Default:
+        if (bHasAlpha) // default Mitchell/CatmullRom give bad results with fully transparent pixels
+            return EImageResampleFilter::CubicBSpline;
+        return (bUpsampling ? EImageResampleFilter::CatmullRom : EImageResampleFilter::MitchellNetrevalli);
+    case ETextureMipGeneration::Box:
+        return EImageResampleFilter::Box;
+    case ETextureMipGeneration::CubicSpine:
+        return EImageResampleFilter::CubicBSpline;
+    case ETextureMipGeneration::CatmullRom:
+        return EImageResampleFilter::CatmullRom;
+    case ETextureMipGeneration::PointSample:
+        return EImageResampleFilter::PointSample;
+    case ETextureMipGeneration::GaussianBlur3: FALLTHROUGH();
+    case ETextureMipGeneration::GaussianBlur5: FALLTHROUGH();
+    case ETextureMipGeneration::GaussianBlur7: FALLTHROUGH();
+    case ETextureMipGeneration::GaussianBlur9: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen1: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen2: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen3: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen4: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen5: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen6: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen7: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen8: FALLTHROUGH();
+    case ETextureMipGeneration::ContrastAdaptiveSharpen9: FALLTHROUGH();
+    case ETextureMipGeneration::MitchellNetrevalli:
+        return EImageResampleFilter::MitchellNetrevalli;
     }
 
-    return Default;
+    return EImageResampleFilter::MitchellNetrevalli;
 }
 //----------------------------------------------------------------------------
-NODISCARD CONSTEXPR ::stbir_pixel_layout STBImagePixelLayout_(ETextureSourceFormat fmt, ETextureSourceFlags flags) {
-    switch (fmt) {
-    case ETextureSourceFormat::BGRA8:
-        return (flags ^ ETextureSourceFlags::PreMultipliedAlpha ? STBIR_BGRA_PM : STBIR_BGRA);
-    case ETextureSourceFormat::RGBA8:
-    case ETextureSourceFormat::RGBA16:
-    case ETextureSourceFormat::RGBA16f:
-    case ETextureSourceFormat::RGBA32f:
-        return (flags ^ ETextureSourceFlags::PreMultipliedAlpha ? STBIR_RGBA_PM : STBIR_RGBA);
-    case ETextureSourceFormat::RA8:
-    case ETextureSourceFormat::RA16:
-        return (flags ^ ETextureSourceFlags::PreMultipliedAlpha ? STBIR_RA_PM : STBIR_RA);
-
-    case ETextureSourceFormat::G8:
-    case ETextureSourceFormat::G16:
-    case ETextureSourceFormat::R16f:
-        return STBIR_1CHANNEL;
-    case ETextureSourceFormat::RG8:
-    case ETextureSourceFormat::RG16:
-        return STBIR_2CHANNEL;
-    case ETextureSourceFormat::BGRE8:
-        return STBIR_4CHANNEL;
-
-    case ETextureSourceFormat::Unknown:
-    case ETextureSourceFormat::_Last:
-        AssertNotReached();
-    }
-
-    return Default;
+NODISCARD FImageResampleLayout ImageResampleLayout_(const FTextureSourceProperties& properties, const uint2& dimensions) {
+    return {
+        .Dimensions = dimensions,
+        .Format = properties.Format,
+        .Flags = properties.Flags,
+        .Gamma = properties.Gamma,
+    };
 }
 //----------------------------------------------------------------------------
 } //!namespace
@@ -125,10 +105,16 @@ FTextureGeneration::FTextureGeneration(const ITextureService& service, const FTe
 :   FTextureGeneration(properties) {
     service.TextureCompression(
         MakeAppendable<UTextureCompression>([this](UTextureCompression&& newCompression) {
-            if (not Compression || (
-                // adopt new compression format if it's yielding to smaller images
-                EPixelFormat_BitsPerPixel(newCompression->Format(), RHI::EImageAspect::Color) <
-                EPixelFormat_BitsPerPixel(Compression->Format(), RHI::EImageAspect::Color) )) {
+            if (not Compression) {
+                Compression = std::move(newCompression);
+                return;
+            }
+
+            // adopt new compression format if it's yielding to smaller images, or if it has a higher priority for the same size
+            const u32 newBitsPerPixel = EPixelFormat_BitsPerPixel(newCompression->Format(), RHI::EImageAspect::Color);
+            const u32 oldBitsPerPixel = EPixelFormat_BitsPerPixel(Compression->Format(), RHI::EImageAspect::Color);
+            if (newBitsPerPixel < oldBitsPerPixel || (
+                newBitsPerPixel == oldBitsPerPixel && newCompression->Priority() > Compression->Priority())) {
                 Compression = std::move(newCompression);
             }
         }), properties, *this);
@@ -322,7 +308,7 @@ bool FTextureGeneration::ResizeMip2D(
     Assert_NoAssume(outputData.SizeInBytes() ==
         ETextureSourceFormat_SizeInBytes(properties.Format, (outputDimensions,1_u32)));
 
-    // resize the texture with stb_image_resize2
+    // resize the texture with FImageResampler, bands of output rows are processed in parallel
     {
         BENCHMARK_SCOPE_ARGS(Texture, "ResizeMip2D",
             {"Method", Opaq::Format(MipGeneration)},
@@ -339,98 +325,31 @@ bool FTextureGeneration::ResizeMip2D(
                 {"Gamma", Opaq::Format(inputGamma)},
             }});
 
-        // First off, you must ALWAYS call stbir_resize_init on your resize structure before any of the other calls!
-        ::STBIR_RESIZE stbir_resize;
-        ::stbir_resize_init(&stbir_resize,
-            // input:
-            inputData.data(),
-            checked_cast<int>(inputDimensions.x),
-            checked_cast<int>(inputDimensions.y),
-            0 /* 0 stride -> contiguous in memory */,
-            // output:
-            outputData.data(),
-            checked_cast<int>(outputDimensions.x),
-            checked_cast<int>(outputDimensions.y),
-            0 /* 0 stride -> contiguous in memory */,
-            // layout:
-            STBImagePixelLayout_(inputFormat, inputFlags),
-            STBImageDataType_(inputFormat, inputGamma));
-
-        // Check for format conversion
-        if (properties.Format != inputFormat && properties.Flags != inputFlags) {
-            ::stbir_set_datatypes(&stbir_resize,
-                STBImageDataType_(inputFormat, inputGamma),
-                STBImageDataType_(properties.Format, properties.Gamma));
-
-            PPE_LOG_CHECK(Texture, !!::stbir_set_pixel_layouts(&stbir_resize,
-                STBImagePixelLayout_(inputFormat, inputFlags),
-                STBImagePixelLayout_(properties.Format, properties.Flags)));
-        }
-
-        // Set filtering algorithms
-        switch (MipGeneration) {
-        case ETextureMipGeneration::Default:
-            if (properties.HasAlpha()) // default Mitchell/CatmullRom give bad results with fully transparent pixels
-                ::stbir_set_filters(&stbir_resize, STBIR_FILTER_CUBICBSPLINE, STBIR_FILTER_CUBICBSPLINE);
-            else
-                ::stbir_set_filters(&stbir_resize, STBIR_FILTER_DEFAULT, STBIR_FILTER_DEFAULT);
-            break;
-        case ETextureMipGeneration::Box:
-            ::stbir_set_filters(&stbir_resize, STBIR_FILTER_BOX, STBIR_FILTER_BOX);
-            break;
-        case ETextureMipGeneration::CubicSpine:
-            ::stbir_set_filters(&stbir_resize, STBIR_FILTER_CUBICBSPLINE, STBIR_FILTER_CUBICBSPLINE);
-            break;
-        case ETextureMipGeneration::CatmullRom:
-            ::stbir_set_filters(&stbir_resize, STBIR_FILTER_CATMULLROM, STBIR_FILTER_CATMULLROM);
-            break;
-        case ETextureMipGeneration::PointSample:
-            ::stbir_set_filters(&stbir_resize, STBIR_FILTER_POINT_SAMPLE, STBIR_FILTER_POINT_SAMPLE);
-            break;
-        case ETextureMipGeneration::GaussianBlur3: FALLTHROUGH();
-        case ETextureMipGeneration::GaussianBlur5: FALLTHROUGH();
-        case ETextureMipGeneration::GaussianBlur7: FALLTHROUGH();
-        case ETextureMipGeneration::GaussianBlur9: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen1: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen2: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen3: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen4: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen5: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen6: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen7: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen8: FALLTHROUGH();
-        case ETextureMipGeneration::ContrastAdaptiveSharpen9: FALLTHROUGH();
-        case ETextureMipGeneration::MitchellNetrevalli:
-            ::stbir_set_filters(&stbir_resize, STBIR_FILTER_MITCHELL, STBIR_FILTER_MITCHELL);
-            break;
-        }
-
-        // Enable edge wrapping when tiling is enabled (slower)
-        if (properties.Flags & ETextureSourceFlags::Tilable) {
-            ::stbir_set_edgemodes(&stbir_resize, STBIR_EDGE_WRAP, STBIR_EDGE_WRAP);
-        }
-
-        // Retrieve task manager for multi-thread resize
-        const FTaskManager& threadPool = FGlobalThreadPool::Get();
-
-        // This will build samplers for threading.
-        const int numSplits = ::stbir_build_samplers_with_splits(&stbir_resize,
-            checked_cast<int>(threadPool.WorkerCount()));
-        DEFERRED {
-            ::stbir_free_samplers(&stbir_resize);
+        const FImageResampleLayout inputLayout{
+            .Dimensions = inputDimensions,
+            .Format = inputFormat,
+            .Flags = inputFlags,
+            .Gamma = inputGamma,
         };
-        PPE_LOG_CHECK(Texture, numSplits > 0);
 
-        const int numSucceeds = ParallelSum(0, checked_cast<size_t>(numSplits), [&stbir_resize](size_t splitIndex) -> int {
-            // This function does a split of the resizing (you call this fuction for each
-            // split, on multiple threads). A split is a piece of the output resize pixel space.
-            PPE_LOG_CHECK(Texture, !!::stbir_resize_extended_split(&stbir_resize, checked_cast<int>(splitIndex), 1));
-            return 1;
+        // Enable edge wrapping when tiling is enabled
+        const FImageResampler resampler{ inputDimensions, outputDimensions,
+            ImageResampleFilter_(MipGeneration, properties.HasAlpha(), AnyGreater(outputDimensions, inputDimensions)),
+            properties.IsTilable() };
 
-        }, ETaskPriority::Normal, threadPool.GlobalContext());
-        PPE_LOG_CHECK(Texture, numSucceeds == numSplits);
+        PPE_LOG_CHECK(Texture, resampler.Resample(
+            ImageResampleLayout_(properties, outputDimensions), outputData,
+            inputLayout, inputData ));
     }
 
+    PostProcessMip2D(properties, outputDimensions, outputData);
+    return true;
+}
+//----------------------------------------------------------------------------
+void FTextureGeneration::PostProcessMip2D(
+    const FTextureSourceProperties& properties,
+    const uint2& outputDimensions,
+    const FRawMemory& outputData ) const {
     // Handle optional post-processing
     switch (MipGeneration) {
     case ETextureMipGeneration::Default: break;
@@ -481,8 +400,6 @@ bool FTextureGeneration::ResizeMip2D(
         ContrastAdaptiveSharpening2D(properties, outputDimensions, outputData, 0.9f);
         break;
     }
-
-    return true;
 }
 //----------------------------------------------------------------------------
 bool FTextureGeneration::GenerateSliceMipChain2D(
@@ -502,6 +419,10 @@ bool FTextureGeneration::GenerateSliceMipChain2D(
     if (bPreserveAlphaTestCoverage2D and properties.HasAlpha() and  properties.HasMaskedAlpha() )
         desiredAlphaTestCoverage = AlphaTestCoverage2D(properties, mipDimensions.xy, outputMipData);
 
+    // each mip is filtered from the linear float texels of the previous one, instead of its quantized output:
+    // the top mip is decoded on the fly, then only 2 float levels are kept alive
+    VECTOR(Texture, float4) previousLinear, currentLinear;
+
     forrange(mipLevel, 1, properties.NumMips) {
         const uint3 previousMipDimensions = mipDimensions;
         const FRawMemoryConst previousMipData = outputMipData;
@@ -510,11 +431,31 @@ bool FTextureGeneration::GenerateSliceMipChain2D(
         outputMipData = rawData.Eat(ETextureSourceFormat_SizeInBytes(
             properties.Format, mipDimensions));
 
-        if (not ResizeMip2D(properties, mipDimensions.xy, outputMipData, previousMipDimensions.xy, properties.Format, properties.Flags, properties.Gamma, previousMipData))
-            return false;
+        const FImageResampler resampler{ previousMipDimensions.xy, mipDimensions.xy,
+            ImageResampleFilter_(MipGeneration, properties.HasAlpha(), false),
+            properties.IsTilable() };
+
+        currentLinear.clear();
+        currentLinear.resize_Uninitialized(static_cast<size_t>(mipDimensions.x) * mipDimensions.y);
+
+        if (mipLevel == 1) {
+            PPE_LOG_CHECK(Texture, resampler.ResampleLinear(currentLinear.MakeView(),
+                ImageResampleLayout_(properties, previousMipDimensions.xy), previousMipData ));
+        }
+        else {
+            resampler.ResampleLinear(currentLinear.MakeView(), previousLinear.MakeConstView());
+        }
+
+        PPE_LOG_CHECK(Texture, FImageResampler::EncodeLinear(
+            ImageResampleLayout_(properties, mipDimensions.xy), outputMipData,
+            currentLinear.MakeConstView() ));
+
+        PostProcessMip2D(properties, mipDimensions.xy, outputMipData);
 
         if (desiredAlphaTestCoverage > 0)
             ScaleAlphaToCoverage2D(properties, mipDimensions.xy, outputMipData, desiredAlphaTestCoverage);
+
+        std::swap(previousLinear, currentLinear);
     }
 
     Assert_NoAssume(rawData.empty());
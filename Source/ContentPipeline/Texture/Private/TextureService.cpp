@@ -9,6 +9,7 @@
 
 #include "Texture/Texture.h"
 
+#include "Texture/Compression/BlockCompression.h"
 #include "Texture/Compression/PassthroughCompression.h"
 #include "Texture/Compression/STBDxtCompression.h"
 #include "Texture/Image/STBImageFormat.h"
@@ -45,7 +46,18 @@ public:
         })
     // register default texture compressions here:
     ,   _textureCompressions({
-        // DXT block compression
+        // BC block compression
+            { RHI::EPixelFormat::BC1_RGB8_UNorm,    UTextureCompression::Make<FBlockCompression_BC1_RGB8_UNorm>() },
+            { RHI::EPixelFormat::BC1_sRGB8,         UTextureCompression::Make<FBlockCompression_BC1_sRGB8>() },
+            { RHI::EPixelFormat::BC3_RGBA8_UNorm,   UTextureCompression::Make<FBlockCompression_BC3_RGBA8_UNorm>() },
+            { RHI::EPixelFormat::BC3_sRGB8_A8,      UTextureCompression::Make<FBlockCompression_BC3_sRGB8_A8>() },
+            { RHI::EPixelFormat::BC4_R8_UNorm,      UTextureCompression::Make<FBlockCompression_BC4_R8_UNorm>() },
+            { RHI::EPixelFormat::BC4_R8_SNorm,      UTextureCompression::Make<FBlockCompression_BC4_R8_SNorm>() },
+            { RHI::EPixelFormat::BC5_RG8_UNorm,     UTextureCompression::Make<FBlockCompression_BC5_RG8_UNorm>() },
+            { RHI::EPixelFormat::BC5_RG8_SNorm,     UTextureCompression::Make<FBlockCompression_BC5_RG8_SNorm>() },
+            { RHI::EPixelFormat::BC7_RGBA8_UNorm,   UTextureCompression::Make<FBlockCompression_BC7_RGBA8_UNorm>() },
+            { RHI::EPixelFormat::BC7_sRGB8_A8,      UTextureCompression::Make<FBlockCompression_BC7_sRGB8_A8>() },
+        // DXT block compression (stb_dxt), FBlockEncoder has a higher priority for the formats supported by both
             { RHI::EPixelFormat::BC1_RGB8_UNorm,    UTextureCompression::Make<FSTBDxtCompression_BC1_RGB8_UNorm>() },
             { RHI::EPixelFormat::BC1_sRGB8,         UTextureCompression::Make<FSTBDxtCompression_BC1_sRGB8>() },
             { RHI::EPixelFormat::BC3_RGBA8_UNorm,   UTextureCompression::Make<FSTBDxtCompression_BC3_RGBA8_UNorm>() },
@@ -97,7 +109,8 @@ public: // ITextureService
     NODISCARD virtual UImageFormat ImageFormat(EImageFormat format, const FTextureSourceProperties& properties) const NOEXCEPT override {
         const auto shared = _imageFormats.LockShared();
 
-        for (auto it = shared->find(format); it != shared->end(); ++it) {
+        const auto range = shared->equal_range(format);
+        for (auto it = range.first; it != range.second; ++it) {
             if (it->second->SupportsTextureSource(properties))
                 return it->second;
         }
@@ -125,10 +138,15 @@ public: // ITextureService
     NODISCARD virtual UTextureCompression TextureCompression(RHI::EPixelFormat format) const NOEXCEPT override {
         const auto shared = _textureCompressions.LockShared();
 
-        if (const auto it = shared->find(format); it != shared->end())
-            return it->second;
+        // don't rely on the order of insertion of the duplicates, see ITextureCompression::Priority()
+        UTextureCompression best;
+        const auto range = shared->equal_range(format);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (not best || it->second->Priority() > best->Priority())
+                best = it->second;
+        }
 
-        return Default;
+        return best;
     }
 
     NODISCARD virtual bool TextureCompression(
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include "Texture_fwd.h"
+
+#include "Texture/TextureCompression.h"
+#include "Texture/TextureEnums.h"
+
+#include "RHI/ResourceEnums.h"
+
+#include "Container/Appendable.h"
+#include "Memory/MemoryView.h"
+#include "Thread/Task_fwd.h"
+
+// SIMD block encoders for BC1, BC3, BC4, BC5 and BC7 (replaces stb_dxt):
+// - texels of a block are loaded in SoA, palettes are matched FWideFloat::Lanes texels at a time (16 texels at once for BC4)
+// - ETextureCompressionQuality::Low uses a range fit, Medium a principal axis fit refined by least squares, High a cluster fit
+// - BC7 searches modes 6/5/7 for blocks with alpha and 6/1/3 for opaque blocks, 2 subsets partitions are ranked before being fitted
+// - images are split in tiles of block rows, see EncodeTile() to batch the tiles of several images
+// SNorm formats map texel values [0,255] to [-1,1].
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class PPE_TEXTURE_API FBlockEncoder {
+public:
+    STATIC_CONST_INTEGRAL(u32, BlockDim, 4);
+    STATIC_CONST_INTEGRAL(u32, TexelsPerBlock, BlockDim * BlockDim);
+    STATIC_CONST_INTEGRAL(u32, BlocksPerTile, 256); // granularity of the parallel tasks
+
+    // RGBA8 texels of a block, in row order
+    struct FBlockTexels {
+        u8 Rgba[TexelsPerBlock][4];
+    };
+
+    // rows of blocks [FirstBlockRow, LastBlockRow) of an image
+    struct FTile {
+        uint2 Dimensions{ 0 };
+        ETextureSourceFormat SourceFormat{ Default };
+        FRawMemoryConst Source; // whole image
+        FRawMemory Dest; // whole image
+        u32 FirstBlockRow{ 0 };
+        u32 LastBlockRow{ 0 };
+    };
+
+    NODISCARD static bool SupportsFormat(RHI::EPixelFormat format) NOEXCEPT;
+    NODISCARD static bool SupportsSourceFormat(ETextureSourceFormat format) NOEXCEPT; // norm8 formats only
+    NODISCARD static u32 BlockSizeInBytes(RHI::EPixelFormat format) NOEXCEPT;
+    NODISCARD static uint2 NumBlocks(const uint2& dimensions) NOEXCEPT;
+    NODISCARD static size_t SizeInBytes(RHI::EPixelFormat format, const uint2& dimensions) NOEXCEPT;
+
+    static void EncodeBlock(RHI::EPixelFormat format, u8* dst, const FBlockTexels& src, ETextureCompressionQuality quality) NOEXCEPT;
+    // decodes the modes emitted by EncodeBlock(), unused BC7 modes decode to zero
+    static void DecodeBlock(RHI::EPixelFormat format, FBlockTexels* dst, const u8* src) NOEXCEPT;
+
+    // partial blocks on the right and bottom edges replicate the last texels, BC5 stores RA8 sources as luminance/alpha in RG
+    static void EncodeTile(RHI::EPixelFormat format, const FTile& tile, ETextureCompressionQuality quality) NOEXCEPT;
+    // appends the tiles splitting an image in chunks of BlocksPerTile
+    static void MakeTiles(
+        TAppendable<FTile> outTiles,
+        RHI::EPixelFormat format, const FRawMemory& dst,
+        const uint2& dimensions, ETextureSourceFormat srcFormat, const FRawMemoryConst& src );
+
+    // tiles are encoded in parallel
+    static bool EncodeImage(
+        RHI::EPixelFormat format, const FRawMemory& dst,
+        const uint2& dimensions, ETextureSourceFormat srcFormat, const FRawMemoryConst& src,
+        ETextureCompressionQuality quality,
+        ITaskContext* context = nullptr );
+    // dst holds RGBA8 texels, unused channels are set to 0 and alpha to 255
+    static bool DecodeImage(
+        RHI::EPixelFormat format, const FRawMemory& dst,
+        const uint2& dimensions, const FRawMemoryConst& src );
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
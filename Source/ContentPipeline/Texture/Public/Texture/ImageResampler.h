@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include "Texture_fwd.h"
+
+#include "Texture/TextureEnums.h"
+
+#include "Container/Vector.h"
+#include "Memory/MemoryView.h"
+#include "Thread/Task_fwd.h"
+
+// Separable image resampler used to generate mips (replaces stb_image_resize2):
+// - kernels are precomputed once per axis, every output texel uses the same number of taps (padded with zero weights)
+// - texels are decoded to linear float4 with alpha weighting, filtered horizontally then vertically, and encoded back
+// - output rows are split in bands whose horizontal cache fits in L2, bands are processed in parallel
+// - ResampleLinear() works directly on decoded images, mip chains can be built without requantizing each level
+
+namespace PPE {
+namespace ContentPipeline {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+enum class EImageResampleFilter : u8 {
+    Box                 = 0,    // A trapezoid w/1-pixel wide ramps, same result as box for integer scale ratios
+    CubicBSpline        ,       // Mitchell-Netrevalli with B=1,C=0, gaussian-esque
+    CatmullRom          ,       // Mitchell-Netrevalli with B=0,C=1/2, interpolating
+    MitchellNetrevalli  ,       // Mitchell-Netrevalli with B=1/3,C=1/3
+    PointSample         ,       // Nearest texel
+};
+//----------------------------------------------------------------------------
+struct FImageResampleLayout {
+    uint2 Dimensions{ 0 };
+    ETextureSourceFormat Format{ Default };
+    ETextureSourceFlags Flags{ Default };
+    ETextureGammaSpace Gamma{ Default };
+
+    NODISCARD size_t SizeInBytes() const {
+        return ETextureSourceFormat_SizeInBytes(Format, uint3{ Dimensions, 1 });
+    }
+};
+//----------------------------------------------------------------------------
+class PPE_TEXTURE_API FImageResampler {
+public:
+    STATIC_CONST_INTEGRAL(size_t, TileCacheSizeInBytes, 256 * 1024); // horizontal cache of a band, should fit in L2
+
+    // taps of one axis, for output texel i: Weights[i * NumTaps + t] applies to input texel First[i] + t
+    struct FAxisKernel {
+        u32 NumTaps{ 0 };
+        u32 BorderBefore{ 0 }; // taps can read outside of the image, resolved by the edge mode
+        u32 BorderAfter{ 0 };
+        VECTOR(Texture, i32) First;
+        VECTOR(Texture, float) Weights;
+    };
+
+    FImageResampler(const uint2& srcDimensions, const uint2& dstDimensions, EImageResampleFilter filter, bool bWrapEdges = false);
+
+    FImageResampler(const FImageResampler&) = delete;
+    FImageResampler& operator =(const FImageResampler&) = delete;
+
+    const uint2& SourceDimensions() const { return _srcDimensions; }
+    const uint2& DestDimensions() const { return _dstDimensions; }
+    EImageResampleFilter Filter() const { return _filter; }
+    bool WrapEdges() const { return _bWrapEdges; }
+
+    const FAxisKernel& KernelX() const { return _kernelX; }
+    const FAxisKernel& KernelY() const { return _kernelY; }
+
+    // src and dst can use different formats, flags or gammas
+    bool Resample(
+        const FImageResampleLayout& dst, const FRawMemory& dstData,
+        const FImageResampleLayout& src, const FRawMemoryConst& srcData,
+        ITaskContext* context = nullptr ) const;
+
+    // both images must hold linear and alpha weighted texels, see DecodeLinear()
+    void ResampleLinear(
+        const TMemoryView<float4>& dst,
+        const TMemoryView<const float4>& src,
+        ITaskContext* context = nullptr ) const;
+    // decodes src on the fly, without allocating a linear copy of the whole source
+    bool ResampleLinear(
+        const TMemoryView<float4>& dst,
+        const FImageResampleLayout& src, const FRawMemoryConst& srcData,
+        ITaskContext* context = nullptr ) const;
+
+    // missing components are decoded as 0, or 1 for alpha
+    // color is weighted by alpha, unless the source is already flagged with PreMultipliedAlpha
+    static bool DecodeLinear(
+        const TMemoryView<float4>& dst,
+        const FImageResampleLayout& src, const FRawMemoryConst& srcData,
+        ITaskContext* context = nullptr );
+    static bool EncodeLinear(
+        const FImageResampleLayout& dst, const FRawMemory& dstData,
+        const TMemoryView<const float4>& src,
+        ITaskContext* context = nullptr );
+
+    NODISCARD static bool SupportsFormat(ETextureSourceFormat format) NOEXCEPT;
+
+private:
+    template <typename _Reader, typename _Writer>
+    void Resample_(const _Reader& reader, const _Writer& writer, ITaskContext* context) const;
+
+    uint2 _srcDimensions;
+    uint2 _dstDimensions;
+    EImageResampleFilter _filter;
+    bool _bWrapEdges;
+
+    FAxisKernel _kernelX;
+    FAxisKernel _kernelY;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ContentPipeline
+} //!namespace PPE
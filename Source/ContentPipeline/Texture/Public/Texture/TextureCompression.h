@@ -26,6 +26,9 @@ public:
 
     NODISCARD virtual RHI::EPixelFormat Format() const NOEXCEPT = 0;
 
+    // several compressions can encode the same format: the highest priority is preferred
+    NODISCARD virtual i32 Priority() const NOEXCEPT { return 0; }
+
     NODISCARD virtual bool SupportsTextureSource(const FTextureSourceProperties& src, const FTextureCompressionSettings& settings) const NOEXCEPT = 0;
 
     NODISCARD virtual bool CompressTexture(FTexture2D& dst, const FTextureSource& src, const FTextureCompressionSettings& settings) const = 0;
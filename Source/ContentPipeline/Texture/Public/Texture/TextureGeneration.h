@@ -75,6 +75,11 @@ private:
         ETextureGammaSpace inputGamma,
         const FRawMemoryConst& inputData ) const;
 
+    void PostProcessMip2D(
+        const FTextureSourceProperties& properties,
+        const uint2& outputDimensions,
+        const FRawMemory& outputData ) const;
+
     NODISCARD bool GenerateSliceMipChain2D(
         const FTextureSourceProperties& properties,
         const FRawMemory& sliceData ) const;
@@ -10,15 +10,20 @@ namespace Test {
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 extern void Test_Allocators();
+extern void Test_BuildGraph();
+extern bool Test_RunBuildWorkerIFN();
 extern void Test_Format();
 extern void Test_Containers();
+extern void Test_ECS();
 extern void Test_RTTI();
 extern void Test_Maths();
 extern void Test_Memory();
+extern void Test_MeshBuilder();
 extern void Test_Network();
 //extern void Test_Pixmap();
 extern void Test_Opaq();
 extern void Test_Process();
+extern void Test_Texture();
 extern void Test_Thread();
 extern void Test_XML();
 // extern void Test_Lattice();
@@ -39,6 +44,10 @@ void FTestApp::Start() {
 void FTestApp::Run() {
     parent_type::Run();
 
+    // Test_BuildGraph() spawns this executable as a synthetic build tool
+    if (Test_RunBuildWorkerIFN())
+        return;
+
     using FAppNotify = Application::FPlatformNotification;
 
     typedef void(*test_t)();
@@ -49,10 +58,14 @@ void FTestApp::Run() {
         &Test_Thread,
         &Test_Maths,
         &Test_Memory,
+        &Test_MeshBuilder,
         &Test_Opaq,
         &Test_VFS,
+        &Test_ECS,
+        &Test_BuildGraph,
         &Test_Process,
         &Test_RTTI,
+        &Test_Texture,
         &Test_XML,
         // &Test_Lattice,
         //&Test_Pixmap, // #TODO refactoring the asset generation pipeline
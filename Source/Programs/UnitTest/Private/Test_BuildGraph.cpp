@@ -0,0 +1,797 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "BuildCache.h"
+#include "BuildEnvironment.h"
+#include "BuildExecutor.h"
+#include "BuildGraph.h"
+#include "BuildLog.h"
+#include "BuildNode.h"
+#include "BuildProfiler.h"
+#include "BuildWorkerFarm.h"
+#include "FileStatCache.h"
+#include "PackedBuildCache.h"
+
+#include "Container/RawStorage.h"
+#include "Container/Vector.h"
+#include "Diagnostic/Benchmark.h"
+#include "Diagnostic/CurrentProcess.h"
+#include "Diagnostic/Logger.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/TargetPlatform.h"
+#include "IO/Dirpath.h"
+#include "IO/Filename.h"
+#include "IO/Format.h"
+#include "IO/FormatHelpers.h"
+#include "IO/StringBuilder.h"
+#include "Maths/RandomGenerator.h"
+#include "Memory/HashFunctions.h"
+#include "Memory/SharedBuffer.h"
+#include "RTTI/Macros.h"
+#include "RTTI/Macros-impl.h"
+#include "RTTI/Module.h"
+#include "RTTI/Module-impl.h"
+#include "Thread/Task/TaskManager.h"
+#include "Thread/ThreadContext.h"
+#include "Thread/ThreadPool.h"
+#include "Time/Timepoint.h"
+#include "Time/Timestamp.h"
+#include "VirtualFileSystem_fwd.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace PPE {
+namespace Test {
+LOG_CATEGORY(, Test_BuildGraph)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+using namespace ContentPipeline;
+//----------------------------------------------------------------------------
+NODISCARD static FBuildFingerpint EntryFingerprint_(u64 index) {
+    return Fingerprint128(&index, sizeof(index));
+}
+//----------------------------------------------------------------------------
+NODISCARD static size_t EntrySize_(u64 index) {
+    return checked_cast<size_t>(64 + (index * 2654435761ull) % 4000);
+}
+//----------------------------------------------------------------------------
+// odd entries are random, even entries are repetitive and compress well
+static void EntryContent_(RAWSTORAGE(Benchmark, u8)& content, u64 index, size_t sizeInBytes) {
+    content.Resize_DiscardData(sizeInBytes);
+
+    FRandomGenerator rand(index);
+    forrange(i, 0, sizeInBytes)
+        content[i] = static_cast<u8>(index & 1 ? rand.Next() : 'a' + (i + index) % 7);
+}
+//----------------------------------------------------------------------------
+NODISCARD static bool CheckEntry_(IBuildCache& cache, u64 index) {
+    const UStreamReader reader = cache.Read(EntryFingerprint_(index));
+    if (not reader)
+        return false;
+
+    RAWSTORAGE(Benchmark, u8) expected;
+    EntryContent_(expected, index, EntrySize_(index));
+
+    RAWSTORAGE(Benchmark, u8) content;
+    content.Resize_DiscardData(checked_cast<size_t>(reader->SizeInBytes()));
+    return (content.SizeInBytes() == expected.SizeInBytes() and
+        reader->Read(content.data(), content.SizeInBytes()) and
+        FPlatformMemory::Memcmp(content.data(), expected.data(), expected.SizeInBytes()) == 0 );
+}
+//----------------------------------------------------------------------------
+static void WriteEntries_(IBuildCache& cache, u64 first, u64 last) {
+    RAWSTORAGE(Benchmark, u8) content;
+    forrange(i, first, last) {
+        EntryContent_(content, i, EntrySize_(i));
+        VerifyRelease(cache.Write(EntryFingerprint_(i), content.MakeConstView()));
+    }
+}
+//----------------------------------------------------------------------------
+static void RemoveIndex_(const FDirpath& path) {
+    Unused(VFS_RemoveFile(path / FBasename(L"index-0.pidx")));
+    Unused(VFS_RemoveFile(path / FBasename(L"index-1.pidx")));
+}
+//----------------------------------------------------------------------------
+static void Test_PackedBuildCache_() {
+    const FDirpath path{ L"Saved:/BuildGraph/PackedCache" };
+    Unused(VFS_RemoveDirectory(path));
+
+    FPackedBuildCacheOptions options;
+    options.MaxPackSizeInBytes = 256 << 10; // force several packs
+
+    STATIC_CONST_INTEGRAL(u64, NumEntries, 2000);
+
+    // write, read back, deduplicate
+    {
+        FPackedBuildCache cache{ path, true, options };
+        WriteEntries_(cache, 0, NumEntries);
+        WriteEntries_(cache, 0, 10);
+
+        forrange(i, 0, NumEntries)
+            AssertRelease(CheckEntry_(cache, i));
+        AssertRelease(not cache.Read(EntryFingerprint_(NumEntries)));
+
+        const FPackedBuildCacheStatistics stats = cache.Statistics();
+        AssertRelease(stats.NumEntries == NumEntries);
+        AssertRelease(stats.Writes == NumEntries);
+        AssertRelease(stats.Duplicates == 10);
+        AssertRelease(stats.Hits == NumEntries);
+        AssertRelease(stats.Misses == 1);
+        AssertRelease(stats.NumPacks > 1);
+        AssertRelease(stats.LiveSizeInBytes == stats.PackSizeInBytes);
+    }
+
+    // the index saved by the destructor is loaded as is
+    {
+        const FPackedBuildCache cache{ path, false, options };
+        const FPackedBuildCacheStatistics stats = cache.Statistics();
+        AssertRelease(stats.NumEntries == NumEntries);
+        AssertRelease(stats.RecoveredEntries == 0);
+    }
+
+    // lost index: everything is recovered from the packs
+    RemoveIndex_(path);
+    {
+        FPackedBuildCache cache{ path, true, options };
+        AssertRelease(cache.Statistics().RecoveredEntries == NumEntries);
+        forrange(i, 0, NumEntries)
+            AssertRelease(CheckEntry_(cache, i));
+
+        // entries written after the last snapshot are recovered from the pack tails
+        WriteEntries_(cache, NumEntries, NumEntries + 100);
+        VerifyRelease(cache.Flush());
+        WriteEntries_(cache, NumEntries + 100, NumEntries + 200);
+    }
+
+    // torn write: the last record of the last pack is truncated
+    {
+        FFilename lastPack;
+        VFS_GlobFiles(path, L"*.pack", false, [&lastPack](const FFilename& fname) {
+            if (lastPack.empty() or lastPack < fname)
+                lastPack = fname;
+        });
+        AssertRelease(not lastPack.empty());
+
+        const FUniqueBuffer content = VFS_ReadAll(lastPack, EAccessPolicy::Binary);
+        AssertRelease(content.SizeInBytes() > 16);
+        VerifyRelease(VFS_WriteAll(lastPack, content.MakeView().ShiftBack(16), EAccessPolicy::Truncate_Binary));
+
+        FPackedBuildCache cache{ path, true, options };
+        AssertRelease(cache.Statistics().NumEntries == NumEntries + 200 - 1);
+        AssertRelease(not cache.Contains(EntryFingerprint_(NumEntries + 199)));
+        forrange(i, NumEntries, NumEntries + 199)
+            AssertRelease(CheckEntry_(cache, i));
+    }
+
+    // LRU: the entries read by the last build survive the eviction
+    STATIC_CONST_INTEGRAL(u64, NumTouched, NumEntries / 4);
+    u64 liveSizeInBytes;
+    {
+        FPackedBuildCache cache{ path, true, options };
+        cache.Initialize(FTimestamp::Now());
+        forrange(i, 0, NumTouched)
+            AssertRelease(CheckEntry_(cache, i));
+
+        liveSizeInBytes = cache.Statistics().LiveSizeInBytes;
+    }
+    {
+        FPackedBuildCacheOptions budget = options;
+        budget.MaxSizeInBytes = liveSizeInBytes / 2;
+
+        FPackedBuildCache cache{ path, true, budget };
+        const FPackedBuildCacheStatistics before = cache.Statistics();
+
+        cache.Cleanup();
+
+        const FPackedBuildCacheStatistics after = cache.Statistics();
+        AssertRelease(after.Evictions > 0);
+        AssertRelease(after.LiveSizeInBytes <= budget.MaxSizeInBytes);
+        AssertRelease(after.NumEntries + after.Evictions == before.NumEntries);
+        AssertRelease(after.PackSizeInBytes < before.PackSizeInBytes); // sparse packs were rewritten
+        AssertRelease(after.CompactedSizeInBytes > 0);
+
+        forrange(i, 0, NumTouched)
+            AssertRelease(CheckEntry_(cache, i));
+    }
+
+    // compaction is persisted
+    {
+        const FPackedBuildCache cache{ path, false, options };
+        const FPackedBuildCacheStatistics stats = cache.Statistics();
+        AssertRelease(stats.RecoveredEntries == 0);
+        AssertRelease(stats.LiveSizeInBytes <= liveSizeInBytes / 2);
+
+        forrange(i, 0, NumTouched)
+            AssertRelease(cache.Contains(EntryFingerprint_(i)));
+    }
+
+    VerifyRelease(VFS_RemoveDirectory(path));
+}
+//----------------------------------------------------------------------------
+static void Test_FileStatCache_() {
+    const FDirpath path{ L"Saved:/BuildGraph/StatCache" };
+    Unused(VFS_RemoveDirectory(path));
+    VerifyRelease(VFS_CreateDirectory(path));
+
+    const FFilename cachePath = path / FBasename(L"stat.cache");
+    const FFilename smallFile = path / FBasename(L"small.bin");
+    const FFilename largeFile = path / FBasename(L"large.bin");
+
+    RAWSTORAGE(Benchmark, u8) smallContent, largeContent;
+    EntryContent_(smallContent, 1, 1000);
+    EntryContent_(largeContent, 3, FFileStatCache::ChunkSizeInBytes * 2 + 123);
+
+    VerifyRelease(VFS_WriteAll(smallFile, smallContent.MakeConstView(), EAccessPolicy::Truncate_Binary));
+    VerifyRelease(VFS_WriteAll(largeFile, largeContent.MakeConstView(), EAccessPolicy::Truncate_Binary));
+
+    // files hashed in the same second as they were modified are always rehashed
+    FPlatformProcess::Sleep(1.1f);
+
+    FBuildFingerpint smallFingerprint, largeFingerprint;
+    {
+        FFileStatCache cache{ cachePath };
+
+        bool rehashed = false;
+        VerifyRelease(cache.Fingerprint(&smallFingerprint, smallFile, &rehashed));
+        AssertRelease(rehashed);
+        AssertRelease(smallFingerprint == hash_128(smallContent.data(), smallContent.SizeInBytes()));
+
+        // chunks are hashed in parallel, but the fingerprint is the same as a sequential hash of the chunks
+        VerifyRelease(cache.Fingerprint(&largeFingerprint, largeFile, &rehashed));
+        AssertRelease(rehashed);
+        {
+            VECTOR(Benchmark, u128) chunks;
+            for (FRawMemoryConst it = largeContent.MakeConstView(); not it.empty(); ) {
+                const FRawMemoryConst chunk = it.CutBefore(Min(it.size(), FFileStatCache::ChunkSizeInBytes));
+                chunks.push_back(hash_128(chunk.data(), chunk.SizeInBytes()));
+                it = it.CutStartingAt(chunk.size());
+            }
+            AssertRelease(largeFingerprint == hash_128(chunks.data(), chunks.size() * sizeof(u128), largeContent.SizeInBytes()));
+        }
+
+        FBuildFingerpint fingerprint;
+        VerifyRelease(cache.Fingerprint(&fingerprint, smallFile, &rehashed));
+        AssertRelease(not rehashed);
+        AssertRelease(fingerprint == smallFingerprint);
+
+        VerifyRelease(cache.Fingerprint(&fingerprint, largeFile, &rehashed));
+        AssertRelease(not rehashed);
+        AssertRelease(fingerprint == largeFingerprint);
+
+        // touched with the same content: rehashed, but the fingerprint doesn't change
+        VerifyRelease(VFS_WriteAll(smallFile, smallContent.MakeConstView(), EAccessPolicy::Truncate_Binary));
+        VerifyRelease(cache.Fingerprint(&fingerprint, smallFile, &rehashed));
+        AssertRelease(rehashed);
+        AssertRelease(fingerprint == smallFingerprint);
+
+        // same size and maybe same timestamp, but a different content
+        smallContent[0] ^= 0xFF;
+        VerifyRelease(VFS_WriteAll(smallFile, smallContent.MakeConstView(), EAccessPolicy::Truncate_Binary));
+        VerifyRelease(cache.Fingerprint(&fingerprint, smallFile, &rehashed));
+        AssertRelease(rehashed);
+        AssertRelease(fingerprint != smallFingerprint);
+        smallFingerprint = fingerprint;
+
+        AssertRelease(not cache.Fingerprint(&fingerprint, path / FBasename(L"missing.bin")));
+
+        const FFileStatCacheStatistics stats = cache.Statistics();
+        AssertRelease(stats.NumEntries == 2);
+        AssertRelease(stats.FilesHashed == 4);
+        AssertRelease(stats.FilesSkipped == 2);
+        AssertRelease(stats.FilesMissing == 1);
+    }
+
+    // entries are persisted: the large file isn't hashed again
+    {
+        FFileStatCache cache{ cachePath };
+        AssertRelease(cache.Statistics().NumEntries == 2);
+
+        bool rehashed = true;
+        FBuildFingerpint fingerprint;
+        VerifyRelease(cache.Fingerprint(&fingerprint, largeFile, &rehashed));
+        AssertRelease(not rehashed);
+        AssertRelease(fingerprint == largeFingerprint);
+
+        VerifyRelease(cache.Fingerprint(&fingerprint, smallFile));
+        AssertRelease(fingerprint == smallFingerprint);
+    }
+
+    // a corrupted cache is ignored
+    {
+        FUniqueBuffer content = VFS_ReadAll(cachePath, EAccessPolicy::Binary);
+        VerifyRelease(content);
+        content.MakeView().back() ^= 0xFF;
+        VerifyRelease(VFS_WriteAll(cachePath, content.MakeView(), EAccessPolicy::Truncate_Binary));
+
+        FFileStatCache cache{ cachePath };
+        AssertRelease(cache.Statistics().NumEntries == 0);
+    }
+
+    VerifyRelease(VFS_RemoveDirectory(path));
+}
+//----------------------------------------------------------------------------
+static void Test_BuildProfiler_() {
+    const FDirpath path{ L"Saved:/BuildGraph/Profiler" };
+    Unused(VFS_RemoveDirectory(path));
+    VerifyRelease(VFS_CreateDirectory(path));
+
+    const FFilename historyPath = path / FBasename(L"build.history");
+    const FFilename tracePath = path / FBasename(L"build.trace.json");
+
+    const FBuildFingerpint fast = EntryFingerprint_(1);
+    const FBuildFingerpint slow = EntryFingerprint_(2);
+
+    {
+        FBuildProfiler profiler{ historyPath };
+        AssertRelease(profiler.NumHistoryEntries() == 0);
+
+        FTimespan estimate;
+        AssertRelease(not profiler.EstimatePath(&estimate, fast));
+        AssertRelease(not profiler.EstimatePath(&estimate, FBuildFingerpint::Zero()));
+
+        profiler.RecordPath(fast, FMilliseconds{ 10.0 });
+        profiler.RecordPath(slow, FMilliseconds{ 400.0 });
+        profiler.RecordPath(slow, FMilliseconds{ 800.0 }); // moving average: (400*3 + 800) / 4
+        profiler.RecordPath(FBuildFingerpint::Zero(), FMilliseconds{ 1.0 }); // ignored
+        AssertRelease(profiler.NumHistoryEntries() == 2);
+
+        VerifyRelease(profiler.EstimatePath(&estimate, fast));
+        AssertRelease(estimate.Value() == 10.0);
+        AssertRelease(profiler.CriticalPath().Value() == 10.0);
+
+        VerifyRelease(profiler.EstimatePath(&estimate, slow));
+        AssertRelease(estimate.Value() == 500.0);
+        AssertRelease(profiler.CriticalPath().Value() == 500.0);
+
+        profiler.ResetCriticalPath();
+        AssertRelease(profiler.CriticalPath().Value() == 0.0);
+    }
+
+    // the history is saved by the destructor
+    {
+        FBuildProfiler profiler{ historyPath };
+        AssertRelease(profiler.NumHistoryEntries() == 2);
+
+        FTimespan estimate;
+        VerifyRelease(profiler.EstimatePath(&estimate, slow));
+        AssertRelease(estimate.Value() == 500.0);
+
+        // nothing is traced while disabled, but the export is still valid
+        AssertRelease(not profiler.Tracing());
+        AssertRelease(profiler.NumTraceEvents() == 0);
+        VerifyRelease(profiler.ExportChromeTrace(tracePath));
+        AssertRelease(VFS_FileExists(tracePath));
+    }
+
+    // a corrupted history is ignored
+    {
+        FUniqueBuffer content = VFS_ReadAll(historyPath, EAccessPolicy::Binary);
+        VerifyRelease(content);
+        content.MakeView().back() ^= 0xFF;
+        VerifyRelease(VFS_WriteAll(historyPath, content.MakeView(), EAccessPolicy::Truncate_Binary));
+
+        FBuildProfiler profiler{ historyPath };
+        AssertRelease(profiler.NumHistoryEntries() == 0);
+    }
+
+    VerifyRelease(VFS_RemoveDirectory(path));
+}
+//----------------------------------------------------------------------------
+RTTI_MODULE_DECL(, BuildGraph_UnitTest);
+RTTI_MODULE_DEF(, BuildGraph_UnitTest, MetaObject);
+//----------------------------------------------------------------------------
+// sleeps while scanned, so the executor has some work to schedule
+FWD_REFPTR(SleepNode_);
+class FSleepNode_ : public FBuildNode {
+public:
+    RTTI_CLASS_HEADER(, FSleepNode_, FBuildNode);
+
+    FSleepNode_() NOEXCEPT = default;
+    FSleepNode_(const FWStringView& name, EBuildResourceClass resource, float workInSeconds, FSleepNode_* dep = nullptr) NOEXCEPT
+    :   _name(name)
+    ,   _resource(resource)
+    ,   _workInSeconds(workInSeconds) {
+        if (dep)
+            AddStaticDep(dep);
+    }
+
+    virtual EBuildResult Scan(FScanContext&) override {
+        FPlatformProcess::Sleep(_workInSeconds);
+        return EBuildResult::UpToDate;
+    }
+    virtual EBuildResult Import(FBuildContext&) override { return EBuildResult::UpToDate; }
+    virtual EBuildResult Process(FBuildContext&) override { return EBuildResult::UpToDate; }
+    virtual EBuildResult Clean(FCleanContext&) override { return EBuildResult::UpToDate; }
+
+    virtual FWString BuildName() const override { return _name; }
+    virtual EBuildResourceClass ResourceClass() const override { return _resource; }
+
+private:
+    FWString _name;
+    EBuildResourceClass _resource{ EBuildResourceClass::Light };
+    float _workInSeconds{ 0 };
+};
+RTTI_CLASS_BEGIN(BuildGraph_UnitTest, FSleepNode_, Concrete)
+RTTI_CLASS_END()
+//----------------------------------------------------------------------------
+static void Test_BuildExecutor_() {
+    const FDirpath path{ L"Saved:/BuildGraph/Executor" };
+    Unused(VFS_RemoveDirectory(path));
+    VerifyRelease(VFS_CreateDirectory(path));
+
+    // a chain of 3 nodes listed after 3 short nodes, everything is cpu heavy
+    const PSleepNode_ chain3{ NEW_RTTI(FSleepNode_, L"chain3"_view, EBuildResourceClass::CpuHeavy, 0.01f) };
+    const PSleepNode_ chain2{ NEW_RTTI(FSleepNode_, L"chain2"_view, EBuildResourceClass::CpuHeavy, 0.01f, chain3.get()) };
+    const PSleepNode_ chain1{ NEW_RTTI(FSleepNode_, L"chain1"_view, EBuildResourceClass::CpuHeavy, 0.01f, chain2.get()) };
+    const PSleepNode_ shorts[] = {
+        PSleepNode_{ NEW_RTTI(FSleepNode_, L"short1"_view, EBuildResourceClass::CpuHeavy, 0.005f) },
+        PSleepNode_{ NEW_RTTI(FSleepNode_, L"short2"_view, EBuildResourceClass::CpuHeavy, 0.005f) },
+        PSleepNode_{ NEW_RTTI(FSleepNode_, L"short3\U0001F600"_view, EBuildResourceClass::CpuHeavy, 0.005f) }, // outside of the BMP, exported as a surrogate pair
+    };
+
+    FBuildGraph graph;
+    for (const PSleepNode_& node : shorts)
+        graph.AddNode(node.get());
+    graph.AddNode(chain1.get());
+
+    {
+        const UBuildCache cache = MakeLocalBuildCache(path, true);
+        const UBuildLog log = MakeDiagnosticsBuildLog();
+
+        // scans the graph with at most one cpu heavy node at a time, returns the traced cpu heavy work sorted by start
+        const auto scanWith = [&](FTaskManager& pool, FBuildProfiler& profiler) {
+            FParallelExecutorOptions options;
+            options.Profiler = &profiler;
+            options.MaxConcurrency[static_cast<size_t>(EBuildResourceClass::CpuHeavy)] = 1;
+
+            const UBuildExecutor executor = MakeParallelExecutor(pool, options);
+            const FBuildEnvironment env{ CurrentPlatform(), path, *cache, *executor, *log };
+
+            profiler.SetTracing(true);
+            AssertRelease(graph.ScanAll(env) == EBuildResult::UpToDate);
+
+            VECTOR(BuildGraph, FBuildTraceEvent) events;
+            for (FBuildTraceEvent& ev : profiler.TraceEvents()) {
+                if (EBuildResourceClass::CpuHeavy == ev.Resource)
+                    events.push_back(std::move(ev));
+            }
+
+            std::sort(events.begin(), events.end(), [](const FBuildTraceEvent& lhs, const FBuildTraceEvent& rhs) {
+                return (lhs.StartInMicros < rhs.StartInMicros);
+            });
+
+            AssertRelease(events.size() == 6);
+            return events;
+        };
+
+        // the resource gate never lets cpu heavy work overlap, even with all the workers
+        {
+            FBuildProfiler profiler;
+            const auto events = scanWith(FGlobalThreadPool::Get(), profiler);
+
+            forrange(i, 1, events.size())
+                AssertRelease(events[i - 1].StartInMicros + events[i - 1].DurationInMicros <= events[i].StartInMicros);
+        }
+
+        // longest estimated paths are dispatched first: the history is seeded, and a single worker keeps the order deterministic
+        {
+            FBuildProfiler profiler;
+            profiler.RecordPath(FBuildProfiler::HistoryKey(*chain1, EBuildStep::Scan), FMilliseconds{ 30.0 });
+            profiler.RecordPath(FBuildProfiler::HistoryKey(*chain2, EBuildStep::Scan), FMilliseconds{ 29.0 });
+            profiler.RecordPath(FBuildProfiler::HistoryKey(*chain3, EBuildStep::Scan), FMilliseconds{ 28.0 });
+            for (const PSleepNode_& node : shorts)
+                profiler.RecordPath(FBuildProfiler::HistoryKey(*node, EBuildStep::Scan), FMilliseconds{ 1.0 });
+
+            FTaskManager pool{ "BuildExecutor", PPE_THREADTAG_WORKER, 1, EThreadPriority::Normal };
+            pool.Start();
+
+            const auto events = scanWith(pool, profiler);
+
+            pool.Shutdown();
+
+            // the whole chain runs before the short nodes, which were listed first
+            AssertRelease(Equals(events[0].Name.MakeView(), L"chain3"_view));
+            AssertRelease(Equals(events[1].Name.MakeView(), L"chain2"_view));
+            AssertRelease(Equals(events[2].Name.MakeView(), L"chain1"_view));
+
+            FStringBuilder json;
+            profiler.ExportChromeTrace(json);
+            AssertRelease(HasSubString(json.Written(), "\"short3\\ud83d\\ude00\""_view));
+        }
+    }
+
+    VerifyRelease(VFS_RemoveDirectory(path));
+}
+//----------------------------------------------------------------------------
+// this executable is its own synthetic tool, see Test_RunBuildWorkerIFN()
+static const FWStringLiteral BuildWorkerArgument_{ L"-BuildWorker" };
+//----------------------------------------------------------------------------
+// arguments are (name, cost): hashes a buffer cost times, fails when named "fail"
+static void SyntheticTool_(FBuildWorkerResult* outResult, const FBuildWorkerJob& job) {
+    if (job.Arguments.size() != 2 or Equals(job.Arguments[0].MakeView(), "fail"_view)) {
+        outResult->ExitCode = 1;
+        outResult->Log = "synthetic tool failure";
+        return;
+    }
+
+    u32 cost = 0;
+    VerifyRelease(Atoi(&cost, job.Arguments[1].MakeView(), 10));
+
+    RAWSTORAGE(Benchmark, u8) content;
+    EntryContent_(content, hash_mem64(job.Arguments[0].data(), job.Arguments[0].size()), 4096);
+
+    FBuildFingerpint digest = hash_128(job.Inputs.data(), job.Inputs.size() * sizeof(FBuildFingerpint));
+    forrange(i, 0, cost)
+        digest = hash_128(content.data(), content.SizeInBytes(), digest.lo ^ digest.hi);
+
+    outResult->ExitCode = 0;
+    outResult->Output.Resize_DiscardData(sizeof(digest));
+    MakePodView(digest).CopyTo(outResult->Output.MakeView());
+}
+//----------------------------------------------------------------------------
+NODISCARD static FBuildWorkerJob SyntheticJob_(const FStringView& name, u32 cost) {
+    FBuildWorkerJob job;
+    job.Arguments.emplace_back(name);
+    job.Arguments.push_back(StringFormat("{0}", cost));
+    job.Inputs.push_back(EntryFingerprint_(cost));
+    job.Fingerprint = FBuildWorkerJob::MakeFingerprint(job);
+    return job;
+}
+//----------------------------------------------------------------------------
+NODISCARD static FFilename SyntheticToolExecutable_() {
+    return FFilename{ CurrentProcess().FileName().MakeView() };
+}
+//----------------------------------------------------------------------------
+static void Test_BuildWorkerFarm_() {
+    const FDirpath path{ L"Saved:/BuildGraph/WorkerFarm" };
+    Unused(VFS_RemoveDirectory(path));
+
+    STATIC_CONST_INTEGRAL(u32, NumJobs, 16);
+
+    VECTOR(Benchmark, FBuildWorkerJob) jobs;
+    VECTOR(Benchmark, FBuildWorkerResult) results;
+    forrange(i, 0, NumJobs)
+        jobs.push_back(SyntheticJob_(StringFormat("job{0}", i).MakeView(), 10 + i));
+    results.resize(NumJobs);
+
+    FBuildWorkerFarmOptions options;
+    options.MaxWorkers = 2;
+    options.MaxJobsPerBatch = 4;
+    options.MaxJobsPerWorker = 8;
+
+    FPackedBuildCache cache{ path, true };
+    FBuildWorkerFarm farm{ SyntheticToolExecutable_(), BuildWorkerArgument_, FDirpath{}, options };
+
+    // results are streamed back from the workers, which are recycled after 8 jobs
+    VerifyRelease(farm.ExecuteBatch(results.MakeView(), jobs.MakeConstView(), &cache));
+    forrange(i, 0, NumJobs) {
+        FBuildWorkerResult expected;
+        SyntheticTool_(&expected, jobs[i]);
+
+        AssertRelease(0 == results[i].ExitCode);
+        AssertRelease(not results[i].FromCache);
+        AssertRelease(results[i].Output.SizeInBytes() == expected.Output.SizeInBytes());
+        AssertRelease(FPlatformMemory::Memcmp(results[i].Output.data(), expected.Output.data(), expected.Output.SizeInBytes()) == 0);
+    }
+    {
+        const FBuildWorkerFarmStatistics stats = farm.Statistics();
+        AssertRelease(stats.NumJobs == NumJobs);
+        AssertRelease(stats.NumBatches == NumJobs / options.MaxJobsPerBatch);
+        AssertRelease(stats.NumCacheHits == 0);
+        AssertRelease(stats.NumRecycles >= 1);
+        AssertRelease(stats.NumCrashes == 0);
+        // recycled workers must see the end of their stdin and exit by themselves
+        AssertRelease(stats.NumGracefulExits == stats.NumRecycles);
+        AssertRelease(farm.NumWorkers() <= options.MaxWorkers);
+    }
+
+    // the same jobs are served by the build cache
+    farm.ResetStatistics();
+    VerifyRelease(farm.ExecuteBatch(results.MakeView(), jobs.MakeConstView(), &cache));
+    forrange(i, 0, NumJobs)
+        AssertRelease(results[i].FromCache);
+    AssertRelease(farm.Statistics().NumCacheHits == NumJobs);
+    AssertRelease(farm.Statistics().NumSpawns == 0);
+
+    // a tool failure is not a worker failure, and is never cached
+    FBuildWorkerResult failure;
+    VerifyRelease(farm.Execute(&failure, SyntheticJob_("fail"_view, 1), &cache));
+    AssertRelease(0 != failure.ExitCode);
+    AssertRelease(not failure.Log.empty());
+
+    VerifyRelease(farm.Execute(&failure, SyntheticJob_("fail"_view, 1), &cache));
+    AssertRelease(not failure.FromCache);
+
+    farm.ResetStatistics();
+    const size_t numIdleWorkers = farm.NumWorkers();
+    farm.Shutdown();
+    AssertRelease(0 == farm.NumWorkers());
+    AssertRelease(farm.Statistics().NumGracefulExits == numIdleWorkers);
+
+    VerifyRelease(VFS_RemoveDirectory(path));
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkBuildCache {
+class FBuildCacheBenchmark : public FBenchmark {
+public:
+    enum EMode { LookupHit, LookupMiss, Insert };
+
+    FPackedBuildCache& Cache;
+    EMode Mode;
+    u64 NumEntries;
+    std::atomic<u64>& NextInsert;
+
+    FBuildCacheBenchmark(FStringView name, FPackedBuildCache& cache, EMode mode, u64 numEntries, std::atomic<u64>& nextInsert)
+    :   FBenchmark{ name }, Cache(cache), Mode(mode), NumEntries(numEntries), NextInsert(nextInsert)
+    {}
+
+    void operator ()(FBenchmark::FState& state) const {
+        FRandomGenerator rand(RandomSeed);
+        RAWSTORAGE(Benchmark, u8) content;
+        EntryContent_(content, 0, 64);
+
+        for (auto _ : state) {
+            switch (Mode) {
+            case LookupHit:
+            case LookupMiss: {
+                const u64 index = (Mode == LookupHit ? rand.NextU64(NumEntries) : (1ull << 63) | rand.NextU64());
+                const UStreamReader reader = Cache.Read(EntryFingerprint_(index));
+                FBenchmark::DoNotOptimize(reader);
+                break;
+            }
+            case Insert: {
+                const u64 index = NextInsert.fetch_add(1, std::memory_order_relaxed);
+                const bool succeed = Cache.Write(EntryFingerprint_(index), content.MakeConstView());
+                FBenchmark::DoNotOptimize(succeed);
+                break;
+            }
+            }
+        }
+    }
+};
+} //!namespace BenchmarkBuildCache
+//----------------------------------------------------------------------------
+static void Benchmark_PackedBuildCache_() {
+    using namespace BenchmarkBuildCache;
+
+    const FDirpath path{ L"Saved:/BuildGraph/PackedCacheBenchmark" };
+    Unused(VFS_RemoveDirectory(path));
+
+    STATIC_CONST_INTEGRAL(u64, NumEntries, 1000000);
+
+    // small entries, below the compression threshold: timings are dominated by the index
+    {
+        FPackedBuildCache cache{ path, true };
+
+        RAWSTORAGE(Benchmark, u8) content;
+        const FTimepoint startedAt = FTimepoint::Now();
+        forrange(i, 0, NumEntries) {
+            EntryContent_(content, i, 64);
+            VerifyRelease(cache.Write(EntryFingerprint_(i), content.MakeConstView()));
+        }
+
+        PPE_LOG(Test_BuildGraph, Info, "packed build cache: inserted {0} entries in {1}",
+            NumEntries, Fmt::DurationInMs(FTimepoint::ElapsedSince(startedAt)) );
+    }
+
+    {
+        const FTimepoint startedAt = FTimepoint::Now();
+        FPackedBuildCache cache{ path, true };
+
+        PPE_LOG(Test_BuildGraph, Info, "packed build cache: opened {0} entries in {1}",
+            cache.Statistics().NumEntries, Fmt::DurationInMs(FTimepoint::ElapsedSince(startedAt)) );
+
+        std::atomic<u64> nextInsert{ NumEntries };
+
+        auto bm = FBenchmark::MakeTable("PackedBuildCache"_view,
+            FBuildCacheBenchmark{ "lookup_hit"_view, cache, FBuildCacheBenchmark::LookupHit, NumEntries, nextInsert },
+            FBuildCacheBenchmark{ "lookup_miss"_view, cache, FBuildCacheBenchmark::LookupMiss, NumEntries, nextInsert },
+            FBuildCacheBenchmark{ "insert"_view, cache, FBuildCacheBenchmark::Insert, NumEntries, nextInsert } );
+
+        bm.Run("1M_entries"_view);
+
+        FBenchmark::FlushAndLog(bm);
+
+        // nothing to evict or compact: only scans the index
+        const FTimepoint cleanupAt = FTimepoint::Now();
+        cache.Cleanup();
+
+        PPE_LOG(Test_BuildGraph, Info, "packed build cache: cleanup of {0} entries without eviction in {1}",
+            cache.Statistics().NumEntries, Fmt::DurationInMs(FTimepoint::ElapsedSince(cleanupAt)) );
+    }
+
+    {
+        FPackedBuildCacheOptions budget;
+        FPackedBuildCache probe{ path, false };
+        budget.MaxSizeInBytes = probe.Statistics().LiveSizeInBytes / 2;
+
+        FPackedBuildCache cache{ path, true, budget };
+
+        const FTimepoint startedAt = FTimepoint::Now();
+        cache.Cleanup();
+
+        const FPackedBuildCacheStatistics stats = cache.Statistics();
+        PPE_LOG(Test_BuildGraph, Info, "packed build cache: cleanup evicted {0} entries and compacted {1} in {2}",
+            stats.Evictions, Fmt::SizeInBytes(stats.CompactedSizeInBytes),
+            Fmt::DurationInMs(FTimepoint::ElapsedSince(startedAt)) );
+    }
+
+    VerifyRelease(VFS_RemoveDirectory(path));
+}
+//----------------------------------------------------------------------------
+// throughput of persistent workers against a process spawned for each job, without cache
+static void Benchmark_BuildWorkerFarm_() {
+    STATIC_CONST_INTEGRAL(u32, NumJobs, 256);
+
+    VECTOR(Benchmark, FBuildWorkerJob) jobs;
+    VECTOR(Benchmark, FBuildWorkerResult) results;
+    forrange(i, 0, NumJobs)
+        jobs.push_back(SyntheticJob_(StringFormat("job{0}", i).MakeView(), 100));
+    results.resize(NumJobs);
+
+    const auto run = [&](FStringLiteral name, u32 maxJobsPerWorker) {
+        FBuildWorkerFarmOptions options;
+        options.MaxJobsPerWorker = maxJobsPerWorker;
+        options.MaxJobsPerBatch = Min(8u, maxJobsPerWorker);
+
+        FBuildWorkerFarm farm{ SyntheticToolExecutable_(), BuildWorkerArgument_, FDirpath{}, options };
+
+        const FTimepoint startedAt = FTimepoint::Now();
+        VerifyRelease(farm.ExecuteBatch(results.MakeView(), jobs.MakeConstView()));
+        const FTimespan elapsed = FTimepoint::ElapsedSince(startedAt);
+
+        PPE_LOG(Test_BuildGraph, Info, "build worker farm: {0} ran {1} jobs in {2} ({3:f1} jobs/s) with {4} processes spawned",
+            name, NumJobs, Fmt::DurationInMs(elapsed),
+            NumJobs / FSeconds(elapsed).Value(),
+            farm.Statistics().NumSpawns );
+    };
+
+    run("spawn per job", 1);
+    run("persistent workers", 256);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void Test_BuildGraph() {
+    PPE_DEBUG_NAMEDSCOPE("Test_BuildGraph");
+
+    PPE_LOG(Test_BuildGraph, Emphasis, "starting build graph tests ...");
+
+    Test_PackedBuildCache_();
+    Test_FileStatCache_();
+    Test_BuildProfiler_();
+
+    RTTI_MODULE(BuildGraph_UnitTest).Start();
+    Test_BuildExecutor_();
+    RTTI_MODULE(BuildGraph_UnitTest).Shutdown();
+
+    Test_BuildWorkerFarm_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_PackedBuildCache_();
+    Benchmark_BuildWorkerFarm_();
+#endif
+}
+//----------------------------------------------------------------------------
+bool Test_RunBuildWorkerIFN() {
+    for (const FWString& arg : CurrentProcess().Args()) {
+        if (Equals(arg.MakeView(), BuildWorkerArgument_.MakeView())) {
+            RunBuildWorker(&SyntheticTool_);
+            return true;
+        }
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace Test
+} //!namespace PPE
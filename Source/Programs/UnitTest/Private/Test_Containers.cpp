@@ -8,6 +8,7 @@
 #include "Container/Appendable.h"
 #include "Container/AssociativeVector.h"
 #include "Container/BurstTrie.h"
+#include "Container/DenseSparseArray.h"
 #include "Container/FixedSizeHashTable.h"
 #include "Container/FlatMap.h"
 #include "Container/FlatSet.h"
@@ -37,9 +38,12 @@
 #include "Meta/PointerWFlags.h"
 #include "Meta/Utility.h"
 #include "Modular/Modular_fwd.h"
+#include "Thread/Task/TaskHelpers.h"
 #include "Time/TimedScope.h"
+#include "Time/Timepoint.h"
 #include "VirtualFileSystem.h"
 
+#include <atomic>
 #include <numeric>
 #include <random>
 #include <unordered_set>
@@ -1937,6 +1941,223 @@ NO_INLINE void Test_TupleVector() {
     */
 }
 //----------------------------------------------------------------------------
+NO_INLINE static void Test_SparseArray_() {
+    STATIC_CONST_INTEGRAL(u32, N, 1000);
+
+    SPARSEARRAY(Container, u32) sparse;
+
+    VECTOR(Container, FSparseDataId) ids;
+    ids.resize(N);
+    sparse.EmplaceN(ids.MakeView(), 0u);
+    AssertRelease(sparse.size() == N);
+    forrange(i, 0, N)
+        *sparse.Find(ids[i]) = i;
+
+    // remove 2 items out of 3, holes must be skipped in index order
+    VECTOR(Container, FSparseDataId) removed;
+    forrange(i, 0, N) {
+        if (i % 3)
+            removed.push_back(ids[i]);
+    }
+    AssertRelease(sparse.RemoveN(removed.MakeConstView()) == removed.size());
+    AssertRelease(sparse.RemoveN(removed.MakeConstView()) == 0); // stale ids are ignored
+    AssertRelease(sparse.size() == N - removed.size());
+    AssertRelease(sparse.CheckInvariants());
+
+    u64 expectedSum = 0;
+    {
+        u32 expected = 0;
+        for (u32 value : sparse) {
+            AssertRelease(value == expected);
+            expectedSum += value;
+            expected += 3;
+        }
+        AssertRelease(expected == 3 * sparse.size());
+    }
+    {
+        u32 expected = 0;
+        sparse.Each([&expected](u32& value) {
+            AssertRelease(value == expected);
+            expected += 3;
+        });
+        AssertRelease(expected == 3 * sparse.size());
+    }
+    {
+        size_t count = 0;
+        sparse.EachInRange(100, 200, [&count](const u32& value) {
+            AssertRelease(value >= 100 && value < 200 && 0 == value % 3);
+            count++;
+        });
+        AssertRelease(33 == count);
+    }
+    {
+        std::atomic<u64> total{ 0 };
+        ParallelForEach(sparse, [&total](u32& value) {
+            total += value;
+        });
+        AssertRelease(total == expectedSum);
+    }
+
+    // holes are reused by the next bulk insertion
+    removed.resize(N - sparse.size());
+    sparse.EmplaceN(removed.MakeView(), N);
+    AssertRelease(sparse.size() == N);
+    {
+        size_t count = 0;
+        sparse.Each([&count](const u32&) { count++; });
+        AssertRelease(count == N);
+    }
+
+    sparse.Clear();
+    AssertRelease(sparse.empty());
+    AssertRelease(sparse.begin() == sparse.end());
+
+    // the first occupancy word is stored inline: it must follow swaps, and be copied when growing past it
+    {
+        SPARSEARRAY(Container, u32) small, large;
+        forrange(i, 0, 3u)
+            small.Emplace(i);
+        forrange(i, 0, 100u)
+            large.Emplace(i);
+
+        small.Swap(large);
+        AssertRelease(small.size() == 100 && small.CheckInvariants());
+        AssertRelease(large.size() == 3 && large.CheckInvariants());
+
+        forrange(i, 3u, 100u)
+            large.Emplace(i);
+        AssertRelease(large.CheckInvariants());
+
+        u32 expected = 0;
+        for (u32 value : large)
+            AssertRelease(value == expected++);
+        AssertRelease(expected == 100);
+    }
+    {
+        SPARSEARRAY_INSITU(Container, u32) insitu;
+        forrange(i, 0, 100u)
+            insitu.Emplace(i);
+        AssertRelease(insitu.CheckInvariants());
+
+        u32 expected = 0;
+        for (u32 value : insitu)
+            AssertRelease(value == expected++);
+        AssertRelease(expected == 100);
+    }
+
+    // dense companion: same ids, but items are packed and removal moves the last item in the hole
+    DENSESPARSEARRAY(Container, u32) dense;
+    forrange(i, 0, N)
+        ids[i] = dense.Emplace(i);
+
+    removed.clear();
+    forrange(i, 0, N) {
+        if (i % 3)
+            removed.push_back(ids[i]);
+    }
+    AssertRelease(dense.RemoveN(removed.MakeConstView()) == removed.size());
+    AssertRelease(dense.size() == N - removed.size());
+    AssertRelease(dense.CheckInvariants());
+
+    u64 denseSum = 0;
+    for (u32 value : dense)
+        denseSum += value;
+    AssertRelease(denseSum == expectedSum);
+
+    forrange(i, 0, N) {
+        const u32* const value = dense.Find(ids[i]);
+        if (i % 3)
+            AssertRelease(nullptr == value);
+        else
+            AssertRelease(value && *value == i);
+    }
+    forrange(i, 0, dense.size())
+        AssertRelease(*dense.Find(dense.Ids()[i]) == dense.MakeConstView()[i]);
+
+    // stale ids are ignored after Clear(), Clear_ReleaseMemory() and on an empty container
+    const auto checkStaleIds = [&]() {
+        AssertRelease(dense.empty());
+        AssertRelease(nullptr == dense.Find(ids[0]));
+        AssertRelease(not dense.Remove(ids[N - 1]));
+        AssertRelease(0 == dense.RemoveN(ids.MakeConstView()));
+        AssertRelease(dense.CheckInvariants());
+    };
+
+    dense.Clear();
+    checkStaleIds();
+    dense.Clear_ReleaseMemory();
+    checkStaleIds();
+
+    DENSESPARSEARRAY(Container, u32) emptyDense;
+    AssertRelease(nullptr == emptyDense.Find(ids[0]));
+    AssertRelease(0 == emptyDense.RemoveN(ids.MakeConstView()));
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+template <typename _Loop>
+static void Benchmark_SparseArrayLoop_(FStringView name, size_t keepOneIn, _Loop&& loop) {
+    STATIC_CONST_INTEGRAL(size_t, NumLoops, 20);
+
+    const FTimepoint startedAt = FTimepoint::Now();
+    forrange(i, 0, NumLoops)
+        loop();
+    const FTimespan elapsed = FTimepoint::ElapsedSince(startedAt);
+
+    PPE_LOG(Test_Containers, Emphasis, "sparse array: {0} with 1 item every {1} slots x {2} -> {3}",
+        name, keepOneIn, NumLoops, Fmt::DurationInMs(elapsed) );
+}
+//----------------------------------------------------------------------------
+NO_INLINE static void Benchmark_SparseArray_() {
+    STATIC_CONST_INTEGRAL(u32, N, 1000000);
+
+    for (const size_t keepOneIn : { 1_size_t, 2_size_t, 8_size_t, 64_size_t }) {
+        SPARSEARRAY(Benchmark, float) sparse;
+        DENSESPARSEARRAY(Benchmark, float) dense;
+        // emulates the previous iterator, which tested the id of every slot to skip the holes
+        VECTOR(Benchmark, TSparseArrayItem<float>) legacy;
+
+        VECTOR(Benchmark, FSparseDataId) ids;
+        ids.resize(N);
+        sparse.EmplaceN(ids.MakeView(), 1.0f);
+
+        VECTOR(Benchmark, FSparseDataId) removed;
+        legacy.reserve(N);
+        forrange(i, 0, N) {
+            if (i % keepOneIn) {
+                removed.push_back(ids[i]);
+                legacy.push_back(TSparseArrayItem<float>{ 1.0f, FSparseDataId::Unknown });
+            }
+            else {
+                legacy.push_back(TSparseArrayItem<float>{ 1.0f, ids[i] });
+                dense.Emplace(1.0f);
+            }
+        }
+        Verify(sparse.RemoveN(removed.MakeConstView()) == removed.size());
+
+        Benchmark_SparseArrayLoop_(MakeStringView("legacy scan"), keepOneIn, [&legacy]() {
+            for (TSparseArrayItem<float>& it : legacy) {
+                if (FSparseDataId::Unknown != it.Id)
+                    it.Data += 1.0f;
+            }
+        });
+        Benchmark_SparseArrayLoop_(MakeStringView("iterator"), keepOneIn, [&sparse]() {
+            for (float& value : sparse)
+                value += 1.0f;
+        });
+        Benchmark_SparseArrayLoop_(MakeStringView("Each()"), keepOneIn, [&sparse]() {
+            sparse.Each([](float& value) { value += 1.0f; });
+        });
+        Benchmark_SparseArrayLoop_(MakeStringView("ParallelForEach()"), keepOneIn, [&sparse]() {
+            ParallelForEach(sparse, [](float& value) { value += 1.0f; });
+        });
+        Benchmark_SparseArrayLoop_(MakeStringView("dense"), keepOneIn, [&dense]() {
+            for (float& value : dense)
+                value += 1.0f;
+        });
+    }
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
 void Test_Containers() {
     PPE_DEBUG_NAMEDSCOPE("Test_Containers");
 
@@ -1956,8 +2177,10 @@ void Test_Containers() {
     Test_Appendable();
     Test_BitSet();
     Test_TupleVector();
+    Test_SparseArray_();
 
 #if USE_PPE_BENCHMARK
+    Benchmark_SparseArray_();
     Test_PODSet_<u64>("u64", [](auto& rnd) { return u64(rnd()); });
 #   if PPE_RUN_EXHAUSTIVE_BENCHMARKS
     Test_PODSet_<u32>("u32", [](auto& rnd) { return u32(rnd()); });
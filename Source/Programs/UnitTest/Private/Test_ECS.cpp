@@ -0,0 +1,502 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "EntityCommandBuffer.h"
+#include "EntityQuery.h"
+#include "EntitySystem.h"
+#include "EntityWorld.h"
+
+#include "Container/HashMap.h"
+#include "Container/Vector.h"
+#include "Diagnostic/Logger.h"
+#include "IO/FormatHelpers.h"
+#include "IO/StringView.h"
+#include "Memory/UniquePtr.h"
+#include "Time/Timeline.h"
+#include "Time/Timepoint.h"
+
+#include <atomic>
+
+namespace PPE {
+namespace Test {
+LOG_CATEGORY(, Test_ECS)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+using namespace ECS;
+//----------------------------------------------------------------------------
+struct FPosition_ { float X{ 0 }, Y{ 0 }; };
+struct FVelocity_ { float X{ 0 }, Y{ 0 }; };
+struct FHealth_ { float Value{ 100.f }; };
+//----------------------------------------------------------------------------
+// not trivially copyable, counts live instances to check that relocations don't leak nor double destroy
+struct FTracked_ {
+    static std::atomic<int> NumAlive;
+
+    int Value{ 0 };
+
+    FTracked_() NOEXCEPT { ++NumAlive; }
+    explicit FTracked_(int value) NOEXCEPT : Value(value) { ++NumAlive; }
+    FTracked_(FTracked_&& rvalue) NOEXCEPT : Value(rvalue.Value) { ++NumAlive; }
+    FTracked_& operator =(FTracked_&& rvalue) NOEXCEPT { Value = rvalue.Value; return (*this); }
+    ~FTracked_() { --NumAlive; }
+};
+std::atomic<int> FTracked_::NumAlive{ 0 };
+//----------------------------------------------------------------------------
+static void Test_EntityWorld_() {
+    {
+        FEntityWorld world;
+
+        // entities with the same components share the same archetype, whatever the order
+        const FEntity a = world.Create(FPosition_{ 1, 1 }, FVelocity_{ 1, 0 });
+        const FEntity b = world.Create(FVelocity_{ 2, 0 }, FPosition_{ 2, 2 });
+        const FEntity c = world.Create(FPosition_{ 3, 3 }, FTracked_{ 3 });
+        VerifyRelease(world.NumEntities() == 3);
+        VerifyRelease(world.NumArchetypes() == 3); // empty + {position,velocity} + {position,tracked}
+        VerifyRelease(world.Get<FPosition_>(b)->X == 2);
+        VerifyRelease(not world.Has<FVelocity_>(c));
+
+        // adding/removing components moves the entity to another archetype and keeps its other components
+        world.Add(c, FVelocity_{ 3, 0 });
+        VerifyRelease(world.Get<FTracked_>(c)->Value == 3);
+        VerifyRelease(world.Get<FPosition_>(c)->Y == 3);
+        VerifyRelease(world.Get<FVelocity_>(c)->X == 3);
+
+        world.Remove<FPosition_>(a);
+        VerifyRelease(not world.Has<FPosition_>(a));
+        VerifyRelease(world.Get<FVelocity_>(a)->X == 1);
+        VerifyRelease(world.Components(a) == world.ComponentMask<FVelocity_>());
+        // b was moved in the hole left by a
+        VerifyRelease(world.Get<FPosition_>(b)->X == 2);
+        VerifyRelease(world.Get<FVelocity_>(b)->X == 2);
+
+        // destroyed handles are stale, even after their index was recycled
+        world.DestroyEntity(b);
+        VerifyRelease(not world.Alive(b));
+        VerifyRelease(nullptr == world.Get<FPosition_>(b));
+
+        const FEntity d = world.CreateEntity(world.ComponentMask<FHealth_>());
+        VerifyRelease(d.Index == b.Index);
+        VerifyRelease(d != b);
+        VerifyRelease(not world.Alive(b));
+        VerifyRelease(world.Get<FHealth_>(d)->Value == 100.f); // default constructed
+
+        // bulk creation fills whole chunks, destructions don't corrupt the other entities
+        VECTOR(Entity, FEntity) entities;
+        entities.resize(10000);
+        world.CreateEntities(entities.MakeView(), world.ComponentMask<FPosition_, FHealth_>());
+
+        forrange(i, 0, entities.size())
+            world.Get<FPosition_>(entities[i])->X = float(i);
+        for (size_t i = 0; i < entities.size(); i += 3)
+            world.DestroyEntity(entities[i]);
+
+        size_t numAlive = 0;
+        forrange(i, 0, entities.size()) {
+            const FPosition_* const position = world.Get<FPosition_>(entities[i]);
+            VerifyRelease((i % 3 == 0) == (nullptr == position));
+            VerifyRelease(nullptr == position || position->X == float(i));
+            numAlive += (position ? 1 : 0);
+        }
+
+        // queries visit only the matching archetypes, chunk by chunk
+        TEntityQuery<FPosition_, const FHealth_> query{ world };
+        VerifyRelease(query.Reads() == world.ComponentMask<FHealth_>());
+        VerifyRelease(query.Writes() == world.ComponentMask<FPosition_>());
+        VerifyRelease(query.NumArchetypes() == 1);
+        VerifyRelease(query.NumEntities() == numAlive);
+
+        size_t numVisited = 0;
+        query.EachWithEntity([&](FEntity entity, FPosition_& position, const FHealth_& health) {
+            VerifyRelease(world.Get<FPosition_>(entity) == &position);
+            VerifyRelease(health.Value == 100.f);
+            ++numVisited;
+        });
+        VerifyRelease(numVisited == numAlive);
+
+        // new archetypes are picked by existing queries
+        world.Add(c, FHealth_{ 50.f });
+        VerifyRelease(query.NumArchetypes() == 2);
+        VerifyRelease(query.NumEntities() == numAlive + 1);
+
+        TEntityQuery<FPosition_> withoutHealth{ world, world.ComponentMask<FHealth_>() };
+        VerifyRelease(withoutHealth.NumEntities() == 0);
+
+        world.Clear();
+        VerifyRelease(world.NumEntities() == 0);
+        VerifyRelease(not world.Alive(c));
+        VerifyRelease(query.NumEntities() == 0);
+
+        world.Create(FTracked_{ 4 }, FHealth_{});
+    }
+    VerifyRelease(0 == FTracked_::NumAlive);
+}
+//----------------------------------------------------------------------------
+static void Test_EntityCommandBuffer_() {
+    {
+        FEntityWorld world;
+        FEntityCommandBuffer commands{ world };
+
+        const FEntity a = world.Create(FPosition_{ 1, 1 });
+
+        const FEntity e = commands.CreateEntity();
+        commands.Add(e, FPosition_{ 4, 4 });
+        commands.Add(e, FTracked_{ 41 });
+        commands.Add(e, FTracked_{ 42 }); // last one wins
+        commands.Add(a, FVelocity_{ 1, 0 });
+        commands.Remove<FPosition_>(a);
+
+        // nothing is applied before playback
+        VerifyRelease(not commands.empty());
+        VerifyRelease(not world.Alive(e));
+        VerifyRelease(world.Has<FPosition_>(a));
+        VerifyRelease(not world.Has<FVelocity_>(a));
+
+        const size_t numArchetypes = world.NumArchetypes();
+        commands.Playback();
+        VerifyRelease(commands.empty());
+
+        // coalesced changes: no intermediate archetype was created
+        VerifyRelease(world.NumArchetypes() == numArchetypes + 2);
+        VerifyRelease(world.Alive(e));
+        VerifyRelease(world.Get<FPosition_>(e)->X == 4);
+        VerifyRelease(world.Get<FTracked_>(e)->Value == 42);
+        VerifyRelease(world.Components(a) == world.ComponentMask<FVelocity_>());
+        VerifyRelease(world.Get<FVelocity_>(a)->X == 1);
+
+        // commands recorded after a destruction are dropped
+        commands.DestroyEntity(e);
+        commands.Add(e, FTracked_{ 43 });
+        commands.Playback();
+        VerifyRelease(not world.Alive(e));
+        VerifyRelease(world.NumEntities() == 1);
+
+        // discarded buffers destroy their payloads and the entities they created
+        const FEntity f = commands.CreateEntity();
+        commands.Add(f, FTracked_{ 44 });
+        commands.Add(a, FTracked_{ 45 });
+        commands.Discard();
+        VerifyRelease(commands.empty());
+        VerifyRelease(not world.Alive(f));
+        VerifyRelease(not world.Has<FTracked_>(a));
+
+        // pending commands are discarded by the destructor
+        commands.Add(a, FTracked_{ 46 });
+    }
+    VerifyRelease(0 == FTracked_::NumAlive);
+}
+//----------------------------------------------------------------------------
+class FMoveSystem_ final : public IEntitySystem {
+public:
+    virtual FStringView Name() const override { return MakeStringView("Move"); }
+
+    virtual void Initialize(FEntityWorld& world, FSystemAccess* access) override {
+        _query = MakeUnique<TEntityQuery<FPosition_, const FVelocity_>>(world);
+        access->Add(*_query);
+    }
+
+    virtual void Update(const FSystemContext& ctx) override {
+        const float dt = static_cast<float>(FSeconds(ctx.Timeline.Elapsed()).Value());
+        ctx.ParallelEachChunk(*_query, [dt](const FSystemContext&, const TChunkView<FPosition_, const FVelocity_>& view) {
+            view.Each([dt](FPosition_& position, const FVelocity_& velocity) {
+                position.X += velocity.X * dt;
+                position.Y += velocity.Y * dt;
+            });
+        });
+    }
+
+private:
+    TUniquePtr<TEntityQuery<FPosition_, const FVelocity_>> _query;
+};
+//----------------------------------------------------------------------------
+class FDamageSystem_ final : public IEntitySystem {
+public:
+    virtual FStringView Name() const override { return MakeStringView("Damage"); }
+
+    virtual void Initialize(FEntityWorld& world, FSystemAccess* access) override {
+        _query = MakeUnique<TEntityQuery<FHealth_>>(world);
+        access->Add(*_query);
+    }
+
+    virtual void Update(const FSystemContext& ctx) override {
+        // each task records in its own command buffer
+        ctx.ParallelEach(*_query, [](const FSystemContext& task, FEntity entity, FHealth_& health) {
+            health.Value -= 25.f;
+            if (health.Value <= 0.f)
+                task.Commands.DestroyEntity(entity);
+        });
+    }
+
+private:
+    TUniquePtr<TEntityQuery<FHealth_>> _query;
+};
+//----------------------------------------------------------------------------
+// spawns a new entity in front of the others each frame
+class FSpawnSystem_ final : public IEntitySystem {
+public:
+    virtual FStringView Name() const override { return MakeStringView("Spawn"); }
+
+    virtual void Initialize(FEntityWorld& world, FSystemAccess* access) override {
+        _query = MakeUnique<TEntityQuery<const FPosition_, const FHealth_>>(world);
+        access->Add(*_query);
+    }
+
+    virtual void Update(const FSystemContext& ctx) override {
+        float front = 0;
+        _query->Each([&front](const FPosition_& position, const FHealth_&) {
+            front = Max(front, position.X);
+        });
+
+        const FEntity entity = ctx.Commands.CreateEntity();
+        ctx.Commands.Add(entity, FPosition_{ front, 0 });
+        ctx.Commands.Add(entity, FVelocity_{ 1, 0 });
+        ctx.Commands.Add(entity, FHealth_{});
+    }
+
+private:
+    TUniquePtr<TEntityQuery<const FPosition_, const FHealth_>> _query;
+};
+//----------------------------------------------------------------------------
+class FCountSystem_ final : public IEntitySystem {
+public:
+    size_t NumEntities{ 0 };
+
+    virtual FStringView Name() const override { return MakeStringView("Count"); }
+
+    virtual void Initialize(FEntityWorld& world, FSystemAccess* access) override {
+        _query = MakeUnique<TEntityQuery<const FHealth_>>(world);
+        access->Add(*_query);
+    }
+
+    virtual void Update(const FSystemContext&) override {
+        NumEntities = _query->NumEntities();
+    }
+
+private:
+    TUniquePtr<TEntityQuery<const FHealth_>> _query;
+};
+//----------------------------------------------------------------------------
+static void Test_SystemScheduler_() {
+    FEntityWorld world;
+
+    VECTOR(Entity, FEntity) entities;
+    entities.resize(100);
+    world.CreateEntities(entities.MakeView(), world.ComponentMask<FPosition_, FVelocity_, FHealth_>());
+    for (FEntity entity : entities)
+        world.Get<FVelocity_>(entity)->X = 1;
+
+    FSystemScheduler scheduler{ world };
+    scheduler.Add<FMoveSystem_>();
+    scheduler.Add<FDamageSystem_>();
+    scheduler.Add<FSpawnSystem_>();
+
+    // move and damage don't conflict, spawn reads what they both write
+    VerifyRelease(scheduler.NumSystems() == 3);
+    VerifyRelease(scheduler.Dependencies(0).empty());
+    VerifyRelease(scheduler.Dependencies(1).empty());
+    VerifyRelease(scheduler.Dependencies(2).size() == 2);
+
+    FTimeline timeline;
+    const FTimespan dt{ 1000.0 }; // 1 second per frame
+
+    timeline.Tick(dt);
+    scheduler.Update(timeline);
+
+    VerifyRelease(world.NumEntities() == entities.size() + 1);
+    for (FEntity entity : entities) {
+        VerifyRelease(world.Get<FPosition_>(entity)->X == 1);
+        VerifyRelease(world.Get<FHealth_>(entity)->Value == 75.f);
+    }
+
+    forrange(frame, 1, 4) {
+        timeline.Tick(dt);
+        scheduler.Update(timeline);
+    }
+
+    // initial entities died during the 4th frame, only the spawned ones remain
+    VerifyRelease(world.NumEntities() == 4);
+    for (FEntity entity : entities)
+        VerifyRelease(not world.Alive(entity));
+
+    VerifyRelease(scheduler.Timing(0).NumUpdates == 4);
+    VerifyRelease(scheduler.FrameTiming().NumUpdates == 4);
+}
+//----------------------------------------------------------------------------
+static void Test_SystemScheduler_SyncPoints_() {
+    FEntityWorld world;
+
+    // large enough to split the queries in ranges of chunks
+    VECTOR(Entity, FEntity) entities;
+    entities.resize(100000);
+    world.CreateEntities(entities.MakeView(), world.ComponentMask<FPosition_, FVelocity_, FHealth_>());
+    forrange(i, 0, entities.size())
+        world.Get<FHealth_>(entities[i])->Value = 25.f * (i % 4 + 1);
+
+    FSystemScheduler scheduler{ world };
+    scheduler.Add<FDamageSystem_>();
+    scheduler.AddSyncPoint();
+    const FCountSystem_& count = scheduler.Add<FCountSystem_>();
+
+    // count would conflict with damage, but the sync point already orders them
+    VerifyRelease(scheduler.NumSyncPoints() == 1);
+    VerifyRelease(scheduler.Dependencies(1).empty());
+
+    FTimeline timeline;
+    timeline.Tick(FTimespan{ 1000.0 });
+    scheduler.Update(timeline);
+
+    // destructions recorded by all the tasks were applied before count ran
+    VerifyRelease(count.NumEntities == entities.size() - entities.size() / 4);
+    VerifyRelease(world.NumEntities() == count.NumEntities);
+    forrange(i, 0, entities.size()) {
+        VerifyRelease((i % 4 == 0) != world.Alive(entities[i]));
+        VerifyRelease(i % 4 == 0 || world.Get<FHealth_>(entities[i])->Value == 25.f * (i % 4));
+    }
+
+    scheduler.LogTimings();
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+// emulates the legacy ECS layout: one virtual container per component type indexed by entity id,
+// systems iterate their entities and fetch each component separately
+template <typename T>
+class ILegacyComponent_ {
+public:
+    virtual ~ILegacyComponent_() = default;
+    virtual void AddComponent(u32 id, T&& data) = 0;
+    virtual T& GetComponent(u32 id) = 0;
+};
+template <typename T>
+class TLegacyComponentMap_ final : public ILegacyComponent_<T> {
+public:
+    virtual void AddComponent(u32 id, T&& data) override {
+        _instances.insert_AssertUnique({ id, std::move(data) });
+    }
+    virtual T& GetComponent(u32 id) override {
+        const auto it = _instances.find(id);
+        Assert(_instances.end() != it);
+        return it->second;
+    }
+private:
+    HASHMAP(Benchmark, u32, T) _instances;
+};
+//----------------------------------------------------------------------------
+static void Benchmark_ECS_() {
+    STATIC_CONST_INTEGRAL(u32, NumEntities, 1000000);
+    STATIC_CONST_INTEGRAL(u32, NumFrames, 10);
+    const float dt = 1.f / 60;
+
+    float checksumLegacy = 0;
+    {
+        TUniquePtr<ILegacyComponent_<FPosition_>> positions{ MakeUnique<TLegacyComponentMap_<FPosition_>>() };
+        TUniquePtr<ILegacyComponent_<FVelocity_>> velocities{ MakeUnique<TLegacyComponentMap_<FVelocity_>>() };
+
+        VECTOR(Benchmark, u32) entities;
+        entities.reserve(NumEntities);
+        forrange(id, 0, NumEntities) {
+            entities.push_back(id);
+            positions->AddComponent(id, FPosition_{ 0, 0 });
+            velocities->AddComponent(id, FVelocity_{ float(id % 7), 1 });
+        }
+
+        const FTimepoint startedAt = FTimepoint::Now();
+        forrange(frame, 0, NumFrames) {
+            for (u32 id : entities) {
+                FPosition_& position = positions->GetComponent(id);
+                const FVelocity_& velocity = velocities->GetComponent(id);
+                position.X += velocity.X * dt;
+                position.Y += velocity.Y * dt;
+            }
+        }
+        const FTimespan elapsed = FTimepoint::ElapsedSince(startedAt);
+
+        for (u32 id : entities)
+            checksumLegacy += positions->GetComponent(id).Y;
+
+        PPE_LOG(Test_ECS, Info, "legacy components: updated {0} entities {1} times in {2}",
+            NumEntities, NumFrames, Fmt::DurationInMs(elapsed) );
+    }
+
+    float checksumECS = 0;
+    {
+        FEntityWorld world;
+
+        VECTOR(Benchmark, FEntity) entities;
+        entities.resize(NumEntities);
+        world.CreateEntities(entities.MakeView(), world.ComponentMask<FPosition_, FVelocity_>());
+        forrange(id, 0, NumEntities)
+            *world.Get<FVelocity_>(entities[id]) = FVelocity_{ float(id % 7), 1 };
+
+        TEntityQuery<FPosition_, const FVelocity_> query{ world };
+
+        const FTimepoint startedAt = FTimepoint::Now();
+        forrange(frame, 0, NumFrames) {
+            query.Each([dt](FPosition_& position, const FVelocity_& velocity) {
+                position.X += velocity.X * dt;
+                position.Y += velocity.Y * dt;
+            });
+        }
+        const FTimespan elapsed = FTimepoint::ElapsedSince(startedAt);
+
+        TEntityQuery<const FPosition_>{ world }.Each([&checksumECS](const FPosition_& position) {
+            checksumECS += position.Y;
+        });
+
+        PPE_LOG(Test_ECS, Info, "archetype chunks: updated {0} entities {1} times in {2}",
+            NumEntities, NumFrames, Fmt::DurationInMs(elapsed) );
+    }
+
+    VerifyRelease(checksumLegacy == checksumECS);
+
+    {
+        FEntityWorld world;
+
+        VECTOR(Benchmark, FEntity) entities;
+        entities.resize(NumEntities);
+        world.CreateEntities(entities.MakeView(), world.ComponentMask<FPosition_, FVelocity_>());
+        forrange(id, 0, NumEntities)
+            *world.Get<FVelocity_>(entities[id]) = FVelocity_{ float(id % 7), 1 };
+
+        FSystemScheduler scheduler{ world };
+        scheduler.Add<FMoveSystem_>();
+
+        FTimeline timeline;
+        const FTimepoint startedAt = FTimepoint::Now();
+        forrange(frame, 0, NumFrames) {
+            timeline.Tick(FTimespan{ 1000.0 / 60 });
+            scheduler.Update(timeline);
+        }
+        const FTimespan elapsed = FTimepoint::ElapsedSince(startedAt);
+
+        PPE_LOG(Test_ECS, Info, "parallel archetype chunks: updated {0} entities {1} times in {2}",
+            NumEntities, NumFrames, Fmt::DurationInMs(elapsed) );
+
+        scheduler.LogTimings();
+    }
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void Test_ECS() {
+    PPE_DEBUG_NAMEDSCOPE("Test_ECS");
+
+    PPE_LOG(Test_ECS, Emphasis, "starting entity component system tests ...");
+
+    Test_EntityWorld_();
+    Test_EntityCommandBuffer_();
+    Test_SystemScheduler_();
+    Test_SystemScheduler_SyncPoints_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_ECS_();
+#endif
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace Test
+} //!namespace PPE
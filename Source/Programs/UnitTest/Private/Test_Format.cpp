@@ -3,6 +3,7 @@
 #include "VirtualFileSystem_fwd.h"
 
 #include "Container/Tuple.h"
+#include "Diagnostic/Benchmark.h"
 #include "Diagnostic/Logger.h"
 #include "IO/BufferedStream.h"
 #include "IO/ConstChar.h"
@@ -21,6 +22,8 @@
 
 #include "Memory/MemoryStream.h"
 
+#include <string_view>
+
 namespace PPE {
 namespace Test {
 LOG_CATEGORY(, Test_Format)
@@ -324,6 +327,285 @@ static void Test_Regexp_() {
         std::get<0>(parseArgs), std::get<1>(parseArgs), std::get<2>(parseArgs) );
 }
 //----------------------------------------------------------------------------
+template <typename _Char>
+static void Test_StringViewSearch_(FRandomGenerator& rnd, const TBasicStringView<_Char>& alphabet) {
+    using view_t = TBasicStringView<_Char>;
+    using std_view_t = std::basic_string_view<_Char>;
+
+    // offsets and lengths are randomized to exercise every alignment and
+    // every tail of the SIMD kernels, reference results come from the STL
+    _Char buffer[320];
+    _Char needle[5];
+    _Char separators[3];
+    _Char flipped[320];
+
+    const auto expectedIndex = [](size_t i, size_t n) NOEXCEPT {
+        return (std_view_t::npos == i ? n : i);
+    };
+
+    forrange(loop, 0, 3000) {
+        const size_t offset = rnd.Next(16);
+        const size_t len = rnd.Next(lengthof(buffer) - 16);
+        forrange(i, 0, len)
+            buffer[offset + i] = alphabet[rnd.Next(alphabet.size())];
+
+        const view_t str(buffer + offset, len);
+        const std_view_t ref(str.data(), str.size());
+
+        // StrChr / StrRChr
+
+        const _Char ch = alphabet[rnd.Next(alphabet.size())];
+        AssertRelease(expectedIndex(ref.find(ch), len) == checked_cast<size_t>(std::distance(str.begin(), StrChr(str, ch))));
+        AssertRelease(expectedIndex(ref.rfind(ch), INDEX_NONE) + 1 == checked_cast<size_t>(std::distance(StrRChr(str, ch), str.rend())));
+
+        // StrStr / StrStrI
+
+        const size_t needleLen = rnd.Next(1, lengthof(needle));
+        forrange(i, 0, needleLen)
+            needle[i] = alphabet[rnd.Next(alphabet.size())];
+        const view_t sub(needle, needleLen);
+
+        AssertRelease(expectedIndex(ref.find(std_view_t(sub.data(), sub.size())), len) == checked_cast<size_t>(std::distance(str.begin(), StrStr(str, sub))));
+
+        size_t subI = len;
+        for (size_t i = 0; i + needleLen <= len; ++i) {
+            if (EqualsI(str.SubRange(i, needleLen), sub)) {
+                subI = i;
+                break;
+            }
+        }
+        AssertRelease(subI == checked_cast<size_t>(std::distance(str.begin(), StrStrI(str, sub))));
+
+        // Split / SplitR
+
+        separators[0] = ch;
+        separators[1] = alphabet[rnd.Next(alphabet.size())];
+        separators[2] = alphabet[rnd.Next(alphabet.size())];
+        const view_t seps(separators, 1 + rnd.Next(lengthof(separators)));
+        const std_view_t refSeps(seps.data(), seps.size());
+
+        {
+            view_t it = str, slice;
+            std_view_t refIt = ref;
+            for (; Split(it, seps, slice); ) {
+                const size_t i = refIt.find_first_of(refSeps);
+                AssertRelease(std_view_t(slice.data(), slice.size()) == refIt.substr(0, i));
+                refIt = (std_view_t::npos == i ? std_view_t() : refIt.substr(i + 1));
+            }
+            AssertRelease(refIt.empty());
+        }
+        {
+            view_t it = str, slice;
+            std_view_t refIt = ref;
+            for (; SplitR(it, ch, slice); ) {
+                const size_t i = refIt.rfind(ch);
+                AssertRelease(std_view_t(slice.data(), slice.size()) == (std_view_t::npos == i ? refIt : refIt.substr(i + 1)));
+                refIt = (std_view_t::npos == i ? std_view_t() : refIt.substr(0, i));
+            }
+            AssertRelease(refIt.empty());
+        }
+
+        // Eat* / Trim*
+
+        {
+            view_t it = str;
+            AssertRelease(EatWhile(it, ch).size() == expectedIndex(ref.find_first_not_of(ch), len));
+            it = str;
+            AssertRelease(EatUntil(it, seps).size() == expectedIndex(ref.find_first_of(refSeps), len));
+            AssertRelease(TrimEnd(str, seps).size() == expectedIndex(ref.find_last_not_of(refSeps), INDEX_NONE) + 1);
+            AssertRelease(TrimStart(str, ch).size() == len - expectedIndex(ref.find_first_not_of(ch), len));
+        }
+        {
+            // empty sets never match any character
+            const view_t none;
+            view_t it = str;
+            AssertRelease(EatWhile(it, none).empty());
+            AssertRelease(it.size() == len);
+            AssertRelease(EatUntil(it, none).size() == len);
+            AssertRelease(it.empty());
+            AssertRelease(TrimStart(str, none).size() == len);
+            AssertRelease(TrimEnd(str, none).size() == len);
+        }
+
+        // EqualsI
+
+        forrange(i, 0, len)
+            flipped[i] = (ToLower(str[i]) == str[i] ? ToUpper(str[i]) : ToLower(str[i]));
+        AssertRelease(EqualsI(str, view_t(flipped, len)));
+        if (len) {
+            const size_t i = rnd.Next(len);
+            flipped[i] = STRING_LITERAL(_Char, '#');
+            AssertRelease(EqualsI(str, view_t(flipped, len)) == (str[i] == STRING_LITERAL(_Char, '#')));
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static void Test_StringView_() {
+    FRandomGenerator rnd;
+    Test_StringViewSearch_(rnd, "aAbBcC/._ \n#"_view);
+    Test_StringViewSearch_(rnd, L"aAbBcC/._ \n#"_view);
+
+    AssertRelease(WildMatch("*.cpp"_view, "Source/Runtime/Core/Private/IO/StringView.cpp"_view));
+    AssertRelease(WildMatch("*/IO/*View*"_view, "Source/Runtime/Core/Private/IO/StringView.cpp"_view));
+    AssertRelease(not WildMatch("*/IO/*.h"_view, "Source/Runtime/Core/Private/IO/StringView.cpp"_view));
+    AssertRelease(WildMatchI(L"*/io/*VIEW.CPP"_view, L"Source/Runtime/Core/Private/IO/StringView.cpp"_view));
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkStrings {
+// baseline relying on the STL string view, compared to PPE string helpers
+struct FStdStringOps {
+    static std::string_view Std(const FStringView& str) { return { str.data(), str.size() }; }
+    static size_t CountChar(FStringView str, char ch) {
+        size_t n = 0;
+        for (size_t i = Std(str).find(ch); std::string_view::npos != i; i = Std(str).find(ch, i + 1)) ++n;
+        return n;
+    }
+    static size_t CountTokens(FStringView str, const FStringView& separators) {
+        size_t n = 0;
+        for (size_t i = 0; i < str.size(); ++n) {
+            const size_t j = Std(str).find_first_of(Std(separators), i);
+            i = (std::string_view::npos == j ? str.size() : j + 1);
+        }
+        return n;
+    }
+    static size_t CountSubString(FStringView str, const FStringView& needle) {
+        size_t n = 0;
+        for (size_t i = Std(str).find(Std(needle)); std::string_view::npos != i; i = Std(str).find(Std(needle), i + 1)) ++n;
+        return n;
+    }
+    static size_t CountSubStringI(FStringView str, const FStringView& needle) {
+        size_t n = 0;
+        for (size_t i = 0; i + needle.size() <= str.size(); ++i)
+            n += (ToLower(str[i]) == ToLower(needle[0]) && EqualsI(str.SubRange(i, needle.size()), needle));
+        return n;
+    }
+    static size_t CountLines(FStringView str) {
+        size_t n = 0;
+        for (const char* it = str.data(), * end = str.data() + str.size(); it != end; ++n) {
+            it = std::find(it, end, '\n');
+            if (it != end) ++it;
+        }
+        return n;
+    }
+};
+struct FPPEStringOps {
+    static size_t CountChar(FStringView str, char ch) {
+        size_t n = 0;
+        for (auto it = StrChr(str, ch); str.end() != it; it = StrChr(str, ch)) {
+            str = str.CutStartingAt(it + 1);
+            ++n;
+        }
+        return n;
+    }
+    static size_t CountTokens(FStringView str, const FStringView& separators) {
+        size_t n = 0;
+        for (FStringView slice; Split(str, separators, slice); ) ++n;
+        return n;
+    }
+    static size_t CountSubString(FStringView str, const FStringView& needle) {
+        size_t n = 0;
+        for (auto it = StrStr(str, needle); str.end() != it; it = StrStr(str, needle)) {
+            str = str.CutStartingAt(it + 1);
+            ++n;
+        }
+        return n;
+    }
+    static size_t CountSubStringI(FStringView str, const FStringView& needle) {
+        size_t n = 0;
+        for (auto it = StrStrI(str, needle); str.end() != it; it = StrStrI(str, needle)) {
+            str = str.CutStartingAt(it + 1);
+            ++n;
+        }
+        return n;
+    }
+    static size_t CountLines(FStringView str) {
+        size_t n = 0;
+        for (; not str.empty(); ++n) {
+            EatUntil(str, '\n');
+            if (not str.empty())
+                str = str.CutStartingAt(1);
+        }
+        return n;
+    }
+};
+template <typename _Functor>
+class TStringOpBenchmark : public FBenchmark {
+public:
+    explicit TStringOpBenchmark(FStringView name) : FBenchmark{ name } {}
+    template <typename _Ops>
+    void operator ()(FBenchmark::FState& state, const _Ops& ops, const FStringView& corpus) const {
+        for (auto _ : state) {
+            const size_t n = _Functor{}(ops, corpus);
+            FBenchmark::DoNotOptimize(n);
+        }
+    }
+};
+struct strchr_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FStringView& corpus) const { return _Ops::CountChar(corpus, '/'); } };
+struct split_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FStringView& corpus) const { return _Ops::CountTokens(corpus, "/\\ \n"_view); } };
+struct strstr_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FStringView& corpus) const { return _Ops::CountSubString(corpus, "Private"_view); } };
+struct strstri_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FStringView& corpus) const { return _Ops::CountSubStringI(corpus, "private"_view); } };
+struct eatline_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FStringView& corpus) const { return _Ops::CountLines(corpus); } };
+} //!namespace BenchmarkStrings
+//----------------------------------------------------------------------------
+static void Benchmark_StringView_(const FStringView& name, const FStringView& corpus) {
+    using namespace BenchmarkStrings;
+
+    AssertRelease(FStdStringOps::CountChar(corpus, '/') == FPPEStringOps::CountChar(corpus, '/'));
+    AssertRelease(FStdStringOps::CountTokens(corpus, "/\\ \n"_view) == FPPEStringOps::CountTokens(corpus, "/\\ \n"_view));
+    AssertRelease(FStdStringOps::CountSubString(corpus, "Private"_view) == FPPEStringOps::CountSubString(corpus, "Private"_view));
+    AssertRelease(FStdStringOps::CountSubStringI(corpus, "private"_view) == FPPEStringOps::CountSubStringI(corpus, "private"_view));
+    AssertRelease(FStdStringOps::CountLines(corpus) == FPPEStringOps::CountLines(corpus));
+
+    auto bm = FBenchmark::MakeTable(name,
+        TStringOpBenchmark<strchr_op_t>{ "strchr"_view },
+        TStringOpBenchmark<split_op_t>{ "split"_view },
+        TStringOpBenchmark<strstr_op_t>{ "strstr"_view },
+        TStringOpBenchmark<strstri_op_t>{ "strstri"_view },
+        TStringOpBenchmark<eatline_op_t>{ "eatline"_view } );
+
+    bm.Run("std", FStdStringOps{}, corpus);
+    bm.Run("ppe", FPPEStringOps{}, corpus);
+
+    FBenchmark::FlushAndLog(bm);
+}
+//----------------------------------------------------------------------------
+static void Benchmark_StringView_() {
+    FRandomGenerator rnd;
+
+    static const FStringView GPathTokens[] = {
+        "Source"_view, "Runtime"_view, "Core"_view, "Private"_view, "Public"_view,
+        "Container"_view, "Memory"_view, "IO"_view, "Thread"_view, "Maths"_view,
+        "StringView"_view, "HashTable"_view, "VirtualFileSystem"_view, "Build"_view };
+    static const FStringView GTextTokens[] = {
+        "the"_view, "quick"_view, "brown"_view, "fox"_view, "jumps"_view, "over"_view,
+        "lazy"_view, "dog"_view, "PRIVATE"_view, "engine"_view, "a"_view, "rendering"_view,
+        "of"_view, "multithreaded"_view, "and"_view, "to"_view };
+
+    // path corpus : short tokens separated by '/', one path per line
+    FStringBuilder paths;
+    forrange(i, 0, 4000) {
+        forrange(j, 0, rnd.Next(2, 8))
+            paths << GPathTokens[rnd.Next(lengthof(GPathTokens))] << '/';
+        paths << GPathTokens[rnd.Next(lengthof(GPathTokens))] << ".cpp" << Eol;
+    }
+
+    // text corpus : long lines of words separated by spaces
+    FStringBuilder text;
+    forrange(i, 0, 1000) {
+        forrange(j, 0, rnd.Next(10, 40))
+            text << GTextTokens[rnd.Next(lengthof(GTextTokens))] << ' ';
+        text << '.' << Eol;
+    }
+
+    const FString pathCorpus = paths.ToString();
+    const FString textCorpus = text.ToString();
+
+    Benchmark_StringView_("StringView_paths"_view, pathCorpus.MakeView());
+    Benchmark_StringView_("StringView_text"_view, textCorpus.MakeView());
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
 } //!namespace
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -339,6 +621,11 @@ void Test_Format() {
     Test_Format_();
     Test_StringEscaping_();
     Test_LogPrintf_();
+    Test_StringView_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_StringView_();
+#endif
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
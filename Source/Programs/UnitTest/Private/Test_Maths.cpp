@@ -1,16 +1,30 @@
 ﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
 
 
+#include "Maths/Frustum.h"
+#include "Maths/FrustumCulling.h"
+#include "Maths/LinearOctree.h"
+#include "Maths/QuaternionHelpers.h"
+#include "Maths/RandomGenerator.h"
 #include "Maths/Range.h"
+#include "Maths/Ray.h"
 #include "Maths/ScalarVectorHelpers.h"
 #include "Maths/ScalarBoundingBoxHelpers.h"
 #include "Maths/ScalarMatrixHelpers.h"
+#include "Maths/Sphere.h"
+#include "Maths/TriangleBVH.h"
+#include "Maths/WideMathsHelpers.h"
 
+#include "Container/Vector.h"
+#include "Diagnostic/Benchmark.h"
 #include "Diagnostic/Logger.h"
 #include "Meta/Optional.h"
 #include "IO/FormatHelpers.h"
 #include "IO/TextWriter.h"
 
+#include <algorithm>
+#include <atomic>
+
 namespace PPE {
 namespace Test {
 LOG_CATEGORY(, Test_Maths)
@@ -359,6 +373,821 @@ static NO_INLINE void Test_Range_() {
     STATIC_ASSERT(c.Overlaps(unionAC));
 }
 //----------------------------------------------------------------------------
+static bool WideNearlyEquals_(float a, float b) {
+    return (Abs(a - b) <= 1e-4f * Max(1.f, Abs(a)));
+}
+static bool WideNearlyEquals_(const float3& a, const float3& b) {
+    return (WideNearlyEquals_(a.x, b.x) && WideNearlyEquals_(a.y, b.y) && WideNearlyEquals_(a.z, b.z));
+}
+static bool WideNearlyEquals_(const float4& a, const float4& b) {
+    return (WideNearlyEquals_(a.xyz, b.xyz) && WideNearlyEquals_(a.w, b.w));
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_WideMaths_() {
+    // not a multiple of FWideFloat::Lanes, to cover the padded tails
+    constexpr size_t N = 37;
+
+    FRandomGenerator rng;
+
+    float4x4 m;
+    forrange(c, 0, 4)
+        forrange(r, 0, 4)
+            m.at_(c, r) = rng.NextFloatM11();
+
+    const FQuaternion q = MakeAxisQuaternion(Normalize(float3(rng.NextFloatM11(), rng.NextFloatM11(), 1.f)), rng.NextFloat01() * 3.f);
+
+    float3 src[N], other[N];
+    FQuaternion qsrc[N];
+    forrange(i, 0, N) {
+        src[i] = float3(rng.NextFloatM11(), rng.NextFloatM11(), rng.NextFloatM11()) * 10.f;
+        other[i] = float3(rng.NextFloatM11(), rng.NextFloatM11(), rng.NextFloatM11());
+        qsrc[i] = MakeAxisQuaternion(Normalize(other[i] + float3(0, 0, 2)), rng.NextFloatM11());
+    }
+
+    {
+        const FWideFloat a = FWideFloat::Iota(1.f);
+        const FWideFloat b = FWideFloat::Broadcast(2.f);
+        AssertRelease((a < b).MoveMask() == 1u);
+        AssertRelease((a <= b).MoveMask() == 3u);
+        AssertRelease((a == a).MoveMask() == FWideFloat::AllLanesMask);
+        AssertRelease(Select(a < b, a, b).Lane(0) == 1.f);
+        AssertRelease(Select(a < b, a, b).Lane(2) == 2.f);
+        AssertRelease(Abs(-a).Lane(1) == 2.f);
+    }
+    {
+        float3 roundtrip[N];
+        float x[N], y[N], z[N];
+        AosToSoa(MakeView(x), MakeView(y), MakeView(z), MakeConstView(src));
+        SoaToAos(MakeView(roundtrip), MakeConstView(x), MakeConstView(y), MakeConstView(z));
+        forrange(i, 0, N) {
+            AssertRelease(x[i] == src[i].x && y[i] == src[i].y && z[i] == src[i].z);
+            AssertRelease(roundtrip[i] == src[i]);
+        }
+
+        TransformPointsSoA(MakeView(x), MakeView(y), MakeView(z), m);
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(float3(x[i], y[i], z[i]), Transform3_OneExtend(m, src[i]).xyz));
+    }
+    {
+        float3 dst[N];
+        TransformPoints(MakeView(dst), MakeConstView(src), m);
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], Transform3_OneExtend(m, src[i]).xyz));
+
+        TransformVectors(MakeView(dst), MakeConstView(src), m);
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], TransformVector3(m, src[i])));
+
+        RotateVectors(MakeView(dst), MakeConstView(src), q);
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], q.Transform(src[i])));
+
+        BatchCross(MakeView(dst), MakeConstView(src), MakeConstView(other));
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], Cross(src[i], other[i])));
+
+        BatchNormalize(MakeView(dst), MakeConstView(src));
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], Normalize(src[i])));
+
+        // in place
+        forrange(i, 0, N)
+            dst[i] = src[i];
+        TransformPoints(MakeView(dst), MakeConstView(dst), m);
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], Transform3_OneExtend(m, src[i]).xyz));
+    }
+    {
+        float4 dst[N];
+        TransformPoints4(MakeView(dst), MakeConstView(src), m);
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i], Transform3_OneExtend(m, src[i])));
+
+        float dots[N];
+        BatchDot(MakeView(dots), MakeConstView(src), MakeConstView(other));
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dots[i], Dot(src[i], other[i])));
+    }
+    {
+        FQuaternion qother[N], dst[N];
+        forrange(i, 0, N)
+            qother[i] = qsrc[N - 1 - i];
+        MultiplyQuaternions(MakeView(dst), MakeConstView(qsrc), MakeConstView(qother));
+        forrange(i, 0, N)
+            AssertRelease(WideNearlyEquals_(dst[i].data, (qsrc[i] * qother[i]).data));
+    }
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkWideMaths {
+struct FScalarOps {
+    static void TransformPoints(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const float4x4& m) {
+        forrange(i, 0, src.size())
+            dst[i] = Transform3_OneExtend(m, src[i]).xyz;
+    }
+    static void RotateVectors(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const FQuaternion& q) {
+        forrange(i, 0, src.size())
+            dst[i] = q.Transform(src[i]);
+    }
+    static void BatchNormalize(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) {
+        forrange(i, 0, src.size())
+            dst[i] = Normalize(src[i]);
+    }
+};
+struct FWideOps {
+    static void TransformPoints(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const float4x4& m) {
+        PPE::TransformPoints(dst, src, m);
+    }
+    static void RotateVectors(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const FQuaternion& q) {
+        PPE::RotateVectors(dst, src, q);
+    }
+    static void BatchNormalize(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) {
+        PPE::BatchNormalize(dst, src);
+    }
+};
+template <typename _Functor>
+class TWideMathsBenchmark : public FBenchmark {
+public:
+    explicit TWideMathsBenchmark(FStringView name) : FBenchmark{ name } {}
+    template <typename _Ops>
+    void operator ()(FBenchmark::FState& state, const _Ops& ops, const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) const {
+        for (auto _ : state) {
+            _Functor{}(ops, dst, src);
+            FBenchmark::DoNotOptimize(dst.data());
+        }
+    }
+};
+struct transform_op_t { template <typename _Ops> void operator ()(const _Ops&, const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) const { _Ops::TransformPoints(dst, src, MakeTranslationMatrix(float3(1, 2, 3))); } };
+struct rotate_op_t { template <typename _Ops> void operator ()(const _Ops&, const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) const { _Ops::RotateVectors(dst, src, MakeAxisQuaternion(float3::Z, 0.5f)); } };
+struct normalize_op_t { template <typename _Ops> void operator ()(const _Ops&, const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) const { _Ops::BatchNormalize(dst, src); } };
+} //!namespace BenchmarkWideMaths
+//----------------------------------------------------------------------------
+static void Benchmark_WideMaths_() {
+    using namespace BenchmarkWideMaths;
+
+    FRandomGenerator rng;
+
+    VECTOR(Benchmark, float3) src, dst;
+    src.resize_Uninitialized(64 * 1024);
+    dst.resize_Uninitialized(src.size());
+    for (float3& v : src)
+        v = float3(rng.NextFloatM11(), rng.NextFloatM11(), rng.NextFloatM11()) + float3(0, 0, 2);
+
+    auto bm = FBenchmark::MakeTable("WideMaths"_view,
+        TWideMathsBenchmark<transform_op_t>{ "transform"_view },
+        TWideMathsBenchmark<rotate_op_t>{ "rotate"_view },
+        TWideMathsBenchmark<normalize_op_t>{ "normalize"_view } );
+
+    bm.Run("scalar", FScalarOps{}, dst.MakeView(), src.MakeConstView());
+    bm.Run("wide", FWideOps{}, dst.MakeView(), src.MakeConstView());
+
+    FBenchmark::FlushAndLog(bm);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+static FFrustum MakeTestFrustum_() {
+    return FFrustum::FromCamera(float3(0, 0, -10), float3::Z, float3::Y, PIOver3_v<float>, 0.1f, 200.f, 16.f / 9.f);
+}
+//----------------------------------------------------------------------------
+struct FTestCullingBounds_ {
+    VECTOR(Maths, float) CenterX, CenterY, CenterZ, Radius;
+    VECTOR(Maths, float) MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+
+    explicit FTestCullingBounds_(size_t n) {
+        FRandomGenerator rng;
+        for (VECTOR(Maths, float)* stream : { &CenterX, &CenterY, &CenterZ, &Radius, &MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ })
+            stream->resize_Uninitialized(n);
+
+        forrange(i, 0, n) {
+            CenterX[i] = rng.NextFloatM11() * 250.f;
+            CenterY[i] = rng.NextFloatM11() * 250.f;
+            CenterZ[i] = rng.NextFloatM11() * 250.f;
+            Radius[i] = 0.1f + rng.NextFloat01() * 10.f;
+            MinX[i] = CenterX[i] - Radius[i] * rng.NextFloat01();
+            MinY[i] = CenterY[i] - Radius[i] * rng.NextFloat01();
+            MinZ[i] = CenterZ[i] - Radius[i] * rng.NextFloat01();
+            MaxX[i] = CenterX[i] + Radius[i] * rng.NextFloat01();
+            MaxY[i] = CenterY[i] + Radius[i] * rng.NextFloat01();
+            MaxZ[i] = CenterZ[i] + Radius[i] * rng.NextFloat01();
+        }
+    }
+
+    FSoaSpheres Spheres() const {
+        return { CenterX.MakeConstView(), CenterY.MakeConstView(), CenterZ.MakeConstView(), Radius.MakeConstView() };
+    }
+    FSoaBoundingBoxes Boxes() const {
+        return { MinX.MakeConstView(), MinY.MakeConstView(), MinZ.MakeConstView(),
+            MaxX.MakeConstView(), MaxY.MakeConstView(), MaxZ.MakeConstView() };
+    }
+    FSphere Sphere(size_t i) const { return FSphere(float3(CenterX[i], CenterY[i], CenterZ[i]), Radius[i]); }
+    FBoundingBox Box(size_t i) const { return FBoundingBox(float3(MinX[i], MinY[i], MinZ[i]), float3(MaxX[i], MaxY[i], MaxZ[i])); }
+};
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_FrustumCulling_() {
+    const FFrustum frustum = MakeTestFrustum_();
+    const FFrustumCuller culler{ frustum };
+
+    const FPlane planes[6] = { frustum.Near(), frustum.Far(), frustum.Left(), frustum.Right(), frustum.Top(), frustum.Bottom() };
+
+    // plane tests only, without the frustum corners rejection of FFrustum::Contains(FBoundingBox)
+    const auto isBoxVisible = [&planes](const FBoundingBox& box) -> bool {
+        for (const FPlane& plane : planes) {
+            const float3 furthest{
+                plane.Normal().x >= 0.f ? box.Max().x : box.Min().x,
+                plane.Normal().y >= 0.f ? box.Max().y : box.Min().y,
+                plane.Normal().z >= 0.f ? box.Max().z : box.Min().z };
+            if (Dot(plane.Normal(), furthest) + plane.D() < 0.f)
+                return false;
+        }
+        return true;
+    };
+
+    // not a multiple of FFrustumCuller::BitsPerWord, to cover partial words
+    const FTestCullingBounds_ bounds{ 4 * FFrustumCuller::ParallelThreshold + 37 };
+    const size_t n = bounds.Radius.size();
+
+    VECTOR(Maths, u64) visibles, parallelVisibles;
+    visibles.resize_Uninitialized(FFrustumCuller::VisibilityWords(n));
+    parallelVisibles.resize_Uninitialized(visibles.size());
+
+    {
+        const size_t numVisibles = culler.CullSpheres(visibles.MakeView(), bounds.Spheres());
+        size_t expected = 0;
+        forrange(i, 0, n) {
+            const bool visible = (frustum.Contains(bounds.Sphere(i)) != EContainmentType::Disjoint);
+            AssertRelease(FFrustumCuller::IsVisible(visibles.MakeConstView(), i) == visible);
+            expected += (visible ? 1 : 0);
+        }
+        AssertRelease(numVisibles == expected);
+        AssertRelease(0 < numVisibles && numVisibles < n);
+
+        const size_t numParallel = culler.ParallelCullSpheres(parallelVisibles.MakeView(), bounds.Spheres());
+        AssertRelease(numParallel == numVisibles);
+        AssertRelease(visibles.MakeConstView().RangeEqual(parallelVisibles.MakeConstView()));
+    }
+    {
+        const size_t numVisibles = culler.CullBoxes(visibles.MakeView(), bounds.Boxes());
+        size_t expected = 0;
+        forrange(i, 0, n) {
+            const FBoundingBox box = bounds.Box(i);
+            const bool visible = isBoxVisible(box);
+            AssertRelease(FFrustumCuller::IsVisible(visibles.MakeConstView(), i) == visible);
+            // conservative compared to the exact test
+            AssertRelease(visible || frustum.Contains(box) == EContainmentType::Disjoint);
+            expected += (visible ? 1 : 0);
+        }
+        AssertRelease(numVisibles == expected);
+
+        const size_t numParallel = culler.ParallelCullBoxes(parallelVisibles.MakeView(), bounds.Boxes());
+        AssertRelease(numParallel == numVisibles);
+        AssertRelease(visibles.MakeConstView().RangeEqual(parallelVisibles.MakeConstView()));
+    }
+    {
+        // hierarchical plane masking
+        u32 planeMask = FFrustumCuller::AllPlanes;
+        AssertRelease(culler.Contains(FBoundingBox(float3(-1000), float3(1000)), &planeMask) == EContainmentType::Intersects);
+        AssertRelease(planeMask == FFrustumCuller::AllPlanes);
+
+        planeMask = FFrustumCuller::AllPlanes;
+        AssertRelease(culler.Contains(FBoundingBox(float3(-1, -1, 10), float3(1, 1, 12)), &planeMask) == EContainmentType::Contains);
+        AssertRelease(0 == planeMask);
+
+        planeMask = FFrustumCuller::AllPlanes;
+        AssertRelease(culler.Contains(FBoundingBox(float3(-1, -1, -30), float3(1, 1, -20)), &planeMask) == EContainmentType::Disjoint);
+
+        // no plane left to test: everything is visible
+        AssertRelease(culler.CullSpheres(visibles.MakeView(), bounds.Spheres(), 0) == n);
+    }
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkFrustumCulling {
+struct FPerObjectOps {
+    size_t CullSpheres(const FFrustum& frustum, const FTestCullingBounds_& bounds, const TMemoryView<u64>& visibles) const {
+        size_t numVisibles = 0;
+        Broadcast(visibles, u64(0));
+        forrange(i, 0, bounds.Radius.size()) {
+            if (frustum.Contains(bounds.Sphere(i)) != EContainmentType::Disjoint) {
+                visibles[i / 64] |= u64(1) << (i % 64);
+                ++numVisibles;
+            }
+        }
+        return numVisibles;
+    }
+};
+struct FBatchOps {
+    size_t CullSpheres(const FFrustum& frustum, const FTestCullingBounds_& bounds, const TMemoryView<u64>& visibles) const {
+        return FFrustumCuller{ frustum }.CullSpheres(visibles, bounds.Spheres());
+    }
+};
+struct FParallelOps {
+    size_t CullSpheres(const FFrustum& frustum, const FTestCullingBounds_& bounds, const TMemoryView<u64>& visibles) const {
+        return FFrustumCuller{ frustum }.ParallelCullSpheres(visibles, bounds.Spheres());
+    }
+};
+class FCullSpheresBenchmark : public FBenchmark {
+public:
+    explicit FCullSpheresBenchmark(FStringView name) : FBenchmark{ name } {}
+    template <typename _Ops>
+    void operator ()(FBenchmark::FState& state, const _Ops& ops, const FFrustum& frustum, const FTestCullingBounds_& bounds, const TMemoryView<u64>& visibles) const {
+        for (auto _ : state) {
+            const size_t n = ops.CullSpheres(frustum, bounds, visibles);
+            FBenchmark::DoNotOptimize(n);
+        }
+    }
+};
+} //!namespace BenchmarkFrustumCulling
+//----------------------------------------------------------------------------
+static void Benchmark_FrustumCulling_() {
+    using namespace BenchmarkFrustumCulling;
+
+    const FFrustum frustum = MakeTestFrustum_();
+    const FTestCullingBounds_ bounds{ 256 * 1024 };
+
+    VECTOR(Benchmark, u64) visibles;
+    visibles.resize_Uninitialized(FFrustumCuller::VisibilityWords(bounds.Radius.size()));
+
+    auto bm = FBenchmark::MakeTable("FrustumCulling"_view,
+        FCullSpheresBenchmark{ "spheres"_view } );
+
+    bm.Run("per_object", FPerObjectOps{}, frustum, bounds, visibles.MakeView());
+    bm.Run("batch", FBatchOps{}, frustum, bounds, visibles.MakeView());
+    bm.Run("parallel", FParallelOps{}, frustum, bounds, visibles.MakeView());
+
+    FBenchmark::FlushAndLog(bm);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+struct FTestTriangleMesh_ {
+    VECTOR(Maths, float3) Positions;
+    VECTOR(Maths, u32) Indices;
+
+    // wavy heightfield, with shared edges and a lot of coherent triangles
+    explicit FTestTriangleMesh_(u32 gridSize) {
+        Positions.reserve(gridSize * gridSize);
+        forrange(z, 0, gridSize) {
+            forrange(x, 0, gridSize) {
+                const float fx = (x * 2.f) / (gridSize - 1) - 1.f;
+                const float fz = (z * 2.f) / (gridSize - 1) - 1.f;
+                Positions.push_back(float3(fx * 100.f, std::sin(fx * 7.f) * std::cos(fz * 5.f) * 10.f, fz * 100.f));
+            }
+        }
+
+        Indices.reserve((gridSize - 1) * (gridSize - 1) * 6);
+        forrange(z, 0, gridSize - 1) {
+            forrange(x, 0, gridSize - 1) {
+                const u32 i0 = z * gridSize + x;
+                const u32 i1 = i0 + 1;
+                const u32 i2 = i0 + gridSize;
+                const u32 i3 = i2 + 1;
+                Indices.push_back(i0); Indices.push_back(i2); Indices.push_back(i1);
+                Indices.push_back(i1); Indices.push_back(i2); Indices.push_back(i3);
+            }
+        }
+    }
+
+    // reference Möller-Trumbore over all the triangles
+    FTriangleBVH::FHit BruteForce(const FRay& ray) const {
+        FTriangleBVH::FHit hit{ FLT_MAX, FTriangleBVH::FHit::NoHit, 0.f, 0.f };
+        forrange(t, 0, checked_cast<u32>(Indices.size() / 3)) {
+            const float3& v0 = Positions[Indices[t * 3 + 0]];
+            const float3 e1 = Positions[Indices[t * 3 + 1]] - v0;
+            const float3 e2 = Positions[Indices[t * 3 + 2]] - v0;
+            const float3 pvec = Cross(ray.Direction(), e2);
+            const float det = Dot(e1, pvec);
+            if (Abs(det) < 1e-12f)
+                continue;
+            const float invDet = 1.f / det;
+            const float3 tvec = ray.Origin() - v0;
+            const float u = Dot(tvec, pvec) * invDet;
+            if (u < 0.f || u > 1.f)
+                continue;
+            const float3 qvec = Cross(tvec, e1);
+            const float v = Dot(ray.Direction(), qvec) * invDet;
+            if (v < 0.f || u + v > 1.f)
+                continue;
+            const float d = Dot(e2, qvec) * invDet;
+            if (d >= 0.f && d < hit.Distance)
+                hit = FTriangleBVH::FHit{ d, t, u, v };
+        }
+        return hit;
+    }
+};
+//----------------------------------------------------------------------------
+static void MakeTestRays_(VECTOR(Maths, FRay)* rays, size_t n, float scale, const float3& offset) {
+    FRandomGenerator rng;
+    rays->reserve(n);
+    forrange(i, 0, n) {
+        // from above the heightfield toward a random point on it, a few will miss
+        const float3 origin{ rng.NextFloatM11() * 150.f, 50.f + rng.NextFloat01() * 50.f, rng.NextFloatM11() * 150.f };
+        const float3 target{ rng.NextFloatM11() * 110.f, 0.f, rng.NextFloatM11() * 110.f };
+        rays->emplace_back(origin * scale + offset, Normalize(target - origin));
+    }
+}
+//----------------------------------------------------------------------------
+static bool SameHit_(const FTriangleBVH::FHit& a, const FTriangleBVH::FHit& b) {
+    if (a.Valid() != b.Valid())
+        return false;
+    // triangle ids can differ on shared edges
+    return (not a.Valid() || NearlyEquals(a.Distance, b.Distance, 1e-3f));
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_TriangleBVH_() {
+    FTestTriangleMesh_ mesh{ 97 };
+    const size_t numTriangles = (mesh.Indices.size() / 3);
+
+    FTriangleBVH bvh;
+    bvh.Build(mesh.Positions.MakeConstView(), mesh.Indices.MakeConstView());
+    AssertRelease(bvh.NumTriangles() == numTriangles);
+    AssertRelease(bvh.Bounds().Min().x == -100.f && bvh.Bounds().Max().x == 100.f);
+
+    // every triangle is referenced by exactly one leaf
+    {
+        VECTOR(Maths, u32) counts;
+        counts.resize_Uninitialized(numTriangles);
+        Broadcast(counts.MakeView(), u32(0));
+        for (const FTriangleBVH::FNode& node : bvh.Nodes()) {
+            forrange(c, 0, FTriangleBVH::Arity) {
+                if (node.IsEmpty(c) || not node.IsLeaf(c))
+                    continue;
+                AssertRelease(node.NumTriangles[c] <= FTriangleBVH::MaxTrianglesPerLeaf);
+                forrange(t, node.Child[c], node.Child[c] + node.NumTriangles[c])
+                    counts[t]++;
+            }
+        }
+        for (u32 count : counts)
+            AssertRelease(1 == count);
+    }
+
+    // not a multiple of FWideFloat::Lanes, to cover partial packets
+    const size_t numRays = 2048 + 3;
+
+    const auto checkHits = [&](const TMemoryView<const FRay>& rays) {
+        VECTOR(Maths, FTriangleBVH::FHit) packetHits, parallelHits;
+        packetHits.resize_Uninitialized(numRays);
+        parallelHits.resize_Uninitialized(numRays);
+
+        // a few rays may touch the boundary of a node with a floating point error
+        size_t numMismatches = 0, numHits = 0;
+        forrange(i, 0, numRays) {
+            const FTriangleBVH::FHit expected = mesh.BruteForce(rays[i]);
+
+            FTriangleBVH::FHit hit;
+            const bool intersects = bvh.Intersects(rays[i], &hit);
+            AssertRelease(intersects == hit.Valid());
+            AssertRelease(bvh.Occluded(rays[i]) == intersects);
+            if (intersects) {
+                AssertRelease(hit.Triangle < numTriangles);
+                AssertRelease(bvh.Occluded(rays[i], hit.Distance * 1.01f));
+                AssertRelease(not bvh.Occluded(rays[i], hit.Distance * 0.99f));
+                ++numHits;
+            }
+
+            numMismatches += (SameHit_(hit, expected) ? 0 : 1);
+        }
+        AssertRelease(numMismatches * 1000 <= numRays);
+        AssertRelease(numHits > numRays / 2 && numHits < numRays);
+
+        const size_t numPacketHits = bvh.IntersectsPacket(rays, packetHits.MakeView());
+        numMismatches = 0;
+        forrange(i, 0, numRays) {
+            FTriangleBVH::FHit hit;
+            bvh.Intersects(rays[i], &hit);
+            numMismatches += (SameHit_(hit, packetHits[i]) ? 0 : 1);
+            if (packetHits[i].Valid()) {
+                const float3 p = rays[i].At(packetHits[i].Distance);
+                AssertRelease(p.y >= bvh.Bounds().Min().y - 0.01f && p.y <= bvh.Bounds().Max().y + 0.01f);
+            }
+        }
+        AssertRelease(numMismatches * 1000 <= numRays);
+
+        // packets are split on the same boundaries
+        const size_t numParallelHits = bvh.BatchIntersects(rays, parallelHits.MakeView());
+        AssertRelease(numParallelHits == numPacketHits);
+        forrange(i, 0, numRays) {
+            AssertRelease(parallelHits[i].Triangle == packetHits[i].Triangle);
+            AssertRelease(parallelHits[i].Distance == packetHits[i].Distance);
+        }
+    };
+
+    VECTOR(Maths, FRay) rays;
+    MakeTestRays_(&rays, numRays, 1.f, float3(0.f));
+    checkHits(rays.MakeConstView());
+
+    // deform the mesh and refit: the topology is kept, only the bounds change
+    const float scale = 2.f;
+    const float3 offset{ 10.f, 20.f, 30.f };
+    for (float3& p : mesh.Positions)
+        p = p * scale + offset;
+    bvh.Refit(mesh.Positions.MakeConstView());
+    AssertRelease(NearlyEquals(bvh.Bounds().Max().x, 100.f * scale + offset.x));
+
+    rays.clear();
+    MakeTestRays_(&rays, numRays, scale, offset);
+    checkHits(rays.MakeConstView());
+
+    bvh.Clear();
+    AssertRelease(bvh.empty());
+    FTriangleBVH::FHit hit;
+    AssertRelease(not bvh.Intersects(rays[0], &hit));
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkTriangleBVH {
+struct FSingleRayOps {
+    size_t Trace(const FTriangleBVH& bvh, const TMemoryView<const FRay>& rays, const TMemoryView<FTriangleBVH::FHit>& hits) const {
+        size_t numHits = 0;
+        forrange(i, 0, rays.size())
+            numHits += (bvh.Intersects(rays[i], &hits[i]) ? 1 : 0);
+        return numHits;
+    }
+};
+struct FPacketOps {
+    size_t Trace(const FTriangleBVH& bvh, const TMemoryView<const FRay>& rays, const TMemoryView<FTriangleBVH::FHit>& hits) const {
+        return bvh.IntersectsPacket(rays, hits);
+    }
+};
+struct FParallelOps {
+    size_t Trace(const FTriangleBVH& bvh, const TMemoryView<const FRay>& rays, const TMemoryView<FTriangleBVH::FHit>& hits) const {
+        return bvh.BatchIntersects(rays, hits);
+    }
+};
+class FTraceBenchmark : public FBenchmark {
+public:
+    explicit FTraceBenchmark(FStringView name) : FBenchmark{ name } {}
+    template <typename _Ops>
+    void operator ()(FBenchmark::FState& state, const _Ops& ops, const FTriangleBVH& bvh, const TMemoryView<const FRay>& rays, const TMemoryView<FTriangleBVH::FHit>& hits) const {
+        for (auto _ : state) {
+            const size_t n = ops.Trace(bvh, rays, hits);
+            FBenchmark::DoNotOptimize(n);
+        }
+    }
+};
+} //!namespace BenchmarkTriangleBVH
+//----------------------------------------------------------------------------
+static void Benchmark_TriangleBVH_() {
+    using namespace BenchmarkTriangleBVH;
+
+    const FTestTriangleMesh_ mesh{ 513 }; // 512K triangles
+
+    FTriangleBVH bvh;
+    {
+        BENCHMARK_SCOPE(L"TriangleBVH", L"Build 512K triangles");
+        bvh.Build(mesh.Positions.MakeConstView(), mesh.Indices.MakeConstView());
+    }
+
+    const size_t numRays = 64 * 1024; // divide the timings by 65536 for Mrays/s
+    VECTOR(Maths, FRay) rays;
+    MakeTestRays_(&rays, numRays, 1.f, float3(0.f));
+
+    VECTOR(Benchmark, FTriangleBVH::FHit) hits;
+    hits.resize_Uninitialized(numRays);
+
+    auto bm = FBenchmark::MakeTable("TriangleBVH"_view,
+        FTraceBenchmark{ "64K_rays"_view } );
+
+    bm.Run("single", FSingleRayOps{}, bvh, rays.MakeConstView(), hits.MakeView());
+    bm.Run("packet", FPacketOps{}, bvh, rays.MakeConstView(), hits.MakeView());
+    bm.Run("parallel", FParallelOps{}, bvh, rays.MakeConstView(), hits.MakeView());
+
+    FBenchmark::FlushAndLog(bm);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+static FBoundingBox RandomObjectBounds_(FRandomGenerator& rng, float worldExtent) {
+    // mostly small objects, a few large ones and a few outside of the world
+    const float size = (rng.NextFloat01() < 0.05f ? 40.f : 2.f) * rng.NextFloat01();
+    const float range = (rng.NextFloat01() < 0.01f ? worldExtent * 1.5f : worldExtent);
+    const float3 center{ rng.NextFloatM11() * range, rng.NextFloatM11() * range, rng.NextFloatM11() * range };
+    const float3 halfExtents{ rng.NextFloat01() * size, rng.NextFloat01() * size, rng.NextFloat01() * size };
+    return FBoundingBox(center - halfExtents, center + halfExtents);
+}
+//----------------------------------------------------------------------------
+// same as Collision::BoxIntersectsBox(), touching boxes overlap
+static bool BoxesOverlap_(const FBoundingBox& a, const FBoundingBox& b) {
+    return (a.Min().x <= b.Max().x && b.Min().x <= a.Max().x &&
+            a.Min().y <= b.Max().y && b.Min().y <= a.Max().y &&
+            a.Min().z <= b.Max().z && b.Min().z <= a.Max().z );
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_LinearOctree_() {
+    const float worldExtent = 100.f;
+    FLinearOctree octree{ FBoundingBox(float3(-worldExtent), float3(worldExtent)) };
+
+    FRandomGenerator rng;
+
+    // large enough for the parallel radix sort
+    VECTOR(Maths, FBoundingBox) bounds;
+    bounds.resize_Uninitialized(150000);
+    for (FBoundingBox& b : bounds)
+        b = RandomObjectBounds_(rng, worldExtent);
+
+    octree.Build(bounds.MakeConstView());
+    AssertRelease(octree.NumObjects() == bounds.size());
+    AssertRelease(0 == octree.NumPendings());
+
+    const auto checkStructure = [&]() {
+        size_t numObjects = 0;
+        forrange(c, 0, octree.NumCells()) {
+            const FLinearOctree::FCell& cell = octree.Cells()[c];
+            AssertRelease(0 == c || octree.Cells()[c - 1].Key < cell.Key);
+            AssertRelease(cell.FirstObject == numObjects);
+            numObjects += cell.NumObjects;
+        }
+        AssertRelease(numObjects == octree.NumObjects());
+
+        forrange(id, 0, checked_cast<u32>(bounds.size())) {
+            const u64 key = octree.ObjectKey(id);
+            AssertRelease(FLinearOctree::KeyLevel(octree.MakeKey(bounds[id])) == FLinearOctree::KeyLevel(key));
+            AssertRelease(octree.LooseCellBounds(key).Contains(bounds[id]));
+        }
+    };
+
+    const auto checkQuery = [&](const auto& query, const auto& test) {
+        VECTOR(Maths, u32) hits;
+        const size_t numHits = octree.Intersects(query, [&hits](const TMemoryView<const u32>& objects) {
+            hits.insert(hits.end(), objects.begin(), objects.end());
+        });
+        AssertRelease(numHits == hits.size());
+        std::sort(hits.begin(), hits.end());
+
+        VECTOR(Maths, u32) expected;
+        forrange(id, 0, checked_cast<u32>(bounds.size()))
+            if (test(bounds[id]))
+                expected.push_back(id);
+
+        AssertRelease(hits.MakeConstView().RangeEqual(expected.MakeConstView()));
+        return numHits;
+    };
+
+    const auto checkRay = [&](const FRay& ray) {
+        FLinearOctree::FHitResult hit;
+        const bool intersects = octree.Intersects(ray, &hit);
+
+        float nearest = FLT_MAX;
+        forrange(id, 0, checked_cast<u32>(bounds.size())) {
+            // origin inside the box is a hit at distance 0
+            const float3 t0 = (bounds[id].Min() - ray.Origin()) / ray.Direction();
+            const float3 t1 = (bounds[id].Max() - ray.Origin()) / ray.Direction();
+            const float tmin = Max(Max(Min(t0.x, t1.x), Min(t0.y, t1.y)), Max(Min(t0.z, t1.z), 0.f));
+            const float tmax = Min(Min(Max(t0.x, t1.x), Max(t0.y, t1.y)), Max(t0.z, t1.z));
+            if (tmin <= tmax)
+                nearest = Min(nearest, tmin);
+        }
+
+        AssertRelease(intersects == (nearest < FLT_MAX));
+        if (intersects)
+            AssertRelease(NearlyEquals(hit.Distance, nearest, 1e-3f));
+    };
+
+    const auto checkQueries = [&]() {
+        const FFrustum frustum = MakeTestFrustum_();
+        const FFrustumCuller culler{ frustum };
+        const size_t numVisibles = checkQuery(frustum, [&culler](const FBoundingBox& b) {
+            u32 planeMask = FFrustumCuller::AllPlanes;
+            return (culler.Contains(b, &planeMask) != EContainmentType::Disjoint);
+        });
+        AssertRelease(0 < numVisibles && numVisibles < bounds.size());
+
+        forrange(q, 0, 8) {
+            const FBoundingBox box = RandomObjectBounds_(rng, worldExtent * 1.1f);
+            checkQuery(box, [&box](const FBoundingBox& b) { return BoxesOverlap_(box, b); });
+
+            const FSphere sphere{ float3(rng.NextFloatM11(), rng.NextFloatM11(), rng.NextFloatM11()) * worldExtent, rng.NextFloat01() * 30.f };
+            checkQuery(sphere, [&sphere](const FBoundingBox& b) {
+                return (DistanceSq(sphere.Center(), Clamp(sphere.Center(), b.Min(), b.Max())) <= sphere.Radius() * sphere.Radius());
+            });
+
+            // a box containing the whole world is reported in a single batch
+            if (0 == q)
+                AssertRelease(checkQuery(FBoundingBox(float3(-worldExtent * 2), float3(worldExtent * 2)), [](const FBoundingBox&) { return true; }) == bounds.size());
+
+            const float3 origin{ rng.NextFloatM11() * 150.f, rng.NextFloatM11() * 150.f, rng.NextFloatM11() * 150.f };
+            const float3 target{ rng.NextFloatM11() * 50.f, rng.NextFloatM11() * 50.f, rng.NextFloatM11() * 50.f };
+            checkRay(FRay(origin, Normalize(target - origin)));
+        }
+    };
+
+    checkStructure();
+    checkQueries();
+
+    // small moves stay in their loose cell, big moves and new objects are pending until Commit()
+    size_t numInPlace = 0;
+    forrange(id, 0, checked_cast<u32>(bounds.size())) {
+        const float3 offset = (id % 16 ? 0.1f : 50.f) * float3(rng.NextFloatM11(), rng.NextFloatM11(), rng.NextFloatM11());
+        bounds[id] = FBoundingBox(bounds[id].Min() + offset, bounds[id].Max() + offset);
+        numInPlace += (octree.Move(id, bounds[id]) ? 1 : 0);
+    }
+    forrange(i, 0, 100) {
+        bounds.push_back(RandomObjectBounds_(rng, worldExtent));
+        AssertRelease(octree.Add(bounds.back()) == bounds.size() - 1);
+    }
+    AssertRelease(numInPlace > bounds.size() / 2);
+    AssertRelease(octree.NumPendings() == bounds.size() - numInPlace);
+    checkQueries();
+
+    // merged without sorting everything
+    octree.Commit();
+    AssertRelease(0 == octree.NumPendings());
+    checkStructure();
+    checkQueries();
+
+    // batched queries
+    {
+        VECTOR(Maths, FBoundingBox) boxes;
+        forrange(q, 0, 64)
+            boxes.push_back(RandomObjectBounds_(rng, worldExtent));
+
+        size_t expected = 0;
+        for (const FBoundingBox& box : boxes)
+            expected += octree.Intersects(box, [](const TMemoryView<const u32>&) {});
+
+        std::atomic<size_t> numReported{ 0 };
+        const size_t numHits = octree.BatchIntersects(boxes.MakeConstView(), [&numReported](size_t, const TMemoryView<const u32>& objects) {
+            numReported += objects.size();
+        });
+        AssertRelease(numHits == expected);
+        AssertRelease(numReported == expected);
+
+        VECTOR(Maths, FRay) rays;
+        forrange(q, 0, 64)
+            rays.emplace_back(float3(0.f, 0.f, -150.f), Normalize(float3(rng.NextFloatM11(), rng.NextFloatM11(), 1.f)));
+
+        VECTOR(Maths, FLinearOctree::FHitResult) hits;
+        hits.resize_Uninitialized(rays.size());
+        size_t numRayHits = 0;
+        forrange(r, 0, rays.size()) {
+            FLinearOctree::FHitResult hit;
+            numRayHits += (octree.Intersects(rays[r], &hit) ? 1 : 0);
+        }
+        AssertRelease(octree.BatchIntersects(rays.MakeConstView(), hits.MakeView()) == numRayHits);
+    }
+
+    octree.Clear();
+    AssertRelease(0 == octree.NumObjects());
+    AssertRelease(0 == octree.Intersects(FBoundingBox(float3(-1.f), float3(1.f)), [](const TMemoryView<const u32>&) {}));
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkLinearOctree {
+struct FRebuildOps {
+    void Update(FLinearOctree& octree, const TMemoryView<const FBoundingBox>& bounds) const {
+        octree.Build(bounds);
+    }
+};
+struct FIncrementalOps {
+    void Update(FLinearOctree& octree, const TMemoryView<const FBoundingBox>& bounds) const {
+        forrange(id, 0, checked_cast<u32>(bounds.size()))
+            octree.Move(id, bounds[id]);
+        octree.Commit();
+    }
+};
+class FMoveAndCullBenchmark : public FBenchmark {
+public:
+    explicit FMoveAndCullBenchmark(FStringView name) : FBenchmark{ name } {}
+    template <typename _Ops>
+    void operator ()(FBenchmark::FState& state, const _Ops& ops, FLinearOctree& octree, const FFrustum& frustum, const TMemoryView<FBoundingBox>& bounds, const TMemoryView<const float3>& velocities) const {
+        for (auto _ : state) {
+            forrange(id, 0, bounds.size())
+                bounds[id] = FBoundingBox(bounds[id].Min() + velocities[id], bounds[id].Max() + velocities[id]);
+            ops.Update(octree, bounds);
+
+            const size_t n = octree.Intersects(frustum, [](const TMemoryView<const u32>&) {});
+            FBenchmark::DoNotOptimize(n);
+        }
+    }
+};
+} //!namespace BenchmarkLinearOctree
+//----------------------------------------------------------------------------
+static void Benchmark_LinearOctree_() {
+    using namespace BenchmarkLinearOctree;
+
+    const float worldExtent = 1000.f;
+    const FFrustum frustum = MakeTestFrustum_();
+
+    FRandomGenerator rng;
+    VECTOR(Benchmark, FBoundingBox) bounds;
+    VECTOR(Benchmark, float3) velocities;
+    bounds.resize_Uninitialized(1024 * 1024);
+    velocities.resize_Uninitialized(bounds.size());
+    forrange(i, 0, bounds.size()) {
+        bounds[i] = RandomObjectBounds_(rng, worldExtent);
+        velocities[i] = float3(rng.NextFloatM11(), rng.NextFloatM11(), rng.NextFloatM11()) * 0.05f;
+    }
+
+    FLinearOctree octree{ FBoundingBox(float3(-worldExtent), float3(worldExtent)) };
+    octree.Build(bounds.MakeConstView());
+
+    auto bm = FBenchmark::MakeTable("LinearOctree"_view,
+        FMoveAndCullBenchmark{ "1M_moving"_view } );
+
+    bm.Run("rebuild", FRebuildOps{}, octree, frustum, bounds.MakeView(), velocities.MakeConstView());
+    bm.Run("incremental", FIncrementalOps{}, octree, frustum, bounds.MakeView(), velocities.MakeConstView());
+
+    FBenchmark::FlushAndLog(bm);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
 } //!namedspace
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -373,6 +1202,17 @@ void Test_Maths() {
     Test_BoundingBox_();
     Test_Matrix_();
     Test_Range_();
+    Test_WideMaths_();
+    Test_FrustumCulling_();
+    Test_TriangleBVH_();
+    Test_LinearOctree_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_WideMaths_();
+    Benchmark_FrustumCulling_();
+    Benchmark_TriangleBVH_();
+    Benchmark_LinearOctree_();
+#endif
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
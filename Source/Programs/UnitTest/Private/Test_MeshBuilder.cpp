@@ -0,0 +1,918 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Mesh/Format/PolygonFileFormat.h"
+#include "Mesh/Format/WaveFrontObj.h"
+#include "Mesh/GenericMesh.h"
+#include "Mesh/GenericMeshHelpers.h"
+#include "Mesh/MeshClusters.h"
+#include "Mesh/MeshSimplifier.h"
+
+#include "Container/Vector.h"
+#include "Diagnostic/Benchmark.h"
+#include "Diagnostic/Logger.h"
+#include "HAL/PlatformMemory.h"
+#include "IO/FormatHelpers.h"
+#include "IO/StringBuilder.h"
+#include "IO/StringView.h"
+#include "Maths/ScalarVector.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Memory/MemoryProvider.h"
+#include "Memory/MemoryStream.h"
+
+#include <algorithm>
+
+namespace PPE {
+namespace Test {
+LOG_CATEGORY(, Test_MeshBuilder)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+using namespace ContentPipeline;
+//----------------------------------------------------------------------------
+// n*n vertices with integer coordinates, texcoords are equal to positions and all the normals are shared
+static void GridObj_(FStringBuilder& oss, u32 n, bool relativeIndices) {
+    oss << "# grid " << n << 'x' << n << Eol;
+
+    forrange(y, 0, n) {
+        forrange(x, 0, n)
+            oss << "v " << x << ' ' << y << " 0" << Eol;
+    }
+    forrange(y, 0, n) {
+        forrange(x, 0, n)
+            oss << "vt " << x << ' ' << y << Eol;
+    }
+    oss << "vn 0 0 1" << Eol;
+
+    const i64 numVertices = (i64(n) * n);
+    const auto corner = [&](u32 x, u32 y) {
+        const i64 index = (i64(y) * n + x + 1);
+        if (relativeIndices)
+            oss << ' ' << (index - numVertices - 1) << '/' << (index - numVertices - 1) << "/-1";
+        else
+            oss << ' ' << index << '/' << index << "/1";
+    };
+
+    forrange(y, 0, n - 1) {
+        forrange(x, 0, n - 1) {
+            oss << 'f';
+            corner(x, y);
+            corner(x + 1, y);
+            corner(x + 1, y + 1);
+            corner(x, y + 1);
+            oss << Eol;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static void CheckGrid_(const FGenericMesh& mesh, u32 n) {
+    AssertRelease(mesh.VertexCount() == n * n); // welded
+    AssertRelease(mesh.IndexCount() == (n - 1) * (n - 1) * 6);
+
+    const TMemoryView<const float3> positions = mesh.Position3f_IFP(0).MakeView();
+    const TMemoryView<const float2> texcoords = mesh.Texcoord2f_IFP(0).MakeView();
+    const TMemoryView<const float3> normals = mesh.Normal3f_IFP(0).MakeView();
+    AssertRelease(positions.size() == n * n);
+    AssertRelease(texcoords.size() == n * n);
+    AssertRelease(normals.size() == n * n);
+
+    const TMemoryView<const u32> indices = mesh.Indices();
+    forrange(y, 0, n - 1) {
+        forrange(x, 0, n - 1) {
+            // quads are triangulated as fans: (a, b, c) (a, c, d)
+            const float3 a{ float(x), float(y), 0.f };
+            const float3 b{ float(x + 1), float(y), 0.f };
+            const float3 c{ float(x + 1), float(y + 1), 0.f };
+            const float3 d{ float(x), float(y + 1), 0.f };
+
+            const u32* quad = (indices.data() + (size_t(y) * (n - 1) + x) * 6);
+            AssertRelease(positions[quad[0]] == a);
+            AssertRelease(positions[quad[1]] == b);
+            AssertRelease(positions[quad[2]] == c);
+            AssertRelease(positions[quad[3]] == a);
+            AssertRelease(positions[quad[4]] == c);
+            AssertRelease(positions[quad[5]] == d);
+
+            forrange(i, 0, 6) {
+                AssertRelease(texcoords[quad[i]] == float2(positions[quad[i]].xy));
+                AssertRelease(normals[quad[i]] == float3(0.f, 0.f, 1.f));
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_ObjFaces_() {
+    // v/vt/vn with a quad, then negative indices referring to the same corners
+    {
+        const FStringView obj =
+            "# comment\n"
+            "o quad\n"
+            "v 0 0 0\n"
+            "v 1.0 0 0\n"
+            "v 1 1e0 0\n"
+            "v 0 0.1e1 0\r\n"
+            "vt 0 0\n"
+            "vt 1 0\n"
+            "vt 1 1\n"
+            "vt 0 1\n"
+            "vn 0 0 1\n"
+            "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+            "f -4/-4/-1 -2/-2/-1 -1/-1/-1\n"_view;
+
+        FGenericMesh mesh;
+        AssertRelease(FWaveFrontObj::Load(&mesh, Default, obj));
+        AssertRelease(mesh.VertexCount() == 4); // welded
+        AssertRelease(mesh.IndexCount() == 9);
+
+        const u32 expected[9] = { 0, 1, 2, 0, 2, 3, 0, 2, 3 };
+        AssertRelease(MakeConstView(expected).RangeEqual(mesh.Indices()));
+
+        const TMemoryView<const float3> positions = mesh.Position3f_IFP(0).MakeView();
+        AssertRelease(positions[1] == float3(1.f, 0.f, 0.f));
+        AssertRelease(positions[2] == float3(1.f, 1.f, 0.f));
+        AssertRelease(positions[3] == float3(0.f, 1.f, 0.f));
+        AssertRelease(mesh.Texcoord2f_IFP(0).MakeView()[2] == float2(1.f, 1.f));
+        AssertRelease(mesh.Normal3f_IFP(0).MakeView()[3] == float3(0.f, 0.f, 1.f));
+    }
+    // v//vn with vertex colors, normals are normalized
+    {
+        const FStringView obj =
+            "v 0.5 -1.25e1 3 1 0 0\n"
+            "v 1 0 0 0 1 0\n"
+            "v 0 1 0 0 0 1\n"
+            "vn 0 0 2\n"
+            "f 1//1 2//1 3//1\n"_view;
+
+        FGenericMesh mesh;
+        AssertRelease(FWaveFrontObj::Load(&mesh, Default, obj));
+        AssertRelease(mesh.VertexCount() == 3);
+        AssertRelease(not mesh.Texcoord2f_IFP(0));
+        AssertRelease(mesh.Position3f_IFP(0).MakeView()[0] == float3(0.5f, -12.5f, 3.f));
+        AssertRelease(mesh.Normal3f_IFP(0).MakeView()[1] == float3(0.f, 0.f, 1.f));
+        AssertRelease(mesh.Color4f_IFP(0).MakeView()[0] == float4(1.f, 0.f, 0.f, 1.f));
+        AssertRelease(mesh.Color4f_IFP(0).MakeView()[2] == float4(0.f, 0.f, 1.f, 1.f));
+    }
+    // invalid files
+    {
+        FGenericMesh mesh;
+        AssertRelease(not FWaveFrontObj::Load(&mesh, Default, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n"_view));
+    }
+    {
+        FGenericMesh mesh;
+        AssertRelease(not FWaveFrontObj::Load(&mesh, Default, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2\n"_view));
+    }
+    {
+        FGenericMesh mesh;
+        AssertRelease(not FWaveFrontObj::Load(&mesh, Default, "v 0 0 zero\n"_view));
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_ObjChunks_() {
+    // several MiB of text: parsed by several workers, relative indices refer to other chunks
+    const u32 n = 384;
+    forrange(relative, 0, 2) {
+        FStringBuilder oss;
+        GridObj_(oss, n, !!relative);
+
+        FGenericMesh mesh;
+        AssertRelease(FWaveFrontObj::Load(&mesh, Default, oss.Written()));
+        CheckGrid_(mesh, n);
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_PlyAscii_() {
+    const FStringView ply =
+        "ply\n"
+        "format ascii 1.0\n"
+        "comment colors are normalized and alpha is missing\n"
+        "element vertex 4\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property uchar red\n"
+        "property uchar green\n"
+        "property uchar blue\n"
+        "element face 2\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n"
+        "0 0 0 255 0 0\n"
+        "1 0 0 0 255 0\n"
+        "1 1 0 0 0 255\n"
+        "0 1 0 255 255 255\n"
+        "4 0 1 2 3\n"
+        "3 3 2 1\n"_view;
+
+    FGenericMesh mesh;
+    AssertRelease(FPolygonFileFormat::Load(&mesh, Default, ply));
+    AssertRelease(mesh.VertexCount() == 4);
+    AssertRelease(mesh.IndexCount() == 9);
+
+    const u32 expected[9] = { 0, 1, 2, 0, 2, 3, 3, 2, 1 };
+    AssertRelease(MakeConstView(expected).RangeEqual(mesh.Indices()));
+
+    const TMemoryView<const float4> colors = mesh.Color4f_IFP(0).MakeView();
+    AssertRelease(colors[0] == float4(1.f, 0.f, 0.f, 1.f));
+    AssertRelease(colors[2] == float4(0.f, 0.f, 1.f, 1.f));
+    AssertRelease(mesh.Position3f_IFP(0).MakeView()[2] == float3(1.f, 1.f, 0.f));
+
+    FGenericMesh invalid;
+    AssertRelease(not FPolygonFileFormat::Load(&invalid, Default, ply.CutBefore(ply.size() - 4)));
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_PlyBinary_() {
+    const u32 n = 257;
+
+    FStringBuilder oss;
+    GridObj_(oss, n, false);
+
+    FGenericMesh grid;
+    AssertRelease(FWaveFrontObj::Load(&grid, Default, oss.Written()));
+
+    MEMORYSTREAM(MeshBuilder) ply;
+    AssertRelease(FPolygonFileFormat::Save(grid, Default, ply));
+
+    // fast path from memory
+    FGenericMesh mesh;
+    AssertRelease(FPolygonFileFormat::Load(&mesh, Default, ply.MakeView().Cast<const char>()));
+    CheckGrid_(mesh, n);
+    AssertRelease(mesh.Indices().RangeEqual(grid.Indices()));
+
+    // generic path from a stream must give the same mesh
+    FMemoryViewReader reader{ ply.MakeView() };
+    FGenericMesh generic;
+    AssertRelease(FPolygonFileFormat::Load(&generic, Default, reader));
+    AssertRelease(generic.Indices().RangeEqual(mesh.Indices()));
+    AssertRelease(generic.Position3f_IFP(0).MakeView().RangeEqual(mesh.Position3f_IFP(0).MakeView()));
+    AssertRelease(generic.Texcoord2f_IFP(0).MakeView().RangeEqual(mesh.Texcoord2f_IFP(0).MakeView()));
+}
+//----------------------------------------------------------------------------
+// n*n vertices on a bumpy height field, so every simplification introduces some error
+static void HeightGrid_(FGenericMesh* pMesh, u32 n) {
+    const FPositions3f positions = pMesh->Position3f(0);
+    pMesh->Resize((n - 1) * (n - 1) * 6, n * n, false);
+
+    forrange(y, 0, n) {
+        forrange(x, 0, n)
+            positions[y * n + x] = float3(float(x), float(y), 2.f * Sin(x * 0.3f) * Cos(y * 0.2f));
+    }
+
+    const TMemoryView<u32> indices = pMesh->Indices();
+    forrange(y, 0, n - 1) {
+        forrange(x, 0, n - 1) {
+            u32* const quad = (indices.data() + (size_t(y) * (n - 1) + x) * 6);
+            quad[0] = y * n + x;
+            quad[1] = y * n + x + 1;
+            quad[2] = (y + 1) * n + x + 1;
+            quad[3] = y * n + x;
+            quad[4] = (y + 1) * n + x + 1;
+            quad[5] = (y + 1) * n + x;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+// texcoords follow the positions of HeightGrid_(), u goes backward when mirrored
+static void GridTexcoords_(FGenericMesh* pMesh, u32 n, bool mirrored) {
+    const FPositions3f positions = pMesh->Position3f(0);
+    const FTexcoords2f texcoords = pMesh->Texcoord2f(0);
+    texcoords.Resize(pMesh->VertexCount(), false);
+
+    forrange(v, 0, pMesh->VertexCount()) {
+        const float u = (positions[v].x / (n - 1));
+        texcoords[v] = float2(mirrored ? 1.f - u : u, positions[v].y / (n - 1));
+    }
+}
+//----------------------------------------------------------------------------
+// rotates the smallest index first to compare triangles while keeping their winding
+static u64 TriangleKey_(u32 a, u32 b, u32 c) {
+    if (b < a && b < c)
+        return TriangleKey_(b, c, a);
+    if (c < a && c < b)
+        return TriangleKey_(c, a, b);
+    return ((u64(a) << 42) | (u64(b) << 21) | u64(c));
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_MeshClusters_() {
+    const u32 n = 65;
+
+    FGenericMesh mesh;
+    HeightGrid_(&mesh, n);
+
+    FMeshClusterDAG dag;
+    AssertRelease(dag.Build(mesh));
+    AssertRelease(dag.NumLevels() > 1);
+    AssertRelease(dag.NumGroups() > 0);
+
+    const TMemoryView<const float3> positions = mesh.Position3f_IFP(0).MakeView();
+
+    // level 0 holds every triangle exactly once
+    VECTOR(MeshBuilder, u64) expected;
+    forrange(t, 0, mesh.TriangleCount()) {
+        const uint3 triangle = mesh.Triangle(t);
+        expected.push_back(TriangleKey_(triangle.x, triangle.y, triangle.z));
+    }
+
+    VECTOR(MeshBuilder, u64) level0;
+    for (const FMeshCluster& cluster : dag.Level(0)) {
+        const TMemoryView<const u32> vertices = dag.ClusterVertices(cluster);
+        const TMemoryView<const u8> triangles = dag.ClusterTriangles(cluster);
+        forrange(t, 0, cluster.NumTriangles)
+            level0.push_back(TriangleKey_(vertices[triangles[t * 3]], vertices[triangles[t * 3 + 1]], vertices[triangles[t * 3 + 2]]));
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(level0.begin(), level0.end());
+    AssertRelease(expected.MakeConstView().RangeEqual(level0.MakeView()));
+
+    size_t numRoots = 0;
+    for (const FMeshCluster& cluster : dag.Clusters()) {
+        AssertRelease(cluster.NumVertices <= FMeshClusterDAG::MaxVertices);
+        AssertRelease(cluster.NumTriangles <= FMeshClusterDAG::MaxTriangles);
+        AssertRelease(cluster.NumTriangles > 0);
+
+        const TMemoryView<const u32> vertices = dag.ClusterVertices(cluster);
+        const TMemoryView<const u8> triangles = dag.ClusterTriangles(cluster);
+        for (u8 local : triangles)
+            AssertRelease(local < cluster.NumVertices);
+
+        // bounds and normal cone
+        const float tolerance = 1e-3f * (1.f + cluster.Radius);
+        for (u32 v : vertices)
+            AssertRelease(Distance(positions[v], cluster.Center) <= cluster.Radius + tolerance);
+
+        if (cluster.ConeCutoff < 1.f) {
+            const float minDot = Sqrt(1.f - cluster.ConeCutoff * cluster.ConeCutoff);
+            forrange(t, 0, cluster.NumTriangles) {
+                const float3& p0 = positions[vertices[triangles[t * 3 + 0]]];
+                const float3& p1 = positions[vertices[triangles[t * 3 + 1]]];
+                const float3& p2 = positions[vertices[triangles[t * 3 + 2]]];
+                const float3 normal = Cross(p1 - p0, p2 - p0);
+                if (LengthSq(normal) > 0)
+                    AssertRelease(Dot(Normalize(normal), cluster.ConeAxis) >= minDot - 1e-3f);
+            }
+        }
+
+        // errors and spheres grow toward the roots
+        if (cluster.IsRoot()) {
+            AssertRelease(cluster.ParentError == FLT_MAX);
+            ++numRoots;
+        }
+        else {
+            AssertRelease(cluster.ParentError >= cluster.LodError);
+            AssertRelease(Distance(cluster.LodCenter, cluster.ParentCenter) + cluster.LodRadius <= cluster.ParentRadius + tolerance);
+        }
+
+        if (0 == cluster.Level)
+            AssertRelease(cluster.LodError == 0.f);
+    }
+    AssertRelease(numRoots > 0);
+    AssertRelease(numRoots < dag.Level(0).size());
+
+    // the finest cut is level 0 and the coarsest only keeps the roots
+    const float3 eye{ n * 0.5f, n * 0.5f, 100.f };
+    const auto selectedTriangles = [&dag](const VECTOR(MeshBuilder, u32)& selected) {
+        size_t numTriangles = 0;
+        for (u32 c : selected)
+            numTriangles += dag.Clusters()[c].NumTriangles;
+        return numTriangles;
+    };
+
+    VECTOR(MeshBuilder, u32) finest;
+    AssertRelease(dag.SelectClusters(eye, 0.f, &finest) == finest.size());
+    for (u32 c : finest)
+        AssertRelease(dag.Clusters()[c].LodError == 0.f);
+    AssertRelease(selectedTriangles(finest) >= mesh.TriangleCount() / 2);
+
+    VECTOR(MeshBuilder, u32) coarsest;
+    AssertRelease(dag.SelectClusters(eye, 1e30f, &coarsest) == numRoots);
+    for (u32 c : coarsest)
+        AssertRelease(dag.Clusters()[c].IsRoot());
+    AssertRelease(selectedTriangles(coarsest) < selectedTriangles(finest));
+
+    // the mesh is seen from above, nothing can be culled from there
+    for (const FMeshCluster& cluster : dag.Level(0))
+        AssertRelease(not FMeshClusterDAG::IsBackfacing(cluster, eye));
+
+    // serialization round trip
+    MEMORYSTREAM(MeshBuilder) stream;
+    dag.Save(stream);
+
+    FMeshClusterDAG loaded;
+    FMemoryViewReader reader{ stream.MakeView() };
+    AssertRelease(loaded.Load(reader));
+    AssertRelease(loaded.NumLevels() == dag.NumLevels());
+    AssertRelease(loaded.NumGroups() == dag.NumGroups());
+    AssertRelease(loaded.Clusters().size() == dag.Clusters().size());
+    AssertRelease(0 == FPlatformMemory::Memcmp(loaded.Clusters().data(), dag.Clusters().data(), dag.Clusters().SizeInBytes()));
+    AssertRelease(loaded.Vertices().RangeEqual(dag.Vertices()));
+    AssertRelease(loaded.Triangles().RangeEqual(dag.Triangles()));
+
+    FMemoryViewReader truncated{ stream.MakeView().CutBefore(stream.SizeInBytes() / 2) };
+    AssertRelease(not loaded.Load(truncated));
+    AssertRelease(loaded.empty());
+
+    // untrusted streams: counts and ranges are validated before being used
+    const auto loadCorrupted = [&stream](size_t offset, u32 value) {
+        MEMORYSTREAM(MeshBuilder) corrupted;
+        corrupted.WriteView(stream.MakeView());
+        FPlatformMemory::Memcpy(corrupted.MakeView().data() + offset, &value, sizeof(value));
+
+        FMeshClusterDAG dag;
+        FMemoryViewReader reader{ corrupted.MakeView() };
+        const bool succeed = dag.Load(reader);
+        AssertRelease(succeed != dag.empty());
+        return succeed;
+    };
+
+    const size_t headerSize = 7 * sizeof(u32);
+    const size_t firstCluster = headerSize + (dag.NumLevels() + 1) * sizeof(u32);
+    AssertRelease(not loadCorrupted(5 * sizeof(u32), UINT32_MAX)); // number of vertices
+    AssertRelease(not loadCorrupted(firstCluster + offsetof(FMeshCluster, FirstVertex), UINT32_MAX));
+    AssertRelease(not loadCorrupted(firstCluster + offsetof(FMeshCluster, FirstTriangle), UINT32_MAX));
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_MeshSimplify_() {
+    const u32 n = 33;
+
+    // half of the triangles
+    {
+        FGenericMesh mesh;
+        HeightGrid_(&mesh, n);
+        const size_t numTriangles = mesh.TriangleCount();
+
+        FMeshSimplifySettings settings;
+        settings.TargetRatio = 0.5f;
+
+        float error = -1;
+        AssertRelease(SimplifyMesh(mesh, 0, settings, &error));
+        AssertRelease(mesh.TriangleCount() <= numTriangles / 2);
+        AssertRelease(mesh.TriangleCount() >= numTriangles / 4);
+        AssertRelease(error > 0);
+        AssertRelease(mesh.VertexCount() == size_t(n) * n);
+    }
+
+    // bounded error
+    {
+        FGenericMesh mesh;
+        HeightGrid_(&mesh, n);
+        const size_t numTriangles = mesh.TriangleCount();
+
+        FMeshSimplifySettings settings;
+        settings.TargetRatio = 0;
+        settings.MaxError = 0.05f;
+
+        float error = -1;
+        AssertRelease(SimplifyMesh(mesh, 0, settings, &error));
+        AssertRelease(mesh.TriangleCount() < numTriangles);
+        AssertRelease(mesh.TriangleCount() > 0);
+        AssertRelease(error >= 0 && error <= settings.MaxError);
+    }
+
+    // attributes and locked borders
+    {
+        FGenericMesh mesh;
+        HeightGrid_(&mesh, n);
+        GridTexcoords_(&mesh, n, false);
+        AssertRelease(ComputeNormals(mesh, 0));
+
+        FMeshSimplifySettings settings;
+        settings.TargetRatio = 0.25f;
+        settings.LockBorders = true;
+
+        AssertRelease(SimplifyMesh(mesh, 0, settings));
+        AssertRelease(mesh.TriangleCount() <= size_t(n - 1) * (n - 1) * 2 / 4);
+
+        VECTOR(MeshBuilder, u8) used;
+        used.resize(mesh.VertexCount(), u8(0));
+        for (u32 v : mesh.Indices())
+            used[v] = 1;
+
+        forrange(i, 0, n) {
+            AssertRelease(used[i]); // y = 0
+            AssertRelease(used[(n - 1) * n + i]); // y = n - 1
+            AssertRelease(used[i * n]); // x = 0
+            AssertRelease(used[i * n + n - 1]); // x = n - 1
+        }
+    }
+
+    // LOD chain, every LOD is simplified from the source
+    {
+        FGenericMesh mesh;
+        HeightGrid_(&mesh, n);
+        AssertRelease(ComputeNormals(mesh, 0));
+
+        FMeshSimplifySettings settings[4];
+        forrange(i, 0, lengthof(settings))
+            settings[i].TargetRatio = (0.5f / (1u << i));
+
+        FMeshLOD lods[lengthof(settings)];
+        AssertRelease(GenerateLODChain(MakeView(lods), mesh, 0, MakeConstView(settings)));
+
+        forrange(i, 0, lengthof(lods)) {
+            AssertRelease(lods[i].Indices.size() % 3 == 0);
+            AssertRelease(float(lods[i].Indices.size() / 3) <= mesh.TriangleCount() * settings[i].TargetRatio);
+            AssertRelease(lods[i].Error > 0);
+            for (u32 v : lods[i].Indices)
+                AssertRelease(v < mesh.VertexCount());
+
+            if (i > 0)
+                AssertRelease(lods[i].Indices.size() < lods[i - 1].Indices.size());
+        }
+
+        AssertRelease(lods[lengthof(lods) - 1].Error > lods[0].Error);
+    }
+}
+//----------------------------------------------------------------------------
+// serial scatter of the triangle normals, the implementation of ComputeNormals() before it went parallel
+static float3 SerialNormal_(const float3& p0, const float3& p1, const float3& p2) {
+    // Newell's method: sum cross product of all consecutive edges
+    auto crossEdge = [](const double3& a, const double3& b) -> double3 {
+        return (double3(a - b).yzx * double3(a + b).zxy);
+    };
+
+    const double3 d0{ p0 };
+    const double3 d1{ p1 };
+    const double3 d2{ p2 };
+
+    const double3 normal = crossEdge(d0, d1) + crossEdge(d1, d2) + crossEdge(d2, d0);
+    return float3(normal);
+}
+static void SerialNormals_(const FGenericMesh& mesh, const TMemoryView<float3>& normals) {
+    const TMemoryView<const float3> positions = mesh.Position3f_IFP(0).MakeView();
+    const TMemoryView<const u32> indices = mesh.Indices();
+
+    for (float3& n : normals)
+        n = float3::Zero;
+
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        const u32 i0 = indices[t + 0];
+        const u32 i1 = indices[t + 1];
+        const u32 i2 = indices[t + 2];
+
+        const float3 n = SerialNormal_(positions[i0], positions[i1], positions[i2]);
+
+        normals[i0] += n;
+        normals[i1] += n;
+        normals[i2] += n;
+    }
+
+    for (float3& n : normals)
+        n = Normalize(n);
+}
+//----------------------------------------------------------------------------
+// serial scatter of the triangle bases, the implementation of ComputeTangentSpace() before it went parallel
+// (with the sign of the basis of corner 2 fixed, it used to be computed from corner 1)
+static void SerialTriangleBasis_(
+    float3 *pTangent,
+    float3 *pBinormal,
+    const float3& pos0, const float3& pos1, const float3& pos2,
+    const float2& tex0, const float2& tex1, const float2& tex2 ) {
+    // triangle 0, 1, 2
+    const float3 pos10 = pos1 - pos0;
+    const float3 pos20 = pos2 - pos0;
+
+    const float2 tex10 = tex1 - tex0;
+    const float2 tex20 = tex2 - tex0;
+
+    const float f012 = (tex10.x * tex20.y -
+                        tex10.y * tex20.x );
+
+    // triangle 1, 0, 2
+    const float3 pos01 = pos0 - pos1;
+    const float3 pos21 = pos2 - pos1;
+
+    const float2 tex01 = tex0 - tex1;
+    const float2 tex21 = tex2 - tex1;
+
+    const float f102 = (tex01.x * tex21.y -
+                        tex01.y * tex21.x );
+
+    // triangle 2, 0, 1
+    const float3 pos02 = pos0 - pos2;
+    const float3 pos12 = pos1 - pos2;
+
+    const float2 tex02 = tex0 - tex2;
+    const float2 tex12 = tex1 - tex2;
+
+    const float f201 = (tex02.x * tex12.y -
+                        tex02.y * tex12.x );
+
+    if (Abs(f012) > Abs(f102) && Abs(f012) > Abs(f201)) {
+        const float f = (Abs(f012) < EpsilonSQ) ? 1.0f : 1.0f/f012;
+        *pTangent = ((pos10 * tex20.y) - (pos20 * tex10.y)) * f;
+        *pBinormal = ((pos20 * tex10.x) - (pos10 * tex20.x)) * f;
+    }
+    else if (Abs(f102) > Abs(f201)) {
+        const float f = (Abs(f102) < EpsilonSQ) ? 1.0f : 1.0f/f102;
+        *pTangent = ((pos01 * tex21.y) - (pos21 * tex01.y)) * f;
+        *pBinormal = ((pos21 * tex01.x) - (pos01 * tex21.x)) * f;
+    }
+    else {
+        const float f = (Abs(f201) < EpsilonSQ) ? 1.0f : 1.0f/f201;
+        *pTangent = ((pos02 * tex12.y) - (pos12 * tex02.y)) * f;
+        *pBinormal = ((pos12 * tex02.x) - (pos02 * tex12.x)) * f;
+    }
+}
+static void SerialTangentSpace_(const FGenericMesh& mesh, const TMemoryView<float3>& tangents3f, const TMemoryView<float3>& binormals3f) {
+    const TMemoryView<const float3> positions3f = mesh.Position3f_IFP(0).MakeView();
+    const TMemoryView<const float2> texcoords2f = mesh.Texcoord2f_IFP(0).MakeView();
+    const TMemoryView<const float3> normals3f = mesh.Normal3f_IFP(0).MakeView();
+    const TMemoryView<const u32> indices = mesh.Indices();
+
+    const float3 zero = float3::Zero;
+    forrange(i, 0, tangents3f.size())
+        tangents3f[i] = binormals3f[i] = zero;
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const u32 i0 = indices[i + 0];
+        const u32 i1 = indices[i + 1];
+        const u32 i2 = indices[i + 2];
+
+        float3 tangent;
+        float3 binormal;
+        SerialTriangleBasis_(
+            &tangent, &binormal,
+            positions3f[i0], positions3f[i1], positions3f[i2],
+            texcoords2f[i0], texcoords2f[i1], texcoords2f[i2] );
+
+        tangents3f[i0] += tangent;
+        tangents3f[i1] += tangent;
+        tangents3f[i2] += tangent;
+        binormals3f[i0] += binormal;
+        binormals3f[i1] += binormal;
+        binormals3f[i2] += binormal;
+    }
+
+    forrange(i, 0, tangents3f.size()) {
+        float3& tangent = tangents3f[i];
+        float3& binormal = binormals3f[i];
+        const float3& normal = normals3f[i];
+
+        if (float3(0) == tangent && float3(0) == binormal) {
+            tangent = float3(1, 0, 0);
+            binormal = Cross(normal, tangent);
+        }
+        else if (float3(0) == tangent) {
+            binormal = SafeNormalize(binormal);
+            tangent = Cross(normal, binormal);
+        }
+        else if (float3(0) == binormal) {
+            tangent = SafeNormalize(tangent);
+            binormal = Cross(normal, tangent);
+        }
+        else {
+            tangent = SafeNormalize(tangent);
+            binormal = SafeNormalize(binormal);
+        }
+
+        //Gram-Schmidt orthogonalization
+        tangent = SafeNormalize(tangent - normal * Dot(normal, tangent));
+
+        //Right handed TBN space ?
+        if (Dot(Cross(tangent, binormal), normal) < 0)
+            binormal = -binormal;
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_TangentSpace_() {
+    const u32 n = 97; // several parallel tasks
+
+    FGenericMesh mesh;
+    HeightGrid_(&mesh, n);
+    GridTexcoords_(&mesh, n, false);
+
+    const size_t numVertices = mesh.VertexCount();
+    VECTOR(MeshBuilder, float3) expected[2];
+    expected[0].resize_Uninitialized(numVertices);
+    expected[1].resize_Uninitialized(numVertices);
+
+    // same results than the serial version, up to the summation order
+    AssertRelease(ComputeNormals(mesh, 0));
+    SerialNormals_(mesh, expected[0].MakeView());
+
+    const TMemoryView<const float3> normals = mesh.Normal3f_IFP(0).MakeView();
+    forrange(v, 0, numVertices)
+        AssertRelease(DistanceSq(normals[v], expected[0][v]) < 1e-8f);
+
+    AssertRelease(ComputeTangentSpace(mesh, 0));
+    SerialTangentSpace_(mesh, expected[0].MakeView(), expected[1].MakeView());
+
+    const TMemoryView<const float3> tangents = mesh.Tangent3f_IFP(0).MakeView();
+    const TMemoryView<const float3> binormals = mesh.Binormal3f_IFP(0).MakeView();
+    forrange(v, 0, numVertices) {
+        AssertRelease(DistanceSq(tangents[v], expected[0][v]) < 1e-8f);
+        AssertRelease(DistanceSq(binormals[v], expected[1][v]) < 1e-8f);
+    }
+
+    // mikktspace: unit tangents orthogonal to the normals, the handedness follows the orientation of the uvs
+    for (bool mirrored : { false, true }) {
+        GridTexcoords_(&mesh, n, mirrored);
+        AssertRelease(ComputeTangentSpace(mesh, 0, true, ETangentSpace::MikkTSpace));
+
+        const TMemoryView<const float4> tangents4f = mesh.Tangent4f_IFP(0).MakeView();
+        forrange(v, 0, numVertices) {
+            const float3 tangent = tangents4f[v].xyz;
+            AssertRelease(Abs(LengthSq(tangent) - 1.f) < 1e-4f);
+            AssertRelease(Abs(Dot(tangent, normals[v])) < 1e-4f);
+            AssertRelease((tangent.x > 0) == (not mirrored)); // u goes along x
+            AssertRelease(tangents4f[v].w == (mirrored ? -1.f : 1.f));
+        }
+    }
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkMeshLoaders {
+// InputDim is the number of vertices: timings are per vertex
+class FMeshLoaderBenchmark : public FBenchmark {
+public:
+    using FLoad = bool (*)(FGenericMesh*, const FFilename&, const FStringView&);
+    FLoad Load;
+    FStringView Content;
+    FMeshLoaderBenchmark(FStringView name, FLoad load, FStringView content, u32 numVertices)
+    :   FBenchmark{ name }, Load(load), Content(content) {
+        InputDim = numVertices;
+    }
+    void operator ()(FBenchmark::FState& state) const {
+        for (auto _ : state) {
+            FGenericMesh mesh;
+            const bool succeed = Load(&mesh, Default, Content);
+            FBenchmark::DoNotOptimize(succeed);
+        }
+    }
+};
+} //!namespace BenchmarkMeshLoaders
+//----------------------------------------------------------------------------
+static void Benchmark_MeshLoaders_() {
+    using namespace BenchmarkMeshLoaders;
+
+    const u32 n = 512;
+
+    FStringBuilder obj;
+    GridObj_(obj, n, false);
+
+    FGenericMesh grid;
+    Verify(FWaveFrontObj::Load(&grid, Default, obj.Written()));
+
+    MEMORYSTREAM(Benchmark) plyBinary;
+    Verify(FPolygonFileFormat::Save(grid, Default, plyBinary));
+
+    // same mesh in ascii, with the header written by hand
+    FStringBuilder plyAscii;
+    plyAscii
+        << "ply" << Eol
+        << "format ascii 1.0" << Eol
+        << "element vertex " << grid.VertexCount() << Eol
+        << "property float x" << Eol << "property float y" << Eol << "property float z" << Eol
+        << "property float texture_u" << Eol << "property float texture_v" << Eol
+        << "element face " << grid.TriangleCount() << Eol
+        << "property list uchar uint vertex_indices" << Eol
+        << "end_header" << Eol;
+    {
+        const TMemoryView<const float3> positions = grid.Position3f_IFP(0).MakeView();
+        const TMemoryView<const float2> texcoords = grid.Texcoord2f_IFP(0).MakeView();
+        forrange(v, 0, grid.VertexCount())
+            plyAscii << positions[v].x << ' ' << positions[v].y << ' ' << positions[v].z << ' ' << texcoords[v].x << ' ' << texcoords[v].y << Eol;
+        forrange(t, 0, grid.TriangleCount()) {
+            const uint3 triangle = grid.Triangle(t);
+            plyAscii << "3 " << triangle.x << ' ' << triangle.y << ' ' << triangle.z << Eol;
+        }
+    }
+
+    PPE_LOG(Test_MeshBuilder, Info, "mesh loaders: obj {0}, ply ascii {1}, ply binary {2}",
+        Fmt::SizeInBytes(obj.Written().SizeInBytes()),
+        Fmt::SizeInBytes(plyAscii.Written().SizeInBytes()),
+        Fmt::SizeInBytes(plyBinary.SizeInBytes()) );
+
+    auto bm = FBenchmark::MakeTable("MeshLoaders"_view,
+        FMeshLoaderBenchmark{ "obj"_view, &FWaveFrontObj::Load, obj.Written(), grid.VertexCount() },
+        FMeshLoaderBenchmark{ "ply_ascii"_view, &FPolygonFileFormat::Load, plyAscii.Written(), grid.VertexCount() },
+        FMeshLoaderBenchmark{ "ply_binary"_view, &FPolygonFileFormat::Load, plyBinary.MakeView().Cast<const char>(), grid.VertexCount() } );
+
+    bm.Run("grid_512x512"_view);
+
+    FBenchmark::FlushAndLog(bm);
+}
+//----------------------------------------------------------------------------
+namespace BenchmarkMeshSimplify {
+// InputDim is the number of source triangles
+class FMeshSimplifyBenchmark : public FBenchmark {
+public:
+    const FGenericMesh& Mesh;
+    TMemoryView<const FMeshSimplifySettings> Settings;
+    FMeshSimplifyBenchmark(FStringView name, const FGenericMesh& mesh, TMemoryView<const FMeshSimplifySettings> settings)
+    :   FBenchmark{ name }, Mesh(mesh), Settings(settings) {
+        InputDim = checked_cast<u32>(mesh.TriangleCount());
+    }
+    void operator ()(FBenchmark::FState& state) const {
+        VECTOR(MeshBuilder, FMeshLOD) lods;
+        lods.resize(Settings.size());
+        for (auto _ : state) {
+            const bool succeed = GenerateLODChain(lods.MakeView(), Mesh, 0, Settings);
+            FBenchmark::DoNotOptimize(succeed);
+        }
+    }
+};
+} //!namespace BenchmarkMeshSimplify
+//----------------------------------------------------------------------------
+static void Benchmark_MeshSimplify_() {
+    using namespace BenchmarkMeshSimplify;
+
+    // ~1M triangles
+    FGenericMesh grid;
+    HeightGrid_(&grid, 708);
+    Verify(ComputeNormals(grid, 0));
+
+    FMeshSimplifySettings lodChain[4];
+    forrange(i, 0, lengthof(lodChain))
+        lodChain[i].TargetRatio = (0.5f / (1u << i));
+
+    auto bm = FBenchmark::MakeTable("MeshSimplify"_view,
+        FMeshSimplifyBenchmark{ "simplify_50"_view, grid, MakeConstView(lodChain).CutBefore(1) },
+        FMeshSimplifyBenchmark{ "lod_chain_4"_view, grid, MakeConstView(lodChain) } );
+
+    bm.Run("height_grid_708x708"_view);
+
+    FBenchmark::FlushAndLog(bm);
+}
+//----------------------------------------------------------------------------
+namespace BenchmarkTangentSpace {
+// InputDim is the number of triangles
+class FTangentSpaceBenchmark : public FBenchmark {
+public:
+    using FCompute = void (*)(FGenericMesh&);
+    FGenericMesh& Mesh;
+    FCompute Compute;
+    FTangentSpaceBenchmark(FStringView name, FGenericMesh& mesh, FCompute compute)
+    :   FBenchmark{ name }, Mesh(mesh), Compute(compute) {
+        InputDim = checked_cast<u32>(mesh.TriangleCount());
+    }
+    void operator ()(FBenchmark::FState& state) const {
+        for (auto _ : state) {
+            Compute(Mesh);
+            FBenchmark::ClobberMemory();
+        }
+    }
+};
+} //!namespace BenchmarkTangentSpace
+//----------------------------------------------------------------------------
+static void Benchmark_TangentSpace_() {
+    using namespace BenchmarkTangentSpace;
+
+    // ~1M triangles
+    FGenericMesh grid;
+    HeightGrid_(&grid, 708);
+    GridTexcoords_(&grid, 708, false);
+    Verify(ComputeNormals(grid, 0));
+    Verify(ComputeTangentSpace(grid, 0));
+
+    auto bm = FBenchmark::MakeTable("TangentSpace"_view,
+        FTangentSpaceBenchmark{ "normals_serial"_view, grid, [](FGenericMesh& mesh) {
+            SerialNormals_(mesh, mesh.Normal3f(0).MakeView());
+        } },
+        FTangentSpaceBenchmark{ "normals_parallel"_view, grid, [](FGenericMesh& mesh) {
+            Verify(ComputeNormals(mesh, 0));
+        } },
+        FTangentSpaceBenchmark{ "tangents_serial"_view, grid, [](FGenericMesh& mesh) {
+            SerialTangentSpace_(mesh, mesh.Tangent3f(0).MakeView(), mesh.Binormal3f(0).MakeView());
+        } },
+        FTangentSpaceBenchmark{ "tangents_parallel"_view, grid, [](FGenericMesh& mesh) {
+            Verify(ComputeTangentSpace(mesh, 0));
+        } },
+        FTangentSpaceBenchmark{ "tangents_mikk"_view, grid, [](FGenericMesh& mesh) {
+            Verify(ComputeTangentSpace(mesh, 0, false, ETangentSpace::MikkTSpace));
+        } } );
+
+    bm.Run("height_grid_708x708"_view);
+
+    FBenchmark::FlushAndLog(bm);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void Test_MeshBuilder() {
+    PPE_DEBUG_NAMEDSCOPE("Test_MeshBuilder");
+
+    PPE_LOG(Test_MeshBuilder, Emphasis, "starting mesh builder tests ...");
+
+    Test_ObjFaces_();
+    Test_ObjChunks_();
+    Test_PlyAscii_();
+    Test_PlyBinary_();
+    Test_MeshClusters_();
+    Test_MeshSimplify_();
+    Test_TangentSpace_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_MeshLoaders_();
+    Benchmark_MeshSimplify_();
+    Benchmark_TangentSpace_();
+#endif
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace Test
+} //!namespace PPE
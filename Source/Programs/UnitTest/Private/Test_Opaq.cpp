@@ -2,12 +2,18 @@
 
 #include "Misc/Opaque.h"
 #include "Misc/OpaqueBuilder.h"
+#include "Misc/OpaqueDocument.h"
 
 
 #include "Allocator/SlabAllocator.h"
 #include "Allocator/SlabHeap.h"
+#include "Container/Vector.h"
+#include "Diagnostic/Benchmark.h"
 #include "Diagnostic/Logger.h"
+#include "IO/Format.h"
+#include "IO/StringBuilder.h"
 #include "IO/TextWriter.h"
+#include "Memory/HashFunctions.h"
 #include "Meta/Utility.h"
 #include "Misc/Function.h"
 
@@ -231,6 +237,184 @@ static void Test_Opaq_SlabMemoization_() {
     PPE_LOG(Test_Opaq, Info, "slab builder block memoized: {}", value_block);
 }
 //----------------------------------------------------------------------------
+static void Test_Opaq_Document_() {
+    using namespace Opaq;
+
+    document_block doc = NewDocument(object_init{
+        {"name", "Paul"},
+        {"city", "Paris"},
+        {"alias", "Paul"},
+        {"address", object_init{
+            {"number", 13},
+            {"city", "Paris"},
+        }},
+        {"children", array_init{
+            object_init{ {"name", L"Anaïs"} },
+            object_init{ {"name", L"Théophile"} },
+        }},
+    });
+
+    const document_view view = doc.View();
+    AssertRelease(view.Validate());
+    AssertRelease(view.header->num_objects == 4);
+    AssertRelease(view.header->num_strings == 10); // 6 keys + 2 ansi values + 2 wide values
+
+    AssertRelease(*XPathAs<integer>(view, { "address"_view, "number"_view }) == 13);
+    AssertRelease(XPathAs<string_view>(view, { "alias"_view })->data() == XPathAs<string_view>(view, { "name"_view })->data());
+    AssertRelease(not XPath(view, { "address"_view, "street"_view }).has_value());
+
+    const FString expected = ToString(view);
+    PPE_LOG(Test_Opaq, Info, "frozen document: {}", view);
+
+    // documents are position independent: relocate with a raw copy and release the original
+    FAllocatorBlock relocated = TStaticAllocator<default_allocator>::Allocate(view.header->size_in_bytes);
+    FPlatformMemory::Memcpy(relocated.Data, view.header.get(), view.header->size_in_bytes);
+    DeleteDocument(doc);
+
+    const Meta::TOptional<document_view> attached = document_view::Attach(relocated.MakeView());
+    AssertRelease(attached.has_value());
+    AssertRelease(attached->Validate());
+    AssertRelease(ToString(*attached) == expected);
+
+    // offsets are untrusted: a dangling node must be rejected even when the fingerprint matches
+    {
+        document_header& header = *static_cast<document_header*>(relocated.Data);
+        const auto refreshFingerprint = [&header]() {
+            header.fingerprint = Fingerprint32(&header + 1, header.size_in_bytes - sizeof(document_header));
+        };
+
+        array_view& dangling = const_cast<array_view&>(std::get<array_view>(*XPath(*attached, { "children"_view })->get()));
+        const i32 offset = dangling.Offset;
+
+        dangling.Offset = checked_cast<i32>(header.size_in_bytes);
+        refreshFingerprint();
+        AssertRelease(not attached->Validate());
+
+        dangling.Offset = offset;
+        refreshFingerprint();
+        AssertRelease(attached->Validate());
+    }
+
+    const TPtrRef<const value_view> children = *XPath(*attached, { "children"_view });
+    const object_view& child = std::get<object_view>(std::get<array_view>(*children).at(1));
+    AssertRelease(Equals(FWStringView(std::get<wstring_view>(*XPath(*attached, child, "name"_view)->get()).MakeView()), L"Théophile"_view));
+
+    TStaticAllocator<default_allocator>::Deallocate(relocated);
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkOpaq {
+struct FSample {
+    Opaq::value_block Block;
+    Opaq::document_block Document;
+    VECTOR(UnitTest, FString) Keys;
+};
+// regular value_block: linear key scan, printed as json text
+struct FValueBlockOps {
+    static size_t Build(const FSample& sample) {
+        Opaq::value_block block = Opaq::NewBlock(TStaticAllocator<Opaq::default_allocator>::Allocate(Opaq::BlockSize(*sample.Block)), *sample.Block);
+        const size_t sz = block.alloc.SizeInBytes;
+        Opaq::DeleteBlock(block);
+        return sz;
+    }
+    static size_t Lookup(const FSample& sample) {
+        const Opaq::object_view& o = std::get<Opaq::object_view>(*sample.Block);
+        size_t n = 0;
+        for (const FString& key : sample.Keys)
+            n += Opaq::XPath(o, key.MakeView()).has_value();
+        return n;
+    }
+    static size_t Save(const FSample& sample) {
+        FStringBuilder oss;
+        oss << sample.Block;
+        return oss.ToString().size();
+    }
+};
+// frozen document: hashed key index, saved as a raw copy
+struct FDocumentOps {
+    static size_t Build(const FSample& sample) {
+        Opaq::document_block doc = Opaq::NewDocument(*sample.Block);
+        const size_t sz = doc.alloc.SizeInBytes;
+        Opaq::DeleteDocument(doc);
+        return sz;
+    }
+    static size_t Lookup(const FSample& sample) {
+        const Opaq::document_view view = sample.Document.View();
+        const Opaq::object_view& o = std::get<Opaq::object_view>(view.Root());
+        size_t n = 0;
+        for (const FString& key : sample.Keys)
+            n += Opaq::XPath(view, o, key.MakeView()).has_value();
+        return n;
+    }
+    static size_t Save(const FSample& sample) {
+        const FRawMemoryConst raw = sample.Document.View().MakeView();
+        FAllocatorBlock copy = TStaticAllocator<Opaq::default_allocator>::Allocate(raw.SizeInBytes());
+        FPlatformMemory::Memcpy(copy.Data, raw.data(), raw.SizeInBytes());
+        TStaticAllocator<Opaq::default_allocator>::Deallocate(copy);
+        return raw.SizeInBytes();
+    }
+};
+template <typename _Functor>
+class TOpaqBenchmark : public FBenchmark {
+public:
+    explicit TOpaqBenchmark(FStringView name) : FBenchmark{ name } {}
+    template <typename _Ops>
+    void operator ()(FBenchmark::FState& state, const _Ops& ops, const FSample* sample) const {
+        for (auto _ : state) {
+            const size_t n = _Functor{}(ops, *sample);
+            FBenchmark::DoNotOptimize(n);
+        }
+    }
+};
+struct build_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FSample& sample) const { return _Ops::Build(sample); } };
+struct lookup_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FSample& sample) const { return _Ops::Lookup(sample); } };
+struct save_op_t { template <typename _Ops> size_t operator ()(const _Ops&, const FSample& sample) const { return _Ops::Save(sample); } };
+} //!namespace BenchmarkOpaq
+//----------------------------------------------------------------------------
+static void Benchmark_Opaq_Document_(const FStringView& name, u32 numKeys) {
+    using namespace Opaq;
+    using namespace BenchmarkOpaq;
+
+    FSample sample;
+    sample.Keys.reserve(numKeys);
+    forrange(i, 0, numKeys)
+        sample.Keys.push_back(StringFormat("property_{0}", i));
+
+    value<> v;
+    TBuilder<> builder(&v);
+    builder.Object([&]() {
+        forrange(i, 0, numKeys) {
+            builder.KeyValue(sample.Keys[i].MakeView(), [&]() {
+                builder.Object([&]() {
+                    builder.KeyValue("index", i);
+                    builder.KeyValue("label", sample.Keys[i % 7].MakeView());
+                    builder.KeyValue("enabled", (i & 1) == 0);
+                });
+            });
+        }
+    }, numKeys);
+
+    sample.Block = builder.ToValueBlock(TStaticAllocator<default_allocator>::Allocate(builder.BlockSize()));
+    sample.Document = NewDocument(*sample.Block);
+
+    AssertRelease(FValueBlockOps::Lookup(sample) == numKeys);
+    AssertRelease(FDocumentOps::Lookup(sample) == numKeys);
+
+    auto bm = FBenchmark::MakeTable(name,
+        TOpaqBenchmark<build_op_t>{ "build"_view },
+        TOpaqBenchmark<lookup_op_t>{ "lookup"_view },
+        TOpaqBenchmark<save_op_t>{ "save"_view } );
+
+    bm.Run("value_block", FValueBlockOps{}, &sample);
+    bm.Run("document", FDocumentOps{}, &sample);
+
+    FBenchmark::FlushAndLog(bm);
+
+    DeleteDocument(sample.Document);
+    DeleteBlock(sample.Block);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
 } //!namespace
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -242,6 +426,12 @@ void Test_Opaq() {
     Test_Opaq_Alloc_();
     Test_Opaq_Slab_();
     Test_Opaq_SlabMemoization_();
+    Test_Opaq_Document_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_Opaq_Document_("Opaq_document_16"_view, 16);
+    Benchmark_Opaq_Document_("Opaq_document_1024"_view, 1024);
+#endif
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -4,12 +4,14 @@
 #include "MetaTransaction.h"
 #include "RTTI/Any.h"
 #include "RTTI/Atom.h"
+#include "RTTI/AtomHeap.h"
 #include "RTTI/AtomVisitor.h"
 #include "RTTI/Macros.h"
 #include "RTTI/Macros-impl.h"
 #include "RTTI/Module.h"
 #include "RTTI/Module-impl.h"
 #include "RTTI/NativeTypes.h"
+#include "RTTI/ReferenceCollector.h"
 #include "RTTI/TypeInfos.h"
 
 #include "Binary/BinarySerializer.h"
@@ -526,6 +528,47 @@ static NO_INLINE void Test_Any_() {
     AssertRelease(anyAny.Equals(anyAny2));
 }
 //----------------------------------------------------------------------------
+static NO_INLINE void Test_AtomHeap_() {
+    RTTI::FAtomHeap& heap = RTTI::FAtomHeap::ThreadLocal();
+    AssertRelease(&heap == &RTTI::FAtomHeap::ThreadLocal());
+
+    const RTTI::FAtomHeap::FStatistics before = heap.Statistics();
+
+    RTTI::FAny promoted;
+    {
+        const RTTI::FAtomHeap::FScope outer{ heap };
+
+        const RTTI::FAtom i = heap.AllocateCopy(42);
+        const RTTI::FAtom s = heap.AllocateCopy(FString("toto"));
+        AssertRelease(i.TypedConstData<int>() == 42);
+        AssertRelease(s.TypedConstData<FString>() == "toto");
+        AssertRelease(heap.Statistics().NumAllocations == before.NumAllocations + 2);
+        AssertRelease(heap.Statistics().NumDestructibles == before.NumDestructibles + 1);
+
+        const RTTI::FAtomHeap::FMark mark = heap.Mark();
+        forrange(n, 0, 10000) // spans over several chunks
+            heap.AllocateCopy(FString(StringFormat("string #{0}", n)));
+        heap.Allocate(RTTI::MakeTraits<TVector<int>>()); // non-trivial, after the mark
+        AssertRelease(heap.Statistics().NumChunks > 1);
+        heap.Rewind(mark);
+
+        AssertRelease(heap.Statistics().NumAllocations == before.NumAllocations + 2);
+        AssertRelease(heap.Statistics().NumDestructibles == before.NumDestructibles + 1);
+        AssertRelease(heap.Statistics().NumFreeChunks > 0); // chunks are recycled
+        AssertRelease(s.TypedConstData<FString>() == "toto");
+
+        promoted = RTTI::FAtomHeap::Promote(s);
+    }
+
+    AssertRelease(heap.Statistics().NumAllocations == before.NumAllocations);
+    AssertRelease(heap.Statistics().BytesInUse == before.BytesInUse);
+    AssertRelease(heap.Statistics().NumDestructibles == before.NumDestructibles);
+    AssertRelease(heap.Statistics().PeakBytesInUse > before.BytesInUse);
+
+    AssertRelease(promoted);
+    AssertRelease(promoted.FlatData<FString>() == "toto");
+}
+//----------------------------------------------------------------------------
 static NO_INLINE void Test_CircularReferences_() {
     PRTTITest_ riri{ NEW_RTTI(FRTTITest_) };
     PRTTITest_ fifi{ NEW_RTTI(FRTTITest_) };
@@ -548,6 +591,60 @@ static NO_INLINE void Test_CircularReferences_() {
     VerifyRelease(RTTI::CheckCircularReferences(MakeView(objs)));
 }
 //----------------------------------------------------------------------------
+static NO_INLINE void Test_ParallelReferences_() {
+    // binary tree, large enough to expand the last levels in parallel
+    VECTOR(MetaObject, PRTTITest_) objs;
+    objs.resize(1023);
+    for (PRTTITest_& it : objs)
+        it = NEW_RTTI(FRTTITest_);
+
+    forrange(i, 0, objs.size() / 2) {
+        objs[i]->_MetaObjectVec.push_back(objs[i * 2 + 1]);
+        objs[i]->_MetaObjectVec.push_back(objs[i * 2 + 2]);
+    }
+
+    objs[42]->RTTI_Export(RTTI::FName{ "obj42" });
+    objs[900]->SetChild(objs[3]); // shared, but not circular
+
+    const RTTI::PMetaObject roots[1] = { objs[0] };
+
+    RTTI::FParallelReferenceCollector collector;
+    RTTI::FParallelReferenceCollector::FResults results;
+    collector.Collect(MakeView(roots), &results);
+
+    AssertRelease(results.Reachable.size() == objs.size());
+    AssertRelease(results.Exported.size() == 1);
+    AssertRelease(results.Exported.front().get() == objs[42].get());
+    AssertRelease(results.Imported.empty());
+    AssertRelease(not results.HasDanglings());
+    AssertRelease(not results.HasCycles());
+    AssertRelease(results.NumReferences == objs.size()); // 1022 tree edges + 1 shared
+
+    // postfix order: every object comes after the objects it references
+    HASHMAP(MetaObject, const RTTI::FMetaObject*, size_t) order;
+    forrange(i, 0, results.Reachable.size())
+        order.emplace(results.Reachable[i].get(), i);
+    forrange(i, 0, objs.size() / 2) {
+        AssertRelease(order.at(objs[i].get()) > order.at(objs[i * 2 + 1].get()));
+        AssertRelease(order.at(objs[i].get()) > order.at(objs[i * 2 + 2].get()));
+    }
+    AssertRelease(order.at(objs[900].get()) > order.at(objs[3].get()));
+
+    // results must not depend on scheduling
+    RTTI::FParallelReferenceCollector::FResults again;
+    collector.Collect(MakeView(roots), &again);
+    AssertRelease(std::equal(
+        results.Reachable.begin(), results.Reachable.end(),
+        again.Reachable.begin(), again.Reachable.end() ));
+
+    objs[1000]->SetChild(objs[0]); // circular
+    collector.Collect(MakeView(roots), &results);
+    AssertRelease(results.HasCycles());
+    AssertRelease(results.Reachable.size() == objs.size());
+
+    objs[1000]->SetChild(nullptr); // break the cycle before releasing
+}
+//----------------------------------------------------------------------------
 static NO_INLINE void Test_Serializer_(const RTTI::FMetaTransaction& input, Serialize::ISerializer& serializer, const FFilename& filename) {
     Assert_NoAssume(not input.empty());
 
@@ -897,6 +994,71 @@ static NO_INLINE void Test_TransactionSerialization_() {
     }
 }
 //----------------------------------------------------------------------------
+static NO_INLINE void Test_DeltaSerializer_() {
+    FRTTIAtomRandomizer_ rand(32, 0xdeadbeefabadcafeull);
+
+    RTTI::FMetaTransaction input(RTTI::FName(MakeStringView("UnitTest_Delta")));
+    forrange(i, 0, 8) {
+        TRefPtr<FRTTITestSimple_> t = NEW_RTTI(FRTTITestSimple_);
+        rand.Randomize(t.get());
+        input.Add(t.get());
+    }
+
+    input.Load();
+
+    const FFilename filename{ L"Saved:/RTTI/UnitTest_Delta.bnx" };
+
+    MEMORYSTREAM(Stream) chunks;
+    Serialize::FBinaryDeltaSerializer delta;
+    {
+        Serialize::FTransactionSaver saver{ input, filename };
+        delta.SerializeBase(saver, &chunks);
+    }
+    AssertRelease(delta.HasBase());
+    AssertRelease(checked_cast<size_t>(chunks.SizeInBytes()) == delta.BaseSizeInBytes());
+
+    for (const RTTI::PMetaObject& obj : input.TopObjects())
+        AssertRelease(not obj->RTTI_IsDirty());
+
+    using EDeltaResult = Serialize::FBinaryDeltaSerializer::EDeltaResult;
+
+    // nothing changed: nothing should be appended
+    {
+        Serialize::FTransactionSaver saver{ input, filename };
+        VerifyRelease(delta.SerializeDelta(saver, &chunks) == EDeltaResult::NothingToAppend);
+    }
+    AssertRelease(0 == delta.NumDeltas());
+    AssertRelease(checked_cast<size_t>(chunks.SizeInBytes()) == delta.BaseSizeInBytes());
+
+    // writes through RTTI are marking the object as dirty
+    int value = 42;
+    RTTI::FMetaObject& patched = *input.TopObjects()[3];
+    VerifyRelease(patched.RTTI_PropertyCopyFrom(RTTI::FName(MakeStringView("_i")), RTTI::MakeAtom(&value)));
+    AssertRelease(patched.RTTI_IsDirty());
+    {
+        Serialize::FTransactionSaver saver{ input, filename };
+        VerifyRelease(delta.SerializeDelta(saver, &chunks) == EDeltaResult::Appended);
+    }
+    AssertRelease(1 == delta.NumDeltas());
+    AssertRelease(not patched.RTTI_IsDirty());
+    AssertRelease(delta.DeltaSizeInBytes() < delta.BaseSizeInBytes());
+    AssertRelease(checked_cast<size_t>(chunks.SizeInBytes()) == delta.BaseSizeInBytes() + delta.DeltaSizeInBytes());
+
+    // replaying base + delta should give back the current state
+    RTTI::FMetaTransaction output(RTTI::FName(MakeStringView("UnitTest_Delta_Output")));
+    {
+        Serialize::FTransactionLinker linker{ filename };
+        Serialize::ISerializer::Deserialize(*Serialize::FBinarySerializer::Get(), chunks.MakeView(), &linker);
+        linker.Resolve(output);
+    }
+
+    AssertRelease(input.TopObjects().size() == output.TopObjects().size());
+    if (false == input.DeepEquals(output))
+        AssertNotReached();
+
+    input.Unload();
+}
+//----------------------------------------------------------------------------
 static NO_INLINE void Test_TransactionSerializer_() {
     Serialize::FDirectoryTransaction import(
         RTTI::FName("Robotapp"),
@@ -973,6 +1135,9 @@ static NO_INLINE void Test_Serialize_() {
         Test_TransactionSerialization_<FRTTITestSimple_>();
         Test_TransactionSerialization_<FRTTITest_>();
     }
+    {
+        Test_DeltaSerializer_();
+    }
     {
         Test_TransactionSerializer_();
     }
@@ -1065,7 +1230,9 @@ void Test_RTTI() {
 
     Test_Atoms_();
     Test_Any_();
+    Test_AtomHeap_();
     Test_CircularReferences_();
+    Test_ParallelReferences_();
     Test_Grammar_();
     Test_Serialize_();
     Test_InteractiveConsole_();
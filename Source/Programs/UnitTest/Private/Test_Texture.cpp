@@ -0,0 +1,571 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Texture/BlockEncoder.h"
+#include "Texture/ImageResampler.h"
+#include "Texture/TextureEnums.h"
+
+#include "Container/Vector.h"
+#include "Diagnostic/Benchmark.h"
+#include "Diagnostic/Logger.h"
+#include "HAL/PlatformMaths.h"
+#include "HAL/PlatformMemory.h"
+#include "Maths/MathHelpers.h"
+#include "Maths/RandomGenerator.h"
+#include "Maths/ScalarVectorHelpers.h"
+
+namespace PPE {
+namespace Test {
+LOG_CATEGORY(, Test_Texture)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+using namespace ContentPipeline;
+//----------------------------------------------------------------------------
+CONSTEXPR EImageResampleFilter GResampleFilters_[] = {
+    EImageResampleFilter::Box,
+    EImageResampleFilter::CubicBSpline,
+    EImageResampleFilter::CatmullRom,
+    EImageResampleFilter::MitchellNetrevalli,
+    EImageResampleFilter::PointSample,
+};
+//----------------------------------------------------------------------------
+static FStringView ResampleFilterName_(EImageResampleFilter filter) {
+    switch (filter) {
+    case EImageResampleFilter::Box: return "Box"_view;
+    case EImageResampleFilter::CubicBSpline: return "CubicBSpline"_view;
+    case EImageResampleFilter::CatmullRom: return "CatmullRom"_view;
+    case EImageResampleFilter::MitchellNetrevalli: return "MitchellNetrevalli"_view;
+    case EImageResampleFilter::PointSample: return "PointSample"_view;
+    }
+    AssertNotReached();
+}
+//----------------------------------------------------------------------------
+static FImageResampleLayout MakeLayout_(u32 width, u32 height, ETextureSourceFormat format, ETextureGammaSpace gamma = ETextureGammaSpace::Linear) {
+    return {
+        .Dimensions = uint2(width, height),
+        .Format = format,
+        .Flags = Default,
+        .Gamma = gamma,
+    };
+}
+//----------------------------------------------------------------------------
+static void RandomImage_(VECTOR(Texture, u8)* pixels, const FImageResampleLayout& layout, FRandomGenerator& rng) {
+    pixels->resize_Uninitialized(layout.SizeInBytes());
+    for (u8& p : *pixels)
+        p = static_cast<u8>(rng.Next() & 0xFF);
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_ResampleConstant_() {
+    // every normalized kernel must preserve a constant image, whatever the edges and the band split
+    const uint2 sizes[][2] = {
+        { uint2(64, 64), uint2(32, 32) },
+        { uint2(64, 32), uint2(1, 1) },
+        { uint2(7, 5), uint2(13, 9) },
+        { uint2(100, 60), uint2(33, 17) },
+        { uint2(1, 1), uint2(4, 4) },
+    };
+
+    for (const EImageResampleFilter filter : GResampleFilters_) {
+        for (const auto& size : sizes) {
+            for (const bool bWrap : { false, true }) {
+                const FImageResampler resampler{ size[0], size[1], filter, bWrap };
+
+                VECTOR(Texture, float4) src, dst;
+                src.resize_Uninitialized(static_cast<size_t>(size[0].x) * size[0].y);
+                dst.resize_Uninitialized(static_cast<size_t>(size[1].x) * size[1].y);
+                Broadcast(src.MakeView(), float4(0.25f, 0.5f, 0.75f, 1.f));
+
+                resampler.ResampleLinear(dst.MakeView(), src.MakeConstView());
+
+                for (const float4& texel : dst)
+                    AssertRelease(NearlyEquals(texel, float4(0.25f, 0.5f, 0.75f, 1.f), 1e-4f));
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_ResampleBox_() {
+    // a 2:1 box is the average of 2x2 texels, 8 bits output is rounded to nearest
+    FRandomGenerator rng;
+
+    const FImageResampleLayout srcLayout = MakeLayout_(256, 128, ETextureSourceFormat::RGBA8);
+    const FImageResampleLayout dstLayout = MakeLayout_(128, 64, ETextureSourceFormat::RGBA8);
+
+    VECTOR(Texture, u8) src, dst;
+    RandomImage_(&src, srcLayout, rng);
+    forrange(i, 0, src.size() / 4)
+        src[i * 4 + 3] = 0xFF; // opaque, or colors would be weighted by alpha
+    dst.resize_Uninitialized(dstLayout.SizeInBytes());
+
+    const FImageResampler resampler{ srcLayout.Dimensions, dstLayout.Dimensions, EImageResampleFilter::Box };
+    AssertRelease(resampler.KernelX().NumTaps == 2);
+    AssertRelease(resampler.Resample(dstLayout, dst.MakeView(), srcLayout, src.MakeConstView()));
+
+    const size_t srcStride = static_cast<size_t>(srcLayout.Dimensions.x) * 4;
+    forrange(y, 0, dstLayout.Dimensions.y) {
+        forrange(x, 0, dstLayout.Dimensions.x) {
+            forrange(c, 0, 4) {
+                const u8* const p = src.data() + (2 * y) * srcStride + (2 * x) * 4 + c;
+                const float expected = (p[0] + p[4] + p[srcStride] + p[srcStride + 4]) / 4.f;
+                const u8 actual = dst[(y * dstLayout.Dimensions.x + x) * 4 + c];
+                AssertRelease(Abs(actual - expected) <= 0.51f);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_ResampleCodecs_() {
+    FRandomGenerator rng;
+
+    // decode/encode round trip is lossless for 8 bits, even through sRGB
+    for (const ETextureSourceFormat format : { ETextureSourceFormat::G8, ETextureSourceFormat::RG8, ETextureSourceFormat::BGRE8 }) {
+        for (const ETextureGammaSpace gamma : { ETextureGammaSpace::Linear, ETextureGammaSpace::sRGB }) {
+            const FImageResampleLayout layout = MakeLayout_(67, 33, format, gamma);
+
+            VECTOR(Texture, u8) src, dst;
+            RandomImage_(&src, layout, rng);
+            dst.resize_Uninitialized(src.size());
+
+            VECTOR(Texture, float4) linear;
+            linear.resize_Uninitialized(static_cast<size_t>(layout.Dimensions.x) * layout.Dimensions.y);
+
+            AssertRelease(FImageResampler::DecodeLinear(linear.MakeView(), layout, src.MakeConstView()));
+            AssertRelease(FImageResampler::EncodeLinear(layout, dst.MakeView(), linear.MakeConstView()));
+            AssertRelease(src.MakeConstView().RangeEqual(dst.MakeConstView()));
+        }
+    }
+
+    // BGRA8 is swizzled to RGBA, and colors are weighted by alpha
+    {
+        const FImageResampleLayout layout = MakeLayout_(1, 1, ETextureSourceFormat::BGRA8);
+        const u8 bgra[4] = { 0x00, 0x80, 0xFF, 0x80 };
+
+        float4 linear;
+        AssertRelease(FImageResampler::DecodeLinear(MakeView(&linear, &linear + 1), layout, MakeRawView(bgra, sizeof(bgra))));
+        AssertRelease(NearlyEquals(linear, float4(1.f, 128.f / 255.f, 0.f, 128.f / 255.f) * float4(128.f / 255.f, 128.f / 255.f, 128.f / 255.f, 1.f)));
+
+        u8 rgba[4];
+        AssertRelease(FImageResampler::EncodeLinear(MakeLayout_(1, 1, ETextureSourceFormat::RGBA8), MakeRawView(rgba, sizeof(rgba)), MakeView(&linear, &linear + 1)));
+        AssertRelease(rgba[0] == 0xFF && rgba[1] == 0x80 && rgba[2] == 0x00 && rgba[3] == 0x80);
+    }
+
+    // transparent texels don't bleed their color on their neighbors
+    {
+        const FImageResampleLayout srcLayout = MakeLayout_(2, 1, ETextureSourceFormat::RGBA8);
+        const FImageResampleLayout dstLayout = MakeLayout_(1, 1, ETextureSourceFormat::RGBA8);
+        const u8 src[8] = { 0xFF, 0x00, 0x00, 0x00, /* transparent red */ 0x00, 0xFF, 0x00, 0xFF /* opaque green */ };
+
+        u8 dst[4];
+        const FImageResampler resampler{ srcLayout.Dimensions, dstLayout.Dimensions, EImageResampleFilter::Box };
+        AssertRelease(resampler.Resample(dstLayout, MakeRawView(dst, sizeof(dst)), srcLayout, MakeRawView(src, sizeof(src))));
+        AssertRelease(dst[0] == 0x00 && dst[1] == 0xFF && dst[2] == 0x00 && dst[3] == 0x80);
+    }
+
+    // decoding on the fly gives the same result than decoding first
+    {
+        const FImageResampleLayout srcLayout = MakeLayout_(300, 200, ETextureSourceFormat::RGBA16, ETextureGammaSpace::Linear);
+        VECTOR(Texture, u8) src;
+        RandomImage_(&src, srcLayout, rng);
+
+        VECTOR(Texture, float4) decoded, dst0, dst1;
+        decoded.resize_Uninitialized(static_cast<size_t>(srcLayout.Dimensions.x) * srcLayout.Dimensions.y);
+        dst0.resize_Uninitialized(150 * 100);
+        dst1.resize_Uninitialized(150 * 100);
+
+        const FImageResampler resampler{ srcLayout.Dimensions, uint2(150, 100), EImageResampleFilter::MitchellNetrevalli, true };
+        AssertRelease(FImageResampler::DecodeLinear(decoded.MakeView(), srcLayout, src.MakeConstView()));
+        resampler.ResampleLinear(dst0.MakeView(), decoded.MakeConstView());
+        AssertRelease(resampler.ResampleLinear(dst1.MakeView(), srcLayout, src.MakeConstView()));
+        AssertRelease(dst0.MakeConstView().RangeEqual(dst1.MakeConstView()));
+    }
+}
+//----------------------------------------------------------------------------
+// smooth gradients with noise, sharp features and alpha cutouts: what block encoders are tuned for
+static void BlockEncoderImage_(VECTOR(Texture, u8)* pixels, const uint2& dimensions, bool bAlpha, FRandomGenerator& rng) {
+    pixels->resize_Uninitialized(static_cast<size_t>(dimensions.x) * dimensions.y * 4);
+
+    forrange(y, 0, dimensions.y) {
+        forrange(x, 0, dimensions.x) {
+            const float fx = static_cast<float>(x) / dimensions.x;
+            const float fy = static_cast<float>(y) / dimensions.y;
+
+            int r = RoundToInt(255.f * fx);
+            int g = RoundToInt(255.f * fy);
+            int b = RoundToInt(128.f + 127.f * FPlatformMaths::Sin(fx * 20.f + fy * 7.f));
+            if ((x / 13 + y / 11) % 5 == 0) {
+                r = 255 - r;
+                b = 30;
+            }
+            if ((x / 8 + y / 8) % 7 == 3) {
+                r = 200; g = 40; b = 220;
+            }
+
+            r += static_cast<int>(rng.NextU32(16)) - 8;
+            g += static_cast<int>(rng.NextU32(16)) - 8;
+            b += static_cast<int>(rng.NextU32(8)) - 4;
+
+            int a = 255;
+            if (bAlpha) {
+                a = RoundToInt(255.f * (0.5f + 0.5f * FPlatformMaths::Cos(fx * 9.f + fy * 3.f)));
+                if ((x / 16 + y / 16) % 4 == 0)
+                    a = (x % 8 < 4 ? 0 : 255);
+            }
+
+            u8* const texel = pixels->data() + (static_cast<size_t>(y) * dimensions.x + x) * 4;
+            texel[0] = static_cast<u8>(Clamp(r, 0, 255));
+            texel[1] = static_cast<u8>(Clamp(g, 0, 255));
+            texel[2] = static_cast<u8>(Clamp(b, 0, 255));
+            texel[3] = static_cast<u8>(a);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static float BlockEncoderPSNR_(const TMemoryView<const u8>& expected, const TMemoryView<const u8>& actual, u32 numChannels) {
+    Assert(expected.size() == actual.size());
+
+    double sqErr = 0;
+    forrange(i, 0, expected.size() / 4) {
+        forrange(c, 0, numChannels) {
+            const double d = static_cast<double>(expected[i * 4 + c]) - actual[i * 4 + c];
+            sqErr += d * d;
+        }
+    }
+
+    const float mse = static_cast<float>(sqErr / ((expected.size() / 4) * numChannels));
+    return (mse > 0 ? 10.f * FPlatformMaths::LogX(10.f, Sqr(255.f) / mse) : 99.f);
+}
+//----------------------------------------------------------------------------
+struct FBlockEncoderFormat_ {
+    RHI::EPixelFormat Format;
+    FStringView Name;
+    u32 NumChannels;
+    bool bAlpha;
+    float MinPSNR;
+};
+//----------------------------------------------------------------------------
+static const FBlockEncoderFormat_ GBlockEncoderFormats_[] = {
+    { RHI::EPixelFormat::BC1_RGB8_UNorm,    "BC1"_view,         3, false,   32.f },
+    { RHI::EPixelFormat::BC3_RGBA8_UNorm,   "BC3"_view,         4, true,    33.f },
+    { RHI::EPixelFormat::BC4_R8_UNorm,      "BC4"_view,         1, false,   38.f },
+    { RHI::EPixelFormat::BC4_R8_SNorm,      "BC4_SNorm"_view,   1, false,   38.f },
+    { RHI::EPixelFormat::BC5_RG8_UNorm,     "BC5"_view,         2, false,   41.f },
+    { RHI::EPixelFormat::BC5_RG8_SNorm,     "BC5_SNorm"_view,   2, false,   41.f },
+    { RHI::EPixelFormat::BC7_RGBA8_UNorm,   "BC7_Opaque"_view,  4, false,   37.f },
+    { RHI::EPixelFormat::BC7_RGBA8_UNorm,   "BC7_Alpha"_view,   4, true,    36.f },
+};
+//----------------------------------------------------------------------------
+CONSTEXPR ETextureCompressionQuality GBlockEncoderQualities_[] = {
+    ETextureCompressionQuality::Low,
+    ETextureCompressionQuality::Medium,
+    ETextureCompressionQuality::High,
+};
+//----------------------------------------------------------------------------
+static FStringView CompressionQualityName_(ETextureCompressionQuality quality) {
+    switch (quality) {
+    case ETextureCompressionQuality::Low: return "Low"_view;
+    case ETextureCompressionQuality::Medium: return "Medium"_view;
+    case ETextureCompressionQuality::High: return "High"_view;
+    }
+    AssertNotReached();
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_BlockEncoderSolid_() {
+    // solid blocks only lose the precision of the endpoints
+    for (const FBlockEncoderFormat_& fmt : GBlockEncoderFormats_) {
+        for (const ETextureCompressionQuality quality : GBlockEncoderQualities_) {
+            forrange(v, 0, 256) {
+                FBlockEncoder::FBlockTexels src, dst;
+                forrange(i, 0, FBlockEncoder::TexelsPerBlock) {
+                    src.Rgba[i][0] = static_cast<u8>(v);
+                    src.Rgba[i][1] = static_cast<u8>(255 - v);
+                    src.Rgba[i][2] = static_cast<u8>(v * 7);
+                    src.Rgba[i][3] = static_cast<u8>(fmt.bAlpha ? v * 3 : 255);
+                }
+
+                u8 block[16];
+                FBlockEncoder::EncodeBlock(fmt.Format, block, src, quality);
+                FBlockEncoder::DecodeBlock(fmt.Format, &dst, block);
+
+                forrange(i, 0, FBlockEncoder::TexelsPerBlock) {
+                    forrange(c, 0, fmt.NumChannels)
+                        AssertRelease(Abs(static_cast<int>(src.Rgba[i][c]) - dst.Rgba[i][c]) <= 1);
+                }
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_BlockEncoderImage_() {
+    // dimensions not aligned on blocks nor on tiles
+    const uint2 dimensions{ 203, 131 };
+
+    for (const FBlockEncoderFormat_& fmt : GBlockEncoderFormats_) {
+        FRandomGenerator rng;
+        VECTOR(Texture, u8) src;
+        BlockEncoderImage_(&src, dimensions, fmt.bAlpha, rng);
+
+        VECTOR(Texture, u8) blocks, decoded;
+        blocks.resize_Uninitialized(FBlockEncoder::SizeInBytes(fmt.Format, dimensions));
+        decoded.resize_Uninitialized(src.size());
+
+        float lowPSNR = 0;
+        for (const ETextureCompressionQuality quality : GBlockEncoderQualities_) {
+            AssertRelease(FBlockEncoder::EncodeImage(fmt.Format, blocks.MakeView(), dimensions, ETextureSourceFormat::RGBA8, src.MakeConstView(), quality));
+            AssertRelease(FBlockEncoder::DecodeImage(fmt.Format, decoded.MakeView(), dimensions, blocks.MakeConstView()));
+
+            const float psnr = BlockEncoderPSNR_(src.MakeConstView(), decoded.MakeConstView(), fmt.NumChannels);
+            PPE_LOG(Test_Texture, Info, "block encoder {0} {1}: {2} dB", fmt.Name, CompressionQualityName_(quality), psnr);
+
+            AssertRelease(psnr >= fmt.MinPSNR);
+            if (quality == ETextureCompressionQuality::Low)
+                lowPSNR = psnr;
+            else
+                AssertRelease(psnr >= lowPSNR - 0.05f);
+        }
+
+        // parallel tiles must give the same result than encoding block by block
+        VECTOR(Texture, u8) expected;
+        expected.resize_Uninitialized(blocks.size());
+
+        const uint2 numBlocks = FBlockEncoder::NumBlocks(dimensions);
+        const u32 blockSize = FBlockEncoder::BlockSizeInBytes(fmt.Format);
+        forrange(by, 0, numBlocks.y) {
+            forrange(bx, 0, numBlocks.x) {
+                FBlockEncoder::FBlockTexels texels;
+                forrange(i, 0, FBlockEncoder::TexelsPerBlock) {
+                    const u32 x = Min(bx * FBlockEncoder::BlockDim + i % FBlockEncoder::BlockDim, dimensions.x - 1);
+                    const u32 y = Min(by * FBlockEncoder::BlockDim + i / FBlockEncoder::BlockDim, dimensions.y - 1);
+                    FPlatformMemory::Memcpy(texels.Rgba[i], src.data() + (static_cast<size_t>(y) * dimensions.x + x) * 4, 4);
+                }
+
+                FBlockEncoder::EncodeBlock(fmt.Format, expected.data() + (static_cast<size_t>(by) * numBlocks.x + bx) * blockSize, texels, ETextureCompressionQuality::High);
+            }
+        }
+
+        AssertRelease(expected.MakeConstView().RangeEqual(blocks.MakeConstView()));
+    }
+}
+//----------------------------------------------------------------------------
+static NO_INLINE void Test_BlockEncoderLuminanceAlpha_() {
+    // BC5 only has 2 channels: RA8 luminance and alpha must land in R and G
+    const uint2 dimensions{ 13, 9 };
+
+    VECTOR(Texture, u8) src;
+    src.resize_Uninitialized(static_cast<size_t>(dimensions.x) * dimensions.y * 2);
+    forrange(y, 0, dimensions.y) {
+        forrange(x, 0, dimensions.x) {
+            u8* const texel = (src.data() + (static_cast<size_t>(y) * dimensions.x + x) * 2);
+            texel[0] = static_cast<u8>(x * 5);
+            texel[1] = static_cast<u8>(255 - y * 7);
+        }
+    }
+
+    const RHI::EPixelFormat formats[] = {
+        RHI::EPixelFormat::BC5_RG8_UNorm,
+        RHI::EPixelFormat::BC5_RG8_SNorm,
+    };
+
+    VECTOR(Texture, u8) blocks, decoded;
+    decoded.resize_Uninitialized(static_cast<size_t>(dimensions.x) * dimensions.y * 4);
+
+    for (const RHI::EPixelFormat format : formats) {
+        blocks.resize_Uninitialized(FBlockEncoder::SizeInBytes(format, dimensions));
+
+        for (const ETextureCompressionQuality quality : GBlockEncoderQualities_) {
+            AssertRelease(FBlockEncoder::EncodeImage(format, blocks.MakeView(), dimensions, ETextureSourceFormat::RA8, src.MakeConstView(), quality));
+            AssertRelease(FBlockEncoder::DecodeImage(format, decoded.MakeView(), dimensions, blocks.MakeConstView()));
+
+            forrange(i, 0, static_cast<size_t>(dimensions.x) * dimensions.y) {
+                AssertRelease(Abs(static_cast<int>(src[i * 2 + 0]) - decoded[i * 4 + 0]) <= 4);
+                AssertRelease(Abs(static_cast<int>(src[i * 2 + 1]) - decoded[i * 4 + 1]) <= 4);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+#if USE_PPE_BENCHMARK
+namespace BenchmarkResampler {
+// InputDim is the number of source texels: timings are per texel
+class FResampleBenchmark : public FBenchmark {
+public:
+    FImageResampleLayout Src, Dst;
+    FRawMemoryConst SrcData;
+    FResampleBenchmark(FStringView name, const FImageResampleLayout& src, const FRawMemoryConst& srcData, const FImageResampleLayout& dst)
+    :   FBenchmark{ name }, Src(src), Dst(dst), SrcData(srcData) {
+        InputDim = Src.Dimensions.x * Src.Dimensions.y;
+    }
+    void operator ()(FBenchmark::FState& state, EImageResampleFilter filter, const FRawMemory& dst) const {
+        const FImageResampler resampler{ Src.Dimensions, Dst.Dimensions, filter };
+        const FRawMemory dstData = dst.CutBefore(Dst.SizeInBytes());
+        for (auto _ : state) {
+            const bool succeed = resampler.Resample(Dst, dstData, Src, SrcData);
+            FBenchmark::DoNotOptimize(succeed);
+        }
+    }
+};
+class FMipChainBenchmark : public FBenchmark {
+public:
+    FImageResampleLayout Src;
+    FRawMemoryConst SrcData;
+    FMipChainBenchmark(FStringView name, const FImageResampleLayout& src, const FRawMemoryConst& srcData)
+    :   FBenchmark{ name }, Src(src), SrcData(srcData) {
+        InputDim = Src.Dimensions.x * Src.Dimensions.y;
+    }
+    void operator ()(FBenchmark::FState& state, EImageResampleFilter filter, const FRawMemory& dst) const {
+        VECTOR(Texture, float4) previous, current;
+        for (auto _ : state) {
+            // same than FTextureGeneration::GenerateSliceMipChain2D()
+            FRawMemory mips = dst;
+            uint2 dimensions = Src.Dimensions;
+            while (dimensions.x > 1 || dimensions.y > 1) {
+                const uint2 next{ Max(dimensions.x / 2, 1_u32), Max(dimensions.y / 2, 1_u32) };
+                const FImageResampler resampler{ dimensions, next, filter };
+                current.clear();
+                current.resize_Uninitialized(static_cast<size_t>(next.x) * next.y);
+                if (dimensions == Src.Dimensions)
+                    Verify(resampler.ResampleLinear(current.MakeView(), Src, SrcData));
+                else
+                    resampler.ResampleLinear(current.MakeView(), previous.MakeConstView());
+
+                FImageResampleLayout layout = Src;
+                layout.Dimensions = next;
+                Verify(FImageResampler::EncodeLinear(layout, mips.Eat(layout.SizeInBytes()), current.MakeConstView()));
+
+                std::swap(previous, current);
+                dimensions = next;
+            }
+            FBenchmark::DoNotOptimize(mips.data());
+        }
+    }
+};
+} //!namespace BenchmarkResampler
+//----------------------------------------------------------------------------
+static void Benchmark_ImageResampler_() {
+    using namespace BenchmarkResampler;
+
+    FRandomGenerator rng;
+
+    const FImageResampleLayout src = MakeLayout_(2048, 2048, ETextureSourceFormat::RGBA8, ETextureGammaSpace::sRGB);
+    VECTOR(Benchmark, u8) srcData;
+    srcData.resize_Uninitialized(src.SizeInBytes());
+    for (u8& p : srcData)
+        p = static_cast<u8>(rng.Next() & 0xFF);
+
+    const FImageResampleLayout srcFloat = MakeLayout_(2048, 2048, ETextureSourceFormat::RGBA32f);
+    VECTOR(Benchmark, u8) srcFloatData;
+    srcFloatData.resize_Uninitialized(srcFloat.SizeInBytes());
+    forrange(i, 0, srcFloatData.size() / sizeof(float))
+        reinterpret_cast<float*>(srcFloatData.data())[i] = rng.NextFloat01();
+
+    const FImageResampleLayout half = MakeLayout_(1024, 1024, ETextureSourceFormat::RGBA8, ETextureGammaSpace::sRGB);
+    const FImageResampleLayout halfFloat = MakeLayout_(1024, 1024, ETextureSourceFormat::RGBA32f);
+    const FImageResampleLayout upscale = MakeLayout_(3072, 3072, ETextureSourceFormat::RGBA8, ETextureGammaSpace::sRGB);
+
+    VECTOR(Benchmark, u8) dstData;
+    dstData.resize_Uninitialized(Max(upscale.SizeInBytes(), srcFloat.SizeInBytes()));
+
+    auto bm = FBenchmark::MakeTable("ImageResampler"_view,
+        FResampleBenchmark{ "rgba8_srgb_2048_to_1024"_view, src, srcData.MakeConstView(), half },
+        FResampleBenchmark{ "rgba32f_2048_to_1024"_view, srcFloat, srcFloatData.MakeConstView(), halfFloat },
+        FResampleBenchmark{ "rgba8_srgb_2048_to_3072"_view, src, srcData.MakeConstView(), upscale },
+        FMipChainBenchmark{ "rgba8_srgb_mip_chain"_view, src, srcData.MakeConstView() } );
+
+    for (const EImageResampleFilter filter : GResampleFilters_)
+        bm.Run(ResampleFilterName_(filter), filter, dstData.MakeView());
+
+    FBenchmark::FlushAndLog(bm);
+}
+//----------------------------------------------------------------------------
+namespace BenchmarkBlockEncoder {
+// InputDim is the number of source texels: timings are per texel
+class FBlockEncoderBenchmark : public FBenchmark {
+public:
+    FBlockEncoderFormat_ Format;
+    uint2 Dimensions;
+    FRawMemoryConst SrcData;
+    FBlockEncoderBenchmark(const FBlockEncoderFormat_& format, const uint2& dimensions, const FRawMemoryConst& srcData)
+    :   FBenchmark{ format.Name }, Format(format), Dimensions(dimensions), SrcData(srcData) {
+        InputDim = Dimensions.x * Dimensions.y;
+    }
+    void operator ()(FBenchmark::FState& state, ETextureCompressionQuality quality, const FRawMemory& dst) const {
+        const FRawMemory blocks = dst.CutBefore(FBlockEncoder::SizeInBytes(Format.Format, Dimensions));
+        for (auto _ : state) {
+            const bool succeed = FBlockEncoder::EncodeImage(Format.Format, blocks, Dimensions, ETextureSourceFormat::RGBA8, SrcData, quality);
+            FBenchmark::DoNotOptimize(succeed);
+        }
+    }
+};
+} //!namespace BenchmarkBlockEncoder
+//----------------------------------------------------------------------------
+static void Benchmark_BlockEncoder_() {
+    using namespace BenchmarkBlockEncoder;
+
+    const uint2 dimensions{ 1024, 1024 };
+
+    FRandomGenerator rng;
+    VECTOR(Texture, u8) opaque, alpha;
+    BlockEncoderImage_(&opaque, dimensions, false, rng);
+    BlockEncoderImage_(&alpha, dimensions, true, rng);
+
+    VECTOR(Benchmark, u8) dstData;
+    dstData.resize_Uninitialized(FBlockEncoder::SizeInBytes(RHI::EPixelFormat::BC7_RGBA8_UNorm, dimensions));
+
+    VECTOR(Benchmark, u8) decoded;
+    decoded.resize_Uninitialized(opaque.size());
+
+    // quality of the benchmarked encodings, to weigh against the timings
+    for (const FBlockEncoderFormat_& fmt : GBlockEncoderFormats_) {
+        const FRawMemoryConst src = (fmt.bAlpha ? alpha : opaque).MakeConstView();
+        for (const ETextureCompressionQuality quality : GBlockEncoderQualities_) {
+            Verify(FBlockEncoder::EncodeImage(fmt.Format, dstData.MakeView(), dimensions, ETextureSourceFormat::RGBA8, src, quality));
+            Verify(FBlockEncoder::DecodeImage(fmt.Format, decoded.MakeView(), dimensions, dstData.MakeConstView()));
+            PPE_LOG(Test_Texture, Info, "block encoder {0} {1}: {2} dB", fmt.Name, CompressionQualityName_(quality),
+                BlockEncoderPSNR_(src, decoded.MakeConstView(), fmt.NumChannels));
+        }
+    }
+
+    auto bm = FBenchmark::MakeTable("BlockEncoder"_view,
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[0], dimensions, opaque.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[1], dimensions, alpha.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[2], dimensions, opaque.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[3], dimensions, opaque.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[4], dimensions, opaque.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[5], dimensions, opaque.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[6], dimensions, opaque.MakeConstView() },
+        FBlockEncoderBenchmark{ GBlockEncoderFormats_[7], dimensions, alpha.MakeConstView() } );
+
+    for (const ETextureCompressionQuality quality : GBlockEncoderQualities_)
+        bm.Run(CompressionQualityName_(quality), quality, dstData.MakeView());
+
+    FBenchmark::FlushAndLog(bm);
+}
+#endif //!USE_PPE_BENCHMARK
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void Test_Texture() {
+    PPE_DEBUG_NAMEDSCOPE("Test_Texture");
+
+    PPE_LOG(Test_Texture, Emphasis, "starting texture tests ...");
+
+    Test_ResampleConstant_();
+    Test_ResampleBox_();
+    Test_ResampleCodecs_();
+    Test_BlockEncoderSolid_();
+    Test_BlockEncoderImage_();
+    Test_BlockEncoderLuminanceAlpha_();
+
+#if USE_PPE_BENCHMARK
+    Benchmark_ImageResampler_();
+    Benchmark_BlockEncoder_();
+#endif
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace Test
+} //!namespace PPE
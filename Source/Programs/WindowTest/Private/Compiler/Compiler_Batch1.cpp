@@ -0,0 +1,156 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Test_Includes.h"
+#include "Test_Uniforms.h"
+
+#include "Vulkan/Pipeline/VulkanPipelineCompiler.h"
+
+#include "IO/FormatHelpers.h"
+#include "Time/Timepoint.h"
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+static FString BatchFragmentVariant_(size_t index) {
+    FStringBuilder sb;
+    sb << R"#(
+#version 450 core
+#pragma shader_stage(fragment)
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding=0) uniform sampler2D  un_Texture;
+
+layout(location=0) in  vec2	in_Texcoord;
+
+layout(location=0) out vec4	 out_Color;
+
+const float tint = )#" << (index + 1) << R"#(.0f;
+
+void main() {
+	out_Color = texture(un_Texture, in_Texcoord) * tint;
+}
+)#";
+    return FString{ sb.Written() };
+}
+//----------------------------------------------------------------------------
+static void MakeBatchMaterials_(TMemoryView<RHI::FGraphicsPipelineDesc> materials, size_t numFragmentVariants) {
+    using namespace PPE::RHI;
+
+    forrange(i, 0, materials.size()) {
+        // all materials share the same vertex shader
+        materials[i].AddShader(EShaderType::Vertex, EShaderLangFormat::GLSL_450, "main", R"#(
+#version 450 core
+#pragma shader_stage(vertex)
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location=0) in  vec3	in_Position;
+layout(location=2) in  vec2	in_Texcoord;
+
+layout(location=0) out vec2	out_Texcoord;
+
+void main() {
+	gl_Position	 = vec4( in_Position, 1.0 );
+	out_Texcoord = in_Texcoord;
+}
+)#"
+ARGS_IF_RHIDEBUG("Compiler_Batch1_VS"));
+
+        materials[i].AddShader(EShaderType::Fragment, EShaderLangFormat::GLSL_450, "main",
+            BatchFragmentVariant_(i % numFragmentVariants)
+            ARGS_IF_RHIDEBUG("Compiler_Batch1_PS"));
+    }
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+bool Compiler_Batch1_(FWindowTestApp& app) {
+    using namespace PPE::RHI;
+
+    IRHIService& rhi = app.RHI();
+
+    const SPipelineCompiler compiler = rhi.Compiler(EShaderLangFormat::GLSL_450);
+    PPE_LOG_CHECK(WindowTest, !!compiler);
+
+    auto* const vulkanCompiler = checked_cast<FVulkanPipelineCompiler*>(compiler.get());
+    PPE_LOG_CHECK(WindowTest, !!vulkanCompiler);
+
+    CONSTEXPR size_t numMaterials = 64;
+    CONSTEXPR size_t numFragmentVariants = 8;
+    CONSTEXPR size_t numUniqueStages = (1/* vertex */ + numFragmentVariants);
+
+    VECTOR(RHIPipeline, FGraphicsPipelineDesc) sequential, batch;
+    sequential.resize(numMaterials);
+    batch.resize(numMaterials);
+
+    MakeBatchMaterials_(sequential.MakeView(), numFragmentVariants);
+    MakeBatchMaterials_(batch.MakeView(), numFragmentVariants);
+
+    // benchmark without the persistent SPIRV cache, or both passes would only be reading from disk
+    const FDirpath spirvCacheDirectory = vulkanCompiler->SpirvCacheDirectory();
+    vulkanCompiler->SetSpirvCacheDirectory(FDirpath{});
+
+    vulkanCompiler->ReleaseSpirvCache();
+    vulkanCompiler->ResetSpirvCacheStatistics();
+
+    const FTimepoint sequentialStartedAt = FTimepoint::Now();
+    for (FGraphicsPipelineDesc& ppln : sequential)
+        PPE_LOG_CHECK(WindowTest, compiler->Compile(ppln, EShaderLangFormat::SPIRV_100));
+    const FTimespan sequentialDuration = FTimepoint::ElapsedSince(sequentialStartedAt);
+
+    vulkanCompiler->ReleaseSpirvCache();
+    vulkanCompiler->ResetSpirvCacheStatistics();
+
+    const FTimepoint batchStartedAt = FTimepoint::Now();
+    PPE_LOG_CHECK(WindowTest, compiler->CompileBatch(batch.MakeView(), EShaderLangFormat::SPIRV_100));
+    const FTimespan batchDuration = FTimepoint::ElapsedSince(batchStartedAt);
+
+    // each unique stage was compiled exactly once
+    const FVulkanSpirvCacheStatistics batchStats = vulkanCompiler->SpirvCacheStatistics();
+    PPE_LOG_CHECK(WindowTest, batchStats.NumLookups() == numUniqueStages);
+    PPE_LOG_CHECK(WindowTest, batchStats.Misses == numUniqueStages);
+
+    vulkanCompiler->SetSpirvCacheDirectory(spirvCacheDirectory);
+
+    forrange(i, 0, numMaterials) {
+        PPE_LOG_CHECK(WindowTest, sequential[i].Shaders.size() == batch[i].Shaders.size());
+
+        for (const auto& sh : sequential[i].Shaders) {
+            const auto* const batchShader = batch[i].Shaders.GetIFP(sh.first);
+            PPE_LOG_CHECK(WindowTest, !!batchShader);
+
+            const auto* const sequentialSpirv = sh.second.Find(EShaderLangFormat::SPIRV_100);
+            const auto* const batchSpirv = batchShader->Find(EShaderLangFormat::SPIRV_100);
+            PPE_LOG_CHECK(WindowTest, sequentialSpirv and batchSpirv);
+
+            PPE_LOG_CHECK(WindowTest, std::get<PShaderBinaryData>(*sequentialSpirv)->Fingerprint() ==
+                                      std::get<PShaderBinaryData>(*batchSpirv)->Fingerprint() );
+        }
+
+        PPE_LOG_CHECK(WindowTest, TestVertexInput(batch[i], "in_Position"_vertex, EVertexFormat::Float3, 0));
+        PPE_LOG_CHECK(WindowTest, TestVertexInput(batch[i], "in_Texcoord"_vertex, EVertexFormat::Float2, 2));
+        PPE_LOG_CHECK(WindowTest, TestFragmentOutput(batch[i], EFragmentOutput::Float4, 0));
+
+        // shared stages must not share their descriptor sets between pipelines
+        FDescriptorSet* const ds = batch[i].DescriptorSet("0"_descriptorset);
+        PPE_LOG_CHECK(WindowTest, !!ds);
+        PPE_LOG_CHECK(WindowTest, TestTextureUniform(*ds, "un_Texture"_uniform, EImageSampler_Float2D, /*binding*/0, EShaderStages::Fragment, /*arraySize*/1 ));
+
+        if (i > 0)
+            PPE_LOG_CHECK(WindowTest, batch[i - 1].DescriptorSet("0"_descriptorset)->Uniforms != ds->Uniforms);
+    }
+
+    PPE_LOG(WindowTest, Info, "compiled {0} materials: sequential = {1}, batch = {2} ({3} unique stages), speed-up = x{4:f2}",
+        numMaterials,
+        Fmt::DurationInMs(sequentialDuration),
+        Fmt::DurationInMs(batchDuration), numUniqueStages,
+        (*sequentialDuration / Max(*batchDuration, 1e-3)) );
+
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
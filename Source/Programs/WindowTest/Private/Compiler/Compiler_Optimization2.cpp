@@ -0,0 +1,101 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Test_Includes.h"
+#include "Test_Uniforms.h"
+
+#include "Vulkan/Pipeline/VulkanSpirvOptimizer.h"
+
+#include "IO/StringBuilder.h"
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+bool Compiler_Optimization2_(FWindowTestApp& app) {
+    using namespace PPE::RHI;
+
+    IRHIService& rhi = app.RHI();
+
+    FComputePipelineDesc ppln;
+    ppln.AddShader(EShaderLangFormat::VKSL_100, "main", R"#(
+#extension GL_ARB_shading_language_420pack : enable
+
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout (constant_id = 0) const int  NUM_ITERATIONS = 4;
+layout (constant_id = 1) const bool USE_COSINE = true;
+
+layout(binding=0, rgba8) writeonly uniform image2D  un_OutImage;
+
+float Wave(float x) {
+	return (USE_COSINE ? cos(x) : sin(x));
+}
+
+void main ()
+{
+	ivec2	coord	= ivec2(gl_GlobalInvocationID.xy);
+	float	accum	= 0.0f;
+
+	for (int i = 0; i < NUM_ITERATIONS; ++i)
+		accum += Wave(float(coord.x * (i + 1) + coord.y));
+
+	imageStore( un_OutImage, coord, vec4(accum / float(NUM_ITERATIONS), 0.0, 0.0, 1.0) );
+}
+)#"
+ARGS_IF_RHIDEBUG("Compiler_Optimization2_CS"));
+
+    const SPipelineCompiler compiler = rhi.Compiler(EShaderLangFormat::GLSL_450);
+    PPE_LOG_CHECK(WindowTest, !!compiler);
+
+    const EShaderCompilationFlags flags = compiler->CompilationFlags();
+    compiler->SetCompilationFlags(EShaderCompilationFlags::GenerateDebug);
+
+    PPE_LOG_CHECK(WindowTest, compiler->Compile(ppln, EShaderLangFormat::SPIRV_100));
+
+    compiler->SetCompilationFlags(flags);
+
+    PPE_LOG_CHECK(WindowTest, TestSpecializationConstant(ppln.Shader, "NUM_ITERATIONS"_specialization, 0));
+    PPE_LOG_CHECK(WindowTest, TestSpecializationConstant(ppln.Shader, "USE_COSINE"_specialization, 1));
+
+    // shipping permutation: everything is known offline
+    FVulkanSpirvOptimizerOptions options;
+    options.Recipe = ESpirvOptimization::Performance;
+    options.StripDebugInfo = true;
+    options.StripReflection = true;
+    PPE_LOG_CHECK(WindowTest, options.Freeze(ppln.Shader.Specializations, "NUM_ITERATIONS"_specialization, 2));
+    PPE_LOG_CHECK(WindowTest, options.Freeze(ppln.Shader.Specializations, "USE_COSINE"_specialization, 0));
+    PPE_LOG_CHECK(WindowTest, not options.Freeze(ppln.Shader.Specializations, "UNKNOWN"_specialization, 0));
+
+    const FVulkanSpirvOptimizer optimizer{ options };
+    FVulkanSpirvOptimizationReport report{ optimizer };
+
+    FComputePipelineDesc optimized{ ppln };
+    PPE_LOG_CHECK(WindowTest, report.Optimize("Compiler_Optimization2_CS"_view, &optimized.Shader, compiler->DefaultLogger()));
+    PPE_LOG_CHECK(WindowTest, report.Entries().size() == 1);
+
+    const FVulkanSpirvOptimizationReport::FEntry& entry = report.Entries().front();
+    PPE_LOG_CHECK(WindowTest, entry.Before.NumSpecConstants >= 2);
+    PPE_LOG_CHECK(WindowTest, entry.After.NumSpecConstants + 2 <= entry.Before.NumSpecConstants);
+    PPE_LOG_CHECK(WindowTest, entry.After.SizeInBytes < entry.Before.SizeInBytes);
+
+    const FShaderDataVariant* const it = optimized.Shader.Find(EShaderLangFormat::SPIRV_100);
+    PPE_LOG_CHECK(WindowTest, !!it);
+
+    const PShaderBinaryData* const pBinary = std::get_if<PShaderBinaryData>(it);
+    PPE_LOG_CHECK(WindowTest, !!pBinary && pBinary->valid());
+
+    FVulkanSpirvStatistics stats;
+    PPE_LOG_CHECK(WindowTest, FVulkanSpirvStatistics::Parse(&stats, (*pBinary)->Data()->MakeConstView()));
+    PPE_LOG_CHECK(WindowTest, stats.SizeInBytes == entry.After.SizeInBytes);
+    PPE_LOG_CHECK(WindowTest, (*pBinary)->Fingerprint() != std::get<PShaderBinaryData>(*ppln.Shader.Find(EShaderLangFormat::SPIRV_100))->Fingerprint());
+
+    FStringBuilder sb;
+    report.Dump(sb);
+    PPE_LOG(WindowTest, Info, "SPIRV optimization report:\n{0}", sb.Written());
+
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,122 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Test_Includes.h"
+#include "Test_Uniforms.h"
+
+#include "Vulkan/Pipeline/VulkanPipelineCompiler.h"
+
+#include "IO/FormatHelpers.h"
+#include "Thread/Task/TaskHelpers.h"
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+static FString SpirvCacheVariant_(size_t index) {
+    FStringBuilder sb;
+    sb << R"#(
+#pragma shader_stage(compute)
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (local_size_x=8, local_size_y=8, local_size_z=1) in;
+
+layout(binding=0, rgba8) writeonly uniform image2D  un_OutImage;
+
+layout(binding=1, std140) readonly buffer un_SSBO
+{
+    vec4 ssb_data;
+};
+
+const float uv_scale = )#" << (index + 1) << R"#(.0f;
+
+void main ()
+{
+    vec2 uv = vec2(gl_GlobalInvocationID.xy) / vec2((gl_WorkGroupSize * gl_NumWorkGroups).xy) * uv_scale;
+
+    imageStore( un_OutImage, ivec2(gl_GlobalInvocationID.xy), vec4(sin(uv.x), cos(uv.y), 1.0, ssb_data.r) );
+}
+)#";
+    return FString{ sb.Written() };
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+bool Compiler_SpirvCache1_(FWindowTestApp& app) {
+    using namespace PPE::RHI;
+
+    IRHIService& rhi = app.RHI();
+
+    const SPipelineCompiler compiler = rhi.Compiler(EShaderLangFormat::GLSL_450);
+    PPE_LOG_CHECK(WindowTest, !!compiler);
+
+    auto* const vulkanCompiler = checked_cast<FVulkanPipelineCompiler*>(compiler.get());
+    PPE_LOG_CHECK(WindowTest, !!vulkanCompiler);
+
+    CONSTEXPR size_t numVariants = 64;
+
+    VECTOR(RHIPipeline, FComputePipelineDesc) cold, warm;
+    cold.resize(numVariants);
+    warm.resize(numVariants);
+
+    forrange(i, 0, numVariants) {
+        cold[i].AddShader(EShaderLangFormat::GLSL_450, "main", SpirvCacheVariant_(i) ARGS_IF_RHIDEBUG("Compiler_SpirvCache1_CS"));
+        warm[i].AddShader(EShaderLangFormat::GLSL_450, "main", SpirvCacheVariant_(i) ARGS_IF_RHIDEBUG("Compiler_SpirvCache1_CS"));
+    }
+
+    auto compileAll = [&compiler](TMemoryView<FComputePipelineDesc> pipelines) {
+        std::atomic<size_t> numFailures{ 0 };
+        ParallelFor(0, pipelines.size(), [&](size_t i) {
+            if (not compiler->Compile(pipelines[i], EShaderLangFormat::SPIRV_100))
+                numFailures.fetch_add(1, std::memory_order_relaxed);
+        });
+        return (0 == numFailures.load(std::memory_order_relaxed));
+    };
+
+    // memo table is cleared, but the disk cache can still serve entries from a previous run
+    vulkanCompiler->ReleaseSpirvCache();
+    vulkanCompiler->ResetSpirvCacheStatistics();
+
+    PPE_LOG_CHECK(WindowTest, compileAll(cold.MakeView()));
+    const FVulkanSpirvCacheStatistics coldStats = vulkanCompiler->SpirvCacheStatistics();
+    PPE_LOG_CHECK(WindowTest, coldStats.NumLookups() == numVariants);
+    PPE_LOG_CHECK(WindowTest, coldStats.MemoryHits == 0);
+
+    vulkanCompiler->ResetSpirvCacheStatistics();
+
+    PPE_LOG_CHECK(WindowTest, compileAll(warm.MakeView()));
+    const FVulkanSpirvCacheStatistics warmStats = vulkanCompiler->SpirvCacheStatistics();
+    PPE_LOG_CHECK(WindowTest, warmStats.MemoryHits == numVariants);
+    PPE_LOG_CHECK(WindowTest, warmStats.Misses == 0);
+
+    forrange(i, 0, numVariants) {
+        const auto* const coldSpirv = cold[i].Shader.Find(EShaderLangFormat::SPIRV_100);
+        const auto* const warmSpirv = warm[i].Shader.Find(EShaderLangFormat::SPIRV_100);
+        PPE_LOG_CHECK(WindowTest, coldSpirv and warmSpirv);
+
+        const PShaderBinaryData& coldData = std::get<PShaderBinaryData>(*coldSpirv);
+        const PShaderBinaryData& warmData = std::get<PShaderBinaryData>(*warmSpirv);
+        PPE_LOG_CHECK(WindowTest, coldData->Fingerprint() == warmData->Fingerprint());
+        PPE_LOG_CHECK(WindowTest, coldData->Data()->Equals(*warmData->Data()));
+
+        PPE_LOG_CHECK(WindowTest, cold[i].DefaultLocalGroupSize == warm[i].DefaultLocalGroupSize);
+
+        FDescriptorSet* const ds = warm[i].DescriptorSet("0"_descriptorset);
+        PPE_LOG_CHECK(WindowTest, !!ds);
+        PPE_LOG_CHECK(WindowTest, TestImageUniform(*ds, "un_OutImage"_uniform, EImageSampler_FromPixelFormat(EImageSampler_Float2D, EPixelFormat::RGBA8_UNorm), EShaderAccess::WriteOnly, 0, EShaderStages::Compute));
+        PPE_LOG_CHECK(WindowTest, TestStorageBuffer(*ds, "un_SSBO"_uniform, 16_b, 0_b, EShaderAccess::ReadOnly, 1, EShaderStages::Compute));
+    }
+
+    PPE_LOG(WindowTest, Info, "SPIRV cache: cold = {0} ({1} from disk, {2:f2}% hit rate), warm = {3} ({4:f2}% hit rate)",
+        Fmt::DurationInMs(coldStats.CompilationTime + coldStats.LookupTime),
+        coldStats.DiskHits, coldStats.HitRate() * 100,
+        Fmt::DurationInMs(warmStats.CompilationTime + warmStats.LookupTime),
+        warmStats.HitRate() * 100 );
+
+    return true;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
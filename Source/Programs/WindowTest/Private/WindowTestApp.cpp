@@ -34,10 +34,12 @@ struct FUnitTestFunc_ {
     _Macro(Compiler_Annotation2_) \
     _Macro(Compiler_Annotation3_) \
     _Macro(Compiler_Annotation4_) \
+    _Macro(Compiler_Batch1_) \
     _Macro(Compiler_ComputeLocalSize1_) \
     _Macro(Compiler_MeshShader1_) \
     _Macro(Compiler_MRT1_) \
     _Macro(Compiler_Optimization1_) \
+    _Macro(Compiler_Optimization2_) \
     _Macro(Compiler_PushConst1_) \
     _Macro(Compiler_PushConst2_) \
     _Macro(Compiler_PushConst3_) \
@@ -48,6 +50,7 @@ struct FUnitTestFunc_ {
     _Macro(Compiler_Reflection4_) \
     _Macro(Compiler_Reflection5_) \
     _Macro(Compiler_ShaderTrace1_) \
+    _Macro(Compiler_SpirvCache1_) \
     _Macro(Compiler_UniformArray1_) \
     _Macro(Compiler_UniformArray2_) \
     /* compute */ \
@@ -25,6 +25,7 @@
 #include "HAL/Linux/LinuxPlatformTime.h"
 
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <semaphore.h>
 #include <signal.h>
@@ -547,8 +548,10 @@ bool FLinuxPlatformProcess::CreatePipe(FPipeHandle* pRead, FPipeHandle* pWrite,
 
     Unused(shareRead);
 
+    // both ends are closed on exec: spawned processes only inherit the ends duplicated on their std handles,
+    // otherwise every child would keep the write end of its own stdin (and of its siblings) alive
     int pipeFd[2];
-    if (-1 == ::pipe(pipeFd)) {
+    if (-1 == ::pipe2(pipeFd, O_CLOEXEC)) {
         const FErrno thisErrno;
         PPE_LOG(HAL, Error, "failed to create pipe with errno: {0}",
             thisErrno );
@@ -602,9 +605,24 @@ size_t FLinuxPlatformProcess::WritePipe(FPipeHandle write, const FRawMemoryConst
     if (buffer.empty())
         return 0;
 
-    // Write to pipe
+    // Write to pipe, without letting SIGPIPE kill the process when the reader is gone
+    sigset_t sigpipe, oldmask;
+    ::sigemptyset(&sigpipe);
+    ::sigaddset(&sigpipe, SIGPIPE);
+    ::pthread_sigmask(SIG_BLOCK, &sigpipe, &oldmask);
+
     int fd = PipeFD_(write);
-    return ::write(fd, buffer.data(), buffer.SizeInBytes());
+    const ::ssize_t written = ::write(fd, buffer.data(), buffer.SizeInBytes());
+
+    if (written < 0 && EPIPE == errno) {
+        const ::timespec noWait{ 0, 0 };
+        while (::sigtimedwait(&sigpipe, nullptr, &noWait) > 0); // consumes the pending signal
+    }
+
+    ::pthread_sigmask(SIG_SETMASK, &oldmask, nullptr);
+
+    // same as windows: 0 on error
+    return (written > 0 ? checked_cast<size_t>(written) : 0);
 }
 //----------------------------------------------------------------------------
 void FLinuxPlatformProcess::ClosePipe(FPipeHandle read, FPipeHandle write) {
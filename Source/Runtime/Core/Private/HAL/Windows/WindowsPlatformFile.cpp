@@ -325,6 +325,7 @@ bool FWindowsPlatformFile::Stat(FStat* pstat, const char_type* filename) {
     pstat->UID = checked_cast<u16>(fs.st_uid);
     pstat->GID = checked_cast<u16>(fs.st_gid);
     pstat->SizeInBytes = checked_cast<u64>(fs.st_size);
+    pstat->Inode = checked_cast<u64>(fs.st_ino); // always 0 on NTFS
     pstat->CreatedAt.SetValue(fs.st_ctime);
     pstat->LastAccess.SetValue(fs.st_atime);
     pstat->LastModified.SetValue(fs.st_mtime);
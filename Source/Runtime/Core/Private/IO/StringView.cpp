@@ -3,81 +3,516 @@
 #include "IO/StringView.h"
 
 #include "Allocator/Alloca.h"
+#include "HAL/PlatformMaths.h"
 #include "HAL/PlatformMemory.h"
 #include "IO/StaticString.h"
 #include "IO/String.h"
 #include "IO/TextWriter.h"
 #include "HAL/PlatformString.h"
+#include "Maths/SSEHelpers.h"
 #include "Memory/HashFunctions.h"
 
 #include "double-conversion-external.h"
 
+#define USE_PPE_SIMD_STRINGVIEW (USE_PPE_SSE2) // turn to 0 to disable SIMD optimizations %_NOCOMMIT%
+
 namespace PPE {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 namespace {
 //----------------------------------------------------------------------------
-template <typename _Char, typename _Pred>
-static bool SplitIf_(TBasicStringView<_Char>& str, TBasicStringView<_Char>& slice, const _Pred& pred) {
-    if (str.empty())
-        return false;
+// SIMD string kernels
+//----------------------------------------------------------------------------
+// All kernels work on raw [first, last) ranges and return pointers, the
+// public API below converts back to iterators. Every kernel handles the tail
+// with an overlapping load of the last block (masking out lanes already
+// visited) and falls back to a scalar loop when the input is shorter than one
+// SSE register.
+//----------------------------------------------------------------------------
+#if USE_PPE_SIMD_STRINGVIEW
+//----------------------------------------------------------------------------
+template <size_t _CharSize>
+struct TStringSIMD_;
+template <>
+struct TStringSIMD_<1> {
+    static FORCE_INLINE m128i_t Broadcast128(u32 ch) NOEXCEPT { return ::_mm_set1_epi8(static_cast<char>(ch)); }
+    static FORCE_INLINE m128i_t CmpEq(m128i_t a, m128i_t b) NOEXCEPT { return ::_mm_cmpeq_epi8(a, b); }
+#if USE_PPE_AVX2
+    static FORCE_INLINE m256i_t Broadcast256(u32 ch) NOEXCEPT { return ::_mm256_set1_epi8(static_cast<char>(ch)); }
+    static FORCE_INLINE m256i_t CmpEq(m256i_t a, m256i_t b) NOEXCEPT { return ::_mm256_cmpeq_epi8(a, b); }
+#endif
+};
+template <>
+struct TStringSIMD_<2> {
+    static FORCE_INLINE m128i_t Broadcast128(u32 ch) NOEXCEPT { return ::_mm_set1_epi16(static_cast<short>(ch)); }
+    static FORCE_INLINE m128i_t CmpEq(m128i_t a, m128i_t b) NOEXCEPT { return ::_mm_cmpeq_epi16(a, b); }
+#if USE_PPE_AVX2
+    static FORCE_INLINE m256i_t Broadcast256(u32 ch) NOEXCEPT { return ::_mm256_set1_epi16(static_cast<short>(ch)); }
+    static FORCE_INLINE m256i_t CmpEq(m256i_t a, m256i_t b) NOEXCEPT { return ::_mm256_cmpeq_epi16(a, b); }
+#endif
+};
+template <>
+struct TStringSIMD_<4> {
+    static FORCE_INLINE m128i_t Broadcast128(u32 ch) NOEXCEPT { return ::_mm_set1_epi32(static_cast<int>(ch)); }
+    static FORCE_INLINE m128i_t CmpEq(m128i_t a, m128i_t b) NOEXCEPT { return ::_mm_cmpeq_epi32(a, b); }
+#if USE_PPE_AVX2
+    static FORCE_INLINE m256i_t Broadcast256(u32 ch) NOEXCEPT { return ::_mm256_set1_epi32(static_cast<int>(ch)); }
+    static FORCE_INLINE m256i_t CmpEq(m256i_t a, m256i_t b) NOEXCEPT { return ::_mm256_cmpeq_epi32(a, b); }
+#endif
+};
+//----------------------------------------------------------------------------
+// Matchers expose the same predicate in scalar and vector forms:
+//  - bool operator ()(_Char) for short inputs,
+//  - m128i_t/m256i_t operator ()(block) returning all ones for matching lanes.
+// _Not inverts the predicate, used for Eat*() and Trim*().
+//----------------------------------------------------------------------------
+template <typename _Char, bool _Not = false>
+struct TMatchChar_ {
+    using simd = TStringSIMD_<sizeof(_Char)>;
 
-    const auto it = str.FindIf(pred);
+    _Char Needle;
+    m128i_t Needle128;
+#if USE_PPE_AVX2
+    m256i_t Needle256;
+#endif
 
-    if (str.end() == it) {
-        slice = str;
-        str = TBasicStringView<_Char>();
+    explicit TMatchChar_(_Char ch) NOEXCEPT
+    :   Needle(ch)
+    ,   Needle128(simd::Broadcast128(static_cast<u32>(ch)))
+#if USE_PPE_AVX2
+    ,   Needle256(simd::Broadcast256(static_cast<u32>(ch)))
+#endif
+    {}
+
+    FORCE_INLINE bool operator ()(_Char ch) const NOEXCEPT { return ((Needle == ch) != _Not); }
+    FORCE_INLINE m128i_t operator ()(m128i_t block) const NOEXCEPT {
+        const m128i_t m = simd::CmpEq(block, Needle128);
+        IF_CONSTEXPR(_Not)
+            return ::_mm_xor_si128(m, m128i_epi8_set_true());
+        else
+            return m;
     }
-    else {
-        Assert_NoAssume(pred(*it));
-        slice = str.CutBefore(it);
-        str = str.CutStartingAt(it + 1);
+#if USE_PPE_AVX2
+    FORCE_INLINE m256i_t operator ()(m256i_t block) const NOEXCEPT {
+        const m256i_t m = simd::CmpEq(block, Needle256);
+        IF_CONSTEXPR(_Not)
+            return ::_mm256_xor_si256(m, m256i_epi8_set_true());
+        else
+            return m;
     }
+#endif
+};
+//----------------------------------------------------------------------------
+template <typename _Char, bool _Not = false>
+struct TMatchAnyOf_ {
+    using simd = TStringSIMD_<sizeof(_Char)>;
 
-    return true;
+    STATIC_CONST_INTEGRAL(size_t, Capacity, 8); // past 8 characters the scalar lookup wins
+
+    TBasicStringView<_Char> Set;
+    m128i_t Set128[Capacity];
+#if USE_PPE_AVX2
+    m256i_t Set256[Capacity];
+#endif
+
+    explicit TMatchAnyOf_(const TBasicStringView<_Char>& set) NOEXCEPT
+    :   Set(set) {
+        Assert(not Set.empty());
+        Assert(Set.size() <= Capacity);
+        forrange(i, 0, Set.size()) {
+            Set128[i] = simd::Broadcast128(static_cast<u32>(Set[i]));
+#if USE_PPE_AVX2
+            Set256[i] = simd::Broadcast256(static_cast<u32>(Set[i]));
+#endif
+        }
+    }
+
+    FORCE_INLINE bool operator ()(_Char ch) const NOEXCEPT { return (Set.Contains(ch) != _Not); }
+    FORCE_INLINE m128i_t operator ()(m128i_t block) const NOEXCEPT {
+        m128i_t m = simd::CmpEq(block, Set128[0]);
+        forrange(i, 1, Set.size())
+            m = ::_mm_or_si128(m, simd::CmpEq(block, Set128[i]));
+        IF_CONSTEXPR(_Not)
+            return ::_mm_xor_si128(m, m128i_epi8_set_true());
+        else
+            return m;
+    }
+#if USE_PPE_AVX2
+    FORCE_INLINE m256i_t operator ()(m256i_t block) const NOEXCEPT {
+        m256i_t m = simd::CmpEq(block, Set256[0]);
+        forrange(i, 1, Set.size())
+            m = ::_mm256_or_si256(m, simd::CmpEq(block, Set256[i]));
+        IF_CONSTEXPR(_Not)
+            return ::_mm256_xor_si256(m, m256i_epi8_set_true());
+        else
+            return m;
+    }
+#endif
+};
+//----------------------------------------------------------------------------
+// Byte masks returned by movemask() have sizeof(_Char) bits per character
+template <typename _Char>
+FORCE_INLINE size_t FirstLaneInMask_(u32 mask) NOEXCEPT {
+    Assert(mask);
+    return (FPlatformMaths::tzcnt(mask) / sizeof(_Char));
+}
+template <typename _Char>
+FORCE_INLINE size_t LastLaneInMask_(u32 mask) NOEXCEPT {
+    Assert(mask);
+    return ((31u - FPlatformMaths::lzcnt(mask)) / sizeof(_Char));
 }
 //----------------------------------------------------------------------------
-template <typename _Char, typename _Pred>
-static bool SplitIfR_(TBasicStringView<_Char>& str, TBasicStringView<_Char>& slice, _Pred&& pred) {
-    if (str.empty())
-        return false;
+template <typename _Char, typename _Matcher>
+static const _Char* FindFirst_SIMD_(const _Char* first, const _Char* last, const _Matcher& match) NOEXCEPT {
+    const _Char* it = first;
 
-    const auto it = str.FindIfR(pred);
+#if USE_PPE_AVX2
+    constexpr size_t Lanes256 = (sizeof(m256i_t) / sizeof(_Char));
+    if (static_cast<size_t>(last - first) >= Lanes256) {
+        for (; it + Lanes256 <= last; it += Lanes256) {
+            if (const u32 mask = m256i_epi8_movemask(match(m256i_epi8_load_unaligned(it))))
+                return (it + FirstLaneInMask_<_Char>(mask));
+        }
+        if (it == last)
+            return last;
+
+        // overlapping load for the tail, ignore lanes already visited
+        const _Char* const tail = (last - Lanes256);
+        u32 mask = m256i_epi8_movemask(match(m256i_epi8_load_unaligned(tail)));
+        mask &= (UINT32_MAX << ((it - tail) * sizeof(_Char)));
+        return (mask ? tail + FirstLaneInMask_<_Char>(mask) : last);
+    }
+#endif
 
-    if (str.rend() == it) {
+    constexpr size_t Lanes128 = (sizeof(m128i_t) / sizeof(_Char));
+    if (static_cast<size_t>(last - first) >= Lanes128) {
+        for (; it + Lanes128 <= last; it += Lanes128) {
+            if (const u32 mask = m128i_epi8_movemask(match(m128i_epi8_load_unaligned(it))))
+                return (it + FirstLaneInMask_<_Char>(mask));
+        }
+        if (it == last)
+            return last;
+
+        const _Char* const tail = (last - Lanes128);
+        u32 mask = m128i_epi8_movemask(match(m128i_epi8_load_unaligned(tail)));
+        mask &= (UINT32_MAX << ((it - tail) * sizeof(_Char)));
+        return (mask ? tail + FirstLaneInMask_<_Char>(mask) : last);
+    }
+
+    for (; it != last && not match(*it); ++it);
+    return it;
+}
+//----------------------------------------------------------------------------
+// Returns nullptr when no character matches
+template <typename _Char, typename _Matcher>
+static const _Char* FindLast_SIMD_(const _Char* first, const _Char* last, const _Matcher& match) NOEXCEPT {
+    const _Char* it = last;
+
+#if USE_PPE_AVX2
+    constexpr size_t Lanes256 = (sizeof(m256i_t) / sizeof(_Char));
+    if (static_cast<size_t>(last - first) >= Lanes256) {
+        for (; static_cast<size_t>(it - first) >= Lanes256; ) {
+            it -= Lanes256;
+            if (const u32 mask = m256i_epi8_movemask(match(m256i_epi8_load_unaligned(it))))
+                return (it + LastLaneInMask_<_Char>(mask));
+        }
+        if (it == first)
+            return nullptr;
+
+        // overlapping load for the head, ignore lanes already visited
+        u32 mask = m256i_epi8_movemask(match(m256i_epi8_load_unaligned(first)));
+        mask &= ~(UINT32_MAX << ((it - first) * sizeof(_Char)));
+        return (mask ? first + LastLaneInMask_<_Char>(mask) : nullptr);
+    }
+#endif
+
+    constexpr size_t Lanes128 = (sizeof(m128i_t) / sizeof(_Char));
+    if (static_cast<size_t>(last - first) >= Lanes128) {
+        for (; static_cast<size_t>(it - first) >= Lanes128; ) {
+            it -= Lanes128;
+            if (const u32 mask = m128i_epi8_movemask(match(m128i_epi8_load_unaligned(it))))
+                return (it + LastLaneInMask_<_Char>(mask));
+        }
+        if (it == first)
+            return nullptr;
+
+        u32 mask = m128i_epi8_movemask(match(m128i_epi8_load_unaligned(first)));
+        mask &= ~(UINT32_MAX << ((it - first) * sizeof(_Char)));
+        return (mask ? first + LastLaneInMask_<_Char>(mask) : nullptr);
+    }
+
+    while (it != first) {
+        if (match(*--it))
+            return it;
+    }
+    return nullptr;
+}
+//----------------------------------------------------------------------------
+// ASCII case folding, used only for the candidate filter of StrStrI()
+FORCE_INLINE m128i_t ToLowerASCII_SIMD_(m128i_t block) NOEXCEPT {
+    const m128i_t upper = ::_mm_and_si128(
+        ::_mm_cmpgt_epi8(block, ::_mm_set1_epi8('A' - 1)),
+        ::_mm_cmplt_epi8(block, ::_mm_set1_epi8('Z' + 1)) );
+    return ::_mm_or_si128(block, ::_mm_and_si128(upper, ::_mm_set1_epi8(0x20)));
+}
+#if USE_PPE_AVX2
+FORCE_INLINE m256i_t ToLowerASCII_SIMD_(m256i_t block) NOEXCEPT {
+    const m256i_t upper = ::_mm256_and_si256(
+        ::_mm256_cmpgt_epi8(block, ::_mm256_set1_epi8('A' - 1)),
+        ::_mm256_cmpgt_epi8(::_mm256_set1_epi8('Z' + 1), block) );
+    return ::_mm256_or_si256(block, ::_mm256_and_si256(upper, ::_mm256_set1_epi8(0x20)));
+}
+#endif
+//----------------------------------------------------------------------------
+// SIMD-friendly substring search (W. Mula): compare the first and the last
+// characters of the needle against 2 shifted loads of the haystack, and only
+// verify the middle of the needle for lanes where both did match.
+// http://0x80.pl/articles/simd-strfind.html#generic-sse-avx2
+//----------------------------------------------------------------------------
+template <ECase _Sensitive, typename _Char>
+struct TSubStringFilter_ {
+    using simd = TStringSIMD_<sizeof(_Char)>;
+
+    static FORCE_INLINE _Char Fold(_Char ch) NOEXCEPT {
+        IF_CONSTEXPR(_Sensitive == ECase::Insensitive)
+            return ToLower(ch);
+        else
+            return ch;
+    }
+    static FORCE_INLINE m128i_t Fold(m128i_t block) NOEXCEPT {
+        IF_CONSTEXPR(_Sensitive == ECase::Insensitive)
+            return ToLowerASCII_SIMD_(block);
+        else
+            return block;
+    }
+#if USE_PPE_AVX2
+    static FORCE_INLINE m256i_t Fold(m256i_t block) NOEXCEPT {
+        IF_CONSTEXPR(_Sensitive == ECase::Insensitive)
+            return ToLowerASCII_SIMD_(block);
+        else
+            return block;
+    }
+#endif
+
+    static FORCE_INLINE bool Verify(const _Char* candidate, const _Char* needle, size_t n) NOEXCEPT {
+        IF_CONSTEXPR(_Sensitive == ECase::Insensitive)
+            return FPlatformString::EqualsI(candidate, needle, n);
+        else
+            return FPlatformString::Equals(candidate, needle, n);
+    }
+};
+//----------------------------------------------------------------------------
+template <ECase _Sensitive, typename _Char>
+static const _Char* FindSubString_SIMD_(const _Char* first, const _Char* last, const _Char* needle, size_t n) NOEXCEPT {
+    using filter = TSubStringFilter_<_Sensitive, _Char>;
+    using simd = typename filter::simd;
+
+    STATIC_ASSERT(sizeof(_Char) == 1 || _Sensitive == ECase::Sensitive); // ASCII folding only valid for char
+    Assert(n > 1);
+
+    const size_t len = static_cast<size_t>(last - first);
+    if (len < n)
+        return last;
+
+    const _Char firstCh = filter::Fold(needle[0]);
+    const _Char lastCh = filter::Fold(needle[n - 1]);
+
+    // lanes of the same character are all set by CmpEq(), clear them all at once
+    constexpr u32 CharMask = static_cast<u32>((u64(1) << sizeof(_Char)) - 1);
+
+    const _Char* it = first;
+    const _Char* const stop = (last - n + 1); // last candidate position (excluded)
+
+#if USE_PPE_AVX2
+    constexpr size_t Lanes256 = (sizeof(m256i_t) / sizeof(_Char));
+    if (static_cast<size_t>(stop - it) >= Lanes256) {
+        const m256i_t first256 = simd::Broadcast256(static_cast<u32>(firstCh));
+        const m256i_t last256 = simd::Broadcast256(static_cast<u32>(lastCh));
+
+        for (; it + Lanes256 <= stop; it += Lanes256) {
+            const m256i_t blockFirst = filter::Fold(m256i_epi8_load_unaligned(it));
+            const m256i_t blockLast = filter::Fold(m256i_epi8_load_unaligned(it + n - 1));
+
+            u32 mask = m256i_epi8_movemask(::_mm256_and_si256(
+                simd::CmpEq(blockFirst, first256),
+                simd::CmpEq(blockLast, last256) ));
+
+            while (mask) {
+                const size_t lane = FirstLaneInMask_<_Char>(mask);
+                if (filter::Verify(it + lane + 1, needle + 1, n - 2))
+                    return (it + lane);
+                mask &= ~(CharMask << (lane * sizeof(_Char)));
+            }
+        }
+    }
+#endif
+
+    constexpr size_t Lanes128 = (sizeof(m128i_t) / sizeof(_Char));
+    if (static_cast<size_t>(stop - it) >= Lanes128) {
+        const m128i_t first128 = simd::Broadcast128(static_cast<u32>(firstCh));
+        const m128i_t last128 = simd::Broadcast128(static_cast<u32>(lastCh));
+
+        for (; it + Lanes128 <= stop; it += Lanes128) {
+            const m128i_t blockFirst = filter::Fold(m128i_epi8_load_unaligned(it));
+            const m128i_t blockLast = filter::Fold(m128i_epi8_load_unaligned(it + n - 1));
+
+            u32 mask = m128i_epi8_movemask(::_mm_and_si128(
+                simd::CmpEq(blockFirst, first128),
+                simd::CmpEq(blockLast, last128) ));
+
+            while (mask) {
+                const size_t lane = FirstLaneInMask_<_Char>(mask);
+                if (filter::Verify(it + lane + 1, needle + 1, n - 2))
+                    return (it + lane);
+                mask &= ~(CharMask << (lane * sizeof(_Char)));
+            }
+        }
+    }
+
+    for (; it != stop; ++it) {
+        if (filter::Fold(it[0]) == firstCh &&
+            filter::Fold(it[n - 1]) == lastCh &&
+            filter::Verify(it + 1, needle + 1, n - 2) )
+            return it;
+    }
+
+    return last;
+}
+//----------------------------------------------------------------------------
+// Compares blocks for strict equality first, and only falls back to towlower()
+// for the lanes which differ: most case insensitive comparisons are between
+// strings with the same case.
+//----------------------------------------------------------------------------
+static bool EqualsI_SIMD_(const wchar_t* lhs, const wchar_t* rhs, size_t len) NOEXCEPT {
+    using simd = TStringSIMD_<sizeof(wchar_t)>;
+
+    constexpr size_t Lanes128 = (sizeof(m128i_t) / sizeof(wchar_t));
+    constexpr u32 AllLanes = 0xFFFF;
+
+    size_t i = 0;
+    for (; i + Lanes128 <= len; i += Lanes128) {
+        u32 mask = m128i_epi8_movemask(simd::CmpEq(
+            m128i_epi8_load_unaligned(lhs + i),
+            m128i_epi8_load_unaligned(rhs + i) ));
+
+        if (Likely(mask == AllLanes))
+            continue;
+
+        for (mask = (~mask & AllLanes); mask; ) {
+            const size_t lane = FirstLaneInMask_<wchar_t>(mask);
+            if (ToLower(lhs[i + lane]) != ToLower(rhs[i + lane]))
+                return false;
+            mask &= ~(static_cast<u32>((u64(1) << sizeof(wchar_t)) - 1) << (lane * sizeof(wchar_t)));
+        }
+    }
+
+    for (; i < len; ++i) {
+        if (lhs[i] != rhs[i] && ToLower(lhs[i]) != ToLower(rhs[i]))
+            return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+#endif //!USE_PPE_SIMD_STRINGVIEW
+//----------------------------------------------------------------------------
+// Index helpers dispatching to the SIMD kernels when available: forward
+// searches return str.size() and backward searches INDEX_NONE when not found.
+//----------------------------------------------------------------------------
+template <bool _Not = false, typename _Char>
+static size_t IndexOfChar_(const TBasicStringView<_Char>& str, _Char ch) NOEXCEPT {
+#if USE_PPE_SIMD_STRINGVIEW
+    return static_cast<size_t>(FindFirst_SIMD_(str.data(), str.data() + str.size(), TMatchChar_<_Char, _Not>{ ch }) - str.data());
+#else
+    return str.FindFirst([ch](_Char x) NOEXCEPT { return ((x == ch) != _Not); });
+#endif
+}
+//----------------------------------------------------------------------------
+template <bool _Not = false, typename _Char>
+static size_t IndexOfCharR_(const TBasicStringView<_Char>& str, _Char ch) NOEXCEPT {
+#if USE_PPE_SIMD_STRINGVIEW
+    const _Char* const it = FindLast_SIMD_(str.data(), str.data() + str.size(), TMatchChar_<_Char, _Not>{ ch });
+    return (it ? static_cast<size_t>(it - str.data()) : INDEX_NONE);
+#else
+    const auto it = str.FindIfR([ch](_Char x) NOEXCEPT { return ((x == ch) != _Not); });
+    return (str.rend() != it ? static_cast<size_t>(std::addressof(*it) - str.data()) : INDEX_NONE);
+#endif
+}
+//----------------------------------------------------------------------------
+template <bool _Not = false, typename _Char>
+static size_t IndexOfAny_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char>& set) NOEXCEPT {
+    if (Unlikely(set.empty()))
+        return (_Not ? 0 : str.size()); // every character is outside of an empty set
+#if USE_PPE_SIMD_STRINGVIEW
+    if (set.size() <= TMatchAnyOf_<_Char>::Capacity)
+        return static_cast<size_t>(FindFirst_SIMD_(str.data(), str.data() + str.size(), TMatchAnyOf_<_Char, _Not>{ set }) - str.data());
+#endif
+    return str.FindFirst([&set](_Char x) NOEXCEPT { return (set.Contains(x) != _Not); });
+}
+//----------------------------------------------------------------------------
+template <bool _Not = false, typename _Char>
+static size_t IndexOfAnyR_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char>& set) NOEXCEPT {
+    if (Unlikely(set.empty()))
+        return (_Not && not str.empty() ? str.size() - 1 : INDEX_NONE);
+#if USE_PPE_SIMD_STRINGVIEW
+    if (set.size() <= TMatchAnyOf_<_Char>::Capacity) {
+        const _Char* const it = FindLast_SIMD_(str.data(), str.data() + str.size(), TMatchAnyOf_<_Char, _Not>{ set });
+        return (it ? static_cast<size_t>(it - str.data()) : INDEX_NONE);
+    }
+#endif
+    const auto it = str.FindIfR([&set](_Char x) NOEXCEPT { return (set.Contains(x) != _Not); });
+    return (str.rend() != it ? static_cast<size_t>(std::addressof(*it) - str.data()) : INDEX_NONE);
+}
+//----------------------------------------------------------------------------
+template <typename _Char>
+static void SplitAt_(TBasicStringView<_Char>& str, TBasicStringView<_Char>& slice, size_t index) NOEXCEPT {
+    if (str.size() == index) {
         slice = str;
         str = TBasicStringView<_Char>();
     }
     else {
-        Assert_NoAssume(pred(*it));
-        slice = str.CutStartingAt(it - 1);
-        str = str.CutBefore(it);
+        slice = str.CutBefore(index);
+        str = str.CutStartingAt(index + 1);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename _Char>
+static void SplitAtR_(TBasicStringView<_Char>& str, TBasicStringView<_Char>& slice, size_t index) NOEXCEPT {
+    if (INDEX_NONE == index) {
+        slice = str;
+        str = TBasicStringView<_Char>();
+    }
+    else {
+        slice = str.CutStartingAt(index + 1);
+        str = str.CutBefore(index);
     }
-
-    return true;
 }
 //----------------------------------------------------------------------------
 template <typename _Char, bool _FindFirst>
 static bool Split_(TBasicStringView<_Char>& str, _Char separator, TBasicStringView<_Char>& slice) {
-    auto pred = [separator](const _Char ch) {
-        return separator == ch;
-    };
+    if (str.empty())
+        return false;
+
     IF_CONSTEXPR(_FindFirst)
-        return SplitIf_<_Char>(str, slice, std::move(pred));
+        SplitAt_(str, slice, IndexOfChar_(str, separator));
     else
-        return SplitIfR_<_Char>(str, slice, std::move(pred));
+        SplitAtR_(str, slice, IndexOfCharR_(str, separator));
+
+    return true;
 }
 //----------------------------------------------------------------------------
 template <typename _Char, bool _FindFirst>
 static bool SplitMulti_(TBasicStringView<_Char>& str, const TBasicStringView<_Char>& separators, TBasicStringView<_Char>& slice) {
-    auto pred = [separators](const _Char ch) {
-        return (separators.end() != std::find(separators.begin(), separators.end(), ch));
-    };
+    if (str.empty())
+        return false;
+
     IF_CONSTEXPR(_FindFirst)
-        return SplitIf_<_Char>(str, slice, std::move(pred));
+        SplitAt_(str, slice, IndexOfAny_(str, separators));
     else
-        return SplitIfR_<_Char>(str, slice, std::move(pred));
+        SplitAtR_(str, slice, IndexOfAnyR_(str, separators));
+
+    return true;
 }
 //----------------------------------------------------------------------------
 template <typename _Char, bool _FindFirst, typename _Separator>
@@ -259,6 +694,19 @@ static bool WildMatch_(const TBasicStringView<_Char>& pat, const TBasicStringVie
 {
     typedef TCharEqualTo<_Char, _Sensitive> equalto;
 
+    // when the pattern resumes with a literal after a star, jump directly to
+    // its next occurrence instead of retrying every position of the input
+    const auto skipToLiteral = [](const _Char* s, const _Char* send, _Char literal) NOEXCEPT -> const _Char* {
+#if USE_PPE_SIMD_STRINGVIEW
+        IF_CONSTEXPR(_Sensitive == ECase::Sensitive) {
+            if (literal != STRING_LITERAL(_Char, '?') && literal != STRING_LITERAL(_Char, '*'))
+                return FindFirst_SIMD_(s, send, TMatchChar_<_Char>{ literal });
+        }
+#endif
+        Unused(send, literal);
+        return s;
+    };
+
     // Wildcard matching algorithms
     // http://xoomer.virgilio.it/acantato/dev/wildcard/wildmatch.html#evolution
 
@@ -281,8 +729,9 @@ loopStart:
         case STRING_LITERAL(_Char, '*'):
             star = true;
             sfirst = s, pfirst = p;
-            do { ++pfirst; } while (*pfirst == STRING_LITERAL(_Char, '*') && pfirst != pend);
+            do { ++pfirst; } while (pfirst != pend && *pfirst == STRING_LITERAL(_Char, '*'));
             if (pfirst == pend) return true;
+            sfirst = skipToLiteral(sfirst, send, *pfirst);
             goto loopStart;
         default:
             if (equalto()(*s, *p) == false)
@@ -295,7 +744,7 @@ loopStart:
 
 starCheck:
    if (!star) return false;
-   sfirst++;
+   sfirst = skipToLiteral(sfirst + 1, send, *pfirst);
    goto loopStart;
 }
 //----------------------------------------------------------------------------
@@ -412,28 +861,39 @@ static TBasicStringView<_Char> SplitInplaceIf_ReturnEaten_(TBasicStringView<_Cha
     return eaten;
 }
 //----------------------------------------------------------------------------
-template <typename _Char, typename _Pred>
-static TBasicStringView<_Char> SplitInplaceIf_ReturnEaten_(TBasicStringView<_Char>& str, _Pred&& pred) {
-    const auto it = str.FindIfNot(std::move(pred));
-    const TBasicStringView<_Char> eaten = str.CutBefore(it);
-    str = str.CutStartingAt(it);
+template <typename _Char>
+static TBasicStringView<_Char> EatFirst_(TBasicStringView<_Char>& str, size_t count) {
+    const TBasicStringView<_Char> eaten = str.CutBefore(count);
+    str = str.CutStartingAt(count);
     return eaten;
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
 typename TBasicStringView<_Char>::iterator StrChr_(const TBasicStringView<_Char>& str, _Char ch) {
-    return str.FindIf([ch](_Char c) { return (c == ch); });
+    return (str.begin() + IndexOfChar_(str, ch));
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
 typename TBasicStringView<_Char>::reverse_iterator StrRChr_(const TBasicStringView<_Char>& str, _Char ch) {
-    return str.FindIfR([ch](_Char c) { return (c == ch); });
+    const size_t index = IndexOfCharR_(str, ch);
+    return (INDEX_NONE != index
+        ? typename TBasicStringView<_Char>::reverse_iterator(str.begin() + (index + 1))
+        : str.rend() );
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
 typename TBasicStringView<_Char>::iterator StrStr_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char>& firstOccurence) {
     Assert(not firstOccurence.empty());
+#if USE_PPE_SIMD_STRINGVIEW
+    if (firstOccurence.size() == 1)
+        return StrChr_(str, firstOccurence[0]);
+
+    return (str.begin() + (FindSubString_SIMD_<ECase::Sensitive>(
+        str.data(), str.data() + str.size(),
+        firstOccurence.data(), firstOccurence.size()) - str.data()) );
+#else
     return str.FindSubRange(firstOccurence);
+#endif
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
@@ -467,6 +927,19 @@ bool EndsWithI_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char
 template <typename _Char>
 typename TBasicStringView<_Char>::iterator StrStrI_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char>& firstOccurence) {
     Assert(not firstOccurence.empty());
+#if USE_PPE_SIMD_STRINGVIEW
+    // ASCII case folding is only correct for char, towlower() is not linear
+    IF_CONSTEXPR(std::is_same_v<_Char, char>) {
+        if (firstOccurence.size() == 1) {
+            const char bothCases[2] = { ToLower(firstOccurence[0]), ToUpper(firstOccurence[0]) };
+            return (str.begin() + IndexOfAny_(str, FStringView(bothCases, bothCases[0] == bothCases[1] ? 1 : 2)));
+        }
+
+        return (str.begin() + (FindSubString_SIMD_<ECase::Insensitive>(
+            str.data(), str.data() + str.size(),
+            firstOccurence.data(), firstOccurence.size()) - str.data()) );
+    }
+#endif
     if (firstOccurence.size() <= str.size()) {
         forrange(i, 0, str.size() - firstOccurence.size() + 1) {
             if (EqualsI(str.SubRange(i, firstOccurence.size()), firstOccurence))
@@ -589,23 +1062,23 @@ FWStringView EatOctals(FWStringView& wstr) NOEXCEPT { return SplitInplaceIf_Retu
 FStringView EatPrints(FStringView& str) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, &IsPrint); }
 FWStringView EatPrints(FWStringView& wstr) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, &IsPrint); }
 //----------------------------------------------------------------------------
-FStringView EatSpaces(FStringView& str) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, &IsSpace); }
+FStringView EatSpaces(FStringView& str) NOEXCEPT { return EatFirst_(str, IndexOfAny_<true>(str, " \f\n\r\t\v"_view)); }
 FWStringView EatSpaces(FWStringView& wstr) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, &IsSpace); }
 //----------------------------------------------------------------------------
-FStringView EatWhile(FStringView& str, char ch) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, [ch](char x) { return (x == ch); }); }
-FWStringView EatWhile(FWStringView& wstr, wchar_t wch) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, [wch](wchar_t x) { return (x == wch); }); }
+FStringView EatWhile(FStringView& str, char ch) NOEXCEPT { return EatFirst_(str, IndexOfChar_<true>(str, ch)); }
+FWStringView EatWhile(FWStringView& wstr, wchar_t wch) NOEXCEPT { return EatFirst_(wstr, IndexOfChar_<true>(wstr, wch)); }
 //----------------------------------------------------------------------------
-FStringView EatWhile(FStringView& str, const FStringView& multiple) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, [multiple](char x) { return (multiple.Contains(x)); }); }
-FWStringView EatWhile(FWStringView& wstr, const FWStringView& wmultiple) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, [wmultiple](wchar_t x) { return (wmultiple.Contains(x)); }); }
+FStringView EatWhile(FStringView& str, const FStringView& multiple) NOEXCEPT { return EatFirst_(str, IndexOfAny_<true>(str, multiple)); }
+FWStringView EatWhile(FWStringView& wstr, const FWStringView& wmultiple) NOEXCEPT { return EatFirst_(wstr, IndexOfAny_<true>(wstr, wmultiple)); }
 //----------------------------------------------------------------------------
 FStringView EatWhile(FStringView& str, bool (*is_a)(char)) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, is_a); }
 FWStringView EatWhile(FWStringView& wstr, bool (*is_a)(wchar_t)) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, is_a); }
 //----------------------------------------------------------------------------
-FStringView EatUntil(FStringView& str, char ch) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, [ch](char x) { return (x != ch); }); }
-FWStringView EatUntil(FWStringView& wstr, wchar_t wch) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, [wch](wchar_t x) { return (x != wch); }); }
+FStringView EatUntil(FStringView& str, char ch) NOEXCEPT { return EatFirst_(str, IndexOfChar_(str, ch)); }
+FWStringView EatUntil(FWStringView& wstr, wchar_t wch) NOEXCEPT { return EatFirst_(wstr, IndexOfChar_(wstr, wch)); }
 //----------------------------------------------------------------------------
-FStringView EatUntil(FStringView& str, const FStringView& multiple) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, [multiple](char x) { return (not multiple.Contains(x)); }); }
-FWStringView EatUntil(FWStringView& wstr, const FWStringView& wmultiple) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, [wmultiple](wchar_t x) { return (not wmultiple.Contains(x)); }); }
+FStringView EatUntil(FStringView& str, const FStringView& multiple) NOEXCEPT { return EatFirst_(str, IndexOfAny_(str, multiple)); }
+FWStringView EatUntil(FWStringView& wstr, const FWStringView& wmultiple) NOEXCEPT { return EatFirst_(wstr, IndexOfAny_(wstr, wmultiple)); }
 //----------------------------------------------------------------------------
 FStringView EatUntil(FStringView& str, bool (*is_not_a)(char)) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(str, is_not_a); }
 FWStringView EatUntil(FWStringView& wstr, bool (*is_not_a)(wchar_t)) NOEXCEPT { return SplitInplaceIf_ReturnEaten_(wstr, is_not_a); }
@@ -623,32 +1096,24 @@ bool EatExpectI(FWStringView& wstr, const FWStringView& expected) NOEXCEPT { if
 //----------------------------------------------------------------------------
 template <typename _Char>
 static TBasicStringView<_Char> TrimStart_(const TBasicStringView<_Char>& str, _Char ch) {
-    size_t begin = 0;
-    for (; begin < str.size() && str[begin] == ch; ++begin);
-    return str.CutStartingAt(begin);
+    return str.CutStartingAt(IndexOfChar_<true>(str, ch));
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
 static TBasicStringView<_Char> TrimStart_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char>& chars) {
-    Assert(not chars.empty());
-    size_t begin = 0;
-    for (; begin < str.size() && chars.Contains(str[begin]); ++begin);
-    return str.CutStartingAt(begin);
+    return str.CutStartingAt(IndexOfAny_<true>(str, chars));
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
 static TBasicStringView<_Char> TrimEnd_(const TBasicStringView<_Char>& str, _Char ch) {
-    size_t end = str.size();
-    for (; end > 0 && str[end - 1] == ch; --end);
-    return str.CutBefore(end);
+    const size_t last = IndexOfCharR_<true>(str, ch);
+    return str.CutBefore(INDEX_NONE != last ? last + 1 : 0);
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
 static TBasicStringView<_Char> TrimEnd_(const TBasicStringView<_Char>& str, const TBasicStringView<_Char>& chars) {
-    Assert(not chars.empty());
-    size_t end = str.size();
-    for (; end > 0 && chars.Contains(str[end - 1]); --end);
-    return str.CutBefore(end);
+    const size_t last = IndexOfAnyR_<true>(str, chars);
+    return str.CutBefore(INDEX_NONE != last ? last + 1 : 0);
 }
 //----------------------------------------------------------------------------
 template <typename _Char>
@@ -761,7 +1226,11 @@ bool CONSTF EqualsN(const wchar_t* lhs, const wchar_t* rhs, size_t len) NOEXCEPT
 }
 //----------------------------------------------------------------------------
 bool CONSTF EqualsNI(const wchar_t* lhs, const wchar_t* rhs, size_t len) NOEXCEPT {
+#if USE_PPE_SIMD_STRINGVIEW
+    return (lhs == rhs || 0 == len || EqualsI_SIMD_(lhs, rhs, len));
+#else
     return (lhs == rhs || 0 == len || FPlatformString::EqualsI(lhs, rhs, len));
+#endif
 }
 //----------------------------------------------------------------------------
 bool CONSTF Equals(const FStringView& lhs, const FStringView& rhs) NOEXCEPT {
@@ -780,8 +1249,7 @@ bool CONSTF EqualsI(const FStringView& lhs, const FStringView& rhs) NOEXCEPT {
 }
 //----------------------------------------------------------------------------
 bool CONSTF EqualsI(const FWStringView& lhs, const FWStringView& rhs) NOEXCEPT {
-    return ((lhs.size() == rhs.size()) &&
-            (lhs.size() == 0 || lhs.data() == rhs.data() || FPlatformString::EqualsI(lhs.data(), rhs.data(), lhs.size())) );
+    return ((lhs.size() == rhs.size()) && EqualsNI(lhs.data(), rhs.data(), lhs.size()) );
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
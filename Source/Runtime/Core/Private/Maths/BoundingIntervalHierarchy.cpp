@@ -6,6 +6,7 @@
 #include "HAL/PlatformMaths.h"
 
 #include "Maths/Frustum.h"
+#include "Maths/FrustumCulling.h"
 #include "Maths/PackingHelpers.h"
 #include "Maths/Ray.h"
 #include "Maths/ScalarVectorHelpers.h"
@@ -53,9 +54,10 @@ static u32 CullBIHTree_(
         const FBIHNode* Node;
         FBoundingBox Bounds;
         u32 Begin, End;
+        u32 PlaneMask; // inherited from the parent, see FFrustumCuller::Contains()
     };
 
-    FBIHCandidate_ it{ root, bounds, 0, checked_cast<u32>(count) };
+    FBIHCandidate_ it{ root, bounds, 0, checked_cast<u32>(count), FFrustumCuller::AllPlanes };
     STACKLOCAL_ASSUMEPOD_STACK(FBIHCandidate_, candidates, ApproxBIHTreeDepth_(count));
 
     u32 intersections = 0;
@@ -77,8 +79,9 @@ static u32 CullBIHTree_(
         bounds0.Max()[axis] = UnquantizeClip0_(it.Node->Clip0, node0, node1);
         bounds1.Min()[axis] = UnquantizeClip1_(it.Node->Clip1, node0, node1);
 
-        const EContainmentType collision0 = volume(bounds0);
-        const EContainmentType collision1 = volume(bounds1);
+        u32 planeMask0 = it.PlaneMask, planeMask1 = it.PlaneMask;
+        const EContainmentType collision0 = volume(bounds0, &planeMask0);
+        const EContainmentType collision1 = volume(bounds1, &planeMask1);
 
         const bool isLeaf = it.Node->IsLeaf();
 
@@ -88,7 +91,7 @@ static u32 CullBIHTree_(
             intersections += (split - it.Begin);
         }
         else if (EContainmentType::Intersects == collision0) {
-            candidates.Push(it.Node + it.Node->Child0, bounds0, it.Begin, split);
+            candidates.Push(it.Node + it.Node->Child0, bounds0, it.Begin, split, planeMask0);
         }
         else {
             Assert(EContainmentType::Disjoint == collision0);
@@ -99,8 +102,8 @@ static u32 CullBIHTree_(
             hitrange(split, it.End, collision1);
             intersections += (it.End - split);
         }
-        else if (EContainmentType::Intersects == collision0) {
-            candidates.Push(it.Node + it.Node->Child0 + 1, bounds1, split, it.End);
+        else if (EContainmentType::Intersects == collision1) {
+            candidates.Push(it.Node + it.Node->Child0 + 1, bounds1, split, it.End, planeMask1);
         }
         else {
             Assert(EContainmentType::Disjoint == collision1);
@@ -578,7 +581,7 @@ size_t FBasicBIHTree::Intersects(const FBoundingBox& box, const hitrange_delegat
 
     struct FBIHBox_ {
         FBoundingBox Box;
-        EContainmentType operator ()(const FBoundingBox& box) const {
+        EContainmentType operator ()(const FBoundingBox& box, u32*) const {
             bool inside = false;
             return (Box.Intersects(box, &inside)
                 ? (inside ? EContainmentType::Contains : EContainmentType::Intersects)
@@ -593,14 +596,15 @@ size_t FBasicBIHTree::Intersects(const FFrustum& frustum, const hitrange_delegat
     Assert(_root);
     Assert(onhit.Valid());
 
+    // only tests the planes still intersecting the parent node
     struct FBIHFrustum_ {
-        FFrustum Frustum;
-        EContainmentType operator ()(const FBoundingBox& box) const {
-            return Frustum.Contains(box);
+        FFrustumCuller Culler;
+        EContainmentType operator ()(const FBoundingBox& box, u32* planeMask) const {
+            return Culler.Contains(box, planeMask);
         }
     };
 
-    return CullBIHTree_(FBIHFrustum_{ frustum }, onhit, static_cast<u32>(count), _root, _bounds);
+    return CullBIHTree_(FBIHFrustum_{ FFrustumCuller{ frustum } }, onhit, static_cast<u32>(count), _root, _bounds);
 }
 //----------------------------------------------------------------------------
 size_t FBasicBIHTree::Intersects(const FSphere& sphere, const hitrange_delegate& onhit, size_t count) const {
@@ -610,7 +614,7 @@ size_t FBasicBIHTree::Intersects(const FSphere& sphere, const hitrange_delegate&
 
     struct FBIHSphere_ {
         FSphere Sphere;
-        EContainmentType operator ()(const FBoundingBox& box) const {
+        EContainmentType operator ()(const FBoundingBox& box, u32*) const {
             return Sphere.Contains(box);
         }
     };
@@ -0,0 +1,193 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Maths/FrustumCulling.h"
+
+#include "HAL/PlatformMaths.h"
+#include "Maths/Collision.h"
+#include "Maths/Frustum.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Thread/Task/TaskHelpers.h"
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// nearest planes first: they reject most of the bounds behind the camera or aside
+static CONSTEXPR const EFrustumPlane GFrustumPlanesOrder_[FFrustumCuller::NumPlanes] = {
+    EFrustumPlane::Near,
+    EFrustumPlane::Left,
+    EFrustumPlane::Right,
+    EFrustumPlane::Top,
+    EFrustumPlane::Bottom,
+    EFrustumPlane::Far,
+};
+//----------------------------------------------------------------------------
+FORCE_INLINE static u32 LaneMask_(size_t numLanes) {
+    Assert(numLanes <= FWideFloat::Lanes);
+    return (numLanes == FWideFloat::Lanes ? FWideFloat::AllLanesMask : (1u << numLanes) - 1);
+}
+//----------------------------------------------------------------------------
+// visibles words covering [first, last) are overwritten, first must start a word
+template <typename _Batch>
+static size_t CullRange_(const TMemoryView<u64>& visibles, size_t first, size_t last, _Batch&& batch) NOEXCEPT {
+    Assert(first % FFrustumCuller::BitsPerWord == 0);
+    Assert(first <= last);
+    Assert(visibles.size() >= FFrustumCuller::VisibilityWords(last));
+
+    constexpr size_t L = FWideFloat::Lanes;
+
+    size_t numVisibles = 0;
+    for (size_t w = first; w < last; w += FFrustumCuller::BitsPerWord) {
+        const size_t wordEnd = Min(w + FFrustumCuller::BitsPerWord, last);
+
+        u64 word = 0;
+        for (size_t i = w; i < wordEnd; i += L) {
+            const size_t numLanes = Min(L, wordEnd - i);
+            const u32 mask = (batch(i, checked_cast<u32>(numLanes)) & LaneMask_(numLanes));
+            word |= (u64(mask) << (i - w));
+        }
+
+        visibles[w / FFrustumCuller::BitsPerWord] = word;
+        numVisibles += checked_cast<size_t>(FPlatformMaths::popcnt(word));
+    }
+
+    return numVisibles;
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static FWideFloat LoadLanes_(const TMemoryView<const float>& stream, size_t first, u32 numLanes) NOEXCEPT {
+    return (numLanes == FWideFloat::Lanes
+        ? FWideFloat::Load(stream.data() + first)
+        : FWideFloat::LoadPartial(stream.data() + first, numLanes) );
+}
+//----------------------------------------------------------------------------
+template <typename _Cull>
+static size_t ParallelCullRange_(size_t numBounds, ITaskContext* context, _Cull&& cull) {
+    if (numBounds < FFrustumCuller::ParallelThreshold)
+        return cull(0, numBounds);
+
+    const size_t numChunks = ((numBounds + FFrustumCuller::ChunkSize - 1) / FFrustumCuller::ChunkSize);
+    return checked_cast<size_t>(ParallelSum(0, numChunks,
+        [&cull, numBounds](size_t chunk) -> int {
+            const size_t first = chunk * FFrustumCuller::ChunkSize;
+            return checked_cast<int>(cull(first, Min(first + FFrustumCuller::ChunkSize, numBounds)));
+        },
+        ETaskPriority::High, context ));
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FFrustumCuller::FFrustumCuller(const FFrustum& frustum) NOEXCEPT {
+    const FPlane* const planes[NumPlanes] = {
+        &frustum.Near(), &frustum.Far(),
+        &frustum.Left(), &frustum.Right(),
+        &frustum.Top(), &frustum.Bottom(),
+    };
+
+    forrange(i, 0, NumPlanes) {
+        const FPlane& plane = *planes[static_cast<size_t>(GFrustumPlanesOrder_[i])];
+        _planes[i] = plane;
+        _normalX[i] = FWideFloat::Broadcast(plane.Normal().x);
+        _normalY[i] = FWideFloat::Broadcast(plane.Normal().y);
+        _normalZ[i] = FWideFloat::Broadcast(plane.Normal().z);
+        _distance[i] = FWideFloat::Broadcast(plane.D());
+    }
+}
+//----------------------------------------------------------------------------
+size_t FFrustumCuller::CullSpheres(const TMemoryView<u64>& visibles, const FSoaSpheres& spheres, u32 planeMask) const NOEXCEPT {
+    return CullSpheres_(visibles, spheres, 0, spheres.size(), planeMask);
+}
+//----------------------------------------------------------------------------
+size_t FFrustumCuller::CullBoxes(const TMemoryView<u64>& visibles, const FSoaBoundingBoxes& boxes, u32 planeMask) const NOEXCEPT {
+    return CullBoxes_(visibles, boxes, 0, boxes.size(), planeMask);
+}
+//----------------------------------------------------------------------------
+size_t FFrustumCuller::ParallelCullSpheres(const TMemoryView<u64>& visibles, const FSoaSpheres& spheres, u32 planeMask, ITaskContext* context) const {
+    return ParallelCullRange_(spheres.size(), context, [&](size_t first, size_t last) NOEXCEPT -> size_t {
+        return CullSpheres_(visibles, spheres, first, last, planeMask);
+    });
+}
+//----------------------------------------------------------------------------
+size_t FFrustumCuller::ParallelCullBoxes(const TMemoryView<u64>& visibles, const FSoaBoundingBoxes& boxes, u32 planeMask, ITaskContext* context) const {
+    return ParallelCullRange_(boxes.size(), context, [&](size_t first, size_t last) NOEXCEPT -> size_t {
+        return CullBoxes_(visibles, boxes, first, last, planeMask);
+    });
+}
+//----------------------------------------------------------------------------
+EContainmentType FFrustumCuller::Contains(const FBoundingBox& box, u32* planeMask) const NOEXCEPT {
+    Assert(planeMask);
+
+    for (u32 planes = *planeMask; planes; planes &= planes - 1) {
+        const u32 p = FPlatformMaths::tzcnt(planes);
+
+        switch (Collision::PlaneIntersectsBox(_planes[p], box)) {
+        case EPlaneIntersectionType::Back:
+            return EContainmentType::Disjoint;
+        case EPlaneIntersectionType::Front:
+            *planeMask &= ~(1u << p); // children will be in front of this plane too
+            break;
+        case EPlaneIntersectionType::Intersecting:
+            break;
+        }
+    }
+
+    return (0 == *planeMask ? EContainmentType::Contains : EContainmentType::Intersects);
+}
+//----------------------------------------------------------------------------
+size_t FFrustumCuller::CullSpheres_(const TMemoryView<u64>& visibles, const FSoaSpheres& spheres, size_t first, size_t last, u32 planeMask) const NOEXCEPT {
+    Assert(last <= spheres.size());
+    Assert(!(planeMask & ~AllPlanes));
+
+    return CullRange_(visibles, first, last, [&](size_t i, u32 numLanes) NOEXCEPT -> u32 {
+        const FWideFloat cx = LoadLanes_(spheres.CenterX, i, numLanes);
+        const FWideFloat cy = LoadLanes_(spheres.CenterY, i, numLanes);
+        const FWideFloat cz = LoadLanes_(spheres.CenterZ, i, numLanes);
+        const FWideFloat negRadius = -LoadLanes_(spheres.Radius, i, numLanes);
+
+        // same as Collision::PlaneIntersectsSphere() != Back
+        u32 visible = FWideFloat::AllLanesMask;
+        for (u32 planes = planeMask; planes && visible; planes &= planes - 1) {
+            const u32 p = FPlatformMaths::tzcnt(planes);
+            const FWideFloat distance = (_normalX[p] * cx + _normalY[p] * cy + _normalZ[p] * cz) + _distance[p];
+            visible &= (~(distance < negRadius).MoveMask()) & FWideFloat::AllLanesMask;
+        }
+
+        return visible;
+    });
+}
+//----------------------------------------------------------------------------
+size_t FFrustumCuller::CullBoxes_(const TMemoryView<u64>& visibles, const FSoaBoundingBoxes& boxes, size_t first, size_t last, u32 planeMask) const NOEXCEPT {
+    Assert(last <= boxes.size());
+    Assert(!(planeMask & ~AllPlanes));
+
+    return CullRange_(visibles, first, last, [&](size_t i, u32 numLanes) NOEXCEPT -> u32 {
+        const FWideFloat minX = LoadLanes_(boxes.MinX, i, numLanes);
+        const FWideFloat minY = LoadLanes_(boxes.MinY, i, numLanes);
+        const FWideFloat minZ = LoadLanes_(boxes.MinZ, i, numLanes);
+        const FWideFloat maxX = LoadLanes_(boxes.MaxX, i, numLanes);
+        const FWideFloat maxY = LoadLanes_(boxes.MaxY, i, numLanes);
+        const FWideFloat maxZ = LoadLanes_(boxes.MaxZ, i, numLanes);
+
+        // same as Collision::PlaneIntersectsBox() != Back: the corner the furthest along
+        // the plane normal is picked with the sign of the normal, which is uniform for all lanes
+        u32 visible = FWideFloat::AllLanesMask;
+        for (u32 planes = planeMask; planes && visible; planes &= planes - 1) {
+            const u32 p = FPlatformMaths::tzcnt(planes);
+            const float3& n = _planes[p].Normal();
+            const FWideFloat distance = (
+                _normalX[p] * (n.x >= 0.f ? maxX : minX) +
+                _normalY[p] * (n.y >= 0.f ? maxY : minY) +
+                _normalZ[p] * (n.z >= 0.f ? maxZ : minZ) ) + _distance[p];
+            visible &= (~(distance < FWideFloat::Zero()).MoveMask()) & FWideFloat::AllLanesMask;
+        }
+
+        return visible;
+    });
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,579 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Maths/LinearOctree.h"
+
+#include "HAL/PlatformMaths.h"
+#include "Maths/Collision.h"
+#include "Maths/Frustum.h"
+#include "Maths/FrustumCulling.h"
+#include "Maths/Ray.h"
+#include "Maths/ScalarBoundingBoxHelpers.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Maths/Sphere.h"
+#include "Thread/Task/TaskHelpers.h"
+
+#include <algorithm>
+
+// https://developer.nvidia.com/blog/thinking-parallel-part-iii-tree-construction-gpu/ (Morton codes)
+// http://www.tulrich.com/geekstuff/partitioning.html (loose octrees)
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+CONSTEXPR size_t ChunkSize_ = 64 * 1024; // objects per parallel task
+CONSTEXPR u32 RadixBits_ = 12;
+CONSTEXPR u32 RadixBuckets_ = (1u << RadixBits_);
+CONSTEXPR u32 IdBits_ = 30; // sort keys are packed with the object id in a single u64
+CONSTEXPR u64 IdMask_ = ((u64(1) << IdBits_) - 1);
+CONSTEXPR u32 KeyBits_ = (3 * FLinearOctree::MaxLevel + 4);
+//----------------------------------------------------------------------------
+FORCE_INLINE static u32 Part1By2_(u32 x) {
+    x &= 0x000003FF;
+    x = (x ^ (x << 16)) & 0xFF0000FF;
+    x = (x ^ (x << 8)) & 0x0300F00F;
+    x = (x ^ (x << 4)) & 0x030C30C3;
+    x = (x ^ (x << 2)) & 0x09249249;
+    return x;
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static u32 Compact1By2_(u32 x) {
+    x &= 0x09249249;
+    x = (x ^ (x >> 2)) & 0x030C30C3;
+    x = (x ^ (x >> 4)) & 0x0300F00F;
+    x = (x ^ (x >> 8)) & 0xFF0000FF;
+    x = (x ^ (x >> 16)) & 0x000003FF;
+    return x;
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static u64 MakeCellKey_(u64 morton, u32 level) {
+    return ((morton << 4) | level);
+}
+//----------------------------------------------------------------------------
+// slightly larger than twice the cell, to absorb rounding errors of objects touching their loose cell
+FORCE_INLINE static FBoundingBox LooseBounds_(const float3& origin, float finestCellSize, u32 level, u32 x, u32 y, u32 z) {
+    const float cellSize = (finestCellSize * static_cast<float>(1u << (FLinearOctree::MaxLevel - level)));
+    const float margin = (cellSize * (0.5f + 1.f / 1024));
+    const float3 cellMin = origin + float3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * finestCellSize;
+    return FBoundingBox(cellMin - margin, cellMin + (cellSize + margin));
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static float SafeRcp_(float d) {
+    return (1.f / (Abs(d) > 1e-20f ? d : (d < 0.f ? -1e-20f : 1e-20f)));
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static bool RayIntersectsBox_(const float3& origin, const float3& invDir, const FBoundingBox& box, float tmax, float* tnear) {
+    const float3 t0 = (box.Min() - origin) * invDir;
+    const float3 t1 = (box.Max() - origin) * invDir;
+    const float tmin = Max(Max(Min(t0.x, t1.x), Min(t0.y, t1.y)), Max(Min(t0.z, t1.z), 0.f));
+    const float tfar = Min(Min(Max(t0.x, t1.x), Max(t0.y, t1.y)), Min(Max(t0.z, t1.z), tmax));
+    *tnear = tmin;
+    return (tmin <= tfar);
+}
+//----------------------------------------------------------------------------
+// LSD radix sort on the bits above IdBits_, each pass is split in chunks: counted in parallel,
+// then scattered in parallel at offsets reserved for every (bucket, chunk) pair to stay stable
+static void RadixSort_(VECTOR(Maths, u64)& values, ITaskContext* context) {
+    const size_t n = values.size();
+    if (n < 2 * ChunkSize_) {
+        std::sort(values.begin(), values.end());
+        return;
+    }
+
+    VECTOR(Maths, u64) tmp;
+    tmp.resize_Uninitialized(n);
+
+    const size_t numChunks = ((n + ChunkSize_ - 1) / ChunkSize_);
+    VECTOR(Maths, u32) histograms;
+    histograms.resize_Uninitialized(numChunks * RadixBuckets_);
+
+    for (u32 shift = IdBits_; shift < IdBits_ + KeyBits_; shift += RadixBits_) {
+        const TMemoryView<const u64> src = values.MakeConstView();
+        const TMemoryView<u64> dst = tmp.MakeView();
+
+        ParallelFor(0, numChunks, [&](size_t chunk) {
+            const TMemoryView<u32> histogram = histograms.MakeView().SubRange(chunk * RadixBuckets_, RadixBuckets_);
+            Broadcast(histogram, u32(0));
+
+            const size_t last = Min(n, (chunk + 1) * ChunkSize_);
+            forrange(i, chunk * ChunkSize_, last)
+                histogram[(src[i] >> shift) & (RadixBuckets_ - 1)]++;
+        }, ETaskPriority::High, context);
+
+        u32 offset = 0;
+        forrange(bucket, 0, RadixBuckets_) {
+            forrange(chunk, 0, numChunks) {
+                u32& count = histograms[chunk * RadixBuckets_ + bucket];
+                const u32 start = offset;
+                offset += count;
+                count = start;
+            }
+        }
+        Assert(offset == n);
+
+        ParallelFor(0, numChunks, [&](size_t chunk) {
+            u32* const offsets = histograms.data() + chunk * RadixBuckets_;
+
+            const size_t last = Min(n, (chunk + 1) * ChunkSize_);
+            forrange(i, chunk * ChunkSize_, last)
+                dst[offsets[(src[i] >> shift) & (RadixBuckets_ - 1)]++] = src[i];
+        }, ETaskPriority::High, context);
+
+        values.swap(tmp);
+    }
+}
+//----------------------------------------------------------------------------
+// Queries
+//----------------------------------------------------------------------------
+struct FBoxQuery_ {
+    const FBoundingBox& Box;
+
+    u32 RootState() const { return 0; }
+    EContainmentType Node(const FBoundingBox& loose, u32*) const { return Collision::BoxContainsBox(Box, loose); }
+    bool Object(const FBoundingBox& bounds, u32) const { return Collision::BoxIntersectsBox(Box, bounds); }
+};
+//----------------------------------------------------------------------------
+struct FSphereQuery_ {
+    const FSphere& Sphere;
+
+    u32 RootState() const { return 0; }
+    EContainmentType Node(const FBoundingBox& loose, u32*) const { return Collision::SphereContainsBox(Sphere, loose); }
+    bool Object(const FBoundingBox& bounds, u32) const { return Collision::BoxIntersectsSphere(bounds, Sphere); }
+};
+//----------------------------------------------------------------------------
+// the state holds the planes still intersecting the parent cell
+struct FFrustumQuery_ {
+    FFrustumCuller Culler;
+
+    u32 RootState() const { return FFrustumCuller::AllPlanes; }
+    EContainmentType Node(const FBoundingBox& loose, u32* planeMask) const { return Culler.Contains(loose, planeMask); }
+    bool Object(const FBoundingBox& bounds, u32 planeMask) const { return (Culler.Contains(bounds, &planeMask) != EContainmentType::Disjoint); }
+};
+//----------------------------------------------------------------------------
+struct FOctreeData_ {
+    TMemoryView<const FLinearOctree::FCell> Cells;
+    TMemoryView<const FLinearOctree::FObjectId> SortedIds;
+    TMemoryView<const FBoundingBox> SortedBounds;
+    float3 Origin;
+    float FinestCellSize;
+
+    // children ranges are found by binary search, since a subtree is contiguous in the cells
+    u32 ChildLast(u32 first, u32 last, u64 childMorton, u32 childShift) const {
+        const u64 endKey = ((childMorton + (u64(1) << childShift)) << 4);
+        return checked_cast<u32>(std::lower_bound(Cells.begin() + first, Cells.begin() + last, endKey,
+            [](const FLinearOctree::FCell& cell, u64 key) { return (cell.Key < key); }) - Cells.begin());
+    }
+};
+//----------------------------------------------------------------------------
+template <typename _Query>
+struct FOctreeWalker_ : FOctreeData_ {
+    const _Query& Query;
+    const FLinearOctree::onhit_delegate& OnHit;
+    size_t NumHits{ 0 };
+
+    FOctreeWalker_(const FOctreeData_& data, const _Query& query, const FLinearOctree::onhit_delegate& onHit)
+    :   FOctreeData_(data), Query(query), OnHit(onHit)
+    {}
+
+    void ReportObjects(u32 firstObject, u32 lastObject) {
+        // skip objects pending after a move
+        for (u32 o = firstObject; o < lastObject; ) {
+            if (FLinearOctree::InvalidObject == SortedIds[o]) {
+                ++o;
+                continue;
+            }
+            u32 run = o + 1;
+            while (run < lastObject && FLinearOctree::InvalidObject != SortedIds[run])
+                ++run;
+            OnHit(SortedIds.SubRange(o, run - o));
+            NumHits += (run - o);
+            o = run;
+        }
+    }
+
+    void Visit(u32 level, u32 x, u32 y, u32 z, u64 morton, u32 first, u32 last, u32 state) {
+        Assert(first < last);
+
+        // the root cell also holds the objects outside of the world
+        if (level > 0) {
+            switch (Query.Node(LooseBounds_(Origin, FinestCellSize, level, x, y, z), &state)) {
+            case EContainmentType::Disjoint:
+                return;
+            case EContainmentType::Contains:
+                ReportObjects(Cells[first].FirstObject, Cells[last - 1].FirstObject + Cells[last - 1].NumObjects);
+                return;
+            case EContainmentType::Intersects:
+                break;
+            }
+        }
+
+        if (Cells[first].Key == MakeCellKey_(morton, level)) {
+            const FLinearOctree::FCell& cell = Cells[first++];
+            forrange(o, cell.FirstObject, cell.FirstObject + cell.NumObjects) {
+                if (FLinearOctree::InvalidObject != SortedIds[o] && Query.Object(SortedBounds[o], state)) {
+                    OnHit(SortedIds.SubRange(o, 1));
+                    NumHits++;
+                }
+            }
+        }
+
+        if (first == last)
+            return;
+
+        Assert(level < FLinearOctree::MaxLevel);
+        const u32 childShift = 3 * (FLinearOctree::MaxLevel - level - 1);
+        const u32 half = (1u << (FLinearOctree::MaxLevel - level - 1));
+
+        for (u32 k = 0; k < 8 && first < last; ++k) {
+            const u64 childMorton = (morton + (u64(k) << childShift));
+            const u32 childLast = ChildLast(first, last, childMorton, childShift);
+            if (childLast > first) {
+                Visit(level + 1,
+                    x + (k & 1) * half, y + ((k >> 1) & 1) * half, z + ((k >> 2) & 1) * half,
+                    childMorton, first, childLast, state );
+                first = childLast;
+            }
+        }
+    }
+};
+//----------------------------------------------------------------------------
+struct FOctreeRayWalker_ : FOctreeData_ {
+    float3 RayOrigin;
+    float3 InvDir;
+    u32 DirMask; // children are visited near to far
+    FLinearOctree::FHitResult Hit;
+
+    FOctreeRayWalker_(const FOctreeData_& data, const FRay& ray, float maxDistance)
+    :   FOctreeData_(data)
+    ,   RayOrigin(ray.Origin())
+    ,   InvDir(SafeRcp_(ray.Direction().x), SafeRcp_(ray.Direction().y), SafeRcp_(ray.Direction().z))
+    ,   DirMask((ray.Direction().x < 0 ? 1u : 0u) | (ray.Direction().y < 0 ? 2u : 0u) | (ray.Direction().z < 0 ? 4u : 0u))
+    ,   Hit{ maxDistance, FLinearOctree::InvalidObject }
+    {}
+
+    void TestObject(const FBoundingBox& bounds, FLinearOctree::FObjectId id) {
+        float t;
+        if (RayIntersectsBox_(RayOrigin, InvDir, bounds, Hit.Distance, &t) && t < Hit.Distance) {
+            Hit.Distance = t;
+            Hit.Object = id;
+        }
+    }
+
+    void Visit(u32 level, u32 x, u32 y, u32 z, u64 morton, u32 first, u32 last) {
+        Assert(first < last);
+
+        if (level > 0) {
+            float tnear;
+            if (not RayIntersectsBox_(RayOrigin, InvDir, LooseBounds_(Origin, FinestCellSize, level, x, y, z), Hit.Distance, &tnear))
+                return;
+        }
+
+        if (Cells[first].Key == MakeCellKey_(morton, level)) {
+            const FLinearOctree::FCell& cell = Cells[first++];
+            forrange(o, cell.FirstObject, cell.FirstObject + cell.NumObjects) {
+                if (FLinearOctree::InvalidObject != SortedIds[o])
+                    TestObject(SortedBounds[o], SortedIds[o]);
+            }
+        }
+
+        if (first == last)
+            return;
+
+        Assert(level < FLinearOctree::MaxLevel);
+        const u32 childShift = 3 * (FLinearOctree::MaxLevel - level - 1);
+        const u32 half = (1u << (FLinearOctree::MaxLevel - level - 1));
+
+        u32 childRanges[9];
+        childRanges[0] = first;
+        forrange(k, 0, 8)
+            childRanges[k + 1] = ChildLast(childRanges[k], last, morton + (u64(k) << childShift), childShift);
+
+        forrange(i, 0, 8) {
+            const u32 k = (i ^ DirMask);
+            if (childRanges[k + 1] > childRanges[k]) {
+                Visit(level + 1,
+                    x + (k & 1) * half, y + ((k >> 1) & 1) * half, z + ((k >> 2) & 1) * half,
+                    morton + (u64(k) << childShift), childRanges[k], childRanges[k + 1] );
+            }
+        }
+    }
+};
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FLinearOctree::FLinearOctree(const FBoundingBox& world)
+:   _world(world) {
+    Assert(_world.HasPositiveExtents());
+
+    const float3 extents = _world.Extents();
+    _worldSize = Max(extents.x, Max(extents.y, extents.z));
+    _origin = _world.Center() - _worldSize * 0.5f;
+    _invFinestCellSize = (static_cast<float>(1u << MaxLevel) / _worldSize);
+}
+//----------------------------------------------------------------------------
+u64 FLinearOctree::MortonCode(u32 x, u32 y, u32 z) NOEXCEPT {
+    return (u64(Part1By2_(x)) | (u64(Part1By2_(y)) << 1) | (u64(Part1By2_(z)) << 2));
+}
+//----------------------------------------------------------------------------
+u64 FLinearOctree::MakeKey(const FBoundingBox& bounds) const NOEXCEPT {
+    const float3 origin = bounds.Min() - _origin;
+    const float3 extents = bounds.Extents();
+    if (origin.x < 0.f || origin.y < 0.f || origin.z < 0.f ||
+        origin.x + extents.x > _worldSize || origin.y + extents.y > _worldSize || origin.z + extents.z > _worldSize )
+        return MakeCellKey_(0, 0);
+
+    // deepest level where the cells are larger than the object: the loose cell around its center contains it
+    const float extent = Max(extents.x, Max(extents.y, extents.z));
+    u32 level = MaxLevel;
+    if (extent * static_cast<float>(1u << MaxLevel) > _worldSize) {
+        const float ratio = (_worldSize / extent);
+        level = (ratio < 1.f ? 0 : FPlatformMaths::FloorLog2(static_cast<u32>(ratio)));
+    }
+
+    const float3 center = (bounds.Center() - _origin) * _invFinestCellSize;
+    CONSTEXPR u32 maxCoord = ((1u << MaxLevel) - 1);
+    const u32 x = Min(static_cast<u32>(center.x), maxCoord);
+    const u32 y = Min(static_cast<u32>(center.y), maxCoord);
+    const u32 z = Min(static_cast<u32>(center.z), maxCoord);
+
+    const u64 cellMask = ~((u64(1) << (3 * (MaxLevel - level))) - 1);
+    return MakeCellKey_(MortonCode(x, y, z) & cellMask, level);
+}
+//----------------------------------------------------------------------------
+FBoundingBox FLinearOctree::LooseCellBounds(u64 key) const NOEXCEPT {
+    const u32 level = KeyLevel(key);
+    if (0 == level)
+        return FBoundingBox(float3(-FLT_MAX), float3(FLT_MAX));
+
+    const u32 morton = checked_cast<u32>(key >> 4);
+    return LooseBounds_(_origin, 1.f / _invFinestCellSize, level,
+        Compact1By2_(morton), Compact1By2_(morton >> 1), Compact1By2_(morton >> 2) );
+}
+//----------------------------------------------------------------------------
+void FLinearOctree::Build(const TMemoryView<const FBoundingBox>& bounds, ITaskContext* context) {
+    Clear();
+    AssertRelease(bounds.size() <= IdMask_);
+
+    _bounds.assign(bounds.begin(), bounds.end());
+    _keys.resize_Uninitialized(bounds.size());
+    _slots.resize_Uninitialized(bounds.size());
+
+    Rebuild_(context);
+}
+//----------------------------------------------------------------------------
+void FLinearOctree::Clear() {
+    _keys.clear();
+    _bounds.clear();
+    _slots.clear();
+    _cells.clear();
+    _sortedIds.clear();
+    _sortedBounds.clear();
+    _pendings.clear();
+}
+//----------------------------------------------------------------------------
+auto FLinearOctree::Add(const FBoundingBox& bounds) -> FObjectId {
+    const FObjectId id = checked_cast<FObjectId>(_keys.size());
+    AssertRelease(id < IdMask_);
+
+    _keys.push_back(MakeKey(bounds));
+    _bounds.push_back(bounds);
+    _slots.push_back(InvalidObject);
+    _pendings.push_back(id);
+    return id;
+}
+//----------------------------------------------------------------------------
+bool FLinearOctree::Move(FObjectId id, const FBoundingBox& bounds) {
+    _bounds[id] = bounds;
+
+    const u64 key = MakeKey(bounds);
+    const u32 slot = _slots[id];
+
+    if (InvalidObject != slot) {
+        // keeps the previous key while the object fits in the loose cell, even if its center left the cell
+        if (_keys[id] == key || (KeyLevel(_keys[id]) == KeyLevel(key) && LooseCellBounds(_keys[id]).Contains(bounds))) {
+            _sortedBounds[slot] = bounds;
+            return true;
+        }
+
+        _sortedIds[slot] = InvalidObject;
+        _slots[id] = InvalidObject;
+        _pendings.push_back(id);
+    }
+
+    _keys[id] = key;
+    return false;
+}
+//----------------------------------------------------------------------------
+void FLinearOctree::Commit(ITaskContext* context) {
+    if (_pendings.empty())
+        return;
+
+    // merging is linear in the number of objects, sorting everything again is faster past some point
+    if (_pendings.size() * 8 > _keys.size())
+        Rebuild_(context);
+    else
+        MergePendings_();
+}
+//----------------------------------------------------------------------------
+void FLinearOctree::Rebuild_(ITaskContext* context) {
+    const size_t n = _bounds.size();
+    const size_t numChunks = ((n + ChunkSize_ - 1) / ChunkSize_);
+
+    VECTOR(Maths, u64) sorted;
+    sorted.resize_Uninitialized(n);
+
+    ParallelFor(0, numChunks, [this, &sorted, n](size_t chunk) {
+        const size_t last = Min(n, (chunk + 1) * ChunkSize_);
+        forrange(id, chunk * ChunkSize_, last) {
+            _keys[id] = MakeKey(_bounds[id]);
+            sorted[id] = ((_keys[id] << IdBits_) | id);
+        }
+    }, ETaskPriority::High, context);
+
+    RadixSort_(sorted, context);
+
+    _sortedIds.clear();
+    _sortedBounds.clear();
+    _sortedIds.resize_Uninitialized(n);
+    _sortedBounds.resize_Uninitialized(n);
+
+    ParallelFor(0, numChunks, [this, &sorted, n](size_t chunk) {
+        const size_t last = Min(n, (chunk + 1) * ChunkSize_);
+        forrange(i, chunk * ChunkSize_, last) {
+            const FObjectId id = checked_cast<FObjectId>(sorted[i] & IdMask_);
+            _sortedIds[i] = id;
+            _sortedBounds[i] = _bounds[id];
+            _slots[id] = checked_cast<u32>(i);
+        }
+    }, ETaskPriority::High, context);
+
+    _pendings.clear();
+    BuildCells_();
+}
+//----------------------------------------------------------------------------
+void FLinearOctree::MergePendings_() {
+    std::sort(_pendings.begin(), _pendings.end(), [this](FObjectId a, FObjectId b) {
+        return (_keys[a] < _keys[b] || (_keys[a] == _keys[b] && a < b));
+    });
+
+    const size_t n = _keys.size();
+    VECTOR(Maths, FObjectId) mergedIds;
+    VECTOR(Maths, FBoundingBox) mergedBounds;
+    mergedIds.reserve(n);
+    mergedBounds.reserve(n);
+
+    const auto append = [&](FObjectId id, const FBoundingBox& bounds) {
+        _slots[id] = checked_cast<u32>(mergedIds.size());
+        mergedIds.push_back(id);
+        mergedBounds.push_back(bounds);
+    };
+
+    size_t p = 0;
+    forrange(i, 0, _sortedIds.size()) {
+        const FObjectId id = _sortedIds[i];
+        if (InvalidObject == id)
+            continue;
+
+        for (; p < _pendings.size() && _keys[_pendings[p]] < _keys[id]; ++p)
+            append(_pendings[p], _bounds[_pendings[p]]);
+
+        append(id, _sortedBounds[i]);
+    }
+    for (; p < _pendings.size(); ++p)
+        append(_pendings[p], _bounds[_pendings[p]]);
+
+    Assert(mergedIds.size() == n);
+    _sortedIds.swap(mergedIds);
+    _sortedBounds.swap(mergedBounds);
+
+    _pendings.clear();
+    BuildCells_();
+}
+//----------------------------------------------------------------------------
+void FLinearOctree::BuildCells_() {
+    _cells.clear();
+
+    forrange(i, 0, checked_cast<u32>(_sortedIds.size())) {
+        const u64 key = _keys[_sortedIds[i]];
+        if (_cells.empty() || _cells.back().Key != key)
+            _cells.push_back(FCell{ key, i, 0 });
+        _cells.back().NumObjects++;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename _Query>
+size_t FLinearOctree::Traverse_(const _Query& query, const onhit_delegate& onHit) const {
+    const FOctreeData_ data{
+        _cells.MakeConstView(), _sortedIds.MakeConstView(), _sortedBounds.MakeConstView(),
+        _origin, 1.f / _invFinestCellSize };
+
+    FOctreeWalker_<_Query> walker{ data, query, onHit };
+
+    if (not _cells.empty())
+        walker.Visit(0, 0, 0, 0, 0, 0, checked_cast<u32>(_cells.size()), query.RootState());
+
+    // objects moved out of their loose cell are not sorted yet
+    for (const FObjectId id : _pendings) {
+        if (query.Object(_bounds[id], query.RootState())) {
+            onHit(MakeView(&id, &id + 1));
+            walker.NumHits++;
+        }
+    }
+
+    return walker.NumHits;
+}
+//----------------------------------------------------------------------------
+size_t FLinearOctree::Intersects(const FBoundingBox& box, const onhit_delegate& onHit) const {
+    return Traverse_(FBoxQuery_{ box }, onHit);
+}
+//----------------------------------------------------------------------------
+size_t FLinearOctree::Intersects(const FSphere& sphere, const onhit_delegate& onHit) const {
+    return Traverse_(FSphereQuery_{ sphere }, onHit);
+}
+//----------------------------------------------------------------------------
+size_t FLinearOctree::Intersects(const FFrustum& frustum, const onhit_delegate& onHit) const {
+    return Traverse_(FFrustumQuery_{ FFrustumCuller{ frustum } }, onHit);
+}
+//----------------------------------------------------------------------------
+bool FLinearOctree::Intersects(const FRay& ray, FHitResult* firstHit, float maxDistance) const {
+    Assert(firstHit);
+
+    const FOctreeData_ data{
+        _cells.MakeConstView(), _sortedIds.MakeConstView(), _sortedBounds.MakeConstView(),
+        _origin, 1.f / _invFinestCellSize };
+
+    FOctreeRayWalker_ walker{ data, ray, maxDistance };
+
+    if (not _cells.empty())
+        walker.Visit(0, 0, 0, 0, 0, 0, checked_cast<u32>(_cells.size()));
+
+    for (const FObjectId id : _pendings)
+        walker.TestObject(_bounds[id], id);
+
+    *firstHit = walker.Hit;
+    return (InvalidObject != walker.Hit.Object);
+}
+//----------------------------------------------------------------------------
+size_t FLinearOctree::BatchIntersects(const TMemoryView<const FBoundingBox>& boxes, const batch_onhit_delegate& onHit, ITaskContext* context) const {
+    return checked_cast<size_t>(ParallelSum(0, boxes.size(), [&](size_t query) -> int {
+        return checked_cast<int>(Intersects(boxes[query], [&onHit, query](const TMemoryView<const FObjectId>& objects) {
+            onHit(query, objects);
+        }));
+    }, ETaskPriority::Normal, context));
+}
+//----------------------------------------------------------------------------
+size_t FLinearOctree::BatchIntersects(const TMemoryView<const FRay>& rays, const TMemoryView<FHitResult>& firstHits, float maxDistance, ITaskContext* context) const {
+    Assert(rays.size() == firstHits.size());
+
+    return checked_cast<size_t>(ParallelSum(0, rays.size(), [&](size_t i) -> int {
+        return (Intersects(rays[i], &firstHits[i], maxDistance) ? 1 : 0);
+    }, ETaskPriority::Normal, context));
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
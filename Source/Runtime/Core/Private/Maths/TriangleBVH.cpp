@@ -0,0 +1,790 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Maths/TriangleBVH.h"
+
+#include "HAL/PlatformMaths.h"
+#include "Maths/Ray.h"
+#include "Maths/ScalarBoundingBoxHelpers.h"
+#include "Maths/ScalarVectorHelpers.h"
+#include "Maths/WideMaths.h"
+#include "Thread/Task/TaskContext.h"
+#include "Thread/Task/TaskHelpers.h"
+
+// https://www.sci.utah.edu/~wald/Publications/2007/ParallelBVHBuild/fastbuild.pdf (binned SAH)
+// https://www.uni-ulm.de/fileadmin/website_uni_ulm/iui.inst.100/institut/Papers/QBVH.pdf (QBVH)
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+CONSTEXPR size_t ParallelBinningThreshold_ = 64 * 1024; // triangles
+CONSTEXPR size_t BinningChunkSize_ = 16 * 1024; // triangles
+CONSTEXPR size_t ParallelRefitThreshold_ = 64 * 1024; // triangles
+CONSTEXPR size_t BatchRaysPerTask_ = 64 * FWideFloat::Lanes;
+CONSTEXPR u32 StackSize_ = FTriangleBVH::MaxDepth * (FTriangleBVH::Arity - 1) + 1;
+// SAH can peel a few triangles per level on valid meshes (geometric falloff of the sizes): deeper nodes use median splits,
+// which divide the triangles by Arity at each level, so 16 levels are enough for 4^16 = 2^32 triangles
+CONSTEXPR u32 MedianSplitDepth_ = FTriangleBVH::MaxDepth - 16;
+// not scaled by the triangle area, unlike Collision::RayIntersectsTriangle() which misses small triangles
+CONSTEXPR float DeterminantEpsilon_ = 1e-12f;
+//----------------------------------------------------------------------------
+FORCE_INLINE static float HalfArea_(const FBoundingBox& box) {
+    const float3 e = box.Extents();
+    return (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+//----------------------------------------------------------------------------
+// Build
+//----------------------------------------------------------------------------
+struct FBVHBin_ {
+    FBoundingBox Bounds;
+    u32 Count{ 0 };
+
+    void Add(const FBVHBin_& other) {
+        Bounds.Add(other.Bounds);
+        Count += other.Count;
+    }
+};
+//----------------------------------------------------------------------------
+struct FBVHBins_ {
+    FBVHBin_ Axis[3][FTriangleBVH::NumBins];
+};
+//----------------------------------------------------------------------------
+struct FBVHRange_ {
+    u32 First, Last;
+    FBoundingBox Bounds; // of the triangles, not of their centroids
+
+    u32 size() const { return (Last - First); }
+};
+//----------------------------------------------------------------------------
+struct FBVHBuilder_ {
+    TMemoryView<const FBoundingBox> PrimBounds;
+    TMemoryView<const float3> Centroids;
+    TMemoryView<u32> PrimIds;
+
+    FBoundingBox CentroidBounds(const FBVHRange_& range) const {
+        FBoundingBox bounds;
+        forrange(i, range.First, range.Last)
+            bounds.Add(Centroids[PrimIds[i]]);
+        return bounds;
+    }
+
+    FBoundingBox PrimitiveBounds(u32 first, u32 last) const {
+        FBoundingBox bounds;
+        forrange(i, first, last)
+            bounds.Add(PrimBounds[PrimIds[i]]);
+        return bounds;
+    }
+
+    static u32 BinIndex(float c, float cmin, float scale) {
+        const i32 bin = static_cast<i32>((c - cmin) * scale);
+        return static_cast<u32>(Min(Max(bin, 0), static_cast<i32>(FTriangleBVH::NumBins) - 1));
+    }
+
+    void BinRange(FBVHBins_* bins, u32 first, u32 last, const float3& cmin, const float3& scale) const {
+        forrange(i, first, last) {
+            const u32 prim = PrimIds[i];
+            const float3& c = Centroids[prim];
+            forrange(axis, 0, 3) {
+                FBVHBin_& bin = bins->Axis[axis][BinIndex(c[axis], cmin[axis], scale[axis])];
+                bin.Bounds.Add(PrimBounds[prim]);
+                bin.Count++;
+            }
+        }
+    }
+
+    // splits range in 2 with the binned SAH, falls back on a median split for degenerate centroids
+    void Split(const FBVHRange_& range, FBVHRange_* left, FBVHRange_* right, ITaskContext* context) const {
+        Assert(range.size() > 1);
+
+        const FBoundingBox centroids = CentroidBounds(range);
+        const float3 extents = centroids.Extents();
+
+        float3 scale;
+        forrange(axis, 0, 3)
+            scale[axis] = (extents[axis] > 0.f ? FTriangleBVH::NumBins / extents[axis] : 0.f);
+
+        FBVHBins_ bins;
+        if (context && range.size() >= ParallelBinningThreshold_) {
+            const size_t numChunks = ((range.size() + BinningChunkSize_ - 1) / BinningChunkSize_);
+            VECTOR(Maths, FBVHBins_) chunks;
+            chunks.resize_AssumeEmpty(numChunks);
+
+            ParallelFor(0, numChunks, [&, this](size_t chunk) {
+                const u32 first = checked_cast<u32>(range.First + chunk * BinningChunkSize_);
+                const u32 last = Min(checked_cast<u32>(first + BinningChunkSize_), range.Last);
+                BinRange(&chunks[chunk], first, last, centroids.Min(), scale);
+            }, ETaskPriority::Normal, context);
+
+            for (const FBVHBins_& chunk : chunks)
+                forrange(axis, 0, 3)
+                    forrange(b, 0, FTriangleBVH::NumBins)
+                        bins.Axis[axis][b].Add(chunk.Axis[axis][b]);
+        }
+        else {
+            BinRange(&bins, range.First, range.Last, centroids.Min(), scale);
+        }
+
+        // sweep the bins from both sides and evaluate the cost of each split plane
+        float bestCost = FLT_MAX;
+        u32 bestAxis = 0, bestBin = 0;
+        FBoundingBox bestLeft, bestRight;
+
+        forrange(axis, 0, 3) {
+            if (scale[axis] == 0.f)
+                continue;
+
+            const FBVHBin_* const axisBins = bins.Axis[axis];
+
+            float rightCosts[FTriangleBVH::NumBins];
+            FBoundingBox rightBounds[FTriangleBVH::NumBins];
+            FBVHBin_ accum;
+            for (u32 b = FTriangleBVH::NumBins - 1; b > 0; --b) {
+                accum.Add(axisBins[b]);
+                rightBounds[b] = accum.Bounds;
+                rightCosts[b] = (accum.Count ? accum.Count * HalfArea_(accum.Bounds) : 0.f);
+            }
+
+            accum = FBVHBin_{};
+            forrange(b, 1, FTriangleBVH::NumBins) {
+                accum.Add(axisBins[b - 1]);
+                if (0 == accum.Count || accum.Count == range.size())
+                    continue;
+
+                const float cost = (accum.Count * HalfArea_(accum.Bounds) + rightCosts[b]);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                    bestLeft = accum.Bounds;
+                    bestRight = rightBounds[b];
+                }
+            }
+        }
+
+        u32* const first = PrimIds.data() + range.First;
+        u32* const last = PrimIds.data() + range.Last;
+        u32* middle;
+
+        if (bestCost < FLT_MAX) {
+            const float cmin = centroids.Min()[bestAxis];
+            const float axisScale = scale[bestAxis];
+            middle = std::partition(first, last, [&](u32 prim) {
+                return (BinIndex(Centroids[prim][bestAxis], cmin, axisScale) < bestBin);
+            });
+        }
+        else {
+            middle = first + range.size() / 2;
+        }
+
+        const u32 split = checked_cast<u32>(middle - PrimIds.data());
+        Assert(split > range.First && split < range.Last);
+
+        *left = FBVHRange_{ range.First, split, FBoundingBox{} };
+        *right = FBVHRange_{ split, range.Last, FBoundingBox{} };
+
+        if (bestCost < FLT_MAX) {
+            left->Bounds = bestLeft;
+            right->Bounds = bestRight;
+        }
+        else {
+            left->Bounds = PrimitiveBounds(left->First, left->Last);
+            right->Bounds = PrimitiveBounds(right->First, right->Last);
+        }
+    }
+
+    // splits range in 2 halves at the median centroid along the largest axis, whatever the SAH cost
+    void SplitMedian(const FBVHRange_& range, FBVHRange_* left, FBVHRange_* right) const {
+        Assert(range.size() > 1);
+
+        const float3 extents = CentroidBounds(range).Extents();
+        u32 axis = 0;
+        if (extents.y > extents[axis]) axis = 1;
+        if (extents.z > extents[axis]) axis = 2;
+
+        const u32 split = (range.First + range.size() / 2);
+        std::nth_element(PrimIds.data() + range.First, PrimIds.data() + split, PrimIds.data() + range.Last,
+            [this, axis](u32 a, u32 b) {
+                return (Centroids[a][axis] < Centroids[b][axis]);
+            });
+
+        *left = FBVHRange_{ range.First, split, PrimitiveBounds(range.First, split) };
+        *right = FBVHRange_{ split, range.Last, PrimitiveBounds(split, range.Last) };
+    }
+
+    // splits the largest child until the node is full or only leaves remain,
+    // median splits pick the child with the most triangles to bound the depth of the tree
+    u32 SplitNode(const FBVHRange_& range, FBVHRange_ (&children)[FTriangleBVH::Arity], bool bMedian, ITaskContext* context) const {
+        u32 numChildren = 1;
+        children[0] = range;
+
+        while (numChildren < FTriangleBVH::Arity) {
+            u32 best = UMax;
+            float bestArea = -1.f;
+            forrange(c, 0, numChildren) {
+                if (children[c].size() <= FTriangleBVH::MaxTrianglesPerLeaf)
+                    continue;
+                const float area = (bMedian ? static_cast<float>(children[c].size()) : HalfArea_(children[c].Bounds));
+                if (area > bestArea) {
+                    bestArea = area;
+                    best = c;
+                }
+            }
+
+            if (UMax == best)
+                break;
+
+            const FBVHRange_ parent = children[best];
+            if (bMedian)
+                SplitMedian(parent, &children[best], &children[numChildren]);
+            else
+                Split(parent, &children[best], &children[numChildren], context);
+            numChildren++;
+        }
+
+        return numChildren;
+    }
+};
+//----------------------------------------------------------------------------
+struct FBVHJob_ {
+    u32 Node;
+    FBVHRange_ Range;
+};
+//----------------------------------------------------------------------------
+struct FBVHJobResult_ {
+    FBVHRange_ Children[FTriangleBVH::Arity];
+    u32 NumChildren;
+};
+//----------------------------------------------------------------------------
+// Traversal
+//----------------------------------------------------------------------------
+struct FRayBoxSetup_ {
+    float3 Origin;
+    float3 InvDir;
+};
+//----------------------------------------------------------------------------
+FORCE_INLINE static float SafeRcp_(float d) {
+    // avoids NaNs in the slab test when the ray is parallel to an axis
+    return (1.f / (Abs(d) > 1e-20f ? d : (d < 0.f ? -1e-20f : 1e-20f)));
+}
+//----------------------------------------------------------------------------
+// slab test of one ray against the 4 children of a node, returns the mask of children hit
+FORCE_INLINE static u32 IntersectChildren_(const FTriangleBVH::FNode& node, const FRayBoxSetup_& ray, float tmax, float (&tnear)[FTriangleBVH::Arity]) {
+#if USE_PPE_WIDE_MATHS
+    const ::__m128 ox = ::_mm_set1_ps(ray.Origin.x);
+    const ::__m128 oy = ::_mm_set1_ps(ray.Origin.y);
+    const ::__m128 oz = ::_mm_set1_ps(ray.Origin.z);
+    const ::__m128 ix = ::_mm_set1_ps(ray.InvDir.x);
+    const ::__m128 iy = ::_mm_set1_ps(ray.InvDir.y);
+    const ::__m128 iz = ::_mm_set1_ps(ray.InvDir.z);
+
+    const ::__m128 t0x = ::_mm_mul_ps(::_mm_sub_ps(::_mm_loadu_ps(node.MinX), ox), ix);
+    const ::__m128 t1x = ::_mm_mul_ps(::_mm_sub_ps(::_mm_loadu_ps(node.MaxX), ox), ix);
+    const ::__m128 t0y = ::_mm_mul_ps(::_mm_sub_ps(::_mm_loadu_ps(node.MinY), oy), iy);
+    const ::__m128 t1y = ::_mm_mul_ps(::_mm_sub_ps(::_mm_loadu_ps(node.MaxY), oy), iy);
+    const ::__m128 t0z = ::_mm_mul_ps(::_mm_sub_ps(::_mm_loadu_ps(node.MinZ), oz), iz);
+    const ::__m128 t1z = ::_mm_mul_ps(::_mm_sub_ps(::_mm_loadu_ps(node.MaxZ), oz), iz);
+
+    const ::__m128 tmin = ::_mm_max_ps(::_mm_max_ps(::_mm_min_ps(t0x, t1x), ::_mm_min_ps(t0y, t1y)), ::_mm_max_ps(::_mm_min_ps(t0z, t1z), ::_mm_setzero_ps()));
+    const ::__m128 tfar = ::_mm_min_ps(::_mm_min_ps(::_mm_max_ps(t0x, t1x), ::_mm_max_ps(t0y, t1y)), ::_mm_min_ps(::_mm_max_ps(t0z, t1z), ::_mm_set1_ps(tmax)));
+
+    ::_mm_storeu_ps(tnear, tmin);
+    return checked_cast<u32>(::_mm_movemask_ps(::_mm_cmple_ps(tmin, tfar)));
+#else
+    u32 mask = 0;
+    forrange(c, 0, FTriangleBVH::Arity) {
+        const float t0x = (node.MinX[c] - ray.Origin.x) * ray.InvDir.x, t1x = (node.MaxX[c] - ray.Origin.x) * ray.InvDir.x;
+        const float t0y = (node.MinY[c] - ray.Origin.y) * ray.InvDir.y, t1y = (node.MaxY[c] - ray.Origin.y) * ray.InvDir.y;
+        const float t0z = (node.MinZ[c] - ray.Origin.z) * ray.InvDir.z, t1z = (node.MaxZ[c] - ray.Origin.z) * ray.InvDir.z;
+        tnear[c] = Max(Max(Min(t0x, t1x), Min(t0y, t1y)), Max(Min(t0z, t1z), 0.f));
+        const float tfar = Min(Min(Max(t0x, t1x), Max(t0y, t1y)), Min(Max(t0z, t1z), tmax));
+        mask |= (tnear[c] <= tfar ? 1u : 0u) << c;
+    }
+    return mask;
+#endif
+}
+//----------------------------------------------------------------------------
+// same as Collision::RayIntersectsTriangle(), with barycentrics and a smaller determinant epsilon
+FORCE_INLINE static bool IntersectTriangle_(const FRay& ray, const float3& v0, const float3& edge1, const float3& edge2, float tmax, float* t, float* u, float* v) {
+    const float3 pvec = Cross(ray.Direction(), edge2);
+    const float det = Dot(edge1, pvec);
+    if (Abs(det) < DeterminantEpsilon_)
+        return false;
+
+    const float invDet = 1.f / det;
+    const float3 tvec = ray.Origin() - v0;
+    const float tu = Dot(tvec, pvec) * invDet;
+    if (tu < 0.f || tu > 1.f)
+        return false;
+
+    const float3 qvec = Cross(tvec, edge1);
+    const float tv = Dot(ray.Direction(), qvec) * invDet;
+    if (tv < 0.f || tu + tv > 1.f)
+        return false;
+
+    const float dist = Dot(edge2, qvec) * invDet;
+    if (dist < 0.f || dist >= tmax)
+        return false;
+
+    *t = dist;
+    *u = tu;
+    *v = tv;
+    return true;
+}
+//----------------------------------------------------------------------------
+struct FStackEntry_ {
+    u32 Node;
+    float TNear;
+};
+//----------------------------------------------------------------------------
+// FWideFloat::Lanes rays in SoA
+struct FRayPacket_ {
+    FWideFloat3 Origin;
+    FWideFloat3 Direction;
+    FWideFloat3 InvDir;
+    FWideFloat TMax;
+    FWideFloat U, V;
+    FWideFloat Triangle; // u32 bits, only moved with Select()
+    u32 Active;
+
+    FRayPacket_(const FRay* rays, u32 numRays, float maxDistance) {
+        Assert(numRays > 0 && numRays <= FWideFloat::Lanes);
+        ALIGN(32) float o[3][FWideFloat::Lanes];
+        ALIGN(32) float d[3][FWideFloat::Lanes];
+        ALIGN(32) float inv[3][FWideFloat::Lanes];
+        forrange(i, 0, FWideFloat::Lanes) {
+            const FRay& ray = rays[Min(i, numRays - 1)]; // replicate the last ray in inactive lanes
+            forrange(axis, 0, 3) {
+                o[axis][i] = ray.Origin()[axis];
+                d[axis][i] = ray.Direction()[axis];
+                inv[axis][i] = SafeRcp_(ray.Direction()[axis]);
+            }
+        }
+
+        Origin = { FWideFloat::LoadAligned(o[0]), FWideFloat::LoadAligned(o[1]), FWideFloat::LoadAligned(o[2]) };
+        Direction = { FWideFloat::LoadAligned(d[0]), FWideFloat::LoadAligned(d[1]), FWideFloat::LoadAligned(d[2]) };
+        InvDir = { FWideFloat::LoadAligned(inv[0]), FWideFloat::LoadAligned(inv[1]), FWideFloat::LoadAligned(inv[2]) };
+        TMax = FWideFloat::Broadcast(maxDistance);
+        U = V = FWideFloat::Zero();
+        Triangle = FWideFloat::Broadcast(std::bit_cast<float>(FTriangleBVH::FHit::NoHit));
+        Active = (numRays == FWideFloat::Lanes ? FWideFloat::AllLanesMask : (1u << numRays) - 1);
+    }
+
+    // returns the mask of lanes hitting the box, and the nearest entry distance among them
+    u32 IntersectBox(const FTriangleBVH::FNode& node, u32 c, float* tnear) const {
+        const FWideFloat t0x = (FWideFloat::Broadcast(node.MinX[c]) - Origin.x) * InvDir.x;
+        const FWideFloat t1x = (FWideFloat::Broadcast(node.MaxX[c]) - Origin.x) * InvDir.x;
+        const FWideFloat t0y = (FWideFloat::Broadcast(node.MinY[c]) - Origin.y) * InvDir.y;
+        const FWideFloat t1y = (FWideFloat::Broadcast(node.MaxY[c]) - Origin.y) * InvDir.y;
+        const FWideFloat t0z = (FWideFloat::Broadcast(node.MinZ[c]) - Origin.z) * InvDir.z;
+        const FWideFloat t1z = (FWideFloat::Broadcast(node.MaxZ[c]) - Origin.z) * InvDir.z;
+
+        const FWideFloat tmin = Max(Max(Min(t0x, t1x), Min(t0y, t1y)), Max(Min(t0z, t1z), FWideFloat::Zero()));
+        const FWideFloat tfar = Min(Min(Max(t0x, t1x), Max(t0y, t1y)), Min(Max(t0z, t1z), TMax));
+
+        const u32 mask = ((tmin <= tfar).MoveMask() & Active);
+        if (mask) {
+            ALIGN(32) float lanes[FWideFloat::Lanes];
+            tmin.StoreAligned(lanes);
+            float nearest = FLT_MAX;
+            for (u32 m = mask; m; m &= m - 1)
+                nearest = Min(nearest, lanes[FPlatformMaths::tzcnt(m)]);
+            *tnear = nearest;
+        }
+        return mask;
+    }
+
+    // same maths than IntersectTriangle_(), for all the lanes at once
+    void IntersectTriangle(const FWideFloat3& v0, const FWideFloat3& edge1, const FWideFloat3& edge2, const FWideFloat& triangle) {
+        const FWideFloat zero = FWideFloat::Zero();
+        const FWideFloat one = FWideFloat::Broadcast(1.f);
+
+        const FWideFloat3 pvec = Cross(Direction, edge2);
+        const FWideFloat det = Dot(edge1, pvec);
+        FWideFloat valid = (Abs(det) >= FWideFloat::Broadcast(DeterminantEpsilon_));
+        if (0 == (valid.MoveMask() & Active))
+            return;
+
+        const FWideFloat invDet = one / det;
+        const FWideFloat3 tvec = Origin - v0;
+        const FWideFloat tu = Dot(tvec, pvec) * invDet;
+        valid = valid & (tu >= zero) & (tu <= one);
+
+        const FWideFloat3 qvec = Cross(tvec, edge1);
+        const FWideFloat tv = Dot(Direction, qvec) * invDet;
+        valid = valid & (tv >= zero) & (tu + tv <= one);
+
+        const FWideFloat dist = Dot(edge2, qvec) * invDet;
+        valid = valid & (dist >= zero) & (dist < TMax);
+
+        if (valid.MoveMask() & Active) {
+            TMax = Select(valid, dist, TMax);
+            U = Select(valid, tu, U);
+            V = Select(valid, tv, V);
+            Triangle = Select(valid, triangle, Triangle);
+        }
+    }
+
+    // lanes still able to hit something at distance tnear
+    u32 ActiveBefore(float tnear) const {
+        return ((FWideFloat::Broadcast(tnear) <= TMax).MoveMask() & Active);
+    }
+};
+//----------------------------------------------------------------------------
+// children hit are pushed far to near, so the nearest is popped first
+FORCE_INLINE static void PushSorted_(FStackEntry_* stack, u32& top, const FStackEntry_* hits, u32 numHits) {
+    FStackEntry_ sorted[FTriangleBVH::Arity];
+    forrange(i, 0, numHits) {
+        u32 j = i;
+        for (; j > 0 && sorted[j - 1].TNear < hits[i].TNear; --j)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = hits[i];
+    }
+    forrange(i, 0, numHits) {
+        Assert(top < StackSize_);
+        stack[top++] = sorted[i];
+    }
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void FTriangleBVH::FNode::SetChildBounds(u32 c, const FBoundingBox& bounds) {
+    MinX[c] = bounds.Min().x; MinY[c] = bounds.Min().y; MinZ[c] = bounds.Min().z;
+    MaxX[c] = bounds.Max().x; MaxY[c] = bounds.Max().y; MaxZ[c] = bounds.Max().z;
+}
+//----------------------------------------------------------------------------
+void FTriangleBVH::Build(const TMemoryView<const float3>& positions, const TMemoryView<const u32>& indices, ITaskContext* context) {
+    Assert(indices.size() % 3 == 0);
+    Clear();
+
+    const u32 numTriangles = checked_cast<u32>(indices.size() / 3);
+    if (0 == numTriangles)
+        return;
+
+    if (nullptr == context)
+        context = GlobalTaskContext();
+
+    VECTOR(Maths, FBoundingBox) primBounds;
+    VECTOR(Maths, float3) centroids;
+    primBounds.resize_AssumeEmpty(numTriangles);
+    centroids.resize_AssumeEmpty(numTriangles);
+    _triangleIds.resize_AssumeEmpty(numTriangles);
+
+    forrange(t, 0, numTriangles) {
+        FBoundingBox& bounds = primBounds[t];
+        bounds = FBoundingBox{};
+        bounds.Add(positions[indices[t * 3 + 0]]);
+        bounds.Add(positions[indices[t * 3 + 1]]);
+        bounds.Add(positions[indices[t * 3 + 2]]);
+        centroids[t] = bounds.Center();
+        _triangleIds[t] = t;
+        _bounds.Add(bounds);
+    }
+
+    const FBVHBuilder_ builder{ primBounds.MakeConstView(), centroids.MakeConstView(), _triangleIds.MakeView() };
+
+    // the tree is built breadth first: the jobs of a level work on disjoint ranges and can run in parallel,
+    // nodes are then allocated sequentially in job order so the layout does not depend on scheduling
+    VECTOR(Maths, FBVHJob_) jobs, nextJobs;
+    VECTOR(Maths, FBVHJobResult_) results;
+
+    _nodes.emplace_back();
+    jobs.push_back(FBVHJob_{ 0, FBVHRange_{ 0, numTriangles, _bounds } });
+
+    for (u32 depth = 0; not jobs.empty(); ++depth) {
+        Assert(depth < MaxDepth);
+        const bool bMedian = (depth >= MedianSplitDepth_);
+
+        results.clear();
+        results.resize_AssumeEmpty(jobs.size());
+
+        if (jobs.size() >= context->WorkerCount()) {
+            ParallelFor(0, jobs.size(), [&](size_t j) {
+                FBVHJobResult_& result = results[j];
+                result.NumChildren = builder.SplitNode(jobs[j].Range, result.Children, bMedian, nullptr);
+            }, ETaskPriority::Normal, context);
+        }
+        else {
+            // few jobs with a lot of triangles: bin each one in parallel instead
+            forrange(j, 0, jobs.size()) {
+                FBVHJobResult_& result = results[j];
+                result.NumChildren = builder.SplitNode(jobs[j].Range, result.Children, bMedian, context);
+            }
+        }
+
+        nextJobs.clear();
+        forrange(j, 0, jobs.size()) {
+            const FBVHJobResult_& result = results[j];
+            const u32 nodeIndex = jobs[j].Node;
+
+            forrange(c, 0, Arity) {
+                FNode& node = _nodes[nodeIndex];
+
+                if (c >= result.NumChildren) {
+                    node.SetChildBounds(c, FBoundingBox::EmptyValue());
+                    node.Child[c] = EmptyChild;
+                    node.NumTriangles[c] = 0;
+                    continue;
+                }
+
+                const FBVHRange_& child = result.Children[c];
+                node.SetChildBounds(c, child.Bounds);
+
+                if (child.size() <= MaxTrianglesPerLeaf) {
+                    node.Child[c] = child.First;
+                    node.NumTriangles[c] = child.size();
+                }
+                else {
+                    const u32 childIndex = checked_cast<u32>(_nodes.size());
+                    node.Child[c] = childIndex;
+                    node.NumTriangles[c] = 0;
+                    nextJobs.push_back(FBVHJob_{ childIndex, child });
+                    _nodes.emplace_back(); // invalidates node
+                }
+            }
+        }
+
+        jobs.swap(nextJobs);
+    }
+
+    // triangles are stored in leaf order
+    _indices.resize_AssumeEmpty(numTriangles * 3);
+    forrange(t, 0, numTriangles) {
+        const u32 src = _triangleIds[t];
+        _indices[t * 3 + 0] = indices[src * 3 + 0];
+        _indices[t * 3 + 1] = indices[src * 3 + 1];
+        _indices[t * 3 + 2] = indices[src * 3 + 2];
+    }
+
+    _triangles.resize_AssumeEmpty(numTriangles);
+    RefitTriangles_(positions, context);
+}
+//----------------------------------------------------------------------------
+void FTriangleBVH::Refit(const TMemoryView<const float3>& positions, ITaskContext* context) {
+    Assert(not empty());
+
+    if (nullptr == context)
+        context = GlobalTaskContext();
+
+    RefitTriangles_(positions, context);
+    RefitNodes_();
+}
+//----------------------------------------------------------------------------
+void FTriangleBVH::Clear() {
+    _nodes.clear_ReleaseMemory();
+    _triangles.clear_ReleaseMemory();
+    _triangleIds.clear_ReleaseMemory();
+    _indices.clear_ReleaseMemory();
+    _bounds = FBoundingBox{};
+}
+//----------------------------------------------------------------------------
+void FTriangleBVH::RefitTriangles_(const TMemoryView<const float3>& positions, ITaskContext* context) {
+    const auto refit = [this, &positions](size_t first, size_t last) {
+        forrange(t, first, last) {
+            const float3& v0 = positions[_indices[t * 3 + 0]];
+            const float3& v1 = positions[_indices[t * 3 + 1]];
+            const float3& v2 = positions[_indices[t * 3 + 2]];
+            _triangles[t] = FTriangle_{ v0, v1 - v0, v2 - v0 };
+        }
+    };
+
+    const size_t n = _triangles.size();
+    if (n < ParallelRefitThreshold_) {
+        refit(0, n);
+    }
+    else {
+        const size_t numChunks = ((n + BinningChunkSize_ - 1) / BinningChunkSize_);
+        ParallelFor(0, numChunks, [&refit, n](size_t chunk) {
+            const size_t first = chunk * BinningChunkSize_;
+            refit(first, Min(first + BinningChunkSize_, n));
+        }, ETaskPriority::Normal, context);
+    }
+}
+//----------------------------------------------------------------------------
+void FTriangleBVH::RefitNodes_() {
+    // children are always allocated after their parent: visit in reverse order to go bottom-up
+    for (size_t i = _nodes.size(); i--; ) {
+        FNode& node = _nodes[i];
+
+        forrange(c, 0, Arity) {
+            if (node.IsEmpty(c))
+                continue;
+
+            FBoundingBox bounds;
+            if (node.IsLeaf(c)) {
+                forrange(t, node.Child[c], node.Child[c] + node.NumTriangles[c]) {
+                    const FTriangle_& tri = _triangles[t];
+                    bounds.Add(tri.V0);
+                    bounds.Add(tri.V0 + tri.Edge1);
+                    bounds.Add(tri.V0 + tri.Edge2);
+                }
+            }
+            else {
+                const FNode& child = _nodes[node.Child[c]];
+                forrange(cc, 0, Arity)
+                    if (not child.IsEmpty(cc))
+                        bounds.Add(child.ChildBounds(cc));
+            }
+
+            node.SetChildBounds(c, bounds);
+        }
+    }
+
+    _bounds = FBoundingBox{};
+    forrange(c, 0, Arity)
+        if (not _nodes[0].IsEmpty(c))
+            _bounds.Add(_nodes[0].ChildBounds(c));
+}
+//----------------------------------------------------------------------------
+template <bool _AnyHit>
+bool FTriangleBVH::Traverse_(const FRay& ray, FHit* hit, float maxDistance) const NOEXCEPT {
+    Assert(hit);
+    hit->Distance = maxDistance;
+    hit->Triangle = FHit::NoHit;
+
+    if (empty())
+        return false;
+
+    const FRayBoxSetup_ setup{ ray.Origin(), float3(SafeRcp_(ray.Direction().x), SafeRcp_(ray.Direction().y), SafeRcp_(ray.Direction().z)) };
+
+    FStackEntry_ stack[StackSize_];
+    u32 top = 0;
+    stack[top++] = FStackEntry_{ 0, 0.f };
+
+    while (top) {
+        const FStackEntry_ entry = stack[--top];
+        if (entry.TNear > hit->Distance)
+            continue;
+
+        const FNode& node = _nodes[entry.Node];
+
+        float tnear[Arity];
+        const u32 mask = IntersectChildren_(node, setup, hit->Distance, tnear);
+
+        FStackEntry_ inner[Arity];
+        u32 numInner = 0;
+
+        for (u32 m = mask; m; m &= m - 1) {
+            const u32 c = FPlatformMaths::tzcnt(m);
+            if (node.IsEmpty(c))
+                continue;
+
+            if (node.IsLeaf(c)) {
+                forrange(t, node.Child[c], node.Child[c] + node.NumTriangles[c]) {
+                    const FTriangle_& tri = _triangles[t];
+                    if (IntersectTriangle_(ray, tri.V0, tri.Edge1, tri.Edge2, hit->Distance, &hit->Distance, &hit->U, &hit->V)) {
+                        hit->Triangle = _triangleIds[t];
+                        IF_CONSTEXPR(_AnyHit)
+                            return true;
+                    }
+                }
+            }
+            else {
+                inner[numInner++] = FStackEntry_{ node.Child[c], tnear[c] };
+            }
+        }
+
+        PushSorted_(stack, top, inner, numInner);
+    }
+
+    return hit->Valid();
+}
+//----------------------------------------------------------------------------
+bool FTriangleBVH::Intersects(const FRay& ray, FHit* firstHit, float maxDistance) const NOEXCEPT {
+    return Traverse_<false>(ray, firstHit, maxDistance);
+}
+//----------------------------------------------------------------------------
+bool FTriangleBVH::Occluded(const FRay& ray, float maxDistance) const NOEXCEPT {
+    FHit hit;
+    return Traverse_<true>(ray, &hit, maxDistance);
+}
+//----------------------------------------------------------------------------
+size_t FTriangleBVH::IntersectsPacket(const TMemoryView<const FRay>& rays, const TMemoryView<FHit>& firstHits, float maxDistance) const NOEXCEPT {
+    Assert(rays.size() == firstHits.size());
+
+    size_t numHits = 0;
+    for (size_t first = 0; first < rays.size(); first += FWideFloat::Lanes) {
+        const u32 numRays = checked_cast<u32>(Min(size_t(FWideFloat::Lanes), rays.size() - first));
+        FRayPacket_ packet{ rays.data() + first, numRays, maxDistance };
+
+        if (not empty()) {
+            FStackEntry_ stack[StackSize_];
+            u32 top = 0;
+            stack[top++] = FStackEntry_{ 0, 0.f };
+
+            while (top) {
+                const FStackEntry_ entry = stack[--top];
+                if (0 == packet.ActiveBefore(entry.TNear))
+                    continue;
+
+                const FNode& node = _nodes[entry.Node];
+
+                FStackEntry_ inner[Arity];
+                u32 numInner = 0;
+
+                forrange(c, 0, Arity) {
+                    if (node.IsEmpty(c))
+                        continue;
+
+                    float tnear;
+                    if (0 == packet.IntersectBox(node, c, &tnear))
+                        continue;
+
+                    if (node.IsLeaf(c)) {
+                        forrange(t, node.Child[c], node.Child[c] + node.NumTriangles[c]) {
+                            const FTriangle_& tri = _triangles[t];
+                            packet.IntersectTriangle(
+                                FWideFloat3::Broadcast(tri.V0),
+                                FWideFloat3::Broadcast(tri.Edge1),
+                                FWideFloat3::Broadcast(tri.Edge2),
+                                FWideFloat::Broadcast(std::bit_cast<float>(_triangleIds[t])) );
+                        }
+                    }
+                    else {
+                        inner[numInner++] = FStackEntry_{ node.Child[c], tnear };
+                    }
+                }
+
+                PushSorted_(stack, top, inner, numInner);
+            }
+        }
+
+        ALIGN(32) float distances[FWideFloat::Lanes], us[FWideFloat::Lanes], vs[FWideFloat::Lanes], triangles[FWideFloat::Lanes];
+        packet.TMax.StoreAligned(distances);
+        packet.U.StoreAligned(us);
+        packet.V.StoreAligned(vs);
+        packet.Triangle.StoreAligned(triangles);
+
+        forrange(i, 0, numRays) {
+            FHit& hit = firstHits[first + i];
+            hit.Distance = distances[i];
+            hit.Triangle = std::bit_cast<u32>(triangles[i]);
+            hit.U = us[i];
+            hit.V = vs[i];
+            numHits += (hit.Valid() ? 1 : 0);
+        }
+    }
+
+    return numHits;
+}
+//----------------------------------------------------------------------------
+size_t FTriangleBVH::BatchIntersects(const TMemoryView<const FRay>& rays, const TMemoryView<FHit>& firstHits, float maxDistance, ITaskContext* context) const {
+    Assert(rays.size() == firstHits.size());
+
+    if (rays.size() <= BatchRaysPerTask_)
+        return IntersectsPacket(rays, firstHits, maxDistance);
+
+    const size_t numTasks = ((rays.size() + BatchRaysPerTask_ - 1) / BatchRaysPerTask_);
+    return checked_cast<size_t>(ParallelSum(0, numTasks, [&](size_t task) -> int {
+        const size_t first = task * BatchRaysPerTask_;
+        const size_t count = Min(BatchRaysPerTask_, rays.size() - first);
+        return checked_cast<int>(IntersectsPacket(rays.SubRange(first, count), firstHits.SubRange(first, count), maxDistance));
+    }, ETaskPriority::Normal, context));
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,315 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Maths/WideMathsHelpers.h"
+
+#include "Maths/Quaternion.h"
+#include "Maths/ScalarMatrix.h"
+#include "Maths/ScalarVector.h"
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+STATIC_ASSERT(sizeof(float3) == 3 * sizeof(float));
+STATIC_ASSERT(sizeof(float4) == 4 * sizeof(float));
+STATIC_ASSERT(sizeof(FQuaternion) == sizeof(float4));
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+#if USE_PPE_WIDE_AVX2 || USE_PPE_WIDE_SSE2
+// [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] -> [x0 x1 x2 x3] [y0 y1 y2 y3] [z0 z1 z2 z3]
+FORCE_INLINE static void GatherFloat3x4_(const float* p, ::__m128& x, ::__m128& y, ::__m128& z) NOEXCEPT {
+    const ::__m128 a = ::_mm_loadu_ps(p + 0);
+    const ::__m128 b = ::_mm_loadu_ps(p + 4);
+    const ::__m128 c = ::_mm_loadu_ps(p + 8);
+
+    x = ::_mm_shuffle_ps(a, ::_mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = ::_mm_shuffle_ps(
+        ::_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+        ::_mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = ::_mm_shuffle_ps(::_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+// inverse of GatherFloat3x4_()
+FORCE_INLINE static void ScatterFloat3x4_(float* p, ::__m128 x, ::__m128 y, ::__m128 z) NOEXCEPT {
+    ::_mm_storeu_ps(p + 0, ::_mm_shuffle_ps(
+        ::_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+        ::_mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+    ::_mm_storeu_ps(p + 4, ::_mm_shuffle_ps(
+        ::_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+        ::_mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+    ::_mm_storeu_ps(p + 8, ::_mm_shuffle_ps(
+        ::_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+        ::_mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE static void GatherFloat4x4_(const float* p, ::__m128& x, ::__m128& y, ::__m128& z, ::__m128& w) NOEXCEPT {
+    x = ::_mm_loadu_ps(p + 0);
+    y = ::_mm_loadu_ps(p + 4);
+    z = ::_mm_loadu_ps(p + 8);
+    w = ::_mm_loadu_ps(p + 12);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+}
+FORCE_INLINE static void ScatterFloat4x4_(float* p, ::__m128 x, ::__m128 y, ::__m128 z, ::__m128 w) NOEXCEPT {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    ::_mm_storeu_ps(p + 0, x);
+    ::_mm_storeu_ps(p + 4, y);
+    ::_mm_storeu_ps(p + 8, z);
+    ::_mm_storeu_ps(p + 12, w);
+}
+#endif
+//----------------------------------------------------------------------------
+#if USE_PPE_WIDE_AVX2
+FORCE_INLINE static ::__m256 Combine_(::__m128 lo, ::__m128 hi) NOEXCEPT {
+    return ::_mm256_insertf128_ps(::_mm256_castps128_ps256(lo), hi, 1);
+}
+FORCE_INLINE static ::__m128 Lo_(::__m256 v) NOEXCEPT { return ::_mm256_castps256_ps128(v); }
+FORCE_INLINE static ::__m128 Hi_(::__m256 v) NOEXCEPT { return ::_mm256_extractf128_ps(v, 1); }
+#endif
+//----------------------------------------------------------------------------
+// full batches run the wide kernel in place, the tail is padded with its last
+// element in a temporary batch, so kernels never see uninitialized lanes
+template <typename _Dst, typename _Src, typename _Kernel>
+static void WideUnary_(const TMemoryView<_Dst>& dst, const TMemoryView<const _Src>& src, _Kernel&& kernel) NOEXCEPT {
+    Assert(dst.size() == src.size());
+    constexpr size_t L = FWideFloat::Lanes;
+
+    const size_t n = src.size();
+    size_t i = 0;
+    for (; i + L <= n; i += L)
+        kernel(dst.data() + i, src.data() + i);
+
+    if (i < n) {
+        _Src tmpSrc[L];
+        _Dst tmpDst[L];
+        forrange(j, 0, L)
+            tmpSrc[j] = src[Min(i + j, n - 1)];
+        kernel(tmpDst, tmpSrc);
+        forrange(j, i, n)
+            dst[j] = tmpDst[j - i];
+    }
+}
+//----------------------------------------------------------------------------
+template <typename _Dst, typename _Lhs, typename _Rhs, typename _Kernel>
+static void WideBinary_(const TMemoryView<_Dst>& dst, const TMemoryView<const _Lhs>& lhs, const TMemoryView<const _Rhs>& rhs, _Kernel&& kernel) NOEXCEPT {
+    Assert(dst.size() == lhs.size());
+    Assert(dst.size() == rhs.size());
+    constexpr size_t L = FWideFloat::Lanes;
+
+    const size_t n = dst.size();
+    size_t i = 0;
+    for (; i + L <= n; i += L)
+        kernel(dst.data() + i, lhs.data() + i, rhs.data() + i);
+
+    if (i < n) {
+        _Lhs tmpLhs[L];
+        _Rhs tmpRhs[L];
+        _Dst tmpDst[L];
+        forrange(j, 0, L) {
+            tmpLhs[j] = lhs[Min(i + j, n - 1)];
+            tmpRhs[j] = rhs[Min(i + j, n - 1)];
+        }
+        kernel(tmpDst, tmpLhs, tmpRhs);
+        forrange(j, i, n)
+            dst[j] = tmpDst[j - i];
+    }
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FWideFloat3 FWideFloat3::Gather(const float3* aos) NOEXCEPT {
+    const float* const p = &aos->x;
+    FWideFloat3 r;
+#if USE_PPE_WIDE_AVX2
+    ::__m128 x0, y0, z0, x1, y1, z1;
+    GatherFloat3x4_(p, x0, y0, z0);
+    GatherFloat3x4_(p + 12, x1, y1, z1);
+    r.x.v = Combine_(x0, x1);
+    r.y.v = Combine_(y0, y1);
+    r.z.v = Combine_(z0, z1);
+#elif USE_PPE_WIDE_SSE2
+    GatherFloat3x4_(p, r.x.v, r.y.v, r.z.v);
+#else
+    forrange(i, 0, FWideFloat::Lanes) {
+        r.x.v.f[i] = p[i * 3 + 0];
+        r.y.v.f[i] = p[i * 3 + 1];
+        r.z.v.f[i] = p[i * 3 + 2];
+    }
+#endif
+    return r;
+}
+//----------------------------------------------------------------------------
+void FWideFloat3::Scatter(float3* aos) const NOEXCEPT {
+    float* const p = &aos->x;
+#if USE_PPE_WIDE_AVX2
+    ScatterFloat3x4_(p, Lo_(x.v), Lo_(y.v), Lo_(z.v));
+    ScatterFloat3x4_(p + 12, Hi_(x.v), Hi_(y.v), Hi_(z.v));
+#elif USE_PPE_WIDE_SSE2
+    ScatterFloat3x4_(p, x.v, y.v, z.v);
+#else
+    forrange(i, 0, FWideFloat::Lanes) {
+        p[i * 3 + 0] = x.v.f[i];
+        p[i * 3 + 1] = y.v.f[i];
+        p[i * 3 + 2] = z.v.f[i];
+    }
+#endif
+}
+//----------------------------------------------------------------------------
+FWideFloat4 FWideFloat4::Gather(const float4* aos) NOEXCEPT {
+    const float* const p = &aos->x;
+    FWideFloat4 r;
+#if USE_PPE_WIDE_AVX2
+    ::__m128 x0, y0, z0, w0, x1, y1, z1, w1;
+    GatherFloat4x4_(p, x0, y0, z0, w0);
+    GatherFloat4x4_(p + 16, x1, y1, z1, w1);
+    r.x.v = Combine_(x0, x1);
+    r.y.v = Combine_(y0, y1);
+    r.z.v = Combine_(z0, z1);
+    r.w.v = Combine_(w0, w1);
+#elif USE_PPE_WIDE_SSE2
+    GatherFloat4x4_(p, r.x.v, r.y.v, r.z.v, r.w.v);
+#else
+    forrange(i, 0, FWideFloat::Lanes) {
+        r.x.v.f[i] = p[i * 4 + 0];
+        r.y.v.f[i] = p[i * 4 + 1];
+        r.z.v.f[i] = p[i * 4 + 2];
+        r.w.v.f[i] = p[i * 4 + 3];
+    }
+#endif
+    return r;
+}
+//----------------------------------------------------------------------------
+void FWideFloat4::Scatter(float4* aos) const NOEXCEPT {
+    float* const p = &aos->x;
+#if USE_PPE_WIDE_AVX2
+    ScatterFloat4x4_(p, Lo_(x.v), Lo_(y.v), Lo_(z.v), Lo_(w.v));
+    ScatterFloat4x4_(p + 16, Hi_(x.v), Hi_(y.v), Hi_(z.v), Hi_(w.v));
+#elif USE_PPE_WIDE_SSE2
+    ScatterFloat4x4_(p, x.v, y.v, z.v, w.v);
+#else
+    forrange(i, 0, FWideFloat::Lanes) {
+        p[i * 4 + 0] = x.v.f[i];
+        p[i * 4 + 1] = y.v.f[i];
+        p[i * 4 + 2] = z.v.f[i];
+        p[i * 4 + 3] = w.v.f[i];
+    }
+#endif
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void TransformPoints(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const float4x4& m) NOEXCEPT {
+    const FWideFloat4x4 wm = FWideFloat4x4::Broadcast(m);
+    WideUnary_(dst, src, [&wm](float3* d, const float3* s) NOEXCEPT {
+        TransformPoint(wm, FWideFloat3::Gather(s)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void TransformVectors(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const float4x4& m) NOEXCEPT {
+    const FWideFloat4x4 wm = FWideFloat4x4::Broadcast(m);
+    WideUnary_(dst, src, [&wm](float3* d, const float3* s) NOEXCEPT {
+        TransformVector(wm, FWideFloat3::Gather(s)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void TransformPoints4(const TMemoryView<float4>& dst, const TMemoryView<const float3>& src, const float4x4& m) NOEXCEPT {
+    const FWideFloat4x4 wm = FWideFloat4x4::Broadcast(m);
+    WideUnary_(dst, src, [&wm](float4* d, const float3* s) NOEXCEPT {
+        TransformPoint4(wm, FWideFloat3::Gather(s)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void RotateVectors(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const FQuaternion& q) NOEXCEPT {
+    const FWideQuaternion wq = FWideQuaternion::Broadcast(q);
+    WideUnary_(dst, src, [&wq](float3* d, const float3* s) NOEXCEPT {
+        wq.Transform(FWideFloat3::Gather(s)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void TransformPointsSoA(const TMemoryView<float>& x, const TMemoryView<float>& y, const TMemoryView<float>& z, const float4x4& m) NOEXCEPT {
+    Assert(x.size() == y.size());
+    Assert(x.size() == z.size());
+    constexpr size_t L = FWideFloat::Lanes;
+
+    const FWideFloat4x4 wm = FWideFloat4x4::Broadcast(m);
+
+    const size_t n = x.size();
+    size_t i = 0;
+    for (; i + L <= n; i += L) {
+        const FWideFloat3 p = TransformPoint(wm, FWideFloat3::Load(x.data() + i, y.data() + i, z.data() + i));
+        p.Store(x.data() + i, y.data() + i, z.data() + i);
+    }
+
+    if (i < n) {
+        const u32 tail = checked_cast<u32>(n - i);
+        const FWideFloat3 p = TransformPoint(wm, FWideFloat3{
+            FWideFloat::LoadPartial(x.data() + i, tail),
+            FWideFloat::LoadPartial(y.data() + i, tail),
+            FWideFloat::LoadPartial(z.data() + i, tail) });
+        p.x.StorePartial(x.data() + i, tail);
+        p.y.StorePartial(y.data() + i, tail);
+        p.z.StorePartial(z.data() + i, tail);
+    }
+}
+//----------------------------------------------------------------------------
+void BatchDot(const TMemoryView<float>& dst, const TMemoryView<const float3>& lhs, const TMemoryView<const float3>& rhs) NOEXCEPT {
+    WideBinary_(dst, lhs, rhs, [](float* d, const float3* a, const float3* b) NOEXCEPT {
+        Dot(FWideFloat3::Gather(a), FWideFloat3::Gather(b)).Store(d);
+    });
+}
+//----------------------------------------------------------------------------
+void BatchCross(const TMemoryView<float3>& dst, const TMemoryView<const float3>& lhs, const TMemoryView<const float3>& rhs) NOEXCEPT {
+    WideBinary_(dst, lhs, rhs, [](float3* d, const float3* a, const float3* b) NOEXCEPT {
+        Cross(FWideFloat3::Gather(a), FWideFloat3::Gather(b)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void BatchNormalize(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) NOEXCEPT {
+    WideUnary_(dst, src, [](float3* d, const float3* s) NOEXCEPT {
+        Normalize(FWideFloat3::Gather(s)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void MultiplyQuaternions(const TMemoryView<FQuaternion>& dst, const TMemoryView<const FQuaternion>& lhs, const TMemoryView<const FQuaternion>& rhs) NOEXCEPT {
+    WideBinary_(dst, lhs, rhs, [](FQuaternion* d, const FQuaternion* a, const FQuaternion* b) NOEXCEPT {
+        (FWideQuaternion::Gather(a) * FWideQuaternion::Gather(b)).Scatter(d);
+    });
+}
+//----------------------------------------------------------------------------
+void AosToSoa(const TMemoryView<float>& x, const TMemoryView<float>& y, const TMemoryView<float>& z, const TMemoryView<const float3>& aos) NOEXCEPT {
+    Assert(x.size() == aos.size());
+    Assert(y.size() == aos.size());
+    Assert(z.size() == aos.size());
+    constexpr size_t L = FWideFloat::Lanes;
+
+    const size_t n = aos.size();
+    size_t i = 0;
+    for (; i + L <= n; i += L)
+        FWideFloat3::Gather(aos.data() + i).Store(x.data() + i, y.data() + i, z.data() + i);
+
+    for (; i < n; ++i) {
+        x[i] = aos[i].x;
+        y[i] = aos[i].y;
+        z[i] = aos[i].z;
+    }
+}
+//----------------------------------------------------------------------------
+void SoaToAos(const TMemoryView<float3>& aos, const TMemoryView<const float>& x, const TMemoryView<const float>& y, const TMemoryView<const float>& z) NOEXCEPT {
+    Assert(x.size() == aos.size());
+    Assert(y.size() == aos.size());
+    Assert(z.size() == aos.size());
+    constexpr size_t L = FWideFloat::Lanes;
+
+    const size_t n = aos.size();
+    size_t i = 0;
+    for (; i + L <= n; i += L)
+        FWideFloat3::Load(x.data() + i, y.data() + i, z.data() + i).Scatter(aos.data() + i);
+
+    for (; i < n; ++i)
+        aos[i] = float3(x[i], y[i], z[i]);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,401 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Misc/OpaqueDocument.h"
+
+#include "Misc/OpaqueBuilder.h"
+
+#include "Container/HashMap.h"
+#include "HAL/PlatformMaths.h"
+#include "HAL/PlatformMemory.h"
+#include "Memory/HashFunctions.h"
+
+namespace PPE {
+namespace Opaq {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// Open addressing table of (index + 1), 0 for empty slots, stored right after
+// the key_value_view of each object. The capacity only depends on the number
+// of keys, so it does not need to be stored in the document.
+//----------------------------------------------------------------------------
+static u32 DocumentIndexCapacity_(size_t numKeys) NOEXCEPT {
+    return (numKeys ? FPlatformMaths::NextPow2(checked_cast<u32>(numKeys) * 2) : 0);
+}
+//----------------------------------------------------------------------------
+static u32 DocumentKeyHash_(FStringView key) NOEXCEPT {
+    // Fingerprint32() is stable across runs, documents can be persisted
+    return Fingerprint32(key.data(), key.SizeInBytes());
+}
+//----------------------------------------------------------------------------
+static TMemoryView<const u32> DocumentIndex_(const object_view& o) NOEXCEPT {
+    STATIC_ASSERT(alignof(key_value_view) >= alignof(u32));
+    return { reinterpret_cast<const u32*>(o.data() + o.size()), DocumentIndexCapacity_(o.size()) };
+}
+//----------------------------------------------------------------------------
+// First pass: deduplicate strings and measure values
+//----------------------------------------------------------------------------
+struct document_layout {
+    HASHMAP(Opaq, FStringView, u32) Strings; // offset in ansi table
+    HASHMAP(Opaq, FWStringView, u32) WStrings; // offset in wide table
+    details::value_block_capacity Values;
+    size_t StringsSize{ 0 };
+    size_t WStringsSize{ 0 };
+    u32 NumObjects{ 0 };
+
+    explicit document_layout(const value_view& root) {
+        Values.Reserve<document_header>(1);
+        std::visit(*this, root);
+    }
+
+    size_t StringsOffset() const NOEXCEPT {
+        return Meta::RoundToNext(*Values.Size, alignof(char));
+    }
+    size_t WStringsOffset() const NOEXCEPT {
+        return Meta::RoundToNext(StringsOffset() + StringsSize * sizeof(char), alignof(wchar_t));
+    }
+    size_t DocumentSize() const NOEXCEPT {
+        return Meta::RoundToNext(WStringsOffset() + WStringsSize * sizeof(wchar_t), alignof(document_header));
+    }
+
+    void Add(FStringView s) {
+        if (not s.empty() && Strings.try_emplace(s, checked_cast<u32>(StringsSize)).second)
+            StringsSize += s.size() + 1/* '\0' */;
+    }
+    void Add(FWStringView s) {
+        if (not s.empty() && WStrings.try_emplace(s, checked_cast<u32>(WStringsSize)).second)
+            WStringsSize += s.size() + 1/* '\0' */;
+    }
+
+    void operator ()(nil) NOEXCEPT {}
+    void operator ()(boolean) NOEXCEPT {}
+    void operator ()(integer) NOEXCEPT {}
+    void operator ()(uinteger) NOEXCEPT {}
+    void operator ()(floating_point) NOEXCEPT {}
+
+    void operator ()(const string_view& v) { Add(FStringView(v.MakeView())); }
+    void operator ()(const wstring_view& v) { Add(FWStringView(v.MakeView())); }
+
+    void operator ()(const array_view& v) {
+        Values.Reserve<value_view>(v.size());
+        for (const value_view& it : v)
+            std::visit(*this, it);
+    }
+    void operator ()(const object_view& v) {
+        Values.Reserve<key_value_view>(v.size());
+        Values.Reserve<u32>(DocumentIndexCapacity_(v.size()));
+        NumObjects++;
+        for (const key_value_view& it : v) {
+            Add(FStringView(it.key.MakeView()));
+            std::visit(*this, it.value);
+        }
+    }
+};
+//----------------------------------------------------------------------------
+// Second pass: write strings once, then inline values and key indices
+//----------------------------------------------------------------------------
+struct document_writer {
+    TPtrRef<const document_layout> Layout;
+    TPtrRef<details::value_block_inliner::slab> Slab;
+    TPtrRef<value_view> Output;
+    const char* Strings;
+    const wchar_t* WStrings;
+
+    void operator ()(nil) const {}
+    void operator ()(boolean v) const { Output->emplace<boolean>(v); }
+    void operator ()(integer v) const { Output->emplace<integer>(v); }
+    void operator ()(uinteger v) const { Output->emplace<uinteger>(v); }
+    void operator ()(floating_point v) const { Output->emplace<floating_point>(v); }
+
+    FStringView Intern(FStringView s) const {
+        return (s.empty() ? FStringView{} : FStringView(Strings + Layout->Strings.at(s), s.size()));
+    }
+    FWStringView Intern(FWStringView s) const {
+        return (s.empty() ? FWStringView{} : FWStringView(WStrings + Layout->WStrings.at(s), s.size()));
+    }
+
+    void operator ()(const string_view& v) const { Output->emplace<string_view>(Intern(FStringView(v.MakeView()))); }
+    void operator ()(const wstring_view& v) const { Output->emplace<wstring_view>(Intern(FWStringView(v.MakeView()))); }
+
+    void operator ()(const array_view& v) const {
+        auto dst = Output->emplace<array_view>(Slab->AllocateView<value_view>(v.size())).begin();
+        for (auto src = v.begin(); src != v.end(); ++src, ++dst)
+            std::visit(document_writer{ Layout, Slab, const_cast<value_view&>(*dst), Strings, WStrings }, *src);
+    }
+
+    void operator ()(const object_view& v) const {
+        const object_view& o = Output->emplace<object_view>(Slab->AllocateView<key_value_view>(v.size()));
+        const TMemoryView<u32> index = Slab->AllocateView<u32>(DocumentIndexCapacity_(v.size()));
+        Assert_NoAssume(DocumentIndex_(o).data() == index.data() || v.empty());
+
+        FPlatformMemory::Memzero(index.data(), index.SizeInBytes());
+
+        u32 keyIndex = 0;
+        auto dst = o.begin();
+        for (auto src = v.begin(); src != v.end(); ++src, ++dst, ++keyIndex) {
+            const FStringView key = Intern(FStringView(src->key.MakeView()));
+            const_cast<string_view&>(dst->key).reset(key);
+
+            // linear probing, duplicate keys are kept but only the first one can be found
+            for (u32 slot = DocumentKeyHash_(key);; ++slot) {
+                u32& it = index[slot & (index.size() - 1)];
+                if (0 == it) {
+                    it = keyIndex + 1;
+                    break;
+                }
+            }
+
+            std::visit(document_writer{ Layout, Slab, const_cast<value_view&>(dst->value), Strings, WStrings }, src->value);
+        }
+    }
+};
+//----------------------------------------------------------------------------
+// Structural checks for untrusted documents: every offset must stay inside the
+// region written by document_writer, nodes can only point forward (no cycles)
+// and the walk is bounded in depth and in number of visited nodes.
+//----------------------------------------------------------------------------
+struct document_validator {
+    STATIC_CONST_INTEGRAL(u32, MaxDepth, 256);
+
+    uintptr_t ValuesBegin; // first byte after the header
+    uintptr_t StringsBegin; // values end where the string tables begin
+    uintptr_t DocumentEnd;
+    size_t NumNodesLeft;
+    u32 NumObjects{ 0 };
+    u32 Depth{ 0 };
+
+    explicit document_validator(const document_header& header) NOEXCEPT
+    :   ValuesBegin(bit_cast<uintptr_t>(&header) + sizeof(document_header))
+    ,   StringsBegin(bit_cast<uintptr_t>(&header) + header.strings_offset)
+    ,   DocumentEnd(bit_cast<uintptr_t>(&header) + header.size_in_bytes)
+    ,   NumNodesLeft(1/* root */ + (StringsBegin - ValuesBegin) / sizeof(value_view))
+    {}
+
+    // returns the number of bytes available for the view, or ~0 if it starts outside of [first, last)
+    template <typename T>
+    static uintptr_t Available_(const TRelativeView<T>& v, uintptr_t first, uintptr_t last) NOEXCEPT {
+        const uintptr_t p = bit_cast<uintptr_t>(v.data());
+        if (not Meta::IsAlignedPow2(alignof(T), p) || p < first || p >= last)
+            return UINTPTR_MAX;
+        return (last - p);
+    }
+
+    template <typename T>
+    bool String_(const TRelativeView<const T>& s) const NOEXCEPT {
+        if (s.empty())
+            return true;
+        const uintptr_t available = Available_(s, StringsBegin, DocumentEnd);
+        return (available != UINTPTR_MAX &&
+            (static_cast<u64>(s.size()) + 1/* '\0' */) * sizeof(T) <= available &&
+            s.data()[s.size()] == T{} );
+    }
+
+    template <typename T>
+    bool Node_(const TRelativeView<const T>& v, size_t extraBytes = 0) const NOEXCEPT {
+        const uintptr_t available = Available_(v, ValuesBegin, StringsBegin);
+        return (available != UINTPTR_MAX &&
+            bit_cast<uintptr_t>(v.data()) > bit_cast<uintptr_t>(&v) &&
+            static_cast<u64>(v.size()) * sizeof(T) + extraBytes <= available );
+    }
+
+    bool Visit(const value_view& v) NOEXCEPT {
+        if (v.valueless_by_exception() ||
+            v.index() >= std::variant_size_v<details::value_view_variant> ||
+            0 == NumNodesLeft-- )
+            return false;
+        return std::visit(*this, v);
+    }
+
+    bool operator ()(nil) const NOEXCEPT { return true; }
+    bool operator ()(boolean) const NOEXCEPT { return true; }
+    bool operator ()(integer) const NOEXCEPT { return true; }
+    bool operator ()(uinteger) const NOEXCEPT { return true; }
+    bool operator ()(floating_point) const NOEXCEPT { return true; }
+
+    bool operator ()(const string_view& v) const NOEXCEPT { return String_(v); }
+    bool operator ()(const wstring_view& v) const NOEXCEPT { return String_(v); }
+
+    bool operator ()(const array_view& v) NOEXCEPT {
+        if (v.empty())
+            return true;
+        if (not Node_(v) || ++Depth > MaxDepth)
+            return false;
+
+        for (const value_view& it : v.MakeView()) {
+            if (not Visit(it))
+                return false;
+        }
+
+        --Depth;
+        return true;
+    }
+
+    bool operator ()(const object_view& v) NOEXCEPT {
+        NumObjects++;
+        if (v.empty())
+            return true;
+        if (not Node_(v) || ++Depth > MaxDepth)
+            return false;
+
+        // the key index follows the key_value_view, at least one slot must be empty or lookups would never end
+        const TMemoryView<const u32> index = DocumentIndex_(v);
+        if (not Node_(v, index.SizeInBytes()))
+            return false;
+
+        bool hasEmptySlot = false;
+        for (const u32 it : index) {
+            if (it > v.size())
+                return false;
+            hasEmptySlot |= (0 == it);
+        }
+        if (not hasEmptySlot)
+            return false;
+
+        for (const key_value_view& it : v.MakeView()) {
+            if (not String_(it.key) || not Visit(it.value))
+                return false;
+        }
+
+        --Depth;
+        return true;
+    }
+};
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+Meta::TOptional<document_view> document_view::Attach(FRawMemoryConst data) NOEXCEPT {
+    if (data.SizeInBytes() < sizeof(document_header) ||
+        not Meta::IsAlignedPow2(alignof(document_header), data.data()) )
+        return Meta::TOptional<document_view>{};
+
+    const document_header& header = *reinterpret_cast<const document_header*>(data.data());
+    if (header.magic != document_header::Magic ||
+        header.version != document_header::Version ||
+        header.abi != document_header::ABI ||
+        header.size_in_bytes < sizeof(document_header) ||
+        header.size_in_bytes > data.SizeInBytes() ||
+        header.strings_offset > header.size_in_bytes )
+        return Meta::TOptional<document_view>{};
+
+    return document_view{ &header };
+}
+//----------------------------------------------------------------------------
+bool document_view::Validate() const NOEXCEPT {
+    if (header->size_in_bytes < sizeof(document_header) ||
+        header->strings_offset < sizeof(document_header) ||
+        header->strings_offset > header->size_in_bytes )
+        return false;
+
+    const FRawMemoryConst content = MakeView().CutStartingAt(sizeof(document_header));
+    if (Fingerprint32(content.data(), content.SizeInBytes()) != header->fingerprint)
+        return false;
+
+    // the fingerprint only detects accidental corruption, offsets are still untrusted
+    document_validator validator{ *header };
+    return (validator.Visit(header->root) && validator.NumObjects == header->num_objects);
+}
+//----------------------------------------------------------------------------
+size_t DocumentSize(const value_view& view) {
+    return document_layout{ view }.DocumentSize();
+}
+//----------------------------------------------------------------------------
+document_block NewDocument(FAllocatorBlock alloc, const value_view& view) {
+    const document_layout layout{ view };
+    AssertRelease(layout.DocumentSize() <= alloc.SizeInBytes);
+
+    details::value_block_inliner::slab slab{ alloc };
+    // header is embedded in block: TRelativeView<> can't be copied/moved!
+    document_header& header = *INPLACE_NEW(slab.AllocateView<document_header>(1).data(), document_header);
+    header.magic = document_header::Magic;
+    header.version = document_header::Version;
+    header.abi = document_header::ABI;
+    header.size_in_bytes = checked_cast<u32>(layout.DocumentSize());
+    header.num_strings = checked_cast<u32>(layout.Strings.size() + layout.WStrings.size());
+    header.num_objects = layout.NumObjects;
+    header.strings_offset = checked_cast<u32>(layout.StringsOffset());
+    header.fingerprint = 0;
+
+    // string tables are written first, so values can reference them while inlined
+    char* const strings = reinterpret_cast<char*>(static_cast<u8*>(alloc.Data) + layout.StringsOffset());
+    for (const auto& it : layout.Strings) {
+        FPlatformMemory::Memcpy(strings + it.second, it.first.data(), it.first.SizeInBytes());
+        strings[it.second + it.first.size()] = '\0';
+    }
+
+    wchar_t* const wstrings = reinterpret_cast<wchar_t*>(static_cast<u8*>(alloc.Data) + layout.WStringsOffset());
+    for (const auto& it : layout.WStrings) {
+        FPlatformMemory::Memcpy(wstrings + it.second, it.first.data(), it.first.SizeInBytes());
+        wstrings[it.second + it.first.size()] = L'\0';
+    }
+
+    std::visit(document_writer{ layout, slab, header.root, strings, wstrings }, view);
+    Assert_NoAssume(slab.OffsetInBlock == *layout.Values.Size);
+
+    // padding must be deterministic for the fingerprint (and for diffing documents on disk)
+    FPlatformMemory::Memzero(static_cast<u8*>(alloc.Data) + slab.OffsetInBlock, layout.StringsOffset() - slab.OffsetInBlock);
+    FPlatformMemory::Memzero(
+        static_cast<u8*>(alloc.Data) + layout.StringsOffset() + layout.StringsSize,
+        layout.WStringsOffset() - (layout.StringsOffset() + layout.StringsSize) );
+    FPlatformMemory::Memzero(
+        static_cast<u8*>(alloc.Data) + layout.WStringsOffset() + layout.WStringsSize * sizeof(wchar_t),
+        layout.DocumentSize() - (layout.WStringsOffset() + layout.WStringsSize * sizeof(wchar_t)) );
+
+    const document_view doc{ &header };
+    const FRawMemoryConst content = doc.MakeView().CutStartingAt(sizeof(document_header));
+    header.fingerprint = Fingerprint32(content.data(), content.SizeInBytes());
+    Assert_NoAssume(doc.Validate());
+
+    return { alloc };
+}
+//----------------------------------------------------------------------------
+Meta::TOptional<TPtrRef<const value_view>> XPath(const document_view& doc, const object_view& o, FStringView key) NOEXCEPT {
+    Assert(doc);
+    Assert_NoAssume(o.empty() || doc.Contains(o.data()));
+    Unused(doc);
+
+    const TMemoryView<const u32> index = DocumentIndex_(o);
+    if (not index.empty()) {
+        for (u32 slot = DocumentKeyHash_(key);; ++slot) {
+            const u32 it = index[slot & (index.size() - 1)];
+            if (0 == it)
+                break;
+
+            const key_value_view& kv = o.at(it - 1);
+            if (kv.key == key)
+                return kv.value;
+        }
+    }
+
+    return Meta::TOptional<TPtrRef<const value_view>>{};
+}
+//----------------------------------------------------------------------------
+Meta::TOptional<TPtrRef<const value_view>> XPath(const document_view& doc, std::initializer_list<FStringView> path) NOEXCEPT {
+    TPtrRef<const value_view> node{ &doc.Root() };
+
+    for (const FStringView& key : path) {
+        const Meta::TOptionalReference<const object_view> obj{ std::get_if<object_view>(node.get()) };
+        if (not obj)
+            return Meta::TOptional<TPtrRef<const value_view>>{};
+
+        const Meta::TOptional<TPtrRef<const value_view>> child = XPath(doc, *obj, key);
+        if (not child.has_value())
+            return Meta::TOptional<TPtrRef<const value_view>>{};
+
+        node = *child;
+    }
+
+    return node;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FTextWriter& operator <<(FTextWriter& oss, const document_view& v) { return oss << v.Root(); }
+FWTextWriter& operator <<(FWTextWriter& oss, const document_view& v) { return oss << v.Root(); }
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace Opaq
+} //!namespace PPE
@@ -150,6 +150,12 @@ size_t FProcess::WriteStdin(const FRawMemoryConst& buffer) {
     return FPlatformProcess::WritePipe(_hStdinWrite, buffer);
 }
 //----------------------------------------------------------------------------
+void FProcess::CloseStdin() {
+    Assert(_hStdinWrite);
+    FPlatformProcess::ClosePipe(nullptr, _hStdinWrite);
+    _hStdinWrite = nullptr;
+}
+//----------------------------------------------------------------------------
 size_t FProcess::ReadStderr(const FRawMemory& buffer) {
     Assert(_hStderrRead);
     return ReadPipe_(buffer, _hStderrRead);
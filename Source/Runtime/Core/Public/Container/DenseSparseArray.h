@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Core_fwd.h"
+
+#include "Container/SparseArray.h"
+#include "Container/Vector.h"
+#include "Memory/MemoryView.h"
+
+#define DENSESPARSEARRAY(_DOMAIN, T) \
+    ::PPE::TDenseSparseArray< COMMA_PROTECT(T), ALLOCATOR(_DOMAIN) >
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Dense companion of TSparseArray<>, for hot loops iterating all the items:
+// - items are packed in a vector, iterations are linear and never see a hole
+// - ids stay valid until removed, a sparse array maps them to the dense index
+// - removal moves the last item in the hole, so pointers to items are NOT stable
+//----------------------------------------------------------------------------
+template <typename T, typename _Allocator = ALLOCATOR(Container) >
+class TDenseSparseArray {
+public:
+    using FDataId = FSparseDataId;
+
+    using dense_type = TVector<T, _Allocator>;
+    using indices_type = TSparseArray<u32, _Allocator>;
+    using ids_type = TVector<FDataId, _Allocator>;
+
+    using value_type = T;
+    using pointer = Meta::TAddPointer<T>;
+    using const_pointer = Meta::TAddPointer<Meta::TAddConst<T>>;
+    using reference = Meta::TAddReference<T>;
+    using const_reference = Meta::TAddReference<Meta::TAddConst<T>>;
+
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using iterator = typename dense_type::iterator;
+    using const_iterator = typename dense_type::const_iterator;
+
+    TDenseSparseArray() = default;
+
+    TDenseSparseArray(const TDenseSparseArray&) = default;
+    TDenseSparseArray& operator =(const TDenseSparseArray&) = default;
+
+    TDenseSparseArray(TDenseSparseArray&&) = default;
+    TDenseSparseArray& operator =(TDenseSparseArray&&) = default;
+
+    NODISCARD size_type size() const { return _dense.size(); }
+    NODISCARD bool empty() const { return _dense.empty(); }
+    NODISCARD size_type capacity() const { return _dense.capacity(); }
+
+    NODISCARD iterator begin() { return _dense.begin(); }
+    NODISCARD iterator end() { return _dense.end(); }
+
+    NODISCARD const_iterator begin() const { return _dense.begin(); }
+    NODISCARD const_iterator end() const { return _dense.end(); }
+
+    NODISCARD TMemoryView<T> MakeView() const { return _dense.MakeView(); }
+    NODISCARD TMemoryView<const T> MakeConstView() const { return _dense.MakeConstView(); }
+
+    // ids of the items, in the same order than MakeView()
+    NODISCARD TMemoryView<const FDataId> Ids() const { return _ids.MakeConstView(); }
+
+    // returns nullptr for stale ids, even after Clear() or on an empty container
+    NODISCARD pointer Find(FDataId id) {
+        const u32* const index = FindIndex_(id);
+        return (index ? &_dense[*index] : nullptr);
+    }
+    NODISCARD const_pointer Find(FDataId id) const {
+        return const_cast<TDenseSparseArray*>(this)->Find(id);
+    }
+
+    template <typename... _Args>
+    FDataId Emplace(_Args&&... args) {
+        const u32 index = checked_cast<u32>(_dense.size());
+        _dense.emplace_back(std::forward<_Args>(args)...);
+
+        const FDataId id = _indices.Emplace(index);
+        _ids.push_back(id);
+
+        return id;
+    }
+
+    // bulk insertion of ids.size() items constructed with the same arguments, the storage grows only once
+    template <typename... _Args>
+    void EmplaceN(const TMemoryView<FDataId>& ids, const _Args&... args) {
+        const u32 first = checked_cast<u32>(_dense.size());
+        Reserve(first + ids.size());
+
+        _indices.EmplaceN(ids, 0);
+
+        u32 index = first;
+        for (FDataId id : ids) {
+            *_indices.Find(id) = index++;
+            _dense.emplace_back_AssumeNoGrow(args...);
+            _ids.emplace_back_AssumeNoGrow(id);
+        }
+    }
+
+    // moves the last item in the hole, returns false if the id was not valid
+    bool Remove(FDataId id) {
+        const u32* const pindex = FindIndex_(id);
+        if (nullptr == pindex)
+            return false;
+
+        const u32 index = *pindex;
+        Verify(_indices.Remove(id));
+
+        const u32 last = checked_cast<u32>(_dense.size() - 1);
+        if (index != last) {
+            _dense[index] = std::move(_dense[last]);
+            _ids[index] = _ids[last];
+            *_indices.Find(_ids[index]) = index;
+        }
+
+        _dense.pop_back();
+        _ids.pop_back();
+
+        return true;
+    }
+
+    // bulk removal, invalid ids are ignored, returns the number of items removed
+    size_type RemoveN(const TMemoryView<const FDataId>& ids) {
+        size_type numDeleted = 0;
+        for (FDataId id : ids)
+            numDeleted += (Remove(id) ? 1 : 0);
+        return numDeleted;
+    }
+
+    void Reserve(size_t n) {
+        _dense.reserve(n);
+        _ids.reserve(n);
+        _indices.Reserve(n);
+    }
+
+    void Clear() {
+        _dense.clear();
+        _ids.clear();
+        _indices.Clear();
+    }
+
+    void Clear_ReleaseMemory() {
+        _dense.clear_ReleaseMemory();
+        _ids.clear_ReleaseMemory();
+        _indices.Clear_ReleaseMemory();
+    }
+
+    // O(n), checks all the ids map to their dense index
+    NODISCARD bool CheckInvariants() const {
+#if USE_PPE_ASSERT
+        if (_dense.size() != _ids.size() || _dense.size() != _indices.size())
+            return false;
+        forrange(i, 0, _ids.size()) {
+            const u32* const index = _indices.Find(_ids[i]);
+            if (nullptr == index || i != *index)
+                return false;
+        }
+#endif
+        return true;
+    }
+
+private:
+    // TSparseArray::Find() expects an id in range, stale ids can point past the slots after Clear()
+    const u32* FindIndex_(FDataId id) const {
+        if (indices_type::Nth(id) >= _indices.HighestIndex())
+            return nullptr;
+        return _indices.Find(id);
+    }
+
+    dense_type _dense;
+    ids_type _ids;
+    indices_type _indices;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
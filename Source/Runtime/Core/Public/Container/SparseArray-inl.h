@@ -14,6 +14,8 @@ TBasicSparseArray<T>::TBasicSparseArray() NOEXCEPT
 ,   _uniqueKey(0)
 ,   _numChunks(0)
 ,   _chunks(nullptr)
+,   _occupancy(nullptr)
+,   _inlineOccupancy(0)
 {}
 //----------------------------------------------------------------------------
 template <typename T>
@@ -35,6 +37,7 @@ auto TBasicSparseArray<T>::operator =(TBasicSparseArray&& rvalue) NOEXCEPT -> TB
     Assert(0 == _uniqueKey);
     Assert(0 == _numChunks);
     Assert(nullptr == _chunks);
+    Assert(nullptr == _occupancy);
 
     Swap(rvalue);
 
@@ -132,6 +135,12 @@ void TBasicSparseArray<T>::Swap(TBasicSparseArray& other) NOEXCEPT {
 #else
     FPlatformMemory::Memswap(this, &other, sizeof(*this));
 #endif
+
+    // the inline occupancy word was swapped with everything else, pointers to it must follow
+    if (_occupancy == &other._inlineOccupancy)
+        _occupancy = &_inlineOccupancy;
+    if (other._occupancy == &_inlineOccupancy)
+        other._occupancy = &other._inlineOccupancy;
 }
 //----------------------------------------------------------------------------
 template <typename T>
@@ -144,6 +153,10 @@ bool TBasicSparseArray<T>::CheckInvariants() const {
         return false;
     if ((!_numChunks) ^ (!_chunks))
         return false;
+    if ((!_numChunks) ^ (!_occupancy))
+        return false;
+    if (_numChunks && (OccupancyWords_(ckOffset_(_numChunks)) <= 1) != (_occupancy == &_inlineOccupancy))
+        return false;
     if (_freeIndex != InvalidIndex && _freeIndex >= _highestIndex)
         return false;
 
@@ -183,6 +196,40 @@ bool TBasicSparseArray<T>::AliasesToContainer(const_iterator it) const {
 }
 //----------------------------------------------------------------------------
 template <typename T>
+template <typename _Each>
+void TBasicSparseArray<T>::EachInRange(size_t first, size_t last, _Each&& each) {
+    Assert(first <= last);
+    Assert(last <= _highestIndex);
+    Assert_NoAssume(CheckInvariants());
+
+    for (size_t w = first / OccupancyBits; w * OccupancyBits < last; ++w) {
+        const size_t off = w * OccupancyBits;
+
+        u64 bits = _occupancy[w];
+        if (off < first)
+            bits &= (UINT64_MAX << (first - off));
+        if (off + OccupancyBits > last)
+            bits &= (UINT64_MAX >> (off + OccupancyBits - last));
+
+        if (0 == bits)
+            continue;
+
+        // every chunk after the first 64 slots is larger than 64 slots and aligned on 64 slots
+        if (off) {
+            FDataItem* const items = At_(off);
+            Assert_NoAssume(ckIndex_(off) == ckIndex_(off + OccupancyBits - 1));
+
+            for (; bits; bits &= bits - 1)
+                each(items[FPlatformMaths::tzcnt(bits)].Data);
+        }
+        else {
+            for (; bits; bits &= bits - 1)
+                each(At_(FPlatformMaths::tzcnt(bits))->Data);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename T>
 auto TBasicSparseArray<T>::At_(size_t index) -> FDataItem* {
     Assert(index < _highestIndex); // out-of-bounds
     Assert_NoAssume(index < capacity());
@@ -231,14 +278,27 @@ auto TSparseArrayIterator<T>::GotoFirstItem_() -> TSparseArrayIterator& {
     Assert(_owner);
     Assert(_index <= _owner->_highestIndex);
 
-    for (;;) {
-        if (_index == _owner->_highestIndex ||
-            not FSparseArray::UnpackId_(_owner->At_(_index)->Id).empty())
-            break;
+    const size_t highestIndex = _owner->_highestIndex;
+    if (_index == highestIndex)
+        return (*this);
+
+    // skips holes with the occupancy mask, instead of testing every item
+    const u64* const occupancy = _owner->_occupancy;
+    size_t w = _index / FSparseArray::OccupancyBits;
+    u64 bits = (occupancy[w] & (UINT64_MAX << (_index % FSparseArray::OccupancyBits)));
 
-        ++_index;
+    while (0 == bits) {
+        if (++w * FSparseArray::OccupancyBits >= highestIndex) {
+            _index = highestIndex;
+            return (*this);
+        }
+        bits = occupancy[w];
     }
 
+    _index = (w * FSparseArray::OccupancyBits + FPlatformMaths::tzcnt(bits));
+    Assert(_index < highestIndex); // slots after _highestIndex are never marked
+    Assert_NoAssume(not FSparseArray::UnpackId_(_owner->At_(_index)->Id).empty());
+
     return (*this);
 }
 //----------------------------------------------------------------------------
@@ -338,6 +398,23 @@ auto TSparseArray<T, _Allocator>::EmplaceIt(_Args&&... args) -> iterator {
 }
 //----------------------------------------------------------------------------
 template <typename T, typename _Allocator>
+template <typename... _Args>
+void TSparseArray<T, _Allocator>::EmplaceN(const TMemoryView<FDataId>& ids, const _Args&... args) {
+    Assert_NoAssume(CheckInvariants());
+
+    Reserve(_size + ids.size());
+
+    for (FDataId& id : ids) {
+        const FUnpackedId_ unpacked = AllocateItem_();
+        Assert(not unpacked.empty());
+
+        FDataItem* const it = At_(unpacked.Index);
+        it->Id = id = PackId_(unpacked);
+        Meta::Construct(&it->Data, args...);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename T, typename _Allocator>
 void TSparseArray<T, _Allocator>::Assign(const TSparseArray& other) {
     Clear_ReleaseMemory();
 
@@ -406,6 +483,29 @@ void TSparseArray<T, _Allocator>::Remove(reference data) {
 }
 //----------------------------------------------------------------------------
 template <typename T, typename _Allocator>
+auto TSparseArray<T, _Allocator>::RemoveN(const TMemoryView<const FDataId>& ids) -> size_type {
+    Assert_NoAssume(CheckInvariants());
+
+    size_type numDeleted = 0;
+    for (const FDataId id : ids) {
+        const FUnpackedId_ unpacked = UnpackId_(id);
+        Assert(not unpacked.empty());
+
+        if (unpacked.Index >= _highestIndex)
+            continue;
+
+        FDataItem* const it = At_(unpacked.Index);
+        if (it->Id != id)
+            continue; // weak ref is invalid, or the same id was given twice
+
+        ReleaseItem_(unpacked, it);
+        numDeleted++;
+    }
+
+    return numDeleted;
+}
+//----------------------------------------------------------------------------
+template <typename T, typename _Allocator>
 template <typename _Pred>
 auto TSparseArray<T, _Allocator>::RemoveIf(_Pred pred) -> size_type {
     Assert_NoAssume(CheckInvariants());
@@ -426,11 +526,13 @@ template <typename T, typename _Allocator>
 void TSparseArray<T, _Allocator>::Clear() {
     Assert_NoAssume(CheckInvariants());
 
-    forrange(i, 0, _highestIndex) {
-        FDataItem* const it = At_(i);
+    // only visit allocated slots, ReleaseItem_() clears the occupancy bits
+    forrange(w, 0, OccupancyWords_(_highestIndex)) {
+        for (u64 bits = _occupancy[w]; bits; bits &= bits - 1) {
+            FDataItem* const it = At_(w * OccupancyBits + FPlatformMaths::tzcnt(bits));
 
-        const FUnpackedId_ unpacked = UnpackId_(it->Id);
-        if (not unpacked.empty()) {
+            const FUnpackedId_ unpacked = UnpackId_(it->Id);
+            Assert(not unpacked.empty());
             Assert(unpacked.Index < _highestIndex);
             ReleaseItem_(unpacked, it);
         }
@@ -455,6 +557,7 @@ void TSparseArray<T, _Allocator>::Clear_ReleaseMemory() {
         _uniqueKey = 0;
         _numChunks = 0;
         _chunks = nullptr;
+        _occupancy = nullptr;
     }
 }
 //----------------------------------------------------------------------------
@@ -467,6 +570,7 @@ void TSparseArray<T, _Allocator>::Reserve(size_t n) {
 
     const size_t cls = ckIndex_(n - 1);
     if (cls >= _numChunks) {
+        const size_t oldCapacity = capacity();
         const size_t csz = ckSize_(cls) - ckOffset_(_numChunks);
 
         auto* const newChunk= static_cast<FDataItem*>(allocator_traits::Allocate(*this, csz * sizeof(FDataItem)).Data);
@@ -474,6 +578,7 @@ void TSparseArray<T, _Allocator>::Reserve(size_t n) {
         if ((!_numChunks) & (!cls)) {
             _numChunks = 1;
             reinterpret_cast<FDataItem*&>(_chunks) = newChunk;
+            GrowOccupancy_(oldCapacity);
             return;
         }
 
@@ -509,6 +614,7 @@ void TSparseArray<T, _Allocator>::Reserve(size_t n) {
 
         _chunks = aliased.data();
         _numChunks = checked_cast<u16>(aliased.size());
+        GrowOccupancy_(oldCapacity);
 
         Assert_NoAssume(CheckInvariants());
     }
@@ -536,6 +642,8 @@ auto TSparseArray<T, _Allocator>::AllocateItem_() -> FUnpackedId_ {
         ? _highestIndex++ // use uninitialized block instead of free list IFP
         : GrabFirstFreeBlock_() );
 
+    _occupancy[index / OccupancyBits] |= (u64(1) << (index % OccupancyBits));
+
     return FUnpackedId_{
 #ifdef PLATFORM_BIGENDIAN // so when Key == 0 we can use Index as a valid size_t
         key, index
@@ -558,6 +666,8 @@ void TSparseArray<T, _Allocator>::ReleaseItem_(FUnpackedId_ id, FDataItem* it) {
     const size_t oldIndex = id.Index;
     Assert_NoAssume(PackId_(id) == it->Id); // check ref validity
 
+    _occupancy[oldIndex / OccupancyBits] &= ~(u64(1) << (oldIndex % OccupancyBits));
+
     // try sorting by ascending index order to keep the container packed
     if (_freeIndex < oldIndex) {
         Assert(InvalidIndex != _freeIndex);
@@ -581,6 +691,7 @@ void TSparseArray<T, _Allocator>::ReleaseItem_(FUnpackedId_ id, FDataItem* it) {
 template <typename T, typename _Allocator>
 NO_INLINE void TSparseArray<T, _Allocator>::GrabNewChunk_(size_t cls) {
     const size_t sz = ckAllocation_(cls);
+    const size_t oldCapacity = capacity();
 
     FDataChunkRef newChunk;
     newChunk.Reset(static_cast<FDataItem*>(allocator_traits::Allocate(*this, sz * sizeof(FDataItem)).Data), true/* should be deleted */);
@@ -591,6 +702,7 @@ NO_INLINE void TSparseArray<T, _Allocator>::GrabNewChunk_(size_t cls) {
 
         _numChunks++; // don't allocate for the first chunk, pack ptr* in ptr**
         reinterpret_cast<FDataItem*&>(_chunks) = newChunk.Get();
+        GrowOccupancy_(oldCapacity);
 
         return;
     }
@@ -612,6 +724,7 @@ NO_INLINE void TSparseArray<T, _Allocator>::GrabNewChunk_(size_t cls) {
     }
 
     _chunks[_numChunks++] = newChunk;
+    GrowOccupancy_(oldCapacity);
 
     Assert_NoAssume(CheckInvariants());
 }
@@ -636,6 +749,45 @@ void TSparseArray<T, _Allocator>::ReleaseChunk_(FDataItem* chunk, size_t off, si
 }
 //----------------------------------------------------------------------------
 template <typename T, typename _Allocator>
+void TSparseArray<T, _Allocator>::GrowOccupancy_(size_t oldCapacity) {
+    const size_t oldWords = OccupancyWords_(oldCapacity);
+    const size_t newWords = OccupancyWords_(capacity());
+    if (oldWords == newWords)
+        return;
+
+    // the first word is stored inline, see TSparseArrayInlineAllocator
+    if (newWords == 1) {
+        Assert(0 == oldWords);
+        _inlineOccupancy = 0;
+        _occupancy = &_inlineOccupancy;
+        return;
+    }
+
+    if (oldWords <= 1) {
+        u64* const words = allocator_traits::template AllocateT<u64>(*this, newWords).data();
+        words[0] = (oldWords ? _inlineOccupancy : 0);
+        _occupancy = words;
+    }
+    else {
+        TMemoryView<u64> aliased{ _occupancy, oldWords };
+        ReallocateAllocatorBlock_AssumePOD(allocator_traits::Get(*this), aliased, oldWords, newWords);
+        _occupancy = aliased.data();
+    }
+
+    const size_t firstNewWord = Max(oldWords, size_t(1));
+    FPlatformMemory::Memzero(_occupancy + firstNewWord, (newWords - firstNewWord) * sizeof(u64));
+}
+//----------------------------------------------------------------------------
+template <typename T, typename _Allocator>
+void TSparseArray<T, _Allocator>::ReleaseOccupancy_() {
+    const size_t numWords = OccupancyWords_(capacity());
+    if (numWords > 1)
+        allocator_traits::DeallocateT(*this, _occupancy, numWords);
+    else
+        Assert(_occupancy == &_inlineOccupancy);
+}
+//----------------------------------------------------------------------------
+template <typename T, typename _Allocator>
 void TSparseArray<T, _Allocator>::ClearReleaseMemory_LeaveDirty_() {
     Assert_NoAssume(CheckInvariants());
 
@@ -652,6 +804,7 @@ void TSparseArray<T, _Allocator>::ClearReleaseMemory_LeaveDirty_() {
         Assert(_chunks);
 
         ReleaseChunk_(reinterpret_cast<FDataItem*&>(_chunks), 0, ckAllocation_(0));
+        ReleaseOccupancy_();
     }
     else { // using an additional allocation for storing pointer
         Assert(_chunks);
@@ -683,6 +836,7 @@ void TSparseArray<T, _Allocator>::ClearReleaseMemory_LeaveDirty_() {
 
         // release the extra allocation made for storage
         allocator_traits::DeallocateT(*this, _chunks, _numChunks);
+        ReleaseOccupancy_();
     }
 }
 //----------------------------------------------------------------------------
@@ -32,6 +32,7 @@ namespace PPE {
 // - won't invalidate it's storage validity
 // - an internal free list is used to get an available slot
 // - uses more than exponential growth : s1 = s0 * 3
+// - an occupancy bit mask tracks allocated slots, so iterations skip holes 64 slots at a time
 //----------------------------------------------------------------------------
 template <typename T>
 class TBasicSparseArray {
@@ -119,6 +120,27 @@ public:
         return UnpackId_(id).Index;
     }
 
+    // one occupancy word covers OccupancyBits slots, ranges aligned on it are iterated faster
+    STATIC_CONST_INTEGRAL(size_t, OccupancyBits, 64);
+
+    // all allocated slots have an index < HighestIndex()
+    NODISCARD size_t HighestIndex() const { return _highestIndex; }
+
+    // each(reference) for every allocated slot in [first, last), in index order
+    template <typename _Each>
+    void EachInRange(size_t first, size_t last, _Each&& each);
+    template <typename _Each>
+    void EachInRange(size_t first, size_t last, _Each&& each) const {
+        const_cast<TBasicSparseArray*>(this)->EachInRange(first, last, [&each](reference data) {
+            each(static_cast<const_reference>(data));
+        });
+    }
+
+    template <typename _Each>
+    void Each(_Each&& each) { EachInRange(0, _highestIndex, std::forward<_Each>(each)); }
+    template <typename _Each>
+    void Each(_Each&& each) const { EachInRange(0, _highestIndex, std::forward<_Each>(each)); }
+
 protected:
     friend class TSparseArrayIterator<T>;
     friend class TSparseArrayIterator<Meta::TAddConst<T>>;
@@ -131,6 +153,12 @@ protected:
     u16 _uniqueKey;
     u16 _numChunks;
     FDataChunkRef* _chunks;
+    u64* _occupancy; // one bit per slot, allocated with the chunks past the first word
+    u64 _inlineOccupancy; // first word, so in situ allocators don't need the heap for the first chunk
+
+    static CONSTEXPR size_t OccupancyWords_(size_t capacity) NOEXCEPT {
+        return ((capacity + OccupancyBits - 1) / OccupancyBits);
+    }
 
     FDataItem* At_(size_t index);
     FORCE_INLINE const FDataItem* At_(size_t index) const {
@@ -401,6 +429,11 @@ public:
     using parent_type::IndexOf;
     using parent_type::Find;
 
+    using parent_type::OccupancyBits;
+    using parent_type::HighestIndex;
+    using parent_type::EachInRange;
+    using parent_type::Each;
+
     using parent_type::CheckInvariants;
     using parent_type::AliasesToContainer;
 
@@ -423,6 +456,10 @@ public:
     template <typename... _Args>
     iterator EmplaceIt(_Args&&... args);
 
+    // bulk insertion of ids.size() items constructed with the same arguments, the storage grows only once
+    template <typename... _Args>
+    void EmplaceN(const TMemoryView<FDataId>& ids, const _Args&... args);
+
     void Assign(TSparseArray&& rvalue);
     void Assign(const TSparseArray& other);
 
@@ -453,6 +490,9 @@ public:
     void Remove(const_iterator it);
     void Remove(reference data);
 
+    // bulk removal, invalid ids are ignored, returns the number of items removed
+    size_type RemoveN(const TMemoryView<const FDataId>& ids);
+
     template <typename _Pred>
     size_type RemoveIf(_Pred pred);
 
@@ -486,6 +526,8 @@ private:
     using parent_type::_uniqueKey;
     using parent_type::_numChunks;
     using parent_type::_chunks;
+    using parent_type::_occupancy;
+    using parent_type::_inlineOccupancy;
 
     using parent_type::GrabFirstFreeBlock_;
 
@@ -498,12 +540,15 @@ private:
     using parent_type::ckSize_;
     using parent_type::ckOffset_;
     using parent_type::ckAllocation_;
+    using parent_type::OccupancyWords_;
 
     FUnpackedId_ AllocateItem_();
     void ReleaseItem_(FUnpackedId_ id, FDataItem* it);
 
     void GrabNewChunk_(size_t cls);
     void ReleaseChunk_(FDataItem* chunk, size_t off, size_t sz);
+    void GrowOccupancy_(size_t oldCapacity);
+    void ReleaseOccupancy_();
 
     void ClearReleaseMemory_LeaveDirty_();
 
@@ -28,6 +28,7 @@ struct FGenericPlatformFileStat {
     ENUM_FLAGS_FRIEND(EMode);
 
     u64 SizeInBytes;
+    u64 Inode; // file serial number, 0 when the platform can't provide one
 
     FTimestamp CreatedAt;
     FTimestamp LastAccess;
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Core_fwd.h"
+
+#include "Maths/Plane.h"
+#include "Maths/ScalarBoundingBox.h"
+#include "Maths/WideMaths.h"
+#include "Memory/MemoryView.h"
+#include "Thread/Task_fwd.h"
+
+// batched frustum culling over SoA bounds:
+// - visibility is written as a bitmask, one bit per bound in u64 words
+// - planes are tested FWideFloat::Lanes bounds at a time, a batch stops as soon as every lane is culled
+// - planeMask skips the planes already known to contain all the bounds (hierarchical coherence)
+// - the parallel variants split the bounds in chunks of whole words, so tasks never share a word
+
+namespace PPE {
+class FFrustum;
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FSoaSpheres {
+    TMemoryView<const float> CenterX;
+    TMemoryView<const float> CenterY;
+    TMemoryView<const float> CenterZ;
+    TMemoryView<const float> Radius;
+
+    size_t size() const {
+        Assert_NoAssume(CenterX.size() == Radius.size());
+        Assert_NoAssume(CenterY.size() == Radius.size());
+        Assert_NoAssume(CenterZ.size() == Radius.size());
+        return Radius.size();
+    }
+};
+//----------------------------------------------------------------------------
+struct FSoaBoundingBoxes {
+    TMemoryView<const float> MinX, MinY, MinZ;
+    TMemoryView<const float> MaxX, MaxY, MaxZ;
+
+    size_t size() const {
+        Assert_NoAssume(MinX.size() == MaxX.size());
+        Assert_NoAssume(MinY.size() == MaxX.size());
+        Assert_NoAssume(MinZ.size() == MaxX.size());
+        Assert_NoAssume(MaxY.size() == MaxX.size());
+        Assert_NoAssume(MaxZ.size() == MaxX.size());
+        return MaxX.size();
+    }
+};
+//----------------------------------------------------------------------------
+class PPE_CORE_API FFrustumCuller {
+public:
+    STATIC_CONST_INTEGRAL(u32, NumPlanes, 6);
+    STATIC_CONST_INTEGRAL(u32, AllPlanes, (1u << NumPlanes) - 1);
+    STATIC_CONST_INTEGRAL(size_t, BitsPerWord, 64);
+    STATIC_CONST_INTEGRAL(size_t, ChunkSize, 4096); // bounds per parallel task
+    STATIC_CONST_INTEGRAL(size_t, ParallelThreshold, 4 * ChunkSize);
+
+    STATIC_ASSERT(BitsPerWord % FWideFloat::Lanes == 0);
+    STATIC_ASSERT(ChunkSize % BitsPerWord == 0);
+
+    explicit FFrustumCuller(const FFrustum& frustum) NOEXCEPT;
+
+    NODISCARD static CONSTEXPR size_t VisibilityWords(size_t numBounds) {
+        return ((numBounds + BitsPerWord - 1) / BitsPerWord);
+    }
+
+    NODISCARD static bool IsVisible(const TMemoryView<const u64>& visibles, size_t index) {
+        return !!(visibles[index / BitsPerWord] & (u64(1) << (index % BitsPerWord)));
+    }
+
+    // returns the number of visible bounds, visibles must hold VisibilityWords(n) words
+    size_t CullSpheres(const TMemoryView<u64>& visibles, const FSoaSpheres& spheres, u32 planeMask = AllPlanes) const NOEXCEPT;
+    size_t CullBoxes(const TMemoryView<u64>& visibles, const FSoaBoundingBoxes& boxes, u32 planeMask = AllPlanes) const NOEXCEPT;
+
+    // falls back to the sequential path under ParallelThreshold
+    size_t ParallelCullSpheres(const TMemoryView<u64>& visibles, const FSoaSpheres& spheres, u32 planeMask = AllPlanes, ITaskContext* context = nullptr) const;
+    size_t ParallelCullBoxes(const TMemoryView<u64>& visibles, const FSoaBoundingBoxes& boxes, u32 planeMask = AllPlanes, ITaskContext* context = nullptr) const;
+
+    // tests only the planes in planeMask, then clears the planes fully containing the box:
+    // pass the updated mask down to the children of a hierarchy
+    NODISCARD EContainmentType Contains(const FBoundingBox& box, u32* planeMask) const NOEXCEPT;
+
+private:
+    size_t CullSpheres_(const TMemoryView<u64>& visibles, const FSoaSpheres& spheres, size_t first, size_t last, u32 planeMask) const NOEXCEPT;
+    size_t CullBoxes_(const TMemoryView<u64>& visibles, const FSoaBoundingBoxes& boxes, size_t first, size_t last, u32 planeMask) const NOEXCEPT;
+
+    FPlane _planes[NumPlanes];
+
+    // each plane broadcast to all lanes
+    FWideFloat _normalX[NumPlanes];
+    FWideFloat _normalY[NumPlanes];
+    FWideFloat _normalZ[NumPlanes];
+    FWideFloat _distance[NumPlanes];
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
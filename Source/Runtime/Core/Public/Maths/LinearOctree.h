@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Core_fwd.h"
+
+#include "Container/Vector.h"
+#include "Maths/ScalarBoundingBox.h"
+#include "Maths/ScalarVector.h"
+#include "Memory/MemoryView.h"
+#include "Misc/Function.h"
+#include "Thread/Task_fwd.h"
+
+// Loose octree stored linearly, for dynamic objects (culling, broad phase):
+// - each object lands in the deepest cell fitting its extent, keyed by the Morton code of its center
+// - objects are sorted by key (parallel radix sort) so any subtree is a contiguous range of cells and objects
+// - cells are implicit: only the occupied ones are stored, with the range of their objects
+// - loose cells are twice the size of the cells, so objects moving inside their loose cell are updated in place
+// - other moves are queued and merged into the sorted arrays by Commit(), queries still see them meanwhile
+// Prefer FBasicOctree for static voxels.
+
+namespace PPE {
+class FFrustum;
+class FRay;
+class FSphere;
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class PPE_CORE_API FLinearOctree {
+public:
+    STATIC_CONST_INTEGRAL(u32, MaxLevel, 10); // 1024^3 cells at the deepest level
+    STATIC_CONST_INTEGRAL(u32, InvalidObject, 0xFFFFFFFFul);
+
+    typedef u32 FObjectId;
+
+    struct FHitResult {
+        float Distance;
+        FObjectId Object;
+    };
+
+    // objects are reported by batches: whole subtrees when fully contained, one by one otherwise
+    typedef TFunction<void(const TMemoryView<const FObjectId>&/* objects */)> onhit_delegate;
+    // may be called concurrently from several workers
+    typedef TFunction<void(size_t/* query */, const TMemoryView<const FObjectId>&/* objects */)> batch_onhit_delegate;
+
+    // each cell holds the objects sharing the same key
+    struct FCell {
+        u64 Key; // (morton << 4) | level, morton is aligned on the deepest level
+        u32 FirstObject;
+        u32 NumObjects;
+    };
+
+    // objects outside of world are stored in the root cell and always tested
+    explicit FLinearOctree(const FBoundingBox& world);
+
+    FLinearOctree(const FLinearOctree&) = delete;
+    FLinearOctree& operator =(const FLinearOctree&) = delete;
+
+    const FBoundingBox& World() const { return _world; }
+    size_t NumObjects() const { return _keys.size(); }
+    size_t NumCells() const { return _cells.size(); }
+    size_t NumPendings() const { return _pendings.size(); }
+    TMemoryView<const FCell> Cells() const { return _cells.MakeConstView(); }
+
+    const FBoundingBox& ObjectBounds(FObjectId id) const { return _bounds[id]; }
+    u64 ObjectKey(FObjectId id) const { return _keys[id]; } // can differ from MakeKey() after a move in place
+
+    // replaces all the objects, ids are the indices in bounds
+    void Build(const TMemoryView<const FBoundingBox>& bounds, ITaskContext* context = nullptr);
+    void Clear();
+
+    // new objects are pending until the next Commit()
+    FObjectId Add(const FBoundingBox& bounds);
+    // returns true when the object still fits in its loose cell and was updated in place
+    bool Move(FObjectId id, const FBoundingBox& bounds);
+    // merges pending objects in the sorted arrays, or rebuilds everything if too many objects moved
+    void Commit(ITaskContext* context = nullptr);
+
+    size_t Intersects(const FBoundingBox& box, const onhit_delegate& onHit) const;
+    size_t Intersects(const FSphere& sphere, const onhit_delegate& onHit) const;
+    size_t Intersects(const FFrustum& frustum, const onhit_delegate& onHit) const;
+
+    // nearest object bounds hit by the ray
+    bool Intersects(const FRay& ray, FHitResult* firstHit, float maxDistance = FLT_MAX) const;
+
+    size_t BatchIntersects(const TMemoryView<const FBoundingBox>& boxes, const batch_onhit_delegate& onHit, ITaskContext* context = nullptr) const;
+    size_t BatchIntersects(const TMemoryView<const FRay>& rays, const TMemoryView<FHitResult>& firstHits, float maxDistance = FLT_MAX, ITaskContext* context = nullptr) const;
+
+    NODISCARD static u64 MortonCode(u32 x, u32 y, u32 z) NOEXCEPT; // 10 bits per axis
+    NODISCARD static u32 KeyLevel(u64 key) { return static_cast<u32>(key & 0xF); }
+    NODISCARD u64 MakeKey(const FBoundingBox& bounds) const NOEXCEPT;
+    NODISCARD FBoundingBox LooseCellBounds(u64 key) const NOEXCEPT;
+
+private:
+    template <typename _Query>
+    size_t Traverse_(const _Query& query, const onhit_delegate& onHit) const;
+    void Rebuild_(ITaskContext* context);
+    void MergePendings_();
+    void BuildCells_();
+
+    FBoundingBox _world;
+    float3 _origin;
+    float _worldSize;
+    float _invFinestCellSize;
+
+    // indexed by object id
+    VECTOR(Maths, u64) _keys;
+    VECTOR(Maths, FBoundingBox) _bounds;
+    VECTOR(Maths, u32) _slots; // index in the sorted arrays, or InvalidObject when pending
+
+    // sorted by key
+    VECTOR(Maths, FCell) _cells;
+    VECTOR(Maths, FObjectId) _sortedIds; // InvalidObject for pending objects
+    VECTOR(Maths, FBoundingBox) _sortedBounds;
+
+    VECTOR(Maths, FObjectId) _pendings;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
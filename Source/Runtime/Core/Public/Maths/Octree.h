@@ -68,7 +68,7 @@ public:
 
     using FBasicOctree::Intersects;
 
-    // #TODO finish impl ? already have a BVH
+    // #TODO finish impl ? already have a BVH, and FLinearOctree for dynamic objects
 
 private:
 
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Core_fwd.h"
+
+#include "Container/Vector.h"
+#include "Maths/ScalarBoundingBox.h"
+#include "Maths/ScalarVector.h"
+#include "Memory/MemoryView.h"
+#include "Thread/Task_fwd.h"
+
+// Bounding volume hierarchy specialized for large triangle meshes (ray casting for baking):
+// - binned SAH builder, big ranges are binned in parallel and each level of the tree is split in parallel
+// - the last levels before MaxDepth use median splits, so the depth stays bounded whatever the triangle sizes
+// - 4-wide nodes (QBVH) stored in a flat array, with the children bounds in SoA for SIMD slab tests
+// - single rays test the 4 children of a node at once, packets trace FWideFloat::Lanes rays together
+// - Refit() updates the bounds after the vertices moved, without changing the topology
+// Prefer FBasicBIHTree for generic items, this tree only handles indexed triangles.
+
+namespace PPE {
+class FRay;
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class PPE_CORE_API FTriangleBVH {
+public:
+    STATIC_CONST_INTEGRAL(u32, Arity, 4);
+    STATIC_CONST_INTEGRAL(u32, MaxTrianglesPerLeaf, 4);
+    STATIC_CONST_INTEGRAL(u32, NumBins, 16);
+    STATIC_CONST_INTEGRAL(u32, MaxDepth, 64);
+    STATIC_CONST_INTEGRAL(u32, EmptyChild, 0xFFFFFFFFul);
+
+    struct FHit {
+        STATIC_CONST_INTEGRAL(u32, NoHit, 0xFFFFFFFFul);
+
+        float Distance;
+        u32 Triangle; // index in the source indices / 3, or NoHit
+        float U, V; // barycentric coordinates of the 2nd and 3rd vertices
+
+        bool Valid() const { return (NoHit != Triangle); }
+    };
+
+    // 128 bytes: two cache lines per node
+    struct FNode {
+        float MinX[Arity], MinY[Arity], MinZ[Arity];
+        float MaxX[Arity], MaxY[Arity], MaxZ[Arity];
+        u32 Child[Arity]; // inner node index, first triangle of a leaf or EmptyChild
+        u32 NumTriangles[Arity]; // 0 for inner nodes and empty slots
+
+        bool IsEmpty(u32 c) const { return (EmptyChild == Child[c]); }
+        bool IsLeaf(u32 c) const { return (NumTriangles[c] > 0); }
+
+        FBoundingBox ChildBounds(u32 c) const {
+            return FBoundingBox(float3(MinX[c], MinY[c], MinZ[c]), float3(MaxX[c], MaxY[c], MaxZ[c]));
+        }
+        void SetChildBounds(u32 c, const FBoundingBox& bounds);
+    };
+
+    FTriangleBVH() = default;
+
+    FTriangleBVH(const FTriangleBVH&) = delete;
+    FTriangleBVH& operator =(const FTriangleBVH&) = delete;
+
+    FTriangleBVH(FTriangleBVH&&) = default;
+    FTriangleBVH& operator =(FTriangleBVH&&) = default;
+
+    bool empty() const { return _nodes.empty(); }
+    size_t NumNodes() const { return _nodes.size(); }
+    size_t NumTriangles() const { return _triangleIds.size(); }
+    const FBoundingBox& Bounds() const { return _bounds; }
+    TMemoryView<const FNode> Nodes() const { return _nodes.MakeConstView(); }
+
+    // indices holds 3 vertex indices per triangle
+    void Build(const TMemoryView<const float3>& positions, const TMemoryView<const u32>& indices, ITaskContext* context = nullptr);
+    // positions must keep the same vertex count than in Build()
+    void Refit(const TMemoryView<const float3>& positions, ITaskContext* context = nullptr);
+    void Clear();
+
+    // nearest hit closer than maxDistance
+    bool Intersects(const FRay& ray, FHit* firstHit, float maxDistance = FLT_MAX) const NOEXCEPT;
+    // any hit closer than maxDistance, for occlusion queries
+    bool Occluded(const FRay& ray, float maxDistance = FLT_MAX) const NOEXCEPT;
+
+    // rays are traced by packets of FWideFloat::Lanes, returns the number of hits
+    size_t IntersectsPacket(const TMemoryView<const FRay>& rays, const TMemoryView<FHit>& firstHits, float maxDistance = FLT_MAX) const NOEXCEPT;
+    // splits the rays between workers, coherent rays should be contiguous
+    size_t BatchIntersects(const TMemoryView<const FRay>& rays, const TMemoryView<FHit>& firstHits, float maxDistance = FLT_MAX, ITaskContext* context = nullptr) const;
+
+private:
+    // precomputed for Möller-Trumbore
+    struct FTriangle_ {
+        float3 V0;
+        float3 Edge1;
+        float3 Edge2;
+    };
+
+    template <bool _AnyHit>
+    bool Traverse_(const FRay& ray, FHit* hit, float maxDistance) const NOEXCEPT;
+    void RefitTriangles_(const TMemoryView<const float3>& positions, ITaskContext* context);
+    void RefitNodes_();
+
+    VECTOR(Maths, FNode) _nodes;
+    VECTOR(Maths, FTriangle_) _triangles; // sorted in leaf order
+    VECTOR(Maths, u32) _triangleIds; // sorted -> source triangle
+    VECTOR(Maths, u32) _indices; // sorted, 3 vertex indices per triangle for Refit()
+    FBoundingBox _bounds;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Maths/WideMaths.h"
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+#if USE_PPE_WIDE_AVX2
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat FWideFloat::Zero() NOEXCEPT { return { ::_mm256_setzero_ps() }; }
+FORCE_INLINE FWideFloat FWideFloat::Broadcast(float f) NOEXCEPT { return { ::_mm256_set1_ps(f) }; }
+FORCE_INLINE FWideFloat FWideFloat::Iota(float first) NOEXCEPT {
+    return { ::_mm256_add_ps(::_mm256_set1_ps(first), ::_mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f)) };
+}
+FORCE_INLINE FWideFloat FWideFloat::Load(const float* p) NOEXCEPT { return { ::_mm256_loadu_ps(p) }; }
+FORCE_INLINE FWideFloat FWideFloat::LoadAligned(const float* p) NOEXCEPT { Assert_NoAssume(Meta::IsAlignedPow2(32, p)); return { ::_mm256_load_ps(p) }; }
+FORCE_INLINE void FWideFloat::Store(float* p) const NOEXCEPT { ::_mm256_storeu_ps(p, v); }
+FORCE_INLINE void FWideFloat::StoreAligned(float* p) const NOEXCEPT { Assert_NoAssume(Meta::IsAlignedPow2(32, p)); ::_mm256_store_ps(p, v); }
+FORCE_INLINE FWideFloat FWideFloat::operator +(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_add_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator -(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_sub_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator *(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_mul_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator /(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_div_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator <(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_cmp_ps(v, other.v, _CMP_LT_OQ) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator <=(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_cmp_ps(v, other.v, _CMP_LE_OQ) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator ==(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_cmp_ps(v, other.v, _CMP_EQ_OQ) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator &(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_and_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator |(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_or_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::AndNot(const FWideFloat& other) const NOEXCEPT { return { ::_mm256_andnot_ps(other.v, v) }; }
+FORCE_INLINE u32 FWideFloat::MoveMask() const NOEXCEPT { return checked_cast<u32>(::_mm256_movemask_ps(v)); }
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat Min(const FWideFloat& a, const FWideFloat& b) NOEXCEPT { return { ::_mm256_min_ps(a.v, b.v) }; }
+FORCE_INLINE FWideFloat Max(const FWideFloat& a, const FWideFloat& b) NOEXCEPT { return { ::_mm256_max_ps(a.v, b.v) }; }
+FORCE_INLINE FWideFloat Sqrt(const FWideFloat& a) NOEXCEPT { return { ::_mm256_sqrt_ps(a.v) }; }
+FORCE_INLINE FWideFloat Abs(const FWideFloat& a) NOEXCEPT { return { ::_mm256_andnot_ps(::_mm256_set1_ps(-0.f), a.v) }; }
+FORCE_INLINE FWideFloat Select(const FWideFloat& mask, const FWideFloat& ifTrue, const FWideFloat& ifFalse) NOEXCEPT {
+    return { ::_mm256_blendv_ps(ifFalse.v, ifTrue.v, mask.v) };
+}
+//----------------------------------------------------------------------------
+#elif USE_PPE_WIDE_SSE2
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat FWideFloat::Zero() NOEXCEPT { return { ::_mm_setzero_ps() }; }
+FORCE_INLINE FWideFloat FWideFloat::Broadcast(float f) NOEXCEPT { return { ::_mm_set1_ps(f) }; }
+FORCE_INLINE FWideFloat FWideFloat::Iota(float first) NOEXCEPT {
+    return { ::_mm_add_ps(::_mm_set1_ps(first), ::_mm_setr_ps(0.f, 1.f, 2.f, 3.f)) };
+}
+FORCE_INLINE FWideFloat FWideFloat::Load(const float* p) NOEXCEPT { return { ::_mm_loadu_ps(p) }; }
+FORCE_INLINE FWideFloat FWideFloat::LoadAligned(const float* p) NOEXCEPT { Assert_NoAssume(Meta::IsAlignedPow2(16, p)); return { ::_mm_load_ps(p) }; }
+FORCE_INLINE void FWideFloat::Store(float* p) const NOEXCEPT { ::_mm_storeu_ps(p, v); }
+FORCE_INLINE void FWideFloat::StoreAligned(float* p) const NOEXCEPT { Assert_NoAssume(Meta::IsAlignedPow2(16, p)); ::_mm_store_ps(p, v); }
+FORCE_INLINE FWideFloat FWideFloat::operator +(const FWideFloat& other) const NOEXCEPT { return { ::_mm_add_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator -(const FWideFloat& other) const NOEXCEPT { return { ::_mm_sub_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator *(const FWideFloat& other) const NOEXCEPT { return { ::_mm_mul_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator /(const FWideFloat& other) const NOEXCEPT { return { ::_mm_div_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator <(const FWideFloat& other) const NOEXCEPT { return { ::_mm_cmplt_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator <=(const FWideFloat& other) const NOEXCEPT { return { ::_mm_cmple_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator ==(const FWideFloat& other) const NOEXCEPT { return { ::_mm_cmpeq_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator &(const FWideFloat& other) const NOEXCEPT { return { ::_mm_and_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::operator |(const FWideFloat& other) const NOEXCEPT { return { ::_mm_or_ps(v, other.v) }; }
+FORCE_INLINE FWideFloat FWideFloat::AndNot(const FWideFloat& other) const NOEXCEPT { return { ::_mm_andnot_ps(other.v, v) }; }
+FORCE_INLINE u32 FWideFloat::MoveMask() const NOEXCEPT { return checked_cast<u32>(::_mm_movemask_ps(v)); }
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat Min(const FWideFloat& a, const FWideFloat& b) NOEXCEPT { return { ::_mm_min_ps(a.v, b.v) }; }
+FORCE_INLINE FWideFloat Max(const FWideFloat& a, const FWideFloat& b) NOEXCEPT { return { ::_mm_max_ps(a.v, b.v) }; }
+FORCE_INLINE FWideFloat Sqrt(const FWideFloat& a) NOEXCEPT { return { ::_mm_sqrt_ps(a.v) }; }
+FORCE_INLINE FWideFloat Abs(const FWideFloat& a) NOEXCEPT { return { ::_mm_andnot_ps(::_mm_set1_ps(-0.f), a.v) }; }
+FORCE_INLINE FWideFloat Select(const FWideFloat& mask, const FWideFloat& ifTrue, const FWideFloat& ifFalse) NOEXCEPT {
+#if USE_PPE_SSE4_1
+    return { ::_mm_blendv_ps(ifFalse.v, ifTrue.v, mask.v) };
+#else
+    return { ::_mm_or_ps(::_mm_and_ps(mask.v, ifTrue.v), ::_mm_andnot_ps(mask.v, ifFalse.v)) };
+#endif
+}
+//----------------------------------------------------------------------------
+#else // portable scalar fallback
+//----------------------------------------------------------------------------
+namespace details {
+template <typename _Op>
+FORCE_INLINE FWideFloat WideMap_(const FWideFloat& a, _Op&& op) NOEXCEPT {
+    FWideFloat r;
+    forrange(i, 0, FWideFloat::Lanes) r.v.f[i] = op(a.v.f[i]);
+    return r;
+}
+template <typename _Op>
+FORCE_INLINE FWideFloat WideMap_(const FWideFloat& a, const FWideFloat& b, _Op&& op) NOEXCEPT {
+    FWideFloat r;
+    forrange(i, 0, FWideFloat::Lanes) r.v.f[i] = op(a.v.f[i], b.v.f[i]);
+    return r;
+}
+template <typename _Op>
+FORCE_INLINE FWideFloat WideMask_(const FWideFloat& a, const FWideFloat& b, _Op&& op) NOEXCEPT {
+    FWideFloat r;
+    forrange(i, 0, FWideFloat::Lanes) r.v.f[i] = std::bit_cast<float>(op(a.v.f[i], b.v.f[i]) ? u32(UMax) : u32(0));
+    return r;
+}
+template <typename _Op>
+FORCE_INLINE FWideFloat WideBits_(const FWideFloat& a, const FWideFloat& b, _Op&& op) NOEXCEPT {
+    FWideFloat r;
+    forrange(i, 0, FWideFloat::Lanes) r.v.f[i] = std::bit_cast<float>(static_cast<u32>(op(std::bit_cast<u32>(a.v.f[i]), std::bit_cast<u32>(b.v.f[i]))));
+    return r;
+}
+} //!details
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat FWideFloat::Zero() NOEXCEPT { return Broadcast(0.f); }
+FORCE_INLINE FWideFloat FWideFloat::Broadcast(float f) NOEXCEPT { return { { { f, f, f, f } } }; }
+FORCE_INLINE FWideFloat FWideFloat::Iota(float first) NOEXCEPT { return { { { first, first + 1.f, first + 2.f, first + 3.f } } }; }
+FORCE_INLINE FWideFloat FWideFloat::Load(const float* p) NOEXCEPT { return { { { p[0], p[1], p[2], p[3] } } }; }
+FORCE_INLINE FWideFloat FWideFloat::LoadAligned(const float* p) NOEXCEPT { return Load(p); }
+FORCE_INLINE void FWideFloat::Store(float* p) const NOEXCEPT { forrange(i, 0, Lanes) p[i] = v.f[i]; }
+FORCE_INLINE void FWideFloat::StoreAligned(float* p) const NOEXCEPT { Store(p); }
+FORCE_INLINE FWideFloat FWideFloat::operator +(const FWideFloat& other) const NOEXCEPT { return details::WideMap_(*this, other, [](float a, float b) { return a + b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator -(const FWideFloat& other) const NOEXCEPT { return details::WideMap_(*this, other, [](float a, float b) { return a - b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator *(const FWideFloat& other) const NOEXCEPT { return details::WideMap_(*this, other, [](float a, float b) { return a * b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator /(const FWideFloat& other) const NOEXCEPT { return details::WideMap_(*this, other, [](float a, float b) { return a / b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator <(const FWideFloat& other) const NOEXCEPT { return details::WideMask_(*this, other, [](float a, float b) { return a < b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator <=(const FWideFloat& other) const NOEXCEPT { return details::WideMask_(*this, other, [](float a, float b) { return a <= b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator ==(const FWideFloat& other) const NOEXCEPT { return details::WideMask_(*this, other, [](float a, float b) { return a == b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator &(const FWideFloat& other) const NOEXCEPT { return details::WideBits_(*this, other, [](u32 a, u32 b) { return a & b; }); }
+FORCE_INLINE FWideFloat FWideFloat::operator |(const FWideFloat& other) const NOEXCEPT { return details::WideBits_(*this, other, [](u32 a, u32 b) { return a | b; }); }
+FORCE_INLINE FWideFloat FWideFloat::AndNot(const FWideFloat& other) const NOEXCEPT { return details::WideBits_(*this, other, [](u32 a, u32 b) { return a & ~b; }); }
+FORCE_INLINE u32 FWideFloat::MoveMask() const NOEXCEPT {
+    u32 mask = 0;
+    forrange(i, 0, Lanes) mask |= (std::bit_cast<u32>(v.f[i]) >> 31) << i;
+    return mask;
+}
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat Min(const FWideFloat& a, const FWideFloat& b) NOEXCEPT { return details::WideMap_(a, b, [](float x, float y) { return (x < y ? x : y); }); }
+FORCE_INLINE FWideFloat Max(const FWideFloat& a, const FWideFloat& b) NOEXCEPT { return details::WideMap_(a, b, [](float x, float y) { return (x > y ? x : y); }); }
+FORCE_INLINE FWideFloat Sqrt(const FWideFloat& a) NOEXCEPT { return details::WideMap_(a, [](float x) { return std::sqrt(x); }); }
+FORCE_INLINE FWideFloat Abs(const FWideFloat& a) NOEXCEPT { return details::WideMap_(a, [](float x) { return std::abs(x); }); }
+FORCE_INLINE FWideFloat Select(const FWideFloat& mask, const FWideFloat& ifTrue, const FWideFloat& ifFalse) NOEXCEPT {
+    return (mask & ifTrue) | ifFalse.AndNot(mask);
+}
+//----------------------------------------------------------------------------
+#endif //!USE_PPE_WIDE_AVX2 || USE_PPE_WIDE_SSE2
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+inline FWideFloat FWideFloat::LoadPartial(const float* p, u32 n) NOEXCEPT {
+    Assert(n <= Lanes);
+    ALIGN(32) float tmp[Lanes] = { 0 };
+    forrange(i, 0, n) tmp[i] = p[i];
+    return LoadAligned(tmp);
+}
+//----------------------------------------------------------------------------
+inline void FWideFloat::StorePartial(float* p, u32 n) const NOEXCEPT {
+    Assert(n <= Lanes);
+    ALIGN(32) float tmp[Lanes];
+    StoreAligned(tmp);
+    forrange(i, 0, n) p[i] = tmp[i];
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "Core_fwd.h"
+
+#include "Maths/Quaternion.h"
+#include "Maths/ScalarMatrix.h"
+#include "Maths/ScalarVector.h"
+#include "Maths/SSEHelpers.h"
+
+// SoA "wide" maths:
+// - FWideFloat packs FWideFloat::Lanes floats, one for each element of a batch
+// - FWideFloat3/FWideFloat4/FWideQuaternion hold one FWideFloat per component
+// - 8 lanes with AVX2, 4 lanes with SSE2 or with the portable scalar fallback
+// - Load()/Store() work on SoA streams, Gather()/Scatter() transpose AoS storage
+// Operations use the same evaluation order than their TScalarVector/FQuaternion
+// counterparts and never contract to FMA, so results match the scalar path.
+
+#define USE_PPE_WIDE_MATHS (USE_PPE_SSE2) // turn to 0 to use the scalar fallback %_NOCOMMIT%
+
+#if USE_PPE_WIDE_MATHS && USE_PPE_AVX2
+#   define USE_PPE_WIDE_AVX2 (1)
+#   define USE_PPE_WIDE_SSE2 (0)
+#elif USE_PPE_WIDE_MATHS
+#   define USE_PPE_WIDE_AVX2 (0)
+#   define USE_PPE_WIDE_SSE2 (1)
+#else
+#   define USE_PPE_WIDE_AVX2 (0)
+#   define USE_PPE_WIDE_SSE2 (0)
+#endif
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FWideFloat {
+#if USE_PPE_WIDE_AVX2
+    STATIC_CONST_INTEGRAL(u32, Lanes, 8);
+    using register_type = ::__m256;
+#elif USE_PPE_WIDE_SSE2
+    STATIC_CONST_INTEGRAL(u32, Lanes, 4);
+    using register_type = ::__m128;
+#else
+    STATIC_CONST_INTEGRAL(u32, Lanes, 4);
+    struct register_type { float f[4]; };
+#endif
+    STATIC_CONST_INTEGRAL(u32, AllLanesMask, (1u << Lanes) - 1);
+
+    register_type v;
+
+    static FORCE_INLINE FWideFloat Zero() NOEXCEPT;
+    static FORCE_INLINE FWideFloat Broadcast(float f) NOEXCEPT;
+    static FORCE_INLINE FWideFloat Iota(float first = 0.f) NOEXCEPT; // first, first+1, ...
+
+    static FORCE_INLINE FWideFloat Load(const float* p) NOEXCEPT;
+    static FORCE_INLINE FWideFloat LoadAligned(const float* p) NOEXCEPT;
+    static FWideFloat LoadPartial(const float* p, u32 n) NOEXCEPT; // zero filled after n
+
+    FORCE_INLINE void Store(float* p) const NOEXCEPT;
+    FORCE_INLINE void StoreAligned(float* p) const NOEXCEPT;
+    void StorePartial(float* p, u32 n) const NOEXCEPT;
+
+    float Lane(u32 i) const NOEXCEPT {
+        Assert(i < Lanes);
+        ALIGN(32) float tmp[Lanes];
+        StoreAligned(tmp);
+        return tmp[i];
+    }
+
+    FORCE_INLINE FWideFloat operator +(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator -(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator *(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator /(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator -() const NOEXCEPT { return (Zero() - *this); }
+
+    FWideFloat& operator +=(const FWideFloat& other) NOEXCEPT { return (*this = *this + other); }
+    FWideFloat& operator -=(const FWideFloat& other) NOEXCEPT { return (*this = *this - other); }
+    FWideFloat& operator *=(const FWideFloat& other) NOEXCEPT { return (*this = *this * other); }
+    FWideFloat& operator /=(const FWideFloat& other) NOEXCEPT { return (*this = *this / other); }
+
+    // comparisons return a mask, with all bits set for each lane passing the test
+    FORCE_INLINE FWideFloat operator <(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator <=(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator >(const FWideFloat& other) const NOEXCEPT { return (other < *this); }
+    FORCE_INLINE FWideFloat operator >=(const FWideFloat& other) const NOEXCEPT { return (other <= *this); }
+    FORCE_INLINE FWideFloat operator ==(const FWideFloat& other) const NOEXCEPT;
+
+    FORCE_INLINE FWideFloat operator &(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat operator |(const FWideFloat& other) const NOEXCEPT;
+    FORCE_INLINE FWideFloat AndNot(const FWideFloat& other) const NOEXCEPT; // this & ~other
+
+    // one bit per lane, from the sign bit of each lane
+    FORCE_INLINE u32 MoveMask() const NOEXCEPT;
+};
+//----------------------------------------------------------------------------
+FORCE_INLINE FWideFloat Min(const FWideFloat& a, const FWideFloat& b) NOEXCEPT;
+FORCE_INLINE FWideFloat Max(const FWideFloat& a, const FWideFloat& b) NOEXCEPT;
+FORCE_INLINE FWideFloat Sqrt(const FWideFloat& a) NOEXCEPT;
+FORCE_INLINE FWideFloat Abs(const FWideFloat& a) NOEXCEPT;
+FORCE_INLINE FWideFloat Select(const FWideFloat& mask, const FWideFloat& ifTrue, const FWideFloat& ifFalse) NOEXCEPT;
+//----------------------------------------------------------------------------
+inline FWideFloat Rcp(const FWideFloat& a) NOEXCEPT { return (FWideFloat::Broadcast(1.f) / a); }
+inline FWideFloat Rsqrt(const FWideFloat& a) NOEXCEPT { return Rcp(Sqrt(a)); }
+inline FWideFloat Lerp(const FWideFloat& a, const FWideFloat& b, const FWideFloat& t) NOEXCEPT { return (a + (b - a) * t); }
+inline FWideFloat Clamp(const FWideFloat& a, const FWideFloat& vmin, const FWideFloat& vmax) NOEXCEPT { return Min(vmax, Max(vmin, a)); }
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FWideFloat3 {
+    FWideFloat x, y, z;
+
+    static FWideFloat3 Zero() NOEXCEPT { return { FWideFloat::Zero(), FWideFloat::Zero(), FWideFloat::Zero() }; }
+    static FWideFloat3 Broadcast(const float3& v) NOEXCEPT {
+        return { FWideFloat::Broadcast(v.x), FWideFloat::Broadcast(v.y), FWideFloat::Broadcast(v.z) };
+    }
+
+    // SoA streams
+    static FWideFloat3 Load(const float* px, const float* py, const float* pz) NOEXCEPT {
+        return { FWideFloat::Load(px), FWideFloat::Load(py), FWideFloat::Load(pz) };
+    }
+    void Store(float* px, float* py, float* pz) const NOEXCEPT {
+        x.Store(px); y.Store(py); z.Store(pz);
+    }
+
+    // AoS storage, reads/writes FWideFloat::Lanes elements
+    static PPE_CORE_API FWideFloat3 Gather(const float3* aos) NOEXCEPT;
+    PPE_CORE_API void Scatter(float3* aos) const NOEXCEPT;
+
+    float3 Lane(u32 i) const NOEXCEPT { return float3(x.Lane(i), y.Lane(i), z.Lane(i)); }
+
+    FWideFloat3 operator +(const FWideFloat3& o) const NOEXCEPT { return { x + o.x, y + o.y, z + o.z }; }
+    FWideFloat3 operator -(const FWideFloat3& o) const NOEXCEPT { return { x - o.x, y - o.y, z - o.z }; }
+    FWideFloat3 operator *(const FWideFloat3& o) const NOEXCEPT { return { x * o.x, y * o.y, z * o.z }; }
+    FWideFloat3 operator *(const FWideFloat& s) const NOEXCEPT { return { x * s, y * s, z * s }; }
+    FWideFloat3 operator -() const NOEXCEPT { return { -x, -y, -z }; }
+};
+//----------------------------------------------------------------------------
+inline FWideFloat Dot(const FWideFloat3& a, const FWideFloat3& b) NOEXCEPT {
+    return (a.x * b.x + a.y * b.y + a.z * b.z);
+}
+inline FWideFloat3 Cross(const FWideFloat3& a, const FWideFloat3& b) NOEXCEPT {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+inline FWideFloat LengthSq(const FWideFloat3& v) NOEXCEPT { return Dot(v, v); }
+inline FWideFloat Length(const FWideFloat3& v) NOEXCEPT { return Sqrt(LengthSq(v)); }
+inline FWideFloat3 Normalize(const FWideFloat3& v) NOEXCEPT { return (v * Rcp(Length(v))); }
+inline FWideFloat3 Lerp(const FWideFloat3& a, const FWideFloat3& b, const FWideFloat& t) NOEXCEPT {
+    return { Lerp(a.x, b.x, t), Lerp(a.y, b.y, t), Lerp(a.z, b.z, t) };
+}
+inline FWideFloat3 Min(const FWideFloat3& a, const FWideFloat3& b) NOEXCEPT { return { Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z) }; }
+inline FWideFloat3 Max(const FWideFloat3& a, const FWideFloat3& b) NOEXCEPT { return { Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z) }; }
+inline FWideFloat3 Select(const FWideFloat& mask, const FWideFloat3& ifTrue, const FWideFloat3& ifFalse) NOEXCEPT {
+    return { Select(mask, ifTrue.x, ifFalse.x), Select(mask, ifTrue.y, ifFalse.y), Select(mask, ifTrue.z, ifFalse.z) };
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FWideFloat4 {
+    FWideFloat x, y, z, w;
+
+    static FWideFloat4 Zero() NOEXCEPT { return { FWideFloat::Zero(), FWideFloat::Zero(), FWideFloat::Zero(), FWideFloat::Zero() }; }
+    static FWideFloat4 Broadcast(const float4& v) NOEXCEPT {
+        return { FWideFloat::Broadcast(v.x), FWideFloat::Broadcast(v.y), FWideFloat::Broadcast(v.z), FWideFloat::Broadcast(v.w) };
+    }
+
+    // AoS storage, reads/writes FWideFloat::Lanes elements
+    static PPE_CORE_API FWideFloat4 Gather(const float4* aos) NOEXCEPT;
+    PPE_CORE_API void Scatter(float4* aos) const NOEXCEPT;
+
+    const FWideFloat3& xyz() const NOEXCEPT { return *reinterpret_cast<const FWideFloat3*>(this); }
+    float4 Lane(u32 i) const NOEXCEPT { return float4(x.Lane(i), y.Lane(i), z.Lane(i), w.Lane(i)); }
+
+    FWideFloat4 operator +(const FWideFloat4& o) const NOEXCEPT { return { x + o.x, y + o.y, z + o.z, w + o.w }; }
+    FWideFloat4 operator -(const FWideFloat4& o) const NOEXCEPT { return { x - o.x, y - o.y, z - o.z, w - o.w }; }
+    FWideFloat4 operator *(const FWideFloat4& o) const NOEXCEPT { return { x * o.x, y * o.y, z * o.z, w * o.w }; }
+    FWideFloat4 operator *(const FWideFloat& s) const NOEXCEPT { return { x * s, y * s, z * s, w * s }; }
+};
+//----------------------------------------------------------------------------
+inline FWideFloat Dot(const FWideFloat4& a, const FWideFloat4& b) NOEXCEPT {
+    return (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// float4x4 with each coefficient broadcast, to transform a batch with the same matrix
+struct FWideFloat4x4 {
+    FWideFloat m[4][4]; // [column][row], same layout than TScalarMatrix
+
+    static FWideFloat4x4 Broadcast(const float4x4& mat) NOEXCEPT {
+        FWideFloat4x4 wide;
+        forrange(c, 0, 4)
+            forrange(r, 0, 4)
+                wide.m[c][r] = FWideFloat::Broadcast(mat.at_(c, r));
+        return wide;
+    }
+};
+//----------------------------------------------------------------------------
+// same as Transform3_OneExtend(m, v).xyz
+inline FWideFloat3 TransformPoint(const FWideFloat4x4& m, const FWideFloat3& v) NOEXCEPT {
+    return {
+        (m.m[0][0] * v.x) + (m.m[1][0] * v.y) + (m.m[2][0] * v.z) + (m.m[3][0]),
+        (m.m[0][1] * v.x) + (m.m[1][1] * v.y) + (m.m[2][1] * v.z) + (m.m[3][1]),
+        (m.m[0][2] * v.x) + (m.m[1][2] * v.y) + (m.m[2][2] * v.z) + (m.m[3][2]) };
+}
+// same as Transform3_OneExtend(m, v)
+inline FWideFloat4 TransformPoint4(const FWideFloat4x4& m, const FWideFloat3& v) NOEXCEPT {
+    return {
+        (m.m[0][0] * v.x) + (m.m[1][0] * v.y) + (m.m[2][0] * v.z) + (m.m[3][0]),
+        (m.m[0][1] * v.x) + (m.m[1][1] * v.y) + (m.m[2][1] * v.z) + (m.m[3][1]),
+        (m.m[0][2] * v.x) + (m.m[1][2] * v.y) + (m.m[2][2] * v.z) + (m.m[3][2]),
+        (m.m[0][3] * v.x) + (m.m[1][3] * v.y) + (m.m[2][3] * v.z) + (m.m[3][3]) };
+}
+// same as Transform3_ZeroExtend(m, v).xyz
+inline FWideFloat3 TransformVector(const FWideFloat4x4& m, const FWideFloat3& v) NOEXCEPT {
+    return {
+        (m.m[0][0] * v.x) + (m.m[1][0] * v.y) + (m.m[2][0] * v.z),
+        (m.m[0][1] * v.x) + (m.m[1][1] * v.y) + (m.m[2][1] * v.z),
+        (m.m[0][2] * v.x) + (m.m[1][2] * v.y) + (m.m[2][2] * v.z) };
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct FWideQuaternion {
+    FWideFloat x, y, z, w;
+
+    static FWideQuaternion Broadcast(const FQuaternion& q) NOEXCEPT {
+        return { FWideFloat::Broadcast(q.x), FWideFloat::Broadcast(q.y), FWideFloat::Broadcast(q.z), FWideFloat::Broadcast(q.w) };
+    }
+
+    static FWideQuaternion Gather(const FQuaternion* aos) NOEXCEPT {
+        const FWideFloat4 v = FWideFloat4::Gather(&aos->data);
+        return { v.x, v.y, v.z, v.w };
+    }
+    void Scatter(FQuaternion* aos) const NOEXCEPT {
+        FWideFloat4{ x, y, z, w }.Scatter(&aos->data);
+    }
+
+    FQuaternion Lane(u32 i) const NOEXCEPT { return FQuaternion(x.Lane(i), y.Lane(i), z.Lane(i), w.Lane(i)); }
+
+    FWideQuaternion Conjugate() const NOEXCEPT { return { -x, -y, -z, w }; }
+
+    FWideQuaternion Normalize() const NOEXCEPT {
+        const FWideFloat rcpLength = Rcp(Sqrt(x * x + y * y + z * z + w * w));
+        return { x * rcpLength, y * rcpLength, z * rcpLength, w * rcpLength };
+    }
+
+    // same as FQuaternion::operator *()
+    FWideQuaternion operator *(const FWideQuaternion& r) const NOEXCEPT {
+        return {
+            (r.x * w + x * r.w + r.y * z) - (r.z * y),
+            (r.y * w + y * r.w + r.z * x) - (r.x * z),
+            (r.z * w + z * r.w + r.x * y) - (r.y * x),
+            (r.w * w) - (r.x * x + r.y * y + r.z * z) };
+    }
+
+    // same as FQuaternion::Transform()
+    FWideFloat3 Transform(const FWideFloat3& value) const NOEXCEPT {
+        const FWideFloat one = FWideFloat::Broadcast(1.f);
+        const FWideFloat vx = x + x;
+        const FWideFloat vy = y + y;
+        const FWideFloat vz = z + z;
+        const FWideFloat vwx = w * vx;
+        const FWideFloat vwy = w * vy;
+        const FWideFloat vwz = w * vz;
+        const FWideFloat vxx = x * vx;
+        const FWideFloat vxy = x * vy;
+        const FWideFloat vxz = x * vz;
+        const FWideFloat vyy = y * vy;
+        const FWideFloat vyz = y * vz;
+        const FWideFloat vzz = z * vz;
+        return {
+            ((value.x * ((one - vyy) - vzz)) + (value.y * (vxy - vwz))) + (value.z * (vxz + vwy)),
+            ((value.x * (vxy + vwz)) + (value.y * ((one - vxx) - vzz))) + (value.z * (vyz - vwx)),
+            ((value.x * (vxz - vwy)) + (value.y * (vyz + vwx))) + (value.z * ((one - vxx) - vyy)) };
+    }
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
+
+#include "Maths/WideMaths-inl.h"
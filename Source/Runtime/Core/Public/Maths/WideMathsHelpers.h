@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Core_fwd.h"
+
+#include "Maths/WideMaths.h"
+#include "Memory/MemoryView.h"
+
+// batch helpers over AoS/SoA arrays, using FWideFloat lanes for every item:
+// - the tail is padded to a full batch and runs the same SIMD kernel, no scalar loop
+// - every function accepts dst == src to work in place
+// - results match the TScalarVector/FQuaternion helpers lane per lane
+
+namespace PPE {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Transform3_OneExtend(m, v).xyz for every point
+PPE_CORE_API void TransformPoints(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const float4x4& m) NOEXCEPT;
+// Transform3_ZeroExtend(m, v).xyz for every vector
+PPE_CORE_API void TransformVectors(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const float4x4& m) NOEXCEPT;
+// Transform3_OneExtend(m, v) for every point, without the perspective divide
+PPE_CORE_API void TransformPoints4(const TMemoryView<float4>& dst, const TMemoryView<const float3>& src, const float4x4& m) NOEXCEPT;
+// q.Transform(v) for every vector
+PPE_CORE_API void RotateVectors(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src, const FQuaternion& q) NOEXCEPT;
+//----------------------------------------------------------------------------
+// SoA streams, transformed in place
+PPE_CORE_API void TransformPointsSoA(const TMemoryView<float>& x, const TMemoryView<float>& y, const TMemoryView<float>& z, const float4x4& m) NOEXCEPT;
+//----------------------------------------------------------------------------
+PPE_CORE_API void BatchDot(const TMemoryView<float>& dst, const TMemoryView<const float3>& lhs, const TMemoryView<const float3>& rhs) NOEXCEPT;
+PPE_CORE_API void BatchCross(const TMemoryView<float3>& dst, const TMemoryView<const float3>& lhs, const TMemoryView<const float3>& rhs) NOEXCEPT;
+PPE_CORE_API void BatchNormalize(const TMemoryView<float3>& dst, const TMemoryView<const float3>& src) NOEXCEPT;
+PPE_CORE_API void MultiplyQuaternions(const TMemoryView<FQuaternion>& dst, const TMemoryView<const FQuaternion>& lhs, const TMemoryView<const FQuaternion>& rhs) NOEXCEPT;
+//----------------------------------------------------------------------------
+// conversions between AoS storage and SoA streams
+PPE_CORE_API void AosToSoa(const TMemoryView<float>& x, const TMemoryView<float>& y, const TMemoryView<float>& z, const TMemoryView<const float3>& aos) NOEXCEPT;
+PPE_CORE_API void SoaToAos(const TMemoryView<float3>& aos, const TMemoryView<const float>& x, const TMemoryView<const float>& y, const TMemoryView<const float>& z) NOEXCEPT;
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,138 @@
+﻿#pragma once
+
+#include "Core_fwd.h"
+
+#include "Misc/Opaque.h"
+
+#include "Allocator/Allocation.h"
+#include "Memory/MemoryView.h"
+#include "Meta/Optional.h"
+
+#include <initializer_list>
+
+// frozen opaque documents:
+// - every string is deduplicated in a table appended after the values
+// - every object has a hashed key index stored right after its key_value_view
+// - the whole document is one position independent allocation: it can be
+//   written to disk or shared memory and read back without any fixup
+
+namespace PPE {
+namespace Opaq {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+struct document_header {
+    STATIC_CONST_INTEGRAL(u32, Magic, 0x4451504F); // 'OPQD'
+    STATIC_CONST_INTEGRAL(u32, Version, 1);
+    // std::variant<> layout depends on the toolchain, documents are only portable between binaries sharing the same ABI
+    STATIC_CONST_INTEGRAL(u32, ABI, (sizeof(value_view) << 16) | sizeof(key_value_view));
+
+    u32 magic;
+    u32 version;
+    u32 abi;
+    u32 size_in_bytes; // header included
+    u32 num_strings; // deduplicated ansi + wide strings
+    u32 num_objects;
+    u32 strings_offset; // string table, relative to the header
+    u32 fingerprint; // Fingerprint32() of everything following the header
+
+    value_view root;
+};
+//----------------------------------------------------------------------------
+// Non-owning view over a frozen document, trivially copyable
+//----------------------------------------------------------------------------
+struct document_view {
+    TPtrRef<const document_header> header;
+
+    PPE_FAKEBOOL_OPERATOR_DECL() { return header.valid(); }
+
+    const value_view& Root() const { return header->root; }
+    FRawMemoryConst MakeView() const { return { reinterpret_cast<const u8*>(header.get()), header->size_in_bytes }; }
+
+    NODISCARD bool Contains(const void* p) const NOEXCEPT {
+        const u8* const first = reinterpret_cast<const u8*>(header.get());
+        return (static_cast<const u8*>(p) >= first && static_cast<const u8*>(p) < first + header->size_in_bytes);
+    }
+
+    // O(1) checks on the header only, no fixup is ever needed after loading
+    NODISCARD static PPE_CORE_API Meta::TOptional<document_view> Attach(FRawMemoryConst data) NOEXCEPT;
+    // O(N) checks the fingerprint, then the bounds of every node, key and string, for untrusted inputs
+    NODISCARD PPE_CORE_API bool Validate() const NOEXCEPT;
+};
+//----------------------------------------------------------------------------
+// Owns the allocation of a frozen document, see value_block
+//----------------------------------------------------------------------------
+struct document_block {
+    FAllocatorBlock alloc;
+
+    PPE_FAKEBOOL_OPERATOR_DECL() { return !!alloc; }
+
+    document_view View() const { return { static_cast<const document_header*>(alloc.Data) }; }
+    const value_view& Root() const { return View().Root(); }
+
+    NODISCARD FAllocatorBlock Reset() {
+        return std::move(alloc);
+    }
+};
+//----------------------------------------------------------------------------
+NODISCARD PPE_CORE_API size_t DocumentSize(const value_view& view);
+NODISCARD PPE_CORE_API document_block NewDocument(FAllocatorBlock alloc, const value_view& view);
+//----------------------------------------------------------------------------
+template <typename _Allocator = default_allocator>
+NODISCARD document_block NewDocument(const value_view& v) {
+    return NewDocument(TStaticAllocator<_Allocator>::Allocate(DocumentSize(v)), v);
+}
+//----------------------------------------------------------------------------
+template <typename _Allocator = default_allocator>
+NODISCARD document_block NewDocument(const value_init& v) {
+    const value_block tmp = NewBlock<_Allocator>(v);
+    document_block doc = NewDocument<_Allocator>(*tmp);
+    DeleteBlock<_Allocator>(tmp);
+    return doc;
+}
+//----------------------------------------------------------------------------
+template <typename _Allocator>
+NODISCARD document_block NewDocument(_Allocator& allocator, const value_view& v) {
+    return NewDocument(TAllocatorTraits<_Allocator>::Allocate(allocator, DocumentSize(v)), v);
+}
+//----------------------------------------------------------------------------
+template <typename _Allocator = default_allocator>
+void DeleteDocument(document_block& v) {
+    STATIC_ASSERT(Meta::is_pod_v<value_view>);
+    TStaticAllocator<_Allocator>::Deallocate(v.Reset());
+}
+//----------------------------------------------------------------------------
+template <typename _Allocator>
+void DeleteDocument(_Allocator& allocator, document_block& v) {
+    STATIC_ASSERT(Meta::is_pod_v<value_view>);
+    TAllocatorTraits<_Allocator>::Deallocate(allocator, v.Reset());
+}
+//----------------------------------------------------------------------------
+// Lookup using the hashed key index: objects must belong to the document
+//----------------------------------------------------------------------------
+NODISCARD PPE_CORE_API Meta::TOptional<TPtrRef<const value_view>> XPath(const document_view& doc, const object_view& o, FStringView key) NOEXCEPT;
+NODISCARD PPE_CORE_API Meta::TOptional<TPtrRef<const value_view>> XPath(const document_view& doc, std::initializer_list<FStringView> path) NOEXCEPT;
+//----------------------------------------------------------------------------
+template <typename T>
+NODISCARD Meta::TOptionalReference<const T> XPathAs(const document_view& doc, const object_view& o, FStringView key) NOEXCEPT {
+    if (Meta::TOptional<TPtrRef<const value_view>> result = XPath(doc, o, key); result.has_value())
+        return std::get_if<T>(result->get());
+    return nullptr;
+}
+//----------------------------------------------------------------------------
+template <typename T>
+NODISCARD Meta::TOptionalReference<const T> XPathAs(const document_view& doc, std::initializer_list<FStringView> path) NOEXCEPT {
+    if (Meta::TOptional<TPtrRef<const value_view>> result = XPath(doc, path); result.has_value())
+        return std::get_if<T>(result->get());
+    return nullptr;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+PPE_CORE_API FTextWriter& operator <<(FTextWriter& oss, const document_view& v);
+PPE_CORE_API FWTextWriter& operator <<(FWTextWriter& oss, const document_view& v);
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace Opaq
+} //!namespace PPE
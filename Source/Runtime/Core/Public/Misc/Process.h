@@ -61,6 +61,7 @@ public:
     bool SetPriority(EProcessPriority priority);
 
     size_t WriteStdin(const FRawMemoryConst& buffer);
+    void CloseStdin(); // signals end of input to the process
 
     size_t ReadStderr(const FRawMemory& buffer);
     size_t ReadStdout(const FRawMemory& buffer);
@@ -2,6 +2,7 @@
 
 #include "Thread/Task/TaskHelpers.h"
 
+#include "Container/SparseArray.h"
 #include "Container/Stack.h"
 #include "HAL/PlatformMisc.h"
 #include "HAL/PlatformProcess.h"
@@ -177,6 +178,26 @@ void ParallelForEachRef(
     details::ParallelForEach_(first, last, foreach_ref, priority, context);
 }
 //----------------------------------------------------------------------------
+template <typename T>
+void ParallelForEach(
+    TBasicSparseArray<T>& sparse,
+    const TFunction<void(Meta::TDontDeduce<T>&)>& foreach_ref,
+    ETaskPriority priority/* = ETaskPriority::Normal */,
+    ITaskContext* context/* = nullptr *//* uses FGlobalThreadPool by default */) {
+    using sparse_type = TBasicSparseArray<T>;
+
+    const size_t highestIndex = sparse.HighestIndex();
+    const size_t numWords = ((highestIndex + sparse_type::OccupancyBits - 1) / sparse_type::OccupancyBits);
+
+    // holes are skipped by EachInRange(), so the words are evenly dispatched between the workers
+    ParallelFor(0, numWords, [&sparse, &foreach_ref, highestIndex](size_t w) {
+        sparse.EachInRange(
+            w * sparse_type::OccupancyBits,
+            Min((w + 1) * sparse_type::OccupancyBits, highestIndex),
+            foreach_ref );
+    },  priority, context );
+}
+//----------------------------------------------------------------------------
 template <typename _Map, typename _Reduce, typename _Result>
 NODISCARD _Result ParallelMapReduce(
     size_t first, size_t last,
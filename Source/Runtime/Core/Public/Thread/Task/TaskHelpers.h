@@ -6,6 +6,7 @@
 #include "Thread/Task/TaskManager.h"
 #include "Thread/ThreadSafe.h"
 
+#include "Container/SparseArray_fwd.h"
 #include "Misc/Function.h"
 
 namespace PPE {
@@ -107,6 +108,14 @@ void ParallelForEachRef(
     ETaskPriority priority = ETaskPriority::Normal,
     ITaskContext* context = nullptr/* uses FGlobalThreadPool by default */);
 //----------------------------------------------------------------------------
+// only visits allocated slots, each task processes whole occupancy words of the sparse array
+template <typename T>
+void ParallelForEach(
+    TBasicSparseArray<T>& sparse,
+    const TFunction<void(Meta::TDontDeduce<T>&)>& foreach_ref,
+    ETaskPriority priority = ETaskPriority::Normal,
+    ITaskContext* context = nullptr/* uses FGlobalThreadPool by default */);
+//----------------------------------------------------------------------------
 NODISCARD PPE_CORE_API int ParallelSum(
     size_t first, size_t last,
     const TFunction<int(size_t)>& sum,
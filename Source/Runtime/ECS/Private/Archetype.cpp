@@ -0,0 +1,163 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "Archetype.h"
+
+#include "Allocator/TrackingMalloc.h"
+#include "HAL/PlatformMemory.h"
+#include "Memory/MemoryDomain.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FArchetype::FArchetype(u32 index, const FComponentMask& mask, const FComponentTypeInfo* types)
+:   _index(index)
+,   _chunkCapacity(0)
+,   _mask(mask) {
+    Assert(types);
+
+    FPlatformMemory::Memset(_columnIndices, InvalidColumn, sizeof(_columnIndices));
+
+    u32 bytesPerEntity = sizeof(FEntity);
+    _mask.Each([&](FComponentId id) {
+        const FComponentTypeInfo& type = types[id];
+        Assert(type.Construct);
+        Assert_NoAssume(type.Alignment <= ALLOCATION_BOUNDARY);
+
+        _columnIndices[id] = checked_cast<u8>(_columns.size());
+        _columns.push_back(FColumn{ id, 0, &type });
+
+        bytesPerEntity += type.SizeInBytes;
+    });
+
+    // compute the layout for the most entities fitting in a chunk, every array is aligned on ALLOCATION_BOUNDARY
+    const u32 maxPadding = checked_cast<u32>(_columns.size() * ALLOCATION_BOUNDARY);
+    _chunkCapacity = (ChunkSizeInBytes - ChunkHeaderSize - maxPadding) / bytesPerEntity;
+    AssertRelease(_chunkCapacity > 0);
+
+    u32 offset = ChunkHeaderSize + _chunkCapacity * sizeof(FEntity);
+    for (FColumn& column : _columns) {
+        offset = checked_cast<u32>(Meta::RoundToNextPow2(offset, ALLOCATION_BOUNDARY));
+        column.Offset = offset;
+        offset += _chunkCapacity * column.Type->SizeInBytes;
+    }
+    Assert_NoAssume(offset <= ChunkSizeInBytes);
+}
+//----------------------------------------------------------------------------
+FArchetype::~FArchetype() {
+    Clear();
+}
+//----------------------------------------------------------------------------
+FArchetypeChunk& FArchetype::AllocateRows(u32* pFirstRow, u32* pNumRows, u32 maxRows) {
+    Assert(pFirstRow);
+    Assert(pNumRows);
+    Assert(maxRows > 0);
+
+    FArchetypeChunk* chunk = (_chunks.empty() ? nullptr : _chunks.back());
+    if (nullptr == chunk || chunk->full())
+        chunk = &AllocateChunk_();
+
+    *pFirstRow = chunk->NumEntities;
+    *pNumRows = Min(maxRows, _chunkCapacity - chunk->NumEntities);
+
+    chunk->NumEntities += *pNumRows;
+    _numEntities += *pNumRows;
+
+    return (*chunk);
+}
+//----------------------------------------------------------------------------
+FEntity FArchetype::RemoveRow(FArchetypeChunk& chunk, u32 row) {
+    Assert(&chunk.Archetype == this);
+    Assert(row < chunk.NumEntities);
+    Assert(not _chunks.empty());
+
+    FArchetypeChunk& last = *_chunks.back();
+    const u32 lastRow = (last.NumEntities - 1);
+
+    FEntity moved;
+    if (&last != &chunk || lastRow != row) {
+        moved = last.EntityData()[lastRow];
+        chunk.EntityData()[row] = moved;
+
+        forrange(column, 0, checked_cast<u32>(_columns.size())) {
+            const FComponentTypeInfo& type = *_columns[column].Type;
+            type.Relocate(chunk.ComponentData(column, row), last.ComponentData(column, lastRow), 1);
+        }
+    }
+
+    last.NumEntities--;
+    _numEntities--;
+
+    if (last.empty())
+        ReleaseLastChunk_();
+
+    return moved;
+}
+//----------------------------------------------------------------------------
+void FArchetype::DestroyRow(FArchetypeChunk& chunk, u32 row) {
+    Assert(&chunk.Archetype == this);
+
+    forrange(column, 0, checked_cast<u32>(_columns.size()))
+        _columns[column].Type->Destroy(chunk.ComponentData(column, row), 1);
+}
+//----------------------------------------------------------------------------
+void FArchetype::Clear() {
+    while (not _chunks.empty()) {
+        FArchetypeChunk& chunk = *_chunks.back();
+        forrange(column, 0, checked_cast<u32>(_columns.size()))
+            _columns[column].Type->Destroy(chunk.ColumnData(column), chunk.NumEntities);
+
+        _numEntities -= chunk.NumEntities;
+        chunk.NumEntities = 0;
+
+        ReleaseLastChunk_();
+    }
+
+    Assert_NoAssume(0 == _numEntities);
+
+    if (_spareChunk) {
+        Meta::Destroy(_spareChunk);
+        TRACKING_FREE(Component, _spareChunk);
+        _spareChunk = nullptr;
+    }
+}
+//----------------------------------------------------------------------------
+FArchetypeChunk& FArchetype::AllocateChunk_() {
+    const u32 chunkIndex = checked_cast<u32>(_chunks.size());
+
+    FArchetypeChunk* chunk;
+    if (_spareChunk) {
+        chunk = _spareChunk;
+        chunk->ChunkIndex = chunkIndex;
+        _spareChunk = nullptr;
+    }
+    else {
+        void* const storage = TRACKING_MALLOC(Component, ChunkSizeInBytes);
+        chunk = INPLACE_NEW(storage, FArchetypeChunk){ *this, chunkIndex };
+    }
+
+    Assert(chunk->empty());
+    _chunks.push_back(chunk);
+    return (*chunk);
+}
+//----------------------------------------------------------------------------
+void FArchetype::ReleaseLastChunk_() {
+    FArchetypeChunk* const chunk = _chunks.back();
+    Assert(chunk->empty());
+
+    _chunks.pop_back();
+
+    if (nullptr == _spareChunk) {
+        _spareChunk = chunk;
+    }
+    else {
+        Meta::Destroy(chunk);
+        TRACKING_FREE(Component, chunk);
+    }
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
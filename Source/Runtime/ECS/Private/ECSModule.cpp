@@ -0,0 +1,55 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "ECSModule.h"
+
+#include "Diagnostic/Logger.h"
+
+#include "Modular/ModularDomain.h"
+#include "Modular/ModuleRegistration.h"
+
+#include "BuildModules.generated.h"
+#include "Diagnostic/BuildVersion.h"
+
+namespace PPE {
+LOG_CATEGORY(PPE_ECS_API, ECS)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+const FModuleInfo FECSModule::StaticInfo{
+    FModuleStaticRegistration::MakeInfo<FECSModule>(
+        STRINGIZE(BUILD_TARGET_NAME),
+        EModulePhase::Bare,
+        EModuleUsage::Runtime,
+        EModuleSource::Core,
+        BUILD_TARGET_ORDINAL,
+        Generated::DependencyList,
+        CurrentBuildVersion() )
+};
+//----------------------------------------------------------------------------
+FECSModule::FECSModule() NOEXCEPT
+:   IModuleInterface(StaticInfo)
+{}
+//----------------------------------------------------------------------------
+void FECSModule::Start(FModularDomain& domain) {
+    IModuleInterface::Start(domain);
+
+}
+//----------------------------------------------------------------------------
+void FECSModule::Shutdown(FModularDomain& domain) {
+    IModuleInterface::Shutdown(domain);
+
+}
+//----------------------------------------------------------------------------
+void FECSModule::DutyCycle(FModularDomain& domain) {
+    IModuleInterface::DutyCycle(domain);
+
+}
+//----------------------------------------------------------------------------
+void FECSModule::ReleaseMemory(FModularDomain& domain) NOEXCEPT {
+    IModuleInterface::ReleaseMemory(domain);
+
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
@@ -0,0 +1,137 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "EntityCommandBuffer.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FEntityCommandBuffer::FEntityCommandBuffer(FEntityWorld& world)
+:   _world(&world)
+{}
+//----------------------------------------------------------------------------
+FEntityCommandBuffer::~FEntityCommandBuffer() {
+    if (not _commands.empty())
+        Discard();
+}
+//----------------------------------------------------------------------------
+FEntity FEntityCommandBuffer::CreateEntity() {
+    const FEntity entity = _world->ReserveEntity();
+    _commands.push_back(FCommand{ EOp::Create, 0, entity, nullptr });
+    return entity;
+}
+//----------------------------------------------------------------------------
+void FEntityCommandBuffer::DestroyEntity(FEntity entity) {
+    Assert(entity.Valid());
+    _commands.push_back(FCommand{ EOp::Destroy, 0, entity, nullptr });
+}
+//----------------------------------------------------------------------------
+void* FEntityCommandBuffer::AddComponent(FEntity entity, FComponentId id) {
+    Assert(entity.Valid());
+
+    const FComponentTypeInfo& type = _world->ComponentType(id);
+    void* const payload = _payloads.Allocate(type.SizeInBytes);
+    Assert_NoAssume(Meta::IsAlignedPow2(type.Alignment, payload));
+
+    _commands.push_back(FCommand{ EOp::Add, id, entity, payload });
+    return payload;
+}
+//----------------------------------------------------------------------------
+void FEntityCommandBuffer::RemoveComponent(FEntity entity, FComponentId id) {
+    Assert(entity.Valid());
+    Assert(id < _world->NumComponentTypes());
+
+    _commands.push_back(FCommand{ EOp::Remove, id, entity, nullptr });
+}
+//----------------------------------------------------------------------------
+void FEntityCommandBuffer::Playback() {
+    FEntityWorld& world = *_world;
+
+    // entities created by this buffer were reserved, so they are alive after this
+    world.FlushReservedEntities_();
+
+    const size_t numCommands = _commands.size();
+    for (size_t first = 0; first < numCommands; ) {
+        const FEntity entity = _commands[first].Entity;
+
+        if (EOp::Destroy == _commands[first].Op) {
+            world.DestroyEntity(entity);
+            ++first;
+            continue;
+        }
+
+        // coalesces the consecutive changes of this entity into one move
+        const bool alive = world.Alive(entity);
+        FComponentMask components = world.Components(entity);
+
+        size_t last = first;
+        for (; last < numCommands; ++last) {
+            const FCommand& cmd = _commands[last];
+            if (cmd.Entity != entity || EOp::Destroy == cmd.Op)
+                break;
+
+            switch (cmd.Op) {
+            case EOp::Create: break;
+            case EOp::Add: components.SetTrue(cmd.Component); break;
+            case EOp::Remove: components.SetFalse(cmd.Component); break;
+            case EOp::Destroy: AssertNotReached();
+            }
+        }
+
+        if (alive)
+            world.SetComponents(entity, components);
+
+        // moves the payloads in place, the last one wins when a component was added several times
+        for (; first < last; ++first) {
+            const FCommand& cmd = _commands[first];
+            if (EOp::Add != cmd.Op)
+                continue;
+
+            const FComponentTypeInfo& type = world.ComponentType(cmd.Component);
+            if (alive && components.Get(cmd.Component)) {
+                void* const component = world.Component(entity, cmd.Component);
+                Assert(component);
+
+                type.Destroy(component, 1);
+                type.Relocate(component, cmd.Payload, 1);
+            }
+            else {
+                type.Destroy(cmd.Payload, 1);
+            }
+        }
+    }
+
+    Reset_();
+}
+//----------------------------------------------------------------------------
+void FEntityCommandBuffer::Discard() {
+    FEntityWorld& world = *_world;
+    world.FlushReservedEntities_();
+
+    for (const FCommand& cmd : _commands) {
+        switch (cmd.Op) {
+        case EOp::Create:
+            world.DestroyEntity(cmd.Entity);
+            break;
+        case EOp::Add:
+            world.ComponentType(cmd.Component).Destroy(cmd.Payload, 1);
+            break;
+        case EOp::Destroy:
+        case EOp::Remove:
+            break;
+        }
+    }
+
+    Reset_();
+}
+//----------------------------------------------------------------------------
+void FEntityCommandBuffer::Reset_() {
+    _commands.clear();
+    _payloads.DiscardAll();
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
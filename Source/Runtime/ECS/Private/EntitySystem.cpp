@@ -0,0 +1,232 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "EntitySystem.h"
+
+#include "ECSModule.h"
+
+#include "Diagnostic/Logger.h"
+#include "IO/FormatHelpers.h"
+#include "Thread/Task/CompletionPort.h"
+#include "Thread/Task/TaskContext.h"
+#include "Time/Timepoint.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+void FSystemContext::ParallelForChunks_(u32 numChunks, size_t numEntities, const FChunkRangeFunc& range) const {
+    Assert(numChunks > 1);
+
+    // every chunk is full except the last one of each archetype, so ranges are balanced by number of chunks
+    const u32 numTasks = checked_cast<u32>(Min(
+        Min(_tasks.WorkerCount(), size_t(numChunks)),
+        numEntities / MinEntitiesPerTask ));
+
+    if (numTasks < 2) {
+        range(*this, 0, numChunks);
+        return;
+    }
+
+    VECTORINSITU(Task, FTaskFunc, 8) tasks;
+    tasks.reserve(numTasks);
+
+    forrange(t, 0, numTasks) {
+        const u32 firstChunk = (numChunks * t) / numTasks;
+        const u32 lastChunk = (numChunks * (t + 1)) / numTasks;
+
+        // the first range reuses the buffer of the calling task, which is blocked until all the ranges completed
+        FEntityCommandBuffer& commands = (0 == t ? Commands : _scheduler.AcquireCommands_(_system));
+
+        tasks.emplace_back([this, &range, &commands, firstChunk, lastChunk](ITaskContext& subTasks) {
+            const FSystemContext ctx{ World, commands, Timeline, subTasks, _scheduler, _system };
+            range(ctx, firstChunk, lastChunk);
+        });
+    }
+
+    _tasks.RunAndWaitFor(tasks.MakeView(), ETaskPriority::High);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FSystemScheduler::FSystemScheduler(FEntityWorld& world)
+:   _world(world)
+{}
+//----------------------------------------------------------------------------
+FSystemScheduler::~FSystemScheduler() {
+    // command buffers are played back at the end of Update()
+    for (const TUniquePtr<FEntry>& entry : _systems) {
+        for (const TUniquePtr<FEntityCommandBuffer>& commands : entry->Commands)
+            Assert_NoAssume(commands->empty());
+    }
+}
+//----------------------------------------------------------------------------
+IEntitySystem& FSystemScheduler::Add(UEntitySystem&& system) {
+    Assert(system);
+
+    const u32 index = checked_cast<u32>(_systems.size());
+
+    TUniquePtr<FEntry> entry = MakeUnique<FEntry>();
+    entry->System = std::move(system);
+    entry->System->Initialize(_world, &entry->Access);
+
+    // keeps the order of the conflicting systems, previous phases are already ordered by the sync points
+    const u32 firstInPhase = (_syncPoints.empty() ? 0 : _syncPoints.back());
+    forrange(other, firstInPhase, index) {
+        FEntry& dependency = *_systems[other];
+        if (entry->Access.ConflictsWith(dependency.Access)) {
+            entry->Dependencies.push_back(other);
+            dependency.Successors.push_back(index);
+        }
+    }
+
+    PPE_LOG(ECS, Verbose, "add system <{0}> with {1} dependencies", entry->System->Name(), entry->Dependencies.size());
+
+    _systems.push_back(std::move(entry));
+    return (*_systems.back()->System);
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::AddSyncPoint() {
+    const u32 index = checked_cast<u32>(_systems.size());
+
+    // ignores empty phases
+    if (_syncPoints.empty() ? 0 < index : _syncPoints.back() < index)
+        _syncPoints.push_back(index);
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::Update(const FTimeline& timeline, ITaskContext* context/* = nullptr */) {
+    // fall back to global priority thread pool by default, since we're blocking the current thread
+    if (nullptr == context)
+        context = GlobalTaskContext();
+
+    const FTimepoint frameStartedAt = FTimepoint::Now();
+
+    FTimespan syncDuration;
+    const u32 numSystems = checked_cast<u32>(_systems.size());
+    for (u32 phase = 0, firstSystem = 0; firstSystem < numSystems; ++phase) {
+        const u32 lastSystem = (phase < _syncPoints.size() ? _syncPoints[phase] : numSystems);
+        Assert(firstSystem < lastSystem);
+
+        context->RunAndWaitFor([this, &timeline, firstSystem, lastSystem](ITaskContext& ctx) {
+            RunPhase_(ctx, timeline, firstSystem, lastSystem);
+        }, ETaskPriority::High);
+
+        // sync point: structural changes are applied when no system is running
+        const FTimepoint syncStartedAt = FTimepoint::Now();
+        Playback_(firstSystem, lastSystem);
+        syncDuration += FTimepoint::ElapsedSince(syncStartedAt);
+
+        firstSystem = lastSystem;
+    }
+
+    _syncTiming.Append(syncDuration);
+    _frameTiming.Append(FTimepoint::ElapsedSince(frameStartedAt));
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::ResetTimings() {
+    for (const TUniquePtr<FEntry>& entry : _systems)
+        entry->Timing = FSystemTiming{};
+
+    _frameTiming = FSystemTiming{};
+    _syncTiming = FSystemTiming{};
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::LogTimings() const {
+    PPE_LOG(ECS, Info, "scheduled {0} systems in {1} phases for {2} frames: frame avg {3} max {4}, sync avg {5} max {6}",
+        _systems.size(), _syncPoints.size() + 1, _frameTiming.NumUpdates,
+        Fmt::DurationInMs(_frameTiming.Average()), Fmt::DurationInMs(_frameTiming.Max),
+        Fmt::DurationInMs(_syncTiming.Average()), Fmt::DurationInMs(_syncTiming.Max) );
+
+    for (const TUniquePtr<FEntry>& entry : _systems) {
+        PPE_LOG(ECS, Info, " - {0:20} | last {1} | avg {2} | max {3} | {4} updates, {5} dependencies",
+            entry->System->Name(),
+            Fmt::DurationInMs(entry->Timing.Last),
+            Fmt::DurationInMs(entry->Timing.Average()),
+            Fmt::DurationInMs(entry->Timing.Max),
+            entry->Timing.NumUpdates,
+            entry->Dependencies.size() );
+    }
+}
+//----------------------------------------------------------------------------
+FEntityCommandBuffer& FSystemScheduler::AcquireCommands_(u32 system) {
+    FEntry& entry = *_systems[system];
+    const FAtomicSpinLock::FScope scopeLock(entry.CommandsBarrier);
+
+    if (entry.Commands.size() == entry.NumCommandsUsed)
+        entry.Commands.push_back(MakeUnique<FEntityCommandBuffer>(_world));
+
+    return (*entry.Commands[entry.NumCommandsUsed++]);
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::RunPhase_(ITaskContext& ctx, const FTimeline& timeline, u32 firstSystem, u32 lastSystem) {
+    forrange(system, firstSystem, lastSystem) {
+        FEntry& entry = *_systems[system];
+        entry.NumPendingDependencies = checked_cast<u32>(entry.Dependencies.size());
+    }
+
+    FAggregationPort phase;
+
+    forrange(system, firstSystem, lastSystem) {
+        if (_systems[system]->Dependencies.empty()) {
+            ctx.Run(phase, [this, &phase, &timeline, system](ITaskContext& subTasks) {
+                RunSystem_(phase, subTasks, timeline, system);
+            }, ETaskPriority::High);
+        }
+    }
+
+    phase.Join(ctx);
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::RunSystem_(FAggregationPort& phase, ITaskContext& ctx, const FTimeline& timeline, u32 system) {
+    for (;;) {
+        FEntry& entry = *_systems[system];
+
+        if (entry.System->Enabled()) {
+            const FTimepoint startedAt = FTimepoint::Now();
+
+            const FSystemContext systemContext{ _world, AcquireCommands_(system), timeline, ctx, *this, system };
+            entry.System->Update(systemContext);
+
+            entry.Timing.Append(FTimepoint::ElapsedSince(startedAt));
+        }
+
+        // starts the successors without pending dependencies: all of them are spawned but one,
+        // which continues on this task to avoid a round trip through the task manager
+        u32 next = UINT32_MAX;
+        for (const u32 successor : entry.Successors) {
+            if (1 != _systems[successor]->NumPendingDependencies.fetch_sub(1))
+                continue;
+
+            if (UINT32_MAX == next) {
+                next = successor;
+            }
+            else {
+                ctx.Run(phase, [this, &phase, &timeline, successor](ITaskContext& subTasks) {
+                    RunSystem_(phase, subTasks, timeline, successor);
+                }, ETaskPriority::High);
+            }
+        }
+
+        if (UINT32_MAX == next)
+            break;
+
+        system = next;
+    }
+}
+//----------------------------------------------------------------------------
+void FSystemScheduler::Playback_(u32 firstSystem, u32 lastSystem) {
+    // in the order of the systems, then in the order of their tasks
+    forrange(system, firstSystem, lastSystem) {
+        FEntry& entry = *_systems[system];
+
+        forrange(i, 0, entry.NumCommandsUsed)
+            entry.Commands[i]->Playback();
+
+        entry.NumCommandsUsed = 0;
+    }
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
@@ -0,0 +1,322 @@
+﻿// PPE - PoPpOlOpOPpo Engine. All Rights Reserved.
+
+#include "EntityWorld.h"
+
+#include "ECSModule.h"
+
+#include "Diagnostic/Logger.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+FEntityWorld::FEntityWorld() {
+    _emptyArchetype = &FindOrAddArchetype(FComponentMask{});
+}
+//----------------------------------------------------------------------------
+FEntityWorld::~FEntityWorld() {
+    Clear();
+}
+//----------------------------------------------------------------------------
+FComponentId FEntityWorld::RegisterComponent(const FComponentTypeInfo& type) {
+    Assert(type.Construct);
+    Assert(type.Destroy);
+    Assert(type.Relocate);
+
+    const auto it = _componentIds.find(type.Type);
+    if (_componentIds.end() != it)
+        return it->second;
+
+    AssertReleaseMessage("too many component types", _numComponentTypes < FComponentMask::Capacity);
+
+    const FComponentId id = checked_cast<FComponentId>(_numComponentTypes++);
+    _componentTypes[id] = type;
+    _componentIds.insert_AssertUnique({ type.Type, id });
+
+    PPE_LOG(ECS, Verbose, "registered component <{0}> with id #{1} ({2} bytes)", type.Name(), id, type.SizeInBytes);
+    return id;
+}
+//----------------------------------------------------------------------------
+FComponentId FEntityWorld::FindComponentId(const Meta::type_info_t& type) const NOEXCEPT {
+    const auto it = _componentIds.find(type);
+    return (_componentIds.end() != it ? it->second : InvalidComponentId);
+}
+//----------------------------------------------------------------------------
+FArchetype* FEntityWorld::FindArchetype(const FComponentMask& components) const NOEXCEPT {
+    const auto it = _archetypeByMask.find(components);
+    return (_archetypeByMask.end() != it ? it->second : nullptr);
+}
+//----------------------------------------------------------------------------
+FArchetype& FEntityWorld::FindOrAddArchetype(const FComponentMask& components) {
+    if (FArchetype* const archetype = FindArchetype(components))
+        return (*archetype);
+
+    const u32 index = checked_cast<u32>(_archetypes.size());
+    _archetypes.push_back(MakeUnique<FArchetype>(index, components, _componentTypes));
+
+    FArchetype& archetype = *_archetypes.back();
+    _archetypeByMask.insert_AssertUnique({ components, &archetype });
+
+    PPE_LOG(ECS, Verbose, "new archetype #{0} with {1} components and {2} entities per chunk",
+        index, archetype.Columns().size(), archetype.ChunkCapacity());
+
+    return archetype;
+}
+//----------------------------------------------------------------------------
+bool FEntityWorld::Alive(FEntity entity) const NOEXCEPT {
+    return (!!AliveSlot_(entity));
+}
+//----------------------------------------------------------------------------
+FEntity FEntityWorld::ReserveEntity() {
+    const FAtomicSpinLock::FScope scopeLock(_reserveBarrier);
+
+    FEntity entity;
+    if (not _freeIndices.empty()) {
+        entity.Index = _freeIndices.back();
+        entity.Generation = _entities[entity.Index].Generation;
+        _freeIndices.pop_back();
+    }
+    else {
+        entity.Index = checked_cast<u32>(_entities.size() + _numReservedIndices++);
+        entity.Generation = 0;
+    }
+
+    _reservedEntities.push_back(entity);
+    return entity;
+}
+//----------------------------------------------------------------------------
+FEntity FEntityWorld::CreateEntity(const FComponentMask& components) {
+    FEntity entity;
+    CreateEntities({ &entity, 1 }, components);
+    return entity;
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::CreateEntities(const TMemoryView<FEntity>& entities, const FComponentMask& components) {
+    FlushReservedEntities_();
+
+    for (FEntity& entity : entities)
+        entity = NewEntity_();
+
+    Place_(FindOrAddArchetype(components), entities, true);
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::DestroyEntity(FEntity entity) {
+    DestroyEntities({ &entity, 1 });
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::DestroyEntities(const TMemoryView<const FEntity>& entities) {
+    FlushReservedEntities_();
+
+    for (const FEntity& entity : entities) {
+        const FEntitySlot* const pSlot = AliveSlot_(entity);
+        if (nullptr == pSlot)
+            continue; // already dead
+
+        FArchetypeChunk& chunk = *pSlot->Chunk;
+        const u32 row = pSlot->Row;
+
+        chunk.Archetype.DestroyRow(chunk, row);
+        Remove_(chunk, row);
+
+        FEntitySlot& slot = _entities[entity.Index];
+        slot.Chunk = nullptr;
+        slot.Row = 0;
+        slot.Generation++;
+
+        _freeIndices.push_back(entity.Index);
+        _numEntities--;
+    }
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::Clear() {
+    FlushReservedEntities_();
+
+    for (const TUniquePtr<FArchetype>& archetype : _archetypes)
+        archetype->Clear();
+
+    // pushed in reverse order to recycle the lowest indices first
+    _freeIndices.clear();
+    for (u32 index = checked_cast<u32>(_entities.size()); index-- > 0; ) {
+        FEntitySlot& slot = _entities[index];
+        if (slot.Chunk) {
+            slot.Chunk = nullptr;
+            slot.Generation++;
+        }
+        _freeIndices.push_back(index);
+    }
+
+    _numEntities = 0;
+}
+//----------------------------------------------------------------------------
+FComponentMask FEntityWorld::Components(FEntity entity) const NOEXCEPT {
+    const FEntitySlot* const pSlot = AliveSlot_(entity);
+    return (pSlot ? pSlot->Chunk->Archetype.Mask() : FComponentMask{});
+}
+//----------------------------------------------------------------------------
+void* FEntityWorld::Component(FEntity entity, FComponentId id) const NOEXCEPT {
+    const FEntitySlot* const pSlot = AliveSlot_(entity);
+    if (nullptr == pSlot)
+        return nullptr;
+
+    const FArchetype& archetype = pSlot->Chunk->Archetype;
+    if (not archetype.Has(id))
+        return nullptr;
+
+    return pSlot->Chunk->ComponentData(archetype.ColumnIndex(id), pSlot->Row);
+}
+//----------------------------------------------------------------------------
+void* FEntityWorld::AddComponent(FEntity entity, FComponentId id) {
+    Assert(id < _numComponentTypes);
+
+    FComponentMask components = Components(entity);
+    if (not components.Get(id)) {
+        components.SetTrue(id);
+        SetComponents(entity, components);
+    }
+
+    return Component(entity, id);
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::RemoveComponent(FEntity entity, FComponentId id) {
+    Assert(id < _numComponentTypes);
+
+    FComponentMask components = Components(entity);
+    if (components.Get(id)) {
+        components.SetFalse(id);
+        SetComponents(entity, components);
+    }
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::SetComponents(FEntity entity, const FComponentMask& components) {
+    FlushReservedEntities_();
+
+    const FEntitySlot* const pSlot = AliveSlot_(entity);
+    AssertRelease(pSlot);
+
+    if (pSlot->Chunk->Archetype.Mask() != components)
+        Move_(entity, FindOrAddArchetype(components));
+}
+//----------------------------------------------------------------------------
+auto FEntityWorld::AliveSlot_(FEntity entity) const NOEXCEPT -> const FEntitySlot* {
+    if (entity.Index >= _entities.size())
+        return nullptr;
+
+    const FEntitySlot& slot = _entities[entity.Index];
+    return (slot.Chunk && slot.Generation == entity.Generation ? &slot : nullptr);
+}
+//----------------------------------------------------------------------------
+FEntity FEntityWorld::NewEntity_() {
+    const FAtomicSpinLock::FScope scopeLock(_reserveBarrier);
+    Assert_NoAssume(0 == _numReservedIndices);
+
+    FEntity entity;
+    if (not _freeIndices.empty()) {
+        entity.Index = _freeIndices.back();
+        entity.Generation = _entities[entity.Index].Generation;
+        _freeIndices.pop_back();
+    }
+    else {
+        entity.Index = checked_cast<u32>(_entities.size());
+        entity.Generation = 0;
+        _entities.emplace_back();
+    }
+
+    return entity;
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::FlushReservedEntities_() {
+    if (_reservedEntities.empty())
+        return;
+
+    const FAtomicSpinLock::FScope scopeLock(_reserveBarrier);
+
+    _entities.resize(_entities.size() + _numReservedIndices);
+    _numReservedIndices = 0;
+
+    Place_(*_emptyArchetype, _reservedEntities.MakeConstView(), true);
+    _reservedEntities.clear();
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::Place_(FArchetype& archetype, const TMemoryView<const FEntity>& entities, bool construct) {
+    const TMemoryView<const FArchetype::FColumn> columns = archetype.Columns();
+
+    for (size_t first = 0; first < entities.size(); ) {
+        u32 firstRow, numRows;
+        FArchetypeChunk& chunk = archetype.AllocateRows(&firstRow, &numRows, checked_cast<u32>(entities.size() - first));
+
+        if (construct) {
+            forrange(column, 0, checked_cast<u32>(columns.size()))
+                columns[column].Type->Construct(chunk.ComponentData(column, firstRow), numRows);
+        }
+
+        forrange(i, 0, numRows) {
+            const FEntity entity = entities[first + i];
+            chunk.EntityData()[firstRow + i] = entity;
+
+            FEntitySlot& slot = _entities[entity.Index];
+            Assert_NoAssume(nullptr == slot.Chunk);
+            Assert_NoAssume(slot.Generation == entity.Generation);
+            slot.Chunk = &chunk;
+            slot.Row = firstRow + i;
+        }
+
+        first += numRows;
+    }
+
+    _numEntities += entities.size();
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::Move_(FEntity entity, FArchetype& dst) {
+    FEntitySlot& slot = _entities[entity.Index];
+    FArchetypeChunk& srcChunk = *slot.Chunk;
+    FArchetype& src = srcChunk.Archetype;
+    const u32 srcRow = slot.Row;
+    Assert(&src != &dst);
+
+    u32 dstRow, numRows;
+    FArchetypeChunk& dstChunk = dst.AllocateRows(&dstRow, &numRows, 1);
+    Assert_NoAssume(1 == numRows);
+    dstChunk.EntityData()[dstRow] = entity;
+
+    // relocates the components present in both archetypes, default constructs the new ones
+    const TMemoryView<const FArchetype::FColumn> dstColumns = dst.Columns();
+    forrange(column, 0, checked_cast<u32>(dstColumns.size())) {
+        const FArchetype::FColumn& it = dstColumns[column];
+        void* const dstData = dstChunk.ComponentData(column, dstRow);
+
+        if (src.Has(it.Id))
+            it.Type->Relocate(dstData, srcChunk.ComponentData(src.ColumnIndex(it.Id), srcRow), 1);
+        else
+            it.Type->Construct(dstData, 1);
+    }
+
+    // destroys the removed components
+    const TMemoryView<const FArchetype::FColumn> srcColumns = src.Columns();
+    forrange(column, 0, checked_cast<u32>(srcColumns.size())) {
+        const FArchetype::FColumn& it = srcColumns[column];
+        if (not dst.Has(it.Id))
+            it.Type->Destroy(srcChunk.ComponentData(column, srcRow), 1);
+    }
+
+    // the destination was allocated before removing from the source: no chunk can be invalidated meanwhile
+    Remove_(srcChunk, srcRow);
+
+    slot.Chunk = &dstChunk;
+    slot.Row = dstRow;
+}
+//----------------------------------------------------------------------------
+void FEntityWorld::Remove_(FArchetypeChunk& chunk, u32 row) {
+    const FEntity moved = chunk.Archetype.RemoveRow(chunk, row);
+    if (moved.Valid()) {
+        FEntitySlot& slot = _entities[moved.Index];
+        Assert_NoAssume(slot.Generation == moved.Generation);
+        slot.Chunk = &chunk;
+        slot.Row = row;
+    }
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
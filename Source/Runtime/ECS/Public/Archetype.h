@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "ComponentMask.h"
+#include "ComponentType.h"
+#include "Entity.h"
+
+#include "Container/Vector.h"
+#include "Memory/MemoryView.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// All the entities sharing the same set of components:
+// - entities are stored in 16KB chunks, each chunk holds the entity handles followed by one array per component (SoA)
+// - every chunk is full except the last one, removals move the last entity of the archetype in the hole
+// - components are not constructed/destroyed by the archetype, FEntityWorld takes care of it
+//----------------------------------------------------------------------------
+class PPE_ECS_API FArchetype : Meta::FNonCopyableNorMovable {
+public:
+    STATIC_CONST_INTEGRAL(u32, ChunkSizeInBytes, 16u << 10);
+    STATIC_CONST_INTEGRAL(u32, ChunkHeaderSize, CACHELINE_SIZE);
+    STATIC_CONST_INTEGRAL(u8, InvalidColumn, 0xFF);
+
+    struct FColumn {
+        FComponentId Id;
+        u32 Offset; // from the start of the chunk
+        const FComponentTypeInfo* Type;
+    };
+
+    // types is indexed by component id and must outlive the archetype
+    FArchetype(u32 index, const FComponentMask& mask, const FComponentTypeInfo* types);
+    ~FArchetype();
+
+    NODISCARD u32 Index() const { return _index; }
+    NODISCARD const FComponentMask& Mask() const { return _mask; }
+    NODISCARD TMemoryView<const FColumn> Columns() const { return _columns.MakeConstView(); }
+
+    NODISCARD u32 ChunkCapacity() const { return _chunkCapacity; }
+    NODISCARD size_t NumChunks() const { return _chunks.size(); }
+    NODISCARD size_t NumEntities() const { return _numEntities; }
+    NODISCARD TMemoryView<FArchetypeChunk* const> Chunks() const { return _chunks.MakeConstView(); }
+
+    NODISCARD bool Has(FComponentId id) const { return (InvalidColumn != _columnIndices[id]); }
+    NODISCARD u32 ColumnIndex(FComponentId id) const { return _columnIndices[id]; }
+    NODISCARD u32 ColumnOffset(u32 column) const { return _columns[column].Offset; }
+
+    // reserves up to maxRows rows at the end of the last chunk, entity handles must be written by the caller
+    FArchetypeChunk& AllocateRows(u32* pFirstRow, u32* pNumRows, u32 maxRows);
+    // moves the last entity of the archetype in (chunk, row), returns the moved entity (invalid when none)
+    // components of the removed row must have been destroyed or relocated before
+    FEntity RemoveRow(FArchetypeChunk& chunk, u32 row);
+    // destroys all the components of a row
+    void DestroyRow(FArchetypeChunk& chunk, u32 row);
+
+    // destroys all the components and releases all the chunks
+    void Clear();
+
+private:
+    FArchetypeChunk& AllocateChunk_();
+    void ReleaseLastChunk_();
+
+    u32 _index;
+    u32 _chunkCapacity;
+    FComponentMask _mask;
+    VECTORINSITU(Component, FColumn, 8) _columns;
+    VECTOR(Component, FArchetypeChunk*) _chunks;
+    FArchetypeChunk* _spareChunk{ nullptr }; // avoids chunk thrashing at the end of the archetype
+    size_t _numEntities{ 0 };
+
+    u8 _columnIndices[FComponentMask::Capacity];
+};
+//----------------------------------------------------------------------------
+class FArchetypeChunk : Meta::FNonCopyableNorMovable {
+public:
+    FArchetype& Archetype;
+    u32 ChunkIndex;
+    u32 NumEntities{ 0 };
+
+    FArchetypeChunk(FArchetype& archetype, u32 chunkIndex) NOEXCEPT
+    :   Archetype(archetype)
+    ,   ChunkIndex(chunkIndex)
+    {}
+
+    NODISCARD size_t size() const { return NumEntities; }
+    NODISCARD bool empty() const { return (0 == NumEntities); }
+    NODISCARD bool full() const { return (Archetype.ChunkCapacity() == NumEntities); }
+
+    NODISCARD FEntity* EntityData() const {
+        return reinterpret_cast<FEntity*>(reinterpret_cast<u8*>(const_cast<FArchetypeChunk*>(this)) + FArchetype::ChunkHeaderSize);
+    }
+    NODISCARD TMemoryView<const FEntity> Entities() const {
+        return { EntityData(), NumEntities };
+    }
+
+    NODISCARD void* ColumnData(u32 column) const {
+        return (reinterpret_cast<u8*>(const_cast<FArchetypeChunk*>(this)) + Archetype.ColumnOffset(column));
+    }
+    NODISCARD void* ComponentData(u32 column, u32 row) const {
+        Assert(row < NumEntities);
+        return (static_cast<u8*>(ColumnData(column)) + size_t(row) * Archetype.Columns()[column].Type->SizeInBytes);
+    }
+
+    template <typename T>
+    NODISCARD TMemoryView<T> Column(u32 column) const {
+        Assert_NoAssume(Archetype.Columns()[column].Type->Type == Meta::type_info<Meta::TDecay<T>>);
+        return { static_cast<T*>(ColumnData(column)), NumEntities };
+    }
+};
+STATIC_ASSERT(sizeof(FArchetypeChunk) <= FArchetype::ChunkHeaderSize);
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
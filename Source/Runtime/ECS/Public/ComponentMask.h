@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "HAL/PlatformMaths.h"
+#include "Meta/Hash_fwd.h"
+
+#include <initializer_list>
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Set of component ids, used as the key of archetypes and to match queries
+//----------------------------------------------------------------------------
+struct FComponentMask {
+    STATIC_CONST_INTEGRAL(u32, Capacity, 128);
+    STATIC_CONST_INTEGRAL(u32, NumWords, Capacity / 64);
+
+    u64 Words[NumWords]{};
+
+    FComponentMask() = default;
+
+    CONSTEXPR FComponentMask(std::initializer_list<FComponentId> ids) NOEXCEPT : Words{} {
+        for (FComponentId id : ids)
+            SetTrue(id);
+    }
+
+    NODISCARD CONSTEXPR bool Get(FComponentId id) const {
+        Assert(id < Capacity);
+        return !!(Words[id >> 6] & (u64(1) << (id & 63)));
+    }
+    CONSTEXPR void SetTrue(FComponentId id) {
+        Assert(id < Capacity);
+        Words[id >> 6] |= (u64(1) << (id & 63));
+    }
+    CONSTEXPR void SetFalse(FComponentId id) {
+        Assert(id < Capacity);
+        Words[id >> 6] &= ~(u64(1) << (id & 63));
+    }
+
+    NODISCARD CONSTEXPR bool Empty() const NOEXCEPT {
+        for (u64 w : Words)
+            if (w) return false;
+        return true;
+    }
+
+    NODISCARD u32 Count() const NOEXCEPT {
+        u32 n = 0;
+        for (u64 w : Words)
+            n += checked_cast<u32>(FPlatformMaths::popcnt(w));
+        return n;
+    }
+
+    // true if all the bits of other are set in this mask
+    NODISCARD CONSTEXPR bool Contains(const FComponentMask& other) const NOEXCEPT {
+        forrange(i, 0, NumWords)
+            if ((Words[i] & other.Words[i]) != other.Words[i])
+                return false;
+        return true;
+    }
+
+    NODISCARD CONSTEXPR bool Intersects(const FComponentMask& other) const NOEXCEPT {
+        forrange(i, 0, NumWords)
+            if (Words[i] & other.Words[i])
+                return true;
+        return false;
+    }
+
+    // visits the ids in ascending order
+    template <typename _Each>
+    void Each(_Each&& each) const {
+        forrange(i, 0, NumWords) {
+            for (u64 w = Words[i]; w; w &= w - 1)
+                each(static_cast<FComponentId>(i * 64 + FPlatformMaths::tzcnt(w)));
+        }
+    }
+
+    CONSTEXPR FComponentMask& operator |=(const FComponentMask& other) NOEXCEPT {
+        forrange(i, 0, NumWords)
+            Words[i] |= other.Words[i];
+        return (*this);
+    }
+    CONSTEXPR FComponentMask& operator &=(const FComponentMask& other) NOEXCEPT {
+        forrange(i, 0, NumWords)
+            Words[i] &= other.Words[i];
+        return (*this);
+    }
+    CONSTEXPR FComponentMask& operator -=(const FComponentMask& other) NOEXCEPT {
+        forrange(i, 0, NumWords)
+            Words[i] &= ~other.Words[i];
+        return (*this);
+    }
+
+    NODISCARD CONSTEXPR FComponentMask operator |(const FComponentMask& other) const NOEXCEPT {
+        FComponentMask result{ *this };
+        return (result |= other);
+    }
+    NODISCARD CONSTEXPR FComponentMask operator &(const FComponentMask& other) const NOEXCEPT {
+        FComponentMask result{ *this };
+        return (result &= other);
+    }
+    NODISCARD CONSTEXPR FComponentMask operator -(const FComponentMask& other) const NOEXCEPT {
+        FComponentMask result{ *this };
+        return (result -= other);
+    }
+
+    CONSTEXPR friend bool operator ==(const FComponentMask& lhs, const FComponentMask& rhs) NOEXCEPT {
+        forrange(i, 0, NumWords)
+            if (lhs.Words[i] != rhs.Words[i])
+                return false;
+        return true;
+    }
+    CONSTEXPR friend bool operator !=(const FComponentMask& lhs, const FComponentMask& rhs) NOEXCEPT {
+        return (not operator ==(lhs, rhs));
+    }
+
+    CONSTEXPR friend hash_t hash_value(const FComponentMask& mask) NOEXCEPT {
+        return hash_u64_constexpr(mask.Words[0], mask.Words[1]);
+    }
+};
+PPE_ASSUME_TYPE_AS_POD(FComponentMask)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "HAL/PlatformMemory.h"
+#include "IO/StringView.h"
+#include "Meta/TypeInfo.h"
+
+#include <memory>
+#include <type_traits>
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Type erased traits of a component, components are stored in untyped arrays:
+// - they must be default constructible and nothrow move constructible
+// - their alignment can't exceed ALLOCATION_BOUNDARY
+//----------------------------------------------------------------------------
+struct FComponentTypeInfo {
+    using construct_f = void (*)(void* dst, size_t n);
+    using destroy_f = void (*)(void* dst, size_t n);
+    using relocate_f = void (*)(void* dst, void* src, size_t n); // move constructs dst and destroys src
+
+    Meta::type_info_t Type;
+    u32 SizeInBytes{ 0 };
+    u32 Alignment{ 0 };
+
+    construct_f Construct{ nullptr };
+    destroy_f Destroy{ nullptr };
+    relocate_f Relocate{ nullptr };
+
+    NODISCARD FStringView Name() const { return Type.name.MakeView(); }
+
+    template <typename T>
+    NODISCARD static FComponentTypeInfo Make() NOEXCEPT;
+};
+//----------------------------------------------------------------------------
+template <typename T>
+FComponentTypeInfo FComponentTypeInfo::Make() NOEXCEPT {
+    STATIC_ASSERT(std::is_same_v<T, Meta::TDecay<T>>);
+    STATIC_ASSERT(std::is_default_constructible_v<T>);
+    STATIC_ASSERT(std::is_nothrow_move_constructible_v<T>);
+    STATIC_ASSERT(alignof(T) <= ALLOCATION_BOUNDARY);
+
+    FComponentTypeInfo info;
+    info.Type = Meta::type_info<T>;
+    info.SizeInBytes = checked_cast<u32>(sizeof(T));
+    info.Alignment = checked_cast<u32>(alignof(T));
+
+    info.Construct = [](void* dst, size_t n) {
+        std::uninitialized_value_construct_n(static_cast<T*>(dst), n);
+    };
+    info.Destroy = [](void* dst, size_t n) {
+        IF_CONSTEXPR(not std::is_trivially_destructible_v<T>)
+            std::destroy_n(static_cast<T*>(dst), n);
+        else
+            Unused(dst, n);
+    };
+    info.Relocate = [](void* dst, void* src, size_t n) {
+        IF_CONSTEXPR(std::is_trivially_copyable_v<T>) {
+            FPlatformMemory::Memcpy(dst, src, n * sizeof(T));
+        }
+        else {
+            std::uninitialized_move_n(static_cast<T*>(src), n, static_cast<T*>(dst));
+            std::destroy_n(static_cast<T*>(src), n);
+        }
+    };
+
+    return info;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
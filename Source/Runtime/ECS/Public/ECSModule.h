@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "Modular/ModuleInterface.h"
+
+#include "Diagnostic/Logger_fwd.h"
+
+namespace PPE {
+EXTERN_LOG_CATEGORY(PPE_ECS_API, ECS)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+class PPE_ECS_API FECSModule final : public IModuleInterface {
+public:
+    static const FModuleInfo StaticInfo;
+
+    explicit FECSModule() NOEXCEPT;
+
+    virtual void Start(FModularDomain& domain) override;
+    virtual void Shutdown(FModularDomain& domain) override;
+
+    virtual void DutyCycle(FModularDomain& domain) override;
+    virtual void ReleaseMemory(FModularDomain& domain) NOEXCEPT override;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace PPE
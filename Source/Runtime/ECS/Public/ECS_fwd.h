@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Core.h"
+
+#ifdef EXPORT_PPE_RUNTIME_ECS
+#   define PPE_ECS_API DLL_EXPORT
+#else
+#   define PPE_ECS_API DLL_IMPORT
+#endif
+
+#include "Memory/UniquePtr.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+using FComponentId = u32;
+//----------------------------------------------------------------------------
+struct FComponentMask;
+struct FComponentTypeInfo;
+struct FEntity;
+//----------------------------------------------------------------------------
+class PPE_ECS_API FArchetype;
+class FArchetypeChunk;
+class PPE_ECS_API FEntityCommandBuffer;
+class PPE_ECS_API FEntityWorld;
+//----------------------------------------------------------------------------
+template <typename... _Components>
+struct TChunkView;
+template <typename... _Components>
+class TEntityQuery;
+//----------------------------------------------------------------------------
+struct FSystemAccess;
+class PPE_ECS_API FSystemContext;
+class PPE_ECS_API FSystemScheduler;
+FWD_INTEFARCE_UNIQUEPTR(EntitySystem);
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
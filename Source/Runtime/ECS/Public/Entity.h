@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "Meta/Hash_fwd.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Generational handle: the generation is bumped each time an index is recycled,
+// so stale handles are detected instead of aliasing a new entity.
+//----------------------------------------------------------------------------
+struct FEntity {
+    STATIC_CONST_INTEGRAL(u32, InvalidIndex, UINT32_MAX);
+
+    u32 Index{ InvalidIndex };
+    u32 Generation{ 0 };
+
+    NODISCARD CONSTEXPR bool Valid() const { return (InvalidIndex != Index); }
+    PPE_FAKEBOOL_OPERATOR_DECL() { return Valid(); }
+
+    CONSTEXPR friend bool operator ==(const FEntity& lhs, const FEntity& rhs) NOEXCEPT {
+        return (lhs.Index == rhs.Index && lhs.Generation == rhs.Generation);
+    }
+    CONSTEXPR friend bool operator !=(const FEntity& lhs, const FEntity& rhs) NOEXCEPT {
+        return (not operator ==(lhs, rhs));
+    }
+
+    CONSTEXPR friend hash_t hash_value(const FEntity& entity) NOEXCEPT {
+        return hash_u32_constexpr(entity.Index, entity.Generation);
+    }
+};
+PPE_ASSUME_TYPE_AS_POD(FEntity)
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "ComponentMask.h"
+#include "Entity.h"
+#include "EntityWorld.h"
+
+#include "Allocator/SlabHeap.h"
+#include "Container/Vector.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Records structural changes to apply them later, when no system is iterating the world:
+// - created entities are reserved immediately, so components can be added to them in the same buffer
+// - added components are moved in a private heap until Playback()
+// - Playback() coalesces consecutive changes of the same entity, so it moves only once between archetypes
+// A buffer can be recorded by only one thread at a time.
+//----------------------------------------------------------------------------
+class PPE_ECS_API FEntityCommandBuffer : Meta::FNonCopyableNorMovable {
+public:
+    explicit FEntityCommandBuffer(FEntityWorld& world);
+    ~FEntityCommandBuffer(); // discards pending commands
+
+    NODISCARD FEntityWorld& World() const { return (*_world); }
+
+    NODISCARD bool empty() const { return _commands.empty(); }
+    NODISCARD size_t NumCommands() const { return _commands.size(); }
+
+    NODISCARD FEntity CreateEntity();
+    void DestroyEntity(FEntity entity);
+
+    // returns uninitialized storage for the component, which must be constructed by the caller
+    NODISCARD void* AddComponent(FEntity entity, FComponentId id);
+    void RemoveComponent(FEntity entity, FComponentId id);
+
+    template <typename T>
+    void Add(FEntity entity, T&& value) {
+        using component_type = Meta::TDecay<T>;
+        INPLACE_NEW(AddComponent(entity, _world->ComponentId<component_type>()), component_type)(std::forward<T>(value));
+    }
+    template <typename T>
+    void Remove(FEntity entity) {
+        RemoveComponent(entity, _world->ComponentId<T>());
+    }
+
+    // applies all the commands in recording order, then resets the buffer
+    void Playback();
+    // drops all the commands, entities created by this buffer are destroyed
+    void Discard();
+
+private:
+    enum class EOp : u8 {
+        Create,
+        Destroy,
+        Add,
+        Remove,
+    };
+
+    struct FCommand {
+        EOp Op;
+        FComponentId Component;
+        FEntity Entity;
+        void* Payload;
+    };
+
+    void Reset_();
+
+    FEntityWorld* _world;
+    VECTOR(Entity, FCommand) _commands;
+    SLABHEAP(Component) _payloads;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
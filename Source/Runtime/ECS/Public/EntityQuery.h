@@ -0,0 +1,180 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "Archetype.h"
+#include "ComponentMask.h"
+#include "EntityWorld.h"
+
+#include "Container/Vector.h"
+#include "Memory/MemoryView.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Typed view on the component arrays of a chunk, const components are read-only
+//----------------------------------------------------------------------------
+template <typename... _Components>
+struct TChunkView {
+    using columns_type = std::tuple<_Components*...>;
+
+    FArchetypeChunk* Chunk{ nullptr };
+    columns_type Columns;
+
+    NODISCARD u32 size() const { return Chunk->NumEntities; }
+    NODISCARD TMemoryView<const FEntity> Entities() const { return Chunk->Entities(); }
+
+    template <size_t _Index>
+    NODISCARD auto Column() const {
+        using component_type = std::remove_pointer_t<std::tuple_element_t<_Index, columns_type>>;
+        return TMemoryView<component_type>{ std::get<_Index>(Columns), Chunk->NumEntities };
+    }
+
+    template <typename T>
+    NODISCARD TMemoryView<T> Get() const {
+        return { std::get<T*>(Columns), Chunk->NumEntities };
+    }
+
+    // each(_Components&...)
+    template <typename _Each>
+    void Each(_Each&& each) const {
+        const u32 n = Chunk->NumEntities;
+        std::apply([&each, n](auto*... columns) {
+            forrange(i, 0, n)
+                each(columns[i]...);
+        }, Columns);
+    }
+
+    // each(FEntity, _Components&...)
+    template <typename _Each>
+    void EachWithEntity(_Each&& each) const {
+        const u32 n = Chunk->NumEntities;
+        const FEntity* const entities = Chunk->EntityData();
+        std::apply([&each, entities, n](auto*... columns) {
+            forrange(i, 0, n)
+                each(entities[i], columns[i]...);
+        }, Columns);
+    }
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Iterates all the entities having every _Components and none of the excluded components:
+// - matching archetypes are cached, and updated incrementally since archetypes are never deleted
+// - iteration is linear in memory: chunk by chunk, then one array per component
+// - const components are declared as reads, other components as writes (see FSystemAccess)
+// Structural changes are forbidden while iterating, use a FEntityCommandBuffer instead.
+//----------------------------------------------------------------------------
+template <typename... _Components>
+class TEntityQuery {
+public:
+    STATIC_CONST_INTEGRAL(u32, NumComponents, sizeof...(_Components));
+    STATIC_ASSERT(NumComponents > 0);
+
+    using view_type = TChunkView<_Components...>;
+
+    explicit TEntityQuery(FEntityWorld& world, const FComponentMask& excluded = {})
+    :   _world(&world)
+    ,   _ids{ world.ComponentId<_Components>()... }
+    ,   _excluded(excluded) {
+        const bool readOnly[NumComponents] = { std::is_const_v<_Components>... };
+        forrange(i, 0, NumComponents) {
+            _required.SetTrue(_ids[i]);
+            (readOnly[i] ? _reads : _writes).SetTrue(_ids[i]);
+        }
+        Assert_NoAssume(not _required.Intersects(_excluded));
+    }
+
+    NODISCARD FEntityWorld& World() const { return (*_world); }
+
+    NODISCARD const FComponentMask& Required() const { return _required; }
+    NODISCARD const FComponentMask& Excluded() const { return _excluded; }
+    NODISCARD const FComponentMask& Reads() const { return _reads; }
+    NODISCARD const FComponentMask& Writes() const { return _writes; }
+
+    // appends the archetypes created since the last call, must not race with structural changes
+    void Refresh() {
+        for (const size_t n = _world->NumArchetypes(); _numArchetypesSeen < n; ++_numArchetypesSeen) {
+            FArchetype& archetype = _world->Archetype(_numArchetypesSeen);
+            if (archetype.Mask().Contains(_required) && not archetype.Mask().Intersects(_excluded)) {
+                FMatch match;
+                match.Archetype = &archetype;
+                forrange(i, 0, NumComponents)
+                    match.Columns[i] = archetype.ColumnIndex(_ids[i]);
+                _matches.push_back(match);
+            }
+        }
+    }
+
+    NODISCARD size_t NumArchetypes() {
+        Refresh();
+        return _matches.size();
+    }
+
+    NODISCARD size_t NumEntities() {
+        Refresh();
+        size_t n = 0;
+        for (const FMatch& match : _matches)
+            n += match.Archetype->NumEntities();
+        return n;
+    }
+
+    // each(const view_type&)
+    template <typename _Each>
+    void EachChunk(_Each&& each) {
+        Refresh();
+        for (const FMatch& match : _matches) {
+            for (FArchetypeChunk* chunk : match.Archetype->Chunks())
+                each(MakeView_(match, *chunk, std::index_sequence_for<_Components...>{}));
+        }
+    }
+
+    // each(_Components&...)
+    template <typename _Each>
+    void Each(_Each&& each) {
+        EachChunk([&each](const view_type& view) {
+            view.Each(each);
+        });
+    }
+
+    // each(FEntity, _Components&...)
+    template <typename _Each>
+    void EachWithEntity(_Each&& each) {
+        EachChunk([&each](const view_type& view) {
+            view.EachWithEntity(each);
+        });
+    }
+
+private:
+    struct FMatch {
+        FArchetype* Archetype;
+        u32 Columns[NumComponents];
+    };
+
+    template <size_t... _Indices>
+    NODISCARD static view_type MakeView_(const FMatch& match, FArchetypeChunk& chunk, std::index_sequence<_Indices...>) {
+        return view_type{ &chunk, { static_cast<_Components*>(chunk.ColumnData(match.Columns[_Indices]))... } };
+    }
+
+    FEntityWorld* _world;
+    FComponentId _ids[NumComponents];
+
+    FComponentMask _required;
+    FComponentMask _excluded;
+    FComponentMask _reads;
+    FComponentMask _writes;
+
+    size_t _numArchetypesSeen{ 0 };
+    VECTORINSITU(Component, FMatch, 4) _matches;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
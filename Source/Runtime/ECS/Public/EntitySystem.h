@@ -0,0 +1,230 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "ComponentMask.h"
+#include "EntityCommandBuffer.h"
+#include "EntityQuery.h"
+
+#include "Container/Vector.h"
+#include "IO/StringView.h"
+#include "Misc/Function.h"
+#include "Thread/AtomicSpinLock.h"
+#include "Thread/Task_fwd.h"
+#include "Time/Time_fwd.h"
+
+#include <atomic>
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Components read and written by a system: systems writing components accessed by another system conflict,
+// conflicting systems never run concurrently.
+//----------------------------------------------------------------------------
+struct FSystemAccess {
+    FComponentMask Reads;
+    FComponentMask Writes;
+
+    template <typename... _Components>
+    FSystemAccess& Add(const TEntityQuery<_Components...>& query) {
+        Reads |= query.Reads();
+        Writes |= query.Writes();
+        return (*this);
+    }
+
+    NODISCARD bool ConflictsWith(const FSystemAccess& other) const NOEXCEPT {
+        return (Writes.Intersects(other.Reads | other.Writes) || other.Writes.Intersects(Reads));
+    }
+};
+//----------------------------------------------------------------------------
+// Passed to IEntitySystem::Update(), each task of a system gets its own context:
+// - Commands is private to the current task, so recording structural changes never needs locking
+// - ParallelEachChunk() splits large queries in ranges of chunks, run concurrently by the task manager
+// All the command buffers are played back at the next sync point, in the order of the systems then of the tasks.
+//----------------------------------------------------------------------------
+class PPE_ECS_API FSystemContext {
+public:
+    STATIC_CONST_INTEGRAL(u32, MinEntitiesPerTask, 4096);
+
+    FEntityWorld& World;
+    FEntityCommandBuffer& Commands;
+    const FTimeline& Timeline;
+
+    FSystemContext(
+        FEntityWorld& world,
+        FEntityCommandBuffer& commands,
+        const FTimeline& timeline,
+        ITaskContext& tasks,
+        FSystemScheduler& scheduler,
+        u32 system ) NOEXCEPT
+    :   World(world)
+    ,   Commands(commands)
+    ,   Timeline(timeline)
+    ,   _tasks(tasks)
+    ,   _scheduler(scheduler)
+    ,   _system(system)
+    {}
+
+    NODISCARD ITaskContext& Tasks() const { return _tasks; }
+
+    // each(const FSystemContext&, const TChunkView<_Components...>&)
+    template <typename... _Components, typename _Each>
+    void ParallelEachChunk(TEntityQuery<_Components...>& query, _Each&& each) const;
+
+    // each(const FSystemContext&, FEntity, _Components&...)
+    template <typename... _Components, typename _Each>
+    void ParallelEach(TEntityQuery<_Components...>& query, _Each&& each) const {
+        ParallelEachChunk(query, [&each](const FSystemContext& ctx, const TChunkView<_Components...>& view) {
+            view.EachWithEntity([&ctx, &each](FEntity entity, _Components&... components) {
+                each(ctx, entity, components...);
+            });
+        });
+    }
+
+private:
+    using FChunkRangeFunc = TFunction<void(const FSystemContext&, u32 firstChunk, u32 lastChunk)>;
+
+    void ParallelForChunks_(u32 numChunks, size_t numEntities, const FChunkRangeFunc& range) const;
+
+    ITaskContext& _tasks;
+    FSystemScheduler& _scheduler;
+    u32 _system;
+};
+//----------------------------------------------------------------------------
+template <typename... _Components, typename _Each>
+void FSystemContext::ParallelEachChunk(TEntityQuery<_Components...>& query, _Each&& each) const {
+    using view_type = TChunkView<_Components...>;
+
+    size_t numEntities = 0;
+    VECTORINSITU(System, view_type, 16) chunks;
+    query.EachChunk([&numEntities, &chunks](const view_type& view) {
+        numEntities += view.size();
+        chunks.push_back(view);
+    });
+
+    if (numEntities < 2 * MinEntitiesPerTask || chunks.size() < 2) {
+        for (const view_type& view : chunks)
+            each(*this, view);
+        return;
+    }
+
+    ParallelForChunks_(checked_cast<u32>(chunks.size()), numEntities,
+        [&chunks, &each](const FSystemContext& ctx, u32 firstChunk, u32 lastChunk) {
+            forrange(i, firstChunk, lastChunk)
+                each(ctx, chunks[i]);
+        });
+}
+//----------------------------------------------------------------------------
+class PPE_ECS_API IEntitySystem : Meta::FNonCopyableNorMovable {
+public:
+    virtual ~IEntitySystem() = default;
+
+    NODISCARD virtual FStringView Name() const = 0;
+    // disabled systems are skipped for the frame, systems depending on them start without waiting
+    NODISCARD virtual bool Enabled() const { return true; }
+
+    // creates the queries and declares all the components accessed by Update()
+    virtual void Initialize(FEntityWorld& world, FSystemAccess* access) = 0;
+    // can run concurrently with other systems, must not do any structural change on the world
+    virtual void Update(const FSystemContext& ctx) = 0;
+};
+//----------------------------------------------------------------------------
+// Wall clock durations measured by FSystemScheduler, for systems, frames and sync points
+//----------------------------------------------------------------------------
+struct FSystemTiming {
+    FTimespan Last;
+    FTimespan Total;
+    FTimespan Max;
+    u32 NumUpdates{ 0 };
+
+    NODISCARD FTimespan Average() const {
+        return (NumUpdates ? FTimespan{ Total.Value() / NumUpdates } : FTimespan{});
+    }
+
+    void Append(FTimespan duration) {
+        Last = duration;
+        Total += duration;
+        Max = (Max.Value() < duration.Value() ? duration : Max);
+        NumUpdates++;
+    }
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Runs the systems on the task manager following a dependency graph built from their accesses:
+// - a system depends on all the previously added systems it conflicts with
+// - a system starts as soon as all its dependencies completed, independent systems run concurrently
+// - sync points split the frame in phases: structural changes recorded during a phase are applied
+//   before the next phase starts, and at the end of the frame
+//----------------------------------------------------------------------------
+class PPE_ECS_API FSystemScheduler : Meta::FNonCopyableNorMovable {
+public:
+    explicit FSystemScheduler(FEntityWorld& world);
+    ~FSystemScheduler();
+
+    NODISCARD FEntityWorld& World() const { return _world; }
+
+    NODISCARD size_t NumSystems() const { return _systems.size(); }
+    NODISCARD size_t NumSyncPoints() const { return _syncPoints.size(); }
+
+    NODISCARD IEntitySystem& System(size_t index) const { return (*_systems[index]->System); }
+    NODISCARD const FSystemAccess& Access(size_t index) const { return _systems[index]->Access; }
+    NODISCARD TMemoryView<const u32> Dependencies(size_t index) const { return _systems[index]->Dependencies.MakeConstView(); }
+    NODISCARD const FSystemTiming& Timing(size_t index) const { return _systems[index]->Timing; }
+
+    NODISCARD const FSystemTiming& FrameTiming() const { return _frameTiming; }
+    NODISCARD const FSystemTiming& SyncTiming() const { return _syncTiming; }
+
+    IEntitySystem& Add(UEntitySystem&& system);
+
+    template <typename _System, typename... _Args>
+    _System& Add(_Args&&... args) {
+        return static_cast<_System&>(Add(UEntitySystem{ MakeUnique<_System>(std::forward<_Args>(args)...) }));
+    }
+
+    // systems added after the sync point wait for all the previous systems, and see their structural changes
+    void AddSyncPoint();
+
+    void Update(const FTimeline& timeline, ITaskContext* context = nullptr/* uses FGlobalThreadPool by default */);
+
+    void ResetTimings();
+    void LogTimings() const;
+
+private:
+    friend class FSystemContext;
+
+    struct FEntry : Meta::FNonCopyableNorMovable {
+        UEntitySystem System;
+        FSystemAccess Access;
+        FSystemTiming Timing;
+
+        VECTORINSITU(System, u32, 4) Dependencies;
+        VECTORINSITU(System, u32, 4) Successors;
+        std::atomic<u32> NumPendingDependencies{ 0 };
+
+        // one command buffer per task, reused between frames
+        FAtomicSpinLock CommandsBarrier;
+        u32 NumCommandsUsed{ 0 };
+        VECTORINSITU(System, TUniquePtr<FEntityCommandBuffer>, 1) Commands;
+    };
+
+    NODISCARD FEntityCommandBuffer& AcquireCommands_(u32 system);
+
+    void RunPhase_(ITaskContext& ctx, const FTimeline& timeline, u32 firstSystem, u32 lastSystem);
+    void RunSystem_(FAggregationPort& phase, ITaskContext& ctx, const FTimeline& timeline, u32 system);
+    void Playback_(u32 firstSystem, u32 lastSystem);
+
+    FEntityWorld& _world;
+    VECTOR(System, TUniquePtr<FEntry>) _systems;
+    VECTORINSITU(System, u32, 2) _syncPoints; // index of the first system after each sync point
+
+    FSystemTiming _frameTiming;
+    FSystemTiming _syncTiming;
+};
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
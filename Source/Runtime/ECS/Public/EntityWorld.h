@@ -0,0 +1,172 @@
+#pragma once
+
+#include "ECS_fwd.h"
+
+#include "Archetype.h"
+#include "ComponentMask.h"
+#include "ComponentType.h"
+#include "Entity.h"
+
+#include "Container/HashMap.h"
+#include "Container/Vector.h"
+#include "Memory/MemoryView.h"
+#include "Thread/AtomicSpinLock.h"
+
+namespace PPE {
+namespace ECS {
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+// Owns the entities and their components, grouped by archetypes:
+// - structural changes (create/destroy entities, add/remove components) move entities between archetypes,
+//   they must not race with any other access: record them in a FEntityCommandBuffer while systems are running
+// - ReserveEntity() and component lookups are the only thread-safe accesses
+// - component types are registered on first use, register them all before running systems concurrently
+//----------------------------------------------------------------------------
+class PPE_ECS_API FEntityWorld : Meta::FNonCopyableNorMovable {
+public:
+    FEntityWorld();
+    ~FEntityWorld();
+
+    /* component types */
+
+    NODISCARD size_t NumComponentTypes() const { return _numComponentTypes; }
+    NODISCARD const FComponentTypeInfo& ComponentType(FComponentId id) const {
+        Assert(id < _numComponentTypes);
+        return _componentTypes[id];
+    }
+
+    FComponentId RegisterComponent(const FComponentTypeInfo& type);
+    NODISCARD FComponentId FindComponentId(const Meta::type_info_t& type) const NOEXCEPT;
+
+    template <typename T>
+    FComponentId ComponentId() {
+        using component_type = Meta::TDecay<T>;
+        const FComponentId id = FindComponentId(Meta::type_info<component_type>);
+        return (InvalidComponentId != id ? id : RegisterComponent(FComponentTypeInfo::Make<component_type>()));
+    }
+
+    template <typename... _Components>
+    FComponentMask ComponentMask() {
+        return FComponentMask{ ComponentId<_Components>()... };
+    }
+
+    STATIC_CONST_INTEGRAL(FComponentId, InvalidComponentId, UINT32_MAX);
+
+    /* archetypes */
+
+    NODISCARD size_t NumArchetypes() const { return _archetypes.size(); }
+    NODISCARD FArchetype& Archetype(size_t index) const { return (*_archetypes[index]); }
+    NODISCARD FArchetype* FindArchetype(const FComponentMask& components) const NOEXCEPT;
+    FArchetype& FindOrAddArchetype(const FComponentMask& components);
+
+    /* entities */
+
+    NODISCARD size_t NumEntities() const { return _numEntities; }
+    NODISCARD bool Alive(FEntity entity) const NOEXCEPT;
+
+    // thread-safe, the entity is created without components by the next structural change
+    NODISCARD FEntity ReserveEntity();
+
+    FEntity CreateEntity(const FComponentMask& components = {});
+    void CreateEntities(const TMemoryView<FEntity>& entities, const FComponentMask& components);
+
+    template <typename... _Components>
+    FEntity Create(_Components&&... components);
+
+    void DestroyEntity(FEntity entity);
+    void DestroyEntities(const TMemoryView<const FEntity>& entities);
+
+    void Clear();
+
+    /* components */
+
+    NODISCARD FComponentMask Components(FEntity entity) const NOEXCEPT;
+    NODISCARD void* Component(FEntity entity, FComponentId id) const NOEXCEPT;
+
+    template <typename T>
+    NODISCARD T* Get(FEntity entity) const NOEXCEPT {
+        const FComponentId id = FindComponentId(Meta::type_info<Meta::TDecay<T>>);
+        return (InvalidComponentId != id ? static_cast<T*>(Component(entity, id)) : nullptr);
+    }
+    template <typename T>
+    NODISCARD bool Has(FEntity entity) const NOEXCEPT {
+        return (!!Get<T>(entity));
+    }
+
+    // returns the component, default constructed when it was missing
+    void* AddComponent(FEntity entity, FComponentId id);
+    void RemoveComponent(FEntity entity, FComponentId id);
+    // moves the entity only once for all the added/removed components
+    void SetComponents(FEntity entity, const FComponentMask& components);
+
+    template <typename T>
+    T& Add(FEntity entity, T&& value) {
+        using component_type = Meta::TDecay<T>;
+        component_type& component = *static_cast<component_type*>(AddComponent(entity, ComponentId<component_type>()));
+        component = std::forward<T>(value);
+        return component;
+    }
+    template <typename T>
+    void Remove(FEntity entity) {
+        RemoveComponent(entity, ComponentId<T>());
+    }
+
+private:
+    friend class FEntityCommandBuffer;
+
+    struct FEntitySlot {
+        FArchetypeChunk* Chunk{ nullptr }; // nullptr when the entity is dead or still reserved
+        u32 Row{ 0 };
+        u32 Generation{ 0 };
+    };
+
+    NODISCARD const FEntitySlot* AliveSlot_(FEntity entity) const NOEXCEPT;
+
+    FEntity NewEntity_();
+    void FlushReservedEntities_();
+    void Place_(FArchetype& archetype, const TMemoryView<const FEntity>& entities, bool construct);
+    void Move_(FEntity entity, FArchetype& dst);
+    void Remove_(FArchetypeChunk& chunk, u32 row);
+
+    size_t _numComponentTypes{ 0 };
+    FComponentTypeInfo _componentTypes[FComponentMask::Capacity];
+    HASHMAP(Component, Meta::type_info_t, FComponentId) _componentIds;
+
+    VECTOR(Component, TUniquePtr<FArchetype>) _archetypes;
+    HASHMAP(Component, FComponentMask, FArchetype*) _archetypeByMask;
+    FArchetype* _emptyArchetype{ nullptr };
+
+    size_t _numEntities{ 0 };
+    VECTOR(Entity, FEntitySlot) _entities;
+    VECTOR(Entity, u32) _freeIndices;
+
+    FAtomicSpinLock _reserveBarrier;
+    u32 _numReservedIndices{ 0 }; // new indices reserved after _entities.size()
+    VECTOR(Entity, FEntity) _reservedEntities;
+};
+//----------------------------------------------------------------------------
+template <typename... _Components>
+FEntity FEntityWorld::Create(_Components&&... components) {
+    FlushReservedEntities_();
+
+    const FComponentMask mask = ComponentMask<_Components...>();
+    Assert_NoAssume(mask.Count() == sizeof...(_Components)); // no duplicates
+
+    FArchetype& archetype = FindOrAddArchetype(mask);
+
+    const FEntity entity = NewEntity_();
+    Place_(archetype, { &entity, 1 }, false);
+
+    const FEntitySlot& slot = _entities[entity.Index];
+    FOLD_EXPR(INPLACE_NEW(
+        slot.Chunk->ComponentData(archetype.ColumnIndex(ComponentId<_Components>()), slot.Row),
+        Meta::TDecay<_Components>)(std::forward<_Components>(components)));
+
+    return entity;
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
+} //!namespace ECS
+} //!namespace PPE
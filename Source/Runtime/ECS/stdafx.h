@@ -0,0 +1,14 @@
+// stdafx.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+
+#pragma once
+
+#include "HAL/PlatformIncludes.h"
+
+#include "ECS_fwd.h"
+
+#ifdef BUILD_PCH // deprecated
+#   include "stdafx.generated.h"
+#endif
@@ -1130,6 +1130,7 @@ template <typename _Char> TBasicTextWriter<_Char>& ToString_(TBasicTextWriter<_C
         case EShaderCompilationFlags::StrongOptimization: oss << sep << STRING_LITERAL(_Char, "StrongOptimization");
         case EShaderCompilationFlags::Validate: oss << sep << STRING_LITERAL(_Char, "Validate");
         case EShaderCompilationFlags::ParseAnnotations: oss << sep << STRING_LITERAL(_Char, "ParseAnnotations");
+        case EShaderCompilationFlags::StripDebugInfo: oss << sep << STRING_LITERAL(_Char, "StripDebugInfo");
         default: AssertNotImplemented();
         }
     }
@@ -3,6 +3,7 @@
 #include "RHI_fwd.h"
 
 #include "HAL/TargetRHI.h"
+#include "Memory/MemoryView.h"
 #include "Misc/Event.h"
 #include "Misc/Function_fwd.h"
 #include "Misc/Opaque_fwd.h"
@@ -27,6 +28,8 @@ enum class EShaderCompilationFlags : u32
 
     ParseAnnotations            = 1 << 20,
 
+    StripDebugInfo              = 1 << 21, // removes names, lines and non-semantic instructions from SPIRV, for shipping
+
     _Last,
     Unknown = 0,
 };
@@ -64,6 +67,16 @@ public:
     NODISCARD inline bool Compile(FGraphicsPipelineDesc& desc, EShaderLangFormat fmt) { return Compile(desc, fmt, DefaultLogger()); }
     NODISCARD inline bool Compile(FComputePipelineDesc& desc, EShaderLangFormat fmt) { return Compile(desc, fmt, DefaultLogger()); }
 
+    // identical stages are compiled only once and the unique stages are compiled concurrently,
+    // fails if any of the pipelines failed but still compiles all the others, the logger can be called concurrently
+    NODISCARD virtual bool CompileBatch(const TMemoryView<FMeshPipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) = 0;
+    NODISCARD virtual bool CompileBatch(const TMemoryView<FGraphicsPipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) = 0;
+    NODISCARD virtual bool CompileBatch(const TMemoryView<FComputePipelineDesc>& descs, EShaderLangFormat fmt, const FLogger& logger) = 0;
+
+    NODISCARD inline bool CompileBatch(const TMemoryView<FMeshPipelineDesc>& descs, EShaderLangFormat fmt) { return CompileBatch(descs, fmt, DefaultLogger()); }
+    NODISCARD inline bool CompileBatch(const TMemoryView<FGraphicsPipelineDesc>& descs, EShaderLangFormat fmt) { return CompileBatch(descs, fmt, DefaultLogger()); }
+    NODISCARD inline bool CompileBatch(const TMemoryView<FComputePipelineDesc>& descs, EShaderLangFormat fmt) { return CompileBatch(descs, fmt, DefaultLogger()); }
+
     virtual void ReleaseUnusedMemory() = 0;
 
     enum ECompilationResult : u8 {
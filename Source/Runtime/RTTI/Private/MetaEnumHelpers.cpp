@@ -74,6 +74,7 @@ RTTI_ENUM_VALUE(Frozen)
 #ifdef WITH_RTTI_VERIFY_PREDICATES
 RTTI_ENUM_VALUE(Verifying)
 #endif
+RTTI_ENUM_VALUE(Dirty)
 RTTI_ENUM_END()
 //----------------------------------------------------------------------------
 RTTI_ENUM_HEADER(PPE_RTTI_API, EParameterFlags);
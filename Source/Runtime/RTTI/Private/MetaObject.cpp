@@ -239,6 +239,7 @@ bool FMetaObject::RTTI_PropertyCopyFrom(const FName& propName, const FAtom& src)
         const FAtom dst = prop->Get(*this);
         src.Copy(dst);
         prop->Facets().Decorate(*prop, dst.Data());
+        RTTI_MarkAsDirty();
         return true;
     }
 
@@ -255,6 +256,7 @@ bool FMetaObject::RTTI_PropertyCopyFrom(const FStringView& propName, const FAtom
         const FAtom dst = prop->Get(*this);
         src.Copy(dst);
         prop->Facets().Decorate(*prop, dst.Data());
+        RTTI_MarkAsDirty();
         return true;
     }
 
@@ -271,6 +273,7 @@ bool FMetaObject::RTTI_PropertyMoveFrom(const FName& propName, FAtom& src) NOEXC
         const FAtom dst = prop->Get(*this);
         src.Move(dst);
         prop->Facets().Decorate(*prop, dst.Data());
+        RTTI_MarkAsDirty();
         return true;
     }
 
@@ -301,6 +304,7 @@ bool FMetaObject::RTTI_PropertySet(const FName& propName, const FAny& src) {
         FAtom const dst = prop->Get(*this);
         if (src.PromoteCopy(dst)) {
             prop->Facets().Decorate(*prop, dst.Data());
+            RTTI_MarkAsDirty();
             return true;
         }
     }
@@ -320,6 +324,7 @@ bool FMetaObject::RTTI_PropertyAdd(const FName& propName, const FAny& item) {
             if (item.Traits() == plist->ValueTraits()) {
                 plist->AddCopy(dst.Data(), item.InnerAtom());
                 prop->Facets().Decorate(*prop, dst.Data());
+                RTTI_MarkAsDirty();
                 return true;
             }
             else {
@@ -327,6 +332,7 @@ bool FMetaObject::RTTI_PropertyAdd(const FName& propName, const FAny& item) {
                 if (item.PromoteCopy(promoted)) {
                     plist->AddMove(dst.Data(), promoted);
                     prop->Facets().Decorate(*prop, dst.Data());
+                    RTTI_MarkAsDirty();
                     return true;
                 }
             }
@@ -348,6 +354,7 @@ bool FMetaObject::RTTI_PropertyRemove(const FName& propName, const FAny& item) {
             if (item.Traits() == plist->ValueTraits()) {
                 plist->Remove(dst.Data(), item.InnerAtom());
                 prop->Facets().Decorate(*prop, dst.Data());
+                RTTI_MarkAsDirty();
                 return true;
             }
             else {
@@ -355,6 +362,7 @@ bool FMetaObject::RTTI_PropertyRemove(const FName& propName, const FAny& item) {
                 if (item.PromoteCopy(promoted)) {
                     plist->Remove(dst.Data(), promoted);
                     prop->Facets().Decorate(*prop, dst.Data());
+                    RTTI_MarkAsDirty();
                     return true;
                 }
             }
@@ -378,6 +386,7 @@ bool FMetaObject::RTTI_PropertyInsert(const FName& propName, const FAny& key, co
                 pdico->ValueTraits() == value.Traits() ) {
                 pdico->AddCopy(dst.Data(), key.InnerAtom(), value.InnerAtom());
                 prop->Facets().Decorate(*prop, dst.Data());
+                RTTI_MarkAsDirty();
                 return true;
             }
             else {
@@ -391,6 +400,7 @@ bool FMetaObject::RTTI_PropertyInsert(const FName& propName, const FAny& key, co
 
                 pdico->AddMove(dst.Data(), promotedKey, promotedValue);
                 prop->Facets().Decorate(*prop, dst.Data());
+                RTTI_MarkAsDirty();
                 return true;
             }
         }
@@ -411,6 +421,7 @@ bool FMetaObject::RTTI_PropertyErase(const FName& propName, const FAny& key) {
             if (pdico->KeyTraits() == key.Traits()) {
                 if (pdico->Remove(dst.Data(), key.InnerAtom())) {
                     prop->Facets().Decorate(*prop, dst.Data());
+                    RTTI_MarkAsDirty();
                     return true;
                 }
                 return false;
@@ -420,6 +431,7 @@ bool FMetaObject::RTTI_PropertyErase(const FName& propName, const FAny& key) {
                 if (key.PromoteCopy(promotedKey)) {
                     pdico->Remove(dst.Data(), promotedKey);
                     prop->Facets().Decorate(*prop, dst.Data());
+                    RTTI_MarkAsDirty();
                     return true;
                 }
             }
@@ -434,7 +446,8 @@ void FMetaObject::RTTI_Load(ILoadContext& context) {
     Assert_NoAssume(not RTTI_IsFrozen());
     Assert_NoAssume(RTTI_IsUnloaded());
 
-    _flags = _flags + EObjectFlags::Loaded - EObjectFlags::Unloaded;
+    // freshly loaded objects are synchronized with their source
+    _flags = _flags + EObjectFlags::Loaded - EObjectFlags::Unloaded - EObjectFlags::Dirty;
 
 #ifdef WITH_RTTI_VERIFY_PREDICATES
     // checks that base method was called :
@@ -498,7 +511,7 @@ void FMetaObject::RTTI_MarkAsTopObject() {
     Assert_NoAssume(not RTTI_IsFrozen());
     Assert_NoAssume(not RTTI_IsTopObject());
 
-    _flags = _flags + EObjectFlags::TopObject;
+    _flags = _flags + EObjectFlags::TopObject + EObjectFlags::Dirty;
 }
 //----------------------------------------------------------------------------
 void FMetaObject::RTTI_UnmarkAsTopObject() {
@@ -506,7 +519,7 @@ void FMetaObject::RTTI_UnmarkAsTopObject() {
     Assert_NoAssume(not RTTI_IsFrozen());
     Assert_NoAssume(RTTI_IsTopObject());
 
-    _flags = _flags - EObjectFlags::TopObject;
+    _flags = _flags - EObjectFlags::TopObject + EObjectFlags::Dirty;
 }
 //----------------------------------------------------------------------------
 #ifdef WITH_RTTI_VERIFY_PREDICATES
@@ -599,6 +612,7 @@ static TBasicTextWriter<_Char>& Print_(TBasicTextWriter<_Char>& oss, RTTI::EObje
 #ifdef WITH_RTTI_VERIFY_PREDICATES
     if (flags & RTTI::EObjectFlags::Verifying)  { oss << sep << STRING_LITERAL(_Char, "Verifying"); }
 #endif
+    if (flags & RTTI::EObjectFlags::Dirty)      { oss << sep << STRING_LITERAL(_Char, "Dirty"); }
 
     return oss;
 }
@@ -2,13 +2,13 @@
 
 #include "MetaProperty.h"
 
+#include "MetaObject.h"
 #include "RTTI/Exceptions.h"
 
 #include "IO/FormatHelpers.h"
 #include "IO/TextWriter.h"
 
 #ifdef WITH_PPE_RTTI_PROPERTY_CHECKS
-#   include "MetaObject.h"
 #   include "Diagnostic/Logger.h"
 #   define CheckPropertyIFN(obj, write) CheckProperty_(obj, write)
 namespace PPE {
@@ -53,16 +53,19 @@ void FMetaProperty::CopyTo(const FMetaObject& obj, const FAtom& dst) const {
 void FMetaProperty::MoveTo(FMetaObject& obj, const FAtom& dst) const NOEXCEPT {
     CheckPropertyIFN(obj, true);
     MakeAtom_(obj).Move(dst);
+    obj.RTTI_MarkAsDirty();
 }
 //----------------------------------------------------------------------------
 void FMetaProperty::CopyFrom(FMetaObject& obj, const FAtom& src) const {
     CheckPropertyIFN(obj, true);
     src.Copy(MakeAtom_(obj));
+    obj.RTTI_MarkAsDirty();
 }
 //----------------------------------------------------------------------------
 void FMetaProperty::MoveFrom(FMetaObject& obj, FAtom& src) const NOEXCEPT {
     CheckPropertyIFN(obj, true);
     src.Move(MakeAtom_(obj));
+    obj.RTTI_MarkAsDirty();
 }
 //----------------------------------------------------------------------------
 FAtom FMetaProperty::ResetToDefaultValue(FMetaObject& obj) const NOEXCEPT {
@@ -3,6 +3,7 @@
 #include "MetaTransaction.h"
 
 #include "RTTI/AtomVisitor.h"
+#include "RTTI/ReferenceCollector.h"
 
 #include "MetaDatabase.h"
 #include "MetaObject.h"
@@ -34,52 +35,29 @@ void LinearizeTransaction_(
     Assert_NoAssume(linearized->LoadedRefs.empty());
     Assert_NoAssume(linearized->ExportedRefs.empty());
 
-    HASHSET(MetaTransaction, const FMetaObject*) visiteds;
-    visiteds.reserve(topObjects.size());
-    linearized->LoadedRefs.reserve(visiteds.size());
+    // walks the whole graph in parallel, imported objects are not traversed
+    FParallelReferenceCollector::FResults collected;
+    FParallelReferenceCollector{
+        EVisitorFlags::Unknown +
+        (outer.KeepDeprecated() ? EVisitorFlags::KeepDeprecated : EVisitorFlags{ 0 }) +
+        (outer.KeepTransient() ? EVisitorFlags::KeepTransient : EVisitorFlags{ 0 })
+    }.Collect(topObjects, &collected, &outer);
 
-    CollectReferences(
-        topObjects,
-#if WITH_PPE_RTTI_TRANSACTION_CHECKS
-        [linearized, &outer, &visiteds](const ITypeTraits&, FMetaObject& obj) {
-#else
-        [linearized, &visiteds](const ITypeTraits&, FMetaObject& obj) {
-#endif
-            if (not visiteds.insert_ReturnIfExists(&obj)) {
-                if (obj.RTTI_IsExported()) {
-                    if (obj.RTTI_Outer() == nullptr) {
-                        linearized->ExportedRefs.emplace_back(&obj);
-                    }
-                    else {
-                        AssertRelease(obj.RTTI_IsLoaded());
+    // can't reference non-exported, non-local objects, or objects from unloaded transactions
+    AssertRelease(not collected.HasDanglings());
 
 #if WITH_PPE_RTTI_TRANSACTION_CHECKS
-                        PPE_CLOG(obj.RTTI_Outer()->Linearized().HasImport(outer), RTTI, Fatal,
-                            "found a circular transaction import : {0} <=> {1}",
-                            outer.Namespace(), obj.RTTI_Outer()->Namespace() );
+    for (const SMetaObject& imported : collected.Imported) {
+        PPE_CLOG(imported->RTTI_Outer()->Linearized().HasImport(outer), RTTI, Fatal,
+            "found a circular transaction import : {0} <=> {1}",
+            outer.Namespace(), imported->RTTI_Outer()->Namespace() );
+    }
 #endif
 
-                        linearized->ImportedRefs.emplace_back(&obj);
-                        return false; // don't recurse on imported objects
-                    }
-                }
-
-                Assert_NoAssume(obj.RTTI_Outer() == nullptr); // can't reference non-exported, non-local objects
-                return true;
-            }
-            else {
-                return false; // don't recurse if already visited
-            }
-
-        },
-        [linearized](const ITypeTraits&, FMetaObject& obj) {
-            Add_AssertUnique(linearized->LoadedRefs, SMetaObject{ &obj }); // postfix order
-            return true; // never fails recursion here
-        },
-        (EVisitorFlags::Unknown +
-            (outer.KeepDeprecated() ? EVisitorFlags::KeepDeprecated : EVisitorFlags{ 0 }) +
-            (outer.KeepTransient() ? EVisitorFlags::KeepTransient : EVisitorFlags{ 0 }))
-        );
+    // postfix order : referenced objects are always loaded before their referencers
+    linearized->LoadedRefs.assign(collected.Reachable.begin(), collected.Reachable.end());
+    linearized->ExportedRefs.assign(collected.Exported.begin(), collected.Exported.end());
+    linearized->ImportedRefs.assign(collected.Imported.begin(), collected.Imported.end());
 
     Assert_NoAssume(linearized->LoadedRefs.size() >= topObjects.size());
     Assert_NoAssume(linearized->ExportedRefs.size() <= linearized->LoadedRefs.size());
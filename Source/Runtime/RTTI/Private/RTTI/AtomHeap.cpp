@@ -3,11 +3,27 @@
 #include "RTTI/AtomHeap.h"
 #include "RTTI/Typedefs.h"
 
+#include "Allocator/StaticAllocator.h"
+#include "Meta/AutoSingleton.h"
+
 namespace PPE {
 namespace RTTI {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+using FAtomChunkAllocator_ = TStaticAllocator<ALLOCATOR(Atom)>;
+//----------------------------------------------------------------------------
+class FAtomHeapTLS_ : public Meta::TThreadLocalAutoSingleton<FAtomHeapTLS_> {
+public:
+    const PAtomHeap Heap{ NEW_REF(Atom, FAtomHeap) };
+};
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
 FAtomHeap::FAtomHeap() = default;
 //----------------------------------------------------------------------------
 FAtomHeap::~FAtomHeap() {
@@ -15,12 +31,63 @@ FAtomHeap::~FAtomHeap() {
 
     ReleaseAll();
     Assert(nullptr == _destructibles);
+    Assert(nullptr == _chunks);
+    Assert(nullptr == _freeChunks);
+}
+//----------------------------------------------------------------------------
+FAtomHeap& FAtomHeap::ThreadLocal() {
+    return (*FAtomHeapTLS_::Get().Heap);
+}
+//----------------------------------------------------------------------------
+FAny FAtomHeap::Promote(const FAtom& atom) {
+    FAny result;
+    if (atom)
+        result.AssignCopy(atom);
+    return result;
+}
+//----------------------------------------------------------------------------
+FAny FAtomHeap::PromoteMove(const FAtom& atom) NOEXCEPT {
+    FAny result;
+    if (atom)
+        result.AssignMove(atom);
+    return result;
+}
+//----------------------------------------------------------------------------
+auto FAtomHeap::Mark() const NOEXCEPT -> FMark {
+    FMark mark;
+    mark.Chunk = _chunks;
+    mark.Offset = (_chunks ? _chunks->Offset : 0);
+    mark.NumAllocations = _stats.NumAllocations;
+    mark.BytesInUse = _stats.BytesInUse;
+    mark.Destructibles = _destructibles;
+    return mark;
+}
+//----------------------------------------------------------------------------
+void FAtomHeap::Rewind(const FMark& mark) {
+    PPE_DATARACE_CHECK_SCOPE(this);
+    Assert(mark.NumAllocations <= _stats.NumAllocations);
+    Assert(mark.BytesInUse <= _stats.BytesInUse);
+
+    // destroy non-trivial atoms allocated after the mark, in reverse order
+    ReleaseDestructibles_(mark.Destructibles);
+
+    // recycle the chunks allocated after the mark, then rewind the bump offset
+    ReleaseChunks_(mark.Chunk, true);
+
+    if (_chunks) {
+        Assert(_chunks == mark.Chunk);
+        Assert(mark.Offset <= _chunks->Offset);
+        _chunks->Offset = mark.Offset;
+    }
+
+    _stats.NumAllocations = mark.NumAllocations;
+    _stats.BytesInUse = mark.BytesInUse;
 }
 //----------------------------------------------------------------------------
 NO_INLINE void FAtomHeap::DiscardAll() {
     PPE_DATARACE_CHECK_SCOPE(this);
 
-    ReleaseDestructibles_();
+    Rewind(FMark{});
 
     _heap.DiscardAll();
 }
@@ -28,7 +95,25 @@ NO_INLINE void FAtomHeap::DiscardAll() {
 NO_INLINE void FAtomHeap::ReleaseAll() {
     PPE_DATARACE_CHECK_SCOPE(this);
 
-    ReleaseDestructibles_();
+    ReleaseDestructibles_(nullptr);
+    ReleaseChunks_(nullptr, false);
+
+    while (_freeChunks) {
+        FChunk_* const pChunk = _freeChunks;
+        _freeChunks = pChunk->pPrev;
+
+        _stats.BytesReserved -= (sizeof(FChunk_) + pChunk->Capacity);
+        _stats.NumFreeChunks--;
+        _stats.NumChunks--;
+
+        FAtomChunkAllocator_::Deallocate(FAllocatorBlock{ pChunk, sizeof(FChunk_) + pChunk->Capacity });
+    }
+
+    Assert_NoAssume(0 == _stats.NumChunks);
+    Assert_NoAssume(0 == _stats.BytesReserved);
+
+    _stats.NumAllocations = 0;
+    _stats.BytesInUse = 0;
 
     _heap.ReleaseAll();
 }
@@ -38,36 +123,111 @@ FAtom FAtomHeap::MakeAtomUinitialized_(const PTypeTraits& traits) {
 
     const FTypeInfos typeInfos = traits->TypeInfos();
     Assert(typeInfos.SizeInBytes());
+    Assert_NoAssume(typeInfos.Alignment() <= ALLOCATION_BOUNDARY);
 
     if (typeInfos.Flags() & ETypeFlags::TriviallyDestructible)
-        return { _heap.Allocate(typeInfos.SizeInBytes()), traits };
+        return { BumpAllocate_(typeInfos.SizeInBytes()), traits };
 
     // track non-trivial type instances for destruction
     FPendingDestroy_* const pBlock = INPLACE_NEW(
-        _heap.Allocate(sizeof(FPendingDestroy_) + typeInfos.SizeInBytes()),
+        BumpAllocate_(sizeof(FPendingDestroy_) + typeInfos.SizeInBytes()),
         FPendingDestroy_ );
 
     pBlock->Traits = traits;
     pBlock->pNext = _destructibles;
     _destructibles = pBlock;
+    _stats.NumDestructibles++;
 
     return { pBlock + 1, traits };
 }
 //----------------------------------------------------------------------------
-void FAtomHeap::ReleaseDestructibles_() {
-    PPE_DATARACE_CHECK_SCOPE(this);
+FORCE_INLINE void* FAtomHeap::BumpAllocate_(size_t sizeInBytes) {
+    sizeInBytes = ROUND_TO_NEXT_16(sizeInBytes);
+    STATIC_ASSERT(ALLOCATION_BOUNDARY == 16);
+
+    _stats.NumAllocations++;
+    _stats.BytesInUse += sizeInBytes;
+    _stats.PeakBytesInUse = Max(_stats.PeakBytesInUse, _stats.BytesInUse);
+
+    if (Likely(_chunks && _chunks->Offset + sizeInBytes <= _chunks->Capacity)) {
+        void* const p = (_chunks->Data() + _chunks->Offset);
+        _chunks->Offset += checked_cast<u32>(sizeInBytes);
+        return p;
+    }
 
+    return AllocateFromNewChunk_(sizeInBytes);
+}
+//----------------------------------------------------------------------------
+void* FAtomHeap::AllocateFromNewChunk_(size_t sizeInBytes) {
+    STATIC_CONST_INTEGRAL(u32, DefaultCapacity, ChunkSize - sizeof(FChunk_));
+
+    FChunk_* pChunk;
+    if (Likely(sizeInBytes <= DefaultCapacity / 4)) {
+        if (_freeChunks) {
+            pChunk = _freeChunks;
+            _freeChunks = pChunk->pPrev;
+            _stats.NumFreeChunks--;
+        }
+        else {
+            pChunk = static_cast<FChunk_*>(FAtomChunkAllocator_::Allocate(ChunkSize).Data);
+            pChunk->Capacity = DefaultCapacity;
+            _stats.BytesReserved += ChunkSize;
+            _stats.NumChunks++;
+        }
+    }
+    else {
+        // large atoms get a dedicated chunk, released on Rewind()
+        pChunk = static_cast<FChunk_*>(FAtomChunkAllocator_::Allocate(sizeof(FChunk_) + sizeInBytes).Data);
+        pChunk->Capacity = checked_cast<u32>(sizeInBytes);
+        _stats.BytesReserved += (sizeof(FChunk_) + sizeInBytes);
+        _stats.NumChunks++;
+    }
+
+    Assert(pChunk);
+    Assert_NoAssume(Meta::IsAlignedPow2(ALLOCATION_BOUNDARY, pChunk));
+
+    pChunk->pPrev = _chunks;
+    pChunk->Offset = checked_cast<u32>(sizeInBytes);
+    _chunks = pChunk;
+
+    return pChunk->Data();
+}
+//----------------------------------------------------------------------------
+void FAtomHeap::ReleaseDestructibles_(const FPendingDestroy_* last) {
     // destroy non-trivial type instances :
-    for (FPendingDestroy_* it = _destructibles; it; ) {
+    for (FPendingDestroy_* it = _destructibles; it != last; ) {
+        Assert(it);
         FPendingDestroy_* const pNext = it->pNext;
 
         it->Traits->Destroy(it + 1);
-        _heap.Deallocate(it, sizeof(FPendingDestroy_) + it->Traits->SizeInBytes());
+        _stats.NumDestructibles--;
 
         it = pNext;
     }
 
-    _destructibles = nullptr;
+    _destructibles = const_cast<FPendingDestroy_*>(last);
+}
+//----------------------------------------------------------------------------
+void FAtomHeap::ReleaseChunks_(const FChunk_* last, bool keepFreeChunks) {
+    STATIC_CONST_INTEGRAL(u32, DefaultCapacity, ChunkSize - sizeof(FChunk_));
+
+    while (_chunks != last) {
+        Assert(_chunks);
+        FChunk_* const pChunk = _chunks;
+        _chunks = pChunk->pPrev;
+
+        if (keepFreeChunks && pChunk->Capacity == DefaultCapacity) {
+            pChunk->pPrev = _freeChunks;
+            _freeChunks = pChunk;
+            _stats.NumFreeChunks++;
+        }
+        else {
+            _stats.BytesReserved -= (sizeof(FChunk_) + pChunk->Capacity);
+            _stats.NumChunks--;
+
+            FAtomChunkAllocator_::Deallocate(FAllocatorBlock{ pChunk, sizeof(FChunk_) + pChunk->Capacity });
+        }
+    }
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
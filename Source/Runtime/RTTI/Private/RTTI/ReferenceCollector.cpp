@@ -2,7 +2,16 @@
 
 #include "RTTI/ReferenceCollector.h"
 
+#include "MetaClass.h"
 #include "MetaObject.h"
+#include "MetaProperty.h"
+
+#include "Container/HashMap.h"
+#include "Thread/Task/TaskContext.h"
+#include "Thread/Task/TaskHelpers.h"
+
+#include <algorithm>
+#include <atomic>
 
 namespace PPE {
 namespace RTTI {
@@ -130,5 +139,257 @@ bool FLambdaReferenceCollector::Visit(const IScalarTraits* scalar, PMetaObject&
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// collects direct references of an object, without recursing in them
+class FReferenceEdgeVisitor_ final : public FBaseAtomVisitor {
+public:
+    using FEdges = VECTOR(MetaObject, FMetaObject*);
+
+    explicit FReferenceEdgeVisitor_(EVisitorFlags flags) NOEXCEPT
+    :   FBaseAtomVisitor(flags + EVisitorFlags::OnlyObjects - EVisitorFlags::NoRecursion)
+    {}
+
+    void Expand(FMetaObject& obj, FEdges* edges) {
+        Assert(edges);
+        Assert_NoAssume(nullptr == _edges);
+
+        // same filtering than IAtomVisitor::Accept(PMetaObject&)
+        if ((not KeepTransient()) && obj.RTTI_IsTransient())
+            return;
+
+        _edges = edges;
+
+        for (const FMetaProperty* prop : obj.RTTI_Class()->AllProperties()) {
+            if ((KeepDeprecated() || (not prop->IsDeprecated())) &&
+                (KeepTransient() || (not prop->IsTransient())) &&
+                (not ShouldSkipTraits(this, *prop->Traits())) )
+                prop->Get(obj).Accept(this);
+        }
+
+        _edges = nullptr;
+    }
+
+    using FBaseAtomVisitor::Visit;
+
+    virtual bool Visit(const IScalarTraits* , PMetaObject& pobj) override final {
+        if (pobj)
+            _edges->push_back(pobj.get());
+        return true; // don't recurse, referenced objects are expanded with the next level
+    }
+
+private:
+    FEdges* _edges{ nullptr };
+};
+//----------------------------------------------------------------------------
+struct FParallelExpandLevel_ {
+    STATIC_CONST_INTEGRAL(u32, BatchSize, 8);
+
+    EVisitorFlags Flags;
+    TMemoryView<FMetaObject* const> Objects;
+    TMemoryView<FReferenceEdgeVisitor_::FEdges> Edges;
+    std::atomic<u32> Cursor{ 0 };
+
+    // workers steal batches of objects until the level is completed
+    void Worker() {
+        FReferenceEdgeVisitor_ visitor{ Flags };
+
+        const u32 n = checked_cast<u32>(Objects.size());
+        for (u32 first; (first = Cursor.fetch_add(BatchSize, std::memory_order_relaxed)) < n; ) {
+            const u32 last = Min(first + BatchSize, n);
+            forrange(i, first, last)
+                visitor.Expand(*Objects[i], &Edges[i]);
+        }
+    }
+};
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+void FParallelReferenceCollector::FResults::Reset() {
+    Reachable.clear();
+    Exported.clear();
+    Imported.clear();
+    Dangling.clear();
+    Cyclics.clear();
+    NumReferences = 0;
+}
+//----------------------------------------------------------------------------
+FParallelReferenceCollector::FParallelReferenceCollector(EVisitorFlags flags, ITaskContext* context/* = nullptr */) NOEXCEPT
+:   _flags(flags)
+,   _context(context)
+{}
+//----------------------------------------------------------------------------
+void FParallelReferenceCollector::Collect(const FMetaObject& root, FResults* results, const FMetaTransaction* outer/* = nullptr */) const {
+    const PMetaObject pobj{ const_cast<FMetaObject*>(&root) };
+    Collect(MakeView(&pobj, &pobj + 1), results, outer);
+}
+//----------------------------------------------------------------------------
+void FParallelReferenceCollector::Collect(const TMemoryView<const PMetaObject>& roots, FResults* results, const FMetaTransaction* outer/* = nullptr */) const {
+    Assert(results);
+    Assert_NoAssume(not roots.empty());
+
+    STATIC_CONST_INTEGRAL(u32, NotLocal, UMax);
+    STATIC_CONST_INTEGRAL(size_t, ParallelThreshold, 32);
+
+    results->Reset();
+
+    // mark: walk the graph level by level, only local objects are indexed and expanded
+
+    HASHMAP(MetaObject, const FMetaObject*, u32) visiteds;
+    VECTOR(MetaObject, FMetaObject*) nodes;
+    VECTOR(MetaObject, u32) edges;
+    VECTOR(MetaObject, u32) edgeOffsets;
+
+    visiteds.reserve(roots.size());
+    nodes.reserve(roots.size());
+    edgeOffsets.reserve(roots.size() + 1);
+
+    const auto discover = [&](FMetaObject& obj) -> u32 {
+        const auto it = visiteds.try_emplace(&obj, NotLocal);
+        if (it.second) {
+            if (obj.RTTI_Outer() == nullptr || obj.RTTI_Outer() == outer) {
+                it.first->second = checked_cast<u32>(nodes.size());
+                nodes.push_back(&obj);
+
+                if (obj.RTTI_IsExported())
+                    results->Exported.emplace_back(&obj);
+            }
+            else if (obj.RTTI_IsExported() && obj.RTTI_IsLoaded()) {
+                results->Imported.emplace_back(&obj);
+            }
+            else {
+                results->Dangling.emplace_back(&obj);
+            }
+        }
+        return it.first->second;
+    };
+
+    for (const PMetaObject& pobj : roots) {
+        Assert(pobj);
+        discover(*pobj);
+    }
+
+    ITaskContext* const context = (_context ? _context : GlobalTaskContext());
+    Assert(context);
+
+    VECTOR(MetaObject, FReferenceEdgeVisitor_::FEdges) levelEdges;
+
+    for (size_t levelBegin = 0; levelBegin < nodes.size(); ) {
+        const size_t levelEnd = nodes.size();
+        const TMemoryView<FMetaObject* const> level = nodes.MakeConstView().SubRange(levelBegin, levelEnd - levelBegin);
+
+        levelEdges.resize(level.size());
+        for (FReferenceEdgeVisitor_::FEdges& it : levelEdges)
+            it.clear();
+
+        // expand: visiting RTTI properties is the expensive part, each object is processed independently
+        if (level.size() < ParallelThreshold) {
+            FReferenceEdgeVisitor_ visitor{ _flags };
+            forrange(i, 0, level.size())
+                visitor.Expand(*level[i], &levelEdges[i]);
+        }
+        else {
+            FParallelExpandLevel_ expand{ _flags, level, levelEdges.MakeView() };
+
+            const size_t numBatches = ((level.size() + FParallelExpandLevel_::BatchSize - 1) / FParallelExpandLevel_::BatchSize);
+            ParallelFor(0, Min(context->WorkerCount(), numBatches),
+                [&expand](size_t) { expand.Worker(); },
+                ETaskPriority::Normal, context );
+        }
+
+        // merge: sequential and in level order, so the result does not depend on scheduling
+        forrange(i, 0, level.size()) {
+            edgeOffsets.push_back(checked_cast<u32>(edges.size()));
+
+            for (FMetaObject* ref : levelEdges[i]) {
+                results->NumReferences++;
+
+                const u32 target = discover(*ref);
+                if (NotLocal != target)
+                    edges.push_back(target);
+            }
+        }
+
+        levelBegin = levelEnd;
+    }
+
+    edgeOffsets.push_back(checked_cast<u32>(edges.size()));
+    Assert_NoAssume(edgeOffsets.size() == nodes.size() + 1);
+
+    // sort: topological order with dependencies first, what remains is on a cycle or depends on one
+
+    const u32 numNodes = checked_cast<u32>(nodes.size());
+
+    VECTOR(MetaObject, u32) pendings; // number of unique dependencies not sorted yet
+    VECTOR(MetaObject, u32) predOffsets;
+    VECTOR(MetaObject, u32) preds;
+
+    pendings.resize_AssumeEmpty(numNodes, 0);
+    predOffsets.resize_AssumeEmpty(numNodes + 1, 0);
+
+    forrange(n, 0, numNodes) {
+        const auto first = edges.begin() + edgeOffsets[n];
+        const auto last = edges.begin() + edgeOffsets[n + 1];
+        std::sort(first, last);
+
+        for (auto it = first; it != last; ++it) {
+            if (it != first && *it == *(it - 1))
+                continue; // duplicate reference
+
+            pendings[n]++;
+            predOffsets[*it + 1]++;
+        }
+    }
+
+    forrange(n, 0, numNodes)
+        predOffsets[n + 1] += predOffsets[n];
+
+    preds.resize_AssumeEmpty(predOffsets.back());
+    {
+        VECTOR(MetaObject, u32) cursors;
+        cursors.assign(predOffsets.begin(), predOffsets.end() - 1);
+        forrange(n, 0, numNodes) {
+            forrange(e, edgeOffsets[n], edgeOffsets[n + 1]) {
+                if (e != edgeOffsets[n] && edges[e] == edges[e - 1])
+                    continue;
+                preds[cursors[edges[e]]++] = n;
+            }
+        }
+    }
+
+    VECTOR(MetaObject, u32) sorteds;
+    sorteds.reserve(numNodes);
+
+    forrange(n, 0, numNodes) {
+        if (0 == pendings[n])
+            sorteds.push_back(n);
+    }
+
+    for (size_t head = 0; head < sorteds.size(); ++head) {
+        const u32 n = sorteds[head];
+        forrange(p, predOffsets[n], predOffsets[n + 1]) {
+            if (0 == --pendings[preds[p]])
+                sorteds.push_back(preds[p]);
+        }
+    }
+
+    results->Reachable.reserve(numNodes);
+    for (u32 n : sorteds)
+        results->Reachable.emplace_back(nodes[n]);
+
+    if (sorteds.size() < numNodes) {
+        forrange(n, 0, numNodes) {
+            if (pendings[n]) {
+                results->Cyclics.emplace_back(nodes[n]);
+                results->Reachable.emplace_back(nodes[n]);
+            }
+        }
+    }
+
+    Assert_NoAssume(results->Reachable.size() == numNodes);
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
 } //!namespace RTTI
 } //!namespace PPE
@@ -35,6 +35,7 @@ enum class EObjectFlags : u32 {
 #ifdef WITH_RTTI_VERIFY_PREDICATES
     Verifying   = 1<<6,
 #endif
+    Dirty       = 1<<7, // modified since last saved, see FMetaProperty write barrier
 
     All         = UINT32_MAX
 };
@@ -77,6 +78,7 @@ public:
     bool RTTI_IsFrozen() const      { return (_flags ^ EObjectFlags::Frozen     ); }
     bool RTTI_IsTopObject() const   { return (_flags ^ EObjectFlags::TopObject  ); }
     bool RTTI_IsTransient() const   { return (_flags ^ EObjectFlags::Transient  ); }
+    bool RTTI_IsDirty() const       { return (_flags ^ EObjectFlags::Dirty      ); }
 
     const FMetaTransaction* RTTI_Outer() const { return _outer.get(); }
     void RTTI_SetOuter(const FMetaTransaction* outer, const FMetaTransaction* prevOuterForDbg = nullptr);
@@ -93,6 +95,11 @@ public:
     void RTTI_Freeze(); // frozen object can't be modified
     void RTTI_Unfreeze();
 
+    // every write through RTTI marks the object as dirty, but native code writing directly
+    // to the members must call RTTI_MarkAsDirty() to be picked by incremental saves
+    void RTTI_MarkAsDirty() { _flags = _flags + EObjectFlags::Dirty; }
+    void RTTI_ClearDirty() { _flags = _flags - EObjectFlags::Dirty; } // should only be called by serializers
+
     void RTTI_Export(const FName& name);
     void RTTI_Unexport();
 
@@ -10,15 +10,61 @@
 #include "Memory/RefPtr.h"
 #include "Thread/DataRaceCheck.h"
 
+#include "RTTI/Any.h"
+
 namespace PPE {
 namespace RTTI {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
-// Use a FSlabHeap for transient FAtom allocation
+// Transient FAtom allocation:
+// - atoms are bump allocated in chunks, Rewind() releases everything allocated
+//   since a mark in O(1) (only non-trivial atoms need to be destroyed)
+// - containers stored inside atoms use the FSlabHeap exposed by Heap()
+// - there is no locking: use ThreadLocal() for one heap per thread
 //----------------------------------------------------------------------------
 class PPE_RTTI_API FAtomHeap : public FRefCountable, FDataRaceCheckResource {
+    struct FChunk_;
+    struct FPendingDestroy_;
+
 public:
+    STATIC_CONST_INTEGRAL(u32, ChunkSize, 64 * 1024);
+
+    struct FMark {
+        FChunk_* Chunk{ nullptr };
+        u32 Offset{ 0 };
+        u32 NumAllocations{ 0 };
+        size_t BytesInUse{ 0 };
+        FPendingDestroy_* Destructibles{ nullptr };
+    };
+
+    struct FStatistics {
+        u32 NumAllocations{ 0 };
+        u32 NumDestructibles{ 0 };
+        u32 NumChunks{ 0 };
+        u32 NumFreeChunks{ 0 };
+        size_t BytesInUse{ 0 };
+        size_t BytesReserved{ 0 };
+        size_t PeakBytesInUse{ 0 };
+    };
+
+    // release every atom allocated since construction when going out of scope
+    class FScope : Meta::FNonCopyableNorMovable {
+    public:
+        explicit FScope(FAtomHeap& heap) NOEXCEPT
+        :   _heap(heap)
+        ,   _mark(heap.Mark())
+        {}
+        ~FScope() { _heap.Rewind(_mark); }
+
+        FAtomHeap& Heap() const { return _heap; }
+        const FMark& Mark() const { return _mark; }
+
+    private:
+        FAtomHeap& _heap;
+        const FMark _mark;
+    };
+
     FAtomHeap();
     ~FAtomHeap();
 
@@ -27,6 +73,11 @@ public:
 
     SLABHEAP(Atom)& Heap() { return _heap; }
 
+    const FStatistics& Statistics() const { return _stats; }
+
+    // lazily created for each thread, destroyed with the thread context
+    static FAtomHeap& ThreadLocal();
+
     FAtom Allocate(ENativeType type) {
         return Allocate(MakeTraits(type));
     }
@@ -51,7 +102,7 @@ public:
 
     template <typename T>
     FAtom AllocateCopy(const T& other) {
-        return AllocateMove(MakeTraits<T>(), &other);
+        return AllocateCopy(MakeTraits<T>(), &other);
     }
 
     template <typename T>
@@ -59,20 +110,41 @@ public:
         return AllocateMove(MakeTraits<T>(), &rvalue);
     }
 
+    // copy/move a transient atom to a value owned by the caller, which can outlive the heap
+    NODISCARD static FAny Promote(const FAtom& atom);
+    NODISCARD static FAny PromoteMove(const FAtom& atom) NOEXCEPT;
+
+    NODISCARD FMark Mark() const NOEXCEPT;
+    void Rewind(const FMark& mark);
+
     void DiscardAll();
     void ReleaseAll();
 
 private:
+    struct ALIGN(ALLOCATION_BOUNDARY) FChunk_ {
+        FChunk_* pPrev;
+        u32 Capacity;
+        u32 Offset;
+
+        u8* Data() { return reinterpret_cast<u8*>(this + 1); }
+    };
+
     struct ALIGN(ALLOCATION_BOUNDARY) FPendingDestroy_ {
         PTypeTraits Traits;
         FPendingDestroy_* pNext;
     };
 
     SLABHEAP(Atom) _heap;
+    FChunk_* _chunks{ nullptr };
+    FChunk_* _freeChunks{ nullptr };
     FPendingDestroy_* _destructibles{ nullptr };
+    FStatistics _stats;
 
     FAtom MakeAtomUinitialized_(const PTypeTraits& traits);
-    void ReleaseDestructibles_();
+    void* BumpAllocate_(size_t sizeInBytes);
+    NO_INLINE void* AllocateFromNewChunk_(size_t sizeInBytes);
+    void ReleaseDestructibles_(const FPendingDestroy_* last);
+    void ReleaseChunks_(const FChunk_* last, bool keepFreeChunks);
 };
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -5,7 +5,9 @@
 #include "RTTI/AtomVisitor.h"
 
 #include "Container/SparseArray.h"
+#include "Container/Vector.h"
 #include "Misc/Function.h"
+#include "Thread/Task_fwd.h"
 
 namespace PPE {
 namespace RTTI {
@@ -74,6 +76,42 @@ private:
     FOnReference _postfix;
 };
 //----------------------------------------------------------------------------
+// Walks the whole object graph in one pass, expanding each level of the graph
+// in parallel on the task context (FGlobalThreadPool by default).
+// - objects owned by another transaction are never traversed
+// - results are deterministic, no matter how many workers were used
+//----------------------------------------------------------------------------
+class PPE_RTTI_API FParallelReferenceCollector : Meta::FNonCopyableNorMovable {
+public:
+    using FReferences = VECTOR(MetaObject, SMetaObject);
+
+    struct FResults {
+        FReferences Reachable;  // local objects, dependencies first (postfix order)
+        FReferences Exported;   // local objects which are exported
+        FReferences Imported;   // exported by another transaction, not traversed
+        FReferences Dangling;   // owned by another transaction, but not exported or not loaded
+        FReferences Cyclics;    // local objects in (or depending on) a circular reference, also appended to Reachable
+        size_t NumReferences{ 0 };
+
+        bool HasCycles() const { return (not Cyclics.empty()); }
+        bool HasDanglings() const { return (not Dangling.empty()); }
+
+        void Reset();
+    };
+
+    explicit FParallelReferenceCollector(EVisitorFlags flags = EVisitorFlags::Unknown, ITaskContext* context = nullptr) NOEXCEPT;
+
+    EVisitorFlags Flags() const { return _flags; }
+
+    // local objects have no outer or are owned by outer
+    void Collect(const FMetaObject& root, FResults* results, const FMetaTransaction* outer = nullptr) const;
+    void Collect(const TMemoryView<const PMetaObject>& roots, FResults* results, const FMetaTransaction* outer = nullptr) const;
+
+private:
+    EVisitorFlags _flags;
+    ITaskContext* _context;
+};
+//----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 } //!namespace RTTI
@@ -120,6 +120,7 @@ struct FBinaryFormat {
         HasBulkData             = 1<<0,
         HasExternalExports      = 1<<1,
         HasExternalImports      = 1<<2,
+        IsDelta                 = 1<<3,
     };
     ENUM_FLAGS_FRIEND(EHeaderFlags);
 
@@ -134,6 +135,20 @@ struct FBinaryFormat {
     STATIC_ASSERT(Meta::IsAlignedPow2(16, sizeof(FHeaders)));
     STATIC_ASSERT(sizeof(FHeaders) == sizeof(FFourCC) * 2 + sizeof(EHeaderFlags) + sizeof(u32) + sizeof(FContents) + sizeof(FSections));
 
+    // a file is a sequence of chunks: one complete image followed by optional delta chunks,
+    // each chunk is a self-contained BINA stream with offsets relative to its own headers
+    static u32 ChunkSize(const FHeaders& h) {
+        return checked_cast<u32>(ROUND_TO_NEXT_16(h.Sections.Bulk.End()));
+    }
+
+    // prefix of .Data in delta chunks, followed by the global index of each object in the chunk:
+    // indices below NumObjects of the parent are patching the previous object, others are new objects
+    struct FDeltaData {
+        u32 ParentFingerprint;
+        u32 NumObjects;
+    };
+    STATIC_ASSERT(sizeof(FDeltaData) == sizeof(u32) * 2);
+
     struct FSignature {
         u128 Headers;
         u128 Names;
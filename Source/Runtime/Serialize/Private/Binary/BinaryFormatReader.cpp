@@ -89,6 +89,8 @@ static bool ReadTextSection_(
 FBinaryFormatReader::FBinaryFormatReader()
 :   _iss(nullptr)
 ,   _link(nullptr)
+,   _origin(0)
+,   _parentFingerprint(0)
 {}
 //----------------------------------------------------------------------------
 void FBinaryFormatReader::Read(IBufferedStreamReader& iss, FTransactionLinker& link) {
@@ -98,13 +100,31 @@ void FBinaryFormatReader::Read(IBufferedStreamReader& iss, FTransactionLinker& l
     _iss = &iss;
     _link = &link;
 
+    // replay all chunks: first one is a complete image, following ones are delta appended by incremental saves
+    const std::streamsize totalSize = _iss->SizeInBytes();
+
     FBinaryFormat::FHeaders h;
+    for (_origin = 0; checked_cast<std::streamsize>(_origin) < totalSize; _origin += FBinaryFormat::ChunkSize(h)) {
+        ReadChunk_(h);
+
+        _parentFingerprint = h.Fingerprint;
+    }
+
+    _iss = nullptr;
+    _link = nullptr;
 
-    _iss->SeekI(0, ESeekOrigin::Begin);
+    ONLY_IF_ASSERT(_iss = nullptr);
+    ONLY_IF_ASSERT(_link = nullptr);
+}
+//----------------------------------------------------------------------------
+void FBinaryFormatReader::ReadChunk_(FBinaryFormat::FHeaders& h) {
+    _iss->SeekI(_origin, ESeekOrigin::Begin);
     if (not _iss->ReadPOD(&h) || h.Magic != FBinaryFormat::FILE_MAGIC)
         PPE_THROW_IT(FBinarySerializerException("invalid file"));
     else if (h.Version != FBinaryFormat::FILE_VERSION)
         PPE_THROW_IT(FBinarySerializerException("version mismatch"));
+    else if ((0 == _origin) == (h.Flags ^ FBinaryFormat::IsDelta))
+        PPE_THROW_IT(FBinarySerializerException("invalid delta chunk"));
     else if (not CheckFingerprint(h))
         PPE_THROW_IT(FBinarySerializerException("fingerpint mismatch"));
     else if (not RetrieveNames_(h))
@@ -129,22 +149,16 @@ void FBinaryFormatReader::Read(IBufferedStreamReader& iss, FTransactionLinker& l
         PPE_THROW_IT(FBinarySerializerException("invalid .Text section"));
     else if (not RetrieveData_(h))
         PPE_THROW_IT(FBinarySerializerException("invalid .Data section"));
-
-    _iss = nullptr;
-    _link = nullptr;
-
-    ONLY_IF_ASSERT(_iss = nullptr);
-    ONLY_IF_ASSERT(_link = nullptr);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::CheckFingerprint(const FBinaryFormat::FHeaders& h) const {
 #if !(USE_PPE_FINAL_RELEASE || USE_PPE_PROFILING) || USE_PPE_BINA_MARKERS
     TAllocaBlock<char> tmp;
 
-    auto sectionFingerprint = [iss=_iss, &tmp](const FBinaryFormat::FRawData& section) -> u128 {
+    auto sectionFingerprint = [this, &tmp](const FBinaryFormat::FRawData& section) -> u128 {
         tmp.RelocateIFP(section.Size, false);
         const auto view = TMemoryView<char>(tmp.RawData, section.Size);
-        VerifyRelease(iss->ReadAt(view, section.Offset));
+        VerifyRelease(_iss->ReadAt(view, Section_(section).Offset));
         return Fingerprint128(view);
     };
 
@@ -182,13 +196,13 @@ bool FBinaryFormatReader::CheckFingerprint(const FBinaryFormat::FHeaders& h) con
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveNames_(const FBinaryFormat::FHeaders& h) {
-    return ReadTextSection_<char>(*_iss, h.Contents.NumNames, h.Sections.Names, _contents.Names);
+    return ReadTextSection_<char>(*_iss, h.Contents.NumNames, Section_(h.Sections.Names), _contents.Names);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveClasses_(const FBinaryFormat::FHeaders& h) {
     STACKLOCAL_ASSUMEPOD_ARRAY(FDataIndex, indices, h.Contents.NumClasses);
     if (indices.SizeInBytes() != h.Sections.Classes.Size ||
-        not _iss->ReadAt(indices, h.Sections.Classes.Offset))
+        not _iss->ReadAt(indices, Section_(h.Sections.Classes).Offset))
         return false;
 
     _contents.Classes.Resize_DiscardData(h.Contents.NumClasses);
@@ -205,7 +219,7 @@ bool FBinaryFormatReader::RetrieveClasses_(const FBinaryFormat::FHeaders& h) {
 bool FBinaryFormatReader::RetrieveProperties_(const FBinaryFormat::FHeaders& h) {
     STACKLOCAL_ASSUMEPOD_ARRAY(FDataIndex, indices, h.Contents.NumProperties);
     if (indices.SizeInBytes() != h.Sections.Properties.Size ||
-        not _iss->ReadAt(indices, h.Sections.Properties.Offset))
+        not _iss->ReadAt(indices, Section_(h.Sections.Properties).Offset))
         return false;
 
     _contents.Properties.Resize_DiscardData(h.Contents.NumProperties);
@@ -220,7 +234,7 @@ bool FBinaryFormatReader::RetrieveProperties_(const FBinaryFormat::FHeaders& h)
 bool FBinaryFormatReader::RetrieveImports_(const FBinaryFormat::FHeaders& h) {
     STACKLOCAL_ASSUMEPOD_ARRAY(FBinaryFormat::FImportData, imports, h.Contents.NumImports);
     if (imports.SizeInBytes() != h.Sections.Imports.Size ||
-        not _iss->ReadAt(imports, h.Sections.Imports.Offset))
+        not _iss->ReadAt(imports, Section_(h.Sections.Imports).Offset))
         return false;
 
     _contents.Imports.Resize_DiscardData(h.Contents.NumImports);
@@ -240,53 +254,89 @@ bool FBinaryFormatReader::RetrieveImports_(const FBinaryFormat::FHeaders& h) {
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveDirpaths_(const FBinaryFormat::FHeaders& h) {
-    return ReadTextSection_<wchar_t>(*_iss, h.Contents.NumDirpaths, h.Sections.Dirpaths, _contents.Dirpaths);
+    return ReadTextSection_<wchar_t>(*_iss, h.Contents.NumDirpaths, Section_(h.Sections.Dirpaths), _contents.Dirpaths);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveBasenameNoExts_(const FBinaryFormat::FHeaders& h) {
-    return ReadTextSection_<wchar_t>(*_iss, h.Contents.NumBasenameNoExts, h.Sections.BasenameNoExts, _contents.BasenameNoExts);
+    return ReadTextSection_<wchar_t>(*_iss, h.Contents.NumBasenameNoExts, Section_(h.Sections.BasenameNoExts), _contents.BasenameNoExts);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveExtnames_(const FBinaryFormat::FHeaders& h) {
-    return ReadTextSection_<wchar_t>(*_iss, h.Contents.NumExtnames, h.Sections.Extnames, _contents.Extnames);
+    return ReadTextSection_<wchar_t>(*_iss, h.Contents.NumExtnames, Section_(h.Sections.Extnames), _contents.Extnames);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveStrings_(const FBinaryFormat::FHeaders& h) {
-    return _iss->ReadAt(_contents.Strings, h.Sections.Strings.Offset, h.Sections.Strings.Size);
+    return _iss->ReadAt(_contents.Strings, Section_(h.Sections.Strings).Offset, h.Sections.Strings.Size);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveWStrings_(const FBinaryFormat::FHeaders& h) {
-    return _iss->ReadAt(_contents.WStrings, h.Sections.WStrings.Offset, h.Sections.WStrings.Size);
+    return _iss->ReadAt(_contents.WStrings, Section_(h.Sections.WStrings).Offset, h.Sections.WStrings.Size);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveText_(const FBinaryFormat::FHeaders& h) {
-    return _iss->ReadAt(_contents.Text, h.Sections.Text.Offset, h.Sections.Text.Size);
+    return _iss->ReadAt(_contents.Text, Section_(h.Sections.Text).Offset, h.Sections.Text.Size);
 }
 //----------------------------------------------------------------------------
 bool FBinaryFormatReader::RetrieveData_(const FBinaryFormat::FHeaders& h) {
-    _contents.Bulk = h.Sections.Bulk;
-    _objects.resize(h.Contents.NumObjects);
+    _contents.Bulk = Section_(h.Sections.Bulk);
 
-    _iss->SeekI(h.Sections.Data.Offset, ESeekOrigin::Begin);
+    _iss->SeekI(Section_(h.Sections.Data).Offset, ESeekOrigin::Begin);
+
+    // objects in delta chunks are indexing the global object table, shared by all chunks
+    STACKLOCAL_POD_ARRAY(u32, indices, h.Contents.NumObjects);
+
+    const bool isDelta = (h.Flags ^ FBinaryFormat::IsDelta);
+    if (isDelta) {
+        FBinaryFormat::FDeltaData deltaData;
+        if (not _iss->ReadPOD(&deltaData) ||
+            deltaData.ParentFingerprint != _parentFingerprint ||
+            deltaData.NumObjects < _objects.size() ||
+            not _iss->ReadView(indices) )
+            return false;
+
+        _objects.resize(deltaData.NumObjects);
+    }
+    else {
+        _objects.resize(h.Contents.NumObjects);
+
+        forrange(i, 0, h.Contents.NumObjects)
+            indices[i] = i;
+    }
 
     FBinaryFormat::FObjectData objData;
     FBinaryFormat::FPropertyData propData;
-    for (RTTI::PMetaObject& obj : _objects) {
+    for (const u32 objectIndex : indices) {
         Verify(_iss->ReadPOD(&objData));
 
         const RTTI::FMetaClass* const klass = _contents.Classes[objData.ClassIndex];
         Assert(klass);
 
-        if (not klass->CreateInstance(obj, true))
+        if (objectIndex >= _objects.size())
             return false;
 
-        if (objData.Flags ^ FBinaryFormat::TopObject) {
-            _link->AddTopObject(obj.get());
+        RTTI::PMetaObject& obj = _objects[objectIndex];
+
+        if (obj) {
+            // patching an object from a previous chunk: exports and top objects can't change without a new image
+            Assert_NoAssume(isDelta);
+            if (obj->RTTI_Class() != klass)
+                return false;
+
+            for (const RTTI::FMetaProperty* prop : klass->AllProperties())
+                prop->ResetToDefaultValue(*obj);
         }
+        else {
+            if (not klass->CreateInstance(obj, true))
+                return false;
 
-        if (objData.Flags ^ FBinaryFormat::Export) {
-            Assert_NoAssume(FDataIndex::DefaultValue() != objData.NameIndex);
-            _link->AddExport(_contents.Names[objData.NameIndex], obj);
+            if (objData.Flags ^ FBinaryFormat::TopObject) {
+                _link->AddTopObject(obj.get());
+            }
+
+            if (objData.Flags ^ FBinaryFormat::Export) {
+                Assert_NoAssume(FDataIndex::DefaultValue() != objData.NameIndex);
+                _link->AddExport(_contents.Names[objData.NameIndex], obj);
+            }
         }
 
         forrange(i, 0, u32(objData.NumProperties)) {
@@ -306,6 +356,12 @@ bool FBinaryFormatReader::RetrieveData_(const FBinaryFormat::FHeaders& h) {
         }
     }
 
+    // every new object must have been serialized by the chunk introducing it
+    for (const RTTI::PMetaObject& obj : _objects) {
+        if (not obj)
+            return false;
+    }
+
     return true;
 }
 //----------------------------------------------------------------------------
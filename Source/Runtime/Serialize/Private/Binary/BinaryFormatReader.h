@@ -54,6 +54,10 @@ private:
     IBufferedStreamReader* _iss;
     FTransactionLinker* _link;
 
+    // offset of the current chunk, and fingerprint of the previous one (for delta chunks)
+    u32 _origin;
+    u32 _parentFingerprint;
+
     // holds lifetime while reading the file
     VECTOR(Binary, RTTI::PMetaObject) _objects;
 
@@ -77,6 +81,12 @@ private:
 
     }   _contents;
 
+    void ReadChunk_(FBinaryFormat::FHeaders& h);
+
+    FBinaryFormat::FRawData Section_(const FBinaryFormat::FRawData& section) const {
+        return { _origin + section.Offset, section.Size };
+    }
+
     bool CheckFingerprint(const FBinaryFormat::FHeaders& h) const;
 
     bool RetrieveNames_(const FBinaryFormat::FHeaders& h);
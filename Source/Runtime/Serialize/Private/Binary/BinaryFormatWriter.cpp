@@ -42,11 +42,12 @@ static void WriteAlign_(IStreamWriter& outp, const TMemoryView<T>& view) {
         outp.WriteView(TMemoryView<const char>(GPaddingStr_, padding));
 }
 //----------------------------------------------------------------------------
+// section offsets are relative to the start of the chunk, outp can already hold previous chunks
 template <typename T>
-static void WriteAlign_(IStreamWriter& outp, const FBinaryFormat::FRawData& section, const TMemoryView<T>& view) {
-    Assert_NoAssume(section.Offset == outp.TellO());
+static void WriteAlign_(IStreamWriter& outp, std::streamoff chunkStart, const FBinaryFormat::FRawData& section, const TMemoryView<T>& view) {
+    Assert_NoAssume(section.Offset == outp.TellO() - chunkStart);
     Assert_NoAssume(section.Size == view.SizeInBytes());
-    Unused(section);
+    Unused(chunkStart, section);
     WriteAlign_(outp, view);
 }
 //----------------------------------------------------------------------------
@@ -104,6 +105,15 @@ static void Sort_(
 FBinaryFormatWriter::FBinaryFormatWriter()
 {}
 //----------------------------------------------------------------------------
+void FBinaryFormatWriter::SetDelta(u32 parentFingerprint, const FGlobalIndices& globals) {
+    Assert_NoAssume(_contents.Objects.empty());
+
+    _delta.ParentFingerprint = parentFingerprint;
+    _delta.Globals = &globals;
+
+    _contents.Flags = _contents.Flags | FBinaryFormat::IsDelta;
+}
+//----------------------------------------------------------------------------
 void FBinaryFormatWriter::Append(const RTTI::FMetaObject* obj) {
     Assert_NoAssume(obj);
 
@@ -165,8 +175,10 @@ void FBinaryFormatWriter::Append(const FTransactionSaver& saver) {
         Append(ref.get());
 }
 //----------------------------------------------------------------------------
-void FBinaryFormatWriter::Finalize(IStreamWriter& outp, bool mergeSort/* = true */) {
-   if (mergeSort)
+FBinaryFormat::FHeaders FBinaryFormatWriter::Finalize(IStreamWriter& outp, bool mergeSort/* = true */) {
+    Assert_NoAssume(mergeSort || nullptr == _delta.Globals); // delta prefix is written while sorting
+
+    if (mergeSort)
         MergeSortContents_();
 
     FBinaryFormat::FHeaders h;
@@ -179,6 +191,8 @@ void FBinaryFormatWriter::Finalize(IStreamWriter& outp, bool mergeSort/* = true
     ExportSections_(h.Sections);
     MakeFingerprint_(h);
     WriteFileData_(h, outp);
+
+    return h;
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
@@ -279,8 +293,21 @@ void FBinaryFormatWriter::Visit_(const RTTI::FBinaryData& bin) {
 void FBinaryFormatWriter::Visit_(const RTTI::PMetaObject& obj) {
     FBinaryFormat::FReferenceData refData;
     if (RTTI::FMetaObject* o = obj.get()) {
-        auto it = _contents.Objects.find(o);
-        if (it == _contents.Objects.end()) {
+        if (_delta.Globals) {
+            // delta chunks can reference objects outside of the chunk, use global indices instead
+            const auto global = _delta.Globals->find(o);
+            if (_delta.Globals->end() == global) {
+                Assert_NoAssume(o->RTTI_IsExported()); // can't import a non exported object
+
+                refData.IsImport = 1;
+                refData.ObjectIndex = DataIndex_<const RTTI::FMetaObject*>(_contents.Imports, obj.get()).Value;
+            }
+            else {
+                refData.IsImport = 0;
+                refData.ObjectIndex = global->second;
+            }
+        }
+        else if (const auto it = _contents.Objects.find(o); it == _contents.Objects.end()) {
             // assuming this is an import, since all objects are serialized by inverse order of discovery
             Assert_NoAssume(o->RTTI_IsExported()); // can't import a non exported object
 
@@ -405,6 +432,19 @@ void FBinaryFormatWriter::MergeSortContents_() {
 
     _contents.Objects.clear();
 
+    // delta chunks start with the global index of every object they contain
+
+    if (_delta.Globals) {
+        FBinaryFormat::FDeltaData deltaData;
+        deltaData.ParentFingerprint = _delta.ParentFingerprint;
+        deltaData.NumObjects = checked_cast<u32>(_delta.Globals->size());
+
+        _sections.Data.WritePOD(deltaData);
+
+        for (const RTTI::FMetaObject* ref : visiteds)
+            _sections.Data.WritePOD(_delta.Globals->at(ref));
+    }
+
     // finally serialize all visited objects with sorted data
 
     for (const RTTI::FMetaObject* ref : visiteds)
@@ -486,19 +526,21 @@ void FBinaryFormatWriter::MakeFingerprint_(FBinaryFormat::FHeaders& h) const {
 }
 //----------------------------------------------------------------------------
 void FBinaryFormatWriter::WriteFileData_(const FBinaryFormat::FHeaders& h, IStreamWriter& outp) const {
+    const std::streamoff chunkStart = outp.TellO();
+
     WriteAlign_(outp, TMemoryView<const FBinaryFormat::FHeaders>(&h, 1));
-    WriteAlign_(outp, h.Sections.Names, _sections.Names.MakeView());
-    WriteAlign_(outp, h.Sections.Classes, _sections.Classes.MakeView());
-    WriteAlign_(outp, h.Sections.Properties, _sections.Properties.MakeView());
-    WriteAlign_(outp, h.Sections.Imports, _sections.Imports.MakeView());
-    WriteAlign_(outp, h.Sections.Dirpaths, _sections.Dirpaths.MakeView());
-    WriteAlign_(outp, h.Sections.BasenameNoExts, _sections.BasenameNoExts.MakeView());
-    WriteAlign_(outp, h.Sections.Extnames, _sections.Extnames.MakeView());
-    WriteAlign_(outp, h.Sections.Strings, _sections.Strings.MakeView());
-    WriteAlign_(outp, h.Sections.WStrings, _sections.WStrings.MakeView());
-    WriteAlign_(outp, h.Sections.Text, _sections.Text.MakeView());
-    WriteAlign_(outp, h.Sections.Data, _sections.Data.MakeView());
-    WriteAlign_(outp, h.Sections.Bulk, _sections.Bulk.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Names, _sections.Names.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Classes, _sections.Classes.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Properties, _sections.Properties.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Imports, _sections.Imports.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Dirpaths, _sections.Dirpaths.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.BasenameNoExts, _sections.BasenameNoExts.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Extnames, _sections.Extnames.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Strings, _sections.Strings.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.WStrings, _sections.WStrings.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Text, _sections.Text.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Data, _sections.Data.MakeView());
+    WriteAlign_(outp, chunkStart, h.Sections.Bulk, _sections.Bulk.MakeView());
 }
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
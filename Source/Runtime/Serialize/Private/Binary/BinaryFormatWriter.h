@@ -25,12 +25,17 @@ namespace Serialize {
 //----------------------------------------------------------------------------
 class FBinaryFormatWriter : Meta::FNonCopyableNorMovable, RTTI::IAtomVisitor {
 public:
+    using FGlobalIndices = HASHMAP(Binary, const RTTI::FMetaObject*, u32);
+
     FBinaryFormatWriter();
 
+    // references are serialized with the global indices of a previous chunk, see FBinaryFormat::FDeltaData
+    void SetDelta(u32 parentFingerprint, const FGlobalIndices& globals);
+
     void Append(const RTTI::FMetaObject* obj);
     void Append(const FTransactionSaver& saver);
 
-    void Finalize(IStreamWriter& outp, bool mergeSort = true);
+    FBinaryFormat::FHeaders Finalize(IStreamWriter& outp, bool mergeSort = true);
 
 private: // RTTI::IAtomVisitor
     virtual bool Visit(const RTTI::ITupleTraits* tuple, void* data) override final;
@@ -82,6 +87,12 @@ private:
 
     }   _contents;
 
+    struct FDelta_ {
+        u32 ParentFingerprint{ 0 };
+        const FGlobalIndices* Globals{ nullptr };
+
+    }   _delta;
+
     struct FSections_ {
         MEMORYSTREAM(Binary) Names;
         MEMORYSTREAM(Binary) Classes;
@@ -6,6 +6,11 @@
 #include "Binary/BinaryFormatReader.h"
 #include "Binary/BinaryFormatWriter.h"
 
+#include "TransactionSaver.h"
+
+#include "MetaObject.h"
+
+#include "Container/Stack.h"
 #include "IO/BufferedStream.h"
 #include "IO/ConstNames.h"
 #include "IO/Extname.h"
@@ -15,6 +20,22 @@ namespace Serialize {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+namespace {
+//----------------------------------------------------------------------------
+// those flags are only registered by the chunk introducing the object, a change needs a new base
+static RTTI::EObjectFlags StructuralFlags_(const RTTI::FMetaObject& obj) {
+    RTTI::EObjectFlags flags = RTTI::EObjectFlags::None;
+    if (obj.RTTI_IsExported())
+        flags = flags + RTTI::EObjectFlags::Exported;
+    if (obj.RTTI_IsTopObject())
+        flags = flags + RTTI::EObjectFlags::TopObject;
+    return flags;
+}
+//----------------------------------------------------------------------------
+} //!namespace
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
 FBinarySerializer::FBinarySerializer() = default;
 //----------------------------------------------------------------------------
 FBinarySerializer::~FBinarySerializer() = default;
@@ -49,5 +70,124 @@ PSerializer FBinarySerializer::Get() {
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
+FBinaryDeltaSerializer::FBinaryDeltaSerializer() = default;
+//----------------------------------------------------------------------------
+FBinaryDeltaSerializer::~FBinaryDeltaSerializer() = default;
+//----------------------------------------------------------------------------
+bool FBinaryDeltaSerializer::NeedCompaction() const {
+    return (_numDeltas >= MaxDeltaChunks || _deltaSizeInBytes > _baseSizeInBytes);
+}
+//----------------------------------------------------------------------------
+void FBinaryDeltaSerializer::SerializeBase(const FTransactionSaver& saver, IStreamWriter* output) {
+    Assert(output);
+
+    Reset();
+
+    FBinaryFormatWriter writer;
+    writer.Append(saver);
+
+    FBinaryFormat::FHeaders h;
+    UsingBufferedStream(output, [&writer, &h](IBufferedStreamWriter* buffered) {
+        h = writer.Finalize(*buffered);
+    });
+
+    _lastFingerprint = h.Fingerprint;
+    _baseSizeInBytes = FBinaryFormat::ChunkSize(h);
+
+    // objects are serialized in the same order than loaded refs, which gives their global index
+    const TMemoryView<const RTTI::SMetaObject> loadedRefs = saver.LoadedRefs();
+
+    _indices.reserve(loadedRefs.size());
+    _states.reserve(loadedRefs.size());
+
+    for (const RTTI::SMetaObject& ref : loadedRefs)
+        Track_(*ref);
+}
+//----------------------------------------------------------------------------
+auto FBinaryDeltaSerializer::SerializeDelta(const FTransactionSaver& saver, IStreamWriter* output) -> EDeltaResult {
+    Assert(output);
+
+    if (not HasBase() || NeedCompaction())
+        return EDeltaResult::NeedBase;
+
+    const TMemoryView<const RTTI::SMetaObject> loadedRefs = saver.LoadedRefs();
+
+    STACKLOCAL_POD_STACK(RTTI::FMetaObject*, dirties, loadedRefs.size());
+    STACKLOCAL_POD_STACK(RTTI::FMetaObject*, created, loadedRefs.size());
+
+    size_t numAlives = 0;
+    for (const RTTI::SMetaObject& ref : loadedRefs) {
+        const auto it = _indices.find(ref.get());
+
+        if (_indices.end() == it) {
+            created.Push(ref.get());
+            dirties.Push(ref.get());
+            continue;
+        }
+
+        ++numAlives;
+
+        if (not ref->RTTI_IsDirty())
+            continue;
+
+        const FObjectState_& state = _states[it->second];
+        if (state.Flags != StructuralFlags_(*ref) || state.Name != ref->RTTI_Name())
+            return EDeltaResult::NeedBase;
+
+        dirties.Push(ref.get());
+    }
+
+    // removed objects would be resurrected when replaying the chunks
+    if (numAlives != _states.size())
+        return EDeltaResult::NeedBase;
+
+    if (dirties.empty())
+        return EDeltaResult::NothingToAppend;
+
+    for (RTTI::FMetaObject* obj : created)
+        Track_(*obj);
+
+    FBinaryFormatWriter writer;
+    writer.SetDelta(_lastFingerprint, _indices);
+
+    for (const RTTI::FMetaObject* obj : dirties)
+        writer.Append(obj);
+
+    FBinaryFormat::FHeaders h;
+    UsingBufferedStream(output, [&writer, &h](IBufferedStreamWriter* buffered) {
+        h = writer.Finalize(*buffered);
+    });
+
+    for (RTTI::FMetaObject* obj : dirties)
+        obj->RTTI_ClearDirty();
+
+    _lastFingerprint = h.Fingerprint;
+    _numDeltas++;
+    _deltaSizeInBytes += FBinaryFormat::ChunkSize(h);
+
+    return EDeltaResult::Appended;
+}
+//----------------------------------------------------------------------------
+void FBinaryDeltaSerializer::Reset() {
+    _indices.clear();
+    _states.clear();
+
+    _lastFingerprint = 0;
+    _numDeltas = 0;
+    _baseSizeInBytes = 0;
+    _deltaSizeInBytes = 0;
+}
+//----------------------------------------------------------------------------
+void FBinaryDeltaSerializer::Track_(RTTI::FMetaObject& obj) {
+    const u32 globalIndex = checked_cast<u32>(_states.size());
+
+    Insert_AssertUnique(_indices, static_cast<const RTTI::FMetaObject*>(&obj), globalIndex);
+    _states.push_back(FObjectState_{ StructuralFlags_(obj), obj.RTTI_Name(), RTTI::PCMetaObject{ &obj } });
+
+    obj.RTTI_ClearDirty();
+}
+//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------------------------
 } //!namespace Serialize
 } //!namespace PPE
@@ -21,8 +21,9 @@ namespace Parser {
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 FParseContext::FParseContext(Meta::FForceInit)
-:   FParseContext(NEW_REF(Parser, RTTI::FAtomHeap))
-{}
+:   FParseContext(RTTI::PAtomHeap{ &RTTI::FAtomHeap::ThreadLocal() }) {
+    _transientMark = _atomHeap->Mark();
+}
 //----------------------------------------------------------------------------
 FParseContext::FParseContext(const RTTI::PAtomHeap& atomHeap)
 :   _parent(nullptr)
@@ -36,7 +37,10 @@ FParseContext::FParseContext(const FParseContext *parent /* = nullptr */)
     Assert(_atomHeap);
 }
 //----------------------------------------------------------------------------
-FParseContext::~FParseContext() = default;
+FParseContext::~FParseContext() {
+    if (_transientMark.has_value())
+        _atomHeap->Rewind(*_transientMark);
+}
 //----------------------------------------------------------------------------
 const FParseContext* FParseContext::GlobalScope() const {
     const FParseContext* ctx = this;
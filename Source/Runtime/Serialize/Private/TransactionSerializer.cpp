@@ -6,6 +6,7 @@
 #include "ISerializer.h"
 #include "TransactionLinker.h"
 #include "TransactionSaver.h"
+#include "Binary/BinarySerializer.h"
 
 #include "MetaTransaction.h"
 #include "RTTI/Macros-impl.h"
@@ -39,6 +40,7 @@ RTTI_ENUM_VALUE(AutoMount)
 RTTI_ENUM_VALUE(AutoImport)
 RTTI_ENUM_VALUE(Compressed)
 RTTI_ENUM_VALUE(Merged) // #TODO
+RTTI_ENUM_VALUE(Incremental)
 RTTI_ENUM_END()
 //----------------------------------------------------------------------------
 RTTI_ENUM_BEGIN(Serialize, ESerializeFormat)
@@ -129,7 +131,47 @@ void FTransactionSerializer::SaveTransaction() {
     FTransactionSaver saver(*_transaction, IdToTransaction(_id));
     const PSerializer serializer = ISerializer::FromExtname(saver.Filename().Extname());
 
-    if (_options & ETransactionOptions::Compressed) {
+    if (_options & ETransactionOptions::Incremental &&
+        not (_options & ETransactionOptions::Compressed) &&
+        saver.Filename().Extname() == FBinarySerializer::Extname() ) {
+        if (not _incremental)
+            _incremental = MakeUnique<FBinaryDeltaSerializer>();
+
+        if (_incremental->HasBase()) {
+            using EDeltaResult = FBinaryDeltaSerializer::EDeltaResult;
+
+            EDeltaResult result = EDeltaResult::NeedBase;
+            {
+                const auto writer{ VFS_OpenBinaryWritable(saver.Filename(), EAccessPolicy::Append) };
+                UsingDeferredStream(writer.get(), [&](IBufferedStreamWriter* async) {
+                    result = _incremental->SerializeDelta(saver, async);
+                });
+            }
+
+            switch (result) {
+            case EDeltaResult::Appended:
+                PPE_LOG(Serialize, Info, "appended delta #{0} to transaction '{1}' with namespace <{2}> in '{3}'",
+                    _incremental->NumDeltas(), _id, _namespace, saver.Filename());
+                return;
+            case EDeltaResult::NothingToAppend:
+                PPE_LOG(Serialize, Verbose, "transaction '{0}' with namespace <{1}> is already up-to-date in '{2}'",
+                    _id, _namespace, saver.Filename());
+                return;
+            case EDeltaResult::NeedBase:
+                break;
+            }
+        }
+
+        // compaction: replace all previous chunks with a new base
+        PPE_LOG(Serialize, Emphasis, "saving incremental base of transaction '{0}' with namespace <{1}> in '{2}' ...",
+            _id, _namespace, saver.Filename());
+
+        const auto writer{ VFS_OpenBinaryWritable(saver.Filename(), EAccessPolicy::Truncate) };
+        UsingDeferredStream(writer.get(), [&](IBufferedStreamWriter* async) {
+            _incremental->SerializeBase(saver, async);
+        });
+    }
+    else if (_options & ETransactionOptions::Compressed) {
         FFilename fnameZ{ saver.Filename() };
         fnameZ.ReplaceExtension(FFSConstNames::Z());
 
@@ -211,6 +253,8 @@ void FTransactionSerializer::UnloadTransaction() {
     PPE_LOG(Serialize, Emphasis, "unloading transaction '{0}' with namespace <{1}> ...",
         _id, _namespace);
 
+    _incremental.reset(); // releases pinned objects
+
     _transaction->Unload();
 
     RemoveRef_AssertReachZero(_transaction);
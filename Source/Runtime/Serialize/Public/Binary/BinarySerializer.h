@@ -6,6 +6,10 @@
 #include "SerializeExceptions.h"
 
 #include "RTTI_fwd.h"
+#include "RTTI/Typedefs.h"
+
+#include "Container/HashMap.h"
+#include "Container/Vector.h"
 
 namespace PPE {
 namespace Serialize {
@@ -36,6 +40,59 @@ private:
     FBinarySerializer();
 };
 //----------------------------------------------------------------------------
+// Incremental saving of a transaction in a single binary file :
+// - SerializeBase() writes a complete image, exactly like FBinarySerializer
+// - SerializeDelta() appends a chunk with only the objects marked dirty since the last save
+// - FBinarySerializer::Deserialize() replays all chunks transparently
+// Compaction is done by writing a new base, when NeedCompaction() or when SerializeDelta() fails.
+//----------------------------------------------------------------------------
+class PPE_SERIALIZE_API FBinaryDeltaSerializer : Meta::FNonCopyableNorMovable {
+public:
+    STATIC_CONST_INTEGRAL(size_t, MaxDeltaChunks, 64);
+
+    enum class EDeltaResult : u8 {
+        NeedBase = 0,       // nothing was written, a new base must be saved
+        NothingToAppend,    // no object is dirty, the output is left untouched
+        Appended,           // a new delta chunk was written to the output
+    };
+
+    FBinaryDeltaSerializer();
+    ~FBinaryDeltaSerializer();
+
+    bool HasBase() const { return (_baseSizeInBytes > 0); }
+    size_t NumDeltas() const { return _numDeltas; }
+    size_t BaseSizeInBytes() const { return _baseSizeInBytes; }
+    size_t DeltaSizeInBytes() const { return _deltaSizeInBytes; }
+
+    // replaying the deltas is becoming more expensive than loading a new base
+    bool NeedCompaction() const;
+
+    // output should be truncated, clears all dirty flags
+    void SerializeBase(const FTransactionSaver& saver, IStreamWriter* output);
+
+    // output should be positioned at the end of the previous save
+    NODISCARD EDeltaResult SerializeDelta(const FTransactionSaver& saver, IStreamWriter* output);
+
+    void Reset();
+
+private:
+    struct FObjectState_ {
+        RTTI::EObjectFlags Flags; // only Exported|TopObject, which can't be patched by a delta
+        RTTI::FName Name;
+        RTTI::PCMetaObject Pin; // holds the address, so it can't be recycled by another object
+    };
+
+    void Track_(RTTI::FMetaObject& obj);
+
+    HASHMAP(Binary, const RTTI::FMetaObject*, u32) _indices; // global index of every serialized object
+    VECTOR(Binary, FObjectState_) _states; // indexed by global index
+
+    u32 _lastFingerprint{ 0 };
+    size_t _numDeltas{ 0 };
+    size_t _baseSizeInBytes{ 0 };
+    size_t _deltaSizeInBytes{ 0 };
+};
+//----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////
 //----------------------------------------------------------------------------
 } //!namespace Serialize
@@ -5,11 +5,13 @@
 #include "RTTI_fwd.h"
 #include "Allocator/SlabHeap.h"
 #include "RTTI/Atom.h"
+#include "RTTI/AtomHeap.h"
 #include "RTTI/TypeTraits.h"
 
 #include "Container/HashMap.h"
 #include "Memory/RefPtr.h"
 #include "IO/StringBuilder.h"
+#include "Meta/Optional.h"
 
 namespace PPE {
 namespace Parser {
@@ -21,6 +23,7 @@ class PPE_SERIALIZE_API FParseContext : Meta::FNonCopyableNorMovable {
 public:
     using local_scope_t = HASHMAP(Parser, RTTI::FName, RTTI::FAtom);
 
+    // uses FAtomHeap::ThreadLocal(), transient atoms are released with the context
     explicit FParseContext(Meta::FForceInit);
     explicit FParseContext(const RTTI::PAtomHeap& atomHeap);
     explicit FParseContext(const FParseContext* parent);
@@ -63,6 +66,7 @@ public:
 private:
     const FParseContext* const _parent;
     const RTTI::PAtomHeap _atomHeap;
+    Meta::TOptional<RTTI::FAtomHeap::FMark> _transientMark;
 
     RTTI::PMetaObject _scopeObject;
     local_scope_t _localScope;
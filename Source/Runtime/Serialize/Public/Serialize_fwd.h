@@ -23,6 +23,7 @@ enum class ESerializeFormat : u32;
 class ISerializer;
 using PSerializer = TInSituPtr<ISerializer>;
 //----------------------------------------------------------------------------
+class FBinaryDeltaSerializer;
 class FTransactionLinker;
 class FTransactionSaver;
 FWD_REFPTR(TransactionSerializer);
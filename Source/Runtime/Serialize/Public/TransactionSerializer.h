@@ -5,6 +5,7 @@
 #include "IO/Dirpath.h"
 #include "IO/Filename.h"
 #include "IO/String.h"
+#include "Memory/UniquePtr.h"
 
 #include "MetaObject.h"
 #include "RTTI_fwd.h"
@@ -26,6 +27,7 @@ enum class ETransactionOptions : u32 {
 
     Compressed          = 1 << 5,
     Merged              = 1 << 6, // #TODO
+    Incremental         = 1 << 7, // append dirty objects to the previous save, ignored when Compressed
 
     Automated           = AutoBuild | AutoMount | AutoImport,
     Default             = Automated | Compressed | Merged
@@ -93,6 +95,7 @@ private:
     ETransactionOptions _options;
 
     RTTI::PMetaTransaction _transaction;
+    TUniquePtr<FBinaryDeltaSerializer> _incremental;
 };
 //----------------------------------------------------------------------------
 //////////////////////////////////////////////////////////////////////////////